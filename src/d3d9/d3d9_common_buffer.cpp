@@ -30,7 +30,7 @@ namespace dxvk {
   D3D9CommonBuffer::D3D9CommonBuffer(
           D3D9DeviceEx*      pDevice,
     const D3D9_BUFFER_DESC*  pDesc) 
-    : m_parent ( pDevice ), m_desc ( *pDesc ) {
+    : m_parent ( pDevice ), m_desc ( *pDesc ), m_residency ( DetermineResidency() ) {
     m_buffer = CreateBuffer();
     if (GetMapMode() == D3D9_COMMON_BUFFER_MAP_MODE_BUFFER)
       m_stagingBuffer = CreateStagingBuffer();
@@ -80,6 +80,19 @@ namespace dxvk {
     }
   }
 
+  // NV-DXVK start: shadowed geometry buffers
+  D3D9GeometryResidency D3D9CommonBuffer::DetermineResidency() const {
+    const D3D9Options* options = m_parent->GetOptions();
+
+    return DetermineGeometryResidency(
+      m_desc.Type == D3DRTYPE_VERTEXBUFFER || m_desc.Type == D3DRTYPE_INDEXBUFFER,
+      IsDirectMapped(m_desc),
+      (m_desc.Usage & D3DUSAGE_DYNAMIC) != 0,
+      options->hostMemoryForGeometry,
+      options->shadowGeometryBuffers);
+  }
+  // NV-DXVK end
+
   Rc<DxvkBuffer> D3D9CommonBuffer::CreateBuffer() const {
     DxvkBufferCreateInfo  info;
     info.size = m_desc.Size;
@@ -124,7 +137,8 @@ namespace dxvk {
     }
 
     // NV-DXVK start: force app geometry data into host memory
-    if (m_parent->GetOptions()->hostMemoryForGeometry) {
+    // Note: Shadowed buffers are read by the CPU through their staging buffer and stay device local
+    if (m_residency == D3D9GeometryResidency::Host) {
       memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
     }
     // NV-DXVK end
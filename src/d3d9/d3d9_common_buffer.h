@@ -2,6 +2,9 @@
 
 #include "d3d9_device_child.h"
 #include "d3d9_format.h"
+// NV-DXVK start: shadowed geometry buffers
+#include "d3d9_geometry_residency.h"
+// NV-DXVK end
 #include "../dxvk/dxvk_buffer.h"
 
 namespace dxvk {
@@ -88,11 +91,26 @@ namespace dxvk {
     * \brief Determine the mapping mode of the buffer, (ie. direct mapping or backed)
     */
     inline D3D9_COMMON_BUFFER_MAP_MODE GetMapMode() const {
-      return (m_desc.Pool == D3DPOOL_DEFAULT && (m_desc.Usage & (D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY)))
+      // NV-DXVK start: shadowed geometry buffers
+      // Shadowed geometry buffers write to a host memory shadow copy which is uploaded on unlock
+      if (m_residency == D3D9GeometryResidency::Shadowed)
+        return D3D9_COMMON_BUFFER_MAP_MODE_BUFFER;
+      // NV-DXVK end
+
+      return IsDirectMapped(m_desc)
         ? D3D9_COMMON_BUFFER_MAP_MODE_DIRECT
         : D3D9_COMMON_BUFFER_MAP_MODE_BUFFER;
     }
 
+    // NV-DXVK start: shadowed geometry buffers
+    /**
+    * \brief Where the buffer lives to keep geometry readable by the CPU
+    */
+    inline D3D9GeometryResidency GetGeometryResidency() const {
+      return m_residency;
+    }
+    // NV-DXVK end
+
     /**
     * \brief Abstraction for getting a type of buffer (mapping/staging/the real buffer) across mapping modes.
     */
@@ -188,6 +206,14 @@ namespace dxvk {
 
   private:
 
+    // NV-DXVK start: shadowed geometry buffers
+    static bool IsDirectMapped(const D3D9_BUFFER_DESC& desc) {
+      return desc.Pool == D3DPOOL_DEFAULT && (desc.Usage & (D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY));
+    }
+
+    D3D9GeometryResidency DetermineResidency() const;
+    // NV-DXVK end
+
     Rc<DxvkBuffer> CreateBuffer() const;
     Rc<DxvkBuffer> CreateStagingBuffer() const;
 
@@ -205,6 +231,9 @@ namespace dxvk {
 
     D3D9DeviceEx*               m_parent;
     const D3D9_BUFFER_DESC      m_desc;
+    // NV-DXVK start: shadowed geometry buffers
+    const D3D9GeometryResidency m_residency;
+    // NV-DXVK end
     DWORD                       m_mapFlags;
     bool                        m_wasWrittenByGPU = false;
     bool                        m_uploadUsingStaging = false;
@@ -569,4 +569,67 @@ namespace dxvk {
   void D3D9CommonTexture::SetupForRtx() {
     SetupForRtxFrom(this);
   }
+
+  static TextureAlphaFormat GetTextureAlphaFormat(D3D9Format Format) {
+    switch (Format) {
+      case D3D9Format::A8R8G8B8:
+      case D3D9Format::A8B8G8R8:
+        return TextureAlphaFormat::A8R8G8B8;
+      case D3D9Format::A8L8:
+        return TextureAlphaFormat::A8L8;
+      case D3D9Format::A8:
+        return TextureAlphaFormat::A8;
+      case D3D9Format::A4R4G4B4:
+        return TextureAlphaFormat::A4R4G4B4;
+      case D3D9Format::A1R5G5B5:
+        return TextureAlphaFormat::A1R5G5B5;
+      case D3D9Format::DXT1:
+        return TextureAlphaFormat::BC1;
+      case D3D9Format::DXT2:
+      case D3D9Format::DXT3:
+        return TextureAlphaFormat::BC2;
+      case D3D9Format::DXT4:
+      case D3D9Format::DXT5:
+        return TextureAlphaFormat::BC3;
+      case D3D9Format::X8R8G8B8:
+      case D3D9Format::X8B8G8R8:
+      case D3D9Format::R8G8B8:
+      case D3D9Format::R5G6B5:
+      case D3D9Format::X1R5G5B5:
+      case D3D9Format::X4R4G4B4:
+      case D3D9Format::L8:
+        return TextureAlphaFormat::Opaque;
+      default:
+        return TextureAlphaFormat::Unknown;
+    }
+  }
+
+  void D3D9CommonTexture::UpdateRtxAlphaRange(UINT Subresource, const void* pData) {
+    // Render targets are written by the GPU, so their contents are never known
+    if (m_type != D3DRTYPE_TEXTURE || (m_desc.Usage & (D3DUSAGE_DEPTHSTENCIL | D3DUSAGE_RENDERTARGET)) || m_image == nullptr)
+      return;
+
+    const UINT mipLevel = Subresource % m_desc.MipLevels;
+
+    if (pData != nullptr) {
+      const TextureAlphaFormat format = GetTextureAlphaFormat(m_desc.Format);
+      const VkExtent3D extent = GetExtentMip(Subresource);
+
+      m_rtxAlphaRanges[mipLevel] = computeTextureAlphaRange(
+        format, pData, extent.width, extent.height,
+        getTextureAlphaRowPitch(format, extent.width));
+    } else {
+      m_rtxAlphaRanges[mipLevel] = TextureAlphaRange();
+    }
+
+    // Automatically generated mips are filtered from the top level and stay within its range
+    const UINT sampledMips = IsAutomaticMip() ? 1 : m_desc.MipLevels;
+
+    TextureAlphaRange range = m_rtxAlphaRanges[0];
+
+    for (UINT i = 1; i < sampledMips; i++)
+      range = TextureAlphaRange::combine(range, m_rtxAlphaRanges[i]);
+
+    m_image->setAlphaRange(range);
+  }
 }
\ No newline at end of file
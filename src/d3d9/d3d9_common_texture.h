@@ -388,6 +388,18 @@ namespace dxvk {
 
     void SetupForRtx();
     void SetupForRtxFrom(const D3D9CommonTexture* source);
+
+    /**
+     * \brief Updates the alpha range of a mip level
+     *
+     * Analyzes the alpha channel of data written to a mip of a
+     * 2D texture, and publishes the range of all mips sampled by
+     * the GPU to the image once each of them is known.
+     * \param [in] Subresource Subresource the data was written to
+     * \param [in] pData Tightly packed data of the whole mip level,
+     *   or \c nullptr if only part of it was written
+     */
+    void UpdateRtxAlphaRange(UINT Subresource, const void* pData);
     
     void AddDirtyBox(CONST D3DBOX* pDirtyBox, uint32_t layer) {
       if (pDirtyBox) {
@@ -474,6 +486,10 @@ namespace dxvk {
 
     std::array<D3DBOX, 6>         m_dirtyBoxes;
 
+    std::array<
+      TextureAlphaRange,
+      caps::MaxMipLevels>         m_rtxAlphaRanges;
+
     /**
      * \brief Mip level
      * \returns Size of packed mip level in bytes
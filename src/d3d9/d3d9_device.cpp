@@ -787,6 +787,15 @@ namespace dxvk {
       dstTextureInfo->SetupForRtxFrom(srcTextureInfo);
     }
 
+    // NV-DXVK start: texture alpha range
+    // The source level has the layout of a locked mip when it is copied as a whole
+    const bool isEntireMip = dstOffset.x == 0 && dstOffset.y == 0
+      && srcBlockOffset.x == 0 && srcBlockOffset.y == 0
+      && copyExtent == texLevelExtent
+      && copyExtent == dstImage->mipLevelExtent(dstSubresource.mipLevel);
+    dstTextureInfo->UpdateRtxAlphaRange(dst->GetSubresource(), isEntireMip ? srcSlice.mapPtr : nullptr);
+    // NV-DXVK end
+
     EmitCs([
       cDstImage   = std::move(dstImage),
       cSrcSlice   = slice.slice,
@@ -881,6 +890,13 @@ namespace dxvk {
         scaledAlignedBoxExtent.height = std::min<uint32_t>(texLevelExtent.height, scaledAlignedBoxExtent.height);
         scaledAlignedBoxExtent.depth  = std::min<uint32_t>(texLevelExtent.depth, scaledAlignedBoxExtent.depth);
 
+        // NV-DXVK start: texture alpha range
+        const bool isEntireMip = scaledBoxOffset.x == 0 && scaledBoxOffset.y == 0
+          && scaledAlignedBoxExtent == texLevelExtent;
+        dstTexInfo->UpdateRtxAlphaRange(dstTexInfo->CalcSubresource(a, m),
+          isEntireMip ? srcTexInfo->GetMappedSlice(srcTexInfo->CalcSubresource(a, m)).mapPtr : nullptr);
+        // NV-DXVK end
+
         EmitCs([
           cDstImage  = dstImage,
           cSrcSlice  = slice.slice,
@@ -2503,6 +2519,11 @@ namespace dxvk {
     m_rtx.PrepareDrawGeometryForRT(false, { PrimitiveType, (INT)StartVertex, 0, 0, 0, PrimitiveCount });
     // NV-DXVK end
 
+    // NV-DXVK start: shadowed geometry buffers
+    if (unlikely(m_trackGeometryTraffic))
+      TrackGeometryTraffic(GetVertexCount(PrimitiveType, PrimitiveCount), 0);
+    // NV-DXVK end
+
     EmitCs([this,
       cPrimType    = PrimitiveType,
       cPrimCount   = PrimitiveCount,
@@ -2546,6 +2567,11 @@ namespace dxvk {
     m_rtx.PrepareDrawGeometryForRT(true, { PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, StartIndex, PrimitiveCount });
     // NV-DXVK end
 
+    // NV-DXVK start: shadowed geometry buffers
+    if (unlikely(m_trackGeometryTraffic))
+      TrackGeometryTraffic(NumVertices, GetVertexCount(PrimitiveType, PrimitiveCount));
+    // NV-DXVK end
+
     EmitCs([this,
       cPrimType        = PrimitiveType,
       cPrimCount       = PrimitiveCount,
@@ -4563,6 +4589,10 @@ namespace dxvk {
       pResource->SetupForRtx();
     }
 
+    // NV-DXVK start: texture alpha range
+    pResource->UpdateRtxAlphaRange(Subresource, srcSlice.mapPtr);
+    // NV-DXVK end
+
     if (likely(convertFormat.FormatType == D3D9ConversionFormat_None)) {
       VkImageSubresourceLayers dstLayers = { VK_IMAGE_ASPECT_COLOR_BIT, subresource.mipLevel, subresource.arrayLayer, 1 };
 
@@ -4708,14 +4738,14 @@ namespace dxvk {
     // We only bounds check for MANAGED.
     // (TODO: Apparently this is meant to happen for DYNAMIC too but I am not sure
     //  how that works given it is meant to be a DIRECT access..?)
-    const bool respectUserBounds = !(Flags & D3DLOCK_DISCARD) &&
-                                    SizeToLock != 0;
-
     // If we don't respect the bounds, encompass it all in our tests/checks
-    // These values may be out of range and don't get clamped.
-    uint32_t offset = respectUserBounds ? OffsetToLock : 0;
-    uint32_t size   = respectUserBounds ? std::min(SizeToLock, desc.Size - offset) : desc.Size;
-    D3D9Range lockRange = D3D9Range(offset, offset + size);
+    // NV-DXVK start: shadowed geometry buffers
+    // Note: Discarding locks of shadowed geometry buffers only dirty the locked range
+    D3D9Range lockRange;
+    GetLockRange(OffsetToLock, SizeToLock, desc.Size, (Flags & D3DLOCK_DISCARD) != 0,
+      pResource->GetGeometryResidency() == D3D9GeometryResidency::Shadowed,
+      lockRange.min, lockRange.max);
+    // NV-DXVK end
 
     if ((desc.Pool == D3DPOOL_DEFAULT || !(Flags & D3DLOCK_NO_DIRTY_UPDATE)) && !(Flags & D3DLOCK_READONLY))
       pResource->DirtyRange().Conjoin(lockRange);
@@ -4823,6 +4853,11 @@ namespace dxvk {
         cLength);
     });
 
+    // NV-DXVK start: shadowed geometry buffers
+    if (unlikely(m_trackGeometryTraffic) && pResource->GetGeometryResidency() == D3D9GeometryResidency::Shadowed)
+      m_geometryTraffic.addUpload(range.max - range.min);
+    // NV-DXVK end
+
     pResource->GPUReadingRange().Conjoin(pResource->DirtyRange());
     pResource->DirtyRange().Clear();
 
@@ -4832,6 +4867,56 @@ namespace dxvk {
   }
 
 
+  // NV-DXVK start: shadowed geometry buffers
+  void D3D9DeviceEx::EnableGeometryTrafficTracking() {
+    D3D9DeviceLock lock = LockDevice();
+
+    // Note: Without host memory for geometry every buffer is device local, so there is nothing to tell apart
+    m_trackGeometryTraffic = m_d3d9Options.hostMemoryForGeometry;
+  }
+
+
+  void D3D9DeviceEx::TrackGeometryTraffic(
+          UINT                    VertexCount,
+          UINT                    IndexCount) {
+    // Note: An estimate, assumes every bound stream is read for every vertex of the draw
+    for (uint32_t i = 0; i < caps::MaxStreams; i++) {
+      const auto& vbo = m_state.vertexBuffers[i];
+      auto* buffer = GetCommonBuffer(vbo.vertexBuffer);
+
+      if (buffer != nullptr)
+        m_geometryTraffic.addDrawRead(buffer->GetGeometryResidency(), uint64_t(VertexCount) * vbo.stride);
+    }
+
+    auto* ibo = GetCommonBuffer(m_state.indices);
+
+    if (IndexCount != 0 && ibo != nullptr) {
+      const uint32_t indexSize = ibo->Desc()->Format == D3D9Format::INDEX32 ? 4 : 2;
+      m_geometryTraffic.addDrawRead(ibo->GetGeometryResidency(), uint64_t(IndexCount) * indexSize);
+    }
+  }
+
+
+  void D3D9DeviceEx::PublishGeometryTraffic() {
+    if (!m_trackGeometryTraffic)
+      return;
+
+    EmitCs([
+      cDevice     = m_dxvkDevice,
+      cHostRead   = m_geometryTraffic.getHostReadBytes(),
+      cDeviceRead = m_geometryTraffic.getDeviceReadBytes(),
+      cUpload     = m_geometryTraffic.getUploadBytes()
+    ] (DxvkContext* ctx) {
+      cDevice->statCounters().setCtr(DxvkStatCounter::D3D9GeometryHostReadBytes, cHostRead);
+      cDevice->statCounters().setCtr(DxvkStatCounter::D3D9GeometryDeviceReadBytes, cDeviceRead);
+      cDevice->statCounters().setCtr(DxvkStatCounter::D3D9GeometryUploadBytes, cUpload);
+    });
+
+    m_geometryTraffic.reset();
+  }
+  // NV-DXVK end
+
+
   HRESULT D3D9DeviceEx::UnlockBuffer(
         D3D9CommonBuffer*       pResource) {
     D3D9DeviceLock lock = LockDevice();
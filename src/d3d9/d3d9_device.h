@@ -29,6 +29,9 @@
 #include <type_traits>
 #include <unordered_map>
 #include "d3d9_rtx.h"
+// NV-DXVK start: shadowed geometry buffers
+#include "d3d9_geometry_residency.h"
+// NV-DXVK end
 
 namespace dxvk {
 
@@ -722,6 +725,16 @@ namespace dxvk {
     HRESULT UnlockBuffer(
             D3D9CommonBuffer*       pResource);
 
+    // NV-DXVK start: shadowed geometry buffers
+    void EnableGeometryTrafficTracking();
+
+    void TrackGeometryTraffic(
+            UINT                    VertexCount,
+            UINT                    IndexCount);
+
+    void PublishGeometryTraffic();
+    // NV-DXVK end
+
     void SetupFPU();
 
     int64_t DetermineInitialTextureMemory();
@@ -1256,6 +1269,12 @@ namespace dxvk {
 
     D3D9Rtx                         m_rtx;
 
+    // NV-DXVK start: shadowed geometry buffers
+    // Note: Only counted while a HUD shows it, and always under the device lock
+    D3D9GeometryTraffic             m_geometryTraffic;
+    bool                            m_trackGeometryTraffic = false;
+    // NV-DXVK end
+
   };
 
 }
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace dxvk {
+
+  /**
+   * \brief Residency of an application geometry buffer
+   *
+   * The RTX capture and hashing paths read application vertex and
+   * index buffers on the CPU, so geometry buffers must be readable
+   * through a host visible mapping.
+   */
+  enum class D3D9GeometryResidency : uint32_t {
+    Default,  ///< Not geometry, or the CPU does not need to read it
+    Host,     ///< Only a host memory copy, read by the GPU over the bus
+    Shadowed, ///< Host memory shadow copy plus a device local copy used for rendering
+  };
+
+  /**
+   * \brief Determines the residency of a buffer
+   *
+   * Buffers which are not directly mapped already write to a host
+   * memory staging buffer which is copied to the real buffer, so
+   * the staging buffer serves as the shadow copy. Static directly
+   * mapped buffers are switched to the same scheme. Dynamic ones
+   * stay in host memory, as they are rewritten every frame and
+   * uploading each of their many small locks would interrupt
+   * render passes.
+   * \param [in] isGeometry Whether the buffer is a vertex or index buffer
+   * \param [in] isDirectMapped Whether the buffer would be directly mapped
+   * \param [in] isDynamic Whether the buffer was created with \c D3DUSAGE_DYNAMIC
+   * \param [in] hostMemoryForGeometry Whether geometry must be CPU readable
+   * \param [in] shadowGeometry Whether shadowed geometry buffers may be used
+   */
+  inline D3D9GeometryResidency DetermineGeometryResidency(
+          bool  isGeometry,
+          bool  isDirectMapped,
+          bool  isDynamic,
+          bool  hostMemoryForGeometry,
+          bool  shadowGeometry) {
+    if (!isGeometry || !hostMemoryForGeometry)
+      return D3D9GeometryResidency::Default;
+
+    if (!shadowGeometry || (isDirectMapped && isDynamic))
+      return D3D9GeometryResidency::Host;
+
+    return D3D9GeometryResidency::Shadowed;
+  }
+
+  /**
+   * \brief Range written by a buffer lock
+   *
+   * Locks which do not respect the user bounds dirty the entire
+   * buffer. A discarding lock of a shadowed buffer starts from a
+   * fresh shadow slice with undefined contents, just like direct
+   * mapped buffers do, so only the locked range has to be copied
+   * to the device local buffer.
+   * \param [in] offsetToLock Lock offset
+   * \param [in] sizeToLock Lock size, 0 locks the entire buffer
+   * \param [in] bufferSize Buffer size
+   * \param [in] discard Whether the lock discards the buffer
+   * \param [in] shadowed Whether the buffer is a shadowed geometry buffer
+   * \param [out] min Start of the written range
+   * \param [out] max End of the written range
+   */
+  inline void GetLockRange(
+          uint32_t  offsetToLock,
+          uint32_t  sizeToLock,
+          uint32_t  bufferSize,
+          bool      discard,
+          bool      shadowed,
+          uint32_t& min,
+          uint32_t& max) {
+    const bool respectUserBounds = (!discard || shadowed) && sizeToLock != 0;
+
+    // These values may be out of range and don't get clamped.
+    min = respectUserBounds ? offsetToLock : 0;
+    max = min + (respectUserBounds ? std::min(sizeToLock, bufferSize - min) : bufferSize);
+  }
+
+  /**
+   * \brief Geometry memory traffic counters
+   *
+   * Estimates the geometry data moved over the bus between host
+   * and device memory. Draws reading host resident buffers fetch
+   * their vertices and indices over the bus every time, while
+   * shadowed buffers only cross it when their shadow is copied to
+   * the device local buffer.
+   */
+  class D3D9GeometryTraffic {
+
+  public:
+
+    /**
+     * \brief Records geometry read by a draw
+     *
+     * \param [in] residency Residency of the buffer
+     * \param [in] bytes Number of bytes read
+     */
+    void addDrawRead(D3D9GeometryResidency residency, uint64_t bytes) {
+      if (residency == D3D9GeometryResidency::Host)
+        m_hostReadBytes += bytes;
+      else
+        m_deviceReadBytes += bytes;
+    }
+
+    /**
+     * \brief Records a shadow copy upload
+     * \param [in] bytes Number of bytes copied
+     */
+    void addUpload(uint64_t bytes) {
+      m_uploadBytes += bytes;
+    }
+
+    /**
+     * \brief Bytes read by draws from host memory
+     */
+    uint64_t getHostReadBytes() const { return m_hostReadBytes; }
+
+    /**
+     * \brief Bytes read by draws from device local memory
+     */
+    uint64_t getDeviceReadBytes() const { return m_deviceReadBytes; }
+
+    /**
+     * \brief Bytes copied from shadow copies to device local memory
+     */
+    uint64_t getUploadBytes() const { return m_uploadBytes; }
+
+    /**
+     * \brief Total geometry traffic over the bus
+     */
+    uint64_t getBusBytes() const {
+      return m_hostReadBytes + m_uploadBytes;
+    }
+
+    /**
+     * \brief Resets all counters
+     */
+    void reset() {
+      m_hostReadBytes = 0;
+      m_deviceReadBytes = 0;
+      m_uploadBytes = 0;
+    }
+
+  private:
+
+    uint64_t m_hostReadBytes   = 0u;
+    uint64_t m_deviceReadBytes = 0u;
+    uint64_t m_uploadBytes     = 0u;
+
+  };
+
+}
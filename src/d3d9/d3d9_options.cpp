@@ -98,6 +98,7 @@ namespace dxvk {
     
     // NV-DXVK start: force app geometry data into host memory
     this->hostMemoryForGeometry = config.getOption<bool>("d3d9.hostMemoryForGeometry", true);
+    this->shadowGeometryBuffers = config.getOption<bool>("d3d9.shadowGeometryBuffers", true);
     // NV-DXVK end
  
     // If we are not Nvidia, enable general hazards.
@@ -189,6 +189,10 @@ namespace dxvk {
     // NV-DXVK start: force app geometry data into host memory
     /// Use host memory for all geometry data (vertex/index).
     bool hostMemoryForGeometry;
+
+    /// Keep a host memory shadow copy of static geometry for the CPU
+    /// and render from a device local copy updated on unlock.
+    bool shadowGeometryBuffers;
     // NV-DXVK end
   };
 
@@ -12,6 +12,7 @@
 #include "../util/util_fastops.h"
 #include "../util/util_math.h"
 #include "d3d9_rtx_utils.h"
+#include "d3d9_rtx_instancing.h"
 #include "d3d9_texture.h"
 
 namespace dxvk {
@@ -82,7 +83,7 @@ namespace dxvk {
     return stagingSlice;
   }
 
-  void D3D9Rtx::prepareVertexCapture(const int vertexIndexOffset, const uint32_t vertexCount) {
+  void D3D9Rtx::prepareVertexCapture(const int vertexIndexOffset, const uint32_t vertexCount, const Matrix4& instanceTransform) {
     // struct {
     //  float4 position;
     //  float4 texcoord0;
@@ -102,9 +103,12 @@ namespace dxvk {
 
     // Bind the latest projection to world matrix...
     // NOTE: May be better to move reverse transformation to end of frame, because this won't work if there hasnt been a FF draw this frame to scrape the matrix from...
+    // Note: Only the first instance of an instanced draw is captured, its instance transform is reversed as well so the
+    //       captured geometry is shared by all instances of the draw.
     const Matrix4& ObjectToProjection = d3d9State().transforms[GetTransformIndex(D3DTS_PROJECTION)] 
                                       * d3d9State().transforms[GetTransformIndex(D3DTS_VIEW)] 
-                                      * d3d9State().transforms[GetTransformIndex(D3DTS_WORLD)];
+                                      * d3d9State().transforms[GetTransformIndex(D3DTS_WORLD)]
+                                      * instanceTransform;
     const Matrix4& vkProjectionToObject = inverse(ObjectToProjection);
 
     m_parent->EmitCs([vkProjectionToObject,
@@ -122,10 +126,10 @@ namespace dxvk {
     });
   }
 
-  void D3D9Rtx::processVertices(const VertexContext vertexContext[caps::MaxStreams], int vertexIndexOffset, uint32_t idealTexcoordIndex, RasterGeometry& geoData) {
+  void D3D9Rtx::processVertices(const VertexContext vertexContext[caps::MaxStreams], int vertexIndexOffset, uint32_t idealTexcoordIndex, const std::vector<Matrix4>& instanceTransforms, RasterGeometry& geoData) {
     // For shader based drawcalls we also want to capture the vertex shader output
     if (likely(m_parent->UseProgrammableVS() && RtxOptions::Get()->isVertexCaptureEnabled())) {
-        prepareVertexCapture(vertexIndexOffset, geoData.vertexCount);
+        prepareVertexCapture(vertexIndexOffset, geoData.vertexCount, instanceTransforms.empty() ? Matrix4() : instanceTransforms[0]);
     }
 
     DxvkBufferSlice streamCopies[caps::MaxStreams] {};
@@ -138,6 +142,10 @@ namespace dxvk {
       if (ctx.buffer.handle == VK_NULL_HANDLE)
         continue;
 
+      // Per-instance data of expanded instanced draws is not indexed by vertex
+      if (!instanceTransforms.empty() && (d3d9State().streamFreq[element.Stream] & D3DSTREAMSOURCE_INSTANCEDATA))
+        continue;
+
       ZoneScopedN("Process Vertices");
       const int32_t vertexOffset = ctx.offset + ctx.stride * vertexIndexOffset;
       const uint32_t numVertexBytes = ctx.stride * geoData.vertexCount;
@@ -198,6 +206,48 @@ namespace dxvk {
     }
   }
 
+  void D3D9Rtx::processInstancing(const VertexContext vertexContext[caps::MaxStreams], RtxGeometryStatus status, std::vector<Matrix4>& instanceTransforms) {
+    uint32_t instancedStreams = 0;
+    for (uint32_t i = 0; i < caps::MaxStreams; i++) {
+      if (d3d9State().streamFreq[i] & D3DSTREAMSOURCE_INSTANCEDATA)
+        instancedStreams |= 1u << i;
+    }
+
+    // Only draws with stream 0 set to indexed data are instanced
+    if (instancedStreams == 0 || (d3d9State().streamFreq[0] & D3DSTREAMSOURCE_INDEXEDDATA) == 0)
+      return;
+
+    if (status != RtxGeometryStatus::RayTraced || !RtxOptions::Get()->instancedDraws.expand() || d3d9State().vertexDecl == nullptr)
+      return;
+
+    // Note: Vertex shader draws are expanded from the vertex capture of their first instance, without it they are ignored
+    if (m_parent->UseProgrammableVS() && !RtxOptions::Get()->isVertexCaptureEnabled())
+      return;
+
+    ZoneScoped;
+
+    const D3D9VertexElements& elements = d3d9State().vertexDecl->GetElements();
+    const D3D9InstanceStreamLayout layout = DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), instancedStreams);
+
+    if (layout.transform == D3D9InstanceTransformLayout::None) {
+      ONCE(Logger::info("[RTX-Compatibility-Info] Instanced draw without a recognized per-instance transform, capturing it as a single object."));
+      return;
+    }
+
+    const VertexContext& ctx = vertexContext[layout.stream];
+    if (ctx.buffer.mapPtr == nullptr || ctx.offset >= ctx.buffer.length)
+      return;
+
+    const uint32_t maxInstances = RtxOptions::Get()->instancedDraws.maxInstances();
+    const uint32_t instanceCount = m_parent->GetInstanceCount();
+    if (instanceCount > maxInstances) {
+      ONCE(Logger::info(str::format("[RTX-Compatibility-Info] Instanced draw with ", instanceCount, " instances exceeds rtx.instancedDraws.maxInstances, only the first ", maxInstances, " are raytraced.")));
+    }
+
+    DecodeInstanceTransforms(layout, (const uint8_t*) ctx.buffer.mapPtr + ctx.offset, ctx.buffer.length - ctx.offset, ctx.stride,
+                             d3d9State().streamFreq[layout.stream] & 0x7FFFFFu, std::min(instanceCount, maxInstances), instanceTransforms);
+  }
+
   uint32_t D3D9Rtx::processRenderState() {
     if (m_flags.test(D3D9RtxFlag::DirtyObjectTransform)) {
       m_flags.clr(D3D9RtxFlag::DirtyObjectTransform);
@@ -409,13 +459,18 @@ namespace dxvk {
     // Fetch all the render state and send it to rtx context (textures, transforms, etc.)
     const uint32_t idealTexcoordIndex = processRenderState();
 
+    // Decode the per-instance transforms of instanced draws, to capture the geometry once and expand it into instances sharing it
+    std::vector<Matrix4> instanceTransforms;
+    processInstancing(vertexContext, status, instanceTransforms);
+
     // Copy all the vertices into a staging buffer.  Assign fields of the geoData structure.
-    processVertices(vertexContext, vertexIndexOffset, idealTexcoordIndex, geoData);
+    processVertices(vertexContext, vertexIndexOffset, idealTexcoordIndex, instanceTransforms, geoData);
     geoData.futureGeometryHashes = computeHash(geoData, (maxIndex - minIndex));
     std::shared_future<SkinningData> futureSkinningData = processSkinning(geoData);
 
     // Send it
     m_parent->EmitCs([geoData, futureSkinningData, legacyState, status,
+                      cInstanceTransforms = std::move(instanceTransforms),
                       cUseVS = m_parent->UseProgrammableVS(),
                       cUsePS = m_parent->UseProgrammablePS()](DxvkContext* ctx) {
       assert(dynamic_cast<RtxContext*>(ctx));
@@ -424,6 +479,7 @@ namespace dxvk {
       rtxCtx->setShaderState(cUseVS, cUsePS);
       rtxCtx->setLegacyState(legacyState);
       rtxCtx->setGeometry(geoData, status);
+      rtxCtx->setInstanceTransforms(cInstanceTransforms);
       rtxCtx->setSkinningData(futureSkinningData);
     });
   }
@@ -155,9 +155,11 @@ namespace dxvk {
     template<typename T>
     DxvkBufferSlice processIndexBuffer(const uint32_t indexCount, const uint32_t startIndex, const DxvkBufferSliceHandle& indexSlice, uint32_t& minIndex, uint32_t& maxIndex);
 
-    void prepareVertexCapture(const int vertexIndexOffset, const uint32_t vertexCount);
+    void prepareVertexCapture(const int vertexIndexOffset, const uint32_t vertexCount, const Matrix4& instanceTransform);
 
-    void processVertices(const VertexContext vertexContext[caps::MaxStreams], int vertexIndexOffset, uint32_t idealTexcoordIndex, RasterGeometry& geoData);
+    void processVertices(const VertexContext vertexContext[caps::MaxStreams], int vertexIndexOffset, uint32_t idealTexcoordIndex, const std::vector<Matrix4>& instanceTransforms, RasterGeometry& geoData);
+
+    void processInstancing(const VertexContext vertexContext[caps::MaxStreams], RtxGeometryStatus status, std::vector<Matrix4>& instanceTransforms);
 
     uint32_t processRenderState();
 
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <d3d9types.h>
+
+#include "../util/util_matrix.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Layout of the per-instance transform in an instance stream
+   *
+   * D3D9 has no notion of an instance transform, instanced vertex
+   * shaders read it from per-instance vertex elements. These are the
+   * layouts commonly used for it.
+   */
+  enum class D3D9InstanceTransformLayout : uint32_t {
+    None,        ///< No per-instance transform found
+    Rows3x4,     ///< Three float4 rows of an affine matrix, each dotted with the position
+    Matrix4x4,   ///< Four float4 rows of a matrix in the layout passed to SetTransform
+    Translation, ///< float3 position offset, or float4 offset with a uniform scale in w
+  };
+
+  /**
+   * \brief Location of the per-instance transform
+   */
+  struct D3D9InstanceStreamLayout {
+    D3D9InstanceTransformLayout transform = D3D9InstanceTransformLayout::None;
+    uint32_t stream = 0;                   ///< Vertex stream holding the instance data
+    uint32_t offset = 0;                   ///< Offset of the transform within an instance element
+    uint32_t type   = D3DDECLTYPE_UNUSED;  ///< Declaration type of a translation
+  };
+
+  /**
+   * \brief Finds the per-instance transform in a vertex declaration
+   *
+   * Consecutive float4 texcoords with consecutive offsets in an
+   * instanced stream are taken as matrix rows, three of them as an
+   * affine 3x4 matrix and four as a full matrix. Failing that, a
+   * float3 or float4 position in an instanced stream is taken as a
+   * translation. Any other instance data is left alone.
+   * \param [in] elements Vertex declaration elements
+   * \param [in] elementCount Number of elements, an end marker also ends the list
+   * \param [in] instancedStreams Mask of streams with per-instance data
+   * \returns Location of the transform, layout \c None if there is none
+   */
+  inline D3D9InstanceStreamLayout DetectInstanceStreamLayout(
+    const D3DVERTEXELEMENT9* elements,
+          uint32_t           elementCount,
+          uint32_t           instancedStreams) {
+    auto isInstanced = [&](const D3DVERTEXELEMENT9& element) {
+      return element.Stream < 32 && (instancedStreams & (1u << element.Stream)) != 0;
+    };
+
+    auto isRow = [&](const D3DVERTEXELEMENT9& element) {
+      return isInstanced(element) && element.Usage == D3DDECLUSAGE_TEXCOORD && element.Type == D3DDECLTYPE_FLOAT4;
+    };
+
+    auto findRow = [&](const D3DVERTEXELEMENT9& first, uint32_t row) -> bool {
+      for (uint32_t i = 0; i < elementCount && elements[i].Stream != 0xFF; i++) {
+        const D3DVERTEXELEMENT9& element = elements[i];
+
+        if (isRow(element) && element.Stream == first.Stream &&
+            element.UsageIndex == first.UsageIndex + row &&
+            element.Offset == first.Offset + row * 4 * sizeof(float))
+          return true;
+      }
+
+      return false;
+    };
+
+    D3D9InstanceStreamLayout layout;
+    uint32_t rowCount = 0;
+
+    for (uint32_t i = 0; i < elementCount && elements[i].Stream != 0xFF; i++) {
+      const D3DVERTEXELEMENT9& element = elements[i];
+
+      if (!isRow(element))
+        continue;
+
+      // The longest run wins, the first one on a tie
+      uint32_t count = 1;
+      while (count < 4 && findRow(element, count))
+        count++;
+
+      if (count >= 3 && count > rowCount) {
+        rowCount = count;
+        layout.transform = count == 4 ? D3D9InstanceTransformLayout::Matrix4x4 : D3D9InstanceTransformLayout::Rows3x4;
+        layout.stream = element.Stream;
+        layout.offset = element.Offset;
+        layout.type = element.Type;
+      }
+    }
+
+    if (layout.transform != D3D9InstanceTransformLayout::None)
+      return layout;
+
+    for (uint32_t i = 0; i < elementCount && elements[i].Stream != 0xFF; i++) {
+      const D3DVERTEXELEMENT9& element = elements[i];
+
+      if (isInstanced(element) && element.Usage == D3DDECLUSAGE_POSITION &&
+          (element.Type == D3DDECLTYPE_FLOAT3 || element.Type == D3DDECLTYPE_FLOAT4)) {
+        layout.transform = D3D9InstanceTransformLayout::Translation;
+        layout.stream = element.Stream;
+        layout.offset = element.Offset;
+        layout.type = element.Type;
+        break;
+      }
+    }
+
+    return layout;
+  }
+
+  /**
+   * \brief Decodes per-instance transforms from an instance stream
+   *
+   * Instance \c i reads the instance element \c i / \c divisor, as
+   * set up with \c SetStreamSourceFreq. Decoding stops at the first
+   * instance whose data lies outside of the stream.
+   * \param [in] layout Location of the transform
+   * \param [in] data Instance stream data, starting at the stream offset
+   * \param [in] size Size of the instance stream data in bytes
+   * \param [in] stride Stride of the instance stream
+   * \param [in] divisor Number of instances sharing one instance element
+   * \param [in] instanceCount Number of instances drawn
+   * \param [out] transforms Object to world transform of each instance
+   * \returns Number of instances decoded
+   */
+  inline uint32_t DecodeInstanceTransforms(
+    const D3D9InstanceStreamLayout& layout,
+    const uint8_t*                  data,
+          size_t                    size,
+          uint32_t                  stride,
+          uint32_t                  divisor,
+          uint32_t                  instanceCount,
+          std::vector<Matrix4>&     transforms) {
+    transforms.clear();
+
+    uint32_t floatCount = 0;
+    switch (layout.transform) {
+    case D3D9InstanceTransformLayout::Rows3x4:     floatCount = 12; break;
+    case D3D9InstanceTransformLayout::Matrix4x4:   floatCount = 16; break;
+    case D3D9InstanceTransformLayout::Translation: floatCount = layout.type == D3DDECLTYPE_FLOAT4 ? 4 : 3; break;
+    case D3D9InstanceTransformLayout::None:        return 0;
+    }
+
+    divisor = divisor != 0 ? divisor : 1;
+    transforms.reserve(instanceCount);
+
+    for (uint32_t i = 0; i < instanceCount; i++) {
+      const size_t elementOffset = size_t(i / divisor) * stride + layout.offset;
+
+      if (elementOffset + floatCount * sizeof(float) > size)
+        break;
+
+      // Instance data is not necessarily aligned
+      float v[16] = { };
+      std::memcpy(v, data + elementOffset, floatCount * sizeof(float));
+
+      switch (layout.transform) {
+      case D3D9InstanceTransformLayout::Rows3x4:
+        transforms.emplace_back(
+          Vector4 { v[0], v[4], v[8],  0.0f },
+          Vector4 { v[1], v[5], v[9],  0.0f },
+          Vector4 { v[2], v[6], v[10], 0.0f },
+          Vector4 { v[3], v[7], v[11], 1.0f });
+        break;
+
+      case D3D9InstanceTransformLayout::Matrix4x4:
+        transforms.emplace_back(
+          Vector4 { v[0],  v[1],  v[2],  v[3]  },
+          Vector4 { v[4],  v[5],  v[6],  v[7]  },
+          Vector4 { v[8],  v[9],  v[10], v[11] },
+          Vector4 { v[12], v[13], v[14], v[15] });
+        break;
+
+      case D3D9InstanceTransformLayout::Translation: {
+        // A zero w is an offset without a scale
+        const float scale = (floatCount == 4 && v[3] != 0.0f) ? v[3] : 1.0f;
+
+        transforms.emplace_back(
+          Vector4 { scale, 0.0f,  0.0f,  0.0f },
+          Vector4 { 0.0f,  scale, 0.0f,  0.0f },
+          Vector4 { 0.0f,  0.0f,  scale, 0.0f },
+          Vector4 { v[0],  v[1],  v[2],  1.0f });
+        break;
+      }
+
+      case D3D9InstanceTransformLayout::None:
+        break;
+      }
+    }
+
+    return uint32_t(transforms.size());
+  }
+
+  /**
+   * \brief Places an instance of an instanced draw in the world
+   *
+   * Instance transforms place the geometry within the object space
+   * of the draw, so they apply before its own object to world transform.
+   * \param [in] objectToWorld Object to world transform of the draw
+   * \param [in] instanceTransform Decoded transform of the instance
+   * \returns Object to world transform of the instance
+   */
+  inline Matrix4 GetInstanceObjectToWorld(
+    const Matrix4& objectToWorld,
+    const Matrix4& instanceTransform) {
+    return objectToWorld * instanceTransform;
+  }
+
+}
@@ -357,6 +357,10 @@ namespace dxvk {
 
     D3D9DeviceLock lock = m_parent->LockDevice();
 
+    // NV-DXVK start: shadowed geometry buffers
+    m_parent->PublishGeometryTraffic();
+    // NV-DXVK end
+
     uint32_t presentInterval = m_presentParams.PresentationInterval;
 
     // This is not true directly in d3d9 to to timing differences that don't matter for us.
@@ -1257,6 +1261,12 @@ namespace dxvk {
     if (m_hud != nullptr) {
       m_hud->addItem<hud::HudClientApiItem>("api", 1, GetApiName());
       m_hud->addItem<hud::HudSamplerCount>("samplers", -1, m_parent);
+
+      // NV-DXVK start: shadowed geometry buffers
+      // Note: The geometry traffic is only shown by the RTX item, so it is not counted otherwise
+      if (m_hud->isItemEnabled("rtx"))
+        m_parent->EnableGeometryTrafficTracking();
+      // NV-DXVK end
     }
   }
 
@@ -3484,9 +3484,20 @@ void DxsoCompiler::emitControlFlowGenericLoop(
     };
 
     const uint32_t vertexId = emitNewBuiltinVariable(vertexIdReg, spv::BuiltInVertexIndex, "uVertexId", 0);
+    const uint32_t instanceId = emitNewBuiltinVariable(vertexIdReg, spv::BuiltInInstanceIndex, "uInstanceId", 0);
 
     const uint32_t uintType = getScalarTypeId(DxsoScalarType::Uint32);
 
+    // Only the first instance of an instanced draw is captured, the instances share its geometry
+    const uint32_t captureLabel = m_module.allocateId();
+    const uint32_t endLabel = m_module.allocateId();
+
+    const uint32_t isFirstInstance = m_module.opIEqual(m_module.defBoolType(), m_module.opLoad(uintType, instanceId), m_module.constu32(0));
+
+    m_module.opSelectionMerge(endLabel, spv::SelectionControlMaskNone);
+    m_module.opBranchConditional(isFirstInstance, captureLabel, endLabel);
+    m_module.opLabel(captureLabel);
+
     const uint32_t uVertexIdVal = m_module.opLoad(uintType, vertexId);
     const uint32_t baseVertexRefId = LoadConstant(uintType, (uint32_t)(D3D9RenderStateItem::BaseVertex));
 
@@ -3522,6 +3533,9 @@ void DxsoCompiler::emitControlFlowGenericLoop(
       // Write texcoord
       m_module.opImageWrite(imageId, writeAddress, texcoord0, defaultOperands);
     }
+
+    m_module.opBranch(endLabel);
+    m_module.opLabel(endLabel);
   }
 
   void DxsoCompiler::emitLinkerOutputSetup() {
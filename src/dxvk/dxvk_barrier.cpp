@@ -63,6 +63,12 @@ namespace dxvk {
 
     assert(dstLayout != VK_IMAGE_LAYOUT_UNDEFINED);
 
+    // NV-DXVK start: static scene detection
+    // Note: Barriers after transfer and compute writes carry the write in their source access
+    if (access.test(DxvkAccess::Write))
+      image->markWritten();
+    // NV-DXVK end
+
     if (srcStages == VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
      || dstStages == VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
      || srcLayout != dstLayout)
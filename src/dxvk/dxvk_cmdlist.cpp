@@ -14,14 +14,6 @@ namespace dxvk {
     const auto& graphicsQueue = m_device->queues().graphics;
     const auto& transferQueue = m_device->queues().transfer;
 
-    VkFenceCreateInfo fenceInfo;
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.pNext = nullptr;
-    fenceInfo.flags = 0;
-    
-    if (m_vkd->vkCreateFence(m_vkd->device(), &fenceInfo, nullptr, &m_fence) != VK_SUCCESS)
-      throw DxvkError("DxvkCommandList: Failed to create fence");
-    
     VkCommandPoolCreateInfo poolInfo;
     poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.pNext            = nullptr;
@@ -76,14 +68,14 @@ namespace dxvk {
     
     m_vkd->vkDestroyCommandPool(m_vkd->device(), m_graphicsPool, nullptr);
     m_vkd->vkDestroyCommandPool(m_vkd->device(), m_transferPool, nullptr);
-    
-    m_vkd->vkDestroyFence(m_vkd->device(), m_fence, nullptr);
   }
   
   
   VkResult DxvkCommandList::submit(
           VkSemaphore     waitSemaphore,
-          VkSemaphore     wakeSemaphore) {
+          VkSemaphore     wakeSemaphore,
+          VkSemaphore     timelineSemaphore,
+          uint64_t        timelineValue) {
     const auto& graphics = m_device->queues().graphics;
     const auto& transfer = m_device->queues().transfer;
 
@@ -94,7 +86,7 @@ namespace dxvk {
 
       if (m_device->hasDedicatedTransferQueue()) {
         info.wakeSync[info.wakeCount++] = m_sdmaSemaphore;
-        VkResult status = submitToQueue(transfer.queueHandle, VK_NULL_HANDLE, info);
+        VkResult status = submitToQueue(transfer.queueHandle, info);
 
         if (status != VK_SUCCESS)
           return status;
@@ -120,21 +112,13 @@ namespace dxvk {
     if (wakeSemaphore)
       info.wakeSync[info.wakeCount++] = wakeSemaphore;
     
-    return submitToQueue(graphics.queueHandle, m_fence, info);
-  }
-  
-  
-  VkResult DxvkCommandList::synchronize() {
-    ZoneScoped;
-    VkResult status = VK_TIMEOUT;
-    
-    while (status == VK_TIMEOUT) {
-      status = m_vkd->vkWaitForFences(
-        m_vkd->device(), 1, &m_fence, VK_FALSE,
-        1'000'000'000ull);
-    }
-    
-    return status;
+    // NV-DXVK start: timeline semaphore submission tracking
+    info.wakeSync[info.wakeCount] = timelineSemaphore;
+    info.wakeValue[info.wakeCount] = timelineValue;
+    info.wakeCount += 1;
+
+    return submitToQueue(graphics.queueHandle, info);
+    // NV-DXVK end
   }
   
   
@@ -154,9 +138,6 @@ namespace dxvk {
      || m_vkd->vkBeginCommandBuffer(m_sdmaBuffer, &info) != VK_SUCCESS)
       Logger::err("DxvkCommandList: Failed to begin command buffer");
     
-    if (m_vkd->vkResetFences(m_vkd->device(), 1, &m_fence) != VK_SUCCESS)
-      Logger::err("DxvkCommandList: Failed to reset fence");
-    
     // Unconditionally mark the exec buffer as used. There
     // is virtually no use case where this isn't correct.
     m_cmdBuffersUsed = DxvkCmdBuffer::ExecBuffer;
@@ -196,11 +177,21 @@ namespace dxvk {
 
   VkResult DxvkCommandList::submitToQueue(
           VkQueue               queue,
-          VkFence               fence,
     const DxvkQueueSubmission&  info) {
+    // NV-DXVK start: timeline semaphore submission tracking
+    // Note: values for binary semaphores are ignored
+    VkTimelineSemaphoreSubmitInfo timelineInfo;
+    timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.pNext                     = nullptr;
+    timelineInfo.waitSemaphoreValueCount   = 0;
+    timelineInfo.pWaitSemaphoreValues      = nullptr;
+    timelineInfo.signalSemaphoreValueCount = info.wakeCount;
+    timelineInfo.pSignalSemaphoreValues    = info.wakeValue;
+    // NV-DXVK end
+
     VkSubmitInfo submitInfo;
     submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext                = nullptr;
+    submitInfo.pNext                = &timelineInfo;
     submitInfo.waitSemaphoreCount   = info.waitCount;
     submitInfo.pWaitSemaphores      = info.waitSync;
     submitInfo.pWaitDstStageMask    = info.waitMask;
@@ -209,7 +200,7 @@ namespace dxvk {
     submitInfo.signalSemaphoreCount = info.wakeCount;
     submitInfo.pSignalSemaphores    = info.wakeSync;
     
-    return m_vkd->vkQueueSubmit(queue, 1, &submitInfo, fence);
+    return m_vkd->vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
   }
   
   void DxvkCommandList::cmdBeginDebugUtilsLabel(VkDebugUtilsLabelEXT *pLabelInfo) {
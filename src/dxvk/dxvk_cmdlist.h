@@ -64,6 +64,9 @@ namespace dxvk {
     VkPipelineStageFlags  waitMask[2];
     uint32_t              wakeCount;
     VkSemaphore           wakeSync[2];
+    // NV-DXVK start: timeline semaphore submission tracking
+    uint64_t              wakeValue[2];
+    // NV-DXVK end
     uint32_t              cmdBufferCount;
     VkCommandBuffer       cmdBuffers[4];
   };
@@ -84,26 +87,25 @@ namespace dxvk {
     DxvkCommandList(DxvkDevice* device);
     ~DxvkCommandList();
     
+    // NV-DXVK start: timeline semaphore submission tracking
     /**
      * \brief Submits command list
      * 
-     * \param [in] queue Device queue
+     * Completion is tracked by the submission queue through
+     * the timeline semaphore, which the submission signals
+     * with the given value once it has finished executing.
      * \param [in] waitSemaphore Semaphore to wait on
      * \param [in] wakeSemaphore Semaphore to signal
+     * \param [in] timelineSemaphore Submission timeline semaphore
+     * \param [in] timelineValue Value to signal on completion
      * \returns Submission status
      */
     VkResult submit(
             VkSemaphore     waitSemaphore,
-            VkSemaphore     wakeSemaphore);
-    
-    /**
-     * \brief Synchronizes command buffer execution
-     * 
-     * Waits for the fence associated with
-     * this command buffer to get signaled.
-     * \returns Synchronization status
-     */
-    VkResult synchronize();
+            VkSemaphore     wakeSemaphore,
+            VkSemaphore     timelineSemaphore,
+            uint64_t        timelineValue);
+    // NV-DXVK end
     
     /**
      * \brief Stat counters
@@ -886,8 +888,6 @@ namespace dxvk {
     Rc<vk::DeviceFn>    m_vkd;
     Rc<vk::InstanceFn>  m_vki;
     
-    VkFence             m_fence;
-    
     VkCommandPool       m_graphicsPool = VK_NULL_HANDLE;
     VkCommandPool       m_transferPool = VK_NULL_HANDLE;
     
@@ -908,7 +908,6 @@ namespace dxvk {
 
     VkResult submitToQueue(
             VkQueue               queue,
-            VkFence               fence,
       const DxvkQueueSubmission&  info);
     
   };
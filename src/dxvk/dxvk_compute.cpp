@@ -63,12 +63,21 @@ namespace dxvk {
 
       instance = this->findInstance(state);
 
-      if (instance)
+      // NV-DXVK start: state cache last use tracking
+      // Pipelines compiled ahead of time from the state cache
+      // are passed on to the cache once on their first use
+      if (instance && !instance->markUsed())
         return instance->pipeline();
     
       // If no pipeline instance exists with the given state
       // vector, create a new one and add it to the list.
-      instance = this->createInstance(state);
+      if (!instance) {
+        instance = this->createInstance(state);
+
+        if (instance)
+          instance->markUsed();
+      }
+      // NV-DXVK end
     }
     
     if (!instance)
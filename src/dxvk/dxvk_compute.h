@@ -67,10 +67,23 @@ namespace dxvk {
       return m_pipeline;
     }
 
+    // NV-DXVK start: state cache last use tracking
+    /**
+     * \brief Marks the pipeline as used
+     * \returns \c true on the first call
+     */
+    bool markUsed() {
+      return !std::exchange(m_used, true);
+    }
+    // NV-DXVK end
+
   private:
 
     DxvkComputePipelineStateInfo m_stateVector;
     VkPipeline                   m_pipeline;
+    // NV-DXVK start: state cache last use tracking
+    bool                         m_used = false;
+    // NV-DXVK end
 
   };
   
@@ -49,6 +49,14 @@ namespace dxvk {
     // Init framebuffer info with default render pass in case
     // the app does not explicitly bind any render targets
     m_state.om.framebufferInfo = makeFramebufferInfo(m_state.om.renderTargets);
+
+    // NV-DXVK start: work-based early submission
+    DxvkSubmitBudgetLimits submitLimits;
+    submitLimits.copyBytes = m_device->config().memcpyKickoffThreshold;
+    submitLimits.accelStructBuilds = m_device->config().accelStructKickoffThreshold;
+    submitLimits.dispatches = m_device->config().dispatchKickoffThreshold;
+    m_submitBudget.setLimits(submitLimits);
+    // NV-DXVK end
   }
 
 
@@ -61,6 +69,10 @@ namespace dxvk {
     m_cmd = cmdList;
     m_cmd->beginRecording();
 
+    // NV-DXVK start: work-based early submission
+    m_submitBudget.reset();
+    // NV-DXVK end
+
     // Mark all resources as untracked
     m_vbTracked.clear();
     m_rcTracked.clear();
@@ -117,10 +129,6 @@ namespace dxvk {
 
     this->beginRecording(
       m_device->createCommandList());
-
-    // NV-DXVK start: early submit heuristics for memcpy work
-    m_bytesCopiedInCurrentCmdlist = 0;
-    // NV-DXVK end
   }
 
 
@@ -791,10 +799,6 @@ namespace dxvk {
     else {
       this->copyBuffer(dstBuffer, dstOffset, dstBuffer, srcOffset, numBytes);
     }
-
-    // NV-DXVK start: early submit heuristics for memcpy work    
-    recordGPUMemCopy(numBytes);
-    // NV-DXVK end
   }
 
 
@@ -1561,6 +1565,10 @@ namespace dxvk {
     }
 
     m_cmd->addStatCtr(DxvkStatCounter::CmdDispatchCalls, 1);
+
+    // NV-DXVK start: work-based early submission
+    m_submitBudget.recordDispatch();
+    // NV-DXVK end
   }
 
 
@@ -1597,6 +1605,10 @@ namespace dxvk {
     }
 
     m_cmd->addStatCtr(DxvkStatCounter::CmdDispatchCalls, 1);
+
+    // NV-DXVK start: work-based early submission
+    m_submitBudget.recordDispatch();
+    // NV-DXVK end
   }
 
   void DxvkContext::draw(
@@ -2917,15 +2929,10 @@ namespace dxvk {
   // NV-DXVK start: early submit heuristics for memcpy work
   void DxvkContext::recordGPUMemCopy(uint32_t bytes)
   {
-    // XXX TODO - this early submit logic is disabled because it results in missing geometry.
-    return;
-
-    m_bytesCopiedInCurrentCmdlist += bytes;
-
-    const uint32_t threshold = m_device->config().memcpyKickoffThreshold;
-    if (threshold > 0 && bytes >= threshold) {
-      flushCommandList();
-    }
+    // Note: Never flush from here, copies are recorded in the middle of other operations
+    // (e.g. while pending draw calls are processed) which may still hold on to m_cmd.
+    // The submission happens at the next safe point, see flushCommandListIfNeeded().
+    m_submitBudget.recordCopy(bytes);
   }
   // NV-DXVK end
 
@@ -4173,6 +4180,13 @@ namespace dxvk {
       m_flags.set(DxvkContextFlag::GpRenderPassBound);
       m_flags.clr(DxvkContextFlag::GpRenderPassSuspended);
 
+      // NV-DXVK start: static scene detection
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+        if (m_state.om.renderTargets.color[i].view != nullptr)
+          m_state.om.renderTargets.color[i].view->image()->markWritten();
+      }
+      // NV-DXVK end
+
       m_execBarriers.recordCommands(m_cmd);
 
       this->renderPassBindFramebuffer(
@@ -5748,6 +5762,10 @@ namespace dxvk {
     }
 
     m_cmd->addStatCtr(DxvkStatCounter::CmdTraceRaysCalls, 1);
+
+    // NV-DXVK start: work-based early submission
+    m_submitBudget.recordDispatch();
+    // NV-DXVK end
   }
 
 
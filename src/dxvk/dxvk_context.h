@@ -26,6 +26,9 @@
 #include "dxvk_cmdlist.h"
 #include "dxvk_context_state.h"
 #include "dxvk_data.h"
+// NV-DXVK start: work-based early submission
+#include "dxvk_submit_budget.h"
+// NV-DXVK end
 #include <optional>
 
 namespace dxvk {
@@ -78,6 +81,22 @@ namespace dxvk {
      * buffer and allocates a new one.
      */
     virtual void flushCommandList();
+
+    // NV-DXVK start: work-based early submission
+    /**
+     * \brief Flushes command buffer if enough work was recorded
+     *
+     * Submits the current command buffer once the amount of
+     * recorded transfers, acceleration structure builds or
+     * dispatches exceeds the configured budget. Must only be
+     * called between commands, when no context operation
+     * is in progress.
+     */
+    void flushCommandListIfNeeded() {
+      if (unlikely(m_submitBudget.isExhausted()))
+        this->flushCommandList();
+    }
+    // NV-DXVK end
     
     /**
      * \brief Begins generating query data
@@ -1110,6 +1129,9 @@ namespace dxvk {
 		const VkAccelerationStructureBuildRangeInfoKHR* const* ppBuildRangeInfos)
 	{
 		m_cmd->vkCmdBuildAccelerationStructuresKHR(infoCount, pInfos, ppBuildRangeInfos);
+		// NV-DXVK start: work-based early submission
+		m_submitBudget.recordAccelStructBuilds(infoCount);
+		// NV-DXVK end
 	}
 
 	void vkCmdBuildAccelerationStructuresIndirectKHR(
@@ -1120,6 +1142,9 @@ namespace dxvk {
 		const uint32_t* const* ppMaxPrimitiveCounts)
 	{
 		m_cmd->vkCmdBuildAccelerationStructuresIndirectKHR( infoCount, pInfos, pIndirectDeviceAddresses, pIndirectStrides, ppMaxPrimitiveCounts);
+		// NV-DXVK start: work-based early submission
+		m_submitBudget.recordAccelStructBuilds(infoCount);
+		// NV-DXVK end
 	}
 
 	void vkCmdCopyAccelerationStructureKHR(
@@ -1257,12 +1282,11 @@ namespace dxvk {
 
     // NV-DXVK start: early submit heuristics for memcpy work
 
-    // track the amount of memory copies being submitted to the current command list
-    // we apply a heuristic to determine whether to submit early based on this value
-    uint32_t m_bytesCopiedInCurrentCmdlist = 0;
+    // track the amount of work being submitted to the current command list,
+    // the command list is submitted early at the next safe point once it runs out
+    DxvkSubmitBudget m_submitBudget;
 
     // records a memory copy being written to the current command list
-    // may flush if heuristic decides it's time
     void recordGPUMemCopy(uint32_t bytes);
 
     // NV-DXVK end
@@ -1,4 +1,5 @@
 #include "dxvk_cs.h"
+#include "../util/util_thread_placement.h"
 #include "../tracy/Tracy.hpp"
 #include "../tracy/TracyC.h"
 
@@ -30,6 +31,10 @@ namespace dxvk {
         cmd->exec(ctx);
         cmd->~DxvkCsCmd();
         cmd = next;
+
+        // NV-DXVK start: work-based early submission
+        ctx->flushCommandListIfNeeded();
+        // NV-DXVK end
       }
 
       m_head = nullptr;
@@ -38,6 +43,10 @@ namespace dxvk {
       while (cmd != nullptr) {
         cmd->exec(ctx);
         cmd = cmd->next();
+
+        // NV-DXVK start: work-based early submission
+        ctx->flushCommandListIfNeeded();
+        // NV-DXVK end
       }
     }
   }
@@ -140,6 +149,9 @@ namespace dxvk {
     ZoneScoped;
 
     env::setThreadName("dxvk-cs");
+    // NV-DXVK start: topology-aware thread placement
+    ThreadPlacementService::get().applyToCurrentThread(ThreadRole::Render);
+    // NV-DXVK end
 
     DxvkCsChunkRef chunk;
 
@@ -69,10 +69,19 @@ namespace dxvk {
     
       instance = this->findInstance(state, renderPass);
       
-      if (instance)
+      // NV-DXVK start: state cache last use tracking
+      // Pipelines compiled ahead of time from the state cache
+      // are passed on to the cache once on their first use
+      if (instance && !instance->markUsed())
         return instance->pipeline();
-      
-      instance = this->createInstance(state, renderPass);
+
+      if (!instance) {
+        instance = this->createInstance(state, renderPass);
+
+        if (instance)
+          instance->markUsed();
+      }
+      // NV-DXVK end
     }
     
     if (!instance)
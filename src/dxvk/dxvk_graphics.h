@@ -113,11 +113,24 @@ namespace dxvk {
       return m_pipeline;
     }
 
+    // NV-DXVK start: state cache last use tracking
+    /**
+     * \brief Marks the pipeline as used
+     * \returns \c true on the first call
+     */
+    bool markUsed() {
+      return !std::exchange(m_used, true);
+    }
+    // NV-DXVK end
+
   private:
 
     DxvkGraphicsPipelineStateInfo m_stateVector;
     const DxvkRenderPass*         m_renderPass;
     VkPipeline                    m_pipeline;
+    // NV-DXVK start: state cache last use tracking
+    bool                          m_used = false;
+    // NV-DXVK end
 
   };
 
@@ -7,6 +7,7 @@
 #include "dxvk_util.h"
 #include "../util/xxHash/xxhash.h"
 #include "dxvk_hash.h"
+#include "rtx_render/rtx_texture_alpha.h"
 
 namespace dxvk {
 
@@ -347,6 +348,45 @@ namespace dxvk {
       return m_hash;
     }
 
+    /**
+     * \brief Records a write to the image contents
+     *
+     * Called by contexts recording a write, so that content
+     * changes which keep the hash of the image can be seen.
+     */
+    void markWritten() {
+      m_writeGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Number of writes recorded to the image contents
+     * \returns Write generation, changes whenever the contents do
+     */
+    uint32_t getWriteGeneration() const {
+      return m_writeGeneration.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Sets the range of alpha values of the image contents
+     *
+     * Set by the owner of the image when it knows the data
+     * uploaded to it. Readers may be on another thread, so
+     * the range is stored as a single value.
+     * \param [in] range Alpha range
+     */
+    void setAlphaRange(const TextureAlphaRange& range) {
+      m_alphaRange.store(uint32_t(range.minAlpha) | (uint32_t(range.maxAlpha) << 8) | (uint32_t(range.isKnown) << 16));
+    }
+
+    /**
+     * \brief Range of alpha values of the image contents
+     * \returns The alpha range, unknown if never set
+     */
+    TextureAlphaRange getAlphaRange() const {
+      const uint32_t packed = m_alphaRange.load();
+      return TextureAlphaRange { uint8_t(packed), uint8_t(packed >> 8), (packed >> 16) != 0 };
+    }
+
     VkDeviceMemory getMemory() const {
       return m_image.memory.memory();
     }
@@ -373,6 +413,8 @@ namespace dxvk {
     VkMemoryPropertyFlags m_memFlags;
     DxvkPhysicalImage     m_image;
     XXH64_hash_t          m_hash = 0;
+    std::atomic<uint32_t> m_alphaRange = { 0u };
+    std::atomic<uint32_t> m_writeGeneration = { 0u };
     small_vector<VkFormat, 4> m_viewFormats;
     
   };
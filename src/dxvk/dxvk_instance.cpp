@@ -41,6 +41,7 @@
 
 #include "../util/util_env.h"
 #include "../util/util_string.h"
+#include "../util/util_thread_placement.h"
 // NV-DXVK end
 
 // NV-DXVK start: RTXIO
@@ -263,6 +264,17 @@ namespace dxvk {
 
     m_options = DxvkOptions(m_config);
 
+    // NV-DXVK start: topology-aware thread placement
+    // Configured before any of the runtime's threads are spawned, they apply their placement on startup
+    ThreadPlacementPolicy threadPlacementPolicy;
+    threadPlacementPolicy.mode = ThreadPlacementPolicy::parseMode(m_options.threadPlacement);
+    threadPlacementPolicy.reserveMainThreadCore = m_options.threadPlacementReserveMainCore;
+    ThreadPlacementService::get().configure(CpuTopology::query(), threadPlacementPolicy);
+
+    for (const std::string& line : str::split(ThreadPlacementService::get().report(), '\n'))
+      Logger::info(line);
+    // NV-DXVK end
+
     RtxOptions::Create(m_config);
 
     m_extProviders.push_back(&DxvkPlatformExts::s_instance);
@@ -33,6 +33,11 @@ namespace dxvk {
     shrinkNvidiaHvvHeap   = config.getOption<Tristate>("dxvk.shrinkNvidiaHvvHeap",    Tristate::Auto);
     hud                   = config.getOption<std::string>("dxvk.hud", "");
 
+    // NV-DXVK start: indexed state cache file
+    stateCacheCompactInterval = config.getOption<uint32_t>("dxvk.stateCacheCompactInterval", 8);
+    stateCacheMaxUnusedSessions = config.getOption<uint32_t>("dxvk.stateCacheMaxUnusedSessions", 0);
+    // NV-DXVK end
+
     // NV-DXVK start: Integrate Aftermath
     enableAftermath = config.getOption<bool>("dxvk.enableAftermath", false);
     enableAftermathResourceTracking = config.getOption<bool>("dxvk.enableAftermathResourceTracking", false);
@@ -42,6 +47,11 @@ namespace dxvk {
     memcpyKickoffThreshold = config.getOption<uint32_t>("dxvk.memcpyKickoffThreshold", 16 * 1024 * 1024);
     // NV-DXVK end
 
+    // NV-DXVK start: work-based early submission
+    accelStructKickoffThreshold = config.getOption<uint32_t>("dxvk.accelStructKickoffThreshold", 512);
+    dispatchKickoffThreshold = config.getOption<uint32_t>("dxvk.dispatchKickoffThreshold", 0);
+    // NV-DXVK end
+
     // NV-DXVK start: tell the user they cant run Remix
     float nvidiaMinDriverFloat = config.getOption<float>("dxvk.nvidiaMinDriver", 527.56f);
     float nvidiaGfnMinDriverFloat = config.getOption<float>("dxvk.nvidiaGfnMinDriver", 527.01f);
@@ -63,6 +73,11 @@ namespace dxvk {
     deviceLocalMemoryChunkSizeMB = config.getOption<uint32_t>("dxvk.deviceLocalMemoryChunkSizeMB", 320);
     otherMemoryChunkSizeMB = config.getOption<uint32_t>("dxvk.otherMemoryChunkSizeMB", 128);
     // NV-DXVK end
+
+    // NV-DXVK start: topology-aware thread placement
+    threadPlacement = config.getOption<std::string>("dxvk.threadPlacement", "priority");
+    threadPlacementReserveMainCore = config.getOption<bool>("dxvk.threadPlacementReserveMainCore", true);
+    // NV-DXVK end
   }
 
 }
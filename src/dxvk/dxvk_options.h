@@ -42,6 +42,16 @@ namespace dxvk {
     /// when using the state cache
     int32_t numCompilerThreads;
 
+    // NV-DXVK start: indexed state cache file
+    /// Number of sessions between state
+    /// cache file compactions
+    uint32_t stateCacheCompactInterval;
+
+    /// Number of sessions after which unused
+    /// state cache entries are dropped, 0 keeps all
+    uint32_t stateCacheMaxUnusedSessions;
+    // NV-DXVK end
+
     /// Shader-related options
     Tristate useRawSsbo;
 
@@ -63,6 +73,11 @@ namespace dxvk {
     uint32_t memcpyKickoffThreshold;
     // NV-DXVK end
 
+    // NV-DXVK start: work-based early submission
+    uint32_t accelStructKickoffThreshold;
+    uint32_t dispatchKickoffThreshold;
+    // NV-DXVK end
+
     // NV-DXVK start: tell the user they cant run Remix
     uint32_t nvidiaMinDriver;
     uint32_t nvidiaLinuxMinDriver;
@@ -72,6 +87,11 @@ namespace dxvk {
     uint32_t deviceLocalMemoryChunkSizeMB;
     uint32_t otherMemoryChunkSizeMB;
     // NV-DXVK end
+
+    // NV-DXVK start: topology-aware thread placement
+    std::string threadPlacement;
+    bool threadPlacementReserveMainCore;
+    // NV-DXVK end
   };
 
 }
@@ -29,7 +29,12 @@ namespace dxvk {
           DxvkDevice*         device,
           DxvkRenderPassPool* passManager)
   : m_device    (device),
-    m_cache     (new DxvkPipelineCache(device->vkd())) {
+    m_cache     (new DxvkPipelineCache(device->vkd())),
+    // NV-DXVK start: ray tracing pipeline libraries
+    m_raytracingLibraries([vkd = device->vkd()] (VkPipeline library) {
+      vkd->vkDestroyPipeline(vkd->device(), library, nullptr);
+    }) {
+    // NV-DXVK end
     std::string useStateCache = env::getEnvVar("DXVK_STATE_CACHE");
     
     if (useStateCache != "0" && device->config().enableStateCache)
@@ -26,6 +26,7 @@
 
 #include "dxvk_compute.h"
 #include "dxvk_graphics.h"
+#include "dxvk_raytracing_library.h"
 
 namespace dxvk {
 
@@ -151,6 +152,11 @@ namespace dxvk {
     std::atomic<uint32_t>     m_numGraphicsPipelines = { 0 };
     
     dxvk::mutex m_mutex;
+
+    // NV-DXVK start: ray tracing pipeline libraries
+    // Note: Declared before the ray tracing pipelines so that it outlives the pipelines linked from it
+    DxvkRaytracingLibraryCache<VkPipeline> m_raytracingLibraries;
+    // NV-DXVK end
     
     std::unordered_map<
       DxvkComputePipelineShaders,
@@ -21,6 +21,7 @@
 */
 #include "dxvk_device.h"
 #include "dxvk_queue.h"
+#include "../util/util_thread_placement.h"
 
 #include "NvLowLatencyVk.h"
 
@@ -29,8 +30,77 @@
 
 namespace dxvk {
   
+  // NV-DXVK start: timeline semaphore submission tracking
+  DxvkQueueTimeline::DxvkQueueTimeline(DxvkDevice* device)
+  : m_device(device) {
+    VkSemaphoreTypeCreateInfo typeInfo;
+    typeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.pNext         = nullptr;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue  = 0;
+
+    VkSemaphoreCreateInfo info;
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    info.pNext = &typeInfo;
+    info.flags = 0;
+
+    if (m_device->vkd()->vkCreateSemaphore(m_device->vkd()->device(), &info, nullptr, &m_semaphore) != VK_SUCCESS)
+      throw DxvkError("DxvkQueueTimeline: Failed to create timeline semaphore");
+  }
+
+
+  DxvkQueueTimeline::~DxvkQueueTimeline() {
+    m_device->vkd()->vkDestroySemaphore(m_device->vkd()->device(), m_semaphore, nullptr);
+  }
+
+
+  uint64_t DxvkQueueTimeline::getCompletedValue() {
+    uint64_t value = 0;
+
+    VkResult status = m_device->vkd()->vkGetSemaphoreCounterValue(m_device->vkd()->device(), m_semaphore, &value);
+
+    if (status != VK_SUCCESS) {
+      m_lastResult = status;
+      throw DxvkError(str::format("DxvkQueueTimeline: Failed to query timeline semaphore: ", status));
+    }
+
+    return value;
+  }
+
+
+  bool DxvkQueueTimeline::wait(uint64_t value) {
+    ZoneScoped;
+
+    VkSemaphoreWaitInfo waitInfo;
+    waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.pNext          = nullptr;
+    waitInfo.flags          = 0;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores    = &m_semaphore;
+    waitInfo.pValues        = &value;
+
+    VkResult status = VK_TIMEOUT;
+
+    while (status == VK_TIMEOUT) {
+      status = m_device->vkd()->vkWaitSemaphores(
+        m_device->vkd()->device(), &waitInfo,
+        1'000'000'000ull);
+    }
+
+    if (status != VK_SUCCESS) {
+      m_lastResult = status;
+      return false;
+    }
+
+    return true;
+  }
+  // NV-DXVK end
+
+
   DxvkSubmissionQueue::DxvkSubmissionQueue(DxvkDevice* device)
   : m_device(device),
+    m_timeline(device),
+    m_finishQueue(m_timeline),
     m_submitThread([this] () { submitCmdLists(); }),
     m_finishThread([this] () { finishCmdLists(); }) {
 
@@ -55,7 +125,7 @@ namespace dxvk {
     std::unique_lock<dxvk::mutex> lock(m_mutex);
 
     m_finishCond.wait(lock, [this] {
-      return m_submitQueue.size() + m_finishQueue.size() <= MaxNumQueuedCommandBuffers;
+      return m_submitQueue.size() + m_finishQueue.size() + m_retiring <= MaxNumQueuedCommandBuffers;
     });
 
     DxvkSubmitEntry entry = { };
@@ -117,6 +187,9 @@ namespace dxvk {
     ZoneScoped;
 
     env::setThreadName("dxvk-submit");
+    // NV-DXVK start: topology-aware thread placement
+    ThreadPlacementService::get().applyToCurrentThread(ThreadRole::Submission);
+    // NV-DXVK end
 
     std::unique_lock<dxvk::mutex> lock(m_mutex);
 
@@ -134,6 +207,10 @@ namespace dxvk {
       // Submit command buffer to device
       VkResult status = VK_NOT_READY;
 
+      // NV-DXVK start: timeline semaphore submission tracking
+      const uint64_t timelineValue = m_timelineValue + 1;
+      // NV-DXVK end
+
       if (m_lastError != VK_ERROR_DEVICE_LOST) {
         // NV-DXVK start: Rename lock to lockQueue to avoid shadowing other mutex
         std::lock_guard<dxvk::mutex> lockQueue(m_mutexQueue);
@@ -142,7 +219,9 @@ namespace dxvk {
         if (entry.submit.cmdList != nullptr) {
           status = entry.submit.cmdList->submit(
             entry.submit.waitSync,
-            entry.submit.wakeSync);
+            entry.submit.wakeSync,
+            m_timeline.handle(),
+            timelineValue);
         } else if (entry.present.presenter != nullptr) {
           
           RtxReflex& reflex = m_device->getCommon()->metaReflex();
@@ -169,8 +248,12 @@ namespace dxvk {
       lock = std::unique_lock<dxvk::mutex>(m_mutex);
 
       if (status == VK_SUCCESS) {
-        if (entry.submit.cmdList != nullptr)
-          m_finishQueue.push(std::move(entry));
+        // NV-DXVK start: timeline semaphore submission tracking
+        if (entry.submit.cmdList != nullptr) {
+          m_timelineValue = timelineValue;
+          m_finishQueue.push(timelineValue, std::move(entry));
+        }
+        // NV-DXVK end
       } else if (status == VK_ERROR_DEVICE_LOST || entry.submit.cmdList != nullptr) {
         Logger::err(str::format("DxvkSubmissionQueue: Command submission failed: ", status));
         m_lastError = status;
@@ -205,6 +288,13 @@ namespace dxvk {
   void DxvkSubmissionQueue::finishCmdLists() {
     ZoneScoped;
     env::setThreadName("dxvk-queue");
+    // NV-DXVK start: topology-aware thread placement
+    ThreadPlacementService::get().applyToCurrentThread(ThreadRole::Submission);
+    // NV-DXVK end
+
+    // NV-DXVK start: timeline semaphore submission tracking
+    std::vector<DxvkSubmitEntry> retired;
+    // NV-DXVK end
 
     std::unique_lock<dxvk::mutex> lock(m_mutex);
 
@@ -223,28 +313,54 @@ namespace dxvk {
       if (m_stopped.load())
         return;
       
-      DxvkSubmitEntry entry = std::move(m_finishQueue.front());
+      // NV-DXVK start: timeline semaphore submission tracking
+      // Wait for the oldest submission only, everything the GPU has
+      // finished by then is retired in the same batch below.
+      const uint64_t timelineValue = m_finishQueue.oldestValue();
       lock.unlock();
       
       VkResult status = m_lastError.load();
       
       if (status != VK_ERROR_DEVICE_LOST)
-        status = entry.submit.cmdList->synchronize();
+        status = m_timeline.wait(timelineValue) ? VK_SUCCESS : m_timeline.getLastResult();
       
       if (status != VK_SUCCESS) {
-        Logger::err(str::format("DxvkSubmissionQueue: Failed to sync fence: ", status));
+        Logger::err(str::format("DxvkSubmissionQueue: Failed to wait for timeline semaphore: ", status));
         m_lastError = status;
         m_device->waitForIdle();
       }
-      entry.submit.cmdList->notifySignals();
-      entry.submit.cmdList->reset();
 
-      m_device->recycleCommandList(entry.submit.cmdList);
+      lock = std::unique_lock<dxvk::mutex>(m_mutex);
+
+      if (status == VK_SUCCESS) {
+        try {
+          m_finishQueue.retireCompleted(retired);
+        } catch (const DxvkError& e) {
+          // The timeline is not going to advance anymore, treat this like a lost device
+          Logger::err(e.message());
+          m_lastError = m_timeline.getLastResult();
+          m_finishQueue.retireAll(retired);
+        }
+      } else
+        m_finishQueue.retireAll(retired);
+
+      m_retiring = retired.size();
+      lock.unlock();
+
+      for (auto& entry : retired) {
+        entry.submit.cmdList->notifySignals();
+        entry.submit.cmdList->reset();
+
+        m_device->recycleCommandList(entry.submit.cmdList);
+      }
+
+      retired.clear();
 
       lock = std::unique_lock<dxvk::mutex>(m_mutex);
-      m_pending -= 1;
+      m_pending -= uint32_t(m_retiring);
+      m_retiring = 0;
+      // NV-DXVK end
 
-      m_finishQueue.pop();
       m_finishCond.notify_all();
     }
   }
@@ -9,6 +9,7 @@
 #include "../vulkan/vulkan_presenter.h"
 
 #include "dxvk_cmdlist.h"
+#include "dxvk_submission_tracker.h"
 
 namespace dxvk {
   
@@ -60,6 +61,46 @@ namespace dxvk {
   };
 
 
+  // NV-DXVK start: timeline semaphore submission tracking
+  /**
+   * \brief Queue timeline
+   *
+   * Timeline semaphore signaled by every command
+   * list submission with an increasing value.
+   */
+  class DxvkQueueTimeline : public DxvkSubmissionTimeline {
+
+  public:
+
+    DxvkQueueTimeline(DxvkDevice* device);
+    ~DxvkQueueTimeline();
+
+    VkSemaphore handle() const {
+      return m_semaphore;
+    }
+
+    /**
+     * \brief Result of the last failed wait or query
+     * \returns Vulkan error code
+     */
+    VkResult getLastResult() const {
+      return m_lastResult;
+    }
+
+    uint64_t getCompletedValue() override;
+
+    bool wait(uint64_t value) override;
+
+  private:
+
+    DxvkDevice*   m_device;
+    VkSemaphore   m_semaphore = VK_NULL_HANDLE;
+    VkResult      m_lastResult = VK_SUCCESS;
+
+  };
+  // NV-DXVK end
+
+
   /**
    * \brief Submission queue
    */
@@ -182,7 +223,16 @@ namespace dxvk {
     dxvk::condition_variable    m_finishCond;
 
     std::queue<DxvkSubmitEntry> m_submitQueue;
-    std::queue<DxvkSubmitEntry> m_finishQueue;
+
+    // NV-DXVK start: timeline semaphore submission tracking
+    DxvkQueueTimeline           m_timeline;
+    uint64_t                    m_timelineValue = 0;
+
+    // Submitted command lists, retired in batches once the
+    // timeline has reached the value they signal
+    DxvkSubmissionTracker<DxvkSubmitEntry> m_finishQueue;
+    size_t                      m_retiring = 0;
+    // NV-DXVK end
 
     dxvk::thread                m_submitThread;
     dxvk::thread                m_finishThread;
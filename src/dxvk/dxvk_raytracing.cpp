@@ -294,6 +294,34 @@ namespace dxvk {
 
     // Create pipeline layout
     m_layout = new DxvkPipelineLayout(m_vkd, slotMapping, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_shaders.groups[0].generalShader->shaderOptions().extraLayouts);
+
+    // NV-DXVK start: ray tracing pipeline libraries
+    // Libraries can only be linked into pipelines with an identical layout,
+    // and the shader modules compiled into them depend on the slot mapping
+    DxvkHashState layoutHash;
+
+    for (uint32_t i = 0; i < slotMapping.bindingCount(); i++) {
+      const DxvkDescriptorSlot& binding = slotMapping.bindingInfos()[i];
+      layoutHash.add(binding.slot);
+      layoutHash.add(uint32_t(binding.type));
+      layoutHash.add(uint32_t(binding.view));
+      layoutHash.add(binding.stages);
+      layoutHash.add(binding.access);
+      layoutHash.add(binding.count);
+      layoutHash.add(binding.flags);
+    }
+
+    const VkPushConstantRange pushConstRange = slotMapping.pushConstRange();
+    layoutHash.add(pushConstRange.stageFlags);
+    layoutHash.add(pushConstRange.offset);
+    layoutHash.add(pushConstRange.size);
+
+    for (VkDescriptorSetLayout extraLayout : m_shaders.groups[0].generalShader->shaderOptions().extraLayouts) {
+      layoutHash.add(reinterpret_cast<size_t>(extraLayout));
+    }
+
+    m_layoutHash = layoutHash;
+    // NV-DXVK end
   }
 
   void DxvkRaytracingPipeline::createPipeline() {
@@ -301,6 +329,13 @@ namespace dxvk {
 
     assert(m_layout != nullptr);
 
+    // NV-DXVK start: ray tracing pipeline libraries
+    if (shouldUsePipelineLibraries()) {
+      createPipelineFromLibraries();
+      return;
+    }
+    // NV-DXVK end
+
     // Assemble the shader stages and recursion depth info into the ray tracing pipeline
     VkRayTracingPipelineCreateInfoKHR rayPipelineInfo{ VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR };
     rayPipelineInfo.stageCount = static_cast<uint32_t>(m_stages.size());  // Stages are shaders
@@ -311,9 +346,24 @@ namespace dxvk {
     rayPipelineInfo.layout = m_layout->pipelineLayout();
     rayPipelineInfo.basePipelineIndex = -1;
     rayPipelineInfo.flags = m_shaders.pipelineFlags;
-    
+
+    createRaytracingPipeline(rayPipelineInfo, &m_pipeline);
+
+    // NV-DXVK start: ray tracing pipeline libraries
+    // Group handles of a fully compiled pipeline map one to one to its groups
+    m_handleCount = static_cast<uint32_t>(m_shaderGroups.size());
+    m_groupHandleIndices.resize(m_shaderGroups.size());
+
+    for (uint32_t i = 0; i < m_groupHandleIndices.size(); i++) {
+      m_groupHandleIndices[i] = i;
+    }
+    // NV-DXVK end
+  }
+
+  // NV-DXVK start: ray tracing pipeline libraries
+  void DxvkRaytracingPipeline::createRaytracingPipeline(const VkRayTracingPipelineCreateInfoKHR& info, VkPipeline* pipeline) {
     auto& rtProperties = m_pipeMgr->m_device->properties().khrDeviceRayTracingPipelineProperties;
-    THROW_IF_FALSE(rtProperties.maxRayRecursionDepth >= rayPipelineInfo.maxPipelineRayRecursionDepth);
+    THROW_IF_FALSE(rtProperties.maxRayRecursionDepth >= info.maxPipelineRayRecursionDepth);
 
     VkDeferredOperationKHR deferredOp = VK_NULL_HANDLE;
 
@@ -322,7 +372,7 @@ namespace dxvk {
     }
 
     VkResult result = m_vkd->vkCreateRayTracingPipelinesKHR(m_vkd->device(), deferredOp, m_pipeMgr->m_cache->handle(),
-                                                               1, &rayPipelineInfo, nullptr, &m_pipeline);
+                                                               1, &info, nullptr, pipeline);
     VK_THROW_IF_FAILED(result);
 
     if (deferredOp == VK_NULL_HANDLE) {
@@ -350,6 +400,161 @@ namespace dxvk {
     m_vkd->vkDestroyDeferredOperationKHR(m_vkd->device(), deferredOp, VK_NULL_HANDLE);
   }
 
+  bool DxvkRaytracingPipeline::shouldUsePipelineLibraries() const {
+    if (!m_usePipelineLibraries.getValue() || !m_pipeMgr->m_device->extensions().khrPipelineLibrary) {
+      return false;
+    }
+
+    // Libraries need an interface covering every payload and hit attribute,
+    // so shaders whose interface cannot be sized require a full compilation
+    for (const auto& group : m_shaders.groups) {
+      for (const DxvkShader* shader : { group.generalShader.ptr(), group.closestHitShader.ptr(),
+                                        group.anyHitShader.ptr(), group.intersectionShader.ptr() }) {
+        if (shader && !shader->hasSizedRayInterface()) {
+          return false;
+        }
+      }
+    }
+
+    // Pipelines without any miss, callable or hit groups have nothing to share
+    for (const auto& group : m_shaders.groups) {
+      if (!group.generalShader.ptr() || group.generalShader->stage() != VK_SHADER_STAGE_RAYGEN_BIT_KHR) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  VkRayTracingPipelineInterfaceCreateInfoKHR DxvkRaytracingPipeline::getLibraryInterface() const {
+    // Note: Libraries and the pipelines linking them have to agree on the interface,
+    // so it covers the largest payload and hit attributes of any shader in the pipeline
+    VkRayTracingPipelineInterfaceCreateInfoKHR iface { VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_INTERFACE_CREATE_INFO_KHR };
+
+    auto addShader = [&iface] (const Rc<DxvkShader>& shader) {
+      if (shader.ptr()) {
+        iface.maxPipelineRayPayloadSize = std::max(iface.maxPipelineRayPayloadSize, shader->rayPayloadSize());
+        iface.maxPipelineRayHitAttributeSize = std::max(iface.maxPipelineRayHitAttributeSize, shader->rayHitAttributeSize());
+      }
+    };
+
+    for (const auto& group : m_shaders.groups) {
+      addShader(group.generalShader);
+      addShader(group.closestHitShader);
+      addShader(group.anyHitShader);
+      addShader(group.intersectionShader);
+    }
+
+    // Triangle hit groups always receive the barycentrics
+    constexpr uint32_t kTriangleHitAttributeSize = 2 * sizeof(float);
+    iface.maxPipelineRayHitAttributeSize = std::max(iface.maxPipelineRayHitAttributeSize, kTriangleHitAttributeSize);
+
+    return iface;
+  }
+
+  VkPipeline DxvkRaytracingPipeline::createLibrary(const DxvkRaytracingLinkPlan::Library& library) {
+    Logger::debug(str::format("Compiling raytracing pipeline library for: ", m_shaders.debugName ? m_shaders.debugName : "<debug name missing>"));
+
+    // Gather the stages used by the library's groups and remap the groups onto them
+    std::vector<VkPipelineShaderStageCreateInfo> stages;
+    std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups;
+    std::unordered_map<uint32_t, uint32_t> stageMapping;
+
+    auto remapStage = [&] (uint32_t stage) -> uint32_t {
+      if (stage == VK_SHADER_UNUSED_KHR)
+        return stage;
+
+      auto entry = stageMapping.emplace(stage, static_cast<uint32_t>(stages.size()));
+
+      if (entry.second)
+        stages.push_back(m_stages[stage]);
+
+      return entry.first->second;
+    };
+
+    groups.reserve(library.groups.size());
+
+    for (uint32_t groupIndex : library.groups) {
+      VkRayTracingShaderGroupCreateInfoKHR group = m_shaderGroups[groupIndex];
+      group.generalShader = remapStage(group.generalShader);
+      group.closestHitShader = remapStage(group.closestHitShader);
+      group.anyHitShader = remapStage(group.anyHitShader);
+      group.intersectionShader = remapStage(group.intersectionShader);
+      groups.push_back(group);
+    }
+
+    const VkRayTracingPipelineInterfaceCreateInfoKHR iface = getLibraryInterface();
+
+    VkRayTracingPipelineCreateInfoKHR info { VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR };
+    info.flags = m_shaders.pipelineFlags | VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+    info.stageCount = static_cast<uint32_t>(stages.size());
+    info.pStages = stages.data();
+    info.groupCount = static_cast<uint32_t>(groups.size());
+    info.pGroups = groups.data();
+    info.maxPipelineRayRecursionDepth = 1;
+    info.pLibraryInterface = &iface;
+    info.layout = m_layout->pipelineLayout();
+    info.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    createRaytracingPipeline(info, &pipeline);
+    return pipeline;
+  }
+
+  void DxvkRaytracingPipeline::createPipelineFromLibraries() {
+    const VkRayTracingPipelineInterfaceCreateInfoKHR iface = getLibraryInterface();
+
+    DxvkRaytracingLibraryInterface libraryInterface;
+    libraryInterface.layoutHash = m_layoutHash;
+    libraryInterface.flags = m_shaders.pipelineFlags;
+    libraryInterface.maxPayloadSize = iface.maxPipelineRayPayloadSize;
+    libraryInterface.maxHitAttributeSize = iface.maxPipelineRayHitAttributeSize;
+
+    std::vector<DxvkRaytracingLinkGroup> linkGroups(m_shaders.groups.size());
+
+    for (size_t i = 0; i < m_shaders.groups.size(); i++) {
+      const auto& group = m_shaders.groups[i];
+
+      DxvkHashState state;
+      state.add(DxvkShader::getHash(group.generalShader));
+      state.add(DxvkShader::getHash(group.closestHitShader));
+      state.add(DxvkShader::getHash(group.anyHitShader));
+      state.add(DxvkShader::getHash(group.intersectionShader));
+
+      linkGroups[i].hash = state;
+      linkGroups[i].isRayGen = group.generalShader.ptr() && group.generalShader->stage() == VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+    }
+
+    const DxvkRaytracingLinkPlan plan = DxvkRaytracingLinkPlan::create(linkGroups, libraryInterface);
+
+    std::vector<VkPipeline> libraries;
+    libraries.reserve(plan.libraries.size());
+
+    for (const auto& library : plan.libraries) {
+      libraries.push_back(m_pipeMgr->m_raytracingLibraries.acquire(library.key, [&] {
+        return createLibrary(library);
+      }));
+    }
+
+    VkPipelineLibraryCreateInfoKHR libraryInfo { VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR };
+    libraryInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+    libraryInfo.pLibraries = libraries.data();
+
+    VkRayTracingPipelineCreateInfoKHR info { VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR };
+    info.flags = m_shaders.pipelineFlags;
+    info.maxPipelineRayRecursionDepth = 1;
+    info.pLibraryInfo = &libraryInfo;
+    info.pLibraryInterface = &iface;
+    info.layout = m_layout->pipelineLayout();
+    info.basePipelineIndex = -1;
+
+    createRaytracingPipeline(info, &m_pipeline);
+
+    m_handleCount = plan.handleCount;
+    m_groupHandleIndices = plan.groupHandleIndices;
+  }
+  // NV-DXVK end
+
   // Each shader binding table is populated with shader records 
   // from DxvkRaytracingPipelineShaders::groups in an order they appear
   // in the container.
@@ -381,7 +586,10 @@ namespace dxvk {
         hitCount++;
     }
 
-    const uint32_t kHandleCount = raygenCount + missCount + callableCount + hitCount;
+    // NV-DXVK start: ray tracing pipeline libraries
+    // Note: Pipelines linked from libraries may have fewer handles than groups
+    const uint32_t kHandleCount = m_handleCount;
+    // NV-DXVK end
     auto& rtProperties = m_pipeMgr->m_device->properties().khrDeviceRayTracingPipelineProperties;
     uint32_t handleSize = rtProperties.shaderGroupHandleSize;
 
@@ -438,7 +646,9 @@ namespace dxvk {
     // Map the SBT buffer and write in the handles
     {
       // Helper to retrieve the handle data
-      auto getHandle = [&](size_t i) { return handles.data() + i * handleSize; };
+      // NV-DXVK start: ray tracing pipeline libraries
+      auto getHandle = [&](size_t i) { return handles.data() + m_groupHandleIndices[i] * handleSize; };
+      // NV-DXVK end
 
       // Calculate the base addresses of the portions of the mapped SBT.
       // Use the deviceAddress difference to reduce the chance of bugs due to different ordering of calculations.
@@ -481,5 +691,8 @@ namespace dxvk {
     m_stages.clear();
     m_shaderGroups.clear();
     m_shaderModules.clear();
+    // NV-DXVK start: ray tracing pipeline libraries
+    m_groupHandleIndices.clear();
+    // NV-DXVK end
   }
 }
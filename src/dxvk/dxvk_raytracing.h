@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "dxvk_pipelayout.h"
+#include "dxvk_raytracing_library.h"
 #include "dxvk_shader.h"
 #include "rtx_render/rtx_option.h"
 
@@ -131,6 +132,14 @@ namespace dxvk {
     void createShaderBindingTable();
     void releaseTmpResources();
 
+    // NV-DXVK start: ray tracing pipeline libraries
+    bool shouldUsePipelineLibraries() const;
+    void createPipelineFromLibraries();
+    VkPipeline createLibrary(const DxvkRaytracingLinkPlan::Library& library);
+    VkRayTracingPipelineInterfaceCreateInfoKHR getLibraryInterface() const;
+    void createRaytracingPipeline(const VkRayTracingPipelineCreateInfoKHR& info, VkPipeline* pipeline);
+    // NV-DXVK end
+
     mutable dxvk::mutex               m_mutex;
     std::atomic_bool                  m_isCompiled;
 
@@ -146,6 +155,13 @@ namespace dxvk {
     DxvkRaytracingPipelineShaders     m_shaders;
     Rc<DxvkPipelineLayout>            m_layout;
 
+    // NV-DXVK start: ray tracing pipeline libraries
+    size_t                            m_layoutHash = 0;
+    std::vector<uint32_t>             m_groupHandleIndices;
+    uint32_t                          m_handleCount = 0;
+    // NV-DXVK end
+
     RTX_OPTION("rtx.pipeline", bool, useDeferredOperations, true, "");
+    RTX_OPTION("rtx.pipeline", bool, usePipelineLibraries, true, "Compiles the shader groups of ray tracing pipelines into pipeline libraries shared between pipelines and links each pipeline from them, rather than compiling every pipeline in full. Requires VK_KHR_pipeline_library.");
   };
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "dxvk_hash.h"
+
+#include "../util/thread.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Ray tracing pipeline library interface
+   *
+   * Everything a library and the pipelines it is linked into
+   * have to agree on: a compatible layout, the same creation
+   * flags and the same ray payload and hit attribute sizes.
+   */
+  struct DxvkRaytracingLibraryInterface {
+    size_t   layoutHash          = 0;
+    uint32_t flags               = 0;
+    uint32_t maxPayloadSize      = 0;
+    uint32_t maxHitAttributeSize = 0;
+
+    bool eq(const DxvkRaytracingLibraryInterface& other) const {
+      return layoutHash          == other.layoutHash
+          && flags               == other.flags
+          && maxPayloadSize      == other.maxPayloadSize
+          && maxHitAttributeSize == other.maxHitAttributeSize;
+    }
+
+    size_t hash() const {
+      DxvkHashState state;
+      state.add(layoutHash);
+      state.add(flags);
+      state.add(maxPayloadSize);
+      state.add(maxHitAttributeSize);
+      return state;
+    }
+  };
+
+  /**
+   * \brief Ray tracing pipeline library key
+   *
+   * Identifies a set of shader groups compiled into a
+   * pipeline library for a given interface.
+   */
+  struct DxvkRaytracingLibraryKey {
+    size_t                         groupsHash = 0;
+    DxvkRaytracingLibraryInterface iface;
+
+    bool eq(const DxvkRaytracingLibraryKey& other) const {
+      return groupsHash == other.groupsHash
+          && iface.eq(other.iface);
+    }
+
+    size_t hash() const {
+      DxvkHashState state;
+      state.add(groupsHash);
+      state.add(iface.hash());
+      return state;
+    }
+  };
+
+  /**
+   * \brief Shader group as seen by the link planner
+   *
+   * Only the hash of the shaders in the group and whether the
+   * group holds a ray generation shader matter for planning.
+   */
+  struct DxvkRaytracingLinkGroup {
+    size_t hash      = 0;
+    bool   isRayGen  = false;
+  };
+
+  /**
+   * \brief Link plan of a ray tracing pipeline
+   *
+   * Describes how a pipeline is put together from libraries.
+   * Ray generation groups go into one library and all miss,
+   * callable and hit groups into another, as the latter are
+   * what permutations of a pass (e.g. with and without SER)
+   * have in common. Groups occurring more than once in a
+   * pipeline are compiled once and share a group handle.
+   */
+  struct DxvkRaytracingLinkPlan {
+    struct Library {
+      DxvkRaytracingLibraryKey key;
+      std::vector<uint32_t>    groups;  // Indices of the pipeline groups compiled into the library
+    };
+
+    std::vector<Library>  libraries;           // In the order they are linked
+    std::vector<uint32_t> groupHandleIndices;  // Group handle index of each pipeline group in the linked pipeline
+    uint32_t              handleCount = 0;     // Total number of group handles of the linked pipeline
+
+    static DxvkRaytracingLinkPlan create(
+      const std::vector<DxvkRaytracingLinkGroup>& groups,
+      const DxvkRaytracingLibraryInterface&       iface) {
+      DxvkRaytracingLinkPlan plan;
+      plan.groupHandleIndices.resize(groups.size());
+
+      for (bool isRayGen : { true, false }) {
+        Library library;
+        DxvkHashState groupsHash;
+
+        // Position of each unique group within the library
+        std::unordered_map<size_t, uint32_t> uniqueGroups;
+
+        for (uint32_t i = 0; i < groups.size(); i++) {
+          if (groups[i].isRayGen != isRayGen)
+            continue;
+
+          auto entry = uniqueGroups.emplace(groups[i].hash, uint32_t(library.groups.size()));
+
+          if (entry.second) {
+            library.groups.push_back(i);
+            groupsHash.add(groups[i].hash);
+          }
+
+          // Note: Handles of linked pipelines follow the library order
+          plan.groupHandleIndices[i] = plan.handleCount + entry.first->second;
+        }
+
+        if (library.groups.empty())
+          continue;
+
+        library.key.groupsHash = groupsHash;
+        library.key.iface = iface;
+
+        plan.handleCount += uint32_t(library.groups.size());
+        plan.libraries.push_back(std::move(library));
+      }
+
+      return plan;
+    }
+  };
+
+  /**
+   * \brief Ray tracing pipeline library cache
+   *
+   * Owns all pipeline libraries compiled for ray tracing
+   * pipelines and hands out existing ones for keys seen
+   * before. Compilation happens outside of the lock, and
+   * concurrent requests for a library that is still being
+   * compiled wait for it rather than compiling it again.
+   * \tparam Library Library handle type
+   */
+  template<typename Library>
+  class DxvkRaytracingLibraryCache {
+
+  public:
+
+    using DestroyFn = std::function<void(Library)>;
+
+    explicit DxvkRaytracingLibraryCache(DestroyFn destroyFn)
+    : m_destroyFn(std::move(destroyFn)) { }
+
+    ~DxvkRaytracingLibraryCache() {
+      for (auto& entry : m_libraries) {
+        if (entry.second.state == State::Ready)
+          m_destroyFn(entry.second.library);
+      }
+    }
+
+    DxvkRaytracingLibraryCache             (const DxvkRaytracingLibraryCache&) = delete;
+    DxvkRaytracingLibraryCache& operator = (const DxvkRaytracingLibraryCache&) = delete;
+
+    /**
+     * \brief Retrieves a library, compiling it if necessary
+     *
+     * \param [in] key Library key
+     * \param [in] createFn Compiles the library, may throw
+     * \returns The library for the given key
+     */
+    template<typename CreateFn>
+    Library acquire(const DxvkRaytracingLibraryKey& key, const CreateFn& createFn) {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      auto entry = m_libraries.emplace(key, Entry());
+
+      if (!entry.second) {
+        m_condOnReady.wait(lock, [&] {
+          return entry.first->second.state != State::Compiling;
+        });
+
+        if (entry.first->second.state == State::Ready) {
+          m_reuseCount += 1;
+          return entry.first->second.library;
+        }
+
+        // A previous attempt failed, try again
+        entry.first->second.state = State::Compiling;
+      }
+
+      lock.unlock();
+
+      Library library;
+
+      try {
+        library = createFn();
+      } catch (...) {
+        lock.lock();
+        entry.first->second.state = State::Failed;
+        m_condOnReady.notify_all();
+        throw;
+      }
+
+      lock.lock();
+      entry.first->second.library = library;
+      entry.first->second.state = State::Ready;
+      m_compileCount += 1;
+      m_condOnReady.notify_all();
+      return library;
+    }
+
+    /**
+     * \brief Number of libraries compiled
+     */
+    uint32_t getCompileCount() const {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      return m_compileCount;
+    }
+
+    /**
+     * \brief Number of requests served by an existing library
+     */
+    uint32_t getReuseCount() const {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      return m_reuseCount;
+    }
+
+  private:
+
+    enum class State {
+      Compiling,
+      Ready,
+      Failed,
+    };
+
+    struct Entry {
+      Library library = { };
+      State   state   = State::Compiling;
+    };
+
+    DestroyFn                   m_destroyFn;
+
+    mutable dxvk::mutex         m_mutex;
+    dxvk::condition_variable    m_condOnReady;
+
+    // Note: Node based so entries stay in place while the lock is released during compilation
+    std::unordered_map<
+      DxvkRaytracingLibraryKey,
+      Entry,
+      DxvkHash, DxvkEq>         m_libraries;
+
+    uint32_t                    m_compileCount = 0;
+    uint32_t                    m_reuseCount   = 0;
+
+  };
+
+}
@@ -148,12 +148,128 @@ namespace dxvk {
           m_flags.set(DxvkShaderFlag::ExportsViewportIndexLayerFromVertexStage);
       }
     }
+
+    // NV-DXVK start: ray tracing pipeline libraries
+    if (m_stage & (VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR |
+                   VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR | VK_SHADER_STAGE_CALLABLE_BIT_KHR))
+      computeRayInterfaceSizes(code);
+    // NV-DXVK end
   }
   
   
   DxvkShader::~DxvkShader() {
     
   }
+
+  // NV-DXVK start: ray tracing pipeline libraries
+  void DxvkShader::computeRayInterfaceSizes(SpirvCodeBuffer& code) {
+    struct TypeLayout {
+      uint32_t size;
+      uint32_t alignment;
+      bool sized;
+    };
+
+    // Note: SPIR-V declares types before their use, so a single pass can lay out all types
+    std::unordered_map<uint32_t, TypeLayout> types;
+    std::unordered_map<uint32_t, uint32_t> constants;
+    std::unordered_map<uint32_t, std::pair<spv::StorageClass, uint32_t>> pointers;
+
+    auto getLayout = [&types] (uint32_t id) {
+      auto entry = types.find(id);
+      return entry != types.end() ? entry->second : TypeLayout { 0, 1, false };
+    };
+
+    for (auto ins : code) {
+      switch (ins.opCode()) {
+        case spv::OpConstant:
+          constants.insert({ ins.arg(2), ins.arg(3) });
+          break;
+
+        case spv::OpTypeBool:
+          types.insert({ ins.arg(1), { 4, 4, true } });
+          break;
+
+        case spv::OpTypeInt:
+        case spv::OpTypeFloat:
+          types.insert({ ins.arg(1), { ins.arg(2) / 8, ins.arg(2) / 8, true } });
+          break;
+
+        case spv::OpTypeVector:
+        case spv::OpTypeMatrix: {
+          const TypeLayout element = getLayout(ins.arg(2));
+          types.insert({ ins.arg(1), { element.size * ins.arg(3), element.alignment, element.sized } });
+        } break;
+
+        case spv::OpTypeArray: {
+          const TypeLayout element = getLayout(ins.arg(2));
+          const auto length = constants.find(ins.arg(3));
+
+          // Note: Lengths given by specialization constants are not known until the pipeline is created
+          if (length == constants.end()) {
+            types.insert({ ins.arg(1), { 0, element.alignment, false } });
+            break;
+          }
+
+          types.insert({ ins.arg(1), { align(element.size, element.alignment) * length->second, element.alignment, element.sized } });
+        } break;
+
+        case spv::OpTypeStruct: {
+          TypeLayout layout = { 0, 1, true };
+
+          for (uint32_t i = 2; i < ins.length(); i++) {
+            const TypeLayout member = getLayout(ins.arg(i));
+            layout.size = align(layout.size, member.alignment) + member.size;
+            layout.alignment = std::max(layout.alignment, member.alignment);
+            layout.sized &= member.sized;
+          }
+
+          layout.size = align(layout.size, layout.alignment);
+          types.insert({ ins.arg(1), layout });
+        } break;
+
+        case spv::OpTypeForwardPointer:
+          types.insert({ ins.arg(1), { 8, 8, true } });
+          break;
+
+        case spv::OpTypePointer:
+          // Note: Only physical storage buffer pointers can be members of a payload, and those are 64 bit addresses
+          types.insert({ ins.arg(1), { 8, 8, true } });
+          pointers.insert({ ins.arg(1), { spv::StorageClass(ins.arg(2)), ins.arg(3) } });
+          break;
+
+        case spv::OpVariable: {
+          auto pointer = pointers.find(ins.arg(1));
+
+          if (pointer == pointers.end())
+            break;
+
+          // Note: The KHR storage classes share their values with the NV ones
+          // Runtime arrays, opaque and unknown types leave the layout unsized
+          const TypeLayout layout = getLayout(pointer->second.second);
+
+          switch (pointer->second.first) {
+            case spv::StorageClassRayPayloadNV:
+            case spv::StorageClassIncomingRayPayloadNV:
+              m_rayPayloadSize = std::max(m_rayPayloadSize, layout.size);
+              m_hasSizedRayInterface &= layout.sized;
+              break;
+
+            case spv::StorageClassHitAttributeNV:
+              m_rayHitAttributeSize = std::max(m_rayHitAttributeSize, layout.size);
+              m_hasSizedRayInterface &= layout.sized;
+              break;
+
+            default:
+              break;
+          }
+        } break;
+
+        default:
+          break;
+      }
+    }
+  }
+  // NV-DXVK end
   
   
   void DxvkShader::defineResourceSlots(
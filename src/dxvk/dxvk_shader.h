@@ -292,6 +292,40 @@ namespace dxvk {
      */
     void generateShaderKey();
 
+    // NV-DXVK start: ray tracing pipeline libraries
+    /**
+     * \brief Ray payload size
+     *
+     * Size in bytes of the largest ray payload the shader
+     * declares, using scalar layout. Pipeline libraries and
+     * the pipelines they are linked into must agree on it.
+     * \returns Ray payload size, or 0 if there is none
+     */
+    uint32_t rayPayloadSize() const {
+      return m_rayPayloadSize;
+    }
+
+    /**
+     * \brief Ray hit attribute size
+     * \returns Hit attribute size, or 0 if there is none
+     */
+    uint32_t rayHitAttributeSize() const {
+      return m_rayHitAttributeSize;
+    }
+
+    /**
+     * \brief Checks whether the ray interface sizes are exact
+     *
+     * Payloads and hit attributes using types that cannot
+     * be sized from the SPIR-V alone, such as runtime arrays,
+     * make the sizes above a lower bound only.
+     * \returns \c true if all payloads and hit attributes were sized
+     */
+    bool hasSizedRayInterface() const {
+      return m_hasSizedRayInterface;
+    }
+    // NV-DXVK end
+
   private:
     
     VkShaderStageFlagBits m_stage;
@@ -309,6 +343,14 @@ namespace dxvk {
     size_t m_o1IdxOffset = 0;
     size_t m_o1LocOffset = 0;
 
+    // NV-DXVK start: ray tracing pipeline libraries
+    uint32_t m_rayPayloadSize = 0;
+    uint32_t m_rayHitAttributeSize = 0;
+    bool m_hasSizedRayInterface = true;
+
+    void computeRayInterfaceSizes(SpirvCodeBuffer& code);
+    // NV-DXVK end
+
     static void eliminateInput(SpirvCodeBuffer& code, uint32_t location);
 
   };
@@ -22,6 +22,7 @@
 #include "dxvk_device.h"
 #include "dxvk_pipemanager.h"
 #include "dxvk_state_cache.h"
+#include "../util/util_thread_placement.h"
 
 namespace dxvk {
 
@@ -115,6 +116,19 @@ namespace dxvk {
       return true;
     }
 
+    // NV-DXVK start: indexed state cache file
+    bool readFromBuffer(const char* data, size_t size) {
+      if (size > MaxSize)
+        return false;
+
+      std::memcpy(m_data, data, size);
+
+      m_size = size;
+      m_read = 0;
+      return true;
+    }
+    // NV-DXVK end
+
   private:
 
     size_t m_size = 0;
@@ -176,35 +190,19 @@ namespace dxvk {
           DxvkRenderPassPool*   passManager)
   : m_pipeManager(pipeManager),
     m_passManager(passManager) {
-    bool newFile = !readCacheFile();
-
-    if (newFile) {
-      Logger::warn("DXVK: Creating new state cache file");
-
-      // Start with an empty file
-      std::ofstream file(getCacheFileName().c_str(),
-        std::ios_base::binary |
-        std::ios_base::trunc);
-
-      if (!file && env::createDirectory(getCacheDir())) {
-        file = std::ofstream(getCacheFileName().c_str(),
-          std::ios_base::binary |
-          std::ios_base::trunc);
-      }
-
-      // Write header with the current version number
-      DxvkStateCacheHeader header;
+    // NV-DXVK start: indexed state cache file
+    m_compactInterval   = device->config().stateCacheCompactInterval;
+    m_maxUnusedSessions = device->config().stateCacheMaxUnusedSessions;
 
-      auto data = reinterpret_cast<const char*>(&header);
-      auto size = sizeof(header);
+    // Rewrite the file if it is new, outdated or
+    // contains invalid entries, or compaction is due
+    if (!readCacheFile())
+      writeCacheFile();
 
-      file.write(data, size);
+    mapCacheEntries();
 
-      // Write all valid entries to the cache file in
-      // case we're recovering a corrupted cache file
-      for (auto& e : m_entries)
-        writeCacheEntry(file, e);
-    }
+    m_entryUsed = std::vector<std::atomic<bool>>(m_hasIndex ? m_index.size() : 0);
+    // NV-DXVK end
 
     // Use half the available CPU cores for pipeline compilation
     uint32_t numCpuCores = dxvk::thread::hardware_concurrency();
@@ -223,7 +221,11 @@ namespace dxvk {
 
     for (uint32_t i = 0; i < numWorkers; i++) {
       m_workerThreads.emplace_back([this] () { workerFunc(); });
-      m_workerThreads[i].set_priority(ThreadPriority::Lowest);
+      // NV-DXVK start: topology-aware thread placement
+      // Workers set their own priority unless thread placement is disabled
+      if (!ThreadPlacementService::get().getPlacement(ThreadRole::PipelineCompiler).setPriority)
+        m_workerThreads[i].set_priority(ThreadPriority::Lowest);
+      // NV-DXVK end
     }
     
     m_writerThread = dxvk::thread([this] () { writerFunc(); });
@@ -232,6 +234,10 @@ namespace dxvk {
 
   DxvkStateCache::~DxvkStateCache() {
     this->stopWorkerThreads();
+
+    // NV-DXVK start: indexed state cache file
+    this->writeCacheIndex();
+    // NV-DXVK end
   }
 
 
@@ -248,8 +254,12 @@ namespace dxvk {
     for (auto e = entries.first; e != entries.second; e++) {
       const DxvkStateCacheEntry& entry = m_entries[e->second];
 
-      if (entry.format.eq(format) && entry.gpState == state)
+      if (entry.format.eq(format) && entry.gpState == state) {
+        // NV-DXVK start: state cache last use tracking
+        markEntryUsed(e->second);
+        // NV-DXVK end
         return;
+      }
     }
 
     // Queue a job to write this pipeline to the cache
@@ -272,8 +282,12 @@ namespace dxvk {
     auto entries = m_entryMap.equal_range(shaders);
 
     for (auto e = entries.first; e != entries.second; e++) {
-      if (m_entries[e->second].cpState == state)
+      if (m_entries[e->second].cpState == state) {
+        // NV-DXVK start: state cache last use tracking
+        markEntryUsed(e->second);
+        // NV-DXVK end
         return;
+      }
     }
 
     // Queue a job to write this pipeline to the cache
@@ -407,6 +421,33 @@ namespace dxvk {
   }
 
 
+  // NV-DXVK start: indexed state cache file
+  void DxvkStateCache::mapCacheEntries() {
+    for (size_t i = 0; i < m_entries.size(); i++) {
+      const auto& entry = m_entries[i];
+
+      mapPipelineToEntry(entry.shaders, i);
+
+      mapShaderToPipeline(entry.shaders.vs,  entry.shaders);
+      mapShaderToPipeline(entry.shaders.tcs, entry.shaders);
+      mapShaderToPipeline(entry.shaders.tes, entry.shaders);
+      mapShaderToPipeline(entry.shaders.gs,  entry.shaders);
+      mapShaderToPipeline(entry.shaders.fs,  entry.shaders);
+      mapShaderToPipeline(entry.shaders.cs,  entry.shaders);
+    }
+  }
+
+
+  void DxvkStateCache::markEntryUsed(
+          size_t                    entryId) {
+    // Entries appended since the last compaction are not indexed,
+    // their last use is the session they were appended in
+    if (entryId < m_entryUsed.size())
+      m_entryUsed[entryId].store(true, std::memory_order_relaxed);
+  }
+  // NV-DXVK end
+
+
   void DxvkStateCache::compilePipelines(const WorkerItem& item) {
     DxvkStateCacheKey key;
     key.vs  = getShaderKey(item.gp.vs);
@@ -463,6 +504,17 @@ namespace dxvk {
       return false;
     }
 
+    // NV-DXVK start: indexed state cache file
+    if (curHeader.version >= 11) {
+      if (curHeader.version > newHeader.version) {
+        Logger::warn("DXVK: State cache version not supported");
+        return false;
+      }
+
+      return readIndexedCacheFile(ifile);
+    }
+    // NV-DXVK end
+
     // Struct size hasn't changed between v2 and v4
     size_t expectedSize = newHeader.entrySize;
 
@@ -499,17 +551,10 @@ namespace dxvk {
       DxvkStateCacheEntry entry;
 
       if (readCacheEntry(curHeader.version, ifile, entry)) {
-        size_t entryId = m_entries.size();
+        // NV-DXVK start: indexed state cache file
         m_entries.push_back(entry);
-
-        mapPipelineToEntry(entry.shaders, entryId);
-
-        mapShaderToPipeline(entry.shaders.vs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.tcs, entry.shaders);
-        mapShaderToPipeline(entry.shaders.tes, entry.shaders);
-        mapShaderToPipeline(entry.shaders.gs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.fs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.cs,  entry.shaders);
+        m_entryLastUse.push_back(0);
+        // NV-DXVK end
       } else if (ifile) {
         numInvalidEntries += 1;
       }
@@ -531,6 +576,179 @@ namespace dxvk {
   }
 
 
+  // NV-DXVK start: indexed state cache file
+  bool DxvkStateCache::readIndexedCacheFile(
+          std::istream&             stream) {
+    // Read the entire file at once, records are
+    // parsed in place and validated in parallel
+    stream.seekg(0, std::ios_base::end);
+    std::vector<char> file(size_t(stream.tellg()));
+    stream.seekg(0, std::ios_base::beg);
+
+    if (!stream.read(file.data(), file.size())) {
+      Logger::warn("DXVK: Failed to read state cache file");
+      return false;
+    }
+
+    DxvkStateCacheFileStats stats;
+    std::vector<DxvkStateCacheRecord> records;
+
+    if (!DxvkStateCacheFile::parse(file.data(), file.size(),
+        sizeof(DxvkStateCacheHeader), m_indexHeader, m_index, records, stats)) {
+      Logger::warn("DXVK: Failed to read state cache index");
+      return false;
+    }
+
+    m_session = m_indexHeader.session + 1;
+
+    uint32_t numInvalidEntries = stats.invalidRecords;
+    uint32_t numUnusedEntries = 0;
+
+    m_entries.reserve(records.size());
+    m_entryLastUse.reserve(records.size());
+
+    for (const auto& record : records) {
+      DxvkStateCacheEntryData data;
+      DxvkStateCacheEntry entry;
+
+      if (!data.readFromBuffer(record.data, record.size)
+       || !decodeCacheEntry(DxvkStateCacheHeader().version, VkShaderStageFlags(record.stageMask), data, entry)) {
+        numInvalidEntries += 1;
+        continue;
+      }
+
+      if (m_maxUnusedSessions && m_session - std::min(record.lastUse, m_session) > m_maxUnusedSessions)
+        numUnusedEntries += 1;
+
+      m_entries.push_back(entry);
+      m_entryLastUse.push_back(record.lastUse);
+    }
+
+    Logger::info(str::format(
+      "DXVK: Read ", m_entries.size(),
+      " valid state cache entries (", stats.appendedRecords, " appended)"));
+
+    if (numInvalidEntries) {
+      Logger::warn(str::format(
+        "DXVK: Skipped ", numInvalidEntries,
+        " invalid state cache entries"));
+    }
+
+    if (stats.duplicateRecords) {
+      Logger::info(str::format(
+        "DXVK: Skipped ", stats.duplicateRecords,
+        " duplicate state cache entries"));
+    }
+
+    // Invalid, duplicate and stale entries are dropped by compacting the
+    // file, otherwise entries appended since the last compaction are merged
+    // into the index once the compaction interval has passed.
+    bool compactionDue = stats.appendedRecords
+      && m_session - m_indexHeader.compactSession >= m_compactInterval;
+
+    m_hasIndex = !numInvalidEntries
+              && !stats.duplicateRecords
+              && !numUnusedEntries
+              && !compactionDue;
+
+    return m_hasIndex;
+  }
+
+
+  void DxvkStateCache::writeCacheFile() {
+    // Serialize all entries, then order them by last use
+    // and drop entries that have not been used for a while
+    std::vector<char> buffer;
+    std::vector<size_t> offsets(m_entries.size());
+    std::vector<DxvkStateCacheRecord> records(m_entries.size());
+
+    for (size_t i = 0; i < m_entries.size(); i++) {
+      DxvkStateCacheEntryData data;
+      VkShaderStageFlags stageMask = encodeCacheEntry(m_entries[i], data);
+
+      offsets[i] = buffer.size();
+      buffer.insert(buffer.end(), data.data(), data.data() + data.size());
+
+      records[i].size      = uint32_t(data.size());
+      records[i].stageMask = uint32_t(stageMask);
+      records[i].lastUse   = m_entryLastUse[i];
+      records[i].checksum  = DxvkStateCacheFile::computeChecksum(records[i].stageMask, data.data(), data.size());
+    }
+
+    std::vector<uint32_t> order = DxvkStateCacheFile::compact(records, m_session, m_maxUnusedSessions);
+
+    std::vector<DxvkStateCacheEntry> entries;
+    std::vector<DxvkStateCacheRecord> compacted;
+
+    entries.reserve(order.size());
+    compacted.reserve(order.size());
+    m_entryLastUse.clear();
+
+    for (uint32_t i : order) {
+      entries.push_back(m_entries[i]);
+      compacted.push_back(records[i]);
+      compacted.back().data = &buffer[offsets[i]];
+      m_entryLastUse.push_back(records[i].lastUse);
+    }
+
+    if (order.size() < m_entries.size()) {
+      Logger::info(str::format(
+        "DXVK: Dropped ", m_entries.size() - order.size(),
+        " unused state cache entries"));
+    }
+
+    m_entries = std::move(entries);
+
+    Logger::warn(str::format("DXVK: Writing state cache file with ", m_entries.size(), " entries"));
+
+    std::ofstream file(getCacheFileName().c_str(),
+      std::ios_base::binary |
+      std::ios_base::trunc);
+
+    if (!file && env::createDirectory(getCacheDir())) {
+      file = std::ofstream(getCacheFileName().c_str(),
+        std::ios_base::binary |
+        std::ios_base::trunc);
+    }
+
+    // Write header with the current version number
+    DxvkStateCacheHeader header;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    DxvkStateCacheFile::write(file, sizeof(header), m_session, compacted, m_indexHeader, m_index);
+
+    m_hasIndex = bool(file);
+  }
+
+
+  void DxvkStateCache::writeCacheIndex() {
+    if (!m_hasIndex)
+      return;
+
+    // Store the session and the last use of indexed
+    // entries in place, records remain untouched
+    for (size_t i = 0; i < m_entryUsed.size(); i++) {
+      if (m_entryUsed[i].load(std::memory_order_relaxed))
+        m_index[i].lastUse = m_session;
+    }
+
+    m_indexHeader.session = m_session;
+
+    std::fstream file(getCacheFileName().c_str(),
+      std::ios_base::binary |
+      std::ios_base::in |
+      std::ios_base::out);
+
+    if (!file)
+      return;
+
+    file.seekp(sizeof(DxvkStateCacheHeader));
+    DxvkStateCacheFile::writeIndex(file, m_indexHeader, m_index);
+  }
+  // NV-DXVK end
+
+
   bool DxvkStateCache::readCacheHeader(
           std::istream&             stream,
           DxvkStateCacheHeader&     header) const {
@@ -610,8 +828,18 @@ namespace dxvk {
     if (hash != data.computeHash())
       return false;
 
+    // NV-DXVK start: indexed state cache file
+    return decodeCacheEntry(version, VkShaderStageFlags(header.stageMask), data, entry);
+  }
+
+
+  bool DxvkStateCache::decodeCacheEntry(
+          uint32_t                  version,
+          VkShaderStageFlags        stageMask,
+          DxvkStateCacheEntryData&  data,
+          DxvkStateCacheEntry&      entry) const {
+    // NV-DXVK end
     // Read shader hashes
-    VkShaderStageFlags stageMask = VkShaderStageFlags(header.stageMask);
     auto keys = &entry.shaders.vs;
 
     for (uint32_t i = 0; i < 6; i++) {
@@ -716,8 +944,27 @@ namespace dxvk {
   void DxvkStateCache::writeCacheEntry(
           std::ostream&             stream, 
           DxvkStateCacheEntry&      entry) const {
+    // NV-DXVK start: indexed state cache file
     DxvkStateCacheEntryData data;
+    VkShaderStageFlags stageMask = encodeCacheEntry(entry, data);
+
+    DxvkStateCacheRecord record;
+    record.data      = data.data();
+    record.size      = uint32_t(data.size());
+    record.stageMask = uint32_t(stageMask);
+    record.lastUse   = m_session;
+    record.checksum  = DxvkStateCacheFile::computeChecksum(record.stageMask, record.data, record.size);
+
+    DxvkStateCacheFile::writeRecord(stream, record);
+    stream.flush();
+  }
+
+
+  VkShaderStageFlags DxvkStateCache::encodeCacheEntry(
+    const DxvkStateCacheEntry&      entry,
+          DxvkStateCacheEntryData&  data) const {
     VkShaderStageFlags stageMask = 0;
+    // NV-DXVK end
 
     // Write shader hashes
     auto keys = &entry.shaders.vs;
@@ -786,17 +1033,7 @@ namespace dxvk {
         data.write(sc.specConstants[i]);
     }
 
-    // General layout: header -> hash -> data
-    DxvkStateCacheEntryHeader header;
-    header.stageMask = uint8_t(stageMask);
-    header.entrySize = data.size();
-
-    Sha1Hash hash = data.computeHash();
-
-    stream.write(reinterpret_cast<char*>(&header), sizeof(header));
-    stream.write(reinterpret_cast<char*>(&hash), sizeof(hash));
-    stream.write(data.data(), data.size());
-    stream.flush();
+    return stageMask;
   }
 
 
@@ -981,6 +1218,9 @@ namespace dxvk {
 
   void DxvkStateCache::workerFunc() {
     env::setThreadName("dxvk-shader");
+    // NV-DXVK start: topology-aware thread placement
+    ThreadPlacementService::get().applyToCurrentThread(ThreadRole::PipelineCompiler);
+    // NV-DXVK end
 
     while (!m_stopThreads.load()) {
       WorkerItem item;
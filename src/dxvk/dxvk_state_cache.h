@@ -29,6 +29,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "dxvk_state_cache_file.h"
 #include "dxvk_state_cache_types.h"
 // NV-DXVK start: compile rt shaders on shader compilation threads
 #include "dxvk_raytracing.h"
@@ -37,6 +38,7 @@
 namespace dxvk {
 
   class DxvkDevice;
+  class DxvkStateCacheEntryData;
 
   /**
    * \brief State cache
@@ -179,6 +181,19 @@ namespace dxvk {
     std::queue<WriterItem>            m_writerQueue;
     dxvk::thread                      m_writerThread;
 
+    // NV-DXVK start: indexed state cache file
+    uint32_t                          m_session           = 1;
+    uint32_t                          m_compactInterval   = 0;
+    uint32_t                          m_maxUnusedSessions = 0;
+
+    bool                              m_hasIndex = false;
+    DxvkStateCacheIndexHeader         m_indexHeader;
+    std::vector<DxvkStateCacheIndexEntry> m_index;
+
+    std::vector<uint32_t>             m_entryLastUse;
+    std::vector<std::atomic<bool>>    m_entryUsed;  // Per index entry, set on first use in this session
+    // NV-DXVK end
+
     DxvkShaderKey getShaderKey(
       const Rc<DxvkShader>&           shader) const;
 
@@ -197,6 +212,30 @@ namespace dxvk {
     void compilePipelines(
       const WorkerItem&               item);
 
+    // NV-DXVK start: indexed state cache file
+    void mapCacheEntries();
+
+    void markEntryUsed(
+            size_t                    entryId);
+
+    bool readIndexedCacheFile(
+            std::istream&             stream);
+
+    void writeCacheFile();
+
+    void writeCacheIndex();
+
+    bool decodeCacheEntry(
+            uint32_t                  version,
+            VkShaderStageFlags        stageMask,
+            DxvkStateCacheEntryData&  data,
+            DxvkStateCacheEntry&      entry) const;
+
+    VkShaderStageFlags encodeCacheEntry(
+      const DxvkStateCacheEntry&      entry,
+            DxvkStateCacheEntryData&  data) const;
+    // NV-DXVK end
+
     bool readCacheFile();
 
     bool readCacheHeader(
@@ -0,0 +1,265 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <cstring>
+#include <ppl.h>
+#include <unordered_map>
+
+#include "dxvk_state_cache_file.h"
+
+#include "../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  // Number of records validated by a single task
+  constexpr static size_t RecordsPerTask = 4096;
+
+
+  uint64_t DxvkStateCacheFile::computeChecksum(
+          uint32_t                    stageMask,
+    const void*                       data,
+          size_t                      size) {
+    // Seed with the packed header so that a corrupted
+    // stage mask or entry size is caught as well
+    return XXH3_64bits_withSeed(data, size, (uint64_t(size) << 8) | stageMask);
+  }
+
+
+  bool DxvkStateCacheFile::parse(
+    const char*                       file,
+          size_t                      fileSize,
+          size_t                      bodyOffset,
+          DxvkStateCacheIndexHeader&  indexHeader,
+          std::vector<DxvkStateCacheIndexEntry>& index,
+          std::vector<DxvkStateCacheRecord>& records,
+          DxvkStateCacheFileStats&    stats) {
+    stats = DxvkStateCacheFileStats();
+    index.clear();
+    records.clear();
+
+    if (fileSize < bodyOffset + sizeof(indexHeader))
+      return false;
+
+    std::memcpy(&indexHeader, &file[bodyOffset], sizeof(indexHeader));
+
+    size_t recordOffset = getRecordOffset(bodyOffset, indexHeader.entryCount);
+
+    if (recordOffset > fileSize
+     || indexHeader.tailOffset < recordOffset
+     || indexHeader.tailOffset > fileSize)
+      return false;
+
+    index.resize(indexHeader.entryCount);
+    std::memcpy(index.data(), &file[bodyOffset + sizeof(indexHeader)],
+      sizeof(DxvkStateCacheIndexEntry) * index.size());
+
+    // Locate all records. Indexed records must lie within the
+    // indexed part of the file, appended records are walked
+    // until the end of the file or the first truncated one.
+    std::vector<DxvkStateCacheRecord> candidates;
+    candidates.reserve(index.size());
+
+    auto readRecord = [&] (size_t offset, size_t end, DxvkStateCacheRecord& record) {
+      DxvkStateCacheRecordHeader header;
+
+      // Note: Offsets come from the file, so compare against what is left to avoid wrapping around
+      if (offset < recordOffset || end < sizeof(header) || offset > end - sizeof(header))
+        return false;
+
+      std::memcpy(&header, &file[offset], sizeof(header));
+
+      if (header.entrySize > end - offset - sizeof(header))
+        return false;
+
+      record.data      = &file[offset + sizeof(header)];
+      record.size      = header.entrySize;
+      record.stageMask = header.stageMask;
+      record.lastUse   = header.lastUse;
+      record.checksum  = header.checksum;
+      return true;
+    };
+
+    for (const auto& entry : index) {
+      DxvkStateCacheRecord record;
+
+      if (!readRecord(entry.offset, indexHeader.tailOffset, record)) {
+        stats.invalidRecords += 1;
+        continue;
+      }
+
+      record.lastUse = entry.lastUse;
+      candidates.push_back(record);
+    }
+
+    size_t indexedCount = candidates.size();
+    size_t offset = indexHeader.tailOffset;
+
+    while (offset < fileSize) {
+      DxvkStateCacheRecord record;
+
+      if (!readRecord(offset, fileSize, record)) {
+        stats.invalidRecords += 1;
+        break;
+      }
+
+      candidates.push_back(record);
+      offset = size_t(record.data - file) + record.size;
+    }
+
+    // Validate checksums in parallel, this is where
+    // the bulk of the time is spent for large files
+    std::vector<uint8_t> valid(candidates.size());
+    size_t taskCount = (candidates.size() + RecordsPerTask - 1) / RecordsPerTask;
+
+    concurrency::parallel_for<size_t>(0, taskCount, [&] (size_t task) {
+      size_t first = task * RecordsPerTask;
+      size_t last  = std::min(first + RecordsPerTask, candidates.size());
+
+      for (size_t i = first; i < last; i++) {
+        const auto& record = candidates[i];
+        valid[i] = record.checksum == computeChecksum(record.stageMask, record.data, record.size);
+      }
+    });
+
+    // Drop invalid and duplicate records, keeping the first
+    // occurrence of each record with its most recent use
+    std::unordered_multimap<uint64_t, uint32_t> recordMap;
+    recordMap.reserve(candidates.size());
+    records.reserve(candidates.size());
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+      const auto& record = candidates[i];
+
+      if (!valid[i]) {
+        stats.invalidRecords += 1;
+        continue;
+      }
+
+      auto range = recordMap.equal_range(record.checksum);
+      auto match = std::find_if(range.first, range.second, [&] (const auto& e) {
+        const auto& other = records[e.second];
+
+        return other.size      == record.size
+            && other.stageMask == record.stageMask
+            && !std::memcmp(other.data, record.data, record.size);
+      });
+
+      if (match != range.second) {
+        auto& other = records[match->second];
+        other.lastUse = std::max(other.lastUse, record.lastUse);
+        stats.duplicateRecords += 1;
+        continue;
+      }
+
+      recordMap.insert({ record.checksum, uint32_t(records.size()) });
+      records.push_back(record);
+
+      if (i < indexedCount)
+        stats.indexedRecords += 1;
+      else
+        stats.appendedRecords += 1;
+    }
+
+    return true;
+  }
+
+
+  std::vector<uint32_t> DxvkStateCacheFile::compact(
+    const std::vector<DxvkStateCacheRecord>& records,
+          uint32_t                    session,
+          uint32_t                    maxUnusedSessions) {
+    std::vector<uint32_t> order;
+    order.reserve(records.size());
+
+    for (uint32_t i = 0; i < records.size(); i++) {
+      uint32_t lastUse = std::min(records[i].lastUse, session);
+
+      if (!maxUnusedSessions || session - lastUse <= maxUnusedSessions)
+        order.push_back(i);
+    }
+
+    // Stable so that records used in the same
+    // session keep their relative order
+    std::stable_sort(order.begin(), order.end(), [&] (uint32_t a, uint32_t b) {
+      return records[a].lastUse > records[b].lastUse;
+    });
+
+    return order;
+  }
+
+
+  void DxvkStateCacheFile::write(
+          std::ostream&               stream,
+          size_t                      bodyOffset,
+          uint32_t                    session,
+    const std::vector<DxvkStateCacheRecord>& records,
+          DxvkStateCacheIndexHeader&  indexHeader,
+          std::vector<DxvkStateCacheIndexEntry>& index) {
+    uint64_t offset = getRecordOffset(bodyOffset, records.size());
+
+    index.resize(records.size());
+
+    for (size_t i = 0; i < records.size(); i++) {
+      index[i].offset  = offset;
+      index[i].lastUse = records[i].lastUse;
+
+      offset += sizeof(DxvkStateCacheRecordHeader) + records[i].size;
+    }
+
+    indexHeader = DxvkStateCacheIndexHeader();
+    indexHeader.session        = session;
+    indexHeader.compactSession = session;
+    indexHeader.entryCount     = uint32_t(index.size());
+    indexHeader.tailOffset     = offset;
+
+    writeIndex(stream, indexHeader, index);
+
+    for (const auto& record : records)
+      writeRecord(stream, record);
+
+    stream.flush();
+  }
+
+
+  void DxvkStateCacheFile::writeIndex(
+          std::ostream&               stream,
+    const DxvkStateCacheIndexHeader&  indexHeader,
+    const std::vector<DxvkStateCacheIndexEntry>& index) {
+    stream.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+    stream.write(reinterpret_cast<const char*>(index.data()), sizeof(DxvkStateCacheIndexEntry) * index.size());
+  }
+
+
+  void DxvkStateCacheFile::writeRecord(
+          std::ostream&               stream,
+    const DxvkStateCacheRecord&       record) {
+    DxvkStateCacheRecordHeader header;
+    header.stageMask = record.stageMask;
+    header.entrySize = record.size;
+    header.lastUse   = record.lastUse;
+    header.checksum  = record.checksum;
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(record.data, record.size);
+  }
+
+}
@@ -0,0 +1,237 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Index header of indexed state cache files
+   *
+   * Follows the state cache header from version 11 on. The
+   * index lists all records written by the last compaction,
+   * records appended since then start at the tail offset and
+   * are found by walking their record headers.
+   */
+  struct DxvkStateCacheIndexHeader {
+    uint32_t session        = 0;  // Last session the file was used in
+    uint32_t compactSession = 0;  // Session the file was last compacted in
+    uint32_t entryCount     = 0;  // Number of index entries
+    uint32_t reserved       = 0;
+    uint64_t tailOffset     = 0;  // File offset of the first appended record
+  };
+
+  static_assert(sizeof(DxvkStateCacheIndexHeader) == 24);
+
+
+  /**
+   * \brief State cache index entry
+   *
+   * Locates an indexed record. The last use is kept in the
+   * index rather than in the record so that it can be
+   * updated in place without touching the records.
+   */
+  struct DxvkStateCacheIndexEntry {
+    uint64_t offset   = 0;  // File offset of the record header
+    uint32_t lastUse  = 0;  // Session the entry was last used in
+    uint32_t reserved = 0;
+  };
+
+  static_assert(sizeof(DxvkStateCacheIndexEntry) == 16);
+
+
+  /**
+   * \brief State cache record header
+   *
+   * Precedes the serialized entry data. The checksum covers
+   * the stage mask, the size and the data, and is only meant
+   * to detect corruption, not tampering.
+   */
+  struct DxvkStateCacheRecordHeader {
+    uint32_t stageMask : 8;
+    uint32_t entrySize : 24;
+    uint32_t lastUse;
+    uint64_t checksum;
+  };
+
+  static_assert(sizeof(DxvkStateCacheRecordHeader) == 16);
+
+
+  /**
+   * \brief State cache record
+   *
+   * Serialized entry data and its metadata. The data pointer
+   * refers to the buffer the record was parsed from.
+   */
+  struct DxvkStateCacheRecord {
+    const char* data      = nullptr;
+    uint32_t    size      = 0;
+    uint32_t    stageMask = 0;
+    uint32_t    lastUse   = 0;
+    uint64_t    checksum  = 0;
+  };
+
+
+  /**
+   * \brief State cache file statistics
+   */
+  struct DxvkStateCacheFileStats {
+    uint32_t indexedRecords   = 0;
+    uint32_t appendedRecords  = 0;
+    uint32_t invalidRecords   = 0;
+    uint32_t duplicateRecords = 0;
+  };
+
+
+  /**
+   * \brief Indexed state cache file
+   *
+   * Reads and writes the body of state cache files that
+   * follows the common state cache header: an index header,
+   * the index, and the records. Knows nothing about the
+   * serialized entries themselves.
+   */
+  class DxvkStateCacheFile {
+
+  public:
+
+    /**
+     * \brief Computes the checksum of a record
+     *
+     * \param [in] stageMask Shader stage mask
+     * \param [in] data Serialized entry data
+     * \param [in] size Size of the entry data
+     * \returns Checksum
+     */
+    static uint64_t computeChecksum(
+            uint32_t                    stageMask,
+      const void*                       data,
+            size_t                      size);
+
+    /**
+     * \brief Parses the body of a cache file
+     *
+     * Validates the checksums of all records in parallel and
+     * drops invalid and duplicate records. Of duplicates, the
+     * first one is kept with the most recent last use. Indexed
+     * records come first and keep their index order, records
+     * appended after them follow in file order.
+     * \param [in] file Contents of the entire file
+     * \param [in] fileSize Size of the file
+     * \param [in] bodyOffset Offset of the index header
+     * \param [out] indexHeader Index header
+     * \param [out] index Index as stored in the file
+     * \param [out] records Valid, unique records
+     * \param [out] stats Record statistics
+     * \returns \c false if the index is unusable
+     */
+    static bool parse(
+      const char*                       file,
+            size_t                      fileSize,
+            size_t                      bodyOffset,
+            DxvkStateCacheIndexHeader&  indexHeader,
+            std::vector<DxvkStateCacheIndexEntry>& index,
+            std::vector<DxvkStateCacheRecord>& records,
+            DxvkStateCacheFileStats&    stats);
+
+    /**
+     * \brief Orders records for compaction
+     *
+     * Orders records by last use, most recently used first,
+     * and drops records which have not been used for more
+     * than the given number of sessions.
+     * \param [in] records Records to compact
+     * \param [in] session Current session
+     * \param [in] maxUnusedSessions Maximum number of sessions
+     *    a record may go unused, or 0 to keep all records
+     * \returns Indices of the records to keep, in index order
+     */
+    static std::vector<uint32_t> compact(
+      const std::vector<DxvkStateCacheRecord>& records,
+            uint32_t                    session,
+            uint32_t                    maxUnusedSessions);
+
+    /**
+     * \brief Writes the body of a compacted cache file
+     *
+     * Writes the index header, the index, and all records.
+     * \param [in] stream Output stream, positioned at the body offset
+     * \param [in] bodyOffset Offset of the index header
+     * \param [in] session Current session
+     * \param [in] records Records, in index order
+     * \param [out] indexHeader Index header as written to the file
+     * \param [out] index Index as written to the file
+     */
+    static void write(
+            std::ostream&               stream,
+            size_t                      bodyOffset,
+            uint32_t                    session,
+      const std::vector<DxvkStateCacheRecord>& records,
+            DxvkStateCacheIndexHeader&  indexHeader,
+            std::vector<DxvkStateCacheIndexEntry>& index);
+
+    /**
+     * \brief Rewrites the index in place
+     *
+     * Used to store updated last use information
+     * without rewriting any of the records.
+     * \param [in] stream Output stream, positioned at the body offset
+     * \param [in] indexHeader Index header
+     * \param [in] index Index entries
+     */
+    static void writeIndex(
+            std::ostream&               stream,
+      const DxvkStateCacheIndexHeader&  indexHeader,
+      const std::vector<DxvkStateCacheIndexEntry>& index);
+
+    /**
+     * \brief Appends a single record
+     *
+     * \param [in] stream Output stream, positioned at the end of the file
+     * \param [in] record Record to append
+     */
+    static void writeRecord(
+            std::ostream&               stream,
+      const DxvkStateCacheRecord&       record);
+
+    /**
+     * \brief Computes the offset of the first record
+     *
+     * \param [in] bodyOffset Offset of the index header
+     * \param [in] entryCount Number of index entries
+     * \returns Offset of the first indexed record
+     */
+    static size_t getRecordOffset(
+            size_t                      bodyOffset,
+            size_t                      entryCount) {
+      return bodyOffset
+        + sizeof(DxvkStateCacheIndexHeader)
+        + sizeof(DxvkStateCacheIndexEntry) * entryCount;
+    }
+
+  };
+
+}
@@ -52,7 +52,7 @@ namespace dxvk {
    */
   struct DxvkStateCacheHeader {
     char     magic[4]   = { 'D', 'X', 'V', 'K' };
-    uint32_t version    = 10;
+    uint32_t version    = 11;
     uint32_t entrySize  = 0; /* no longer meaningful */
   };
 
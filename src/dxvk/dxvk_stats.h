@@ -28,6 +28,12 @@ namespace dxvk {
     RtxSurfaceMaterialCount,  ///< Number of surface materials in the scene
     RtxVolumeMaterialCount,   ///< Number of volume materials in the scene
     RtxLightCount,            ///< Number of lights currently present in the scene
+    RtxTextureAlphaOpaqueCount,      ///< Number of instances made opaque by the alpha of their texture last frame
+    RtxTextureAlphaTransparentCount, ///< Number of instances hidden by the alpha of their texture last frame
+    RtxDeferredBlasBuildCount,       ///< Number of static BLAS builds deferred to a later frame last frame
+    D3D9GeometryHostReadBytes,   ///< Estimated geometry bytes read by draws from host memory last frame
+    D3D9GeometryDeviceReadBytes, ///< Estimated geometry bytes read by draws from device memory last frame
+    D3D9GeometryUploadBytes,     ///< Geometry bytes copied from shadow copies to device memory last frame
     NumCounters,              ///< Number of counters available
   };
   
@@ -0,0 +1,158 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Submission timeline
+   *
+   * Abstracts the timeline semaphore which the GPU signals
+   * with a monotonically increasing value per submission.
+   */
+  class DxvkSubmissionTimeline {
+
+  public:
+
+    virtual ~DxvkSubmissionTimeline() { }
+
+    /**
+     * \brief Queries the last value signaled by the GPU
+     *
+     * Throws a \c DxvkError if the timeline cannot be
+     * queried, e.g. on device loss.
+     * \returns Completed timeline value
+     */
+    virtual uint64_t getCompletedValue() = 0;
+
+    /**
+     * \brief Waits for a timeline value to be signaled
+     *
+     * \param [in] value Value to wait for
+     * \returns \c false if the wait failed, e.g. on device loss
+     */
+    virtual bool wait(uint64_t value) = 0;
+
+  };
+
+
+  /**
+   * \brief Submission tracker
+   *
+   * Tracks in-flight submissions by the timeline value they
+   * signal on completion. Since the timeline is monotonic, a
+   * single query retires every submission up to the signaled
+   * value in one batch, in submission order.
+   */
+  template<typename T>
+  class DxvkSubmissionTracker {
+
+  public:
+
+    explicit DxvkSubmissionTracker(DxvkSubmissionTimeline& timeline)
+    : m_timeline(timeline) { }
+
+    /**
+     * \brief Adds a submission
+     *
+     * Values must be strictly increasing.
+     * \param [in] value Timeline value signaled by the submission
+     * \param [in] payload Data to retire once the value is reached
+     */
+    void push(uint64_t value, T&& payload) {
+      m_entries.push_back({ value, std::move(payload) });
+    }
+
+    bool empty() const {
+      return m_entries.empty();
+    }
+
+    size_t size() const {
+      return m_entries.size();
+    }
+
+    /**
+     * \brief Timeline value of the oldest pending submission
+     * \returns Value to wait for, or 0 if nothing is pending
+     */
+    uint64_t oldestValue() const {
+      return m_entries.empty() ? 0 : m_entries.front().value;
+    }
+
+    /**
+     * \brief Retires completed submissions
+     *
+     * Queries the timeline once and moves the payloads of all
+     * submissions whose value has been reached to \c retired.
+     * Nothing is retired if the timeline query throws.
+     * \param [out] retired Payloads of completed submissions
+     * \returns Number of retired submissions
+     */
+    size_t retireCompleted(std::vector<T>& retired) {
+      if (m_entries.empty())
+        return 0;
+
+      return retireUpTo(m_timeline.getCompletedValue(), retired);
+    }
+
+    /**
+     * \brief Retires all submissions regardless of the timeline
+     *
+     * Used when the device was lost and the timeline
+     * is not going to advance anymore.
+     * \param [out] retired Payloads of all pending submissions
+     * \returns Number of retired submissions
+     */
+    size_t retireAll(std::vector<T>& retired) {
+      return retireUpTo(UINT64_MAX, retired);
+    }
+
+  private:
+
+    struct Entry {
+      uint64_t value;
+      T        payload;
+    };
+
+    DxvkSubmissionTimeline& m_timeline;
+    std::deque<Entry>       m_entries;
+
+    size_t retireUpTo(uint64_t value, std::vector<T>& retired) {
+      size_t count = 0;
+
+      while (!m_entries.empty() && m_entries.front().value <= value) {
+        retired.push_back(std::move(m_entries.front().payload));
+        m_entries.pop_front();
+        count += 1;
+      }
+
+      return count;
+    }
+
+  };
+
+}
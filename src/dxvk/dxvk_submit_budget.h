@@ -0,0 +1,140 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+namespace dxvk {
+
+  /**
+   * \brief Submission budget limits
+   *
+   * Amount of work after which the current command list
+   * should be submitted. A limit of zero disables it.
+   */
+  struct DxvkSubmitBudgetLimits {
+    uint64_t copyBytes         = 0;
+    uint32_t accelStructBuilds = 0;
+    uint32_t dispatches        = 0;
+  };
+
+
+  /**
+   * \brief Submission budget
+   *
+   * Accumulates the work recorded into the current command
+   * list and decides when it is worth submitting early, so
+   * that the GPU can start on large uploads and builds while
+   * the rest of the frame is still being recorded.
+   *
+   * The budget never submits by itself. Work is recorded from
+   * deep inside context operations, e.g. while pending draw
+   * calls are being turned into RT geometry, and callers up
+   * the stack may still hold on to the command list. Splitting
+   * there would move the remainder of that operation into a
+   * command list that has already been submitted. Instead, an
+   * exhausted budget is only acted upon between commands, see
+   * \ref DxvkContext::flushCommandListIfNeeded.
+   */
+  class DxvkSubmitBudget {
+
+  public:
+
+    void setLimits(const DxvkSubmitBudgetLimits& limits) {
+      m_limits = limits;
+      update();
+    }
+
+    const DxvkSubmitBudgetLimits& getLimits() const {
+      return m_limits;
+    }
+
+    /**
+     * \brief Records a transfer
+     * \param [in] bytes Number of bytes copied
+     */
+    void recordCopy(uint64_t bytes) {
+      m_work.copyBytes += bytes;
+      update();
+    }
+
+    /**
+     * \brief Records acceleration structure builds
+     * \param [in] count Number of builds
+     */
+    void recordAccelStructBuilds(uint32_t count) {
+      m_work.accelStructBuilds += count;
+      update();
+    }
+
+    /**
+     * \brief Records a compute or ray tracing dispatch
+     */
+    void recordDispatch() {
+      m_work.dispatches += 1;
+      update();
+    }
+
+    /**
+     * \brief Checks whether the command list should be submitted
+     * \returns \c true if any limit has been reached
+     */
+    bool isExhausted() const {
+      return m_exhausted;
+    }
+
+    /**
+     * \brief Work recorded since the last reset
+     */
+    const DxvkSubmitBudgetLimits& getRecordedWork() const {
+      return m_work;
+    }
+
+    /**
+     * \brief Resets the budget
+     *
+     * Called whenever a new command list is started.
+     */
+    void reset() {
+      m_work = DxvkSubmitBudgetLimits();
+      m_exhausted = false;
+    }
+
+  private:
+
+    DxvkSubmitBudgetLimits m_limits;
+    DxvkSubmitBudgetLimits m_work;
+    bool                   m_exhausted = false;
+
+    static bool reached(uint64_t work, uint64_t limit) {
+      return limit != 0 && work >= limit;
+    }
+
+    void update() {
+      m_exhausted = reached(m_work.copyBytes,         m_limits.copyBytes)
+                 || reached(m_work.accelStructBuilds, m_limits.accelStructBuilds)
+                 || reached(m_work.dispatches,        m_limits.dispatches);
+    }
+
+  };
+
+}
@@ -60,6 +60,18 @@ namespace dxvk::hud {
     void addItem(const char* name, int32_t at, Args... args) {
       m_hudItems.add<T>(name, at, std::forward<Args>(args)...);
     }
+
+    // NV-DXVK start: shadowed geometry buffers
+    /**
+     * \brief Checks whether a HUD item is enabled
+     *
+     * \param [in] name HUD item name
+     * \returns \c true if the item is shown
+     */
+    bool isItemEnabled(const char* name) const {
+      return m_hudItems.isEnabled(name);
+    }
+    // NV-DXVK end
     
     /**
      * \brief Creates the HUD
@@ -717,7 +717,13 @@ namespace dxvk::hud {
                                    "# Instances/Surfaces:" , 
                                    "# Surface Materials:" , 
                                    "# Volume Materials:" , 
-                                   "# Lights:" }; 
+                                   "# Lights:" ,
+                                   "# Alpha Promoted Opaque:" ,
+                                   "# Alpha Promoted Hidden:" ,
+                                   "# BLAS Builds Deferred:" ,
+                                   "Geometry host reads (KB):" ,
+                                   "Geometry VRAM reads (KB):" ,
+                                   "Geometry uploads (KB):" }; 
     const uint64_t values[] = { counters.getCtr(DxvkStatCounter::QueuePresentCount),
                                 counters.getCtr(DxvkStatCounter::RtxBlasCount),
                                 counters.getCtr(DxvkStatCounter::RtxBufferCount),
@@ -725,7 +731,13 @@ namespace dxvk::hud {
                                 counters.getCtr(DxvkStatCounter::RtxInstanceCount),
                                 counters.getCtr(DxvkStatCounter::RtxSurfaceMaterialCount),
                                 counters.getCtr(DxvkStatCounter::RtxVolumeMaterialCount),
-                                counters.getCtr(DxvkStatCounter::RtxLightCount)};
+                                counters.getCtr(DxvkStatCounter::RtxLightCount),
+                                counters.getCtr(DxvkStatCounter::RtxTextureAlphaOpaqueCount),
+                                counters.getCtr(DxvkStatCounter::RtxTextureAlphaTransparentCount),
+                                counters.getCtr(DxvkStatCounter::RtxDeferredBlasBuildCount),
+                                counters.getCtr(DxvkStatCounter::D3D9GeometryHostReadBytes) / 1024,
+                                counters.getCtr(DxvkStatCounter::D3D9GeometryDeviceReadBytes) / 1024,
+                                counters.getCtr(DxvkStatCounter::D3D9GeometryUploadBytes) / 1024};
 
     const uint32_t kNumLabels = sizeof(labels) / sizeof(labels[0]);
     static_assert(kNumLabels == sizeof(values) / sizeof(values[0]));
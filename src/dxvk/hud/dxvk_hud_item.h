@@ -82,22 +82,27 @@ namespace dxvk::hud {
      */
     template<typename T, typename... Args>
     void add(const char* name, int32_t at, Args... args) {
-      bool enable = m_enableFull;
-
-      if (!enable) {
-        auto entry = m_enabled.find(name);
-        enable = entry != m_enabled.end();
-      }
-
       if (at < 0 || at > int32_t(m_items.size()))
         at = m_items.size();
 
-      if (enable) {
+      if (isEnabled(name)) {
         m_items.insert(m_items.begin() + at,
           new T(std::forward<Args>(args)...));
       }
     }
 
+    // NV-DXVK start: shadowed geometry buffers
+    /**
+     * \brief Checks whether a HUD item is enabled
+     *
+     * \param [in] name HUD item name
+     * \returns \c true if the item is shown
+     */
+    bool isEnabled(const char* name) const {
+      return m_enableFull || m_enabled.find(name) != m_enabled.end();
+    }
+    // NV-DXVK end
+
     template<typename T>
     T getOption(const char *option, T fallback) {
       auto entry = m_options.find(option);
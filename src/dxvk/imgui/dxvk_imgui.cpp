@@ -42,6 +42,7 @@
 #include "../util/util_math.h"
 #include "rtx_render/rtx_opacity_micromap_manager.h"
 #include "rtx_render/rtx_bridgemessagechannel.h"
+#include "rtx_render/rtx_game_capturer_paths.h"
 #include "dxvk_imgui_about.h"
 #include "dxvk_imgui_splash.h"
 #include "dxvk_scoped_annotation.h"
@@ -1203,6 +1204,68 @@ namespace dxvk {
       ImGui::Checkbox("Validate CPU index data", &RtxOptions::Get()->validateCPUIndexDataObject());
     }
 
+    if (ImGui::CollapsingHeader("Asset Costs", collapsingHeaderClosedFlags)) {
+      ImGui::Indent();
+      ImGui::Checkbox("Enable##AssetCosts", &RtxOptions::Get()->assetCostLedger.enableObject());
+      ImGui::BeginDisabled(!RtxOptions::Get()->assetCostLedger.enable());
+      ImGui::DragInt("Listed Assets", &RtxOptions::Get()->assetCostLedger.topCountObject(), 1.f, 1, 1000, "%d", sliderFlags);
+
+      static int sortCost = int(AssetCost::Triangles);
+      static int sortPeriod = int(AssetCostPeriod::Average);
+      ImGui::Combo("Sort By", &sortCost, "Instances\0Triangles\0BLAS Build Triangles\0BLAS Memory\0Opacity Micromap Memory\0Texture Memory\0");
+      ImGui::Combo("Period", &sortPeriod, "Last Frame\0Average\0Peak\0");
+
+      SceneManager& sceneManager = m_device->getCommon()->getSceneManager();
+      const AssetCostLedger& assetCostLedger = sceneManager.getAssetCostLedger();
+
+      if (ImGui::Button("Dump Asset Costs")) {
+        sceneManager.dumpAssetCosts();
+      }
+      ImGui::SetTooltipToLastWidgetOnHover("Writes the costs of all tracked assets to '%s'", relPath::remixAssetCostsPath.c_str());
+
+      ImGui::SameLine();
+      ImGui::Text("Tracked Assets: %zu", assetCostLedger.getEntryCount());
+
+      // Note: Memory costs are shown in MiB, the rest as counts
+      static const char* columnNames[] = { "Instances", "Triangles", "BLAS Build Tris", "BLAS MiB", "OMM MiB", "Texture MiB" };
+      static_assert(IM_ARRAYSIZE(columnNames) == int(AssetCostLedger::kCostCount), "Column names do not match the asset costs");
+
+      const AssetCostPeriod period = AssetCostPeriod(sortPeriod);
+      const auto rows = assetCostLedger.getTopAssets(AssetCost(sortCost), period, RtxOptions::Get()->assetCostLedger.topCount());
+
+      if (ImGui::BeginTable("Asset Costs", 1 + AssetCostLedger::kCostCount, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Asset Hash");
+        for (const char* columnName : columnNames) {
+          ImGui::TableSetupColumn(columnName);
+        }
+        ImGui::TableHeadersRow();
+
+        for (const AssetCostLedger::Row& row : rows) {
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Text("0x%" PRIx64, row.assetHash);
+
+          for (uint32_t i = 0; i < AssetCostLedger::kCostCount; i++) {
+            const AssetCost cost = AssetCost(i);
+            const bool isMemoryCost = cost == AssetCost::BlasBytes || cost == AssetCost::OpacityMicromapBytes || cost == AssetCost::TextureBytes;
+
+            ImGui::TableNextColumn();
+
+            if (isMemoryCost) {
+              ImGui::Text("%.2f", row.get(cost, period) / (1024.f * 1024.f));
+            } else {
+              ImGui::Text("%.0f", row.get(cost, period));
+            }
+          }
+        }
+
+        ImGui::EndTable();
+      }
+
+      ImGui::EndDisabled();
+      ImGui::Unindent();
+    }
+
     ImGui::PopItemWidth();
   }
 
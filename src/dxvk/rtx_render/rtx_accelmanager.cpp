@@ -28,6 +28,9 @@
 #include "rtx_opacity_micromap_manager.h"
 #include "rtx_scenemanager.h"
 #include "rtx_accelmanager.h"
+#include "rtx_asset_cost_ledger.h"
+#include "rtx_blas_build_scheduler.h"
+#include "rtx_game_capturer_paths.h"
 
 #include "../d3d9/d3d9_state.h"
 #include "rtx_matrix_helpers.h"
@@ -45,10 +48,64 @@ namespace dxvk {
   // Make this static and not a member of AccelManager to make it safe updating the count from ~PooledBlas()
   static int g_blasCount = 0;
 
+  namespace {
+    // Serialized acceleration structures start with the driver UUID and the compatibility UUID,
+    // followed by the serialized size, the deserialized size and the number of handles.
+    constexpr size_t kSerializedBlasVersionDataSize = 2 * VK_UUID_SIZE;
+    constexpr size_t kSerializedBlasSerializedSizeOffset = kSerializedBlasVersionDataSize;
+    constexpr size_t kSerializedBlasDeserializedSizeOffset = kSerializedBlasVersionDataSize + sizeof(uint64_t);
+    constexpr size_t kSerializedBlasHeaderSize = kSerializedBlasVersionDataSize + 3 * sizeof(uint64_t);
+
+    // Serialization source and destination addresses must be aligned to 256 bytes
+    constexpr VkDeviceSize kBlasSerializationAlignment = 256;
+    constexpr uint32_t kMaxPendingBlasSerializations = 64;
+    constexpr uint32_t kMaxBlasSerializationsPerFrame = 8;
+
+    class VulkanBlasCacheSerializer : public BlasCacheSerializer {
+    public:
+      VulkanBlasCacheSerializer(DxvkDevice* device)
+        : m_device(device) {
+      }
+
+      bool isCompatible(const std::vector<uint8_t>& serializedData) const override {
+        if (serializedData.size() < kSerializedBlasHeaderSize) {
+          return false;
+        }
+
+        uint64_t serializedSize;
+        memcpy(&serializedSize, serializedData.data() + kSerializedBlasSerializedSizeOffset, sizeof(serializedSize));
+
+        if (serializedSize > serializedData.size()) {
+          return false;
+        }
+
+        VkAccelerationStructureVersionInfoKHR versionInfo {};
+        versionInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_VERSION_INFO_KHR;
+        versionInfo.pVersionData = serializedData.data();
+
+        VkAccelerationStructureCompatibilityKHR compatibility = VK_ACCELERATION_STRUCTURE_COMPATIBILITY_INCOMPATIBLE_KHR;
+        m_device->vkd()->vkGetDeviceAccelerationStructureCompatibilityKHR(m_device->handle(), &versionInfo, &compatibility);
+
+        return compatibility == VK_ACCELERATION_STRUCTURE_COMPATIBILITY_COMPATIBLE_KHR;
+      }
+
+    private:
+      DxvkDevice* m_device;
+    };
+  }
+
   AccelManager::AccelManager(Rc<DxvkDevice> device)
     : m_device(device) {
   }
 
+  AccelManager::~AccelManager() {
+    m_blasSerializationRequests.clear();
+
+    if (m_blasSerializationQueryPool != VK_NULL_HANDLE) {
+      m_device->vkd()->vkDestroyQueryPool(m_device->handle(), m_blasSerializationQueryPool, nullptr);
+    }
+  }
+
   void AccelManager::clear() {
     m_blasPool.clear();
   }
@@ -131,6 +188,13 @@ namespace dxvk {
     return true;
   }
 
+  static bool splitsBillboardGeometry(const BlasEntry& blasEntry, const RtInstance& instance, const OpacityMicromapManager* opacityMicromapManager) {
+    return instance.getBillboardCount() > 0 && blasEntry.modifiedGeometryData.usesIndices() &&
+      (opacityMicromapManager &&
+       opacityMicromapManager->getSettings().splitBillboardGeometry &&
+       opacityMicromapManager->doesInstanceUseOpacityMicromap(instance));
+  }
+
   static void fillGeometryInfoFromBlasEntry(const BlasEntry& blasEntry, RtInstance& instance, const OpacityMicromapManager* opacityMicromapManager) {
 
     instance.buildGeometries.clear();
@@ -138,13 +202,8 @@ namespace dxvk {
     instance.billboardIndices.clear();
     instance.indexOffsets.clear();
 
-    const bool usesIndices = blasEntry.modifiedGeometryData.usesIndices();
-
     // Associate each billboard with a unique geometry entry
-    if (instance.getBillboardCount() > 0 && usesIndices && 
-        (opacityMicromapManager && 
-         opacityMicromapManager->getSettings().splitBillboardGeometry &&
-         opacityMicromapManager->doesInstanceUseOpacityMicromap(instance))) {
+    if (splitsBillboardGeometry(blasEntry, instance, opacityMicromapManager)) {
 
       VkAccelerationStructureGeometryKHR geometry = {};
       geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
@@ -210,6 +269,32 @@ namespace dxvk {
     }
   }
 
+  // Determines whether the geometry of a BLAS entry is built into a static BLAS of its own rather than a merged one.
+  // Geometry too large for merged BLASes is forced into a static BLAS from the first frame it is seen.
+  static bool shouldUseStaticBlas(const BlasEntry& blasEntry, uint32_t currentFrame, bool& isForced) {
+    const uint32_t minPrimsForStaticBlas = std::max(RtxOptions::Get()->getMinPrimsInStaticBLAS(), 100u);
+    const uint32_t maxPrimsForMergedBlas = RtxOptions::Get()->maxPrimsInMergedBLAS();
+    constexpr uint32_t minFramesWithNoUpdates = 1;
+    uint32_t blasPrims = blasEntry.modifiedGeometryData.calculatePrimitiveCount();
+
+    const bool promoteToStaticBlas = blasPrims > minPrimsForStaticBlas &&
+      blasEntry.frameLastUpdated + minFramesWithNoUpdates < currentFrame;
+    isForced = blasPrims >= maxPrimsForMergedBlas &&
+      blasEntry.input.getSkinningState().numBones == 0 &&
+      blasEntry.frameCreated == blasEntry.frameLastUpdated;
+
+    return promoteToStaticBlas || isForced;
+  }
+
+  // Determines whether an instance gets its geometry built into a static BLAS, only single geometry instances can be.
+  // Note: Used both when scheduling static BLAS builds and when building them so the two agree on the candidates.
+  static bool shouldBuildStaticBlas(const BlasEntry& blasEntry, const RtInstance& instance, const OpacityMicromapManager* opacityMicromapManager,
+                                    uint32_t currentFrame, bool& isForced) {
+    const uint32_t buildGeometryCount = splitsBillboardGeometry(blasEntry, instance, opacityMicromapManager) ? instance.getBillboardCount() : 1;
+
+    return shouldUseStaticBlas(blasEntry, currentFrame, isForced) && buildGeometryCount == 1;
+  }
+
   void AccelManager::createAndBuildIntersectionBlas(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList, DxvkBarrierSet& execBarriers) {
     if (m_intersectionBlas.ptr())
       return;
@@ -293,6 +378,211 @@ namespace dxvk {
     return newBlas;
   }
 
+  void AccelManager::initializeBlasDiskCache() {
+    const DxvkDeviceInfo& properties = m_device->properties();
+
+    // Serialized BLASes are only guaranteed to be valid for the same device and driver
+    m_blasCacheDeviceHash = XXH64(properties.coreDeviceId.deviceUUID, VK_UUID_SIZE, 0);
+    m_blasCacheDeviceHash = XXH64(properties.coreDeviceId.driverUUID, VK_UUID_SIZE, m_blasCacheDeviceHash);
+    m_blasCacheDeviceHash = XXH64(&properties.core.properties.driverVersion, sizeof(uint32_t), m_blasCacheDeviceHash);
+
+    VkQueryPoolCreateInfo queryPoolInfo {};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR;
+    queryPoolInfo.queryCount = kMaxPendingBlasSerializations;
+
+    if (m_device->vkd()->vkCreateQueryPool(m_device->handle(), &queryPoolInfo, nullptr, &m_blasSerializationQueryPool) != VK_SUCCESS) {
+      Logger::err("[RTX] Failed to create the BLAS serialization query pool, disabling the BLAS disk cache");
+      RtxOptions::Get()->enableBlasDiskCacheRef() = false;
+      return;
+    }
+
+    for (uint32_t i = kMaxPendingBlasSerializations; i > 0; i--) {
+      m_freeBlasSerializationQueries.push_back(i - 1);
+    }
+
+    m_blasCacheSerializer = std::make_unique<VulkanBlasCacheSerializer>(m_device.ptr());
+    m_blasDiskCache = std::make_unique<BlasDiskCache>(relPath::remixBlasCacheDir, uint64_t(RtxOptions::Get()->blasDiskCacheMaxSizeMB()) << 20, *m_blasCacheSerializer);
+
+    Logger::info(str::format("[RTX] BLAS disk cache: ", m_blasDiskCache->getEntryCount(), " entries, ", m_blasDiskCache->getSize() >> 20, " MB"));
+  }
+
+  bool AccelManager::getBlasCacheKey(const BlasEntry& blasEntry, const RtInstance& instance, const VkAccelerationStructureBuildGeometryInfoKHR& buildInfo, BlasCacheKey& key) const {
+    const RasterGeometry& geometryData = blasEntry.input.getGeometryData();
+
+    // Only replacement geometry has a content hash which is stable across runs
+    if (geometryData.persistentContentHash == kEmptyHash || blasEntry.input.getSkinningState().numBones != 0) {
+      return false;
+    }
+
+    const VkAccelerationStructureGeometryKHR& geometry = instance.buildGeometries[0];
+
+    key.geometryHash = geometryData.persistentContentHash;
+    key.deviceHash = m_blasCacheDeviceHash;
+    key.buildFlags = buildInfo.flags;
+    key.geometryFlags = geometry.flags;
+    key.vertexFormat = geometry.geometry.triangles.vertexFormat;
+    key.indexType = geometry.geometry.triangles.indexType;
+    key.primitiveCount = instance.buildRanges[0].primitiveCount;
+    key.vertexCount = geometry.geometry.triangles.maxVertex + 1;
+    return true;
+  }
+
+  Rc<DxvkBuffer> AccelManager::createBlasSerializationBuffer(VkDeviceSize size, VkDeviceSize& alignedOffset) const {
+    DxvkBufferCreateInfo info {};
+    info.size = size + kBlasSerializationAlignment;
+    info.usage = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+    info.stages = VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_HOST_BIT;
+    info.access = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_HOST_READ_BIT | VK_ACCESS_HOST_WRITE_BIT;
+
+    Rc<DxvkBuffer> buffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, DxvkMemoryStats::Category::RTXAccelerationStructure);
+
+    const VkDeviceAddress address = buffer->getDeviceAddress();
+    alignedOffset = align(address, kBlasSerializationAlignment) - address;
+
+    return buffer;
+  }
+
+  Rc<PooledBlas> AccelManager::loadCachedBlas(Rc<DxvkCommandList> cmdList, const BlasCacheKey& key) {
+    std::vector<uint8_t> serializedData;
+
+    // Note: the cache validates the data and evicts entries which are not compatible with the current driver,
+    //       on failure the caller falls back to building the BLAS
+    if (!m_blasDiskCache->load(key, serializedData)) {
+      return nullptr;
+    }
+
+    uint64_t deserializedSize;
+    memcpy(&deserializedSize, serializedData.data() + kSerializedBlasDeserializedSizeOffset, sizeof(deserializedSize));
+
+    VkDeviceSize offset;
+    Rc<DxvkBuffer> uploadBuffer = createBlasSerializationBuffer(serializedData.size(), offset);
+    memcpy(uploadBuffer->mapPtr(offset), serializedData.data(), serializedData.size());
+
+    Rc<PooledBlas> blas = createPooledBlas(deserializedSize);
+
+    VkCopyMemoryToAccelerationStructureInfoKHR copyInfo {};
+    copyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_ACCELERATION_STRUCTURE_INFO_KHR;
+    copyInfo.src.deviceAddress = uploadBuffer->getDeviceAddress() + offset;
+    copyInfo.dst = blas->accelStructure->getAccelStructure();
+    copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_DESERIALIZE_KHR;
+
+    cmdList->vkCmdCopyMemoryToAccelerationStructureKHR(&copyInfo);
+
+    cmdList->trackResource<DxvkAccess::Read>(uploadBuffer);
+    cmdList->trackResource<DxvkAccess::Write>(blas->accelStructure);
+
+    return blas;
+  }
+
+  void AccelManager::requestBlasSerialization(const Rc<PooledBlas>& blas, const BlasCacheKey& key) {
+    if (m_freeBlasSerializationQueries.empty()) {
+      // Try again when this geometry is built the next time
+      return;
+    }
+
+    BlasSerializationRequest request;
+    request.blas = blas;
+    request.key = key;
+    request.queryIndex = m_freeBlasSerializationQueries.back();
+    m_freeBlasSerializationQueries.pop_back();
+
+    m_blasSerializationRequests.push_back(std::move(request));
+  }
+
+  void AccelManager::writeBlasSerializationQueries(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList) {
+    bool barrierEmitted = false;
+
+    for (BlasSerializationRequest& request : m_blasSerializationRequests) {
+      if (request.queryWritten) {
+        continue;
+      }
+
+      // Wait for the BLAS builds before querying the serialization sizes
+      if (!barrierEmitted) {
+        ctx->emitMemoryBarrier(0,
+          VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+          VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+          VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+          VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR);
+        barrierEmitted = true;
+      }
+
+      const VkAccelerationStructureKHR accelStructure = request.blas->accelStructure->getAccelStructure();
+
+      cmdList->cmdResetQueryPool(m_blasSerializationQueryPool, request.queryIndex, 1);
+      cmdList->vkCmdWriteAccelerationStructuresPropertiesKHR(1, &accelStructure, VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR,
+                                                             m_blasSerializationQueryPool, request.queryIndex);
+      cmdList->trackResource<DxvkAccess::Read>(request.blas->accelStructure);
+
+      request.queryWritten = true;
+    }
+  }
+
+  void AccelManager::processBlasSerializationRequests(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList) {
+    uint32_t numSerializationsRecorded = 0;
+
+    for (uint32_t i = 0; i < m_blasSerializationRequests.size();) {
+      BlasSerializationRequest& request = m_blasSerializationRequests[i];
+      bool completed = false;
+
+      if (request.serializedBuffer == nullptr) {
+        // Serialize the BLAS once its build and the size query have finished on the GPU
+        if (request.queryWritten && !request.blas->accelStructure->isInUse(DxvkAccess::Write) &&
+            numSerializationsRecorded < kMaxBlasSerializationsPerFrame) {
+          uint64_t serializedSize = 0;
+          const VkResult result = m_device->vkd()->vkGetQueryPoolResults(m_device->handle(), m_blasSerializationQueryPool, request.queryIndex, 1,
+                                                                         sizeof(serializedSize), &serializedSize, sizeof(serializedSize), VK_QUERY_RESULT_64_BIT);
+
+          if (result == VK_SUCCESS) {
+            m_freeBlasSerializationQueries.push_back(request.queryIndex);
+
+            if (serializedSize >= kSerializedBlasHeaderSize) {
+              request.serializedSize = serializedSize;
+              request.serializedBuffer = createBlasSerializationBuffer(serializedSize, request.serializedOffset);
+
+              VkCopyAccelerationStructureToMemoryInfoKHR copyInfo {};
+              copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_TO_MEMORY_INFO_KHR;
+              copyInfo.src = request.blas->accelStructure->getAccelStructure();
+              copyInfo.dst.deviceAddress = request.serializedBuffer->getDeviceAddress() + request.serializedOffset;
+              copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_SERIALIZE_KHR;
+
+              cmdList->vkCmdCopyAccelerationStructureToMemoryKHR(&copyInfo);
+
+              cmdList->trackResource<DxvkAccess::Read>(request.blas->accelStructure);
+              cmdList->trackResource<DxvkAccess::Write>(request.serializedBuffer);
+
+              ++numSerializationsRecorded;
+            } else {
+              completed = true;
+            }
+          }
+        }
+      } else if (!request.serializedBuffer->isInUse(DxvkAccess::Write)) {
+        const uint8_t* serializedData = reinterpret_cast<const uint8_t*>(request.serializedBuffer->mapPtr(request.serializedOffset));
+        m_blasDiskCache->store(request.key, std::vector<uint8_t>(serializedData, serializedData + request.serializedSize));
+        completed = true;
+      }
+
+      if (completed) {
+        std::swap(m_blasSerializationRequests[i], m_blasSerializationRequests.back());
+        m_blasSerializationRequests.pop_back();
+        continue;
+      }
+
+      ++i;
+    }
+
+    if (numSerializationsRecorded > 0) {
+      // Make the serialized data visible to the host
+      ctx->emitMemoryBarrier(0,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+        VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        VK_ACCESS_HOST_READ_BIT);
+    }
+  }
+
   static void trackBlasBuildResources(Rc<DxvkCommandList> cmdList, DxvkBarrierSet& execBarriers, const BlasEntry* blasEntry) {
     cmdList->trackResource<DxvkAccess::Read>(blasEntry->modifiedGeometryData.positionBuffer.buffer());
     cmdList->trackResource<DxvkAccess::Read>(blasEntry->modifiedGeometryData.indexBuffer.buffer());
@@ -312,6 +602,76 @@ namespace dxvk {
       VK_ACCESS_SHADER_READ_BIT);
   }
 
+  std::unordered_set<const BlasEntry*> AccelManager::scheduleStaticBlasBuilds(const CameraManager& cameraManager, const std::vector<RtInstance*>& instances,
+                                                                                const OpacityMicromapManager* opacityMicromapManager, uint32_t currentFrame) {
+    std::unordered_set<const BlasEntry*> deferredBlasEntries;
+    m_deferredBlasBuildCount = 0;
+
+    const auto& options = RtxOptions::Get()->blasBuildBudget;
+
+    if (!options.enable())
+      return deferredBlasEntries;
+
+    const Vector3& cameraPosition = cameraManager.getMainCamera().getPosition();
+
+    std::vector<BlasBuildScheduler::Candidate> candidates;
+    std::vector<BlasEntry*> candidateEntries;
+    std::unordered_map<const BlasEntry*, uint32_t> candidateIndices;
+
+    // Collect the BLAS entries which would get a new static BLAS this frame
+    for (RtInstance* instance : instances) {
+      BlasEntry* blasEntry = instance->getBlas();
+
+      // Note: Instances with billboards are never deferred as other passes need their surfaces
+      if (instance->getVkInstance().mask == 0 || blasEntry == nullptr || blasEntry->staticBlas.ptr() || instance->getBillboardCount() > 0)
+        continue;
+
+      bool isForced;
+      if (!shouldBuildStaticBlas(*blasEntry, *instance, opacityMicromapManager, currentFrame, isForced))
+        continue;
+
+      // Note: Geometry whose bounds are unknown is ranked as if it was a unit sphere
+      const Matrix4 transform = instance->getTransform();
+      const float scale = std::max({ length(transform[0].xyz()), length(transform[1].xyz()), length(transform[2].xyz()) });
+      const float radius = (instance->getObjectRadius() >= 0.f ? instance->getObjectRadius() : 1.f) * scale;
+      const float projectedSize = BlasBuildScheduler::getProjectedSize(radius, length(instance->getWorldPosition() - cameraPosition));
+
+      auto entry = candidateIndices.emplace(blasEntry, uint32_t(candidates.size()));
+
+      if (entry.second) {
+        BlasBuildScheduler::Candidate candidate;
+        candidate.primitiveCount = blasEntry->modifiedGeometryData.calculatePrimitiveCount();
+        candidate.projectedSize = projectedSize;
+        candidate.framesDeferred = blasEntry->staticBlasFramesDeferred;
+
+        candidates.push_back(candidate);
+        candidateEntries.push_back(blasEntry);
+      } else {
+        // Geometry shared by several instances is ranked by the largest of them
+        BlasBuildScheduler::Candidate& candidate = candidates[entry.first->second];
+        candidate.projectedSize = std::max(candidate.projectedSize, projectedSize);
+      }
+    }
+
+    BlasBuildScheduler::Params params;
+    params.maxPrimitivesPerFrame = options.maxPrimitivesPerFrame();
+    params.maxDeferredFrames = options.maxDeferredFrames();
+
+    const std::vector<bool> approved = BlasBuildScheduler::schedule(candidates, params);
+
+    for (size_t i = 0; i < candidateEntries.size(); i++) {
+      if (approved[i]) {
+        candidateEntries[i]->staticBlasFramesDeferred = 0;
+      } else {
+        candidateEntries[i]->staticBlasFramesDeferred++;
+        deferredBlasEntries.insert(candidateEntries[i]);
+      }
+    }
+
+    m_deferredBlasBuildCount = uint32_t(deferredBlasEntries.size());
+    return deferredBlasEntries;
+  }
+
   void AccelManager::mergeInstancesIntoBlas(Rc<RtxContext> ctx, 
                                             Rc<DxvkCommandList> cmdList, 
                                             DxvkBarrierSet& execBarriers, 
@@ -319,6 +679,7 @@ namespace dxvk {
                                             const CameraManager& cameraManager,
                                             InstanceManager& instanceManager,
                                             OpacityMicromapManager* opacityMicromapManager,
+                                            AssetCostLedger* assetCostLedger,
                                             float frameTimeSecs) {
 
     ScopedGpuProfileZone(ctx, "buildBLAS");
@@ -362,6 +723,22 @@ namespace dxvk {
     if (opacityMicromapManager)
       opacityMicromapManager->onFrameStart(ctx, cmdList);
 
+    const bool useBlasDiskCache = RtxOptions::Get()->enableBlasDiskCache();
+
+    if (useBlasDiskCache) {
+      if (!m_blasDiskCache) {
+        initializeBlasDiskCache();
+      } else {
+        m_blasDiskCache->setMaxSize(uint64_t(RtxOptions::Get()->blasDiskCacheMaxSizeMB()) << 20);
+      }
+    }
+
+    if (m_blasDiskCache) {
+      processBlasSerializationRequests(ctx, cmdList);
+    }
+
+    const std::unordered_set<const BlasEntry*> deferredBlasEntries = scheduleStaticBlasBuilds(cameraManager, instances, opacityMicromapManager, currentFrame);
+
     std::vector<std::unique_ptr<BlasBucket>> blasBuckets;
     for (RtInstance* instance : instances) {
       // If the instance has zero mask, do not build BLAS for it: no ray can intersect this instance.
@@ -419,19 +796,15 @@ namespace dxvk {
       }
 
       // Figure out if this blas should be a static one
-      const uint32_t minPrimsForStaticBlas = std::max(RtxOptions::Get()->getMinPrimsInStaticBLAS(), 100u);
-      const uint32_t maxPrimsForMergedBlas = RtxOptions::Get()->maxPrimsInMergedBLAS();
-      constexpr uint32_t minFramesWithNoUpdates = 1;
-      uint32_t blasPrims = blasEntry->modifiedGeometryData.calculatePrimitiveCount();
-
-      const bool promoteToStaticBlas = blasPrims > minPrimsForStaticBlas &&
-        blasEntry->frameLastUpdated + minFramesWithNoUpdates < currentFrame;
-      const bool forceStaticBlas = blasPrims >= maxPrimsForMergedBlas &&
-        blasEntry->input.getSkinningState().numBones == 0 &&
-        blasEntry->frameCreated == blasEntry->frameLastUpdated;
-
-      if ((promoteToStaticBlas || forceStaticBlas) &&
-           instance->buildGeometries.size() == 1) {
+      bool forceStaticBlas;
+      const bool useStaticBlas = shouldBuildStaticBlas(*blasEntry, *instance, opacityMicromapManager, currentFrame, forceStaticBlas);
+      assert(!useStaticBlas || instance->buildGeometries.size() == 1);
+
+      // A deferred static BLAS build keeps the geometry in a merged BLAS until its turn, including geometry
+      // which is otherwise forced into a static BLAS.
+      const bool isStaticBlasBuildDeferred = !blasEntry->staticBlas.ptr() && deferredBlasEntries.count(blasEntry) != 0;
+
+      if (useStaticBlas && !isStaticBlasBuildDeferred) {
         if (!blasEntry->staticBlas.ptr()) {
           // Bind opacity micromap
           // Opacity micromaps must be bound before acceleration sizes are calculated
@@ -450,32 +823,50 @@ namespace dxvk {
           buildInfo.geometryCount = 1;
           buildInfo.pGeometries = instance->buildGeometries.data();
 
-          // Calculate the build sizes for this static BLAS
-          VkAccelerationStructureBuildSizesInfoKHR sizeInfo {};
-          sizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-          m_device->vkd()->vkGetAccelerationStructureBuildSizesKHR(m_device->handle(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
-                                                                   &buildInfo, &instance->buildRanges[0].primitiveCount, &sizeInfo);
+          // Static BLASes of replacement meshes without opacity micromaps can be loaded from the disk cache
+          BlasCacheKey blasCacheKey;
+          const bool cacheBlas = useBlasDiskCache && m_blasDiskCache && boundOpacityMicromapHash == kEmptyHash &&
+                                 getBlasCacheKey(*blasEntry, *instance, buildInfo, blasCacheKey);
+
+          if (cacheBlas) {
+            blasEntry->staticBlas = loadCachedBlas(cmdList, blasCacheKey);
+          }
+
+          if (!blasEntry->staticBlas.ptr()) {
+            // Calculate the build sizes for this static BLAS
+            VkAccelerationStructureBuildSizesInfoKHR sizeInfo {};
+            sizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+            m_device->vkd()->vkGetAccelerationStructureBuildSizesKHR(m_device->handle(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                                                     &buildInfo, &instance->buildRanges[0].primitiveCount, &sizeInfo);
+
+            blasEntry->staticBlas = createPooledBlas(sizeInfo.accelerationStructureSize);
+            blasEntry->staticBlas->opacityMicromapSourceHash = boundOpacityMicromapHash;
 
-          blasEntry->staticBlas = createPooledBlas(sizeInfo.accelerationStructureSize);
-          blasEntry->staticBlas->opacityMicromapSourceHash = boundOpacityMicromapHash;
+            buildInfo.dstAccelerationStructure = blasEntry->staticBlas->accelStructure->getAccelStructure();
 
-          buildInfo.dstAccelerationStructure = blasEntry->staticBlas->accelStructure->getAccelStructure();
+            // Allocate a scratch buffer slice
+            DxvkBufferSlice scratchSlice = scratchAllocator.alloc(scratchAlignment, sizeInfo.buildScratchSize + scratchAlignment);
+            buildInfo.scratchData.deviceAddress = scratchSlice.getDeviceAddress();
 
-          // Allocate a scratch buffer slice
-          DxvkBufferSlice scratchSlice = scratchAllocator.alloc(scratchAlignment, sizeInfo.buildScratchSize + scratchAlignment);
-          buildInfo.scratchData.deviceAddress = scratchSlice.getDeviceAddress();
+            // Put the new BLAS into the build queue
+            blasToBuild.push_back(buildInfo);
+            blasRangesToBuild.push_back(&instance->buildRanges[0]);
 
-          // Put the new BLAS into the build queue
-          blasToBuild.push_back(buildInfo);
-          blasRangesToBuild.push_back(&instance->buildRanges[0]);
+            if (assetCostLedger)
+              assetCostLedger->add(blasEntry->assetHash, AssetCost::BlasBuildTriangles, instance->buildRanges[0].primitiveCount);
 
-          // Track the lifetime of the scratch and BLAS buffers
-          cmdList->trackResource<DxvkAccess::Write>(scratchSlice.buffer());
-          cmdList->trackResource<DxvkAccess::Read>(scratchSlice.buffer());
-          cmdList->trackResource<DxvkAccess::Write>(blasEntry->staticBlas->accelStructure);
+            // Track the lifetime of the scratch and BLAS buffers
+            cmdList->trackResource<DxvkAccess::Write>(scratchSlice.buffer());
+            cmdList->trackResource<DxvkAccess::Read>(scratchSlice.buffer());
+            cmdList->trackResource<DxvkAccess::Write>(blasEntry->staticBlas->accelStructure);
 
-          // Track the lifetime and states of the source geometry buffers
-          trackBlasBuildResources(cmdList, execBarriers, blasEntry);
+            // Track the lifetime and states of the source geometry buffers
+            trackBlasBuildResources(cmdList, execBarriers, blasEntry);
+
+            if (cacheBlas) {
+              requestBlasSerialization(blasEntry->staticBlas, blasCacheKey);
+            }
+          }
         }
       } else { // Non-static blas instance
         // Previously static BLAS is no longer considered static (i.e. because it started getting animated)
@@ -542,6 +933,12 @@ namespace dxvk {
 
         // Track the lifetime and states of the source geometry buffers
         trackBlasBuildResources(cmdList, execBarriers, blasEntry);
+
+        // Merged BLASes are rebuilt every frame
+        if (assetCostLedger) {
+          for (const auto& buildRange : instance->buildRanges)
+            assetCostLedger->add(blasEntry->assetHash, AssetCost::BlasBuildTriangles, buildRange.primitiveCount);
+        }
       }
     }
 
@@ -907,6 +1304,10 @@ namespace dxvk {
       assert(blasToBuild.size() == blasRangesToBuild.size());
       ctx->vkCmdBuildAccelerationStructuresKHR(blasToBuild.size(), blasToBuild.data(), blasRangesToBuild.data());
     }
+
+    if (m_blasDiskCache) {
+      writeBlasSerializationQueries(ctx, cmdList);
+    }
   }
 
   void AccelManager::buildTlas(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList) {
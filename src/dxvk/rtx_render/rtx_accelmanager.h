@@ -27,6 +27,7 @@
 #include <unordered_map>
 #include "../util/rc/util_rc_ptr.h"
 #include "rtx_types.h"
+#include "rtx_blas_disk_cache.h"
 #include "../util/util_vector.h"
 #include "../util/util_matrix.h"
 
@@ -37,6 +38,7 @@ class DxvkDevice;
 class ResourceCache;
 class CameraManager;
 class OpacityMicromapManager;
+class AssetCostLedger;
 
 // AccelManager is responsible for maintaining the acceleration structures (BLAS and TLAS)
 class AccelManager
@@ -67,6 +69,7 @@ public:
   AccelManager& operator=(AccelManager const&) = delete;
 
   AccelManager(Rc<DxvkDevice> device);
+  ~AccelManager();
 
   // Returns a GPU buffer containing the surface data for active instances
   const Rc<DxvkBuffer> getSurfaceBuffer() const { return m_surfaceBuffer; }
@@ -91,13 +94,17 @@ public:
   // and some other BLAS will be dedicated to instances with static geometries.
   void mergeInstancesIntoBlas(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList, class DxvkBarrierSet& execBarriers,
                               const std::vector<TextureRef>& textures, const CameraManager& cameraManager, 
-                              InstanceManager& instanceManager, OpacityMicromapManager* opacityMicromapManager, float frameTimeSecs);
+                              InstanceManager& instanceManager, OpacityMicromapManager* opacityMicromapManager, AssetCostLedger* assetCostLedger,
+                              float frameTimeSecs);
 
   void buildTlas(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList);
 
   // Returns the number of live BLAS objects
   static uint32_t getBlasCount();
 
+  // Returns the number of static BLAS builds deferred to a later frame by the BLAS build budget
+  uint32_t getDeferredBlasBuildCount() const { return m_deferredBlasBuildCount; }
+
 private:
   void buildBlases(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList, DxvkBarrierSet& execBarriers,
                    const CameraManager& cameraManager, OpacityMicromapManager* opacityMicromapManager, const InstanceManager& instanceManager,
@@ -111,10 +118,14 @@ private:
                                      std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
                                      std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild);
   void internalBuildTlas(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList, Tlas::Type type);
+  // Decides which new static BLASes are built this frame, returns the BLAS entries whose build is deferred
+  std::unordered_set<const BlasEntry*> scheduleStaticBlasBuilds(const CameraManager& cameraManager, const std::vector<RtInstance*>& instances,
+                                                                const OpacityMicromapManager* opacityMicromapManager, uint32_t currentFrame);
   std::vector<RtInstance*> m_reorderedSurfaces;
   std::vector<uint32_t> m_reorderedSurfacesFirstIndexOffset; 
   std::vector<VkAccelerationStructureInstanceKHR> m_mergedInstances[Tlas::Count];
   std::vector<Rc<PooledBlas>> m_blasPool;
+  uint32_t m_deferredBlasBuildCount = 0;
 
   Rc<DxvkBuffer> m_vkInstanceBuffer; // Note: Holds Vulkan AS Instances, not RtInstances
   Rc<DxvkBuffer> m_surfaceBuffer;
@@ -128,6 +139,33 @@ private:
   void createAndBuildIntersectionBlas(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList, class DxvkBarrierSet& execBarriers);
 
   Rc<PooledBlas> createPooledBlas(size_t bufferSize) const;
+
+  // On-disk cache of serialized static BLASes for replacement meshes
+  struct BlasSerializationRequest {
+    Rc<PooledBlas> blas;
+    BlasCacheKey key;
+    uint32_t queryIndex = 0;
+    bool queryWritten = false;
+    // Host visible buffer the BLAS is serialized into, null until the serialized size is known
+    Rc<DxvkBuffer> serializedBuffer;
+    VkDeviceSize serializedOffset = 0;
+    VkDeviceSize serializedSize = 0;
+  };
+
+  void initializeBlasDiskCache();
+  bool getBlasCacheKey(const BlasEntry& blasEntry, const RtInstance& instance, const VkAccelerationStructureBuildGeometryInfoKHR& buildInfo, BlasCacheKey& key) const;
+  Rc<DxvkBuffer> createBlasSerializationBuffer(VkDeviceSize size, VkDeviceSize& alignedOffset) const;
+  Rc<PooledBlas> loadCachedBlas(Rc<DxvkCommandList> cmdList, const BlasCacheKey& key);
+  void requestBlasSerialization(const Rc<PooledBlas>& blas, const BlasCacheKey& key);
+  void writeBlasSerializationQueries(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList);
+  void processBlasSerializationRequests(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmdList);
+
+  std::unique_ptr<BlasCacheSerializer> m_blasCacheSerializer;
+  std::unique_ptr<BlasDiskCache> m_blasDiskCache;
+  XXH64_hash_t m_blasCacheDeviceHash = kEmptyHash;
+  VkQueryPool m_blasSerializationQueryPool = VK_NULL_HANDLE;
+  std::vector<uint32_t> m_freeBlasSerializationQueries;
+  std::vector<BlasSerializationRequest> m_blasSerializationRequests;
 };
 
 }  // namespace dxvk
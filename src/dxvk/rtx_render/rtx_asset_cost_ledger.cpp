@@ -0,0 +1,156 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_asset_cost_ledger.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace dxvk {
+  float AssetCostLedger::Row::get(AssetCost cost, AssetCostPeriod period) const {
+    const uint32_t index = uint32_t(cost);
+
+    switch (period) {
+    case AssetCostPeriod::LastFrame: return float(lastFrame[index]);
+    case AssetCostPeriod::Average: return average[index];
+    case AssetCostPeriod::Peak: return float(peak[index]);
+    default: return 0.f;
+    }
+  }
+
+  void AssetCostLedger::add(XXH64_hash_t assetHash, AssetCost cost, uint64_t amount) {
+    if (amount == 0)
+      return;
+
+    auto entryIter = m_entries.find(assetHash);
+
+    if (entryIter == m_entries.end()) {
+      if (m_entries.size() >= m_params.maxEntries)
+        assetHash = kUnattributedHash;
+
+      entryIter = m_entries.emplace(assetHash, Entry()).first;
+      entryIter->second.row.assetHash = assetHash;
+    }
+
+    entryIter->second.currentFrame[uint32_t(cost)] += amount;
+  }
+
+  void AssetCostLedger::endFrame() {
+    for (auto entryIter = m_entries.begin(); entryIter != m_entries.end(); ) {
+      Entry& entry = entryIter->second;
+      bool isSeen = false;
+
+      for (uint32_t i = 0; i < kCostCount; i++) {
+        const uint64_t value = entry.currentFrame[i];
+
+        entry.row.lastFrame[i] = value;
+        entry.row.average[i] += (float(value) - entry.row.average[i]) * kAverageWeight;
+        entry.row.peak[i] = std::max(entry.row.peak[i], value);
+        entry.currentFrame[i] = 0;
+
+        isSeen |= value != 0;
+      }
+
+      entry.idleFrames = isSeen ? 0 : entry.idleFrames + 1;
+
+      if (entry.idleFrames > m_params.maxIdleFrames)
+        entryIter = m_entries.erase(entryIter);
+      else
+        ++entryIter;
+    }
+  }
+
+  void AssetCostLedger::clear() {
+    m_entries.clear();
+  }
+
+  std::vector<AssetCostLedger::Row> AssetCostLedger::getTopAssets(AssetCost cost, AssetCostPeriod period, uint32_t count) const {
+    std::vector<const Row*> rows;
+    rows.reserve(m_entries.size());
+
+    for (const auto& entry : m_entries) {
+      if (entry.second.row.get(cost, period) > 0.f)
+        rows.push_back(&entry.second.row);
+    }
+
+    // Note: Ties are broken by hash so the order does not depend on the hash table
+    const auto isHigher = [cost, period](const Row* a, const Row* b) {
+      const float valueA = a->get(cost, period);
+      const float valueB = b->get(cost, period);
+      return valueA != valueB ? valueA > valueB : a->assetHash < b->assetHash;
+    };
+
+    const size_t topCount = std::min(size_t(count), rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + topCount, rows.end(), isHigher);
+
+    std::vector<Row> topRows;
+    topRows.reserve(topCount);
+
+    for (size_t i = 0; i < topCount; i++)
+      topRows.push_back(*rows[i]);
+
+    return topRows;
+  }
+
+  void AssetCostLedger::writeCsv(std::ostream& stream) const {
+    static const char* periodNames[] = { "LastFrame", "Average", "Peak" };
+
+    stream << "AssetHash";
+
+    for (uint32_t i = 0; i < kCostCount; i++) {
+      for (const char* periodName : periodNames)
+        stream << ',' << getCostName(AssetCost(i)) << periodName;
+    }
+
+    stream << '\n';
+
+    std::vector<const Row*> rows;
+    rows.reserve(m_entries.size());
+
+    for (const auto& entry : m_entries)
+      rows.push_back(&entry.second.row);
+
+    std::sort(rows.begin(), rows.end(), [](const Row* a, const Row* b) {
+      return a->assetHash < b->assetHash;
+    });
+
+    for (const Row* row : rows) {
+      stream << "0x" << std::hex << std::setw(16) << std::setfill('0') << row->assetHash << std::setfill(' ') << std::dec;
+
+      for (uint32_t i = 0; i < kCostCount; i++)
+        stream << ',' << row->lastFrame[i] << ',' << row->average[i] << ',' << row->peak[i];
+
+      stream << '\n';
+    }
+  }
+
+  const char* AssetCostLedger::getCostName(AssetCost cost) {
+    switch (cost) {
+    case AssetCost::Instances: return "Instances";
+    case AssetCost::Triangles: return "Triangles";
+    case AssetCost::BlasBuildTriangles: return "BlasBuildTriangles";
+    case AssetCost::BlasBytes: return "BlasBytes";
+    case AssetCost::OpacityMicromapBytes: return "OpacityMicromapBytes";
+    case AssetCost::TextureBytes: return "TextureBytes";
+    default: return "Unknown";
+    }
+  }
+}
@@ -0,0 +1,118 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+  enum class AssetCost : uint32_t {
+    Instances,             // Instances of the asset in the scene
+    Triangles,             // Triangles of all instances of the asset
+    BlasBuildTriangles,    // Triangles fed to BLAS builds, i.e. static BLAS builds and merged BLAS rebuilds
+    BlasBytes,             // Video memory of static BLASes
+    OpacityMicromapBytes,  // Video memory of opacity micromaps
+    TextureBytes,          // Video memory of the textures of the asset's materials
+
+    Count
+  };
+
+  enum class AssetCostPeriod : uint32_t {
+    LastFrame,  // Costs of the last completed frame
+    Average,    // Exponential moving average over recent frames
+    Peak,       // Highest cost of a single frame since the asset was first seen
+
+    Count
+  };
+
+  /**
+   * \brief Asset cost ledger
+   *
+   * Attributes the costs of the scene, i.e. triangles, instances, BLAS builds and the memory of
+   * BLASes, opacity micromaps and textures, back to the asset hash that caused them, so that the
+   * heaviest assets of a scene can be found. Costs are added during a frame and folded into the
+   * history of each asset at the end of it.
+   *
+   * The overhead is bounded: adding a cost is a single hash table lookup, the number of entries
+   * is capped, and assets that have not been seen for a number of frames are dropped. Costs of
+   * assets that do not get an entry of their own, because the ledger is full or because they have
+   * no hash, are collected under kUnattributedHash.
+   */
+  class AssetCostLedger {
+  public:
+    static constexpr XXH64_hash_t kUnattributedHash = 0;
+    static constexpr uint32_t kCostCount = uint32_t(AssetCost::Count);
+
+    // Weight of the current frame in the moving average, averages over roughly the last 20 frames
+    static constexpr float kAverageWeight = 0.05f;
+
+    struct Params {
+      uint32_t maxEntries = 0;     // Maximum number of assets tracked individually
+      uint32_t maxIdleFrames = 0;  // Frames an asset stays in the ledger after it was last seen
+    };
+
+    struct Row {
+      XXH64_hash_t assetHash = kUnattributedHash;
+      std::array<uint64_t, kCostCount> lastFrame {};
+      std::array<float, kCostCount> average {};
+      std::array<uint64_t, kCostCount> peak {};
+
+      float get(AssetCost cost, AssetCostPeriod period) const;
+    };
+
+    void setParams(const Params& params) { m_params = params; }
+
+    // Adds to a cost of an asset in the current frame
+    void add(XXH64_hash_t assetHash, AssetCost cost, uint64_t amount);
+
+    // Folds the costs of the current frame into the history and drops idle assets
+    void endFrame();
+
+    void clear();
+
+    // Returns up to count assets with the highest cost in a given period, highest first
+    std::vector<Row> getTopAssets(AssetCost cost, AssetCostPeriod period, uint32_t count) const;
+
+    // Writes all assets as CSV, with the last frame, average and peak value of every cost
+    void writeCsv(std::ostream& stream) const;
+
+    // Number of tracked assets, including the unattributed bucket once it has been used
+    size_t getEntryCount() const { return m_entries.size(); }
+
+    static const char* getCostName(AssetCost cost);
+
+  private:
+    struct Entry {
+      Row row;
+      std::array<uint64_t, kCostCount> currentFrame {};
+      uint32_t idleFrames = 0;
+    };
+
+    Params m_params;
+    std::unordered_map<XXH64_hash_t, Entry> m_entries;
+  };
+}
@@ -21,6 +21,7 @@
 */
 #pragma once
 
+#include <algorithm>
 #include <vulkan/vulkan.h>
 #include "../../util/util_error.h"
 #include "../../util/rc/util_rc.h"
@@ -116,7 +117,27 @@ namespace dxvk {
     }
 
     void setMinLevel(int minLevel) {
-      m_minLevel = minLevel;
+      const AssetInfo& sourceInfo = m_sourceAsset->info();
+
+      // Note: Packed tail mips cannot be addressed individually, so the view may start at the first tail mip at most
+      m_minLevel = std::clamp(minLevel, 0, getMaxMinLevel());
+
+      // Describe the view as an asset starting at the new min level
+      m_info.extent.width = std::max(sourceInfo.extent.width >> m_minLevel, 1u);
+      m_info.extent.height = std::max(sourceInfo.extent.height >> m_minLevel, 1u);
+      m_info.extent.depth = std::max(sourceInfo.extent.depth >> m_minLevel, 1u);
+      m_info.mipLevels = sourceInfo.mipLevels - m_minLevel;
+      m_info.looseLevels = sourceInfo.looseLevels - std::min<uint32_t>(sourceInfo.looseLevels, m_minLevel);
+    }
+
+    int getMinLevel() const {
+      return m_minLevel;
+    }
+
+    int getMaxMinLevel() const {
+      const AssetInfo& sourceInfo = m_sourceAsset->info();
+      const uint32_t maxLevel = std::min(sourceInfo.looseLevels, sourceInfo.mipLevels - 1);
+      return sourceInfo.mipLevels > 0 ? int(maxLevel) : 0;
     }
 
   private:
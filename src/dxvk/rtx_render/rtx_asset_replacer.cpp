@@ -33,6 +33,50 @@
 
 namespace dxvk {
 
+namespace {
+  template<typename Fn>
+  void forEachReplacementTexture(const MaterialData& materialData, Fn&& fn) {
+    auto visit = [&fn](const TextureRef& texture) {
+      const Rc<ManagedTexture>& managedTexture = texture.getManagedTexture();
+      if (managedTexture.ptr() != nullptr && managedTexture->assetData.ptr() != nullptr) {
+        fn(managedTexture->assetData->hash());
+      }
+    };
+
+    // Note: Legacy materials only reference game textures, so there is nothing to record for them
+    switch (materialData.getType()) {
+    case MaterialDataType::Opaque: {
+      const auto& opaque = materialData.getOpaqueMaterialData();
+      visit(opaque.getAlbedoOpacityTexture());
+      visit(opaque.getNormalTexture());
+      visit(opaque.getTangentTexture());
+      visit(opaque.getRoughnessTexture());
+      visit(opaque.getMetallicTexture());
+      visit(opaque.getEmissiveColorTexture());
+      break;
+    }
+    case MaterialDataType::Translucent: {
+      const auto& translucent = materialData.getTranslucentMaterialData();
+      visit(translucent.getNormalTexture());
+      visit(translucent.getTransmittanceTexture());
+      break;
+    }
+    case MaterialDataType::RayPortal: {
+      const auto& rayPortal = materialData.getRayPortalMaterialData();
+      visit(rayPortal.getMaskTexture());
+      visit(rayPortal.getMaskTexture2());
+      break;
+    }
+    default:
+      break;
+    }
+  }
+}
+
+AssetReplacer::~AssetReplacer() {
+  saveTextureManifests();
+}
+
 std::vector<AssetReplacement>* AssetReplacer::getReplacementsForMesh(XXH64_hash_t hash) {
   if (!RtxOptions::Get()->getEnableReplacementMeshes())
     return nullptr;
@@ -80,6 +124,7 @@ void AssetReplacer::initialize(const Rc<DxvkContext>& context) {
     mod->load(context);
   }
   updateSecretReplacements();
+  loadTextureManifests();
 }
 
 bool AssetReplacer::checkForChanges(const Rc<DxvkContext>& context) {
@@ -156,5 +201,98 @@ void AssetReplacer::updateSecretReplacements() {
   m_bSecretReplacementsUpdated = updated;
 }
 
+void AssetReplacer::loadTextureManifests() {
+  for (auto& mod : m_modManager.mods()) {
+    TextureUsageManifest& manifest = mod->textureManifest();
+    manifest = TextureUsageManifest(RtxOptions::Get()->textureUsageManifestCellSize());
+
+    const std::string manifestPath = mod->textureManifestPath().string();
+
+    if (!std::filesystem::exists(manifestPath)) {
+      continue;
+    }
+
+    if (manifest.readFromFile(manifestPath)) {
+      Logger::info(str::format("[RTX] Loaded texture usage manifest ", manifestPath, " (", manifest.getEntryCount(), " entries in ", manifest.getCellCount(), " cells)"));
+    } else {
+      Logger::warn(str::format("[RTX] Failed to load texture usage manifest ", manifestPath, ", ignoring it."));
+    }
+  }
+}
+
+void AssetReplacer::saveTextureManifests() {
+  for (auto& mod : m_modManager.mods()) {
+    const TextureUsageManifest& manifest = mod->textureManifest();
+
+    if (!manifest.isDirty()) {
+      continue;
+    }
+
+    const std::string manifestPath = mod->textureManifestPath().string();
+
+    if (manifest.writeToFile(manifestPath)) {
+      Logger::info(str::format("[RTX] Saved texture usage manifest ", manifestPath, " (", manifest.getEntryCount(), " entries in ", manifest.getCellCount(), " cells)"));
+    } else {
+      Logger::warn(str::format("[RTX] Failed to save texture usage manifest ", manifestPath));
+    }
+  }
+}
+
+void AssetReplacer::recordTextureUsage(const Vector3& cameraPosition, XXH64_hash_t gameMaterialHash, const MaterialData& materialData) {
+  forEachReplacementTexture(materialData, [&](XXH64_hash_t textureHash) {
+    // Attribute the texture to the first mod which owns it
+    for (auto& mod : m_modManager.mods()) {
+      Rc<ManagedTexture>* texture;
+      if (mod->replacements().getObject(textureHash, texture)) {
+        mod->textureManifest().record(cameraPosition, gameMaterialHash, textureHash);
+        break;
+      }
+    }
+  });
+}
+
+void AssetReplacer::prefetchTextures(const Rc<DxvkContext>& context, const Vector3& cameraPosition, const Vector3& cameraMotion) {
+  ZoneScoped;
+
+  RtxTextureManager& textureManager = context->getDevice()->getCommon()->getTextureManager();
+
+  // Stay within the memory budget, prefetching is only worth it if it doesn't evict something needed right now
+  const VkDeviceSize minFreeMemoryMib = std::max(RtxOptions::Get()->textureUsageManifestPrefetchMinFreeMemoryMB(), 0);
+  if (textureManager.getAvailableDeviceMemoryMib() < minFreeMemoryMib) {
+    return;
+  }
+
+  const uint32_t maxPrefetches = std::max(RtxOptions::Get()->textureUsageManifestMaxPrefetchesPerFrame(), 0);
+  // Note: Most predicted textures are typically resident already, so consider more candidates than we are going to prefetch
+  const uint32_t maxCandidates = maxPrefetches * 16;
+  const float lookAheadDistance = RtxOptions::Get()->textureUsageManifestLookAheadDistance();
+
+  Rc<DxvkContext> immediateContext = context;
+  uint32_t numPrefetched = 0;
+
+  for (auto& mod : m_modManager.mods()) {
+    if (numPrefetched >= maxPrefetches) {
+      break;
+    }
+
+    if (mod->state() != Mod::State::Loaded || mod->textureManifest().getCellCount() == 0) {
+      continue;
+    }
+
+    const auto predicted = mod->textureManifest().predict(cameraPosition, cameraMotion, lookAheadDistance, maxCandidates);
+
+    for (const XXH64_hash_t textureHash : predicted) {
+      Rc<ManagedTexture>* texture;
+      if (!mod->replacements().getObject(textureHash, texture)) {
+        continue;
+      }
+
+      if (textureManager.prefetchTexture(*texture, immediateContext) && ++numPrefetched >= maxPrefetches) {
+        break;
+      }
+    }
+  }
+}
+
 } // namespace dxvk
 
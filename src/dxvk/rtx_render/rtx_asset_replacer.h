@@ -31,6 +31,17 @@ namespace dxvk {
   class DxvkDevice;
   class DxvkCommandList;
 
+  // Simplified versions of a replacement mesh, see rtx.meshLod
+  struct MeshLodChain {
+    // Object space error of each level, starting with the full detail mesh which has none
+    std::vector<float> errors;
+    // Geometry of each simplified level, sharing the vertex buffers of the full detail mesh
+    std::vector<RasterGeometry*> geometryData;
+    // Object space bounding sphere of the mesh
+    Vector3 center;
+    float radius = 0.f;
+  };
+
   struct AssetReplacement {
     enum Type {
       eMesh,
@@ -44,6 +55,8 @@ namespace dxvk {
     Matrix4 replacementToObject;
     Type type;
     bool includeOriginal = false;
+    // Simplified versions of the geometry, null if none were generated
+    const MeshLodChain* lods = nullptr;
 
     AssetReplacement(RasterGeometry* geometryData, MaterialData* materialData, const Matrix4& replacementToObject)
         : geometryData(geometryData), materialData(materialData), replacementToObject(replacementToObject), type(eMesh) {}
@@ -109,6 +122,20 @@ namespace dxvk {
           return true;
         }
         return false;
+      } else if constexpr (std::is_same_v<T, Rc<ManagedTexture>>) {
+        auto it = m_textures.find(hash);
+        if (it != m_textures.end()) {
+          obj = &it->second;
+          return true;
+        }
+        return false;
+      } else if constexpr (std::is_same_v<T, MeshLodChain>) {
+        auto it = m_meshLods.find(hash);
+        if (it != m_meshLods.end()) {
+          obj = &it->second;
+          return true;
+        }
+        return false;
       }
       return false;
     }
@@ -121,6 +148,10 @@ namespace dxvk {
         return m_materials.try_emplace(hash, std::move(obj)).first->second;
       } else if constexpr (std::is_same_v<T, RasterGeometry>) {
         return m_geometries.try_emplace(hash, std::move(obj)).first->second;
+      } else if constexpr (std::is_same_v<T, Rc<ManagedTexture>>) {
+        return m_textures.try_emplace(hash, std::move(obj)).first->second;
+      } else if constexpr (std::is_same_v<T, MeshLodChain>) {
+        return m_meshLods.try_emplace(hash, std::move(obj)).first->second;
       } else {
         return m_secretReplacements[hash].emplace_back(obj);
       }
@@ -146,6 +177,8 @@ namespace dxvk {
       m_lightReplacers.clear();
       m_materials.clear();
       m_geometries.clear();
+      m_meshLods.clear();
+      m_textures.clear();
       m_secretReplacements.clear();
     }
 
@@ -163,9 +196,15 @@ namespace dxvk {
     // Replacement geometry storage
     fast_unordered_cache<RasterGeometry> m_geometries;
 
+    // Simplified levels of replacement geometry, keyed by the content of the full detail mesh
+    fast_unordered_cache<MeshLodChain> m_meshLods;
+
     // Replacement material storage
     fast_unordered_cache<MaterialData> m_materials;
 
+    // Replacement textures referenced by the materials, keyed by asset hash
+    fast_unordered_cache<Rc<ManagedTexture>> m_textures;
+
     // Secret replacements if any
     SecretReplacements m_secretReplacements;
   };
@@ -174,6 +213,8 @@ namespace dxvk {
     AssetReplacer(Rc<DxvkDevice>& device) {
     }
 
+    ~AssetReplacer();
+
     std::vector<AssetReplacement>* getReplacementsForMesh(XXH64_hash_t hash);
     std::vector<AssetReplacement>* getReplacementsForLight(XXH64_hash_t hash);
     MaterialData* getReplacementMaterial(XXH64_hash_t hash);
@@ -198,6 +239,15 @@ namespace dxvk {
       return m_secretReplacements;
     }
 
+    // Records the replacement textures used by a replacement material into the manifest of the mod providing them.
+    void recordTextureUsage(const Vector3& cameraPosition, XXH64_hash_t gameMaterialHash, const MaterialData& materialData);
+
+    // Streams in replacement textures the texture usage manifests predict will be needed soon.
+    void prefetchTextures(const Rc<DxvkContext>& context, const Vector3& cameraPosition, const Vector3& cameraMotion);
+
+    // Writes out texture usage manifests which recorded new usage.
+    void saveTextureManifests();
+
     void markVariantStatus(const XXH64_hash_t assetHash,
                            const size_t variantId,
                            const bool bEnabled) {
@@ -207,6 +257,7 @@ namespace dxvk {
 
   private:
     void updateSecretReplacements();
+    void loadTextureManifests();
 
     bool m_bSecretReplacementsUpdated = false;
 
@@ -0,0 +1,75 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_blas_build_scheduler.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace dxvk {
+  std::vector<bool> BlasBuildScheduler::schedule(const std::vector<Candidate>& candidates, const Params& params) {
+    if (params.maxPrimitivesPerFrame == 0)
+      return std::vector<bool>(candidates.size(), true);
+
+    std::vector<bool> approved(candidates.size(), false);
+    uint64_t usedPrimitives = 0;
+    bool anyApproved = false;
+
+    // Builds that waited long enough go first and are never deferred again
+    for (size_t i = 0; i < candidates.size(); i++) {
+      if (candidates[i].framesDeferred >= params.maxDeferredFrames) {
+        approved[i] = true;
+        usedPrimitives += candidates[i].primitiveCount;
+        anyApproved = true;
+      }
+    }
+
+    // The others by decreasing size on screen, then by how long they waited
+    std::vector<uint32_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&candidates](uint32_t a, uint32_t b) {
+      if (candidates[a].projectedSize != candidates[b].projectedSize)
+        return candidates[a].projectedSize > candidates[b].projectedSize;
+      return candidates[a].framesDeferred > candidates[b].framesDeferred;
+    });
+
+    for (uint32_t i : order) {
+      if (approved[i])
+        continue;
+
+      // Note: Smaller builds further down the order may still fit after a large one did not
+      const uint64_t primitives = candidates[i].primitiveCount;
+
+      if (!anyApproved || usedPrimitives + primitives <= params.maxPrimitivesPerFrame) {
+        approved[i] = true;
+        usedPrimitives += primitives;
+        anyApproved = true;
+      }
+    }
+
+    return approved;
+  }
+
+  float BlasBuildScheduler::getProjectedSize(float radius, float distance) {
+    // Note: The camera may be inside the bounding sphere, which makes the mesh as large as it gets
+    return radius / std::max(distance - radius, 1e-3f);
+  }
+}
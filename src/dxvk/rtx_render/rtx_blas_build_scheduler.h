@@ -0,0 +1,59 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace dxvk {
+  /**
+   * \brief BLAS build scheduler
+   *
+   * Spreads the builds of new static BLASes over several frames when many meshes appear at once,
+   * e.g. on level loads or camera cuts. Each frame the pending builds are ranked by their projected
+   * size on screen and approved until the primitive budget of the frame is used up, the rest wait
+   * for a later frame. Two guarantees keep this from stalling:
+   * - At least one build is approved every frame there is one, even if it exceeds the budget alone.
+   * - A build deferred for maxDeferredFrames frames is approved regardless of the budget.
+   *
+   * The scheduler is stateless, the caller tracks for how many frames each build was deferred.
+   */
+  class BlasBuildScheduler {
+  public:
+    struct Candidate {
+      uint32_t primitiveCount = 0;
+      float projectedSize = 0.f;   // Any measure of the size on screen, larger builds first
+      uint32_t framesDeferred = 0; // Frames the build has been waiting for
+    };
+
+    struct Params {
+      uint64_t maxPrimitivesPerFrame = 0; // 0 disables the budget
+      uint32_t maxDeferredFrames = 0;
+    };
+
+    // Approves the builds of this frame, returns whether each candidate may be built
+    static std::vector<bool> schedule(const std::vector<Candidate>& candidates, const Params& params);
+
+    // Projected size of a bounding sphere seen from a given distance
+    static float getProjectedSize(float radius, float distance);
+  };
+}
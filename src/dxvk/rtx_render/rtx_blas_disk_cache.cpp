@@ -0,0 +1,268 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_blas_disk_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace dxvk {
+  namespace {
+    constexpr char kBlasCacheMagic[4] = { 'R', 'T', 'B', 'C' };
+    constexpr uint32_t kBlasCacheVersion = 1;
+    constexpr char kBlasCacheExtension[] = ".blas";
+
+    struct BlasCacheFileHeader {
+      char magic[4];
+      uint32_t version;
+      BlasCacheKey key;
+      uint64_t dataSize;
+      XXH64_hash_t dataChecksum;
+    };
+  }
+
+  XXH64_hash_t BlasCacheKey::hash() const {
+    XXH64_hash_t h = XXH64(&geometryHash, sizeof(geometryHash), 0);
+    h = XXH64(&deviceHash, sizeof(deviceHash), h);
+    h = XXH64(&buildFlags, sizeof(buildFlags), h);
+    h = XXH64(&geometryFlags, sizeof(geometryFlags), h);
+    h = XXH64(&vertexFormat, sizeof(vertexFormat), h);
+    h = XXH64(&indexType, sizeof(indexType), h);
+    h = XXH64(&primitiveCount, sizeof(primitiveCount), h);
+    h = XXH64(&vertexCount, sizeof(vertexCount), h);
+    return h;
+  }
+
+  bool BlasCacheKey::operator==(const BlasCacheKey& other) const {
+    return geometryHash == other.geometryHash
+        && deviceHash == other.deviceHash
+        && buildFlags == other.buildFlags
+        && geometryFlags == other.geometryFlags
+        && vertexFormat == other.vertexFormat
+        && indexType == other.indexType
+        && primitiveCount == other.primitiveCount
+        && vertexCount == other.vertexCount;
+  }
+
+  BlasDiskCache::BlasDiskCache(const std::string& directory, uint64_t maxSizeBytes, const BlasCacheSerializer& serializer)
+    : m_directory(directory)
+    , m_maxSizeBytes(maxSizeBytes)
+    , m_serializer(serializer) {
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+
+    scanDirectory();
+    trim();
+  }
+
+  std::string BlasDiskCache::getEntryPath(XXH64_hash_t keyHash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(keyHash));
+    return (fs::path(m_directory) / (std::string(name) + kBlasCacheExtension)).string();
+  }
+
+  void BlasDiskCache::scanDirectory() {
+    std::error_code ec;
+
+    struct ScannedEntry {
+      XXH64_hash_t keyHash;
+      uint64_t sizeBytes;
+      fs::file_time_type writeTime;
+    };
+
+    std::vector<ScannedEntry> scanned;
+
+    for (const auto& dirEntry : fs::directory_iterator(m_directory, ec)) {
+      if (!dirEntry.is_regular_file(ec) || dirEntry.path().extension() != kBlasCacheExtension) {
+        continue;
+      }
+
+      const std::string stem = dirEntry.path().stem().string();
+      char* end = nullptr;
+      const XXH64_hash_t keyHash = std::strtoull(stem.c_str(), &end, 16);
+
+      if (stem.empty() || *end != '\0') {
+        continue;
+      }
+
+      scanned.push_back({ keyHash, dirEntry.file_size(ec), dirEntry.last_write_time(ec) });
+    }
+
+    // Oldest files first so that the use order carries over between sessions
+    std::sort(scanned.begin(), scanned.end(), [](const ScannedEntry& a, const ScannedEntry& b) {
+      return a.writeTime < b.writeTime;
+    });
+
+    for (const ScannedEntry& entry : scanned) {
+      m_entries[entry.keyHash] = EntryInfo { entry.sizeBytes, ++m_useCounter };
+      m_totalSizeBytes += entry.sizeBytes;
+    }
+  }
+
+  void BlasDiskCache::evict(XXH64_hash_t keyHash) {
+    auto it = m_entries.find(keyHash);
+
+    if (it != m_entries.end()) {
+      m_totalSizeBytes -= it->second.sizeBytes;
+      m_entries.erase(it);
+    }
+
+    std::error_code ec;
+    fs::remove(getEntryPath(keyHash), ec);
+  }
+
+  bool BlasDiskCache::contains(const BlasCacheKey& key) const {
+    return m_entries.find(key.hash()) != m_entries.end();
+  }
+
+  bool BlasDiskCache::load(const BlasCacheKey& key, std::vector<uint8_t>& outData) {
+    const XXH64_hash_t keyHash = key.hash();
+
+    auto it = m_entries.find(keyHash);
+
+    if (it == m_entries.end()) {
+      ++m_statistics.misses;
+      return false;
+    }
+
+    const std::string path = getEntryPath(keyHash);
+    std::ifstream file(path, std::ios::binary);
+
+    const std::vector<uint8_t> fileData { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    BlasCacheFileHeader header;
+    bool valid = file.is_open() && fileData.size() >= sizeof(header);
+
+    if (valid) {
+      std::memcpy(&header, fileData.data(), sizeof(header));
+
+      valid = std::memcmp(header.magic, kBlasCacheMagic, sizeof(kBlasCacheMagic)) == 0
+           && header.version == kBlasCacheVersion
+           && header.key == key
+           && header.dataSize == fileData.size() - sizeof(header)
+           && XXH64(fileData.data() + sizeof(header), header.dataSize, 0) == header.dataChecksum;
+    }
+
+    if (valid) {
+      outData.assign(fileData.begin() + sizeof(header), fileData.end());
+      valid = m_serializer.isCompatible(outData);
+    }
+
+    file.close();
+
+    if (!valid) {
+      outData.clear();
+      evict(keyHash);
+
+      ++m_statistics.invalidated;
+      ++m_statistics.misses;
+      return false;
+    }
+
+    it->second.lastUse = ++m_useCounter;
+
+    // Persist the use order for the next session
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    ++m_statistics.hits;
+    return true;
+  }
+
+  bool BlasDiskCache::store(const BlasCacheKey& key, const std::vector<uint8_t>& data) {
+    const uint64_t entrySize = sizeof(BlasCacheFileHeader) + data.size();
+
+    if (data.empty() || entrySize > m_maxSizeBytes) {
+      return false;
+    }
+
+    const XXH64_hash_t keyHash = key.hash();
+
+    if (m_entries.find(keyHash) != m_entries.end()) {
+      evict(keyHash);
+    }
+
+    BlasCacheFileHeader header {};
+    std::memcpy(header.magic, kBlasCacheMagic, sizeof(kBlasCacheMagic));
+    header.version = kBlasCacheVersion;
+    header.key = key;
+    header.dataSize = data.size();
+    header.dataChecksum = XXH64(data.data(), data.size(), 0);
+
+    const std::string path = getEntryPath(keyHash);
+
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+      if (file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+      }
+
+      if (!file.good()) {
+        file.close();
+
+        std::error_code ec;
+        fs::remove(path, ec);
+        return false;
+      }
+    }
+
+    m_entries[keyHash] = EntryInfo { entrySize, ++m_useCounter };
+    m_totalSizeBytes += entrySize;
+
+    ++m_statistics.stored;
+
+    trim();
+
+    return true;
+  }
+
+  void BlasDiskCache::trim() {
+    if (m_totalSizeBytes <= m_maxSizeBytes) {
+      return;
+    }
+
+    std::vector<std::pair<uint64_t, XXH64_hash_t>> byUse;
+    byUse.reserve(m_entries.size());
+
+    for (const auto& [keyHash, info] : m_entries) {
+      byUse.emplace_back(info.lastUse, keyHash);
+    }
+
+    std::sort(byUse.begin(), byUse.end());
+
+    for (const auto& [lastUse, keyHash] : byUse) {
+      if (m_totalSizeBytes <= m_maxSizeBytes) {
+        break;
+      }
+
+      evict(keyHash);
+      ++m_statistics.evicted;
+    }
+  }
+} // namespace dxvk
@@ -0,0 +1,121 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+  // Everything which affects the contents of a built BLAS, used to key serialized BLASes on disk
+  struct BlasCacheKey {
+    // Content hash of the source geometry (positions and indices), must be stable across sessions
+    XXH64_hash_t geometryHash = 0;
+    // Hash identifying the device and driver the BLAS was built with
+    XXH64_hash_t deviceHash = 0;
+    uint32_t buildFlags = 0;
+    uint32_t geometryFlags = 0;
+    uint32_t vertexFormat = 0;
+    uint32_t indexType = 0;
+    uint32_t primitiveCount = 0;
+    uint32_t vertexCount = 0;
+
+    XXH64_hash_t hash() const;
+
+    bool operator==(const BlasCacheKey& other) const;
+  };
+
+  /**
+   * \brief BLAS serializer interface
+   *
+   * Abstracts the API specific parts of BLAS serialization the disk cache needs
+   * to validate entries, i.e. checking the driver's compatibility with serialized data.
+   */
+  class BlasCacheSerializer {
+  public:
+    virtual ~BlasCacheSerializer() = default;
+
+    // Returns true if a serialized BLAS blob can be deserialized on the current device
+    virtual bool isCompatible(const std::vector<uint8_t>& serializedData) const = 0;
+  };
+
+  /**
+   * \brief On-disk cache of serialized BLASes
+   *
+   * Stores one file per BLAS in a directory. Every entry carries its full key and a checksum
+   * of the serialized data, entries which fail validation (corrupt, stale or incompatible
+   * with the current device) are evicted when looked up. The total size of the cache is
+   * kept under a budget by evicting the least recently used entries.
+   */
+  class BlasDiskCache {
+  public:
+    struct Statistics {
+      uint32_t hits = 0;
+      uint32_t misses = 0;
+      uint32_t invalidated = 0;
+      uint32_t stored = 0;
+      uint32_t evicted = 0;
+    };
+
+    BlasDiskCache(const std::string& directory, uint64_t maxSizeBytes, const BlasCacheSerializer& serializer);
+
+    // Looks up a serialized BLAS. Returns false on a miss or if the entry failed validation, in which case it is evicted.
+    bool load(const BlasCacheKey& key, std::vector<uint8_t>& outData);
+
+    // Writes a serialized BLAS to the cache and evicts old entries to stay within the budget.
+    bool store(const BlasCacheKey& key, const std::vector<uint8_t>& data);
+
+    bool contains(const BlasCacheKey& key) const;
+
+    // Evicts least recently used entries until the cache fits in the size budget.
+    void trim();
+
+    void setMaxSize(uint64_t maxSizeBytes) { m_maxSizeBytes = maxSizeBytes; }
+
+    uint64_t getSize() const { return m_totalSizeBytes; }
+    size_t getEntryCount() const { return m_entries.size(); }
+    const Statistics& getStatistics() const { return m_statistics; }
+
+  private:
+    struct EntryInfo {
+      uint64_t sizeBytes;
+      uint64_t lastUse;
+    };
+
+    std::string getEntryPath(XXH64_hash_t keyHash) const;
+    void scanDirectory();
+    void evict(XXH64_hash_t keyHash);
+
+    std::string m_directory;
+    uint64_t m_maxSizeBytes;
+    const BlasCacheSerializer& m_serializer;
+
+    std::unordered_map<XXH64_hash_t, EntryInfo> m_entries;
+    uint64_t m_totalSizeBytes = 0;
+    uint64_t m_useCounter = 0;
+
+    Statistics m_statistics;
+  };
+} // namespace dxvk
@@ -43,6 +43,7 @@
 
 #include "../d3d9/d3d9_state.h"
 #include "../d3d9/d3d9_spec_constants.h"
+#include "../d3d9/d3d9_rtx_instancing.h"
 
 #include "../util/log/metrics.h"
 #include "../util/util_defer.h"
@@ -378,8 +379,16 @@ namespace dxvk {
       // Update all the GPU buffers needed to describe the scene
       getSceneManager().prepareSceneData(this, m_cmd, m_execBarriers, frameTimeSecs);
       
+      const bool hasScene = getSceneManager().getSurfaceBuffer() != nullptr;
+
+      if (!hasScene)
+        m_staticSceneDetector.reset();
+
+      // Present the last output again if nothing changed since it was rendered
+      const bool reusedOutput = hasScene && reuseStaticSceneOutput(targetImage, captureScreenImage);
+
       // If we really don't have any RT to do, just bail early (could be UI/menus rendering)
-      if (getSceneManager().getSurfaceBuffer() != nullptr) {
+      if (hasScene && !reusedOutput) {
 
         auto logRenderPassRaytraceModeRayQuery = [=](const char* renderPassName, auto mode) {
           switch (mode) {
@@ -435,6 +444,8 @@ namespace dxvk {
 
         Resources::RaytracingOutput& rtOutput = getResourceManager().getRaytracingOutput();
 
+        updateFrameBudget(frameTimeSecs, gpuIdleTimeSecs);
+
         updateReflexConstants();
 
         // Generate ray tracing constant buffer
@@ -456,6 +467,9 @@ namespace dxvk {
 
         // ReSTIR GI
         m_common->metaReSTIRGIRayQuery().dispatch(this, rtOutput);
+
+        // Note: All material sampling of the frame is done at this point
+        m_common->getTextureManager().resolveSamplerFeedback(this, getSceneManager().getTextureTable());
         
         if (captureScreenImage && captureDebugImage) {
           takeScreenshot("baseReflectivity", rtOutput.m_primaryBaseReflectivity.image(Resources::AccessType::Read));
@@ -670,6 +684,10 @@ namespace dxvk {
     m_rtState.world = objectToWorld;
   }
 
+  void RtxContext::setInstanceTransforms(const std::vector<Matrix4>& instanceTransforms) {
+    m_rtState.instanceTransforms = instanceTransforms;
+  }
+
   void RtxContext::setCameraTransforms(const Matrix4& worldToView, const Matrix4& viewToProjection) {
     m_rtState.view = worldToView;
     m_rtState.projection = viewToProjection;
@@ -1051,7 +1069,19 @@ namespace dxvk {
     getSceneManager().processCameraData(drawCallState);
 
     // Add to the list, will be processed later in injectRTX
-    m_drawCallQueue.push_back(drawCallState);
+    if (m_rtState.instanceTransforms.empty()) {
+      m_drawCallQueue.push_back(drawCallState);
+    } else {
+      // Each instance of an instanced draw becomes a draw call of its own. They all share the geometry hash and so the BLAS.
+      for (uint32_t i = 0; i < m_rtState.instanceTransforms.size(); i++) {
+        const Matrix4 instanceToWorld = GetInstanceObjectToWorld(transformData.objectToWorld, m_rtState.instanceTransforms[i]);
+        DrawCallState& instanceState = m_drawCallQueue.emplace_back(drawCallState);
+        instanceState.m_instanceIndex = i;
+        instanceState.m_transformData.objectToWorld = instanceToWorld;
+        instanceState.m_transformData.objectToView = transformData.worldToView * instanceToWorld;
+        instanceState.m_transformData.sanitize();
+      }
+    }
 
     return RtxGeometryStatus::RayTraced;
   }
@@ -1067,6 +1097,9 @@ namespace dxvk {
     }
 
     m_drawCallQueue.clear();
+
+    // Geometry of the processed draw calls must be cached before anything consumes it
+    m_common->metaGeometryUtils().flushGeometryBatches(this);
   }
 
   bool RtxContext::requiresDrawCall() const {
@@ -1099,6 +1132,7 @@ namespace dxvk {
       m_rtState.geometry.indexCount = 0;
       m_rtState.geometry.vertexCount = 0;
       m_rtState.geometryStatus = RtxGeometryStatus::Ignored;
+      m_rtState.instanceTransforms.clear();
       m_drawCallID++;
     }
   }
@@ -1131,6 +1165,7 @@ namespace dxvk {
       m_rtState.geometry.indexCount = 0;
       m_rtState.geometry.vertexCount = 0;
       m_rtState.geometryStatus = RtxGeometryStatus::Ignored;
+      m_rtState.instanceTransforms.clear();
       m_drawCallID++;
     }
   } 
@@ -1353,6 +1388,7 @@ namespace dxvk {
     constants.skyBrightness = RtxOptions::Get()->skyBrightness();
     constants.isLastCompositeOutputValid = rtOutput.m_lastCompositeOutput.matchesWriteFrameIdx(frameIdx - 1);
     constants.isZUp = RtxOptions::Get()->isZUp();
+    constants.enableSamplerFeedback = RtxTextureManager::isSamplerFeedbackEnabled();
 
     // Upload the constants to the GPU
     {
@@ -1392,6 +1428,9 @@ namespace dxvk {
     bindResourceView(BINDING_BLUE_NOISE_TEXTURE, getResourceManager().getBlueNoiseTexture(this), nullptr);
     bindResourceBuffer(BINDING_CONSTANTS, DxvkBufferSlice(constantsBuffer, 0, constantsBuffer->info().size));
     bindResourceView(BINDING_DEBUG_VIEW_TEXTURE, debugView.getDebugOutput(), nullptr);
+
+    Rc<DxvkBuffer> samplerFeedbackBuffer = m_device->getCommon()->getTextureManager().getSamplerFeedbackBuffer(this);
+    bindResourceBuffer(BINDING_SAMPLER_FEEDBACK_BUFFER, DxvkBufferSlice(samplerFeedbackBuffer, 0, samplerFeedbackBuffer->info().size));
   }
 
   void RtxContext::checkOpacityMicromapSupport() {
@@ -1752,6 +1791,177 @@ namespace dxvk {
       takeScreenshot("rtxImageDebugView", debugView.getDebugOutput()->image());
   }
 
+  void RtxContext::updateFrameBudget(const float frameTimeSecs, const float gpuIdleTimeSecs) {
+    const auto& frameBudget = RtxOptions::Get()->frameBudget;
+
+    // Note: An empty list hands all settings back
+    const std::string& settingList = frameBudget.enable() ? frameBudget.settings() : std::string();
+
+    if (settingList != m_frameBudgetSettingList)
+      bindFrameBudgetSettings(settingList);
+
+    if (m_frameBudgetOptions.empty())
+      return;
+
+    const auto& settings = m_frameBudgetGovernor.getSettings();
+
+    for (size_t i = 0; i < m_frameBudgetOptions.size(); i++) {
+      // Values changed from outside the governor (e.g. in the UI) become the new maximum
+      const int32_t value = m_frameBudgetOptions[i]->valueList[(int) RtxOptionImpl::ValueType::Value].i;
+
+      if (value != settings[i].value)
+        m_frameBudgetGovernor.overrideValue(i, value);
+    }
+
+    FrameBudgetGovernor::Params params;
+    params.targetFrameTimeMs = frameBudget.targetFrameTimeMs();
+    params.hysteresis = frameBudget.hysteresis();
+    params.settleFrames = frameBudget.settleFrames();
+
+    // Note: The time the GPU was busy since the last frame stands in for its frame time
+    const float gpuFrameTimeMs = std::max(frameTimeSecs - gpuIdleTimeSecs, 0.f) * 1000.f;
+    const int32_t changed = m_frameBudgetGovernor.update(gpuFrameTimeMs, params);
+
+    if (changed >= 0) {
+      const FrameBudgetGovernor::Setting& setting = settings[changed];
+      m_frameBudgetOptions[changed]->valueList[(int) RtxOptionImpl::ValueType::Value].i = setting.value;
+
+      Logger::debug(str::format("Frame budget: ", setting.name, " set to ", setting.value, " at ", m_frameBudgetGovernor.getAverageFrameTimeMs(), " ms"));
+    }
+  }
+
+  void RtxContext::bindFrameBudgetSettings(const std::string& settingList) {
+    // Hand the previously scaled settings back at the values they had before
+    for (size_t i = 0; i < m_frameBudgetOptions.size(); i++)
+      m_frameBudgetOptions[i]->valueList[(int) RtxOptionImpl::ValueType::Value].i = m_frameBudgetGovernor.getSettings()[i].maxValue;
+
+    m_frameBudgetOptions.clear();
+    m_frameBudgetSettingList = settingList;
+
+    std::vector<FrameBudgetGovernor::Setting> settings;
+    const auto& options = RtxOptionImpl::getGlobalRtxOptionMap();
+
+    for (FrameBudgetGovernor::Setting& setting : FrameBudgetGovernor::parseSettings(settingList)) {
+      auto option = options.find(setting.name);
+
+      if (option == options.end() || option->second->type != OptionType::Int) {
+        Logger::warn(str::format("Frame budget: ", setting.name, " is not an integer option and cannot be scaled."));
+        continue;
+      }
+
+      // Note: Smaller integer types are stored zero extended in the value, so they can be accessed as int
+      setting.value = setting.maxValue = option->second->valueList[(int) RtxOptionImpl::ValueType::Value].i;
+
+      m_frameBudgetOptions.push_back(option->second.get());
+      settings.push_back(std::move(setting));
+    }
+
+    m_frameBudgetGovernor.setSettings(std::move(settings));
+  }
+
+  XXH64_hash_t RtxContext::computeSceneDigest(const Rc<DxvkImage>& targetImage) {
+    ZoneScoped;
+
+    const SceneManager& sceneManager = getSceneManager();
+    SceneDigest digest;
+
+    const RtCamera& camera = sceneManager.getCamera();
+    digest.add(camera.getWorldToView());
+    digest.add(camera.getViewToProjection());
+    digest.add(targetImage->info().extent);
+
+    for (const RtInstance* instance : sceneManager.getInstanceTable()) {
+      digest.add(instance->getId());
+      // Note: Covers the transform, mask, flags and the BLAS the instance references
+      digest.add(instance->getVkInstance());
+      digest.add(instance->getMaterialDataHash());
+      digest.add(instance->getSurfaceIndex());
+
+      if (instance->getBlas() != nullptr)
+        digest.add(instance->getBlas()->frameLastUpdated);
+    }
+
+    // Note: Light hashes only identify lights, the GPU data covers everything the path tracer sees
+    for (const auto& light : sceneManager.getLightManager().getLightTable()) {
+      unsigned char lightData[kLightGPUSize];
+      std::size_t offset = 0;
+      light.second.writeGPUData(lightData, offset);
+      digest.addUnordered(XXH3_64bits(lightData, offset));
+    }
+
+    // Note: Sprite sheets and ray portals animate with the game time, so scenes showing them are never static
+    bool hasAnimatedMaterial = false;
+
+    for (const RtSurfaceMaterial& material : sceneManager.getSurfaceMaterialTable()) {
+      digest.add(material.getHash());
+
+      switch (material.getType()) {
+      case RtSurfaceMaterialType::Opaque:
+        hasAnimatedMaterial |= material.getOpaqueSurfaceMaterial().getSpriteSheetFPS() != 0;
+        break;
+      case RtSurfaceMaterialType::RayPortal:
+        hasAnimatedMaterial |= material.getRayPortalSurfaceMaterial().getSpriteSheetFPS() != 0 ||
+                               material.getRayPortalSurfaceMaterial().getRotationSpeed() != 0.f;
+        break;
+      default:
+        break;
+      }
+    }
+
+    if (hasAnimatedMaterial)
+      digest.add(getGameTimeSinceStartMS());
+
+    // Note: Textures updated in place (e.g. video or render to texture) keep their hash, their contents are tracked by the
+    // write generation of the image instead
+    for (const TextureRef& texture : sceneManager.getTextureTable()) {
+      const DxvkImageView* imageView = texture.getImageView();
+
+      if (imageView != nullptr)
+        digest.add(imageView->image()->getWriteGeneration());
+    }
+
+    digest.add(RtxOptionImpl::getAllValuesHash());
+
+    return digest.getHash();
+  }
+
+  bool RtxContext::reuseStaticSceneOutput(const Rc<DxvkImage>& targetImage, bool captureScreenImage) {
+    if (!RtxOptions::Get()->staticSceneDetection.enable()) {
+      m_staticSceneDetector.reset();
+      return false;
+    }
+
+    StaticSceneDetector::Settings settings;
+    settings.minStaticFrames = RtxOptions::Get()->staticSceneDetection.minStaticFrames();
+    settings.refreshInterval = RtxOptions::Get()->staticSceneDetection.refreshInterval();
+
+    const StaticSceneAction action = m_staticSceneDetector.update(computeSceneDigest(targetImage), settings);
+
+    // Anything consuming this frame's passes needs them to run, and the last output must still be there
+    const bool needsPasses =
+      captureScreenImage ||
+      !m_pendingThumbnailRequests.empty() ||
+      m_common->metaDebugView().debugViewIdx() != DEBUG_VIEW_DISABLED ||
+      !getResourceManager().validateRaytracingOutput(setDownscaleExtent(targetImage->info().extent), targetImage->info().extent);
+
+    if (needsPasses) {
+      m_staticSceneDetector.reset();
+      return false;
+    }
+
+    if (action == StaticSceneAction::Render)
+      return false;
+
+    {
+      ScopedGpuProfileZone(this, "Blit to Game");
+      blitImageHelper(getResourceManager().getRaytracingOutput().m_finalOutput.image, targetImage, VkFilter::VK_FILTER_NEAREST);
+    }
+
+    getSceneManager().onFrameEnd(this);
+
+    return true;
+  }
+
   void RtxContext::flushCommandList() {
     ZoneScoped;
 
@@ -1818,6 +2028,9 @@ namespace dxvk {
     ZoneScoped;
     ScopedGpuProfileZone(this, "performSkinning");
 
+    // Skinning operates on the cached vertex data in place
+    m_common->metaGeometryUtils().flushGeometryBatches(this);
+
     m_common->metaGeometryUtils().dispatchSkinning(m_cmd, this, drawCallState, geo);
   }
 
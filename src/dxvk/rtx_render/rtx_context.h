@@ -24,6 +24,8 @@
 #include "../dxvk_context.h"
 #include "rtx_resources.h"
 #include "rtx_asset_exporter.h"
+#include "rtx_scene_digest.h"
+#include "rtx_frame_budget.h"
 #include "rtx/pass/nrd_args.h"
 
 #include <chrono>
@@ -131,6 +133,13 @@ namespace dxvk {
       */
     void setObjectTransform(const Matrix4& objectToWorld);
 
+    /**
+      * \brief Set the per-instance transforms of the next instanced draw on context
+      *
+      * \param [in] instanceTransforms: object to world transform of each instance, empty for a regular draw
+      */
+    void setInstanceTransforms(const std::vector<Matrix4>& instanceTransforms);
+
     /**
       * \brief Set the current camera matrices on context
       *
@@ -236,6 +245,12 @@ namespace dxvk {
     void dispatchDebugView(Rc<DxvkImage>& srcImage, const Resources::RaytracingOutput& rtOutput, bool captureScreenImage);
     void updateMetrics(const float frameTimeSecs, const float gpuIdleTimeSecs) const;
 
+    void updateFrameBudget(const float frameTimeSecs, const float gpuIdleTimeSecs);
+    void bindFrameBudgetSettings(const std::string& settingList);
+
+    XXH64_hash_t computeSceneDigest(const Rc<DxvkImage>& targetImage);
+    bool reuseStaticSceneOutput(const Rc<DxvkImage>& targetImage, bool captureScreenImage);
+
     bool isStencilShadowVolumeState();
 
     void rasterizeToSkyMatte(const DrawParameters& params);
@@ -297,6 +312,12 @@ namespace dxvk {
     XXH64_hash_t m_lastTerrainMaterial = 0;
     bool m_previousInjectRtxHadScene = false;
 
+    StaticSceneDetector m_staticSceneDetector;
+
+    FrameBudgetGovernor m_frameBudgetGovernor;
+    std::vector<RtxOptionImpl*> m_frameBudgetOptions;
+    std::string m_frameBudgetSettingList;
+
     struct ThumbnailRequest {
       std::string directory;
       std::string filename;
@@ -423,7 +423,23 @@ namespace dxvk {
 
     RtxPass::onFrameBegin(ctx, downscaledExtent, targetExtent);
 
-    if (!isActive())
+    const uint32_t numFramesToKeep = RtxOptions::Get()->numFramesToKeepOptionalPassResources();
+    const bool useHdrWaveform = shouldDispatch() && displayType() == DebugViewDisplayType::HDRWaveform;
+    const bool useInstrumentation = shouldDispatch() && debugViewIdx() == DEBUG_VIEW_INSTRUMENTATION_THREAD_DIVERGENCE;
+
+    switch (m_hdrWaveformLifetime.update(useHdrWaveform, numFramesToKeep)) {
+    case RtxOptionalResourceLifetime::Action::Allocate: createHdrWaveformResource(ctx, downscaledExtent); break;
+    case RtxOptionalResourceLifetime::Action::Release: releaseHdrWaveformResource(); break;
+    default: break;
+    }
+
+    switch (m_instrumentationLifetime.update(useInstrumentation, numFramesToKeep)) {
+    case RtxOptionalResourceLifetime::Action::Allocate: createInstrumentationResource(ctx, downscaledExtent); break;
+    case RtxOptionalResourceLifetime::Action::Release: releaseInstrumentationResource(); break;
+    default: break;
+    }
+
+    if (!shouldDispatch())
       return;
 
     VkClearColorValue clearColor;
@@ -440,7 +456,7 @@ namespace dxvk {
 
     ctx->clearColorImage(m_debugView.image, clearColor, subRange);
 
-    if (debugViewIdx() == DEBUG_VIEW_INSTRUMENTATION_THREAD_DIVERGENCE)
+    if (useInstrumentation)
       ctx->clearColorImage(m_instrumentation.image, clearColor, subRange);
   }
 
@@ -540,7 +556,10 @@ namespace dxvk {
       ctx->updateBuffer(cb, 0, sizeof(DebugViewArgs), &debugViewArgs);
       cmdList->trackResource<DxvkAccess::Read>(cb);
 
-      if (displayType() == DebugViewDisplayType::HDRWaveform) {
+      // Note: The waveform buffers are only allocated at the beginning of the frame the waveform is enabled in
+      const bool useHdrWaveform = displayType() == DebugViewDisplayType::HDRWaveform && m_hdrWaveformRed.image != nullptr;
+
+      if (useHdrWaveform) {
         // Clear HDR Waveform textures when in use before accumulated into
 
         VkClearColorValue clearColor;
@@ -586,7 +605,7 @@ namespace dxvk {
       }
 
       // Display HDR Waveform
-      if (displayType() == DebugViewDisplayType::HDRWaveform) {
+      if (useHdrWaveform) {
         ScopedGpuProfileZone(ctx, "HDR Waveform Render");
 
         ctx->bindResourceView(DEBUG_VIEW_WAVEFORM_RENDER_BINDING_HDR_WAVEFORM_RED_INPUT, m_hdrWaveformRed.view, nullptr);
@@ -632,22 +651,37 @@ namespace dxvk {
   void DebugView::createDownscaledResource(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent) {
     // Debug
     m_debugView = Resources::createImageResource(ctx, downscaledExtent, VK_FORMAT_R32G32B32A32_SFLOAT);
+  }
+
+  void DebugView::releaseDownscaledResource() {
+    m_debugView.reset();
+
+    // Note: Reallocated at the beginning of the next frame they are used in
+    releaseHdrWaveformResource();
+    releaseInstrumentationResource();
+    m_hdrWaveformLifetime.reset();
+    m_instrumentationLifetime.reset();
+  }
 
+  void DebugView::createHdrWaveformResource(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent) {
     // Note: Only allocate half resolution for HDR waveform buffers, this is the default view size
     // and while it is wasteful if the resolution scale is higher, this is probably fine.
     m_hdrWaveformRed = Resources::createImageResource(ctx, { (downscaledExtent.width + 2) / 2, (downscaledExtent.height + 2) / 2, 1 }, VK_FORMAT_R32_UINT);
     m_hdrWaveformBlue = Resources::createImageResource(ctx, { (downscaledExtent.width + 2) / 2, (downscaledExtent.height + 2) / 2, 1 }, VK_FORMAT_R32_UINT);
     m_hdrWaveformGreen = Resources::createImageResource(ctx, { (downscaledExtent.width + 2) / 2, (downscaledExtent.height + 2) / 2, 1 }, VK_FORMAT_R32_UINT);
-
-    // Instrumentation
-    m_instrumentation = Resources::createImageResource(ctx, downscaledExtent, VK_FORMAT_R32_UINT);
   }
 
-  void DebugView::releaseDownscaledResource() {
-    m_debugView.reset();
+  void DebugView::releaseHdrWaveformResource() {
     m_hdrWaveformRed.reset();
     m_hdrWaveformBlue.reset();
     m_hdrWaveformGreen.reset();
+  }
+
+  void DebugView::createInstrumentationResource(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent) {
+    m_instrumentation = Resources::createImageResource(ctx, downscaledExtent, VK_FORMAT_R32_UINT);
+  }
+
+  void DebugView::releaseInstrumentationResource() {
     m_instrumentation.reset();
   }
 
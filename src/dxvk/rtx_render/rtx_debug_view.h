@@ -81,6 +81,11 @@ namespace dxvk {
     void createDownscaledResource(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent);
     void releaseDownscaledResource();
 
+    void createHdrWaveformResource(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent);
+    void releaseHdrWaveformResource();
+    void createInstrumentationResource(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent);
+    void releaseInstrumentationResource();
+
     bool isActive();
 
     Rc<DxvkBuffer> m_debugViewConstants;
@@ -129,5 +134,10 @@ namespace dxvk {
     Resources::Resource m_hdrWaveformGreen;
     Resources::Resource m_hdrWaveformBlue;
     Resources::Resource m_instrumentation;
+
+    // Note: The HDR waveform buffers and the instrumentation image are only needed by some of the debug views,
+    // so they are allocated separately from the debug output while the debug view pass is active.
+    RtxOptionalResourceLifetime m_hdrWaveformLifetime;
+    RtxOptionalResourceLifetime m_instrumentationLifetime;
   };
 } // namespace dxvk
@@ -0,0 +1,169 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <sstream>
+
+#include "rtx_frame_budget.h"
+
+namespace dxvk {
+  namespace {
+    std::string trim(const std::string& str) {
+      const size_t begin = str.find_first_not_of(" \t");
+
+      if (begin == std::string::npos)
+        return std::string();
+
+      const size_t end = str.find_last_not_of(" \t");
+      return str.substr(begin, end - begin + 1);
+    }
+  }
+
+  std::vector<FrameBudgetGovernor::Setting> FrameBudgetGovernor::parseSettings(const std::string& list) {
+    std::vector<Setting> settings;
+    std::stringstream stream(list);
+    std::string entry;
+
+    while (std::getline(stream, entry, ',')) {
+      const size_t separator = entry.find(':');
+
+      Setting setting;
+      setting.name = trim(entry.substr(0, separator));
+
+      if (setting.name.empty())
+        continue;
+
+      if (separator != std::string::npos) {
+        try {
+          setting.minValue = std::stoi(entry.substr(separator + 1));
+        } catch (...) {
+          continue;
+        }
+      }
+
+      settings.push_back(std::move(setting));
+    }
+
+    return settings;
+  }
+
+  void FrameBudgetGovernor::setSettings(std::vector<Setting> settings) {
+    m_settings = std::move(settings);
+
+    for (Setting& setting : m_settings) {
+      setting.minValue = std::min(setting.minValue, setting.maxValue);
+      setting.value = std::clamp(setting.value, setting.minValue, setting.maxValue);
+    }
+
+    m_numSamples = 0;
+    m_framesToSettle = 0;
+    m_lastChange = 0;
+    m_lastChanged = -1;
+    m_raiseBackoff = 0;
+    m_raiseBlockedFrames = 0;
+  }
+
+  void FrameBudgetGovernor::overrideValue(size_t index, int32_t value) {
+    Setting& setting = m_settings[index];
+    setting.maxValue = value;
+    setting.minValue = std::min(setting.minValue, value);
+    setting.value = value;
+  }
+
+  int32_t FrameBudgetGovernor::update(float gpuFrameTimeMs, const Params& params) {
+    if (m_raiseBlockedFrames > 0)
+      m_raiseBlockedFrames--;
+
+    if (m_framesToSettle > 0) {
+      m_framesToSettle--;
+      return -1;
+    }
+
+    if (m_numSamples++ == 0)
+      m_averageFrameTimeMs = gpuFrameTimeMs;
+    else
+      m_averageFrameTimeMs += (gpuFrameTimeMs - m_averageFrameTimeMs) * params.smoothing;
+
+    // Note: Let the average warm up before acting on it
+    const uint32_t minSamples = std::max(1u, uint32_t(1.f / std::max(params.smoothing, 0.01f)));
+
+    if (m_numSamples < minSamples)
+      return -1;
+
+    int32_t changed = -1;
+
+    if (m_averageFrameTimeMs > params.targetFrameTimeMs * (1.f + params.hysteresis)) {
+      changed = lower();
+
+      if (changed >= 0) {
+        // Undoing the last raise: the step does not fit into the hysteresis band, back off
+        if (m_lastChange > 0 && m_lastChanged == changed) {
+          m_raiseBackoff = m_raiseBackoff > 0 ? std::min(m_raiseBackoff * 2, kMaxRaiseBackoff) : std::max(params.settleFrames, 1u) * 4;
+          m_raiseBlockedFrames = m_raiseBackoff;
+        }
+
+        m_lastChange = -1;
+      }
+    } else if (m_averageFrameTimeMs < params.targetFrameTimeMs * (1.f - params.hysteresis) && m_raiseBlockedFrames == 0) {
+      changed = raise();
+
+      if (changed >= 0) {
+        // The previous raise held, so steps fit again
+        if (m_lastChange > 0)
+          m_raiseBackoff = 0;
+
+        m_lastChange = 1;
+      }
+    }
+
+    if (changed >= 0) {
+      m_lastChanged = changed;
+
+      // The frame times measured so far do not reflect the new settings
+      m_numSamples = 0;
+      m_framesToSettle = params.settleFrames;
+    }
+
+    return changed;
+  }
+
+  int32_t FrameBudgetGovernor::lower() {
+    for (size_t i = 0; i < m_settings.size(); i++) {
+      if (m_settings[i].value > m_settings[i].minValue) {
+        m_settings[i].value--;
+        return int32_t(i);
+      }
+    }
+
+    return -1;
+  }
+
+  int32_t FrameBudgetGovernor::raise() {
+    for (size_t i = m_settings.size(); i-- > 0; ) {
+      if (m_settings[i].value < m_settings[i].maxValue) {
+        m_settings[i].value++;
+        return int32_t(i);
+      }
+    }
+
+    return -1;
+  }
+}
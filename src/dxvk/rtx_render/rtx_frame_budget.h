@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dxvk {
+  /**
+   * \brief Frame budget governor
+   *
+   * Holds a target GPU frame time by scaling a set of integer quality settings (e.g. bounce or
+   * sample counts) within their allowed ranges. Settings are given in priority order: when over
+   * budget the first setting is lowered until it reaches its minimum before the next one is
+   * touched, and when under budget they are restored in the reverse order. A hysteresis band
+   * around the target and a number of frames to let the frame time settle after each change
+   * keep the governor from oscillating. When a step is too expensive for the hysteresis band,
+   * i.e. raising a setting puts the frame over budget again right away, further raises are held
+   * off for an exponentially growing number of frames.
+   */
+  class FrameBudgetGovernor {
+  public:
+    struct Setting {
+      std::string name;
+      int32_t minValue = 0;
+      int32_t maxValue = 0;  // Value before the governor took control, never exceeded
+      int32_t value = 0;
+    };
+
+    struct Params {
+      float targetFrameTimeMs = 16.6f;
+      float hysteresis = 0.1f;    // Fraction of the target the frame time may deviate by before acting
+      uint32_t settleFrames = 30; // Frames ignored after a change so it can take effect
+      float smoothing = 0.1f;     // Weight of a new frame time sample in the running average
+    };
+
+    // Parses a comma separated "name:minimum" list, in priority order
+    static std::vector<Setting> parseSettings(const std::string& list);
+
+    void setSettings(std::vector<Setting> settings);
+
+    const std::vector<Setting>& getSettings() const { return m_settings; }
+
+    // Takes a value set from outside the governor (e.g. by the user) as the new maximum of a setting
+    void overrideValue(size_t index, int32_t value);
+
+    // Feeds the GPU time of a frame, returns the index of the setting changed, or -1
+    int32_t update(float gpuFrameTimeMs, const Params& params);
+
+    float getAverageFrameTimeMs() const { return m_averageFrameTimeMs; }
+
+  private:
+    static constexpr uint32_t kMaxRaiseBackoff = 3600;
+
+    std::vector<Setting> m_settings;
+    float m_averageFrameTimeMs = 0.f;
+    uint32_t m_numSamples = 0;
+    uint32_t m_framesToSettle = 0;
+
+    int32_t m_lastChange = 0;   // +1 for a raise, -1 for a lowering
+    int32_t m_lastChanged = -1; // Index of the setting changed last
+    uint32_t m_raiseBackoff = 0;
+    uint32_t m_raiseBlockedFrames = 0;
+
+    int32_t lower();
+    int32_t raise();
+  };
+}
@@ -30,6 +30,8 @@
 #include "rtx_utils.h"
 #include "rtx_instancemanager.h"
 #include "rtx_scenemanager.h"
+#include "rtx_geometry_utils.h"
+#include "rtx/utility/vertex_packing.h"
 #include "../../lssusd/game_exporter.h"
 #include "../../lssusd/game_exporter_paths.h"
 #include "../../util/log/log.h"
@@ -493,23 +495,31 @@ void GameCapturer::captureMeshNormals(const Rc<RtxContext> rtxCtx,
                                       std::shared_ptr<Mesh> pMesh) {
                                         
   AssetExporter::BufferCallback captureMeshNormalsAsync = [rtxCtx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> norBuf) {
-    assert(geomData.normalBuffer.vertexFormat() == VK_FORMAT_R32G32B32_SFLOAT);
+    // Note: Normals of the ray tracing geometry cache may be stored as compact octahedral normals
+    const bool compactNormals = geomData.normalBuffer.vertexFormat() == RtxGeometryUtils::kCompactNormalFormat;
+    assert(compactNormals || geomData.normalBuffer.vertexFormat() == VK_FORMAT_R32G32B32_SFLOAT);
     // Prep helper vars
     const size_t numVertices = geomData.vertexCount;
-    constexpr size_t normalSubElementSize = sizeof(float);
-    const size_t normalStride = geomData.normalBuffer.stride() / normalSubElementSize;
+    const size_t normalStride = geomData.normalBuffer.stride();
+    const size_t normalElementSize = compactNormals ? sizeof(uint32_t) : sizeof(pxr::GfVec3f);
     const DxvkBufferSlice normalBuffer(norBuf, 0, norBuf->info().size );
     // Ensure no reads are out of bounds
-    assert(((size_t)(numVertices - 1) * (size_t)geomData.normalBuffer.stride() + sizeof(pxr::GfVec3f)) <=
+    assert(((size_t)(numVertices - 1) * normalStride + normalElementSize) <=
            (normalBuffer.length() - geomData.normalBuffer.offsetFromSlice()));
     // Get copied-to-CPU GPU buffer
-    const float* pVkNormalBuf = (float*)normalBuffer.mapPtr((size_t)geomData.normalBuffer.offsetFromSlice());
+    const uint8_t* pVkNormalBuf = (uint8_t*)normalBuffer.mapPtr((size_t)geomData.normalBuffer.offsetFromSlice());
     assert(pVkNormalBuf);
     // Copy GPU buffer to local VtArray
     pxr::VtArray<pxr::GfVec3f> normals;
     normals.reserve(numVertices);
     for (size_t idx = 0; idx < numVertices; ++idx) {
-      normals.push_back(pxr::GfVec3f(&pVkNormalBuf[idx * normalStride]));
+      if (compactNormals) {
+        float normal[3];
+        vertexPackingDecodeNormal(*(const uint32_t*)&pVkNormalBuf[idx * normalStride], normal);
+        normals.push_back(pxr::GfVec3f(normal));
+      } else {
+        normals.push_back(pxr::GfVec3f((const float*)&pVkNormalBuf[idx * normalStride]));
+      }
     }
     assert(normals.size() > 0);
     // Create comparison function that returns float
@@ -578,25 +588,35 @@ void GameCapturer::captureMeshTexCoords(const Rc<RtxContext> rtxCtx,
                                         std::shared_ptr<Mesh> pMesh) {
                                           
   AssetExporter::BufferCallback captureMeshTexCoordsAsync = [rtxCtx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> texBuf) {
-    assert(geomData.texcoordBuffer.vertexFormat() == VK_FORMAT_R32G32_SFLOAT ||
+    // Note: Texcoords of the ray tracing geometry cache may be stored as compact half precision texcoords
+    const bool compactTexcoords = geomData.texcoordBuffer.vertexFormat() == RtxGeometryUtils::kCompactTexcoordFormat;
+    assert(compactTexcoords ||
+           geomData.texcoordBuffer.vertexFormat() == VK_FORMAT_R32G32_SFLOAT ||
            geomData.texcoordBuffer.vertexFormat() == VK_FORMAT_R32G32B32_SFLOAT);
     // Prep helper vars
     const size_t numVertices = geomData.vertexCount;
-    constexpr size_t texcoordSubElementSize = sizeof(float);
-    const size_t texcoordStride = geomData.texcoordBuffer.stride() / texcoordSubElementSize;
+    const size_t texcoordStride = geomData.texcoordBuffer.stride();
+    const size_t texcoordElementSize = compactTexcoords ? sizeof(uint32_t) : sizeof(pxr::GfVec2f);
     const DxvkBufferSlice texcoordBuffer(texBuf, 0, texBuf->info().size );
     // Ensure no reads are out of bounds
-    assert(((size_t)(numVertices - 1) * (size_t)geomData.texcoordBuffer.stride() + sizeof(pxr::GfVec2f)) <=
+    assert(((size_t)(numVertices - 1) * texcoordStride + texcoordElementSize) <=
            (texcoordBuffer.length() - geomData.texcoordBuffer.offsetFromSlice()));
     // Get copied-to-CPU GPU buffer
-    const float* pVkTexcoordsBuf = (float*)texcoordBuffer.mapPtr((size_t)geomData.texcoordBuffer.offsetFromSlice());
+    const uint8_t* pVkTexcoordsBuf = (uint8_t*)texcoordBuffer.mapPtr((size_t)geomData.texcoordBuffer.offsetFromSlice());
     assert(pVkTexcoordsBuf);
     // Copy GPU buffer to local VtArray
     pxr::VtArray<pxr::GfVec2f> texcoords;
     texcoords.reserve(numVertices);
     for (size_t idx = 0; idx < numVertices; ++idx) {
-      texcoords.push_back(pxr::GfVec2f(       pVkTexcoordsBuf[idx * texcoordStride],
-                                       1.0f - pVkTexcoordsBuf[idx * texcoordStride + 1]));
+      float texcoord[2];
+      if (compactTexcoords) {
+        vertexPackingDecodeTexcoord(*(const uint32_t*)&pVkTexcoordsBuf[idx * texcoordStride], texcoord);
+      } else {
+        const float* pTexcoord = (const float*)&pVkTexcoordsBuf[idx * texcoordStride];
+        texcoord[0] = pTexcoord[0];
+        texcoord[1] = pTexcoord[1];
+      }
+      texcoords.push_back(pxr::GfVec2f(texcoord[0], 1.0f - texcoord[1]));
     }
     assert(texcoords.size() > 0);
     // Create comparison function that returns float
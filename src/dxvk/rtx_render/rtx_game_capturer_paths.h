@@ -31,17 +31,23 @@ namespace dxvk {
 namespace commonFileName {
   static const std::string mod("mod");
   static const std::string bakedSkyProbe("T_SkyProbe_NonReplaceable" + lss::ext::dds);
+  static const std::string assetCosts("asset_costs.csv");
 }
     
 namespace relPath {
   static const std::string rtxRemixDir("./rtx-remix/");
   static const std::string modsDir("./mods/");
   static const std::string captureDir("./captures/");
+  static const std::string blasCacheDir("./blascache/");
+  static const std::string meshLodCacheDir("./meshlodcache/");
 
   static const std::string remixCaptureDir(rtxRemixDir + captureDir);
   static const std::string remixCaptureThumbnailsDir(remixCaptureDir + lss::commonDirName::thumbDir);
   static const std::string remixCaptureTexturesDir(remixCaptureDir + lss::commonDirName::texDir);
   static const std::string remixCaptureMaterialsDir(remixCaptureDir + lss::commonDirName::matDir);
   static const std::string remixCaptureBakedSkyProbePath(remixCaptureTexturesDir + commonFileName::bakedSkyProbe);
+  static const std::string remixBlasCacheDir(rtxRemixDir + blasCacheDir);
+  static const std::string remixMeshLodCacheDir(rtxRemixDir + meshLodCacheDir);
+  static const std::string remixAssetCostsPath(rtxRemixDir + commonFileName::assetCosts);
 }
 }
\ No newline at end of file
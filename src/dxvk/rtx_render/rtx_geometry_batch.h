@@ -0,0 +1,170 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace dxvk {
+  /**
+   * \brief Work list of a batched geometry processing dispatch
+   *
+   * Jobs of a batch read their inputs from and write their outputs to a pair of arena buffers, so
+   * a single dispatch with one set of bindings processes every job. The layout packs the source
+   * ranges each job reads into the input arena (the copies to record ahead of the dispatch),
+   * reserves the output range of each job and partitions the dispatch's threads between jobs.
+   *
+   * Resource identifies source buffers, it only needs to be copyable and equality comparable.
+   */
+  template<typename Resource>
+  class GeometryBatchLayout {
+  public:
+    static constexpr uint64_t kArenaAlignment = 16;
+
+    // Range of a source buffer read by a job
+    struct Stream {
+      Resource resource;
+      uint64_t offset;
+      uint64_t size;
+    };
+
+    // Copy of a source range into the input arena
+    struct Copy {
+      Resource resource;
+      uint64_t resourceOffset;
+      uint64_t arenaOffset;
+      uint64_t size;
+    };
+
+    /**
+     * \brief Adds the source ranges read by a job to the input arena
+     *
+     * Ranges of the same resource which overlap or touch are merged into a single copy, so
+     * attributes interleaved in one vertex buffer are only copied once. Offsets within a
+     * merged range are preserved, ranges keep their alignment relative to each other.
+     * \param [in] streams Ranges read by the job
+     * \param [out] arenaOffsets Input arena offset of the first byte of each range
+     */
+    void addInputs(const std::vector<Stream>& streams, std::vector<uint64_t>& arenaOffsets) {
+      arenaOffsets.resize(streams.size());
+
+      std::vector<bool> placed(streams.size(), false);
+      std::vector<size_t> members;
+
+      for (size_t i = 0; i < streams.size(); i++) {
+        if (placed[i])
+          continue;
+
+        uint64_t begin = streams[i].offset;
+        uint64_t end = streams[i].offset + streams[i].size;
+
+        placed[i] = true;
+        members.clear();
+        members.push_back(i);
+
+        // Grow the range until no other range of the resource overlaps it
+        for (bool grown = true; grown; ) {
+          grown = false;
+
+          for (size_t j = i + 1; j < streams.size(); j++) {
+            const Stream& stream = streams[j];
+
+            if (placed[j] || !(stream.resource == streams[i].resource))
+              continue;
+
+            if (stream.offset <= end && stream.offset + stream.size >= begin) {
+              begin = std::min(begin, stream.offset);
+              end = std::max(end, stream.offset + stream.size);
+              placed[j] = true;
+              members.push_back(j);
+              grown = true;
+            }
+          }
+        }
+
+        const uint64_t arenaOffset = allocate(m_inputSize, end - begin);
+        m_copies.push_back({ streams[i].resource, begin, arenaOffset, end - begin });
+
+        for (size_t member : members)
+          arenaOffsets[member] = arenaOffset + streams[member].offset - begin;
+      }
+    }
+
+    /**
+     * \brief Reserves the output range of a job
+     * \returns Output arena offset of the range
+     */
+    uint64_t addOutput(uint64_t size) {
+      return allocate(m_outputSize, size);
+    }
+
+    /**
+     * \brief Reserves the threads of a job
+     * \returns First thread of the job within the dispatch
+     */
+    uint32_t addThreads(uint32_t count) {
+      const uint32_t firstThread = m_threadCount;
+      m_threadCount += count;
+      return firstThread;
+    }
+
+    const std::vector<Copy>& getCopies() const {
+      return m_copies;
+    }
+
+    uint64_t getInputSize() const {
+      return m_inputSize;
+    }
+
+    uint64_t getOutputSize() const {
+      return m_outputSize;
+    }
+
+    uint32_t getThreadCount() const {
+      return m_threadCount;
+    }
+
+    bool empty() const {
+      return m_threadCount == 0;
+    }
+
+    void clear() {
+      m_copies.clear();
+      m_inputSize = 0;
+      m_outputSize = 0;
+      m_threadCount = 0;
+    }
+
+  private:
+    std::vector<Copy> m_copies;
+    uint64_t m_inputSize = 0;
+    uint64_t m_outputSize = 0;
+    uint32_t m_threadCount = 0;
+
+    static uint64_t allocate(uint64_t& arenaSize, uint64_t size) {
+      const uint64_t offset = (arenaSize + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+      arenaSize = offset + size;
+      return offset;
+    }
+  };
+}
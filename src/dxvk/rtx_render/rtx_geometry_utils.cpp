@@ -24,10 +24,12 @@
 #include "dxvk_shader_manager.h"
 
 #include <rtx_shaders/gen_tri_list_index_buffer.h>
+#include <rtx_shaders/gen_tri_list_index_buffer_batch.h>
 #include <rtx_shaders/gpu_skinning.h>
 #include <rtx_shaders/view_model_correction.h>
 #include <rtx_shaders/bake_opacity_micromap.h>
 #include <rtx_shaders/interleave_geometry.h>
+#include <rtx_shaders/interleave_geometry_batch.h>
 #include "dxvk_scoped_annotation.h"
 
 #include "rtx_context.h"
@@ -57,6 +59,20 @@ namespace dxvk {
 
     PREWARM_SHADER_PIPELINE(GenTriListIndicesShader);
 
+    class GenTriListIndicesBatchShader : public ManagedShader {
+      SHADER_SOURCE(GenTriListIndicesBatchShader, VK_SHADER_STAGE_COMPUTE_BIT, gen_tri_list_index_buffer_batch)
+
+      PUSH_CONSTANTS(GenTriListBatchArgs)
+
+      BEGIN_PARAMETER()
+        RW_STRUCTURED_BUFFER(GEN_TRILIST_BINDING_OUTPUT)
+        STRUCTURED_BUFFER(GEN_TRILIST_BINDING_INPUT)
+        STRUCTURED_BUFFER(GEN_TRILIST_BINDING_JOBS)
+      END_PARAMETER()
+    };
+
+    PREWARM_SHADER_PIPELINE(GenTriListIndicesBatchShader);
+
     class SkinningShader : public ManagedShader {
       SHADER_SOURCE(SkinningShader, VK_SHADER_STAGE_COMPUTE_BIT, gpu_skinning)
 
@@ -118,6 +134,27 @@ namespace dxvk {
     };
 
     PREWARM_SHADER_PIPELINE(InterleaveGeometryShader);
+
+    class InterleaveGeometryBatchShader : public ManagedShader {
+      SHADER_SOURCE(InterleaveGeometryBatchShader, VK_SHADER_STAGE_COMPUTE_BIT, interleave_geometry_batch)
+
+      PUSH_CONSTANTS(InterleaveGeometryBatchArgs)
+
+      BEGIN_PARAMETER()
+      RW_STRUCTURED_BUFFER(INTERLEAVE_GEOMETRY_BINDING_OUTPUT)
+      STRUCTURED_BUFFER(INTERLEAVE_GEOMETRY_BINDING_POSITION_INPUT)
+      STRUCTURED_BUFFER(INTERLEAVE_GEOMETRY_BINDING_NORMAL_INPUT)
+      STRUCTURED_BUFFER(INTERLEAVE_GEOMETRY_BINDING_TEXCOORD_INPUT)
+      STRUCTURED_BUFFER(INTERLEAVE_GEOMETRY_BINDING_COLOR0_INPUT)
+      STRUCTURED_BUFFER(INTERLEAVE_GEOMETRY_BINDING_JOBS)
+      END_PARAMETER()
+    };
+
+    PREWARM_SHADER_PIPELINE(InterleaveGeometryBatchShader);
+
+    // Maximum number of workgroups a single batch dispatch is split into (minimum maxComputeWorkGroupCount guaranteed by Vulkan)
+    constexpr uint32_t kMaxBatchWorkgroups = 65535;
+    constexpr uint32_t kBatchWorkgroupSize = 128;
   }
 
   RtxGeometryUtils::RtxGeometryUtils(DxvkDevice* pDevice) {
@@ -125,6 +162,13 @@ namespace dxvk {
       pDevice,
       (VkMemoryPropertyFlagBits) (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT),
       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    m_pBatchData = std::make_unique<DxvkStagingDataAlloc>(
+      pDevice,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
   }
 
   RtxGeometryUtils::~RtxGeometryUtils() { }
@@ -201,6 +245,7 @@ namespace dxvk {
     args.positionOffset = geo.positionBuffer.offsetFromSlice();
     args.normalStride = geo.normalBuffer.defined() ? geo.normalBuffer.stride() : 0;
     args.normalOffset = geo.normalBuffer.defined() ? geo.normalBuffer.offsetFromSlice() : 0;
+    args.compactNormals = geo.normalBuffer.defined() && geo.normalBuffer.vertexFormat() == kCompactNormalFormat;
     args.numVertices = geo.vertexCount;
 
     // Upload the arguments into a buffer slice
@@ -249,6 +294,7 @@ namespace dxvk {
     args.subdivisionLevel = desc.subdivisionLevel;
     args.texcoordOffset = geo.texcoordBuffer.offsetFromSlice();
     args.texcoordStride = geo.texcoordBuffer.stride();
+    args.compactTexcoords = geo.texcoordBuffer.vertexFormat() == kCompactTexcoordFormat;
     args.resolveTransparencyThreshold = desc.resolveTransparencyThreshold;
     args.resolveOpaquenessThreshold = desc.resolveOpaquenessThreshold;
     args.useConservativeEstimation = desc.useConservativeEstimation;
@@ -399,14 +445,16 @@ namespace dxvk {
     return true;
   }
 
-  void RtxGeometryUtils::dispatchGenTriList(const Rc<RtxContext>& ctx, const GenTriListArgs& cb, const DxvkBufferSlice& dstSlice, const RasterBuffer* srcBuffer) const {
+  void RtxGeometryUtils::dispatchGenTriList(const Rc<RtxContext>& ctx, const GenTriListArgs& cb, const DxvkBufferSlice& dstSlice, const RasterBuffer* srcBuffer) {
     ZoneScoped;
     ScopedGpuProfileZone(ctx, "generateTriangleList");
     // At some point, its more efficient to do these calculations on the GPU, this limit is somewhat arbitrary however, and might require better tuning...
     const uint32_t kNumTrianglesToProcessOnCPU = 512;
     const bool useGPU = ((srcBuffer != nullptr) && (srcBuffer->isPendingGpuWrite())) || cb.primCount > kNumTrianglesToProcessOnCPU;
 
-    if (useGPU) {
+    if (useGPU && RtxOptions::Get()->batchGeometryProcessing() && batchGenTriList(cb, dstSlice, srcBuffer)) {
+      // Deferred to flushGeometryBatches
+    } else if (useGPU) {
       ctx->bindResourceBuffer(GEN_TRILIST_BINDING_OUTPUT, dstSlice);
 
       if (srcBuffer != nullptr)
@@ -445,10 +493,10 @@ namespace dxvk {
     output.positionBuffer = RaytraceBuffer(targetSlice, desc.positionOffset, desc.stride, VK_FORMAT_R32G32B32_SFLOAT);
 
     if (desc.hasNormals)
-      output.normalBuffer = RaytraceBuffer(targetSlice, desc.normalOffset, desc.stride, VK_FORMAT_R32G32B32_SFLOAT);
+      output.normalBuffer = RaytraceBuffer(targetSlice, desc.normalOffset, desc.stride, desc.compactNormals ? kCompactNormalFormat : VK_FORMAT_R32G32B32_SFLOAT);
 
     if (desc.hasTexcoord)
-      output.texcoordBuffer = RaytraceBuffer(targetSlice, desc.texcoordOffset, desc.stride, VK_FORMAT_R32G32_SFLOAT);
+      output.texcoordBuffer = RaytraceBuffer(targetSlice, desc.texcoordOffset, desc.stride, desc.compactTexcoords ? kCompactTexcoordFormat : VK_FORMAT_R32G32_SFLOAT);
 
     if (desc.hasColor0) 
       output.color0Buffer = RaytraceBuffer(targetSlice, desc.color0Offset, desc.stride, VK_FORMAT_B8G8R8A8_UNORM);
@@ -476,19 +524,41 @@ namespace dxvk {
       output.color0Buffer = RaytraceBuffer(slice, input.color0Buffer.offsetFromSlice(), input.color0Buffer.stride(), input.color0Buffer.vertexFormat());
   }
 
-  size_t RtxGeometryUtils::computeOptimalVertexStride(const RasterGeometry& input) {
+  RtxGeometryUtils::CompactVertexLayout RtxGeometryUtils::getCompactVertexLayout(const RasterGeometry& input) {
+    CompactVertexLayout layout;
+
+    // Note: Skinned geometry is excluded as the skinning shader writes full precision normals into the cached
+    // vertex data in place. Blend weights are used rather than the per draw bone count as they are a property
+    // of the geometry itself and so cannot change between the build and later updates.
+    if (input.blendWeightBuffer.defined())
+      return layout;
+
+    layout.normals = RtxOptions::Get()->compactRaytracingNormals() && input.normalBuffer.defined();
+    layout.texcoords = RtxOptions::Get()->compactRaytracingTexcoords() && input.texcoordBuffer.defined();
+
+    return layout;
+  }
+
+  RtxGeometryUtils::CompactVertexLayout RtxGeometryUtils::getCompactVertexLayout(const RaytraceGeometry& geometry) {
+    CompactVertexLayout layout;
+    layout.normals = geometry.normalBuffer.defined() && geometry.normalBuffer.vertexFormat() == kCompactNormalFormat;
+    layout.texcoords = geometry.texcoordBuffer.defined() && geometry.texcoordBuffer.vertexFormat() == kCompactTexcoordFormat;
+    return layout;
+  }
+
+  size_t RtxGeometryUtils::computeOptimalVertexStride(const RasterGeometry& input, const CompactVertexLayout& layout) {
     // Calculate stride
     size_t stride = sizeof(float) * 3; // position is the minimum
     assert(input.positionBuffer.vertexFormat() == VK_FORMAT_R32G32B32A32_SFLOAT || input.positionBuffer.vertexFormat() == VK_FORMAT_R32G32B32_SFLOAT);
 
     if (input.normalBuffer.defined()) {
       assert(input.normalBuffer.vertexFormat() == VK_FORMAT_R32G32B32_SFLOAT);
-      stride += sizeof(float) * 3;
+      stride += layout.normals ? sizeof(uint32_t) : sizeof(float) * 3;
     }
 
     if (input.texcoordBuffer.defined()) {
       assert(isTexcoordFormatValid(input.texcoordBuffer.vertexFormat()));
-      stride += sizeof(float) * 2;
+      stride += layout.texcoords ? sizeof(uint32_t) : sizeof(float) * 2;
     }
 
     if (input.color0Buffer.defined()) {
@@ -499,9 +569,10 @@ namespace dxvk {
     return stride;
   }
 
-  void RtxGeometryUtils::cacheVertexDataOnGPU(const Rc<RtxContext>& ctx, const RasterGeometry& input, RaytraceGeometry& output) {
+  void RtxGeometryUtils::cacheVertexDataOnGPU(const Rc<RtxContext>& ctx, const RasterGeometry& input, const CompactVertexLayout& layout, RaytraceGeometry& output) {
     ZoneScoped;
-    if (input.isVertexDataInterleaved()) {
+    // Note: Interleaved data can only be copied as is when no attribute needs to be re-encoded
+    if (input.isVertexDataInterleaved() && !layout.any()) {
       const size_t vertexBufferSize = input.vertexCount * input.positionBuffer.stride();
       ctx->copyBuffer(output.historyBuffer[0], 0, input.positionBuffer.buffer(), input.positionBuffer.offset(), vertexBufferSize);
 
@@ -510,7 +581,7 @@ namespace dxvk {
       RtxGeometryUtils::InterleavedGeometryDescriptor interleaveResult;
       interleaveResult.buffer = output.historyBuffer[0];
 
-      ctx->getCommonObjects()->metaGeometryUtils().interleaveGeometry(ctx, input, interleaveResult);
+      ctx->getCommonObjects()->metaGeometryUtils().interleaveGeometry(ctx, input, layout, interleaveResult);
 
       processGeometryBuffers(interleaveResult, output);
     }
@@ -519,14 +590,15 @@ namespace dxvk {
   void RtxGeometryUtils::interleaveGeometry(
     const Rc<RtxContext>& ctx,
     const RasterGeometry& input,
-    InterleavedGeometryDescriptor& output) const {
+    const CompactVertexLayout& layout,
+    InterleavedGeometryDescriptor& output) {
     ZoneScoped;
     ScopedGpuProfileZone(ctx, "interleaveGeometry");
     // Required
     assert(input.positionBuffer.defined());
 
     // Calculate stride
-    output.stride = computeOptimalVertexStride(input);
+    output.stride = computeOptimalVertexStride(input, layout);
     
     assert(output.buffer->info().size == align(output.stride * input.vertexCount, CACHE_LINE_SIZE));
 
@@ -559,15 +631,21 @@ namespace dxvk {
       args.color0Stride = input.color0Buffer.stride() / 4;
     }
 
+    args.compactNormals = args.hasNormals && layout.normals;
+    args.compactTexcoords = args.hasTexcoord && layout.texcoords;
+
     args.minVertexIndex = 0;
     assert(output.stride % 4 == 0);
     args.outputStride = output.stride / 4;
+    args.outputOffset = 0;
     args.vertexCount = input.vertexCount;
 
     const uint32_t kNumVerticesToProcessOnCPU = 1024;
     const bool useGPU = input.vertexCount > kNumVerticesToProcessOnCPU || pendingGpuWrites;
 
-    if (useGPU) {
+    if (useGPU && RtxOptions::Get()->batchGeometryProcessing() && batchInterleaveGeometry(input, args, output.buffer, output.stride * input.vertexCount)) {
+      // Deferred to flushGeometryBatches
+    } else if (useGPU) {
       ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_OUTPUT, DxvkBufferSlice(output.buffer));
 
       ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_POSITION_INPUT, input.positionBuffer);
@@ -612,14 +690,16 @@ namespace dxvk {
 
     if (input.normalBuffer.defined()) {
       output.hasNormals = true;
+      output.compactNormals = args.compactNormals;
       output.normalOffset = offset;
-      offset += sizeof(float) * 3;
+      offset += output.compactNormals ? sizeof(uint32_t) : sizeof(float) * 3;
     }
 
     if (input.texcoordBuffer.defined()) {
       output.hasTexcoord = true;
+      output.compactTexcoords = args.compactTexcoords;
       output.texcoordOffset = offset;
-      offset += sizeof(float) * 2;
+      offset += output.compactTexcoords ? sizeof(uint32_t) : sizeof(float) * 2;
     }
 
     if (input.color0Buffer.defined()) {
@@ -628,4 +708,183 @@ namespace dxvk {
       offset += sizeof(uint32_t);
     }
   }
+
+  bool RtxGeometryUtils::batchInterleaveGeometry(const RasterGeometry& input, InterleaveGeometryArgs args, const Rc<DxvkBuffer>& output, uint32_t outputSize) {
+    using Stream = GeometryBatchLayout<Rc<DxvkBuffer>>::Stream;
+
+    std::vector<Stream> streams;
+    std::vector<uint32_t*> streamOffsets;
+
+    // Copies the elements the job reads, attribute offsets are rebased onto the input arena below
+    auto addStream = [&](const RasterBuffer& buffer, uint32_t elementSize, uint32_t& offset) {
+      const VkDeviceSize begin = buffer.offsetFromSlice();
+      const VkDeviceSize end = begin + VkDeviceSize(input.vertexCount - 1) * buffer.stride() + elementSize;
+
+      if (buffer.offset() % 4 != 0 || end > buffer.length())
+        return false;
+
+      streams.push_back({ buffer.buffer(), buffer.offset() + begin, end - begin });
+      streamOffsets.push_back(&offset);
+      return true;
+    };
+
+    bool batchable = addStream(input.positionBuffer, sizeof(float) * 3, args.positionOffset);
+
+    if (args.hasNormals)
+      batchable = batchable && addStream(input.normalBuffer, sizeof(float) * 3, args.normalOffset);
+
+    if (args.hasTexcoord)
+      batchable = batchable && addStream(input.texcoordBuffer, sizeof(float) * 2, args.texcoordOffset);
+
+    if (args.hasColor0)
+      batchable = batchable && addStream(input.color0Buffer, sizeof(uint32_t), args.color0Offset);
+
+    if (!batchable)
+      return false;
+
+    std::vector<uint64_t> arenaOffsets;
+    m_interleaveBatch.layout.addInputs(streams, arenaOffsets);
+
+    for (uint32_t i = 0; i < streams.size(); i++)
+      *streamOffsets[i] = uint32_t(arenaOffsets[i] / 4);
+
+    const uint64_t outputOffset = m_interleaveBatch.layout.addOutput(outputSize);
+    args.outputOffset = uint32_t(outputOffset / 4);
+
+    InterleaveGeometryJob job;
+    job.args = args;
+    job.firstThread = m_interleaveBatch.layout.addThreads(input.vertexCount);
+
+    m_interleaveBatch.jobs.push_back(job);
+    m_interleaveBatch.outputs.push_back({ output, 0, outputOffset, outputSize });
+    return true;
+  }
+
+  bool RtxGeometryUtils::batchGenTriList(GenTriListArgs args, const DxvkBufferSlice& dst, const RasterBuffer* srcBuffer) {
+    using Stream = GeometryBatchLayout<Rc<DxvkBuffer>>::Stream;
+
+    // Note: generateIndices reads indices relative to the bound slice, starting at firstIndex
+    assert(args.firstIndex == 0);
+
+    if (srcBuffer != nullptr) {
+      const uint32_t indexReadCount = (args.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) ? args.primCount * 3 : args.primCount + 2;
+      const VkDeviceSize size = VkDeviceSize(indexReadCount) * sizeof(uint16_t);
+
+      if (size > srcBuffer->length())
+        return false;
+
+      std::vector<uint64_t> arenaOffsets;
+      m_genTriListBatch.layout.addInputs({ Stream { srcBuffer->buffer(), srcBuffer->offset(), size } }, arenaOffsets);
+
+      args.firstIndex = uint32_t(arenaOffsets[0] / sizeof(uint16_t));
+    }
+
+    const uint64_t outputSize = uint64_t(args.primCount) * 3 * sizeof(uint16_t);
+    const uint64_t outputOffset = m_genTriListBatch.layout.addOutput(outputSize);
+    args.outputOffset = uint32_t(outputOffset / sizeof(uint16_t));
+
+    GenTriListJob job;
+    job.args = args;
+    job.firstThread = m_genTriListBatch.layout.addThreads(args.primCount);
+
+    m_genTriListBatch.jobs.push_back(job);
+    m_genTriListBatch.outputs.push_back({ dst.buffer(), dst.offset(), outputOffset, outputSize });
+    return true;
+  }
+
+  template<typename Job>
+  RtxGeometryUtils::BatchArena RtxGeometryUtils::beginBatch(const Rc<RtxContext>& ctx, const GeometryBatch<Job>& batch) {
+    constexpr VkDeviceSize kAlignment = GeometryBatchLayout<Rc<DxvkBuffer>>::kArenaAlignment;
+
+    // Note: Structured buffer bindings must not be empty, even when no job reads an input
+    const VkDeviceSize inputSize = align(std::max<VkDeviceSize>(batch.layout.getInputSize(), kAlignment), kAlignment);
+    const VkDeviceSize outputSize = align(batch.layout.getOutputSize(), kAlignment);
+    const VkDeviceSize jobsSize = sizeof(Job) * batch.jobs.size();
+
+    // Allocated as a single slice, the allocator may hand out overlapping slices until they are used
+    const DxvkBufferSlice arena = m_pBatchData->alloc(kAlignment, inputSize + outputSize + jobsSize);
+
+    BatchArena result;
+    result.input = DxvkBufferSlice(arena.buffer(), arena.offset(), inputSize);
+    result.output = DxvkBufferSlice(arena.buffer(), arena.offset() + inputSize, outputSize);
+    result.jobs = DxvkBufferSlice(arena.buffer(), arena.offset() + inputSize + outputSize, jobsSize);
+
+    ctx->updateBuffer(result.jobs.buffer(), result.jobs.offset(), jobsSize, batch.jobs.data());
+
+    for (const auto& copy : batch.layout.getCopies())
+      ctx->copyBuffer(result.input.buffer(), result.input.offset() + copy.arenaOffset, copy.resource, copy.resourceOffset, copy.size);
+
+    return result;
+  }
+
+  template<typename Job>
+  void RtxGeometryUtils::endBatch(const Rc<RtxContext>& ctx, GeometryBatch<Job>& batch, const BatchArena& arena) {
+    for (const auto& output : batch.outputs)
+      ctx->copyBuffer(output.buffer, output.offset, arena.output.buffer(), arena.output.offset() + output.arenaOffset, output.size);
+
+    batch.clear();
+  }
+
+  template<typename BatchArgs>
+  void RtxGeometryUtils::dispatchBatch(const Rc<RtxContext>& ctx, BatchArgs args) {
+    const uint32_t threadCount = args.threadCount;
+
+    ctx->setPushConstantBank(DxvkPushConstantBank::RTX);
+
+    // Split dispatches exceeding the workgroup count limit, threads are offset into the job table
+    for (args.threadOffset = 0; args.threadOffset < threadCount; args.threadOffset += kMaxBatchWorkgroups * kBatchWorkgroupSize) {
+      ctx->pushConstants(0, sizeof(BatchArgs), &args);
+
+      const uint32_t chunkThreadCount = std::min(threadCount - args.threadOffset, kMaxBatchWorkgroups * kBatchWorkgroupSize);
+      const VkExtent3D workgroups = util::computeBlockCount(VkExtent3D { chunkThreadCount, 1, 1 }, VkExtent3D { kBatchWorkgroupSize, 1, 1 });
+      ctx->dispatch(workgroups.width, workgroups.height, workgroups.depth);
+    }
+  }
+
+  void RtxGeometryUtils::flushGeometryBatches(const Rc<RtxContext>& ctx) {
+    ZoneScoped;
+
+    if (m_genTriListBatch.empty() && m_interleaveBatch.empty())
+      return;
+
+    ScopedGpuProfileZone(ctx, "flushGeometryBatches");
+
+    if (!m_genTriListBatch.empty()) {
+      const BatchArena arena = beginBatch(ctx, m_genTriListBatch);
+
+      ctx->bindResourceBuffer(GEN_TRILIST_BINDING_OUTPUT, arena.output);
+      ctx->bindResourceBuffer(GEN_TRILIST_BINDING_INPUT, arena.input);
+      ctx->bindResourceBuffer(GEN_TRILIST_BINDING_JOBS, arena.jobs);
+
+      ctx->bindShader(VK_SHADER_STAGE_COMPUTE_BIT, GenTriListIndicesBatchShader::getShader());
+
+      GenTriListBatchArgs args;
+      args.jobCount = uint32_t(m_genTriListBatch.jobs.size());
+      args.threadCount = m_genTriListBatch.layout.getThreadCount();
+      dispatchBatch(ctx, args);
+
+      endBatch(ctx, m_genTriListBatch, arena);
+    }
+
+    if (!m_interleaveBatch.empty()) {
+      const BatchArena arena = beginBatch(ctx, m_interleaveBatch);
+
+      // Every attribute is read from the input arena, the job args carry the per attribute offsets
+      ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_OUTPUT, arena.output);
+      ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_POSITION_INPUT, arena.input);
+      ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_NORMAL_INPUT, arena.input);
+      ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_TEXCOORD_INPUT, arena.input);
+      ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_COLOR0_INPUT, arena.input);
+      ctx->bindResourceBuffer(INTERLEAVE_GEOMETRY_BINDING_JOBS, arena.jobs);
+
+      ctx->bindShader(VK_SHADER_STAGE_COMPUTE_BIT, InterleaveGeometryBatchShader::getShader());
+
+      InterleaveGeometryBatchArgs args;
+      args.jobCount = uint32_t(m_interleaveBatch.jobs.size());
+      args.threadCount = m_interleaveBatch.layout.getThreadCount();
+      dispatchBatch(ctx, args);
+
+      endBatch(ctx, m_interleaveBatch, arena);
+    }
+  }
 }
@@ -27,6 +27,8 @@
 
 #include "../util/util_matrix.h"
 #include "rtx/pass/gen_tri_list_index_buffer_indices.h"
+#include "rtx/pass/interleave_geometry_indices.h"
+#include "rtx_geometry_batch.h"
 #include "rtx_types.h"
 
 struct SkinningArgs;
@@ -45,6 +47,36 @@ namespace dxvk {
   */
   class RtxGeometryUtils {
     std::unique_ptr<DxvkStagingDataAlloc> m_pCbData;
+    std::unique_ptr<DxvkStagingDataAlloc> m_pBatchData;
+
+    // Interleave and triangle list generation jobs gathered from draw calls, executed with
+    // a single dispatch per kind when flushed
+    template<typename Job>
+    struct GeometryBatch {
+      struct OutputCopy {
+        Rc<DxvkBuffer> buffer;
+        VkDeviceSize offset;
+        uint64_t arenaOffset;
+        uint64_t size;
+      };
+
+      GeometryBatchLayout<Rc<DxvkBuffer>> layout;
+      std::vector<Job> jobs;
+      std::vector<OutputCopy> outputs;
+
+      bool empty() const {
+        return jobs.empty();
+      }
+
+      void clear() {
+        layout.clear();
+        jobs.clear();
+        outputs.clear();
+      }
+    };
+
+    GeometryBatch<InterleaveGeometryJob> m_interleaveBatch;
+    GeometryBatch<GenTriListJob> m_genTriListBatch;
 
   public:
     RtxGeometryUtils(DxvkDevice* pDevice);
@@ -124,8 +156,26 @@ namespace dxvk {
       uint32_t texcoordOffset = 0;
       bool hasColor0 = false;
       uint32_t color0Offset = 0;
+      bool compactNormals = false;
+      bool compactTexcoords = false;
     };
 
+    /**
+     * \brief Selects which vertex attributes are stored using the compact encodings
+     *        from vertex_packing.h in the ray tracing geometry cache.
+     */
+    struct CompactVertexLayout {
+      bool normals = false;
+      bool texcoords = false;
+
+      bool any() const { return normals || texcoords; }
+    };
+
+    // Note: Vertex formats used to tag compact attributes on RaytraceBuffers, octahedral normals are
+    // not a true snorm vector but share its memory footprint.
+    static constexpr VkFormat kCompactNormalFormat = VK_FORMAT_R16G16_SNORM;
+    static constexpr VkFormat kCompactTexcoordFormat = VK_FORMAT_R16G16_SFLOAT;
+
     // Helpers for promoting Geometry Snapshots from raster pipeline to Geometry Data for RT pipeline
     // Index related:
     static uint32_t getOptimalTriangleListSize(const RasterGeometry& input);
@@ -135,13 +185,15 @@ namespace dxvk {
     // Vertex related:
     static void processGeometryBuffers(const InterleavedGeometryDescriptor& desc, RaytraceGeometry& output);
     static void processGeometryBuffers(const RasterGeometry& input, RaytraceGeometry& output);
-    static size_t computeOptimalVertexStride(const RasterGeometry& input);
-    static void cacheVertexDataOnGPU(const Rc<RtxContext>& ctx, const RasterGeometry& input, RaytraceGeometry& output);
+    static CompactVertexLayout getCompactVertexLayout(const RasterGeometry& input);
+    static CompactVertexLayout getCompactVertexLayout(const RaytraceGeometry& geometry);
+    static size_t computeOptimalVertexStride(const RasterGeometry& input, const CompactVertexLayout& layout = CompactVertexLayout());
+    static void cacheVertexDataOnGPU(const Rc<RtxContext>& ctx, const RasterGeometry& input, const CompactVertexLayout& layout, RaytraceGeometry& output);
 
     /**
      * \brief Execute a compute shader to generate a triangle list from arbitrary topologies
      */
-    void dispatchGenTriList(const Rc<RtxContext>& ctx, const GenTriListArgs& args, const DxvkBufferSlice& dst, const RasterBuffer* srcBuffer) const;
+    void dispatchGenTriList(const Rc<RtxContext>& ctx, const GenTriListArgs& args, const DxvkBufferSlice& dst, const RasterBuffer* srcBuffer);
     
     /**
       * \brief Execute a compute shader to interleave vertex data into a single buffer
@@ -149,6 +201,35 @@ namespace dxvk {
     void interleaveGeometry(
       const Rc<RtxContext>& ctx,
       const RasterGeometry& input,
-      InterleavedGeometryDescriptor& output) const;
+      const CompactVertexLayout& layout,
+      InterleavedGeometryDescriptor& output);
+
+    /**
+      * \brief Executes the batched interleave and triangle list generation jobs
+      *
+      * With rtx.batchGeometryProcessing, GPU interleaving and triangle list generation are
+      * deferred and gathered into batches. Must be called before the cached geometry is
+      * consumed, i.e. at the end of draw call processing and ahead of skinning.
+      */
+    void flushGeometryBatches(const Rc<RtxContext>& ctx);
+
+  private:
+    struct BatchArena {
+      DxvkBufferSlice input;
+      DxvkBufferSlice output;
+      DxvkBufferSlice jobs;
+    };
+
+    bool batchInterleaveGeometry(const RasterGeometry& input, InterleaveGeometryArgs args, const Rc<DxvkBuffer>& output, uint32_t outputSize);
+    bool batchGenTriList(GenTriListArgs args, const DxvkBufferSlice& dst, const RasterBuffer* srcBuffer);
+
+    template<typename Job>
+    BatchArena beginBatch(const Rc<RtxContext>& ctx, const GeometryBatch<Job>& batch);
+
+    template<typename Job>
+    void endBatch(const Rc<RtxContext>& ctx, GeometryBatch<Job>& batch, const BatchArena& arena);
+
+    template<typename BatchArgs>
+    void dispatchBatch(const Rc<RtxContext>& ctx, BatchArgs args);
   };
 }
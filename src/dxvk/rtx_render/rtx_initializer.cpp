@@ -24,6 +24,7 @@
 #include "rtx_initializer.h"
 #include "rtx_options.h"
 #include "../../util/thread.h"
+#include "../../util/util_thread_placement.h"
 #include "dxvk_context.h"
 #include "dxvk_device.h"
 #include "dxvk_shader_manager.h"
@@ -72,6 +73,7 @@ namespace dxvk {
       // Async asset loading (USD)
       dxvk::thread([this] {
         env::setThreadName("rtx-initialize-assets");
+        ThreadPlacementService::get().applyToCurrentThread(ThreadRole::AssetLoader);
         loadAssets();
       });
     } else {
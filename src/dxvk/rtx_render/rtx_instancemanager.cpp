@@ -30,6 +30,7 @@
 #include "rtx_options.h"
 #include "rtx_materials.h"
 #include "rtx_opacity_micromap_manager.h"
+#include "rtx_ray_visibility.h"
 
 #include "../d3d9/d3d9_state.h"
 #include "rtx_matrix_helpers.h"
@@ -48,6 +49,33 @@ namespace dxvk {
     return dot(cross(x, y), z) < 0;
   }
 
+  static RayVisibilityPolicy getRayVisibilityPolicy() {
+    const auto& options = RtxOptions::Get()->rayVisibility;
+    RayVisibilityPolicy policy;
+
+    if (options.excludeParticlesFromShadowRays())
+      policy.shadowExcluded |= uint32_t(RayVisibilityCategory::Particle);
+    if (options.excludeParticlesFromIndirectRays())
+      policy.indirectExcluded |= uint32_t(RayVisibilityCategory::Particle);
+    if (options.excludeDecalsFromShadowRays())
+      policy.shadowExcluded |= uint32_t(RayVisibilityCategory::Decal);
+    if (options.excludeDecalsFromIndirectRays())
+      policy.indirectExcluded |= uint32_t(RayVisibilityCategory::Decal);
+    if (options.excludeAlphaTestedFromShadowRays())
+      policy.shadowExcluded |= uint32_t(RayVisibilityCategory::AlphaTested);
+    if (options.excludeAlphaTestedFromIndirectRays())
+      policy.indirectExcluded |= uint32_t(RayVisibilityCategory::AlphaTested);
+
+    if (options.smallInstanceRadius() > 0.f) {
+      if (options.excludeSmallInstancesFromShadowRays())
+        policy.shadowExcluded |= uint32_t(RayVisibilityCategory::Small);
+      if (options.excludeSmallInstancesFromIndirectRays())
+        policy.indirectExcluded |= uint32_t(RayVisibilityCategory::Small);
+    }
+
+    return policy;
+  }
+
   static uint32_t determineInstanceFlags(const DrawCallState& drawCall, const Matrix4& worldToProjection, const RtSurface& surface) {
     // Determine if the view inverts face winding globally
     const bool worldToProjectionMirrored = isMirrorTransform(worldToProjection);
@@ -128,6 +156,7 @@ namespace dxvk {
        m_frameLastUpdated
        m_frameCreated
        m_isCreatedByRenderer
+       m_expandedInstanceKey
        buildGeometry
        buildRange
      */
@@ -312,6 +341,9 @@ namespace dxvk {
     m_currentDecalIndex = c_firstDecalIndex;
     resetSurfaceIndices();
     m_billboards.clear();
+    m_textureAlphaOpaqueCount = 0;
+    m_textureAlphaTransparentCount = 0;
+    m_expandedDrawCounts.clear();
   }
 
   RtInstance* InstanceManager::processSceneObject(
@@ -328,11 +360,24 @@ namespace dxvk {
     }
 
     // Search for an existing instance matching our input
-    RtInstance* currentInstance = findSimilarInstance(blas, drawCall, material, objectToWorld, cameraManager, rayPortalManager);
+    RtInstance* currentInstance;
+    XXH64_hash_t expandedInstanceKey = kEmptyHash;
+
+    if (drawCall.getInstanceIndex() != DrawCallState::kNotInstanced) {
+      expandedInstanceKey = getExpandedInstanceKey(drawCall, material, objectToWorld);
+      currentInstance = findExpandedInstance(expandedInstanceKey, objectToWorld);
+    } else {
+      currentInstance = findSimilarInstance(blas, drawCall, material, objectToWorld, cameraManager, rayPortalManager);
+    }
 
     if (currentInstance == nullptr) {
       // No existing match - so need to create one
       currentInstance = addInstance(blas, drawCall, material, objectToWorld);
+
+      if (expandedInstanceKey != kEmptyHash) {
+        currentInstance->m_expandedInstanceKey = expandedInstanceKey;
+        m_expandedInstances[expandedInstanceKey] = currentInstance;
+      }
     }
 
     updateInstance(*currentInstance, cameraManager, blas, drawCall, materialData, material, objectToWorld, worldToProjection);
@@ -340,9 +385,11 @@ namespace dxvk {
     return currentInstance;
   }
 
-  RtSurface::AlphaState InstanceManager::calculateAlphaState(const DrawCallState& drawCall, const MaterialData& materialData, const RtSurfaceMaterial& material) {
+  RtSurface::AlphaState InstanceManager::calculateAlphaState(const DrawCallState& drawCall, const MaterialData& materialData, const RtSurfaceMaterial& material, AlphaCoverage& textureAlphaCoverage) {
     RtSurface::AlphaState out{};
 
+    textureAlphaCoverage = AlphaCoverage::Mixed;
+
     // Handle Alpha State for non-Opaque materials
 
     if (material.getType() == RtSurfaceMaterialType::Translucent) {
@@ -532,6 +579,35 @@ namespace dxvk {
     out.isFullyOpaque = !blendEnabled && !alphaTestEnabled;
     out.isBlendingDisabled = !blendEnabled;
 
+    // Promote alpha tested or blended surfaces whose texture alpha makes the test and blending irrelevant.
+    // Note: Only the legacy material samples the draw call's texture as its opacity, and particles, decals
+    // and blended terrain rely on their alpha state for more than opacity, so they are left alone.
+    const LegacyMaterialDefaults& legacyMaterial = RtxOptions::Get()->legacyMaterial;
+
+    if (!out.isFullyOpaque && RtxOptions::Get()->enableTextureAlphaPromotion() &&
+        materialData.getType() == MaterialDataType::Legacy &&
+        legacyMaterial.useAlbedoTextureIfPresent() && !legacyMaterial.alphaIsThinFilmThickness() &&
+        !RtxOptions::Get()->getWhiteMaterialModeEnabled() &&
+        !out.isParticle && !out.isDecal && !out.isBlendedTerrain) {
+      const DxvkImageView* colorImageView = drawMaterialData.getColorTexture().getImageView();
+
+      if (colorImageView != nullptr) {
+        const TextureAlphaRange alphaRange = applyTextureStageAlpha(
+          colorImageView->image()->getAlphaRange(),
+          drawMaterialData.textureAlphaOperation,
+          drawMaterialData.textureAlphaArg1Source,
+          drawMaterialData.textureAlphaArg2Source,
+          uint8_t(drawMaterialData.tFactor >> 24));
+
+        textureAlphaCoverage = classifyAlphaCoverage(alphaRange, out.alphaTestType, out.alphaTestReferenceValue, blendEnabled, out.blendType, out.invertedBlend);
+
+        if (textureAlphaCoverage == AlphaCoverage::Opaque) {
+          out = RtSurface::AlphaState{};
+          out.isFullyOpaque = true;
+        }
+      }
+    }
+
     return out;
   }
 
@@ -655,6 +731,58 @@ namespace dxvk {
     return foundResult.instance; 
   }
 
+  XXH64_hash_t InstanceManager::getExpandedInstanceKey(const DrawCallState& drawCall, const RtSurfaceMaterial& material, const Matrix4& transform) {
+    const XXH64_hash_t materialHash = material.getHash();
+    const XXH64_hash_t drawHash = XXH64(&materialHash, sizeof(materialHash), drawCall.getHash(RtxOptions::Get()->GeometryHashGenerationRule));
+
+    // Note: The instances of a draw are processed in order, so the first instance starts the next draw of this geometry and material
+    uint32_t& drawCount = m_expandedDrawCounts[drawHash];
+
+    if (drawCall.getInstanceIndex() == 0 || drawCount == 0) {
+      // A repeated draw with identical transforms (e.g. two-pass rendering) maps onto the instances of the previous draw
+      bool isRepeatedDraw = false;
+
+      if (drawCount > 0) {
+        const uint32_t firstInstanceKey[] = { drawCount - 1, 0 };
+        auto iter = m_expandedInstances.find(XXH64(firstInstanceKey, sizeof(firstInstanceKey), drawHash));
+
+        if (iter != m_expandedInstances.end() && iter->second->m_frameLastUpdated == m_device->getCurrentFrameId()) {
+          const Matrix4 firstInstanceTransform = iter->second->getTransform();
+          isRepeatedDraw = memcmp(&transform, &firstInstanceTransform, sizeof(transform)) == 0;
+        }
+      }
+
+      if (!isRepeatedDraw)
+        drawCount++;
+    }
+
+    const uint32_t instanceKey[] = { drawCount - 1, drawCall.getInstanceIndex() };
+    return XXH64(instanceKey, sizeof(instanceKey), drawHash);
+  }
+
+  RtInstance* InstanceManager::findExpandedInstance(XXH64_hash_t key, const Matrix4& transform) const {
+    // Disable temporal correlation between instances, see findSimilarInstance()
+    if (RtxOptions::Get()->getDeveloperOptionsEnabled())
+      return nullptr;
+
+    auto iter = m_expandedInstances.find(key);
+
+    if (iter == m_expandedInstances.end())
+      return nullptr;
+
+    RtInstance* instance = iter->second;
+
+    // An instance touched this frame is only shared by a second draw call with the same transform
+    if (instance->m_frameLastUpdated == m_device->getCurrentFrameId()) {
+      const Matrix4 instanceTransform = instance->getTransform();
+
+      if (memcmp(&transform, &instanceTransform, sizeof(transform)) != 0)
+        return nullptr;
+    }
+
+    return instance;
+  }
+
   RtInstance* InstanceManager::addInstance(BlasEntry& blas, 
                                            const DrawCallState& drawCall,
                                            const RtSurfaceMaterial& material, 
@@ -709,12 +837,14 @@ namespace dxvk {
     currentInstance.surface.normalBufferIndex = blas.modifiedGeometryData.normalBufferIndex;
     currentInstance.surface.normalOffset = blas.modifiedGeometryData.normalBuffer.offsetFromSlice();
     currentInstance.surface.normalStride = blas.modifiedGeometryData.normalBuffer.stride();
+    currentInstance.surface.hasCompactNormals = blas.modifiedGeometryData.normalBuffer.defined() && blas.modifiedGeometryData.normalBuffer.vertexFormat() == RtxGeometryUtils::kCompactNormalFormat;
     currentInstance.surface.color0BufferIndex = blas.modifiedGeometryData.color0BufferIndex;
     currentInstance.surface.color0Offset = blas.modifiedGeometryData.color0Buffer.offsetFromSlice();
     currentInstance.surface.color0Stride = blas.modifiedGeometryData.color0Buffer.stride();
     currentInstance.surface.texcoordBufferIndex = blas.modifiedGeometryData.texcoordBufferIndex;
     currentInstance.surface.texcoordOffset = blas.modifiedGeometryData.texcoordBuffer.offsetFromSlice();
     currentInstance.surface.texcoordStride = blas.modifiedGeometryData.texcoordBuffer.stride();
+    currentInstance.surface.hasCompactTexcoords = blas.modifiedGeometryData.texcoordBuffer.defined() && blas.modifiedGeometryData.texcoordBuffer.vertexFormat() == RtxGeometryUtils::kCompactTexcoordFormat;
     currentInstance.surface.previousPositionBufferIndex = blas.modifiedGeometryData.previousPositionBufferIndex;
     currentInstance.surface.indexBufferIndex = blas.modifiedGeometryData.indexBufferIndex;
     currentInstance.surface.indexStride = blas.modifiedGeometryData.indexBuffer.stride();
@@ -779,7 +909,19 @@ namespace dxvk {
        // Don't overwrite transform from when the instance was seen with the main camera
        !currentInstance.isCameraRegistered(CameraType::Main));
 
-    const RtSurface::AlphaState alphaState = calculateAlphaState(drawCall, materialData, material);
+    AlphaCoverage textureAlphaCoverage;
+    const RtSurface::AlphaState alphaState = calculateAlphaState(drawCall, materialData, material, textureAlphaCoverage);
+
+    // Surfaces whose texture alpha discards everything are not traced at all. A later draw of the
+    // same instance in this frame recomputes the hidden state and is not hidden by this one.
+    if (isFirstUpdateThisFrame) {
+      if (textureAlphaCoverage == AlphaCoverage::Opaque) {
+        m_textureAlphaOpaqueCount++;
+      } else if (textureAlphaCoverage == AlphaCoverage::Transparent) {
+        m_textureAlphaTransparentCount++;
+        currentInstance.m_isHidden = true;
+      }
+    }
 
     if (!isFirstUpdateThisFrame)
       // This is probably the same instance, being drawn twice!  Merge it
@@ -962,6 +1104,12 @@ namespace dxvk {
       }
     }
 
+    // The BLAS build budget ranks static BLAS builds by the size of their instances on screen
+    if (RtxOptions::Get()->blasBuildBudget.enable() && !blas.staticBlas.ptr() &&
+        blas.modifiedGeometryData.calculatePrimitiveCount() > RtxOptions::Get()->getMinPrimsInStaticBLAS()) {
+      getObjectRadius(currentInstance, drawCall.getGeometryData());
+    }
+
     // Update mask
     {
       uint mask = isFirstUpdateThisFrame ? 0 : currentInstance.m_vkInstance.mask;
@@ -986,7 +1134,21 @@ namespace dxvk {
             // Portal
             mask |= OBJECT_MASK_PORTAL;
           } else {
-            mask |= OBJECT_MASK_OPAQUE;
+            const RayVisibilityPolicy rayVisibilityPolicy = getRayVisibilityPolicy();
+
+            if (rayVisibilityPolicy.isEmpty()) {
+              mask |= OBJECT_MASK_OPAQUE;
+            } else {
+              const bool isSmallCandidate = (rayVisibilityPolicy.shadowExcluded | rayVisibilityPolicy.indirectExcluded) & uint32_t(RayVisibilityCategory::Small);
+              const float scale = std::max({ length(transform[0].xyz()), length(transform[1].xyz()), length(transform[2].xyz()) });
+              const float radius = isSmallCandidate ? getObjectRadius(currentInstance, drawCall.getGeometryData()) * scale : -1.f;
+
+              const uint32_t categories = getRayVisibilityCategories(
+                alphaState.isParticle, alphaState.isDecal, alphaState.alphaTestType != AlphaTestType::kAlways,
+                radius, RtxOptions::Get()->rayVisibility.smallInstanceRadius());
+
+              mask |= getOpaqueRayVisibilityMask(categories, rayVisibilityPolicy);
+            }
           }
         }
       }
@@ -1031,6 +1193,13 @@ namespace dxvk {
   }
 
   void InstanceManager::removeInstance(RtInstance* instance) {
+    if (instance->m_expandedInstanceKey != kEmptyHash) {
+      auto iter = m_expandedInstances.find(instance->m_expandedInstanceKey);
+
+      if (iter != m_expandedInstances.end() && iter->second == instance)
+        m_expandedInstances.erase(iter);
+    }
+
     // Some view model and player instances are created in the renderer and don't have onInstanceAdded called,
     // so not call onInstanceDestroyed either.
     if (instance->m_isCreatedByRenderer)
@@ -1600,6 +1769,31 @@ namespace dxvk {
       instance->m_surfaceIndex = BINDING_INDEX_INVALID;
   }
 
+  float InstanceManager::getObjectRadius(RtInstance& instance, const RasterGeometry& geometryData) {
+    // Only scan the vertices again when their positions changed
+    if (geometryData.hashes[HashComponents::VertexPosition] == instance.m_objectRadiusVertexDataVersion)
+      return instance.m_objectRadius;
+    instance.m_objectRadiusVertexDataVersion = geometryData.hashes[HashComponents::VertexPosition];
+    instance.m_objectRadius = -1.f;
+
+    const GeometryBufferData bufferData(geometryData);
+
+    if (!bufferData.positionData || geometryData.vertexCount == 0)
+      return instance.m_objectRadius;
+
+    Vector3 minPosition = bufferData.getPosition(0);
+    Vector3 maxPosition = minPosition;
+
+    for (uint32_t i = 1; i < geometryData.vertexCount; ++i) {
+      const Vector3 position = bufferData.getPosition(i);
+      minPosition = min(minPosition, position);
+      maxPosition = max(maxPosition, position);
+    }
+
+    instance.m_objectRadius = length(maxPosition - minPosition) * 0.5f;
+    return instance.m_objectRadius;
+  }
+
   // This function goes over all decals and offsets each one along its normal.
   // The offset is different per-decal and generally grows with every draw call and every decal in a draw call,
   // only wrapping around to 0 when some limit is reached.
@@ -30,6 +30,7 @@
 #include "../util/util_vector.h"
 #include "../util/util_matrix.h"
 #include "rtx_cameramanager.h"
+#include "rtx_texture_alpha.h"
 #include "dxvk_cmdlist.h"
 
 namespace dxvk 
@@ -115,6 +116,9 @@ public:
 
   VkGeometryFlagsKHR getGeometryFlags() const { return m_geometryFlags; }
 
+  // Object space bounding sphere radius of the geometry, negative when it has not been determined
+  float getObjectRadius() const { return m_objectRadius; }
+
   bool isViewModel() const;
   bool isViewModelNonReference() const;
   bool isViewModelReference() const;
@@ -157,6 +161,9 @@ private:
   uint32_t m_firstBillboard = 0;
   uint32_t m_billboardCount = 0;
   uint64_t m_lastDecalOffsetVertexDataVersion = 0;
+  XXH64_hash_t m_objectRadiusVertexDataVersion = kEmptyHash;
+  float m_objectRadius = -1.f; // Object space bounding sphere radius, negative when unknown
+  XXH64_hash_t m_expandedInstanceKey = kEmptyHash; // Key in the expanded instance map, for instances of expanded instanced draws
 
 public:
 
@@ -218,6 +225,10 @@ public:
 
   // Returns the active number of instances in scene
   const uint32_t getActiveCount() const { return m_instances.size(); }
+
+  // Returns the number of instances made opaque or hidden this frame based on the alpha of their texture
+  uint32_t getTextureAlphaOpaqueCount() const { return m_textureAlphaOpaqueCount; }
+  uint32_t getTextureAlphaTransparentCount() const { return m_textureAlphaTransparentCount; }
   
   void onFrameEnd();
 
@@ -290,12 +301,27 @@ private:
 
   std::vector<InstanceEventHandler> m_eventHandlers;
 
+  // Instances of expanded instanced draws, keyed by their draw and their index within it. All instances of such a draw
+  // share a BLAS, so they are mapped directly rather than searched for among the instances linked to it.
+  std::unordered_map<XXH64_hash_t, RtInstance*> m_expandedInstances;
+  // Number of expanded instanced draws of each geometry and material this frame, to tell apart draws sharing both
+  std::unordered_map<XXH64_hash_t, uint32_t> m_expandedDrawCounts;
+
+  uint32_t m_textureAlphaOpaqueCount = 0;
+  uint32_t m_textureAlphaTransparentCount = 0;
+
   // Handles the case of when two (or more) identical geometries+textures draw calls have been submitted in a single frame (typically used for two-pass rendering in FF)
   void mergeInstanceHeuristics(RtInstance& instanceToModify, const DrawCallState& drawCall, const RtSurfaceMaterial& material, const RtSurface::AlphaState& alphaState) const;
 
   // Finds the "closest" matching instance to a set of inputs, returns a pointer (can be null if not found) to closest instance
   RtInstance* findSimilarInstance(const BlasEntry& blas, const DrawCallState& drawCall, const RtSurfaceMaterial& material, const Matrix4& transform, const CameraManager& cameraManager, const RayPortalManager& rayPortalManager);
 
+  // Returns the key of an instance of an expanded instanced draw in m_expandedInstances
+  XXH64_hash_t getExpandedInstanceKey(const DrawCallState& drawCall, const RtSurfaceMaterial& material, const Matrix4& transform);
+
+  // Finds the instance of an expanded instanced draw from the previous frames, returns null if there is none
+  RtInstance* findExpandedInstance(XXH64_hash_t key, const Matrix4& transform) const;
+
   RtInstance* addInstance(BlasEntry& blas, const DrawCallState& drawCall, const RtSurfaceMaterial& material, const Matrix4& transform);
   void processInstanceBuffers(const BlasEntry& blas, RtInstance& currentInstance) const;
 
@@ -306,11 +332,14 @@ private:
 
   void removeInstance(RtInstance* instance);
 
-  static RtSurface::AlphaState calculateAlphaState(const DrawCallState& drawCall, const MaterialData& materialData, const RtSurfaceMaterial& material);
+  static RtSurface::AlphaState calculateAlphaState(const DrawCallState& drawCall, const MaterialData& materialData, const RtSurfaceMaterial& material, AlphaCoverage& textureAlphaCoverage);
 
   // Modifies an instance given active developer options. Returns true if the instance was modified
   bool applyDeveloperOptions(RtInstance& currentInstance, const DrawCallState& drawCall);
 
+  // Returns the object space bounding sphere radius of an instance's geometry, or a negative value if it cannot be read
+  static float getObjectRadius(RtInstance& instance, const RasterGeometry& geometryData);
+
   void applyDecalOffsets(RtInstance& instance, const RasterGeometry& geometryData);
 
   void createBillboards(RtInstance& instance, const Vector3& cameraViewDirection);
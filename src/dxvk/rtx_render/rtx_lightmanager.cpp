@@ -83,10 +83,11 @@ namespace dxvk {
 
   void LightManager::clear() {
     m_lights.clear();
+    m_replacementLightBindings.clear();
   }
 
   void LightManager::garbageCollection() {
-    const uint32_t currentFrame = m_device->getCurrentFrameId();
+    const uint32_t currentFrame = getCurrentFrameId();
     const uint32_t framesToKeep = RtxOptions::Get()->getNumFramesToKeepLights();
     const uint32_t framesToSleep = RtxOptions::Get()->getNumFramesToPutLightsToSleep();
 
@@ -124,7 +125,7 @@ namespace dxvk {
     for (auto it = m_lights.begin(); it != m_lights.end(); ) {
       RtLight& light = it->second;
       // Only looking for instances of dynamic lights that have been updated on the previous frame
-      if (light.getFrameLastTouched() + 1 != m_device->getCurrentFrameId()) {
+      if (light.getFrameLastTouched() + 1 != getCurrentFrameId()) {
         ++it;
         continue;
       }
@@ -458,7 +459,7 @@ namespace dxvk {
     const auto& foundLightIt = m_lights.find(rtLight.getInstanceHash());
     if (foundLightIt != m_lights.end()) {
       // Ignore changes in the same frame
-      if (foundLightIt->second.getFrameLastTouched() != m_device->getCurrentFrameId()) {
+      if (foundLightIt->second.getFrameLastTouched() != getCurrentFrameId()) {
         if (rtLight.isChildOfMesh()) {
           // If light transform changed, update it.
           if (foundLightIt->second.getTransformedHash() != rtLight.getTransformedHash()) {
@@ -486,7 +487,7 @@ namespace dxvk {
         }
 
         // We saw this light so bump its frame counter.
-        foundLightIt->second.setFrameLastTouched(m_device->getCurrentFrameId());
+        foundLightIt->second.setFrameLastTouched(getCurrentFrameId());
       }
 
     } else {
@@ -518,10 +519,49 @@ namespace dxvk {
         updateLight(similarLight.value(), localLight);
 
       // Record we saw this light
-      localLight.setFrameLastTouched(m_device->getCurrentFrameId());
+      localLight.setFrameLastTouched(getCurrentFrameId());
     }
   }
 
+  void LightManager::addReplacementLight(uint64_t rootInstanceId, const RtLight& localLight, const Matrix4& objectToWorld) {
+    // Note: Transforms do not change the radiance, so lights which are "off" can be rejected before transforming them
+    const Vector3 originalRadiance = localLight.getRadiance();
+    if (originalRadiance.x < 0 || originalRadiance.y < 0 || originalRadiance.z < 0
+        || (originalRadiance.x <= 0 && originalRadiance.y <= 0 && originalRadiance.z <= 0))
+      return;
+
+    // Note: Matches RtLight::getInstanceHash once the root instance is set
+    const XXH64_hash_t lightHash = localLight.getInitialHash() + rootInstanceId;
+    const uint32_t currentFrame = getCurrentFrameId();
+    const auto action = m_replacementLightBindings.bind(rootInstanceId, lightHash, objectToWorld, currentFrame);
+
+    // A light already in the table whose root instance has not moved is up to date, so only needs touching
+    if (action == RtReplacementLightBindings<Matrix4>::Action::Keep) {
+      const auto& foundLightIt = m_lights.find(lightHash);
+      if (foundLightIt != m_lights.end()) {
+        foundLightIt->second.setFrameLastTouched(currentFrame);
+        return;
+      }
+    }
+
+    // New and moved lights go through light matching to keep the buffer index of the light they continue
+    RtLight light(localLight);
+    light.setRootInstanceId(rootInstanceId);
+    light.applyTransform(objectToWorld);
+    addLight(light);
+  }
+
+  void LightManager::retireReplacementLights(uint64_t rootInstanceId) {
+    // Note: The lights themselves age out like any other light, a light of a recreated
+    // instance may still take over their buffer index through light matching
+    m_replacementLightBindings.retire(rootInstanceId);
+  }
+
+  uint32_t LightManager::getCurrentFrameId() const {
+    // Note: Only unit tests create a light manager without a device, they step through frames themselves
+    return m_device.ptr() ? m_device->getCurrentFrameId() : m_detachedFrameId;
+  }
+
   void LightManager::setRaytraceArgs(RaytraceArgs& raytraceArgs, uint32_t rtxdiInitialLightSamples, uint32_t volumeRISInitialLightSamples, uint32_t risLightSamples) const
   {
     // The algorithm below performs two tasks:
@@ -30,6 +30,7 @@
 #include "rtx/concept/light/light_types.h"
 #include "rtx_lights.h"
 #include "rtx_cameramanager.h"
+#include "rtx_replacement_light_bindings.h"
 
 struct RaytraceArgs;
 
@@ -69,11 +70,20 @@ public:
 
   void addLight(const RtLight& light);
   void addLight(const RtLight& light, const DrawCallState& drawCallState);
+  // Adds a light of a replacement asset, only transforming and matching it when its root instance is new or moved
+  void addReplacementLight(uint64_t rootInstanceId, const RtLight& localLight, const Matrix4& objectToWorld);
+  void retireReplacementLights(uint64_t rootInstanceId);
+
+  // Sets the frame of a light manager created without a device
+  void setDetachedFrameId(uint32_t frameId) { m_detachedFrameId = frameId; }
 
   void setRaytraceArgs(RaytraceArgs& raytraceArgs, uint32_t rtxdiInitialLightSamples, uint32_t volumeRISInitialLightSamples, uint32_t risLightSamples) const;
 
 private:
   std::unordered_map<XXH64_hash_t, RtLight> m_lights;
+  // Note: Replacement lights live in the light table like any other light, the bindings only record which root
+  // instance owns them and where it was placed, so lights of instances which did not move skip light matching.
+  RtReplacementLightBindings<Matrix4> m_replacementLightBindings;
   // Note: A fallback light tracked seperately and handled specially to not be mixed up with
   // lights provided from the application.
   std::optional<RtLight> m_fallbackLight{};
@@ -81,6 +91,7 @@ private:
   Rc<DxvkBuffer> m_previousLightBuffer;
   Rc<DxvkBuffer> m_lightMappingBuffer;
   Rc<DxvkDevice> m_device;
+  uint32_t m_detachedFrameId = 0;
 
   uint32_t m_currentActiveLightCount = 0;
   std::array<LightRange, lightTypeCount> m_lightTypeRanges;
@@ -97,6 +108,8 @@ private:
   //  Returns 0~1 if similar, higher is more similar
   static float isSimilar(const RtLight& a, const RtLight& b, float distanceThreshold);
   static void updateLight(const RtLight& in, RtLight& out);
+
+  uint32_t getCurrentFrameId() const;
 };
 
 }  // namespace dxvk
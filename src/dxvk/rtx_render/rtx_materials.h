@@ -146,6 +146,8 @@ struct RtSurface {
     flags |= isAnimatedWater ?               (1 << 24) : 0;
     flags |= isClipPlaneEnabled ?            (1 << 25) : 0;
     flags |= isMatte ?                       (1 << 26) : 0;
+    flags |= hasCompactNormals ?             (1 << 27) : 0;
+    flags |= hasCompactTexcoords ?           (1 << 28) : 0;
 
     writeGPUHelper(data, offset, flags);
 
@@ -246,6 +248,9 @@ struct RtSurface {
   bool isStatic = false;
   bool isAnimatedWater = false;
   bool isClipPlaneEnabled = false;
+  // Note: Indicates the vertex attribute is stored with the compact encodings from vertex_packing.h
+  bool hasCompactNormals = false;
+  bool hasCompactTexcoords = false;
 
   RtTextureArgSource textureColorArg1Source = RtTextureArgSource::Texture;
   RtTextureArgSource textureColorArg2Source = RtTextureArgSource::None;
@@ -743,6 +748,14 @@ struct RtTranslucentSurfaceMaterial {
   XXH64_hash_t getHash() const {
     return m_cachedHash;
   }
+
+  uint32_t getNormalTextureIndex() const {
+    return m_normalTextureIndex;
+  }
+
+  uint32_t getTransmittanceTextureIndex() const {
+    return m_transmittanceTextureIndex;
+  }
 private:
   void updateCachedHash() {
     XXH64_hash_t h = 0;
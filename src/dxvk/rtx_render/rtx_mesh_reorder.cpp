@@ -0,0 +1,178 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_mesh_reorder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+#include "../../util/util_vector.h"
+
+namespace dxvk {
+  namespace {
+    // Bits per axis of the Morton codes, 3 * 10 bits fit in 32 bits
+    constexpr uint32_t kMortonBits = 10;
+
+    const Vector3& getPosition(const float* positions, size_t positionStride, uint32_t vertex) {
+      return *reinterpret_cast<const Vector3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * positionStride);
+    }
+
+    // Spreads the lower 10 bits of v so that there are two zero bits between each of them
+    uint32_t spreadBits(uint32_t v) {
+      v = (v | (v << 16)) & 0x030000FF;
+      v = (v | (v << 8)) & 0x0300F00F;
+      v = (v | (v << 4)) & 0x030C30C3;
+      v = (v | (v << 2)) & 0x09249249;
+      return v;
+    }
+
+    Vector3 getTriangleCenter(const float* positions, size_t positionStride, const uint32_t* triangle) {
+      return (getPosition(positions, positionStride, triangle[0]) +
+              getPosition(positions, positionStride, triangle[1]) +
+              getPosition(positions, positionStride, triangle[2])) / 3.f;
+    }
+  }
+
+  void reorderTrianglesSpatially(const float* positions, size_t positionStride, std::vector<uint32_t>& indices) {
+    const uint32_t triangleCount = uint32_t(indices.size() / 3);
+
+    if (triangleCount < 2) {
+      return;
+    }
+
+    std::vector<Vector3> centers(triangleCount);
+    Vector3 minCenter(FLT_MAX);
+    Vector3 maxCenter(-FLT_MAX);
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      centers[t] = getTriangleCenter(positions, positionStride, &indices[t * 3]);
+      minCenter = min(minCenter, centers[t]);
+      maxCenter = max(maxCenter, centers[t]);
+    }
+
+    // Quantize with the same scale on all axes so the curve does not stretch along thin meshes
+    const Vector3 extent = maxCenter - minCenter;
+    const float maxExtent = std::max({ extent.x, extent.y, extent.z });
+    const float scale = maxExtent > 0.f ? float((1u << kMortonBits) - 1) / maxExtent : 0.f;
+
+    std::vector<std::pair<uint32_t, uint32_t>> codes(triangleCount);
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      const Vector3 q = (centers[t] - minCenter) * scale;
+      const uint32_t x = std::min(uint32_t(q.x), (1u << kMortonBits) - 1);
+      const uint32_t y = std::min(uint32_t(q.y), (1u << kMortonBits) - 1);
+      const uint32_t z = std::min(uint32_t(q.z), (1u << kMortonBits) - 1);
+      codes[t] = { spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2), t };
+    }
+
+    // Ties are broken by the original order, which keeps the result deterministic
+    std::sort(codes.begin(), codes.end());
+
+    const std::vector<uint32_t> original = indices;
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      std::copy_n(&original[codes[t].second * 3], 3, &indices[t * 3]);
+    }
+  }
+
+  std::vector<uint32_t> reorderVerticesForFetch(std::vector<uint32_t>& indices, uint32_t vertexCount) {
+    constexpr uint32_t kUnassigned = UINT32_MAX;
+
+    std::vector<uint32_t> newVertex(vertexCount, kUnassigned);
+    std::vector<uint32_t> vertexOrder;
+    vertexOrder.reserve(vertexCount);
+
+    for (uint32_t& index : indices) {
+      if (newVertex[index] == kUnassigned) {
+        newVertex[index] = uint32_t(vertexOrder.size());
+        vertexOrder.push_back(index);
+      }
+
+      index = newVertex[index];
+    }
+
+    // Unreferenced vertices are kept so the vertex count and any other users of the data stay valid
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+      if (newVertex[vertex] == kUnassigned) {
+        vertexOrder.push_back(vertex);
+      }
+    }
+
+    return vertexOrder;
+  }
+
+  MeshLocalityMetrics measureMeshLocality(const float* positions, size_t positionStride, uint32_t vertexCount, const std::vector<uint32_t>& indices, uint32_t cacheSize) {
+    MeshLocalityMetrics metrics;
+
+    const uint32_t triangleCount = uint32_t(indices.size() / 3);
+
+    if (triangleCount == 0 || cacheSize == 0) {
+      return metrics;
+    }
+
+    // FIFO cache: a vertex is cached if it was fetched less than cacheSize fetches ago
+    std::vector<uint64_t> fetchTime(vertexCount, 0);
+    uint64_t fetchCount = 0;
+    uint64_t indexDeltaSum = 0;
+
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+      const uint32_t vertex = indices[i];
+
+      if (fetchTime[vertex] == 0 || fetchCount - fetchTime[vertex] >= cacheSize) {
+        fetchTime[vertex] = ++fetchCount;
+      }
+
+      if (i > 0) {
+        indexDeltaSum += uint64_t(std::abs(int64_t(vertex) - int64_t(indices[i - 1])));
+      }
+    }
+
+    Vector3 minPosition(FLT_MAX);
+    Vector3 maxPosition(-FLT_MAX);
+    double distanceSum = 0.0;
+    Vector3 previousCenter;
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      const Vector3 center = getTriangleCenter(positions, positionStride, &indices[t * 3]);
+
+      for (uint32_t k = 0; k < 3; k++) {
+        minPosition = min(minPosition, getPosition(positions, positionStride, indices[t * 3 + k]));
+        maxPosition = max(maxPosition, getPosition(positions, positionStride, indices[t * 3 + k]));
+      }
+
+      if (t > 0) {
+        distanceSum += length(center - previousCenter);
+      }
+
+      previousCenter = center;
+    }
+
+    const float diagonal = length(maxPosition - minPosition);
+
+    metrics.acmr = float(fetchCount) / triangleCount;
+    metrics.averageIndexDelta = float(double(indexDeltaSum) / std::max<size_t>(triangleCount * 3 - 1, 1));
+    metrics.averageTriangleDistance = triangleCount > 1 && diagonal > 0.f ? float(distanceSum / (triangleCount - 1)) / diagonal : 0.f;
+
+    return metrics;
+  }
+}
@@ -0,0 +1,50 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dxvk {
+  // Locality of a triangle list, see measureMeshLocality
+  struct MeshLocalityMetrics {
+    // Average number of vertices fetched per triangle through a FIFO vertex cache, between 0.5 and 3
+    float acmr = 0.f;
+    // Average distance in the vertex buffer between a vertex and the one referenced before it, in vertices
+    float averageIndexDelta = 0.f;
+    // Average distance between the centers of consecutive triangles, relative to the bounding box diagonal
+    float averageTriangleDistance = 0.f;
+  };
+
+  // Reorders the triangles of a triangle list along a Morton curve through their centers, so that
+  // triangles close in the list are close in space. The vertex order within triangles is kept.
+  // Positions are 3 floats at the given byte stride.
+  void reorderTrianglesSpatially(const float* positions, size_t positionStride, std::vector<uint32_t>& indices);
+
+  // Renumbers vertices in the order the triangle list first references them and rewrites the indices
+  // accordingly. Returns the original vertex of each new vertex, unreferenced vertices are moved to the end.
+  std::vector<uint32_t> reorderVerticesForFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+  // Measures how well a triangle list is ordered for vertex fetches and ray traversal
+  MeshLocalityMetrics measureMeshLocality(const float* positions, size_t positionStride, uint32_t vertexCount, const std::vector<uint32_t>& indices, uint32_t cacheSize = 32);
+}
@@ -0,0 +1,754 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_mesh_simplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+
+namespace fs = std::filesystem;
+
+namespace dxvk {
+  namespace {
+    constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    // Minimum cosine between the vertex normals of a removed vertex and the one it collapses into,
+    // keeps creases which are smooth shaded rather than split into separate vertices.
+    constexpr float kMinCollapseNormalDot = 0.7f;
+    // Minimum cosine between the normals of a triangle before and after a collapse
+    constexpr float kMinTriangleNormalDot = 0.25f;
+
+    // A level has to remove at least this fraction of the requested triangles to be kept
+    constexpr float kMinLevelReductionFraction = 0.5f;
+
+    constexpr char kMeshLodCacheMagic[4] = { 'R', 'T', 'M', 'L' };
+    constexpr uint32_t kMeshLodCacheVersion = 1;
+    constexpr char kMeshLodCacheExtension[] = ".lod";
+
+    struct MeshLodCacheFileHeader {
+      char magic[4];
+      uint32_t version;
+      XXH64_hash_t key;
+      uint32_t levelCount;
+      uint32_t reserved;
+      uint64_t dataSize;
+      XXH64_hash_t dataChecksum;
+    };
+
+    std::string getMeshLodCachePath(const std::string& directory, XXH64_hash_t key) {
+      char name[32];
+      std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+      return (fs::path(directory) / (std::string(name) + kMeshLodCacheExtension)).string();
+    }
+
+    float getUvArea(const Vector2& a, const Vector2& b, const Vector2& c) {
+      return (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+    }
+  }
+
+  void MeshSimplifier::Quadric::addPlane(const Vector3& n, float d) {
+    a00 += n.x * n.x; a01 += n.x * n.y; a02 += n.x * n.z; a03 += n.x * d;
+    a11 += n.y * n.y; a12 += n.y * n.z; a13 += n.y * d;
+    a22 += n.z * n.z; a23 += n.z * d;
+    a33 += double(d) * d;
+  }
+
+  void MeshSimplifier::Quadric::add(const Quadric& o) {
+    a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+    a11 += o.a11; a12 += o.a12; a13 += o.a13;
+    a22 += o.a22; a23 += o.a23;
+    a33 += o.a33;
+  }
+
+  double MeshSimplifier::Quadric::evaluate(const Vector3& p) const {
+    const double x = p.x, y = p.y, z = p.z;
+    // Sum of squared distances to all planes, clamped as rounding may take it slightly negative
+    const double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+                   + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+                   + a22 * z * z + 2 * a23 * z
+                   + a33;
+    return std::max(e, 0.0);
+  }
+
+  MeshSimplifier::MeshSimplifier(const MeshSimplifierInput& input, const std::vector<uint32_t>& indices)
+    : m_input(input)
+    , m_indices(indices) {
+    const uint32_t triangleCount = uint32_t(m_indices.size() / 3);
+    m_indices.resize(triangleCount * 3);
+
+    // Weld vertices by position so that the topology is seen through attribute seams
+    std::vector<uint32_t> order(m_input.vertexCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+      const Vector3& pa = getPosition(a);
+      const Vector3& pb = getPosition(b);
+      return std::tie(pa.x, pa.y, pa.z, a) < std::tie(pb.x, pb.y, pb.z, b);
+    });
+
+    m_vertexPosition.resize(m_input.vertexCount);
+
+    for (uint32_t i = 0; i < order.size(); i++) {
+      const uint32_t vertex = order[i];
+
+      if (i == 0 || getPosition(order[i - 1]) != getPosition(vertex)) {
+        m_positionVertex.push_back(vertex);
+        m_positionLocked.push_back(false);
+      } else {
+        // Lock positions shared by vertices with different attributes so seams stay in place
+        const uint32_t first = m_positionVertex.back();
+        const Vector3* normal = getNormal(vertex);
+        const Vector2* texcoord = getTexcoord(vertex);
+
+        if ((normal && *normal != *getNormal(first)) || (texcoord && *texcoord != *getTexcoord(first))) {
+          m_positionLocked.back() = true;
+        }
+      }
+
+      m_vertexPosition[vertex] = uint32_t(m_positionVertex.size() - 1);
+    }
+
+    const uint32_t positionCount = uint32_t(m_positionVertex.size());
+
+    m_positionTriangles.resize(positionCount);
+    m_quadrics.resize(positionCount);
+    m_positionAlive.assign(positionCount, true);
+    m_positionCollapses.resize(positionCount);
+    m_triangleAlive.assign(triangleCount, false);
+
+    std::vector<uint64_t> edges;
+    edges.reserve(triangleCount * 3);
+
+    for (uint32_t t = 0; t < triangleCount; t++) {
+      const uint32_t p[3] = {
+        m_vertexPosition[m_indices[t * 3 + 0]],
+        m_vertexPosition[m_indices[t * 3 + 1]],
+        m_vertexPosition[m_indices[t * 3 + 2]]
+      };
+
+      // Triangles which are already degenerate in position are dropped
+      if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0]) {
+        continue;
+      }
+
+      m_triangleAlive[t] = true;
+      m_triangleCount++;
+
+      const Vector3& a = getPosition(m_indices[t * 3 + 0]);
+      const Vector3 normal = cross(getPosition(m_indices[t * 3 + 1]) - a, getPosition(m_indices[t * 3 + 2]) - a);
+      const float area = length(normal);
+
+      for (uint32_t k = 0; k < 3; k++) {
+        m_positionTriangles[p[k]].push_back(t);
+
+        if (area > 0.f) {
+          const Vector3 planeNormal = normal / area;
+          m_quadrics[p[k]].addPlane(planeNormal, -dot(planeNormal, a));
+        }
+
+        const uint32_t e0 = std::min(p[k], p[(k + 1) % 3]);
+        const uint32_t e1 = std::max(p[k], p[(k + 1) % 3]);
+        edges.push_back((uint64_t(e0) << 32) | e1);
+      }
+    }
+
+    // Lock border and non-manifold edges, found as edges not used by exactly two triangles
+    std::sort(edges.begin(), edges.end());
+
+    for (size_t i = 0; i < edges.size();) {
+      size_t end = i + 1;
+
+      while (end < edges.size() && edges[end] == edges[i]) {
+        end++;
+      }
+
+      if (end - i != 2) {
+        m_positionLocked[uint32_t(edges[i] >> 32)] = true;
+        m_positionLocked[uint32_t(edges[i])] = true;
+      }
+
+      i = end;
+    }
+
+    for (uint32_t p = 0; p < positionCount; p++) {
+      updateCollapse(p);
+    }
+  }
+
+  const Vector3& MeshSimplifier::getPosition(uint32_t vertex) const {
+    return *reinterpret_cast<const Vector3*>(reinterpret_cast<const uint8_t*>(m_input.positions) + vertex * m_input.positionStride);
+  }
+
+  const Vector3* MeshSimplifier::getNormal(uint32_t vertex) const {
+    if (m_input.normals == nullptr) {
+      return nullptr;
+    }
+
+    return reinterpret_cast<const Vector3*>(reinterpret_cast<const uint8_t*>(m_input.normals) + vertex * m_input.normalStride);
+  }
+
+  const Vector2* MeshSimplifier::getTexcoord(uint32_t vertex) const {
+    if (m_input.texcoords == nullptr) {
+      return nullptr;
+    }
+
+    return reinterpret_cast<const Vector2*>(reinterpret_cast<const uint8_t*>(m_input.texcoords) + vertex * m_input.texcoordStride);
+  }
+
+  double MeshSimplifier::getCollapseCost(uint32_t from, uint32_t to) const {
+    Quadric quadric = m_quadrics[from];
+    quadric.add(m_quadrics[to]);
+    return quadric.evaluate(getPosition(m_positionVertex[to]));
+  }
+
+  void MeshSimplifier::getNeighbors(uint32_t position, std::vector<uint32_t>& neighbors) const {
+    neighbors.clear();
+
+    for (uint32_t t : m_positionTriangles[position]) {
+      if (!m_triangleAlive[t]) {
+        continue;
+      }
+
+      for (uint32_t k = 0; k < 3; k++) {
+        const uint32_t neighbor = m_vertexPosition[m_indices[t * 3 + k]];
+
+        if (neighbor != position) {
+          neighbors.push_back(neighbor);
+        }
+      }
+    }
+
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+  }
+
+  void MeshSimplifier::queueCollapse(uint32_t position, double cost, uint32_t to) {
+    // Replaces any collapse of the vertex queued before
+    Collapse& collapse = m_positionCollapses[position];
+    collapse = { cost, position, to, collapse.version + 1 };
+
+    if (to != kInvalidIndex) {
+      m_queue.push_back(collapse);
+      std::push_heap(m_queue.begin(), m_queue.end());
+    }
+  }
+
+  void MeshSimplifier::updateCollapse(uint32_t position) {
+    double bestCost = DBL_MAX;
+    uint32_t bestTo = kInvalidIndex;
+
+    if (!m_positionLocked[position] && m_positionAlive[position]) {
+      std::vector<uint32_t>& neighbors = m_neighbors;
+      getNeighbors(position, neighbors);
+
+      for (uint32_t neighbor : neighbors) {
+        const double cost = getCollapseCost(position, neighbor);
+
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestTo = neighbor;
+        }
+      }
+    }
+
+    queueCollapse(position, bestCost, bestTo);
+  }
+
+  bool MeshSimplifier::findValidCollapse(uint32_t from, Collapse& collapse, uint32_t& toVertex) const {
+    std::vector<uint32_t>& neighbors = m_neighbors;
+    getNeighbors(from, neighbors);
+
+    std::vector<std::pair<double, uint32_t>>& candidates = m_candidates;
+    candidates.clear();
+
+    for (uint32_t neighbor : neighbors) {
+      candidates.emplace_back(getCollapseCost(from, neighbor), neighbor);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto& [cost, to] : candidates) {
+      if (isCollapseValid(from, to, toVertex)) {
+        collapse.cost = cost;
+        collapse.to = to;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool MeshSimplifier::isCollapseValid(uint32_t from, uint32_t to, uint32_t& toVertex) const {
+    toVertex = kInvalidIndex;
+
+    std::vector<uint32_t>& fromNeighbors = m_fromNeighbors;
+    std::vector<uint32_t>& toNeighbors = m_toNeighbors;
+    fromNeighbors.clear();
+    toNeighbors.clear();
+    uint32_t sharedTriangleCount = 0;
+
+    for (uint32_t t : m_positionTriangles[from]) {
+      if (!m_triangleAlive[t]) {
+        continue;
+      }
+
+      bool hasTo = false;
+
+      for (uint32_t k = 0; k < 3; k++) {
+        const uint32_t vertex = m_indices[t * 3 + k];
+        const uint32_t position = m_vertexPosition[vertex];
+
+        if (position == to) {
+          // The removed vertex lies on one side of any seam through the target, so all
+          // triangles on the collapsed edge have to agree on the target's attributes
+          if (toVertex != kInvalidIndex && toVertex != vertex) {
+            return false;
+          }
+
+          toVertex = vertex;
+          hasTo = true;
+        }
+
+        if (position != from) {
+          fromNeighbors.push_back(position);
+        }
+      }
+
+      sharedTriangleCount += hasTo ? 1 : 0;
+    }
+
+    // The edge may be gone after earlier collapses
+    if (sharedTriangleCount == 0) {
+      return false;
+    }
+
+    for (uint32_t t : m_positionTriangles[to]) {
+      if (!m_triangleAlive[t]) {
+        continue;
+      }
+
+      for (uint32_t k = 0; k < 3; k++) {
+        const uint32_t position = m_vertexPosition[m_indices[t * 3 + k]];
+
+        if (position != to) {
+          toNeighbors.push_back(position);
+        }
+      }
+    }
+
+    // Link condition: the only neighbors both vertices share are the ones opposite to the collapsed
+    // edge, anything else would fold the surface into non-manifold geometry.
+    std::sort(fromNeighbors.begin(), fromNeighbors.end());
+    fromNeighbors.erase(std::unique(fromNeighbors.begin(), fromNeighbors.end()), fromNeighbors.end());
+    std::sort(toNeighbors.begin(), toNeighbors.end());
+    toNeighbors.erase(std::unique(toNeighbors.begin(), toNeighbors.end()), toNeighbors.end());
+
+    uint32_t sharedNeighborCount = 0;
+
+    for (auto f = fromNeighbors.begin(), t = toNeighbors.begin(); f != fromNeighbors.end() && t != toNeighbors.end();) {
+      if (*f < *t) {
+        ++f;
+      } else if (*t < *f) {
+        ++t;
+      } else {
+        sharedNeighborCount++;
+        ++f;
+        ++t;
+      }
+    }
+
+    if (sharedNeighborCount != sharedTriangleCount) {
+      return false;
+    }
+
+    const uint32_t fromVertex = m_positionVertex[from];
+    const Vector3* fromNormal = getNormal(fromVertex);
+
+    if (fromNormal && dot(*fromNormal, *getNormal(toVertex)) < kMinCollapseNormalDot * length(*fromNormal) * length(*getNormal(toVertex))) {
+      return false;
+    }
+
+    const Vector3& target = getPosition(toVertex);
+    const Vector2* targetTexcoord = getTexcoord(toVertex);
+
+    // Reject collapses which would flip or degenerate the remaining triangles of the removed vertex
+    for (uint32_t t : m_positionTriangles[from]) {
+      if (!m_triangleAlive[t]) {
+        continue;
+      }
+
+      Vector3 oldPositions[3];
+      Vector3 newPositions[3];
+      Vector2 oldTexcoords[3];
+      Vector2 newTexcoords[3];
+      bool hasTo = false;
+
+      for (uint32_t k = 0; k < 3; k++) {
+        const uint32_t vertex = m_indices[t * 3 + k];
+        const uint32_t position = m_vertexPosition[vertex];
+        const bool isFrom = position == from;
+
+        hasTo |= position == to;
+        oldPositions[k] = getPosition(vertex);
+        newPositions[k] = isFrom ? target : oldPositions[k];
+
+        if (targetTexcoord) {
+          oldTexcoords[k] = *getTexcoord(vertex);
+          newTexcoords[k] = isFrom ? *targetTexcoord : oldTexcoords[k];
+        }
+      }
+
+      if (hasTo) {
+        continue;
+      }
+
+      const Vector3 oldNormal = cross(oldPositions[1] - oldPositions[0], oldPositions[2] - oldPositions[0]);
+      const Vector3 newNormal = cross(newPositions[1] - newPositions[0], newPositions[2] - newPositions[0]);
+      const float newArea = length(newNormal);
+
+      if (newArea == 0.f || dot(oldNormal, newNormal) < kMinTriangleNormalDot * length(oldNormal) * newArea) {
+        return false;
+      }
+
+      if (targetTexcoord) {
+        const float oldUvArea = getUvArea(oldTexcoords[0], oldTexcoords[1], oldTexcoords[2]);
+        const float newUvArea = getUvArea(newTexcoords[0], newTexcoords[1], newTexcoords[2]);
+
+        if (oldUvArea * newUvArea < 0.f) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  void MeshSimplifier::collapse(uint32_t from, uint32_t to, uint32_t toVertex) {
+    for (uint32_t t : m_positionTriangles[from]) {
+      if (!m_triangleAlive[t]) {
+        continue;
+      }
+
+      const uint32_t base = t * 3;
+      const bool hasTo =
+        m_vertexPosition[m_indices[base + 0]] == to ||
+        m_vertexPosition[m_indices[base + 1]] == to ||
+        m_vertexPosition[m_indices[base + 2]] == to;
+
+      if (hasTo) {
+        m_triangleAlive[t] = false;
+        m_triangleCount--;
+        continue;
+      }
+
+      for (uint32_t k = 0; k < 3; k++) {
+        if (m_vertexPosition[m_indices[base + k]] == from) {
+          m_indices[base + k] = toVertex;
+        }
+      }
+
+      m_positionTriangles[to].push_back(t);
+    }
+
+    m_quadrics[to].add(m_quadrics[from]);
+    m_positionAlive[from] = false;
+    queueCollapse(from, DBL_MAX, kInvalidIndex);
+    m_positionTriangles[from].clear();
+
+    auto& toTriangles = m_positionTriangles[to];
+    toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [this](uint32_t t) { return !m_triangleAlive[t]; }), toTriangles.end());
+
+    // The target's quadric changed and it gained new neighbors, which affects the collapses of
+    // the target and of every vertex next to it
+    std::vector<uint32_t>& neighbors = m_collapseNeighbors;
+    getNeighbors(to, neighbors);
+
+    updateCollapse(to);
+
+    for (uint32_t neighbor : neighbors) {
+      if (m_positionLocked[neighbor]) {
+        continue;
+      }
+
+      // Only the cost of collapsing into the target changed, unless the queued collapse of the
+      // neighbor involves one of the two merged vertices or it had no valid collapse left
+      const Collapse& queued = m_positionCollapses[neighbor];
+
+      if (queued.to == to || queued.to == from || queued.to == kInvalidIndex) {
+        updateCollapse(neighbor);
+      } else {
+        const double cost = getCollapseCost(neighbor, to);
+
+        if (cost < queued.cost) {
+          queueCollapse(neighbor, cost, to);
+        }
+      }
+    }
+  }
+
+  void MeshSimplifier::simplify(uint32_t targetIndexCount, float maxError) {
+    const double maxCost = double(maxError) * maxError;
+
+    while (getIndexCount() > targetIndexCount && !m_queue.empty()) {
+      std::pop_heap(m_queue.begin(), m_queue.end());
+      const Collapse candidate = m_queue.back();
+      m_queue.pop_back();
+
+      if (candidate.version != m_positionCollapses[candidate.from].version) {
+        continue;
+      }
+
+      if (candidate.cost > maxCost) {
+        // Every remaining collapse costs at least as much, keep it for a later call
+        m_queue.push_back(candidate);
+        std::push_heap(m_queue.begin(), m_queue.end());
+        break;
+      }
+
+      // The cheapest collapse of a vertex may be blocked by its neighborhood, in which case the
+      // next valid one is queued again at its own cost. Vertices without any valid collapse wait
+      // for their neighborhood to change.
+      Collapse best = candidate;
+      uint32_t toVertex;
+
+      if (!findValidCollapse(candidate.from, best, toVertex)) {
+        queueCollapse(candidate.from, DBL_MAX, kInvalidIndex);
+        continue;
+      }
+
+      if (best.cost > candidate.cost) {
+        queueCollapse(best.from, best.cost, best.to);
+        continue;
+      }
+
+      collapse(best.from, best.to, toVertex);
+
+      m_error = std::max(m_error, float(std::sqrt(best.cost)));
+    }
+  }
+
+  std::vector<uint32_t> MeshSimplifier::getIndices() const {
+    std::vector<uint32_t> indices;
+    indices.reserve(getIndexCount());
+
+    for (uint32_t t = 0; t < m_triangleAlive.size(); t++) {
+      if (m_triangleAlive[t]) {
+        indices.insert(indices.end(), m_indices.begin() + t * 3, m_indices.begin() + t * 3 + 3);
+      }
+    }
+
+    return indices;
+  }
+
+  std::vector<MeshLod> generateMeshLods(const MeshSimplifierInput& input, const std::vector<uint32_t>& indices, const MeshLodSettings& settings) {
+    std::vector<MeshLod> lods;
+
+    if (indices.size() / 3 <= settings.minTriangles || settings.reductionPerLevel <= 0.f || settings.reductionPerLevel >= 1.f) {
+      return lods;
+    }
+
+    // Levels are snapshots of a single simplification run, so errors stay relative to the original mesh
+    MeshSimplifier simplifier(input, indices);
+    uint32_t previousIndexCount = uint32_t(indices.size());
+
+    while (lods.size() < settings.maxLevels && previousIndexCount / 3 > settings.minTriangles) {
+      const uint32_t targetIndexCount = std::max(uint32_t(previousIndexCount * settings.reductionPerLevel) / 3, settings.minTriangles) * 3;
+
+      simplifier.simplify(targetIndexCount, settings.maxError);
+
+      const uint32_t indexCount = simplifier.getIndexCount();
+      const uint32_t requestedReduction = previousIndexCount - targetIndexCount;
+
+      // Levels barely smaller than the previous one cost memory and BLAS builds for little gain
+      if (previousIndexCount - indexCount < requestedReduction * kMinLevelReductionFraction) {
+        break;
+      }
+
+      lods.push_back({ simplifier.getIndices(), simplifier.getError() });
+      previousIndexCount = indexCount;
+    }
+
+    return lods;
+  }
+
+  bool loadMeshLods(const std::string& directory, XXH64_hash_t key, std::vector<MeshLod>& outLods) {
+    outLods.clear();
+
+    std::ifstream file(getMeshLodCachePath(directory, key), std::ios::binary);
+
+    if (!file.is_open()) {
+      return false;
+    }
+
+    const std::vector<uint8_t> fileData { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    MeshLodCacheFileHeader header;
+
+    if (fileData.size() < sizeof(header)) {
+      return false;
+    }
+
+    std::memcpy(&header, fileData.data(), sizeof(header));
+
+    const bool valid = std::memcmp(header.magic, kMeshLodCacheMagic, sizeof(kMeshLodCacheMagic)) == 0
+                    && header.version == kMeshLodCacheVersion
+                    && header.key == key
+                    && header.dataSize == fileData.size() - sizeof(header)
+                    && XXH64(fileData.data() + sizeof(header), header.dataSize, 0) == header.dataChecksum;
+
+    if (!valid) {
+      return false;
+    }
+
+    // Each level is stored as its error and index count followed by the indices
+    const uint8_t* data = fileData.data() + sizeof(header);
+    const uint8_t* end = data + header.dataSize;
+
+    for (uint32_t level = 0; level < header.levelCount; level++) {
+      MeshLod lod;
+      uint32_t indexCount;
+
+      if (end - data < ptrdiff_t(sizeof(lod.error) + sizeof(indexCount))) {
+        outLods.clear();
+        return false;
+      }
+
+      std::memcpy(&lod.error, data, sizeof(lod.error));
+      std::memcpy(&indexCount, data + sizeof(lod.error), sizeof(indexCount));
+      data += sizeof(lod.error) + sizeof(indexCount);
+
+      if (uint64_t(end - data) < uint64_t(indexCount) * sizeof(uint32_t)) {
+        outLods.clear();
+        return false;
+      }
+
+      lod.indices.resize(indexCount);
+      std::memcpy(lod.indices.data(), data, indexCount * sizeof(uint32_t));
+      data += indexCount * sizeof(uint32_t);
+
+      outLods.push_back(std::move(lod));
+    }
+
+    return data == end;
+  }
+
+  bool storeMeshLods(const std::string& directory, XXH64_hash_t key, const std::vector<MeshLod>& lods) {
+    std::vector<uint8_t> data;
+
+    for (const MeshLod& lod : lods) {
+      const uint32_t indexCount = uint32_t(lod.indices.size());
+      const uint8_t* error = reinterpret_cast<const uint8_t*>(&lod.error);
+      const uint8_t* count = reinterpret_cast<const uint8_t*>(&indexCount);
+      const uint8_t* indices = reinterpret_cast<const uint8_t*>(lod.indices.data());
+
+      data.insert(data.end(), error, error + sizeof(lod.error));
+      data.insert(data.end(), count, count + sizeof(indexCount));
+      data.insert(data.end(), indices, indices + indexCount * sizeof(uint32_t));
+    }
+
+    MeshLodCacheFileHeader header {};
+    std::memcpy(header.magic, kMeshLodCacheMagic, sizeof(kMeshLodCacheMagic));
+    header.version = kMeshLodCacheVersion;
+    header.key = key;
+    header.levelCount = uint32_t(lods.size());
+    header.dataSize = data.size();
+    header.dataChecksum = XXH64(data.data(), data.size(), 0);
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    const std::string path = getMeshLodCachePath(directory, key);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (file) {
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    if (!file.good()) {
+      file.close();
+      fs::remove(path, ec);
+      return false;
+    }
+
+    return true;
+  }
+
+  uint32_t MeshLodSelector::selectLevel(const float* errors, uint32_t levelCount, float pixelsPerUnit,
+                                        float pixelThreshold, float hysteresis, uint32_t currentLevel) {
+    // Coarsest level within the threshold, errors grow along the chain
+    uint32_t level = 0;
+
+    while (level + 1 < levelCount && errors[level + 1] * pixelsPerUnit <= pixelThreshold) {
+      level++;
+    }
+
+    if (currentLevel >= levelCount || level == currentLevel) {
+      return level;
+    }
+
+    if (level > currentLevel) {
+      // Only coarsen as far as the error stays below the threshold by the margin
+      uint32_t coarserLevel = currentLevel;
+
+      while (coarserLevel + 1 < levelCount && errors[coarserLevel + 1] * pixelsPerUnit <= pixelThreshold * (1.f - hysteresis)) {
+        coarserLevel++;
+      }
+
+      return coarserLevel;
+    }
+
+    // Keep the current level until its error exceeds the threshold by the margin
+    if (errors[currentLevel] * pixelsPerUnit <= pixelThreshold * (1.f + hysteresis)) {
+      return currentLevel;
+    }
+
+    return level;
+  }
+
+  uint32_t MeshLodSelector::select(XXH64_hash_t key, const float* errors, uint32_t levelCount, float pixelsPerUnit,
+                                   float pixelThreshold, float hysteresis, uint32_t frameId) {
+    auto it = m_objects.try_emplace(key, Object { UINT32_MAX, frameId }).first;
+
+    it->second.level = selectLevel(errors, levelCount, pixelsPerUnit, pixelThreshold, hysteresis, it->second.level);
+    it->second.frameId = frameId;
+
+    return it->second.level;
+  }
+
+  void MeshLodSelector::garbageCollect(uint32_t frameId, uint32_t maxAge) {
+    for (auto it = m_objects.begin(); it != m_objects.end();) {
+      if (frameId - it->second.frameId > maxAge) {
+        it = m_objects.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
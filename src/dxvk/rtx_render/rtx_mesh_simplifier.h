@@ -0,0 +1,201 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../util/util_vector.h"
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+  // Vertex data of a mesh to simplify, strides are in bytes. Normals and texcoords are optional.
+  struct MeshSimplifierInput {
+    const float* positions = nullptr;
+    size_t positionStride = 0;
+    const float* normals = nullptr;
+    size_t normalStride = 0;
+    const float* texcoords = nullptr;
+    size_t texcoordStride = 0;
+    uint32_t vertexCount = 0;
+  };
+
+  /**
+   * \brief Edge collapse mesh simplifier
+   *
+   * Simplifies a triangle list by collapsing vertices into one of their neighbors, ordered by the
+   * quadric error of the planes of the original triangles merged into the remaining vertex. As
+   * vertices only ever move onto existing vertices, simplified meshes are index lists referencing
+   * the original vertex buffer. Vertices on borders, on UV or normal seams (positions shared by
+   * vertices with different attributes) and on non-manifold edges are never removed, which keeps
+   * open edges, seams and the boundaries between separately simplified material subsets intact.
+   * The error is reported in object space and bounds the distance of the remaining vertices to
+   * the planes of the original triangles they have absorbed.
+   */
+  class MeshSimplifier {
+  public:
+    MeshSimplifier(const MeshSimplifierInput& input, const std::vector<uint32_t>& indices);
+
+    // Removes vertices until at most targetIndexCount indices remain or the next collapse would
+    // exceed maxError. May be called repeatedly with decreasing targets, errors accumulate over calls.
+    void simplify(uint32_t targetIndexCount, float maxError);
+
+    std::vector<uint32_t> getIndices() const;
+
+    uint32_t getIndexCount() const { return m_triangleCount * 3; }
+
+    float getError() const { return m_error; }
+
+  private:
+    // Symmetric 4x4 plane quadric, stored as its upper triangle
+    struct Quadric {
+      double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+      double a11 = 0, a12 = 0, a13 = 0;
+      double a22 = 0, a23 = 0;
+      double a33 = 0;
+
+      void addPlane(const Vector3& normal, float distance);
+      void add(const Quadric& other);
+      double evaluate(const Vector3& p) const;
+    };
+
+    // Queued collapse of a vertex, outdated once the version of the vertex's collapse changes
+    struct Collapse {
+      double cost = 0;
+      uint32_t from = 0;
+      uint32_t to = 0;
+      uint32_t version = 0;
+
+      bool operator<(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    const Vector3& getPosition(uint32_t vertex) const;
+    const Vector3* getNormal(uint32_t vertex) const;
+    const Vector2* getTexcoord(uint32_t vertex) const;
+
+    void getNeighbors(uint32_t position, std::vector<uint32_t>& neighbors) const;
+    void queueCollapse(uint32_t position, double cost, uint32_t to);
+    void updateCollapse(uint32_t position);
+    double getCollapseCost(uint32_t from, uint32_t to) const;
+    bool findValidCollapse(uint32_t from, Collapse& collapse, uint32_t& toVertex) const;
+    bool isCollapseValid(uint32_t from, uint32_t to, uint32_t& toVertex) const;
+    void collapse(uint32_t from, uint32_t to, uint32_t toVertex);
+
+    MeshSimplifierInput m_input;
+
+    // Vertex indices of all triangles, dead triangles are kept but never referenced again
+    std::vector<uint32_t> m_indices;
+    std::vector<bool> m_triangleAlive;
+    uint32_t m_triangleCount = 0;
+
+    // Per unique position (vertices welded by position): the first vertex with that position,
+    // the triangles using it, its quadric and whether it may be removed
+    std::vector<uint32_t> m_vertexPosition;
+    std::vector<uint32_t> m_positionVertex;
+    std::vector<std::vector<uint32_t>> m_positionTriangles;
+    std::vector<Quadric> m_quadrics;
+    std::vector<bool> m_positionLocked;
+    std::vector<bool> m_positionAlive;
+    std::vector<Collapse> m_positionCollapses;
+
+    std::vector<Collapse> m_queue;
+
+    // Scratch space
+    std::vector<uint32_t> m_collapseNeighbors;
+    mutable std::vector<uint32_t> m_neighbors;
+    mutable std::vector<uint32_t> m_fromNeighbors;
+    mutable std::vector<uint32_t> m_toNeighbors;
+    mutable std::vector<std::pair<double, uint32_t>> m_candidates;
+
+    float m_error = 0.f;
+  };
+
+  struct MeshLodSettings {
+    // Index count reduction of each level relative to the previous one
+    float reductionPerLevel = 0.5f;
+    uint32_t maxLevels = 4;
+    uint32_t minTriangles = 256;
+    // Object space error no level may exceed
+    float maxError = 1.f;
+
+    XXH64_hash_t hash() const {
+      XXH64_hash_t h = XXH64(&reductionPerLevel, sizeof(reductionPerLevel), 0);
+      h = XXH64(&maxLevels, sizeof(maxLevels), h);
+      h = XXH64(&minTriangles, sizeof(minTriangles), h);
+      return XXH64(&maxError, sizeof(maxError), h);
+    }
+  };
+
+  // A simplified version of a mesh, error is in object space
+  struct MeshLod {
+    std::vector<uint32_t> indices;
+    float error = 0.f;
+  };
+
+  // Generates a chain of progressively simplified index lists for a mesh, the full detail mesh
+  // is not included. Levels which do not reduce the triangle count noticeably end the chain.
+  std::vector<MeshLod> generateMeshLods(const MeshSimplifierInput& input, const std::vector<uint32_t>& indices, const MeshLodSettings& settings);
+
+  // Stores and loads LOD chains on disk so they only need to be generated once per mesh,
+  // entries are keyed by the persistent content hash of the mesh and the LOD settings.
+  bool loadMeshLods(const std::string& directory, XXH64_hash_t key, std::vector<MeshLod>& outLods);
+  bool storeMeshLods(const std::string& directory, XXH64_hash_t key, const std::vector<MeshLod>& lods);
+
+  /**
+   * \brief Mesh LOD level selection
+   *
+   * Picks the coarsest level whose error projected to the screen stays below a pixel threshold.
+   * The level of each tracked object only moves to a coarser level once the projected error drops
+   * below the threshold by the hysteresis margin, and to a finer one once the error of the current
+   * level exceeds it by the margin, which avoids flipping levels (and rebuilding BLASes) every frame
+   * when an object hovers around a transition distance.
+   */
+  class MeshLodSelector {
+  public:
+    // Selects a level for a chain of increasing errors (level 0 being the full detail mesh with no
+    // error), pixelsPerUnit converts object space error to pixels at the object's distance.
+    static uint32_t selectLevel(const float* errors, uint32_t levelCount, float pixelsPerUnit,
+                                float pixelThreshold, float hysteresis, uint32_t currentLevel);
+
+    // Selects a level for an object tracked across frames, objects seen for the first time get
+    // their level without hysteresis.
+    uint32_t select(XXH64_hash_t key, const float* errors, uint32_t levelCount, float pixelsPerUnit,
+                    float pixelThreshold, float hysteresis, uint32_t frameId);
+
+    // Forgets objects not selected for more than the given number of frames
+    void garbageCollect(uint32_t frameId, uint32_t maxAge);
+
+    void clear() { m_objects.clear(); }
+
+    size_t getObjectCount() const { return m_objects.size(); }
+
+  private:
+    struct Object {
+      uint32_t level;
+      uint32_t frameId;
+    };
+
+    std::unordered_map<XXH64_hash_t, Object> m_objects;
+  };
+}
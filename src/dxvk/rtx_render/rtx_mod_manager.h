@@ -23,6 +23,7 @@
 
 #include "../../util/rc/util_rc_ptr.h"
 #include "../../lssusd/game_exporter_paths.h"
+#include "rtx_texture_manifest.h"
 
 #include <string>
 #include <filesystem>
@@ -75,6 +76,15 @@ public:
     return m_filePath;
   }
 
+  TextureUsageManifest& textureManifest() {
+    return m_textureManifest;
+  }
+
+  // The texture usage manifest lives next to the mod file, e.g. mod.usda -> mod.texturemanifest
+  Path textureManifestPath() const {
+    return Path(m_filePath).replace_extension(".texturemanifest");
+  }
+
   struct ComparePtrs {
     bool operator()(const std::unique_ptr<Mod>& lhs,
                     const std::unique_ptr<Mod>& rhs) const {
@@ -102,6 +112,8 @@ protected:
   std::string m_status = "Unloaded";
 
   std::unique_ptr<AssetReplacements> m_replacements;
+
+  TextureUsageManifest m_textureManifest;
 };
 
 /**
@@ -31,6 +31,8 @@
 #include "rtx_game_capturer_paths.h"
 #include "rtx_utils.h"
 #include "rtx_asset_datamanager.h"
+#include "rtx_mesh_reorder.h"
+#include "rtx_mesh_simplifier.h"
 
 #include "../../lssusd/usd_include_begin.h"
 #include <pxr/base/gf/matrix4f.h>
@@ -85,6 +87,8 @@ private:
   MaterialData* processMaterial(Args& args, const pxr::UsdPrim& matPrim);
   MaterialData* processMaterialUser(Args& args, const pxr::UsdPrim& prim);
   bool processGeomSubset(Args& args, const pxr::UsdPrim& subPrim, RasterGeometry& geometryData, MaterialData*& materialData);
+  const MeshLodChain* processMeshLods(Args& args, const RasterGeometry& geometryData);
+  std::vector<uint32_t> reorderMesh(const float* positions, size_t positionStride, uint32_t vertexCount, std::vector<uint32_t>& indices, bool reorderVertices);
   void processPrim(Args& args, pxr::UsdPrim& prim);
   void processLight(Args& args, const pxr::UsdPrim& lightPrim);
   void processReplacement(Args& args);
@@ -92,6 +96,11 @@ private:
   std::filesystem::file_time_type m_fileModificationTime;
   std::string m_openedFilePath;
   size_t m_replacedCount = 0;
+
+  // Triangle weighted locality of the meshes reordered by the current load, before and after reordering
+  MeshLocalityMetrics m_localityBefore;
+  MeshLocalityMetrics m_localityAfter;
+  size_t m_reorderedTriangleCount = 0;
 };
 
 // context and member variable arguments to pass down to anonymous functions (to avoid having USD in the header)
@@ -231,7 +240,10 @@ Rc<ManagedTexture> UsdMod::Impl::getTexture(const Args& args, const pxr::UsdPrim
       if (assetData != nullptr) {
         auto device = args.context->getDevice();
         auto& textureManager = device->getCommon()->getTextureManager();
-        return textureManager.preloadTexture(assetData, colorSpace, args.context, forcePreload);
+        auto texture = textureManager.preloadTexture(assetData, colorSpace, args.context, forcePreload);
+        // Keep track of the textures this mod owns so texture usage can be attributed to it
+        m_owner.m_replacements->storeObject(assetData->hash(), Rc<ManagedTexture>(texture));
+        return texture;
       } else {
         Logger::info(str::format("Texture ", path.GetAssetPath(), " asset data cannot be found or corrupted."));
       }
@@ -566,6 +578,17 @@ bool UsdMod::Impl::processGeomSubset(Args& args, const pxr::UsdPrim& subPrim, Ra
 
   assert(vecIndices.size() != 0);
 
+  // Subsets share the vertices of the parent mesh, so only their triangles are reordered
+  if (RtxOptions::Get()->reorderReplacementMeshes() && !vecIndices.empty() && vecIndices.size() % 3 == 0 && geometryData.positionBuffer.defined()) {
+    std::vector<uint32_t> indices(vecIndices.begin(), vecIndices.end());
+
+    if (*std::max_element(indices.begin(), indices.end()) < geometryData.vertexCount) {
+      const GeometryBufferData bufferData(geometryData);
+      reorderMesh(bufferData.positionData, geometryData.positionBuffer.stride(), geometryData.vertexCount, indices, false);
+      std::copy(indices.begin(), indices.end(), vecIndices.begin());
+    }
+  }
+
   size_t vertexIndicesSize = vecIndices.size();
   int maxIndex = 0;
 
@@ -605,6 +628,8 @@ bool UsdMod::Impl::processGeomSubset(Args& args, const pxr::UsdPrim& subPrim, Ra
   }
 
   geometryData.indexCount = vertexIndicesSize;
+  // Subsets share the points of the parent mesh, so mix the subset indices into its content hash
+  geometryData.persistentContentHash = XXH64(vecIndices.data(), vecIndices.size() * sizeof(int), geometryData.persistentContentHash);
   // Set these as hashed so that the geometryData acts like it's static.
   geometryData.hashes[HashComponents::VertexPosition] = ++m_replacedCount;
   geometryData.hashes[HashComponents::Indices] = geometryData.hashes[HashComponents::VertexPosition];
@@ -617,6 +642,169 @@ bool UsdMod::Impl::processGeomSubset(Args& args, const pxr::UsdPrim& subPrim, Ra
   return true;
 }
 
+const MeshLodChain* UsdMod::Impl::processMeshLods(Args& args, const RasterGeometry& geometryData) {
+  ZoneScoped;
+
+  const auto& options = RtxOptions::Get()->meshLod;
+
+  if (!options.enable() || geometryData.indexCount / 3 <= options.minTriangles() || !geometryData.positionBuffer.defined()) {
+    return nullptr;
+  }
+
+  // Replacement buffers are host visible, so the simplifier reads the vertex and index data from them directly
+  const GeometryBufferData bufferData(geometryData);
+  const bool use16bitIndices = geometryData.indexBuffer.indexType() == VK_INDEX_TYPE_UINT16;
+
+  std::vector<uint32_t> indices(geometryData.indexCount);
+  for (uint32_t i = 0; i < geometryData.indexCount; i++) {
+    indices[i] = use16bitIndices ? bufferData.getIndex(i) : reinterpret_cast<const uint32_t*>(bufferData.indexData)[i];
+  }
+
+  // Key by content rather than by prim, as the same mesh may be referenced by many prims
+  const size_t vertexDataSize = size_t(geometryData.vertexCount) * geometryData.positionBuffer.stride();
+  XXH64_hash_t lodHash = XXH64(bufferData.positionData, vertexDataSize, 0);
+  lodHash = XXH64(indices.data(), indices.size() * sizeof(uint32_t), lodHash);
+
+  MeshLodChain* existingChain;
+  if (m_owner.m_replacements->getObject(lodHash, existingChain)) {
+    return existingChain->geometryData.empty() ? nullptr : existingChain;
+  }
+
+  MeshLodChain chain;
+  chain.errors.push_back(0.f);
+
+  Vector3 minPosition(FLT_MAX);
+  Vector3 maxPosition(-FLT_MAX);
+  for (uint32_t index : indices) {
+    minPosition = min(minPosition, bufferData.getPosition(index));
+    maxPosition = max(maxPosition, bufferData.getPosition(index));
+  }
+
+  chain.center = (minPosition + maxPosition) * 0.5f;
+  chain.radius = length(maxPosition - minPosition) * 0.5f;
+
+  MeshSimplifierInput input;
+  input.positions = bufferData.positionData;
+  input.positionStride = geometryData.positionBuffer.stride();
+  input.normals = bufferData.normalData;
+  input.normalStride = geometryData.normalBuffer.stride();
+  input.texcoords = bufferData.texcoordData;
+  input.texcoordStride = geometryData.texcoordBuffer.stride();
+  input.vertexCount = geometryData.vertexCount;
+
+  MeshLodSettings settings;
+  settings.reductionPerLevel = options.reductionPerLevel();
+  settings.maxLevels = options.maxLevels();
+  settings.minTriangles = options.minTriangles();
+  settings.maxError = options.maxRelativeError() * chain.radius * 2.f;
+
+  const XXH64_hash_t cacheKey = XXH64(&lodHash, sizeof(lodHash), settings.hash());
+
+  std::vector<MeshLod> lods;
+  bool isCached = options.enableDiskCache() && loadMeshLods(relPath::remixMeshLodCacheDir, cacheKey, lods);
+
+  for (const MeshLod& lod : lods) {
+    if (std::any_of(lod.indices.begin(), lod.indices.end(), [&](uint32_t index) { return index >= geometryData.vertexCount; })) {
+      isCached = false;
+      break;
+    }
+  }
+
+  if (!isCached) {
+    lods = generateMeshLods(input, indices, settings);
+
+    if (options.enableDiskCache()) {
+      storeMeshLods(relPath::remixMeshLodCacheDir, cacheKey, lods);
+    }
+  }
+
+  for (uint32_t level = 0; level < lods.size(); level++) {
+    const std::vector<uint32_t>& lodIndices = lods[level].indices;
+
+    const size_t unalignedSize = lodIndices.size() * (use16bitIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    DxvkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+    info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+    info.access = VK_ACCESS_TRANSFER_WRITE_BIT;
+    info.size = dxvk::align(unalignedSize, CACHE_LINE_SIZE);
+
+    // Buffer contains:
+    // |---INDICES---|
+    Rc<DxvkBuffer> buffer = args.context->getDevice()->createBuffer(info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, DxvkMemoryStats::Category::RTXBuffer);
+
+    const DxvkBufferSlice& bufferSlice = DxvkBufferSlice(buffer);
+
+    // Levels only reference the vertices of the full detail mesh, so its index type fits them
+    RasterGeometry lodGeometryData(geometryData);
+
+    if (use16bitIndices) {
+      uint16_t* pIndices = reinterpret_cast<uint16_t*>(buffer->mapPtr(0));
+      for (size_t i = 0; i < lodIndices.size(); i++) {
+        pIndices[i] = static_cast<uint16_t>(lodIndices[i]);
+      }
+      lodGeometryData.indexBuffer = RasterBuffer(bufferSlice, 0, sizeof(uint16_t), VK_INDEX_TYPE_UINT16);
+    } else {
+      memcpy(buffer->mapPtr(0), lodIndices.data(), unalignedSize);
+      lodGeometryData.indexBuffer = RasterBuffer(bufferSlice, 0, sizeof(uint32_t), VK_INDEX_TYPE_UINT32);
+    }
+
+    lodGeometryData.indexCount = lodIndices.size();
+    lodGeometryData.persistentContentHash = XXH64(lodIndices.data(), lodIndices.size() * sizeof(uint32_t), geometryData.persistentContentHash);
+    // Each level is a distinct static geometry with its own BLAS
+    lodGeometryData.hashes[HashComponents::VertexPosition] = ++m_replacedCount;
+    lodGeometryData.hashes[HashComponents::Indices] = lodGeometryData.hashes[HashComponents::VertexPosition];
+
+    const XXH64_hash_t lodGeometryHash = XXH64(&level, sizeof(level), lodHash);
+    chain.geometryData.push_back(&m_owner.m_replacements->storeObject(lodGeometryHash, std::move(lodGeometryData)));
+    chain.errors.push_back(lods[level].error);
+  }
+
+  // Meshes which could not be simplified are stored too, so they are not attempted again
+  MeshLodChain& storedChain = m_owner.m_replacements->storeObject(lodHash, std::move(chain));
+  return storedChain.geometryData.empty() ? nullptr : &storedChain;
+}
+
+std::vector<uint32_t> UsdMod::Impl::reorderMesh(const float* positions, size_t positionStride, uint32_t vertexCount, std::vector<uint32_t>& indices, bool reorderVertices) {
+  ZoneScoped;
+
+  const float triangleCount = float(indices.size() / 3);
+  const MeshLocalityMetrics before = measureMeshLocality(positions, positionStride, vertexCount, indices);
+
+  reorderTrianglesSpatially(positions, positionStride, indices);
+
+  std::vector<uint32_t> vertexOrder;
+  if (reorderVertices) {
+    vertexOrder = reorderVerticesForFetch(indices, vertexCount);
+  }
+
+  MeshLocalityMetrics after;
+  if (reorderVertices) {
+    // The caller permutes the vertex data, so measure against a reordered copy of the positions
+    std::vector<Vector3> reorderedPositions(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      reorderedPositions[i] = *reinterpret_cast<const Vector3*>(reinterpret_cast<const uint8_t*>(positions) + vertexOrder[i] * positionStride);
+    }
+    after = measureMeshLocality(&reorderedPositions[0].x, sizeof(Vector3), vertexCount, indices);
+  } else {
+    after = measureMeshLocality(positions, positionStride, vertexCount, indices);
+  }
+
+  m_localityBefore.acmr += before.acmr * triangleCount;
+  m_localityBefore.averageIndexDelta += before.averageIndexDelta * triangleCount;
+  m_localityBefore.averageTriangleDistance += before.averageTriangleDistance * triangleCount;
+  m_localityAfter.acmr += after.acmr * triangleCount;
+  m_localityAfter.averageIndexDelta += after.averageIndexDelta * triangleCount;
+  m_localityAfter.averageTriangleDistance += after.averageTriangleDistance * triangleCount;
+  m_reorderedTriangleCount += indices.size() / 3;
+
+  return vertexOrder;
+}
+
 void UsdMod::Impl::processPrim(Args& args, pxr::UsdPrim& prim) {
   ZoneScoped;
 
@@ -679,6 +867,35 @@ void UsdMod::Impl::processPrim(Args& args, pxr::UsdPrim& prim) {
     bool isNormalValid = !normals.empty() && points.size() == normals.size();
     bool isUVValid = !uvs.empty() && points.size() == uvs.size();
 
+    // Reorder triangles and vertices for locality before the buffers are built, the caches below then key and store the reordered mesh
+    const bool isTriangleList = !vecFaceCounts.empty() && vecFaceCounts[0] == 3 && !vecIndices.empty() && vecIndices.size() % 3 == 0;
+    if (numSubsets <= 1 && isTriangleList && RtxOptions::Get()->reorderReplacementMeshes()) {
+      std::vector<uint32_t> indices(vecIndices.begin(), vecIndices.end());
+
+      if (*std::max_element(indices.begin(), indices.end()) < points.size()) {
+        static_assert(sizeof(pxr::GfVec3f) == sizeof(float) * 3);
+        const std::vector<uint32_t> vertexOrder = reorderMesh(points.data()->data(), sizeof(pxr::GfVec3f), uint32_t(points.size()), indices, true);
+
+        auto permute = [&vertexOrder](auto& data) {
+          std::remove_reference_t<decltype(data)> reordered(data.size());
+          for (size_t i = 0; i < vertexOrder.size(); i++) {
+            reordered[i] = data[vertexOrder[i]];
+          }
+          data.swap(reordered);
+        };
+
+        permute(points);
+        if (isNormalValid) {
+          permute(normals);
+        }
+        if (isUVValid) {
+          permute(uvs);
+        }
+
+        std::copy(indices.begin(), indices.end(), vecIndices.begin());
+      }
+    }
+
     newGeomData.vertexCount = points.size();
 
     const size_t indexSize = numSubsets <= 1 ? vecIndices.size() * sizeof(uint32_t) : 0; // allocate the worse case here (32-bit indices) - this leaves room for optimization but it should break the bank
@@ -774,6 +991,8 @@ void UsdMod::Impl::processPrim(Args& args, pxr::UsdPrim& prim) {
     }
     
     newGeomData.hashes[HashComponents::VertexPosition] = ++m_replacedCount;
+    newGeomData.persistentContentHash = XXH64(points.data(), points.size() * sizeof(pxr::GfVec3f), 0);
+    newGeomData.persistentContentHash = XXH64(vecIndices.data(), vecIndices.size() * sizeof(int), newGeomData.persistentContentHash);
     if (!vecIndices.empty() || !points.empty()) {
       // Set these as hashed so that the geometry acts like it's static.
       // TODO this will need to change to support skeleton meshes
@@ -840,6 +1059,7 @@ void UsdMod::Impl::processPrim(Args& args, pxr::UsdPrim& prim) {
             if (mat) {
               newReplacementMesh.materialData = mat;
             }
+            newReplacementMesh.lods = processMeshLods(args, *childGeometryData);
             args.meshes.push_back(newReplacementMesh);
           } else {
             RasterGeometry& newGeomData = m_owner.m_replacements->storeObject(usdOriginHash, RasterGeometry(*geometryData));
@@ -849,6 +1069,7 @@ void UsdMod::Impl::processPrim(Args& args, pxr::UsdPrim& prim) {
 
             // Only add this to the replacements if it was successful
             if (processGeomSubset(args, child, *newReplacementMesh.geometryData, newReplacementMesh.materialData)) {
+              newReplacementMesh.lods = processMeshLods(args, *newReplacementMesh.geometryData);
               args.meshes.push_back(newReplacementMesh);
             } else {
               // Geom Subset failed to process, need to remove the placeholder from the map to prevent
@@ -867,6 +1088,7 @@ void UsdMod::Impl::processPrim(Args& args, pxr::UsdPrim& prim) {
     return;
   }
   args.meshes.emplace_back(geometryData, materialData, replacementToObject);
+  args.meshes.back().lods = processMeshLods(args, *geometryData);
 }
 
 void UsdMod::Impl::processLight(Args& args, const pxr::UsdPrim& lightPrim) {
@@ -1071,6 +1293,10 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
   m_fileModificationTime = fs::last_write_time(fs::path(m_openedFilePath));
   pxr::UsdGeomXformCache xformCache;
 
+  m_localityBefore = MeshLocalityMetrics();
+  m_localityAfter = MeshLocalityMetrics();
+  m_reorderedTriangleCount = 0;
+
   pxr::VtDictionary layerData = stage->GetRootLayer()->GetCustomLayerData();
   if (layerData.empty()) {
     m_owner.m_status = "Layer Data Missing";
@@ -1169,6 +1395,14 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
     VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR);
 
+  if (m_reorderedTriangleCount > 0) {
+    const float scale = 1.f / float(m_reorderedTriangleCount);
+    Logger::info(str::format("Reordered ", m_reorderedTriangleCount, " replacement mesh triangles for locality: ACMR ",
+                             m_localityBefore.acmr * scale, " -> ", m_localityAfter.acmr * scale,
+                             ", average index delta ", m_localityBefore.averageIndexDelta * scale, " -> ", m_localityAfter.averageIndexDelta * scale,
+                             ", average triangle distance ", m_localityBefore.averageTriangleDistance * scale, " -> ", m_localityAfter.averageTriangleDistance * scale));
+  }
+
   m_owner.setState(State::Loaded);
 }
 
@@ -570,6 +570,20 @@ namespace dxvk {
     destroyInstance(instance);
   }
 
+  VkDeviceSize OpacityMicromapManager::getBuiltOpacityMicromapSize(XXH64_hash_t ommSrcHash) const {
+    auto ommCacheItemIter = m_ommCache.find(ommSrcHash);
+
+    if (ommCacheItemIter == m_ommCache.end())
+      return 0;
+
+    const OpacityMicromapCacheState ommCacheState = ommCacheItemIter->second.cacheState;
+
+    if (ommCacheState != OpacityMicromapCacheState::eStep3_Built && ommCacheState != OpacityMicromapCacheState::eStep4_Ready)
+      return 0;
+
+    return ommCacheItemIter->second.getDeviceSize();
+  }
+
   bool OpacityMicromapManager::doesInstanceUseOpacityMicromap(const RtInstance& instance) const {
     if (instance.getTexcoordHash() == kEmptyHash) {
       ONCE(Logger::info("[RTX Opacity Micromap] No texcoord hash detected. Ignoring the Opacity Micromap request."));
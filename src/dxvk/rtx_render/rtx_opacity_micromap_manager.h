@@ -256,6 +256,9 @@ namespace dxvk {
 
     bool doesInstanceUseOpacityMicromap(const RtInstance& instance) const;
 
+    // Returns the video memory taken by a built opacity micromap, 0 if there is none for the source hash
+    VkDeviceSize getBuiltOpacityMicromapSize(XXH64_hash_t ommSrcHash) const;
+
     // Must be called before a BLAS build is kicked off if an opacity micromap may have been bound for it
     // Should be called sparingly/once a frame after opacity micromaps have been bound to BLASes
     // and corresponding batched BLASes are about to be built. 
@@ -95,6 +95,45 @@ namespace dxvk {
     }
   }
 
+  XXH64_hash_t RtxOptionImpl::getValueHash(ValueType valueType) const {
+    const GenericValue& value = valueList[static_cast<int>(valueType)];
+
+    switch (type) {
+    case OptionType::Bool:
+    case OptionType::Int:
+    case OptionType::Float:
+      // Note: Basic types are stored in the zero initialized 64 bit value
+      return XXH3_64bits(&value.value, sizeof(value.value));
+    case OptionType::HashSet: {
+      // Note: Order independent as the iteration order of the set is not stable
+      XXH64_hash_t h = value.hashSet->size();
+      for (auto&& hash : *value.hashSet)
+        h += XXH3_64bits(&hash, sizeof(hash));
+      return h;
+    }
+    case OptionType::HashVector:
+      return XXH3_64bits(value.hashVector->data(), value.hashVector->size() * sizeof(XXH64_hash_t));
+    case OptionType::Vector2: return XXH3_64bits(value.v2, sizeof(Vector2));
+    case OptionType::Vector3: return XXH3_64bits(value.v3, sizeof(Vector3));
+    case OptionType::Vector2i: return XXH3_64bits(value.v2i, sizeof(Vector2i));
+    case OptionType::String: return XXH3_64bits(value.string->data(), value.string->size());
+    default:
+      return 0;
+    }
+  }
+
+  XXH64_hash_t RtxOptionImpl::getAllValuesHash() {
+    XXH64_hash_t h = 0;
+
+    // Note: The global option map is ordered by name
+    for (auto& pPair : getGlobalRtxOptionMap()) {
+      const XXH64_hash_t valueHash = pPair.second->getValueHash(ValueType::Value);
+      h = XXH3_64bits_withSeed(&valueHash, sizeof(valueHash), h);
+    }
+
+    return h;
+  }
+
   void RtxOptionImpl::readOptions(const Config& options) {
     auto& globalRtxOptions = getGlobalRtxOptionMap();
     for (auto& pPair : globalRtxOptions) {
@@ -98,6 +98,7 @@ namespace dxvk {
 
     const char* getTypeString() const;
     std::string genericValueToString(ValueType valueType) const;
+    XXH64_hash_t getValueHash(ValueType valueType) const;
 
     void readOption(const Config& options, ValueType type);
     void writeOption(Config& options, bool changedOptionOnly);
@@ -113,6 +114,9 @@ namespace dxvk {
     static void resetOptions();
     static bool writeMarkdownDocumentation(const char* outputMarkdownFilePath);
 
+    // Returns a hash of the current values of all options, used to detect changes to any of them
+    static XXH64_hash_t getAllValuesHash();
+
     // Returns a global container holding all serializable options
     static RtxOptionMap& getGlobalRtxOptionMap();
 
@@ -0,0 +1,68 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_optional_resource.h"
+
+namespace dxvk {
+  RtxOptionalResourceLifetime::Action RtxOptionalResourceLifetime::update(bool isActive, uint32_t idleFramesBeforeRelease) {
+    m_isActive = isActive;
+
+    if (isActive) {
+      m_idleFrames = 0;
+
+      if (!m_isAllocated) {
+        m_isAllocated = true;
+        return Action::Allocate;
+      }
+
+      return Action::None;
+    }
+
+    if (!m_isAllocated) {
+      return Action::None;
+    }
+
+    if (m_idleFrames++ < idleFramesBeforeRelease) {
+      return Action::None;
+    }
+
+    reset();
+    return Action::Release;
+  }
+
+  RtxOptionalResourceLifetime::Action RtxOptionalResourceLifetime::onResize() {
+    if (!m_isAllocated) {
+      return Action::None;
+    }
+
+    if (m_isActive) {
+      return Action::Allocate;
+    }
+
+    reset();
+    return Action::Release;
+  }
+
+  void RtxOptionalResourceLifetime::reset() {
+    m_isAllocated = false;
+    m_idleFrames = 0;
+  }
+}
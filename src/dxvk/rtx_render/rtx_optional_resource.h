@@ -0,0 +1,69 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+namespace dxvk {
+  // Tracks the lifetime of a resource (or a group of resources) which is only needed while its activation
+  // predicate holds, e.g. while the feature using it is enabled. The resource is allocated the first frame the
+  // predicate holds and released once it has not held for a number of frames, so briefly toggling a feature
+  // does not reallocate its resources. The lifetime neither evaluates predicates nor owns the resource itself,
+  // the caller allocates and releases it as told by the returned Action.
+  class RtxOptionalResourceLifetime {
+  public:
+    enum class Action {
+      None,
+      Allocate, // Resource must be (re)created
+      Release   // Resource must be released
+    };
+
+    // Called once per frame with the current value of the activation predicate. The resource is released
+    // after the given number of consecutive inactive frames, 0 releases it the first frame it is inactive.
+    Action update(bool isActive, uint32_t idleFramesBeforeRelease);
+
+    // Called when the extent the resource depends on changes. Resources in use must be recreated,
+    // resources kept around while idle are released rather than being reallocated at the new extent.
+    Action onResize();
+
+    // Forgets about the resource, for when its owner released it outside of update()
+    void reset();
+
+    bool isAllocated() const {
+      return m_isAllocated;
+    }
+
+    // Whether the predicate held the last time the lifetime was updated
+    bool isActive() const {
+      return m_isActive;
+    }
+
+    uint32_t getIdleFrames() const {
+      return m_idleFrames;
+    }
+
+  private:
+    bool m_isAllocated = false;
+    bool m_isActive = false;
+    uint32_t m_idleFrames = 0;
+  };
+}
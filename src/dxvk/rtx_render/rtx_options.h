@@ -226,10 +226,92 @@ namespace dxvk {
       RTX_OPTION("rtx.playerModel", float, intersectionCapsuleHeight, 68.f, "");
     } playerModel;
 
+  public:
+    struct StaticSceneDetection {
+      friend class ImGUI;
+      RTX_OPTION("rtx.staticSceneDetection", bool, enable, false, "Detects frames in which nothing the path tracer consumes (camera, instances, lights, materials, texture contents, animated materials and options) changed, and presents the output of the last rendered frame again instead of ray tracing, denoising and upscaling it, e.g. in pause menus or loading screens. "
+                 "Rendering resumes on the first frame with a change. Scene data preparation still runs every frame.");
+      RTX_OPTION("rtx.staticSceneDetection", uint32_t, minStaticFrames, 32, "The number of unchanged frames still rendered after a change before the output is reused, giving temporal accumulation and the denoisers time to converge.");
+      RTX_OPTION("rtx.staticSceneDetection", uint32_t, refreshInterval, 0, "While the scene is unchanged, still render one in this many frames to keep accumulating at a reduced rate. 0 reuses the output until the scene changes.");
+    } staticSceneDetection;
+
+  public:
+    struct FrameBudget {
+      friend class ImGUI;
+      RTX_OPTION("rtx.frameBudget", bool, enable, false, "Scales the quality settings listed in rtx.frameBudget.settings at runtime to hold the target GPU frame time, lowering them in dense areas and restoring them where there is headroom. "
+                 "Settings are never raised above the values they had when the governor took control of them.");
+      RTX_OPTION("rtx.frameBudget", float, targetFrameTimeMs, 16.6f, "The GPU frame time in milliseconds the governor aims for.");
+      RTX_OPTION("rtx.frameBudget", float, hysteresis, 0.1f, "The fraction of the target frame time the measured frame time may deviate by before any setting is changed.");
+      RTX_OPTION("rtx.frameBudget", uint32_t, settleFrames, 30, "The number of frames to wait after changing a setting before measuring again.");
+      RTX_OPTION("rtx.frameBudget", std::string, settings, "rtx.froxelMaxReservoirSamples:1, rtx.di.spatialSamples:1, rtx.di.initialSampleCount:1, rtx.pathMaxBounces:1",
+                 "Comma separated list of integer options the governor may scale, each followed by the lowest value it may use, e.g. rtx.pathMaxBounces:1. "
+                 "Options are lowered in the listed order and restored in the reverse order.");
+    } frameBudget;
+
+  public:
+    struct MeshLod {
+      friend class ImGUI;
+      RTX_OPTION("rtx.meshLod", bool, enable, false, "Generates a chain of simplified versions of replacement meshes when they are loaded and traces each instance with the coarsest one whose error stays below rtx.meshLod.pixelErrorThreshold on screen. "
+                 "UV and normal seams, open borders and the boundaries between material subsets are preserved, simplified levels share the vertex data of the original mesh.");
+      RTX_OPTION("rtx.meshLod", uint32_t, minTriangles, 2000, "Meshes with fewer triangles are not simplified, and no level is simplified further than this.");
+      RTX_OPTION("rtx.meshLod", uint32_t, maxLevels, 4, "The maximum number of simplified levels generated per mesh.");
+      RTX_OPTION("rtx.meshLod", float, reductionPerLevel, 0.5f, "The triangle count of each level relative to the previous one.");
+      RTX_OPTION("rtx.meshLod", float, maxRelativeError, 0.05f, "The maximum geometric error of any level, relative to the size of the mesh's bounding box.");
+      RTX_OPTION("rtx.meshLod", float, pixelErrorThreshold, 1.f, "The geometric error in pixels a level may have on screen to be used.");
+      RTX_OPTION("rtx.meshLod", float, hysteresis, 0.25f, "The fraction of the pixel error threshold by which the on-screen error has to cross it before an instance switches levels, avoids BLAS rebuilds from flipping between levels.");
+      RTX_OPTION("rtx.meshLod", bool, enableDiskCache, true, "Stores generated levels on disk so that meshes are only simplified the first time they are loaded.");
+    } meshLod;
+
+  public:
+    struct RayVisibility {
+      friend class ImGUI;
+      RTX_OPTION("rtx.rayVisibility", bool, excludeParticlesFromShadowRays, false, "Opaque particles in the ordered TLAS are not traced by shadow rays. Particles handled as unordered approximations are never traced by shadow rays.");
+      RTX_OPTION("rtx.rayVisibility", bool, excludeParticlesFromIndirectRays, false, "Opaque particles in the ordered TLAS are not traced by indirect rays.");
+      RTX_OPTION("rtx.rayVisibility", bool, excludeDecalsFromShadowRays, false, "Decals are not traced by shadow rays.");
+      RTX_OPTION("rtx.rayVisibility", bool, excludeDecalsFromIndirectRays, false, "Decals are not traced by indirect rays.");
+      RTX_OPTION("rtx.rayVisibility", bool, excludeAlphaTestedFromShadowRays, false, "Opaque alpha tested surfaces, such as foliage cards, are not traced by shadow rays.");
+      RTX_OPTION("rtx.rayVisibility", bool, excludeAlphaTestedFromIndirectRays, false, "Opaque alpha tested surfaces, such as foliage cards, are not traced by indirect rays.");
+      RTX_OPTION("rtx.rayVisibility", bool, excludeSmallInstancesFromShadowRays, false, "Opaque instances with a bounding sphere radius below rtx.rayVisibility.smallInstanceRadius are not traced by shadow rays.");
+      RTX_OPTION("rtx.rayVisibility", bool, excludeSmallInstancesFromIndirectRays, false, "Opaque instances with a bounding sphere radius below rtx.rayVisibility.smallInstanceRadius are not traced by indirect rays.");
+      RTX_OPTION("rtx.rayVisibility", float, smallInstanceRadius, 0.f, "The world space bounding sphere radius below which instances count as small. "
+                 "Primary rays always trace every category, and an instance excluded from both shadow and indirect rays is only excluded from indirect rays, as there is no instance mask bit left for primary rays alone.");
+    } rayVisibility;
+
+  public:
+    struct BlasBuildBudget {
+      friend class ImGUI;
+      RTX_OPTION("rtx.blasBuildBudget", bool, enable, false, "Spreads the builds of new static BLASes over several frames when many meshes appear at once, e.g. on level loads or camera cuts. "
+                 "Builds are ranked by the projected size of their instance on screen. Meshes waiting to be promoted to a static BLAS keep using a merged BLAS meanwhile.");
+      RTX_OPTION("rtx.blasBuildBudget", uint32_t, maxPrimitivesPerFrame, 1000000, "The number of triangles of new static BLASes built per frame. At least one BLAS is built every frame there is one waiting, even if it exceeds the budget alone.");
+      RTX_OPTION("rtx.blasBuildBudget", uint32_t, maxDeferredFrames, 8, "The number of frames a static BLAS build may be deferred for, after which it is built regardless of the budget.");
+    } blasBuildBudget;
+
+    struct AssetCostLedgerOptions {
+      friend class ImGUI;
+      RTX_OPTION("rtx.assetCostLedger", bool, enable, false, "Attributes the instances, triangles, BLAS builds and the memory of BLASes, opacity micromaps and textures of the scene to the asset hash that caused them. "
+                 "Replacement meshes are attributed to the hash of the mesh they replace. The heaviest assets are listed in the developer menu and all of them can be dumped to a CSV file.");
+      RTX_OPTION("rtx.assetCostLedger", uint32_t, maxEntries, 4096, "The number of assets tracked individually. Costs of further assets are collected under hash 0.");
+      RTX_OPTION("rtx.assetCostLedger", uint32_t, maxIdleFrames, 600, "The number of frames an asset stays in the ledger after it was last seen.");
+      RTX_OPTION("rtx.assetCostLedger", uint32_t, topCount, 20, "The number of assets listed in the developer menu.");
+    } assetCostLedger;
+
+    struct InstancedDrawOptions {
+      friend class ImGUI;
+      RTX_OPTION("rtx.instancedDraws", bool, expand, true, "Captures hardware instanced draws (SetStreamSourceFreq) once and expands them into one instance per drawn instance, all sharing the BLAS of the geometry. "
+                 "The per-instance transform is decoded on the CPU from the instance stream: three or four consecutive float4 texcoords are taken as the rows of the instance matrix, otherwise a float3 or float4 position as an offset, with a uniform scale in w. "
+                 "The instance transform applies before the world transform of the draw. Draws using a vertex shader are expanded from the vertex capture of their first instance and need rtx.useVertexCapture. Instanced draws without a recognized transform are captured as a single object.");
+      RTX_OPTION("rtx.instancedDraws", uint32_t, maxInstances, 4096, "The number of instances an instanced draw is expanded into at most. Further instances are not raytraced.");
+    } instancedDraws;
+
     RTX_OPTION("rtx", bool, resolvePreCombinedMatrices, true, "");
     RTX_OPTION("rtx", bool, useVertexCapture, false, "");
     RTX_OPTION("rtx", uint32_t, minPrimsInStaticBLAS, 1000, "");
     RTX_OPTION("rtx", uint32_t, maxPrimsInMergedBLAS, 50000, "");
+    RTX_OPTION("rtx", bool, enableBlasDiskCache, false, "Stores serialized static BLASes of replacement meshes in a cache on disk and deserializes them instead of building them in subsequent runs. "
+               "Entries are keyed by mesh content, build flags and the device/driver, and are rebuilt automatically when the serialized data is not compatible with the current driver.");
+    RTX_OPTION("rtx", bool, reorderReplacementMeshes, true, "Reorders the triangles of replacement meshes along a space filling curve and their vertices in order of first use when they are loaded, "
+               "which makes vertex fetches and BLAS builds more cache friendly. The geometry is unchanged, only the order of triangles and vertices.");
+    RTX_OPTION("rtx", uint32_t, blasDiskCacheMaxSizeMB, 2048, "The maximum size of the on-disk BLAS cache, least recently used entries are evicted when it is exceeded.");
     
     // Camera
     RTX_OPTION("rtx", bool, shakeCamera, false, "");
@@ -284,6 +366,10 @@ namespace dxvk {
     RTX_OPTION("rtx", uint32_t, numFramesToKeepLights, 100, ""); // NOTE: This was the default we've had for a while, can probably be reduced...
     RTX_OPTION("rtx", uint32_t, numFramesToKeepGeometryData, 5, "");
     RTX_OPTION("rtx", uint32_t, numFramesToKeepMaterialTextures, 30, "");
+    RTX_OPTION("rtx", uint32_t, numFramesToKeepOptionalPassResources, 0, "The number of frames the resources of an optional pass (e.g. bloom, TAA or the debug view) are kept after the pass has been disabled, so that toggling it back on does not reallocate them. 0 releases them as soon as the pass is disabled.");
+    RTX_OPTION("rtx", bool, batchGeometryProcessing, true, "Gathers the vertex interleaving and triangle list generation work of all draw calls processed together into one compute dispatch per kind, rather than one dispatch per draw call. The cached geometry is identical either way.");
+    RTX_OPTION("rtx", bool, compactRaytracingNormals, false, "Stores vertex normals of cached ray tracing geometry octahedral encoded in 32 bits rather than as 3 floats. Reduces geometry memory and hit shading bandwidth at a small precision cost. Skinned geometry always uses full precision normals.");
+    RTX_OPTION("rtx", bool, compactRaytracingTexcoords, false, "Stores texture coordinates of cached ray tracing geometry as half precision floats. Reduces geometry memory and hit shading bandwidth, but may cause visible texture swimming on geometry with large texture coordinate values or high resolution textures.");
     RTX_OPTION("rtx", bool, enablePreviousTLAS, true, "");
     RTX_OPTION("rtx", float, sceneScale, 1, "Defines the ratio of rendering unit (1cm) to game unit, i.e. sceneScale = 1cm / GameUnit.");
 
@@ -382,6 +468,9 @@ namespace dxvk {
     RTX_OPTION("rtx", bool, useIntersectionBillboardsOnPrimaryRays, false, "");
     RTX_OPTION("rtx", float, translucentDecalAlbedoFactor, 10.f, "Scale for the albedo of decals that are applied to a translucent base material, to make the decals more visible.");
     RTX_OPTION("rtx", float, decalNormalOffset, 0.003f, "Distance along normal between two adjacent decals.");
+    RTX_OPTION("rtx", bool, enableTerrainBaking, false, "Composites the layers of blended terrain (see rtx.terrainTextures) drawn over the same geometry into a single baked opaque surface and only traces the bottom layer. "
+               "Only stacks whose layers share texture coordinates and do not use vertex colors in their texture stage state are baked, other stacks are traced as blended layers.");
+    RTX_OPTION("rtx", uint32_t, terrainBakingMaxResolution, 2048, "The maximum width and height of the textures a terrain stack is baked into.");
     RTX_OPTION("rtx", float, worldSpaceUiBackgroundOffset, -0.01f, "Distance along normal to offset the background of screens.");
 
     // Light Selection/Sampling Options
@@ -445,6 +534,8 @@ namespace dxvk {
     RTX_OPTION("rtx", float, emissiveBlendOverrideEmissiveIntensity, 0.2f, "The emissive intensity to use when the emissive blend override is enabled. Adjust this if particles for example look overly bright globally.");
     RTX_OPTION("rtx", float, particleSoftnessFactor, 0.05f, "Multiplier for the view distance that is used to calculate the particle blending range.");
     RTX_OPTION("rtx", float, forceCutoutAlpha, 0.5f, "When an object is added to cutoutTextures, its surface with alpha less than this value will get discarded. This is meant to improve on legacy, low-resolution textures that use blended transparency instead of alpha cutout, which can result in blurry halos around edges. This is generally best handled by generating replacement assets that use either fully opaque, detailed geometry, or fully transparent alpha cutouts on higher resolution textures. Rendered output might still look incorrect even with this flag.");
+    RTX_OPTION("rtx", bool, enableTextureAlphaPromotion, true, "Uses the range of alpha values in the textures of legacy materials to treat alpha tested and alpha blended surfaces as fully opaque when their alpha always passes, "
+               "or to skip them when it never does. This avoids any-hit shading for legacy draws that leave alpha testing or blending enabled on textures with uniform alpha.");
 
     // Ray Portal Options
     // Note: Not a set as the ordering of the hashes is important. Keep this list small to avoid expensive O(n) searching (should only have 2 or 4 elements usually).
@@ -504,10 +595,20 @@ namespace dxvk {
     RTX_OPTION("rtx", bool, forceHighResolutionReplacementTextures, false, "");
     RTX_OPTION("rtx", int,  skipReplacementTextureMipMapLevel, 0, "The texture resolution to use, lower resolution textures may improve performance and reduce video memory usage.");
     RTX_OPTION("rtx", int,  assetEstimatedSizeGB, 2, "");
+    RTX_OPTION("rtx", bool, enableSamplerFeedbackTextureResidency, false, "Enables per texture mip residency for replacement textures driven by the mips the path tracer samples. Only mips sampled over a recent window are kept resident, finer mips are streamed in as they are sampled and unused ones are dropped. Requires adaptive resolution replacement textures and is not used with RTX IO.");
+    RTX_OPTION("rtx", uint32_t, textureResidencyWindowFrames, 60, "The number of frames of sampler feedback a replacement texture must go without sampling a mip before that mip is dropped.");
+    RTX_OPTION("rtx", uint32_t, textureResidencyMipBias, 0, "The number of mips finer than the finest sampled one to keep resident, trades memory for less streaming when the camera approaches surfaces.");
+    RTX_OPTION("rtx", uint32_t, textureResidencyMaxChangesPerFrame, 8, "The maximum number of replacement textures whose resident mips are changed in a single frame, limits the loading work sampler feedback may cause per frame.");
     RTX_OPTION_ENV("rtx", bool, enableAsyncTextureUpload, true, "DXVK_ASYNC_TEXTURE_UPLOAD", "");
     RTX_OPTION_ENV("rtx", bool, alwaysWaitForAsyncTextures, false, "DXVK_WAIT_ASYNC_TEXTURES", "");
     RTX_OPTION("rtx", int,  asyncTextureUploadPreloadMips, 8, "");
     RTX_OPTION("rtx", bool, usePartialDdsLoader, true, "");
+    RTX_OPTION("rtx", bool, recordTextureUsageManifest, false, "Records which replacement textures are used near which camera positions into a texture usage manifest stored next to each mod, used to prefetch replacement textures ahead of the camera on later runs.");
+    RTX_OPTION("rtx", bool, prefetchFromTextureUsageManifest, true, "Streams in replacement textures ahead of the camera based on the texture usage manifests recorded for the loaded mods, if any.");
+    RTX_OPTION("rtx", float, textureUsageManifestCellSize, 1000.f, "The size of a texture usage manifest grid cell in world units. Only applies to newly recorded manifests.");
+    RTX_OPTION("rtx", float, textureUsageManifestLookAheadDistance, 3000.f, "How far ahead along the direction of camera motion (in world units) the texture usage manifest is queried for textures to prefetch.");
+    RTX_OPTION("rtx", int,  textureUsageManifestMaxPrefetchesPerFrame, 4, "The maximum number of replacement textures prefetched per frame based on the texture usage manifests.");
+    RTX_OPTION("rtx", int,  textureUsageManifestPrefetchMinFreeMemoryMB, 1024, "Texture prefetching is skipped while less than this amount of video memory (in MB) is available within the memory budget.");
 
     RTX_OPTION("rtx", TonemappingMode, tonemappingMode, TonemappingMode::Local, "");
 
@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include "../shaders/rtx/pass/instance_definitions.h"
+
+namespace dxvk {
+  // Categories of instances whose visibility to secondary rays can be restricted
+  enum class RayVisibilityCategory : uint32_t {
+    Particle    = 1 << 0,
+    Decal       = 1 << 1,
+    AlphaTested = 1 << 2,
+    Small       = 1 << 3,
+  };
+
+  // Categories excluded from each secondary ray type, as sets of RayVisibilityCategory bits
+  struct RayVisibilityPolicy {
+    uint32_t shadowExcluded = 0;
+    uint32_t indirectExcluded = 0;
+
+    bool isEmpty() const {
+      return shadowExcluded == 0 && indirectExcluded == 0;
+    }
+  };
+
+  // Determines the categories of an instance. Instances are small when their world space bounding sphere is smaller
+  // than smallRadius, a negative radius means the bounds are unknown.
+  inline uint32_t getRayVisibilityCategories(bool isParticle, bool isDecal, bool isAlphaTested, float radius, float smallRadius) {
+    uint32_t categories = 0;
+
+    if (isParticle)
+      categories |= uint32_t(RayVisibilityCategory::Particle);
+    if (isDecal)
+      categories |= uint32_t(RayVisibilityCategory::Decal);
+    if (isAlphaTested)
+      categories |= uint32_t(RayVisibilityCategory::AlphaTested);
+    if (radius >= 0.f && radius < smallRadius)
+      categories |= uint32_t(RayVisibilityCategory::Small);
+
+    return categories;
+  }
+
+  // Selects the opaque instance mask bits of an instance with the given categories. Primary rays trace both bits, so
+  // an instance has to keep at least one of them to stay visible. Instances excluded from both shadow and indirect
+  // rays are only excluded from indirect rays, as their shadows are usually the more noticeable of the two.
+  inline uint32_t getOpaqueRayVisibilityMask(uint32_t categories, const RayVisibilityPolicy& policy) {
+    uint32_t mask = OBJECT_MASK_OPAQUE;
+
+    if (categories & policy.indirectExcluded)
+      mask &= ~OBJECT_MASK_OPAQUE_INDIRECT;
+    if ((categories & policy.shadowExcluded) && mask != OBJECT_MASK_OPAQUE_SHADOW)
+      mask &= ~OBJECT_MASK_OPAQUE_SHADOW;
+
+    return mask;
+  }
+}
@@ -0,0 +1,92 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+  // Binds the lights of replacement assets to the instance of the asset they belong to (its root instance).
+  // A replacement light is fully determined by the light in the replacement asset and the transform of its
+  // root instance, so its owner only has to transform and match it when it is first seen or the root instance
+  // moved. The bindings only track light hashes, the lights themselves are owned and aged by the caller.
+  template<typename Transform>
+  class RtReplacementLightBindings {
+  public:
+    enum class Action {
+      Keep,   // Light exists and is up to date
+      Create, // Light is new to its root instance
+      Update  // Root instance moved, light must be transformed again
+    };
+
+    // Binds a light to its root instance for the given frame. The transform of the root instance is only compared
+    // for the first light bound in a frame, further lights of the same instance share the result.
+    Action bind(uint64_t rootInstanceId, XXH64_hash_t lightHash, const Transform& objectToWorld, uint32_t frameId) {
+      auto entry = m_bindings.try_emplace(rootInstanceId);
+      Binding& binding = entry.first->second;
+
+      if (entry.second) {
+        binding.objectToWorld = objectToWorld;
+        binding.frameId = frameId;
+      } else if (binding.frameId != frameId) {
+        binding.hasMoved = !(binding.objectToWorld == objectToWorld);
+        binding.objectToWorld = objectToWorld;
+        binding.frameId = frameId;
+      }
+
+      for (XXH64_hash_t boundHash : binding.lights) {
+        if (boundHash == lightHash)
+          return binding.hasMoved ? Action::Update : Action::Keep;
+      }
+
+      binding.lights.push_back(lightHash);
+      return Action::Create;
+    }
+
+    // Removes the bindings of a root instance
+    void retire(uint64_t rootInstanceId) {
+      m_bindings.erase(rootInstanceId);
+    }
+
+    void clear() {
+      m_bindings.clear();
+    }
+
+    size_t getInstanceCount() const {
+      return m_bindings.size();
+    }
+
+  private:
+    struct Binding {
+      Transform objectToWorld;
+      uint32_t frameId = 0;
+      bool hasMoved = false;
+      // Note: Replacement assets only carry a handful of lights, a linear search beats hashing here
+      std::vector<XXH64_hash_t> lights;
+    };
+
+    std::unordered_map<uint64_t, Binding> m_bindings;
+  };
+}
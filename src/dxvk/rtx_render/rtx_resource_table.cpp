@@ -0,0 +1,194 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_resource_table.h"
+
+#include <array>
+#include <cassert>
+#include <cstring>
+
+#include "../dxvk_format.h"
+
+namespace dxvk {
+  namespace {
+    using R = RtxOutputResource;
+    using S = RtxOutputScale;
+
+    // Note: Aliases must use a format with the same texel size as the resource they alias
+    const std::array<RtxOutputResourceDesc, size_t(RtxOutputResource::Count)> s_outputResources = {{
+      { R::VolumePreintegratedRadiance, "Volume Preintegrated Radiance", "Volumetrics", S::FroxelVolume, VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::VolumeReservoirs0, "Volume Reservoirs 0", "Volumetrics", S::FroxelVolumes, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::VolumeReservoirs1, "Volume Reservoirs 1", "Volumetrics", S::FroxelVolumes, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::VolumeAccumulatedRadiance0, "Volume Accumulated Radiance 0", "Volumetrics", S::FroxelVolumes, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::VolumeAccumulatedRadiance1, "Volume Accumulated Radiance 1", "Volumetrics", S::FroxelVolumes, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::VolumeFilteredRadiance, "Volume Filtered Radiance", "Volumetrics", S::FroxelVolumes, VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedFlags, "Shared Flags", "GBuffer", S::Downscaled, VK_FORMAT_R16_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedRadianceRG, "Shared Radiance RG", "GBuffer", S::Downscaled, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedRadianceB, "Shared Radiance B", "GBuffer", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedMaterialData0, "Shared Material Data 0", "GBuffer", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedMaterialData1, "Shared Material Data 1", "GBuffer", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedMediumMaterialIndex, "Shared Medium Material Index", "GBuffer", S::Downscaled, VK_FORMAT_R16_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedBiasCurrentColorMask, "Shared Attenuation", "GBuffer", S::Downscaled, VK_FORMAT_R8_UNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SharedIntegrationSurfacePdf, "Shared Integration Surface PDF", "Integrator", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::PrimaryRtxdiIlluminance0 },
+      { R::PrimaryAttenuation, "Primary Attenuation", "GBuffer", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryWorldShadingNormal, "Primary World Shading Normal", "GBuffer", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryWorldInterpolatedNormal, "Primary World Interpolated Normal", "GBuffer", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryPerceptualRoughness, "Primary Perceptual Roughness", "GBuffer", S::Downscaled, VK_FORMAT_R8_UNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryLinearViewZ, "Primary Linear View Z", "GBuffer", S::Downscaled, VK_FORMAT_R32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryDepth, "Primary Depth", "GBuffer", S::Downscaled, VK_FORMAT_R32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryAlbedo, "Primary Albedo", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryBaseReflectivity, "Primary Base Reflectivity", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimarySpecularAlbedo, "Primary Specular Albedo", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::PrimaryBaseReflectivity },
+      { R::PrimaryVirtualMotionVector, "Primary Virtual Motion Vector", "GBuffer", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryScreenSpaceMotionVector, "Primary Screen Space Motion Vector", "GBuffer", S::Downscaled, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryVirtualWorldShadingNormalPerceptualRoughness, "Primary Virtual World Shading Normal Perceptual Roughness", "GBuffer", S::Downscaled, VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryVirtualWorldShadingNormalPerceptualRoughnessDenoising, "Primary Virtual World Shading Normal Perceptual Roughness Denoising", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryHitDistance, "Primary Hit Distance", "GBuffer", S::Downscaled, VK_FORMAT_R32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryViewDirection, "Primary View Direction", "GBuffer", S::Downscaled, VK_FORMAT_R16G16_SNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryConeRadius, "Primary Cone Radius", "GBuffer", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryWorldPositionWorldTriangleNormal0, "Primary World Position World Triangle Normal 0", "GBuffer", S::Downscaled, VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryWorldPositionWorldTriangleNormal1, "Primary World Position World Triangle Normal 1", "GBuffer", S::Downscaled, VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryPositionError, "Primary Position Error", "GBuffer", S::Downscaled, VK_FORMAT_R32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryRtxdiIlluminance0, "Primary RTXDI Illuminance 0", "RTXDI", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryRtxdiIlluminance1, "Primary RTXDI Illuminance 1", "RTXDI", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryRtxdiTemporalPosition, "Primary RTXDI Temporal Position", "RTXDI", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimarySurfaceFlags, "Primary Surface Flags", "GBuffer", S::Downscaled, VK_FORMAT_R8_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryDisocclusionThresholdMix, "Primary Disocclusion Threshold Mix", "Denoiser", S::Downscaled, VK_FORMAT_R8_UNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryAttenuation, "Secondary Attenuation", "GBuffer", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryWorldShadingNormal, "Secondary World Shading Normal", "GBuffer", S::Downscaled, VK_FORMAT_R32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryPerceptualRoughness, "Secondary Perceptual Roughness", "GBuffer", S::Downscaled, VK_FORMAT_R8_UNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryLinearViewZ, "Secondary Linear View Z", "GBuffer", S::Downscaled, VK_FORMAT_R32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryAlbedo, "Secondary Albedo", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryBaseReflectivity, "Secondary Base Reflectivity", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondarySpecularAlbedo, "Secondary Specular Albedo", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::SecondaryBaseReflectivity },
+      { R::SecondaryVirtualMotionVector, "Secondary Virtual Motion Vector", "GBuffer", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryVirtualWorldShadingNormalPerceptualRoughness, "Secondary Virtual World Shading Normal Perceptual Roughness", "GBuffer", S::Downscaled, VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryVirtualWorldShadingNormalPerceptualRoughnessDenoising, "Secondary Virtual World Shading Normal Perceptual Roughness Denoising", "GBuffer", S::Downscaled, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryHitDistance, "Secondary Hit Distance", "GBuffer", S::Downscaled, VK_FORMAT_R32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryViewDirection, "Secondary View Direction", "GBuffer", S::Downscaled, VK_FORMAT_R16G16_SNORM, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryConeRadius, "Secondary Cone Radius", "GBuffer", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::RtxdiConfidence0 },
+      { R::SecondaryWorldPositionWorldTriangleNormal, "Secondary World Position World Triangle Normal", "GBuffer", S::Downscaled, VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryPositionError, "Secondary Position Error", "GBuffer", S::Downscaled, VK_FORMAT_R32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::DecalMaterial, "Decal Material", "GBuffer", S::Downscaled, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::DecalEmissiveRadiance, "Decal Emissive Radiance", "GBuffer", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::AlphaBlendGBuffer, "Alpha Blend GBuffer", "GBuffer", S::Downscaled, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::AlphaBlendRadiance, "Alpha Blend Radiance", "Integrator", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::SecondaryVirtualMotionVector },
+      { R::IndirectRadianceHitDistance, "Indirect Radiance Hit Distance", "Integrator", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::DecalEmissiveRadiance },
+      { R::PrimaryDirectDiffuseRadiance, "Primary Direct Diffuse Radiance", "Denoiser", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryDirectSpecularRadiance, "Primary Direct Specular Radiance", "Denoiser", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimaryIndirectDiffuseRadiance, "Primary Indirect Diffuse Radiance Hit Distance", "Denoiser", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::DecalEmissiveRadiance },
+      { R::PrimaryIndirectSpecularRadiance, "Primary Indirect Specular Radiance", "Denoiser", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryCombinedDiffuseRadiance, "Secondary Combined Diffuse Radiance", "Denoiser", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::SecondaryCombinedSpecularRadiance, "Secondary Combined Specular Radiance", "Denoiser", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::GbufferPSRData0, "GBuffer PSR Data 0", "GBuffer", S::Downscaled, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_UNDEFINED, 1, R::DecalMaterial },
+      { R::GbufferPSRData1, "GBuffer PSR Data 1", "GBuffer", S::Downscaled, VK_FORMAT_R32G32_UINT, VK_FORMAT_UNDEFINED, 1, R::DecalEmissiveRadiance },
+      { R::GbufferPSRData2, "GBuffer PSR Data 2", "GBuffer", S::Downscaled, VK_FORMAT_R32G32_UINT, VK_FORMAT_UNDEFINED, 1, R::PrimaryDirectDiffuseRadiance },
+      { R::GbufferPSRData3, "GBuffer PSR Data 3", "GBuffer", S::Downscaled, VK_FORMAT_R32G32_UINT, VK_FORMAT_UNDEFINED, 1, R::PrimaryDirectSpecularRadiance },
+      { R::GbufferPSRData4, "GBuffer PSR Data 4", "GBuffer", S::Downscaled, VK_FORMAT_R32G32_UINT, VK_FORMAT_UNDEFINED, 1, R::PrimaryIndirectSpecularRadiance },
+      { R::GbufferPSRData5, "GBuffer PSR Data 5", "GBuffer", S::Downscaled, VK_FORMAT_R32G32_UINT, VK_FORMAT_UNDEFINED, 1, R::SecondaryCombinedDiffuseRadiance },
+      { R::GbufferPSRData6, "GBuffer PSR Data 6", "GBuffer", S::Downscaled, VK_FORMAT_R32G32_UINT, VK_FORMAT_UNDEFINED, 1, R::SecondaryCombinedSpecularRadiance },
+      { R::IndirectRayOriginDirection, "Indirect Ray Origin Direction", "Integrator", S::Downscaled, VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::SecondaryWorldPositionWorldTriangleNormal },
+      { R::IndirectThroughputConeRadius, "Indirect Throughput Cone Radius", "Integrator", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::DecalEmissiveRadiance },
+      { R::IndirectFirstSampledLobeAndSolidAnglePdf, "Indirect First Sampled Lobe And Solid Angle Pdf", "Integrator", S::Downscaled, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::SecondaryViewDirection },
+      { R::IndirectFirstHitPerceptualRoughness, "Indirect First Hit Perceptual Roughness", "Integrator", S::Downscaled, VK_FORMAT_R8_UNORM, VK_FORMAT_UNDEFINED, 1, R::SecondaryPerceptualRoughness },
+      { R::BsdfFactor, "BSDF Factor", "Integrator", S::Downscaled, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::BsdfFactor2, "BSDF Factor 2", "Integrator", S::Downscaled, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::CompositeOutput, "Composite Output", "Composite", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::LastCompositeOutput, "Last Composite Output", "Composite", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::GbufferLast, "GBuffer Last", "RTXDI", S::Downscaled, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::ReprojectionConfidence, "Reprojection Confidence", "RTXDI", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::RtxdiConfidence0, "RTXDI Confidence 0", "RTXDI", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::RtxdiConfidence1, "RTXDI Confidence 1", "RTXDI", S::Downscaled, VK_FORMAT_R16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::RtxdiGradients, "RTXDI Gradients", "RTXDI", S::RtxdiGradients, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED, 2, R::Count },
+      { R::RtxdiBestLights, "RTXDI Best Lights", "RTXDI", S::RtxdiGradients, VK_FORMAT_R16G16_UINT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::RestirGIRadiance, "ReSTIR GI Radiance", "ReSTIR GI", S::Downscaled, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::CompositeOutput },
+      { R::RestirGIHitGeometry, "ReSTIR GI Hit Geometry", "ReSTIR GI", S::Downscaled, VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_UNDEFINED, 1, R::Count },
+      { R::PrimarySurfaceFlagsIntermediateTexture1, "Primary Surface Flags Intermediate Texture 1", "Post Effects", S::Downscaled, VK_FORMAT_R8_UINT, VK_FORMAT_UNDEFINED, 1, R::SecondaryPerceptualRoughness },
+      { R::PrimarySurfaceFlagsIntermediateTexture2, "Primary Surface Flags Intermediate Texture 2", "Post Effects", S::Downscaled, VK_FORMAT_R8_UINT, VK_FORMAT_UNDEFINED, 1, R::SharedBiasCurrentColorMask },
+      { R::FinalOutput, "Final Output", "Output", S::Target, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_B10G11R11_UFLOAT_PACK32, 1, R::Count },
+      { R::PostFxIntermediateTexture, "Post Effects Intermediate", "Post Effects", S::Target, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_B10G11R11_UFLOAT_PACK32, 1, R::Count },
+    }};
+  }
+
+  const RtxOutputResourceDesc& getRtxOutputResourceDesc(RtxOutputResource id) {
+    const RtxOutputResourceDesc& desc = s_outputResources[size_t(id)];
+    assert(desc.id == id && "Output resource table is out of order.");
+    return desc;
+  }
+
+  VkExtent3D getRtxOutputResourceExtent(RtxOutputResource id, const RtxOutputExtents& extents) {
+    switch (getRtxOutputResourceDesc(id).scale) {
+    default:
+    case RtxOutputScale::Downscaled:
+      return extents.downscaled;
+    case RtxOutputScale::Target:
+      return extents.target;
+    case RtxOutputScale::FroxelVolume:
+      return extents.froxelVolume;
+    case RtxOutputScale::FroxelVolumes:
+      return VkExtent3D { extents.froxelVolume.width * extents.numFroxelVolumes, extents.froxelVolume.height, extents.froxelVolume.depth };
+    case RtxOutputScale::RtxdiGradients:
+      return VkExtent3D {
+        (extents.downscaled.width + extents.rtxdiGradientFactor - 1) / extents.rtxdiGradientFactor,
+        (extents.downscaled.height + extents.rtxdiGradientFactor - 1) / extents.rtxdiGradientFactor,
+        1 };
+    }
+  }
+
+  RtxOutputMemoryReport computeRtxOutputMemoryReport(const RtxOutputExtents& extents) {
+    RtxOutputMemoryReport report;
+
+    for (const RtxOutputResourceDesc& desc : s_outputResources) {
+      if (!desc.ownsMemory()) {
+        continue;
+      }
+
+      const VkExtent3D extent = getRtxOutputResourceExtent(desc.id, extents);
+      const uint64_t texels = uint64_t(extent.width) * extent.height * extent.depth * desc.numLayers;
+      const VkFormat compactFormat = desc.compactFormat != VK_FORMAT_UNDEFINED ? desc.compactFormat : desc.format;
+
+      RtxOutputMemoryReport::Entry entry;
+      entry.id = desc.id;
+      entry.extent = extent;
+      entry.bytes = texels * imageFormatInfo(desc.format)->elementSize;
+      entry.compactBytes = texels * imageFormatInfo(compactFormat)->elementSize;
+
+      report.entries.push_back(entry);
+      report.totalBytes += entry.bytes;
+      report.compactTotalBytes += entry.compactBytes;
+
+      auto passTotal = report.passTotals.begin();
+
+      while (passTotal != report.passTotals.end() && strcmp(passTotal->pass, desc.pass) != 0) {
+        ++passTotal;
+      }
+
+      if (passTotal == report.passTotals.end()) {
+        report.passTotals.push_back({ desc.pass, 0 });
+        passTotal = report.passTotals.end() - 1;
+      }
+
+      passTotal->bytes += entry.bytes;
+    }
+
+    return report;
+  }
+}
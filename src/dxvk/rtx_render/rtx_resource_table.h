@@ -0,0 +1,213 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "vulkan/vulkan_core.h"
+
+namespace dxvk {
+  // Render targets created for the ray tracing output, in the order they are created.
+  // Note: Keep in sync with the descriptor table in rtx_resource_table.cpp.
+  enum class RtxOutputResource : uint32_t {
+    // Volumetrics
+    VolumePreintegratedRadiance,
+    VolumeReservoirs0,
+    VolumeReservoirs1,
+    VolumeAccumulatedRadiance0,
+    VolumeAccumulatedRadiance1,
+    VolumeFilteredRadiance,
+
+    // GBuffer
+    SharedFlags,
+    SharedRadianceRG,
+    SharedRadianceB,
+    SharedMaterialData0,
+    SharedMaterialData1,
+    SharedMediumMaterialIndex,
+    SharedBiasCurrentColorMask,
+    SharedIntegrationSurfacePdf,
+
+    PrimaryAttenuation,
+    PrimaryWorldShadingNormal,
+    PrimaryWorldInterpolatedNormal,
+    PrimaryPerceptualRoughness,
+    PrimaryLinearViewZ,
+    PrimaryDepth,
+    PrimaryAlbedo,
+    PrimaryBaseReflectivity,
+    PrimarySpecularAlbedo,
+    PrimaryVirtualMotionVector,
+    PrimaryScreenSpaceMotionVector,
+    PrimaryVirtualWorldShadingNormalPerceptualRoughness,
+    PrimaryVirtualWorldShadingNormalPerceptualRoughnessDenoising,
+    PrimaryHitDistance,
+    PrimaryViewDirection,
+    PrimaryConeRadius,
+    PrimaryWorldPositionWorldTriangleNormal0,
+    PrimaryWorldPositionWorldTriangleNormal1,
+    PrimaryPositionError,
+    PrimaryRtxdiIlluminance0,
+    PrimaryRtxdiIlluminance1,
+    PrimaryRtxdiTemporalPosition,
+    PrimarySurfaceFlags,
+    PrimaryDisocclusionThresholdMix,
+
+    SecondaryAttenuation,
+    SecondaryWorldShadingNormal,
+    SecondaryPerceptualRoughness,
+    SecondaryLinearViewZ,
+    SecondaryAlbedo,
+    SecondaryBaseReflectivity,
+    SecondarySpecularAlbedo,
+    SecondaryVirtualMotionVector,
+    SecondaryVirtualWorldShadingNormalPerceptualRoughness,
+    SecondaryVirtualWorldShadingNormalPerceptualRoughnessDenoising,
+    SecondaryHitDistance,
+    SecondaryViewDirection,
+    SecondaryConeRadius,
+    SecondaryWorldPositionWorldTriangleNormal,
+    SecondaryPositionError,
+    DecalMaterial,
+    DecalEmissiveRadiance,
+    AlphaBlendGBuffer,
+    AlphaBlendRadiance,
+    IndirectRadianceHitDistance,
+
+    // Denoiser input and output
+    PrimaryDirectDiffuseRadiance,
+    PrimaryDirectSpecularRadiance,
+    PrimaryIndirectDiffuseRadiance,
+    PrimaryIndirectSpecularRadiance,
+    SecondaryCombinedDiffuseRadiance,
+    SecondaryCombinedSpecularRadiance,
+
+    GbufferPSRData0,
+    GbufferPSRData1,
+    GbufferPSRData2,
+    GbufferPSRData3,
+    GbufferPSRData4,
+    GbufferPSRData5,
+    GbufferPSRData6,
+
+    // Integrator
+    IndirectRayOriginDirection,
+    IndirectThroughputConeRadius,
+    IndirectFirstSampledLobeAndSolidAnglePdf,
+    IndirectFirstHitPerceptualRoughness,
+    BsdfFactor,
+    BsdfFactor2,
+
+    // Composite
+    CompositeOutput,
+    LastCompositeOutput,
+
+    // RTXDI
+    GbufferLast,
+    ReprojectionConfidence,
+    RtxdiConfidence0,
+    RtxdiConfidence1,
+    RtxdiGradients,
+    RtxdiBestLights,
+
+    // ReSTIR GI
+    RestirGIRadiance,
+    RestirGIHitGeometry,
+
+    // Post effects
+    PrimarySurfaceFlagsIntermediateTexture1,
+    PrimarySurfaceFlagsIntermediateTexture2,
+
+    // Target resolution
+    FinalOutput,
+    PostFxIntermediateTexture,
+
+    Count
+  };
+
+  // Resolution a render target is allocated at
+  enum class RtxOutputScale : uint8_t {
+    Downscaled,     // Render resolution
+    Target,         // Output resolution
+    FroxelVolume,   // Froxel grid of the main volume
+    FroxelVolumes,  // Froxel grids of all volumes side by side
+    RtxdiGradients  // Render resolution divided by the RTXDI gradient factor
+  };
+
+  struct RtxOutputResourceDesc {
+    RtxOutputResource id;
+    const char* name;
+    const char* pass;           // Pass owning the resource
+    RtxOutputScale scale;
+    VkFormat format;
+    // Narrower format the contents could be stored in, or VK_FORMAT_UNDEFINED if there is none.
+    // Note: Informational only, as the shaders declare the storage format of each binding.
+    VkFormat compactFormat;
+    uint32_t numLayers;
+    // Resource whose memory this one aliases, or Count if it owns its memory
+    RtxOutputResource aliasOf;
+
+    bool ownsMemory() const {
+      return aliasOf == RtxOutputResource::Count;
+    }
+
+    bool is3D() const {
+      return scale == RtxOutputScale::FroxelVolume || scale == RtxOutputScale::FroxelVolumes;
+    }
+  };
+
+  struct RtxOutputExtents {
+    VkExtent3D downscaled = { 0, 0, 0 };
+    VkExtent3D target = { 0, 0, 0 };
+    VkExtent3D froxelVolume = { 0, 0, 0 };
+    uint32_t numFroxelVolumes = 1;
+    uint32_t rtxdiGradientFactor = 1;
+  };
+
+  // Memory used by the render targets for a given set of extents. Sizes are texel data only, so
+  // allocations may be somewhat larger due to alignment and padding the driver applies.
+  struct RtxOutputMemoryReport {
+    struct Entry {
+      RtxOutputResource id;
+      VkExtent3D extent;
+      uint64_t bytes;
+      uint64_t compactBytes;  // Size in the compact format, equal to bytes if there is none
+    };
+
+    struct PassTotal {
+      const char* pass;
+      uint64_t bytes;
+    };
+
+    std::vector<Entry> entries;         // Resources owning memory, aliases share the memory of their target
+    std::vector<PassTotal> passTotals;  // In order of first appearance in the table
+    uint64_t totalBytes = 0;
+    uint64_t compactTotalBytes = 0;
+  };
+
+  const RtxOutputResourceDesc& getRtxOutputResourceDesc(RtxOutputResource id);
+
+  VkExtent3D getRtxOutputResourceExtent(RtxOutputResource id, const RtxOutputExtents& extents);
+
+  RtxOutputMemoryReport computeRtxOutputMemoryReport(const RtxOutputExtents& extents);
+}
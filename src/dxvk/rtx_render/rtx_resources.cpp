@@ -296,6 +296,8 @@ namespace dxvk {
 
       createTargetResources(ctx);
     }
+
+    logOutputMemoryReport();
   }
 
   bool Resources::validateRaytracingOutput(const VkExtent3D& downscaledExtent, const VkExtent3D& targetExtent) const {
@@ -305,9 +307,11 @@ namespace dxvk {
   void Resources::onFrameBegin(Rc<DxvkContext> ctx, const VkExtent3D& downscaledExtents, const VkExtent3D& targetExtent) {
     executeFrameBeginEventList(m_onFrameBegin, ctx, downscaledExtents, targetExtent);
 
+    using R = RtxOutputResource;
+
     // Alias resources that alias to different resources frame to frame
-    m_raytracingOutput.m_secondaryConeRadius = AliasedResource(m_raytracingOutput.getCurrentRtxdiConfidence(), ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT, "Secondary Cone Radius");
-    m_raytracingOutput.m_sharedIntegrationSurfacePdf = AliasedResource(m_raytracingOutput.getCurrentRtxdiIlluminance(), ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT, "Shared Integration Surface PDF");
+    m_raytracingOutput.m_secondaryConeRadius = createOutputAliasedResource(m_raytracingOutput.getCurrentRtxdiConfidence(), ctx, R::SecondaryConeRadius);
+    m_raytracingOutput.m_sharedIntegrationSurfacePdf = createOutputAliasedResource(m_raytracingOutput.getCurrentRtxdiIlluminance(), ctx, R::SharedIntegrationSurfacePdf);
     assert(
       m_raytracingOutput.m_secondaryConeRadius.sharesTheSameView(m_raytracingOutput.getCurrentRtxdiConfidence()) &&
       m_raytracingOutput.m_sharedIntegrationSurfacePdf.sharesTheSameView(m_raytracingOutput.getCurrentRtxdiIlluminance()) &&
@@ -676,6 +680,8 @@ namespace dxvk {
   void Resources::createDownscaledResources(Rc<DxvkContext>& ctx) {
     Logger::debug("Render resolution changed, recreating rendering resources");
 
+    using R = RtxOutputResource;
+
     // Explicit constant to make it clear where cross format aliasing occurs. 
     // Changing it to false requires further changes below.
     const bool allowCompatibleFormatAliasing = true;
@@ -689,129 +695,120 @@ namespace dxvk {
     m_raytracingOutput.m_froxelVolumeExtent.depth = RtxOptions::Get()->getFroxelDepthSlices();
     m_raytracingOutput.m_numFroxelVolumes = RtxOptions::Get()->enableVolumetricsInPortals() ? maxRayPortalCount + 1 : 1;
 
-    VkExtent3D froxelGridFullDimensions = m_raytracingOutput.m_froxelVolumeExtent;
     // Note: preintegrated radiance is only computed for one (main) volume, not all of them
-    m_raytracingOutput.m_volumePreintegratedRadiance = createImageResource(ctx, froxelGridFullDimensions, VK_FORMAT_B10G11R11_UFLOAT_PACK32, 1, VK_IMAGE_TYPE_3D, VK_IMAGE_VIEW_TYPE_3D);
-
-    froxelGridFullDimensions.width *= m_raytracingOutput.m_numFroxelVolumes;
-
-    m_raytracingOutput.m_volumeReservoirs[0] = createImageResource(ctx, froxelGridFullDimensions, VK_FORMAT_R32G32B32A32_UINT, 1, VK_IMAGE_TYPE_3D, VK_IMAGE_VIEW_TYPE_3D);
-    m_raytracingOutput.m_volumeReservoirs[1] = createImageResource(ctx, froxelGridFullDimensions, VK_FORMAT_R32G32B32A32_UINT, 1, VK_IMAGE_TYPE_3D, VK_IMAGE_VIEW_TYPE_3D);
+    m_raytracingOutput.m_volumePreintegratedRadiance = createOutputResource(ctx, R::VolumePreintegratedRadiance);
+    m_raytracingOutput.m_volumeReservoirs[0] = createOutputResource(ctx, R::VolumeReservoirs0);
+    m_raytracingOutput.m_volumeReservoirs[1] = createOutputResource(ctx, R::VolumeReservoirs1);
     // Note: RGBA16 used here as R11G11B10 develops precision issues when accumulated over many frames. Luckily can make use of 16 bit alpha
     // channel to store additional information however (such as the history age, previously we'd want this in its own texture so it could be
     // sampled from exactly whereas the radiance would be interpolated, but interpolating the history age is likely a better estimation of the
     // actual age anyways, though do note this is fairly wasteful as the history age only needs to be 8-ish bits).
-    m_raytracingOutput.m_volumeAccumulatedRadiance[0] = createImageResource(ctx, froxelGridFullDimensions, VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_IMAGE_TYPE_3D, VK_IMAGE_VIEW_TYPE_3D);
-    m_raytracingOutput.m_volumeAccumulatedRadiance[1] = createImageResource(ctx, froxelGridFullDimensions, VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_IMAGE_TYPE_3D, VK_IMAGE_VIEW_TYPE_3D);
-    m_raytracingOutput.m_volumeFilteredRadiance = createImageResource(ctx, froxelGridFullDimensions, VK_FORMAT_B10G11R11_UFLOAT_PACK32, 1, VK_IMAGE_TYPE_3D, VK_IMAGE_VIEW_TYPE_3D);
+    m_raytracingOutput.m_volumeAccumulatedRadiance[0] = createOutputResource(ctx, R::VolumeAccumulatedRadiance0);
+    m_raytracingOutput.m_volumeAccumulatedRadiance[1] = createOutputResource(ctx, R::VolumeAccumulatedRadiance1);
+    m_raytracingOutput.m_volumeFilteredRadiance = createOutputResource(ctx, R::VolumeFilteredRadiance);
 
     // GBuffer (Primary/Secondary Surfaces)
-    m_raytracingOutput.m_sharedFlags = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16_UINT);
+    m_raytracingOutput.m_sharedFlags = createOutputResource(ctx, R::SharedFlags);
     // Note: Could be B10G11R11_UFLOAT_PACK32 potentially if the precision of that is acceptable for the shared radiance.
     // Otherwise we split the channels like this to reduce memory usage (as no 3 component 16 bit float formats are very well supported),
     // this is fine because we only read/write to this texture in a coherent way so bringing in 2x many cachelines is not a problem (versus
     // random access reads where they would be a problem).
-    m_raytracingOutput.m_sharedRadianceRG = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16_SFLOAT);
-    m_raytracingOutput.m_sharedRadianceB = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT);
-    m_raytracingOutput.m_sharedMaterialData0 = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
-    m_raytracingOutput.m_sharedMaterialData1 = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
+    m_raytracingOutput.m_sharedRadianceRG = createOutputResource(ctx, R::SharedRadianceRG);
+    m_raytracingOutput.m_sharedRadianceB = createOutputResource(ctx, R::SharedRadianceB);
+    m_raytracingOutput.m_sharedMaterialData0 = createOutputResource(ctx, R::SharedMaterialData0);
+    m_raytracingOutput.m_sharedMaterialData1 = createOutputResource(ctx, R::SharedMaterialData1);
     // Note: This value is isolated rather than being packed with other data (such as the alpha channel combined with the Shared Radiance RGB) so that
     // reads/writes to it do not bring in extra unneeded data into the cachelines (as we don't need that shared radiance information except in compositing).
-    m_raytracingOutput.m_sharedMediumMaterialIndex = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16_UINT);
-    m_raytracingOutput.m_sharedBiasCurrentColorMask = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R8_UNORM, "Shared Attenuation", allowCompatibleFormatAliasing);
-
-    m_raytracingOutput.m_primaryAttenuation = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
-    m_raytracingOutput.m_primaryWorldShadingNormal = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
-    m_raytracingOutput.m_primaryWorldInterpolatedNormal = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
-    m_raytracingOutput.m_primaryPerceptualRoughness = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R8_UNORM);
-    m_raytracingOutput.m_primaryLinearViewZ = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_SFLOAT);
-    m_raytracingOutput.m_primaryDepth = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_SFLOAT);
-    m_raytracingOutput.m_primaryAlbedo = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32);
-    m_raytracingOutput.m_primaryBaseReflectivity = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32, "Primary Base Reflectivity");
-    m_raytracingOutput.m_primarySpecularAlbedo = AliasedResource(m_raytracingOutput.m_primaryBaseReflectivity, ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32, "Primary Specular Albedo");
-    m_raytracingOutput.m_primaryVirtualMotionVector = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT);
-    m_raytracingOutput.m_primaryScreenSpaceMotionVector = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16_SFLOAT);
-    m_raytracingOutput.m_primaryVirtualWorldShadingNormalPerceptualRoughness = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_UNORM);
-    m_raytracingOutput.m_primaryVirtualWorldShadingNormalPerceptualRoughnessDenoising = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32);
-    m_raytracingOutput.m_primaryHitDistance = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_SFLOAT);
-    m_raytracingOutput.m_primaryViewDirection = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16_SNORM);
-    m_raytracingOutput.m_primaryConeRadius = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT);
-    m_raytracingOutput.m_primaryWorldPositionWorldTriangleNormal[0] = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_SFLOAT);
-    m_raytracingOutput.m_primaryWorldPositionWorldTriangleNormal[1] = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_SFLOAT);
-    m_raytracingOutput.m_primaryPositionError = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_SFLOAT);
+    m_raytracingOutput.m_sharedMediumMaterialIndex = createOutputResource(ctx, R::SharedMediumMaterialIndex);
+    m_raytracingOutput.m_sharedBiasCurrentColorMask = createOutputAliasedResource(ctx, R::SharedBiasCurrentColorMask, allowCompatibleFormatAliasing);
+
+    m_raytracingOutput.m_primaryAttenuation = createOutputResource(ctx, R::PrimaryAttenuation);
+    m_raytracingOutput.m_primaryWorldShadingNormal = createOutputResource(ctx, R::PrimaryWorldShadingNormal);
+    m_raytracingOutput.m_primaryWorldInterpolatedNormal = createOutputResource(ctx, R::PrimaryWorldInterpolatedNormal);
+    m_raytracingOutput.m_primaryPerceptualRoughness = createOutputResource(ctx, R::PrimaryPerceptualRoughness);
+    m_raytracingOutput.m_primaryLinearViewZ = createOutputResource(ctx, R::PrimaryLinearViewZ);
+    m_raytracingOutput.m_primaryDepth = createOutputResource(ctx, R::PrimaryDepth);
+    m_raytracingOutput.m_primaryAlbedo = createOutputResource(ctx, R::PrimaryAlbedo);
+    m_raytracingOutput.m_primaryBaseReflectivity = createOutputAliasedResource(ctx, R::PrimaryBaseReflectivity);
+    m_raytracingOutput.m_primarySpecularAlbedo = createOutputAliasedResource(m_raytracingOutput.m_primaryBaseReflectivity, ctx, R::PrimarySpecularAlbedo);
+    m_raytracingOutput.m_primaryVirtualMotionVector = createOutputResource(ctx, R::PrimaryVirtualMotionVector);
+    m_raytracingOutput.m_primaryScreenSpaceMotionVector = createOutputResource(ctx, R::PrimaryScreenSpaceMotionVector);
+    m_raytracingOutput.m_primaryVirtualWorldShadingNormalPerceptualRoughness = createOutputResource(ctx, R::PrimaryVirtualWorldShadingNormalPerceptualRoughness);
+    m_raytracingOutput.m_primaryVirtualWorldShadingNormalPerceptualRoughnessDenoising = createOutputResource(ctx, R::PrimaryVirtualWorldShadingNormalPerceptualRoughnessDenoising);
+    m_raytracingOutput.m_primaryHitDistance = createOutputResource(ctx, R::PrimaryHitDistance);
+    m_raytracingOutput.m_primaryViewDirection = createOutputResource(ctx, R::PrimaryViewDirection);
+    m_raytracingOutput.m_primaryConeRadius = createOutputResource(ctx, R::PrimaryConeRadius);
+    m_raytracingOutput.m_primaryWorldPositionWorldTriangleNormal[0] = createOutputResource(ctx, R::PrimaryWorldPositionWorldTriangleNormal0);
+    m_raytracingOutput.m_primaryWorldPositionWorldTriangleNormal[1] = createOutputResource(ctx, R::PrimaryWorldPositionWorldTriangleNormal1);
+    m_raytracingOutput.m_primaryPositionError = createOutputResource(ctx, R::PrimaryPositionError);
     
-    m_raytracingOutput.m_primaryRtxdiIlluminance[0] = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT, "Primary RTXDI Illuminance [0]");
-    m_raytracingOutput.m_primaryRtxdiIlluminance[1] = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT, "Primary RTXDI Illuminance[1]");
-
-    m_raytracingOutput.m_primaryRtxdiTemporalPosition = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
-    m_raytracingOutput.m_primarySurfaceFlags = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R8_UINT);
-    m_raytracingOutput.m_primaryDisocclusionThresholdMix = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R8_UNORM);
-
-    m_raytracingOutput.m_secondaryAttenuation = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
-    m_raytracingOutput.m_secondaryWorldShadingNormal = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_UINT);
-    m_raytracingOutput.m_secondaryPerceptualRoughness = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R8_UNORM, "Secondary Perceptual Roughness", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_secondaryLinearViewZ = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_SFLOAT);
-    m_raytracingOutput.m_secondaryAlbedo = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32);
-    m_raytracingOutput.m_secondaryBaseReflectivity = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32, "Secondary Base Reflectivity");
-    m_raytracingOutput.m_secondarySpecularAlbedo = AliasedResource(
-    m_raytracingOutput.m_secondaryBaseReflectivity, ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32, "Secondary Specular Albedo");
-    m_raytracingOutput.m_secondaryVirtualMotionVector = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Secondary Virtual Motion Vector");
-    m_raytracingOutput.m_secondaryVirtualWorldShadingNormalPerceptualRoughness = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_UNORM);
-    m_raytracingOutput.m_secondaryVirtualWorldShadingNormalPerceptualRoughnessDenoising = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32);
-    m_raytracingOutput.m_secondaryHitDistance = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_SFLOAT);
-    m_raytracingOutput.m_secondaryViewDirection = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16_SNORM, "Secondary View Direction", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_secondaryWorldPositionWorldTriangleNormal = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_SFLOAT, "Secondary World Position World Triangle Normal", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_secondaryPositionError = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32_SFLOAT);
-    m_raytracingOutput.m_decalMaterial = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_UINT, "Decal Material");
-    m_raytracingOutput.m_decalEmissiveRadiance = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Decal Emissive Radiance", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_alphaBlendGBuffer = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_UINT);
-    m_raytracingOutput.m_alphaBlendRadiance = AliasedResource(m_raytracingOutput.m_secondaryVirtualMotionVector, ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Alpha Blend Radiance");
-    m_raytracingOutput.m_indirectRadianceHitDistance = AliasedResource(m_raytracingOutput.m_decalEmissiveRadiance, ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Indirect Radiance Hit Distance");
+    m_raytracingOutput.m_primaryRtxdiIlluminance[0] = createOutputAliasedResource(ctx, R::PrimaryRtxdiIlluminance0);
+    m_raytracingOutput.m_primaryRtxdiIlluminance[1] = createOutputAliasedResource(ctx, R::PrimaryRtxdiIlluminance1);
+
+    m_raytracingOutput.m_primaryRtxdiTemporalPosition = createOutputResource(ctx, R::PrimaryRtxdiTemporalPosition);
+    m_raytracingOutput.m_primarySurfaceFlags = createOutputResource(ctx, R::PrimarySurfaceFlags);
+    m_raytracingOutput.m_primaryDisocclusionThresholdMix = createOutputResource(ctx, R::PrimaryDisocclusionThresholdMix);
+
+    m_raytracingOutput.m_secondaryAttenuation = createOutputResource(ctx, R::SecondaryAttenuation);
+    m_raytracingOutput.m_secondaryWorldShadingNormal = createOutputResource(ctx, R::SecondaryWorldShadingNormal);
+    m_raytracingOutput.m_secondaryPerceptualRoughness = createOutputAliasedResource(ctx, R::SecondaryPerceptualRoughness, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_secondaryLinearViewZ = createOutputResource(ctx, R::SecondaryLinearViewZ);
+    m_raytracingOutput.m_secondaryAlbedo = createOutputResource(ctx, R::SecondaryAlbedo);
+    m_raytracingOutput.m_secondaryBaseReflectivity = createOutputAliasedResource(ctx, R::SecondaryBaseReflectivity);
+    m_raytracingOutput.m_secondarySpecularAlbedo = createOutputAliasedResource(m_raytracingOutput.m_secondaryBaseReflectivity, ctx, R::SecondarySpecularAlbedo);
+    m_raytracingOutput.m_secondaryVirtualMotionVector = createOutputAliasedResource(ctx, R::SecondaryVirtualMotionVector);
+    m_raytracingOutput.m_secondaryVirtualWorldShadingNormalPerceptualRoughness = createOutputResource(ctx, R::SecondaryVirtualWorldShadingNormalPerceptualRoughness);
+    m_raytracingOutput.m_secondaryVirtualWorldShadingNormalPerceptualRoughnessDenoising = createOutputResource(ctx, R::SecondaryVirtualWorldShadingNormalPerceptualRoughnessDenoising);
+    m_raytracingOutput.m_secondaryHitDistance = createOutputResource(ctx, R::SecondaryHitDistance);
+    m_raytracingOutput.m_secondaryViewDirection = createOutputAliasedResource(ctx, R::SecondaryViewDirection, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_secondaryWorldPositionWorldTriangleNormal = createOutputAliasedResource(ctx, R::SecondaryWorldPositionWorldTriangleNormal, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_secondaryPositionError = createOutputResource(ctx, R::SecondaryPositionError);
+    m_raytracingOutput.m_decalMaterial = createOutputAliasedResource(ctx, R::DecalMaterial);
+    m_raytracingOutput.m_decalEmissiveRadiance = createOutputAliasedResource(ctx, R::DecalEmissiveRadiance, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_alphaBlendGBuffer = createOutputResource(ctx, R::AlphaBlendGBuffer);
+    m_raytracingOutput.m_alphaBlendRadiance = createOutputAliasedResource(m_raytracingOutput.m_secondaryVirtualMotionVector, ctx, R::AlphaBlendRadiance);
+    m_raytracingOutput.m_indirectRadianceHitDistance = createOutputAliasedResource(m_raytracingOutput.m_decalEmissiveRadiance, ctx, R::IndirectRadianceHitDistance);
 
     // Denoiser input and output (Primary/Secondary Surfaces with Direct/Indirect or Combined Radiance)
     // Note: A single texture is aliased for both the noisy output from the integration pass and the denoised result from NRD.
-    m_raytracingOutput.m_primaryDirectDiffuseRadiance = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Primary Direct Diffuse Radiance", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_primaryDirectSpecularRadiance = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Primary Direct Specular Radiance", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_primaryIndirectDiffuseRadiance = AliasedResource(m_raytracingOutput.m_decalEmissiveRadiance, ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Primary Indirect Diffuse Radiance Hit Distance");
-    m_raytracingOutput.m_primaryIndirectSpecularRadiance = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Primary Indirect Specular Radiance", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_secondaryCombinedDiffuseRadiance = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Secondary Combined Diffuse Radiance", allowCompatibleFormatAliasing);
-    m_raytracingOutput.m_secondaryCombinedSpecularRadiance = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Secondary Combined Specular Radiance", allowCompatibleFormatAliasing);
-
-    m_raytracingOutput.m_gbufferPSRData[0] = AliasedResource(m_raytracingOutput.m_decalMaterial, ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_UINT, "GBuffer PSR Data 0");
-    m_raytracingOutput.m_gbufferPSRData[1] = AliasedResource(m_raytracingOutput.m_decalEmissiveRadiance, ctx, m_downscaledExtent, VK_FORMAT_R32G32_UINT, "GBuffer PSR Data 1");
-    m_raytracingOutput.m_gbufferPSRData[2] = AliasedResource(m_raytracingOutput.m_primaryDirectDiffuseRadiance, ctx, m_downscaledExtent, VK_FORMAT_R32G32_UINT, "GBuffer PSR Data 2");
-    m_raytracingOutput.m_gbufferPSRData[3] = AliasedResource(m_raytracingOutput.m_primaryDirectSpecularRadiance, ctx, m_downscaledExtent, VK_FORMAT_R32G32_UINT, "GBuffer PSR Data 3");
-    m_raytracingOutput.m_gbufferPSRData[4] = AliasedResource(m_raytracingOutput.m_primaryIndirectSpecularRadiance, ctx, m_downscaledExtent, VK_FORMAT_R32G32_UINT, "GBuffer PSR Data 4");
-    m_raytracingOutput.m_gbufferPSRData[5] = AliasedResource(m_raytracingOutput.m_secondaryCombinedDiffuseRadiance, ctx, m_downscaledExtent, VK_FORMAT_R32G32_UINT, "GBuffer PSR Data 5");
-    m_raytracingOutput.m_gbufferPSRData[6] = AliasedResource(m_raytracingOutput.m_secondaryCombinedSpecularRadiance, ctx, m_downscaledExtent, VK_FORMAT_R32G32_UINT, "GBuffer PSR Data 6");
-
-    m_raytracingOutput.m_indirectRayOriginDirection = AliasedResource(
-      m_raytracingOutput.m_secondaryWorldPositionWorldTriangleNormal, ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_SFLOAT, "Indirect Ray Origin Direction");
-    m_raytracingOutput.m_indirectThroughputConeRadius = AliasedResource(
-      m_raytracingOutput.m_decalEmissiveRadiance, ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Indirect Throughput Cone Radius");
-    m_raytracingOutput.m_indirectFirstSampledLobeAndSolidAnglePdf = AliasedResource(m_raytracingOutput.m_secondaryViewDirection, ctx, m_downscaledExtent, VK_FORMAT_R16G16_SFLOAT, "Indirect First Sampled Lobe And Solid Angle Pdf");
-    m_raytracingOutput.m_indirectFirstHitPerceptualRoughness = AliasedResource(
-      m_raytracingOutput.m_secondaryPerceptualRoughness, ctx, m_downscaledExtent, VK_FORMAT_R8_UNORM, "Indirect First Hit Perceptual Roughness");
-    m_raytracingOutput.m_bsdfFactor = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16_SFLOAT);
-    m_raytracingOutput.m_bsdfFactor2 = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16_SFLOAT);
+    m_raytracingOutput.m_primaryDirectDiffuseRadiance = createOutputAliasedResource(ctx, R::PrimaryDirectDiffuseRadiance, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_primaryDirectSpecularRadiance = createOutputAliasedResource(ctx, R::PrimaryDirectSpecularRadiance, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_primaryIndirectDiffuseRadiance = createOutputAliasedResource(m_raytracingOutput.m_decalEmissiveRadiance, ctx, R::PrimaryIndirectDiffuseRadiance);
+    m_raytracingOutput.m_primaryIndirectSpecularRadiance = createOutputAliasedResource(ctx, R::PrimaryIndirectSpecularRadiance, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_secondaryCombinedDiffuseRadiance = createOutputAliasedResource(ctx, R::SecondaryCombinedDiffuseRadiance, allowCompatibleFormatAliasing);
+    m_raytracingOutput.m_secondaryCombinedSpecularRadiance = createOutputAliasedResource(ctx, R::SecondaryCombinedSpecularRadiance, allowCompatibleFormatAliasing);
+
+    m_raytracingOutput.m_gbufferPSRData[0] = createOutputAliasedResource(m_raytracingOutput.m_decalMaterial, ctx, R::GbufferPSRData0);
+    m_raytracingOutput.m_gbufferPSRData[1] = createOutputAliasedResource(m_raytracingOutput.m_decalEmissiveRadiance, ctx, R::GbufferPSRData1);
+    m_raytracingOutput.m_gbufferPSRData[2] = createOutputAliasedResource(m_raytracingOutput.m_primaryDirectDiffuseRadiance, ctx, R::GbufferPSRData2);
+    m_raytracingOutput.m_gbufferPSRData[3] = createOutputAliasedResource(m_raytracingOutput.m_primaryDirectSpecularRadiance, ctx, R::GbufferPSRData3);
+    m_raytracingOutput.m_gbufferPSRData[4] = createOutputAliasedResource(m_raytracingOutput.m_primaryIndirectSpecularRadiance, ctx, R::GbufferPSRData4);
+    m_raytracingOutput.m_gbufferPSRData[5] = createOutputAliasedResource(m_raytracingOutput.m_secondaryCombinedDiffuseRadiance, ctx, R::GbufferPSRData5);
+    m_raytracingOutput.m_gbufferPSRData[6] = createOutputAliasedResource(m_raytracingOutput.m_secondaryCombinedSpecularRadiance, ctx, R::GbufferPSRData6);
+
+    m_raytracingOutput.m_indirectRayOriginDirection = createOutputAliasedResource(m_raytracingOutput.m_secondaryWorldPositionWorldTriangleNormal, ctx, R::IndirectRayOriginDirection);
+    m_raytracingOutput.m_indirectThroughputConeRadius = createOutputAliasedResource(m_raytracingOutput.m_decalEmissiveRadiance, ctx, R::IndirectThroughputConeRadius);
+    m_raytracingOutput.m_indirectFirstSampledLobeAndSolidAnglePdf = createOutputAliasedResource(m_raytracingOutput.m_secondaryViewDirection, ctx, R::IndirectFirstSampledLobeAndSolidAnglePdf);
+    m_raytracingOutput.m_indirectFirstHitPerceptualRoughness = createOutputAliasedResource(m_raytracingOutput.m_secondaryPerceptualRoughness, ctx, R::IndirectFirstHitPerceptualRoughness);
+    m_raytracingOutput.m_bsdfFactor = createOutputResource(ctx, R::BsdfFactor);
+    m_raytracingOutput.m_bsdfFactor2 = createOutputResource(ctx, R::BsdfFactor2);
 
     // Final Output
-    m_raytracingOutput.m_compositeOutput = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Composite Output");
+    m_raytracingOutput.m_compositeOutput = createOutputAliasedResource(ctx, R::CompositeOutput);
     m_raytracingOutput.m_compositeOutputExtent = m_downscaledExtent;
-    m_raytracingOutput.m_lastCompositeOutput = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "Last Composite Output");
+    m_raytracingOutput.m_lastCompositeOutput = createOutputAliasedResource(ctx, R::LastCompositeOutput);
 
     // RTXDI Data
-    m_raytracingOutput.m_gbufferLast = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32G32_SFLOAT);
-    m_raytracingOutput.m_reprojectionConfidence = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT);
-    m_raytracingOutput.m_rtxdiConfidence[0] = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT, "RTXDI Confidence 0");
-    m_raytracingOutput.m_rtxdiConfidence[1] = AliasedResource(ctx, m_downscaledExtent, VK_FORMAT_R16_SFLOAT, "RTXDI Confidence 1");
+    m_raytracingOutput.m_gbufferLast = createOutputResource(ctx, R::GbufferLast);
+    m_raytracingOutput.m_reprojectionConfidence = createOutputResource(ctx, R::ReprojectionConfidence);
+    m_raytracingOutput.m_rtxdiConfidence[0] = createOutputAliasedResource(ctx, R::RtxdiConfidence0);
+    m_raytracingOutput.m_rtxdiConfidence[1] = createOutputAliasedResource(ctx, R::RtxdiConfidence1);
 
     // RTXDI Gradients
-    const VkExtent3D rtxDiGradientExtents = { (m_downscaledExtent.width + RTXDI_GRAD_FACTOR - 1) / RTXDI_GRAD_FACTOR, (m_downscaledExtent.height + RTXDI_GRAD_FACTOR - 1) / RTXDI_GRAD_FACTOR, 1 };
-    m_raytracingOutput.m_rtxdiGradients = createImageResource(ctx, rtxDiGradientExtents, VK_FORMAT_R16G16_SFLOAT, 2);
+    m_raytracingOutput.m_rtxdiGradients = createOutputResource(ctx, R::RtxdiGradients);
 
     // RTXDI Best Lights - using the same downscaling factor as Gradients
-    m_raytracingOutput.m_rtxdiBestLights = AliasedResource(ctx, rtxDiGradientExtents, VK_FORMAT_R16G16_UINT, "RTXDI Best Lights");
+    m_raytracingOutput.m_rtxdiBestLights = createOutputAliasedResource(ctx, R::RtxdiBestLights);
 
     int numReservoirBuffer = 3;
     int reservoirSize = sizeof(RTXDI_PackedReservoir);
@@ -830,12 +827,12 @@ namespace dxvk {
     reservoirSize = sizeof(ReSTIRGI_PackedReservoir);
     rtxdiBufferInfo.size = reservoirBufferPixels * numReservoirBuffer * reservoirSize;
     m_raytracingOutput.m_restirGIReservoirBuffer = m_device->createBuffer(rtxdiBufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer);
-    m_raytracingOutput.m_restirGIRadiance = AliasedResource(m_raytracingOutput.m_compositeOutput, ctx, m_downscaledExtent, VK_FORMAT_R16G16B16A16_SFLOAT, "ReSTIR GI Radiance");
-    m_raytracingOutput.m_restirGIHitGeometry = createImageResource(ctx, m_downscaledExtent, VK_FORMAT_R32G32B32A32_SFLOAT);
+    m_raytracingOutput.m_restirGIRadiance = createOutputAliasedResource(m_raytracingOutput.m_compositeOutput, ctx, R::RestirGIRadiance);
+    m_raytracingOutput.m_restirGIHitGeometry = createOutputResource(ctx, R::RestirGIHitGeometry);
 
     // Post Effect motion blur prefilter intermediate textures
-    m_raytracingOutput.m_primarySurfaceFlagsIntermediateTexture1 = AliasedResource(m_raytracingOutput.m_secondaryPerceptualRoughness, ctx, m_downscaledExtent, VK_FORMAT_R8_UINT, "Primary Surface Flags Intermediate Texture 1");
-    m_raytracingOutput.m_primarySurfaceFlagsIntermediateTexture2 = AliasedResource(m_raytracingOutput.m_sharedBiasCurrentColorMask, ctx, m_downscaledExtent, VK_FORMAT_R8_UINT, "Primary Surface Flags Intermediate Texture 2");
+    m_raytracingOutput.m_primarySurfaceFlagsIntermediateTexture1 = createOutputAliasedResource(m_raytracingOutput.m_secondaryPerceptualRoughness, ctx, R::PrimarySurfaceFlagsIntermediateTexture1);
+    m_raytracingOutput.m_primarySurfaceFlagsIntermediateTexture2 = createOutputAliasedResource(m_raytracingOutput.m_sharedBiasCurrentColorMask, ctx, R::PrimarySurfaceFlagsIntermediateTexture2);
 
     // Let other systems know of the resize
     executeResizeEventList(m_onDownscaleResize, ctx, m_downscaledExtent);
@@ -844,15 +841,69 @@ namespace dxvk {
   void Resources::createTargetResources(Rc<DxvkContext>& ctx) {
     Logger::debug("Target resolution changed, recreating target resources");
 
-    m_raytracingOutput.m_finalOutput = createImageResource(ctx, m_targetExtent, VK_FORMAT_R16G16B16A16_SFLOAT);
+    using R = RtxOutputResource;
+
+    m_raytracingOutput.m_finalOutput = createOutputResource(ctx, R::FinalOutput);
 
     // Post Effect intermediate textures
-    m_raytracingOutput.m_postFxIntermediateTexture = createImageResource(ctx, m_targetExtent, VK_FORMAT_R16G16B16A16_SFLOAT);
+    m_raytracingOutput.m_postFxIntermediateTexture = createOutputResource(ctx, R::PostFxIntermediateTexture);
 
     // Let other systems know of the resize
     executeResizeEventList(m_onTargetResize, ctx, m_targetExtent);
   }
 
+  RtxOutputExtents Resources::getOutputExtents() const {
+    RtxOutputExtents extents;
+    extents.downscaled = m_downscaledExtent;
+    extents.target = m_targetExtent;
+    extents.froxelVolume = m_raytracingOutput.m_froxelVolumeExtent;
+    extents.numFroxelVolumes = m_raytracingOutput.m_numFroxelVolumes;
+    extents.rtxdiGradientFactor = RTXDI_GRAD_FACTOR;
+    return extents;
+  }
+
+  Resources::Resource Resources::createOutputResource(Rc<DxvkContext>& ctx, RtxOutputResource id) const {
+    const RtxOutputResourceDesc& desc = getRtxOutputResourceDesc(id);
+    assert(desc.ownsMemory());
+
+    return createImageResource(ctx, getRtxOutputResourceExtent(id, getOutputExtents()), desc.format, desc.numLayers,
+                               desc.is3D() ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D,
+                               desc.is3D() ? VK_IMAGE_VIEW_TYPE_3D : VK_IMAGE_VIEW_TYPE_2D);
+  }
+
+  Resources::AliasedResource Resources::createOutputAliasedResource(Rc<DxvkContext>& ctx, RtxOutputResource id, bool allowCompatibleFormatAliasing) const {
+    const RtxOutputResourceDesc& desc = getRtxOutputResourceDesc(id);
+    assert(desc.ownsMemory());
+
+    return AliasedResource(ctx, getRtxOutputResourceExtent(id, getOutputExtents()), desc.format, desc.name, allowCompatibleFormatAliasing, desc.numLayers);
+  }
+
+  Resources::AliasedResource Resources::createOutputAliasedResource(const AliasedResource& other, Rc<DxvkContext>& ctx, RtxOutputResource id) const {
+    const RtxOutputResourceDesc& desc = getRtxOutputResourceDesc(id);
+    assert(!desc.ownsMemory());
+
+    return AliasedResource(other, ctx, getRtxOutputResourceExtent(id, getOutputExtents()), desc.format, desc.name, desc.numLayers);
+  }
+
+  void Resources::logOutputMemoryReport() const {
+    constexpr double kMiB = 1024.0 * 1024.0;
+
+    const RtxOutputMemoryReport report = getOutputMemoryReport();
+
+    for (const RtxOutputMemoryReport::Entry& entry : report.entries) {
+      const RtxOutputResourceDesc& desc = getRtxOutputResourceDesc(entry.id);
+      Logger::debug(str::format("  ", desc.name, " (", desc.pass, "): ", entry.extent.width, "x", entry.extent.height, "x", entry.extent.depth,
+                                ", ", entry.bytes / kMiB, " MiB"));
+    }
+
+    Logger::info(str::format("Ray tracing render targets use ", report.totalBytes / kMiB, " MiB (",
+                             report.compactTotalBytes / kMiB, " MiB with compact formats):"));
+
+    for (const RtxOutputMemoryReport::PassTotal& passTotal : report.passTotals) {
+      Logger::info(str::format("  ", passTotal.pass, ": ", passTotal.bytes / kMiB, " MiB"));
+    }
+  }
+
   Resources::MipMapResource Resources::createMipmapResource(Rc<DxvkContext> ctx, const VkExtent3D& extent, VkFormat format, int mipLevel) {
     Resources::MipMapResource resource;
     DxvkImageCreateInfo desc;
@@ -929,30 +980,51 @@ namespace dxvk {
   }
 
   void RtxPass::onFrameBegin(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent, const VkExtent3D& targetExtent) {
-    bool lastStatus = m_shouldDispatch;
-    m_shouldDispatch = isActive();
-    if (m_shouldDispatch != lastStatus) {
-      if (m_shouldDispatch) {
-        createTargetResource(ctx, targetExtent);
-        createDownscaledResource(ctx, downscaledExtent);
-      } else {
-        releaseTargetResource();
-        releaseDownscaledResource();
-      }
+    // Resources are allocated the first frame the pass is active, and kept for a while after it is disabled
+    switch (m_resourceLifetime.update(isActive(), RtxOptions::Get()->numFramesToKeepOptionalPassResources())) {
+    case RtxOptionalResourceLifetime::Action::Allocate:
+      createTargetResource(ctx, targetExtent);
+      createDownscaledResource(ctx, downscaledExtent);
+      break;
+    case RtxOptionalResourceLifetime::Action::Release:
+      releaseTargetResource();
+      releaseDownscaledResource();
+      break;
+    default:
+      break;
     }
+
+    m_shouldDispatch = m_resourceLifetime.isActive();
   }
 
   void RtxPass::onTargetResize(Rc<DxvkContext>& ctx, const VkExtent3D& targetExtent) {
-    if (m_shouldDispatch) {
+    switch (m_resourceLifetime.onResize()) {
+    case RtxOptionalResourceLifetime::Action::Allocate:
       releaseTargetResource();
       createTargetResource(ctx, targetExtent);
+      break;
+    case RtxOptionalResourceLifetime::Action::Release:
+      // Note: Idle resources are released rather than reallocated at the new extent
+      releaseTargetResource();
+      releaseDownscaledResource();
+      break;
+    default:
+      break;
     }
   }
 
   void RtxPass::onDownscaledResize(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent) {
-    if (m_shouldDispatch) {
+    switch (m_resourceLifetime.onResize()) {
+    case RtxOptionalResourceLifetime::Action::Allocate:
       releaseDownscaledResource();
       createDownscaledResource(ctx, downscaledExtent);
+      break;
+    case RtxOptionalResourceLifetime::Action::Release:
+      releaseTargetResource();
+      releaseDownscaledResource();
+      break;
+    default:
+      break;
     }
   }
 }  // namespace dxvk
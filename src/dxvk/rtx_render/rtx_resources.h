@@ -25,6 +25,8 @@
 #include "../dxvk_image.h"
 #include "../dxvk_sampler.h"
 #include "rtx_types.h"
+#include "rtx_resource_table.h"
+#include "rtx_optional_resource.h"
 #include "vulkan/vulkan_core.h"
 #include "rtx_utils.h"
 #include "rtx/pass/raytrace_args.h"
@@ -374,6 +376,9 @@ namespace dxvk
     const VkExtent3D& getTargetDimensions() const { return m_targetExtent; }
     const VkExtent3D& getDownscaleDimensions() const { return m_downscaledExtent; }
 
+    // Memory used by the ray tracing output render targets at the current resolution
+    RtxOutputMemoryReport getOutputMemoryReport() const { return computeRtxOutputMemoryReport(getOutputExtents()); }
+
     static const uint32_t kInvalidFormatCompatibilityCategoryIndex = UINT32_MAX;
     static uint32_t getFormatCompatibilityCategoryIndex(const VkFormat format);
     static bool areFormatsCompatible(const VkFormat format1, const VkFormat format2);
@@ -426,6 +431,12 @@ namespace dxvk
     void createTargetResources(Rc<DxvkContext>& ctx);
 
     void createDownscaledResources(Rc<DxvkContext>& ctx);
+
+    RtxOutputExtents getOutputExtents() const;
+    Resource createOutputResource(Rc<DxvkContext>& ctx, RtxOutputResource id) const;
+    AliasedResource createOutputAliasedResource(Rc<DxvkContext>& ctx, RtxOutputResource id, bool allowCompatibleFormatAliasing = false) const;
+    AliasedResource createOutputAliasedResource(const AliasedResource& other, Rc<DxvkContext>& ctx, RtxOutputResource id) const;
+    void logOutputMemoryReport() const;
   };
 
   class RtxPass {
@@ -447,6 +458,7 @@ namespace dxvk
     void onDownscaledResize(Rc<DxvkContext>& ctx, const VkExtent3D& downscaledExtent);
 
     bool m_shouldDispatch = false;
+    RtxOptionalResourceLifetime m_resourceLifetime;
     EventHandler m_events;
   protected:
     // Interface to determine whether a pass is enabled.
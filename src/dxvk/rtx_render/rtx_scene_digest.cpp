@@ -0,0 +1,71 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_scene_digest.h"
+
+namespace dxvk {
+  void SceneDigest::addData(const void* data, size_t size) {
+    m_ordered = XXH3_64bits_withSeed(data, size, m_ordered);
+  }
+
+  void SceneDigest::addUnordered(XXH64_hash_t hash) {
+    // Note: Sum and xor together with the count so that duplicates do not simply cancel out
+    m_unorderedSum += hash;
+    m_unorderedXor ^= hash;
+    m_unorderedCount++;
+  }
+
+  XXH64_hash_t SceneDigest::getHash() const {
+    const XXH64_hash_t unordered[] = { m_unorderedSum, m_unorderedXor, m_unorderedCount };
+    return XXH3_64bits_withSeed(unordered, sizeof(unordered), m_ordered);
+  }
+
+  StaticSceneAction StaticSceneDetector::update(XXH64_hash_t digest, const Settings& settings) {
+    if (!m_hasDigest || digest != m_lastDigest) {
+      m_lastDigest = digest;
+      m_hasDigest = true;
+      m_staticFrames = 0;
+    } else {
+      m_staticFrames++;
+    }
+
+    StaticSceneAction action = StaticSceneAction::Reuse;
+
+    if (m_staticFrames == 0 || m_staticFrames <= settings.minStaticFrames) {
+      // Changed, or not unchanged for long enough yet
+      action = StaticSceneAction::Render;
+    } else if (settings.refreshInterval > 0 && m_framesSinceRender + 1 >= settings.refreshInterval) {
+      action = StaticSceneAction::Render;
+    }
+
+    m_framesSinceRender = action == StaticSceneAction::Render ? 0 : m_framesSinceRender + 1;
+    m_lastAction = action;
+
+    return action;
+  }
+
+  void StaticSceneDetector::reset() {
+    m_hasDigest = false;
+    m_staticFrames = 0;
+    m_framesSinceRender = 0;
+    m_lastAction = StaticSceneAction::Render;
+  }
+}
@@ -0,0 +1,98 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+  /**
+   * \brief Scene digest
+   *
+   * Cheap fingerprint of everything the path tracer consumes in a frame: the camera, the TLAS
+   * instance inputs, the light, material and texture tables, the game time when materials are
+   * animated and the option values. Ordered inputs are
+   * chained into a running hash, inputs coming from unordered tables (e.g. the light table) are
+   * combined in an order independent way so that iteration order does not register as a change.
+   */
+  class SceneDigest {
+  public:
+    void addData(const void* data, size_t size);
+
+    template<typename T>
+    void add(const T& value) {
+      static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be added to the digest");
+      addData(&value, sizeof(T));
+    }
+
+    // Adds a hash of an element of an unordered table
+    void addUnordered(XXH64_hash_t hash);
+
+    XXH64_hash_t getHash() const;
+
+  private:
+    XXH64_hash_t m_ordered = 0;
+    XXH64_hash_t m_unorderedSum = 0;
+    XXH64_hash_t m_unorderedXor = 0;
+    uint64_t m_unorderedCount = 0;
+  };
+
+  enum class StaticSceneAction {
+    Render,  // Run the full ray tracing pipeline
+    Reuse,   // Present the output of the last rendered frame again
+  };
+
+  /**
+   * \brief Static scene detector
+   *
+   * Compares the scene digest of consecutive frames. Once the scene has been unchanged for a
+   * number of frames (so temporal accumulation and the denoisers had time to converge), frames
+   * reuse the last output instead of being rendered again, optionally still rendering one frame
+   * every refresh interval to keep accumulating at a reduced rate. Any change renders immediately.
+   */
+  class StaticSceneDetector {
+  public:
+    struct Settings {
+      uint32_t minStaticFrames = 0;  // Unchanged frames still rendered after a change
+      uint32_t refreshInterval = 0;  // Render one in this many frames while static, 0 to never render
+    };
+
+    StaticSceneAction update(XXH64_hash_t digest, const Settings& settings);
+
+    // Forces the next frame to be rendered, e.g. when no output was produced or the output was lost
+    void reset();
+
+    // Number of consecutive frames with an unchanged digest
+    uint32_t getStaticFrameCount() const { return m_staticFrames; }
+
+    bool isReusingOutput() const { return m_lastAction == StaticSceneAction::Reuse; }
+
+  private:
+    XXH64_hash_t m_lastDigest = 0;
+    bool m_hasDigest = false;
+    uint32_t m_staticFrames = 0;
+    uint32_t m_framesSinceRender = 0;
+    StaticSceneAction m_lastAction = StaticSceneAction::Render;
+  };
+}
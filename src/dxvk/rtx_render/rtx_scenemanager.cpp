@@ -19,6 +19,8 @@
 * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 * DEALINGS IN THE SOFTWARE.
 */
+#include <filesystem>
+#include <fstream>
 #include <mutex>
 #include <vector>
 
@@ -37,6 +39,7 @@
 #include "vulkan/vulkan_core.h"
 
 #include "rtx_game_capturer.h"
+#include "rtx_game_capturer_paths.h"
 #include "rtx_matrix_helpers.h"
 
 #include "dxvk_scoped_annotation.h"
@@ -53,6 +56,7 @@ namespace dxvk {
     , m_drawCallCache(device)
     , m_bindlessResourceManager(device)
     , m_volumeManager(device)
+    , m_terrainBaker(device)
     , m_pReplacer(new AssetReplacer(device))
     , m_gameCapturer(new GameCapturer(*this))
     , m_cameraManager(device) {
@@ -114,6 +118,9 @@ namespace dxvk {
     m_lightManager.clear();
     m_rayPortalManager.clear();
     m_drawCallCache.clear();
+    m_terrainBaker.clear();
+    m_meshLodSelector.clear();
+    m_assetCostLedger.clear();
 
     m_previousFrameSceneAvailable = false;
   }
@@ -144,15 +151,21 @@ namespace dxvk {
         const bool isDemotable = iter->getManagedTexture() != nullptr && iter->getManagedTexture()->canDemote;
         if (isDemotable && iter->frameLastUsed < oldestFrame) {
           iter->demote();
+          iter->getManagedTexture()->frameDemoted = m_device->getCurrentFrameId();
         }
       }
     }
 
+    // Adjust the resident mips of material textures to what was sampled recently
+    m_device->getCommon()->getTextureManager().updateTextureResidency(m_textureCache.getObjectTable());
+
     // Perform GC on the other managers
     m_instanceManager.garbageCollection();
     m_accelManager.garbageCollection();
     m_lightManager.garbageCollection();
     m_rayPortalManager.garbageCollection();
+    m_terrainBaker.garbageCollection(m_device->getCurrentFrameId());
+    m_meshLodSelector.garbageCollect(m_device->getCurrentFrameId(), RtxOptions::Get()->numFramesToKeepInstances());
   }
 
   void SceneManager::destroy() {
@@ -212,7 +225,8 @@ namespace dxvk {
         // Set up the ideal vertex params, if input vertices are interleaved, it's safe to assume the positionBuffer stride is the vertex stride
         output.vertexCount = input.vertexCount;
 
-        const size_t vertexStride = input.isVertexDataInterleaved() ? input.positionBuffer.stride() : RtxGeometryUtils::computeOptimalVertexStride(input);
+        const RtxGeometryUtils::CompactVertexLayout compactLayout = RtxGeometryUtils::getCompactVertexLayout(input);
+        const size_t vertexStride = (input.isVertexDataInterleaved() && !compactLayout.any()) ? input.positionBuffer.stride() : RtxGeometryUtils::computeOptimalVertexStride(input, compactLayout);
         const size_t vertexBufferSize = output.vertexCount * vertexStride;
 
         // Set up the ideal index params
@@ -242,7 +256,7 @@ namespace dxvk {
         info.size = align(vertexBufferSize, CACHE_LINE_SIZE);
         output.historyBuffer[0] = m_device->createBuffer(info, memoryProperty, DxvkMemoryStats::Category::RTXAccelerationStructure);
 
-        RtxGeometryUtils::cacheVertexDataOnGPU(ctx, input, output);
+        RtxGeometryUtils::cacheVertexDataOnGPU(ctx, input, compactLayout, output);
 
         break;
       }
@@ -255,7 +269,8 @@ namespace dxvk {
           output.historyBuffer[0] = m_device->createBuffer(inOutGeometry.historyBuffer[0]->info(), memoryProperty, DxvkMemoryStats::Category::RTXAccelerationStructure);
         } 
 
-        RtxGeometryUtils::cacheVertexDataOnGPU(ctx, input, output);
+        // Note: Keep the layout chosen when the buffers were allocated, the vertex stride must not change across updates
+        RtxGeometryUtils::cacheVertexDataOnGPU(ctx, input, RtxGeometryUtils::getCompactVertexLayout(inOutGeometry), output);
 
         // Assign the previous buffer using the last slice (copy most params from the position, just change buffer)
         output.previousPositionBuffer = RaytraceBuffer(DxvkBufferSlice(output.historyBuffer[1], 0, output.positionBuffer.length()), output.positionBuffer.offsetFromSlice(), output.positionBuffer.stride(), output.positionBuffer.vertexFormat());
@@ -333,6 +348,24 @@ namespace dxvk {
       }
     }
 
+    // Record replacement texture usage for predictive streaming on later runs
+    if (RtxOptions::Get()->recordTextureUsageManifest()) {
+      const Vector3& cameraPosition = m_cameraManager.getMainCamera().getPosition(false);
+      const XXH64_hash_t gameMaterialHash = input.getMaterialData().getHash();
+
+      if (overrideMaterialData != nullptr) {
+        m_pReplacer->recordTextureUsage(cameraPosition, gameMaterialHash, *overrideMaterialData);
+      }
+
+      if (pReplacements != nullptr) {
+        for (const AssetReplacement& replacement : *pReplacements) {
+          if (replacement.type == AssetReplacement::eMesh && replacement.materialData != nullptr) {
+            m_pReplacer->recordTextureUsage(cameraPosition, gameMaterialHash, *replacement.materialData);
+          }
+        }
+      }
+    }
+
     // Check if a Ray Portal override is needed
     std::optional<MaterialData> rayPortalMaterialData{};
     size_t rayPortalTextureIndex;
@@ -387,11 +420,31 @@ namespace dxvk {
       }
     }
 
+    // Trace blended terrain stacks as a single opaque surface with all layers baked into it
+    std::optional<DrawCallState> bakedTerrainDrawCallState{};
+
+    if (RtxOptions::Get()->enableTerrainBaking() && pReplacements == nullptr &&
+        RtxOptions::Get()->isTerrainTexture(input.getMaterialData().getHash())) {
+      const MaterialData* bakedTerrainMaterialData = nullptr;
+
+      switch (m_terrainBaker.registerLayer(input, overrideMaterialData, bakedTerrainDrawCallState, bakedTerrainMaterialData)) {
+      case TerrainBaker::LayerAction::Skip:
+        return;
+      case TerrainBaker::LayerAction::DrawBaked:
+        overrideMaterialData = bakedTerrainMaterialData;
+        break;
+      default:
+        break;
+      }
+    }
+
+    const DrawCallState& drawCallState = bakedTerrainDrawCallState.has_value() ? *bakedTerrainDrawCallState : input;
+
     uint64_t instanceId = UINT64_MAX;
     if (pReplacements != nullptr) {
-      instanceId = drawReplacements(ctx, cmd, &input, pReplacements, overrideMaterialData);
+      instanceId = drawReplacements(ctx, cmd, &drawCallState, pReplacements, overrideMaterialData);
     } else {
-      instanceId = processDrawCallState(ctx, cmd, input, overrideMaterialData);
+      instanceId = processDrawCallState(ctx, cmd, drawCallState, overrideMaterialData, activeReplacementHash);
     }
   }
 
@@ -454,12 +507,14 @@ namespace dxvk {
 
   uint64_t SceneManager::drawReplacements(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmd, const DrawCallState* input, const std::vector<AssetReplacement>* pReplacements, const MaterialData* overrideMaterialData) {
     uint64_t rootInstanceId = UINT64_MAX;
+    // Note: Costs of the replacement meshes are attributed to the mesh they replace
+    const XXH64_hash_t assetHash = input->getHash(RtxOptions::Get()->GeometryAssetHashRule);
     // Detect replacements of meshes that would have unstable hashes due to the vertex hash using vertex data from a shared vertex buffer.
     // TODO: Once the vertex hash only uses vertices referenced by the index buffer, this should be removed.
     const bool highlightUnsafeReplacement = RtxOptions::Get()->getHighlightUnsafeReplacementModeEnabled() &&
         input->getGeometryData().indexBuffer.defined() && input->getGeometryData().vertexCount > input->getGeometryData().indexCount;
     if (!pReplacements->empty() && (*pReplacements)[0].includeOriginal) {
-      rootInstanceId = processDrawCallState(ctx, cmd, *input, overrideMaterialData);
+      rootInstanceId = processDrawCallState(ctx, cmd, *input, overrideMaterialData, assetHash);
     }
     for (auto&& replacement : *pReplacements) {
       if (replacement.type == AssetReplacement::eMesh) {
@@ -469,7 +524,7 @@ namespace dxvk {
         transforms.objectToView = transforms.objectToView * replacement.replacementToObject;
         
         const DrawCallState newDrawCallState{
-          *replacement.geometryData, // Note: Geometry Data replaced
+          selectMeshLod(ctx, replacement, transforms), // Note: Geometry Data replaced
           input->getMaterialData(), // Note: Original legacy material data preserved
           transforms,
           input->getSkinningState(),
@@ -488,7 +543,7 @@ namespace dxvk {
             overrideMaterialData = &sHighlightMaterialData;
           }
         }
-        uint64_t instanceId = processDrawCallState(ctx, cmd, newDrawCallState, overrideMaterialData);
+        uint64_t instanceId = processDrawCallState(ctx, cmd, newDrawCallState, overrideMaterialData, assetHash);
         if (rootInstanceId == UINT64_MAX) {
           rootInstanceId = instanceId;
         }
@@ -502,16 +557,55 @@ namespace dxvk {
           ));
           continue;
         }
-        RtLight localLight(replacement.lightData);
-        localLight.setRootInstanceId(rootInstanceId);
-        localLight.applyTransform(input->getTransformData().objectToWorld);
-        m_lightManager.addLight(localLight);
+        m_lightManager.addReplacementLight(rootInstanceId, replacement.lightData, input->getTransformData().objectToWorld);
       }
     }
 
     return rootInstanceId;
   }
 
+  const RasterGeometry& SceneManager::selectMeshLod(Rc<RtxContext> ctx, const AssetReplacement& replacement, const DrawCallTransforms& transforms) {
+    const auto& options = RtxOptions::Get()->meshLod;
+
+    if (replacement.lods == nullptr || !options.enable()) {
+      return *replacement.geometryData;
+    }
+
+    const MeshLodChain& lods = *replacement.lods;
+    const RtCamera& camera = m_cameraManager.getMainCamera();
+    const uint32_t screenHeight = ctx->getResourceManager().getTargetDimensions().height;
+
+    if (screenHeight == 0 || camera.getFov() <= 0.f) {
+      return *replacement.geometryData;
+    }
+
+    // Measure the error at the point of the bounding sphere closest to the camera
+    const Matrix4& objectToView = transforms.objectToView;
+    const float scale = std::max({ length(objectToView[0].xyz()), length(objectToView[1].xyz()), length(objectToView[2].xyz()) });
+    const Vector4 viewCenter = objectToView * Vector4(lods.center.x, lods.center.y, lods.center.z, 1.f);
+    const float distance = std::max(length(viewCenter.xyz()) - lods.radius * scale, camera.getNearPlane());
+    const float pixelsPerUnit = scale * float(screenHeight) / (2.f * std::tan(camera.getFov() * 0.5f) * distance);
+
+    // Note: Replacements carry no identity across frames, so instances are told apart by their mesh and a
+    // world position quantized to the size of the mesh. Moving instances lose their history as they cross
+    // cells, which only costs them the hysteresis for that frame.
+    const Vector3 worldCenter = (transforms.objectToWorld * Vector4(lods.center.x, lods.center.y, lods.center.z, 1.f)).xyz();
+    const float cellSize = std::max(lods.radius * scale * 2.f, 1e-3f);
+    const int32_t cell[3] = {
+      int32_t(std::floor(worldCenter.x / cellSize)),
+      int32_t(std::floor(worldCenter.y / cellSize)),
+      int32_t(std::floor(worldCenter.z / cellSize))
+    };
+
+    XXH64_hash_t key = XXH64(&replacement.lods, sizeof(replacement.lods), 0);
+    key = XXH64(cell, sizeof(cell), key);
+
+    const uint32_t level = m_meshLodSelector.select(key, lods.errors.data(), uint32_t(lods.errors.size()), pixelsPerUnit,
+                                                    options.pixelErrorThreshold(), options.hysteresis(), m_device->getCurrentFrameId());
+
+    return level == 0 ? *replacement.geometryData : *lods.geometryData[level - 1];
+  }
+
   void SceneManager::clearFogState() {
     m_fog = FogState();
   }
@@ -696,6 +790,9 @@ namespace dxvk {
     if (pBlas != nullptr) {
       pBlas->unlinkInstance(&instance);
     }
+
+    // Note: Only the bindings of replacement lights go with the instance, the lights age out like any other light
+    m_lightManager.retireReplacementLights(instance.getId());
   }
 
   // Helper to populate the texture cache with this resource (and patch sampler if required for texture)
@@ -730,7 +827,7 @@ namespace dxvk {
     cachedTexture.frameLastUsed = ctx->getDevice()->getCurrentFrameId();
   }
 
-  uint64_t SceneManager::processDrawCallState(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmd, const DrawCallState& drawCallState, const MaterialData* overrideMaterialData) {
+  uint64_t SceneManager::processDrawCallState(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmd, const DrawCallState& drawCallState, const MaterialData* overrideMaterialData, XXH64_hash_t assetHash) {
     const MaterialData& renderMaterialData = overrideMaterialData != nullptr ? *overrideMaterialData : drawCallState.getMaterialData();
     if (renderMaterialData.getIgnored()) {
       return UINT64_MAX;
@@ -745,6 +842,7 @@ namespace dxvk {
 
     // Update the input state, so we always have a reference to the original draw call state
     pBlas->frameLastTouched = m_device->getCurrentFrameId();
+    pBlas->assetHash = assetHash;
 
     if (drawCallState.getSkinningState().numBones > 0 && (result == ObjectCacheState::KBuildBVH || result == ObjectCacheState::kUpdateBVH)) {
       ctx->performSkinning(drawCallState, pBlas->modifiedGeometryData);
@@ -1004,6 +1102,8 @@ namespace dxvk {
     
     m_bindlessResourceManager.prepareSceneData(cmdList, getTextureTable(), getBufferTable());
 
+    m_terrainBaker.prepareSceneData(ctx);
+
     // If there are no instances, we should do nothing!
     if (m_instanceManager.getActiveCount() == 0) {
       // Clear the ray portal data before the next frame
@@ -1032,6 +1132,15 @@ namespace dxvk {
       m_enqueueDelayedClear = true;
     }
 
+    if (RtxOptions::Get()->prefetchFromTextureUsageManifest()) {
+      const RtCamera& camera = m_cameraManager.getMainCamera();
+      const Vector3& cameraPosition = camera.getPosition(false);
+      // Note: No meaningful motion across a camera cut, only look around the new position
+      const Vector3 cameraMotion = m_cameraManager.isCameraCutThisFrame() ? Vector3(0.f) : cameraPosition - camera.getPreviousViewToWorld(false)[3].xyz();
+
+      m_pReplacer->prefetchTextures(ctx, cameraPosition, cameraMotion);
+    }
+
     // Initialize/remove opacity micromap manager
     if (RtxOptions::Get()->getEnableOpacityMicromap()) {
       if (!m_opacityMicromapManager.get() || 
@@ -1054,7 +1163,16 @@ namespace dxvk {
     m_instanceManager.createViewModelInstances(ctx, cmdList, m_cameraManager, m_rayPortalManager);
     m_instanceManager.createPlayerModelVirtualInstances(ctx, m_cameraManager, m_rayPortalManager);
 
-    m_accelManager.mergeInstancesIntoBlas(ctx, cmdList, execBarriers, m_textureCache.getObjectTable(), m_cameraManager, m_instanceManager, m_opacityMicromapManager.get(), frameTimeSecs);
+    const bool useAssetCostLedger = RtxOptions::Get()->assetCostLedger.enable();
+
+    m_accelManager.mergeInstancesIntoBlas(ctx, cmdList, execBarriers, m_textureCache.getObjectTable(), m_cameraManager, m_instanceManager, m_opacityMicromapManager.get(),
+                                          useAssetCostLedger ? &m_assetCostLedger : nullptr, frameTimeSecs);
+
+    if (useAssetCostLedger) {
+      updateAssetCostLedger();
+    } else {
+      m_assetCostLedger.clear();
+    }
 
     // Call on the other managers to prepare their GPU data for the current scene
     m_accelManager.prepareSceneData(ctx, cmdList, execBarriers, m_instanceManager);
@@ -1137,6 +1255,9 @@ namespace dxvk {
     m_device->statCounters().setCtr(DxvkStatCounter::RtxSurfaceMaterialCount, m_surfaceMaterialCache.getActiveCount());
     m_device->statCounters().setCtr(DxvkStatCounter::RtxVolumeMaterialCount, m_volumeMaterialCache.getActiveCount());
     m_device->statCounters().setCtr(DxvkStatCounter::RtxLightCount, m_lightManager.getActiveCount());
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxTextureAlphaOpaqueCount, m_instanceManager.getTextureAlphaOpaqueCount());
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxTextureAlphaTransparentCount, m_instanceManager.getTextureAlphaTransparentCount());
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxDeferredBlasBuildCount, m_accelManager.getDeferredBlasBuildCount());
     
     if (m_device->getCurrentFrameId() == m_beginUsdExportFrameNum) {
       m_gameCapturer->toggleMultiFrameCapture();
@@ -1149,6 +1270,110 @@ namespace dxvk {
   
   bool SceneManager::isGameCapturerIdle() const { return m_gameCapturer->isIdle(); }
 
+  void SceneManager::updateAssetCostLedger() {
+    ZoneScoped;
+
+    const auto& options = RtxOptions::Get()->assetCostLedger;
+
+    AssetCostLedger::Params params;
+    params.maxEntries = options.maxEntries();
+    params.maxIdleFrames = options.maxIdleFrames();
+    m_assetCostLedger.setParams(params);
+
+    const uint32_t currentFrame = m_device->getCurrentFrameId();
+    const std::vector<TextureRef>& textures = m_textureCache.getObjectTable();
+    const std::vector<RtSurfaceMaterial>& surfaceMaterials = m_surfaceMaterialCache.getObjectTable();
+
+    const auto getTextureSize = [&textures](uint32_t textureIndex) -> uint64_t {
+      if (textureIndex >= textures.size())
+        return 0;
+
+      const DxvkImageView* imageView = textures[textureIndex].getImageView();
+      return imageView != nullptr ? imageView->image()->memSize() : 0;
+    };
+
+    // Note: Resources are shared by all instances of a geometry, so they are only counted once
+    std::unordered_set<const BlasEntry*> countedBlasEntries;
+
+    for (const RtInstance* instance : m_instanceManager.getInstanceTable()) {
+      const BlasEntry* pBlas = instance->getBlas();
+
+      if (pBlas == nullptr || instance->getFrameLastUpdated() != currentFrame)
+        continue;
+
+      const XXH64_hash_t assetHash = pBlas->assetHash;
+
+      m_assetCostLedger.add(assetHash, AssetCost::Instances, 1);
+      m_assetCostLedger.add(assetHash, AssetCost::Triangles, pBlas->modifiedGeometryData.calculatePrimitiveCount());
+
+      if (!countedBlasEntries.insert(pBlas).second)
+        continue;
+
+      if (pBlas->staticBlas.ptr())
+        m_assetCostLedger.add(assetHash, AssetCost::BlasBytes, pBlas->staticBlas->accelStructure->info().size);
+
+      if (m_opacityMicromapManager.get())
+        m_assetCostLedger.add(assetHash, AssetCost::OpacityMicromapBytes, m_opacityMicromapManager->getBuiltOpacityMicromapSize(instance->getOpacityMicromapSourceHash()));
+
+      if (instance->surface.surfaceMaterialIndex >= surfaceMaterials.size())
+        continue;
+
+      const RtSurfaceMaterial& surfaceMaterial = surfaceMaterials[instance->surface.surfaceMaterialIndex];
+      uint64_t textureSize = 0;
+
+      switch (surfaceMaterial.getType()) {
+      case RtSurfaceMaterialType::Opaque: {
+        const RtOpaqueSurfaceMaterial& opaqueMaterial = surfaceMaterial.getOpaqueSurfaceMaterial();
+        textureSize += getTextureSize(opaqueMaterial.getAlbedoOpacityTextureIndex());
+        textureSize += getTextureSize(opaqueMaterial.getNormalTextureIndex());
+        textureSize += getTextureSize(opaqueMaterial.getTangentTextureIndex());
+        textureSize += getTextureSize(opaqueMaterial.getRoughnessTextureIndex());
+        textureSize += getTextureSize(opaqueMaterial.getMetallicTextureIndex());
+        textureSize += getTextureSize(opaqueMaterial.getEmissiveColorTextureIndex());
+        break;
+      }
+      case RtSurfaceMaterialType::Translucent: {
+        const RtTranslucentSurfaceMaterial& translucentMaterial = surfaceMaterial.getTranslucentSurfaceMaterial();
+        textureSize += getTextureSize(translucentMaterial.getNormalTextureIndex());
+        textureSize += getTextureSize(translucentMaterial.getTransmittanceTextureIndex());
+        break;
+      }
+      case RtSurfaceMaterialType::RayPortal: {
+        const RtRayPortalSurfaceMaterial& rayPortalMaterial = surfaceMaterial.getRayPortalSurfaceMaterial();
+        textureSize += getTextureSize(rayPortalMaterial.getMaskTextureIndex());
+        textureSize += getTextureSize(rayPortalMaterial.getMaskTextureIndex2());
+        break;
+      }
+      default:
+        break;
+      }
+
+      m_assetCostLedger.add(assetHash, AssetCost::TextureBytes, textureSize);
+    }
+
+    m_assetCostLedger.endFrame();
+  }
+
+  bool SceneManager::dumpAssetCosts() const {
+    const std::string& path = relPath::remixAssetCostsPath;
+
+    std::error_code ec;
+    std::filesystem::create_directories(relPath::rtxRemixDir, ec);
+
+    std::ofstream file(path, std::ios::trunc);
+
+    if (file)
+      m_assetCostLedger.writeCsv(file);
+
+    if (!file.good()) {
+      Logger::err(str::format("[RTX] Asset Cost Ledger: failed to write ", path));
+      return false;
+    }
+
+    Logger::info(str::format("[RTX] Asset Cost Ledger: wrote the costs of ", m_assetCostLedger.getEntryCount(), " assets to ", path));
+    return true;
+  }
+
   void SceneManager::triggerUsdCapture() const {
     m_gameCapturer->startNewSingleFrameCapture();
   }
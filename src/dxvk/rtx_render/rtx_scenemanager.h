@@ -43,9 +43,12 @@
 #include "rtx_lightmanager.h"
 #include "rtx_instancemanager.h"
 #include "rtx_accelmanager.h"
+#include "rtx_asset_cost_ledger.h"
 #include "rtx_rayportalmanager.h"
 #include "rtx_bindlessresourcemanager.h"
 #include "rtx_volumemanager.h"
+#include "rtx_terrain_baker.h"
+#include "rtx_mesh_simplifier.h"
 #include <d3d9types.h>
 
 namespace dxvk 
@@ -142,6 +145,7 @@ public:
   const BindlessResourceManager& getBindlessResourceManager() const { return m_bindlessResourceManager; }
   const OpacityMicromapManager* getOpacityMicromapManager() const { return m_opacityMicromapManager.get(); }
   const VolumeManager& getVolumeManager() const { return m_volumeManager; }
+  const AssetCostLedger& getAssetCostLedger() const { return m_assetCostLedger; }
   std::unique_ptr<AssetReplacer>& getAssetReplacer() { return m_pReplacer; }
 
   void addLight(const D3DLIGHT9& light);
@@ -170,6 +174,9 @@ public:
 
   void finalizeAllPendingTexturePromotions();
 
+  // Writes the costs of all assets in the asset cost ledger to a CSV file in the rtx-remix directory
+  bool dumpAssetCosts() const;
+
   void trackTexture(Rc<RtxContext> ctx, TextureRef inputTexture, uint32_t& textureIndex, bool hasTexcoords, bool patchSampler = true, bool allowAsync = true);
 
 private:
@@ -185,7 +192,7 @@ private:
   ObjectCacheState processGeometryInfo(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmd, const DrawCallState& drawCallState, RaytraceGeometry& modifiedGeometryData);
 
   // Consumes a draw call state and updates the scene state accordingly
-  uint64_t processDrawCallState(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmd, const DrawCallState& blasInput, const MaterialData* replacementMaterialData);
+  uint64_t processDrawCallState(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmd, const DrawCallState& blasInput, const MaterialData* replacementMaterialData, XXH64_hash_t assetHash);
   // Updates ref counts for old and new buffers
   void updateBufferCache(const RaytraceGeometry& oldGeoData, RaytraceGeometry& newGeoData);
   // Decrements the ref count for buffers associated with the specified geometry data
@@ -207,8 +214,14 @@ private:
 
   uint64_t drawReplacements(Rc<RtxContext> ctx, Rc<DxvkCommandList> cmd, const DrawCallState* input, const std::vector<AssetReplacement>* pReplacements, const MaterialData* overrideMaterialData);
 
+  // Picks the level of a replacement mesh to trace from its error projected on screen, see rtx.meshLod
+  const RasterGeometry& selectMeshLod(Rc<RtxContext> ctx, const AssetReplacement& replacement, const DrawCallTransforms& transforms);
+
   void createEffectLight(Rc<RtxContext> ctx, const DrawCallState& input, const RtInstance* instance);
 
+  // Attributes the instances of this frame and the resources they keep resident to their assets, see rtx.assetCostLedger
+  void updateAssetCostLedger();
+
   Rc<GameCapturer> m_gameCapturer;
   uint32_t m_beginUsdExportFrameNum = -1;
   bool m_enqueueDelayedClear = false;
@@ -222,6 +235,9 @@ private:
   BindlessResourceManager m_bindlessResourceManager;
   std::unique_ptr<OpacityMicromapManager> m_opacityMicromapManager;
   VolumeManager m_volumeManager;
+  TerrainBaker m_terrainBaker;
+  MeshLodSelector m_meshLodSelector;
+  AssetCostLedger m_assetCostLedger;
 
   DrawCallCache m_drawCallCache;
 
@@ -0,0 +1,345 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_terrain_baker.h"
+#include "rtx_context.h"
+#include "rtx_options.h"
+#include "dxvk_device.h"
+#include "dxvk_scoped_annotation.h"
+#include "dxvk_shader_manager.h"
+
+#include <rtx_shaders/terrain_bake.h>
+
+#include "rtx/pass/terrain_bake/terrain_bake.h"
+
+namespace dxvk {
+
+  // Defined within an unnamed namespace to ensure unique definition across binary
+  namespace {
+    class TerrainBakeShader : public ManagedShader {
+      SHADER_SOURCE(TerrainBakeShader, VK_SHADER_STAGE_COMPUTE_BIT, terrain_bake)
+
+      PUSH_CONSTANTS(TerrainBakeArgs)
+
+      BEGIN_PARAMETER()
+        SAMPLER2D(TERRAIN_BAKE_ALBEDO_INPUT)
+        SAMPLER2D(TERRAIN_BAKE_NORMAL_INPUT)
+        SAMPLER2D(TERRAIN_BAKE_ROUGHNESS_INPUT)
+        RW_TEXTURE2D(TERRAIN_BAKE_ALBEDO_OUTPUT)
+        RW_TEXTURE2D(TERRAIN_BAKE_NORMAL_OUTPUT)
+        RW_TEXTURE2D(TERRAIN_BAKE_ROUGHNESS_OUTPUT)
+      END_PARAMETER()
+    };
+
+    PREWARM_SHADER_PIPELINE(TerrainBakeShader);
+
+    static_assert(TERRAIN_BLEND_ARG_VERTEX_COLOR0 == (uint32_t) RtTextureArgSource::VertexColor0);
+    static_assert(TERRAIN_BLEND_ARG_TFACTOR == (uint32_t) RtTextureArgSource::TFactor);
+    static_assert(TERRAIN_BLEND_TEXOP_ADD == (uint32_t) DxvkRtTextureOperation::Add);
+    static_assert(TERRAIN_BLEND_FACTOR_SRC_ALPHA_SATURATE == VK_BLEND_FACTOR_SRC_ALPHA_SATURATE);
+    static_assert(TERRAIN_BLEND_OP_MAX == VK_BLEND_OP_MAX);
+
+    TerrainBlendLayerState toLayerState(const LegacyMaterialData& materialData, bool isBaseLayer) {
+      TerrainBlendLayerState state {};
+      state.colorArg1Source = (uint32_t) materialData.textureColorArg1Source;
+      state.colorArg2Source = (uint32_t) materialData.textureColorArg2Source;
+      state.colorOperation = (uint32_t) materialData.textureColorOperation;
+      state.alphaArg1Source = (uint32_t) materialData.textureAlphaArg1Source;
+      state.alphaArg2Source = (uint32_t) materialData.textureAlphaArg2Source;
+      state.alphaOperation = (uint32_t) materialData.textureAlphaOperation;
+      // Note: The base layer is the opaque surface everything else is blended onto
+      state.blendEnabled = materialData.alphaBlendEnabled && !isBaseLayer;
+      state.srcColorBlendFactor = materialData.srcColorBlendFactor;
+      state.dstColorBlendFactor = materialData.dstColorBlendFactor;
+      state.colorBlendOp = materialData.colorBlendOp;
+      state.tFactor = materialData.tFactor;
+      return state;
+    }
+
+    bool usesVertexColor(const LegacyMaterialData& materialData) {
+      return materialData.textureColorArg1Source == RtTextureArgSource::VertexColor0 ||
+             materialData.textureColorArg2Source == RtTextureArgSource::VertexColor0 ||
+             materialData.textureAlphaArg1Source == RtTextureArgSource::VertexColor0 ||
+             materialData.textureAlphaArg2Source == RtTextureArgSource::VertexColor0;
+    }
+  }
+
+  TerrainBaker::TerrainBaker(Rc<DxvkDevice> device)
+    : m_device(device) {
+  }
+
+  TerrainBaker::~TerrainBaker() {
+  }
+
+  TerrainBaker::Layer TerrainBaker::createLayer(const DrawCallState& drawCallState, const MaterialData* overrideMaterialData) const {
+    Layer layer;
+    layer.materialData = drawCallState.getMaterialData();
+    layer.texcoordHash = drawCallState.getGeometryData().hashes[HashComponents::VertexTexcoord];
+    layer.textureTransform = drawCallState.getTransformData().textureTransform;
+    layer.albedoTexture = layer.materialData.getColorTexture();
+    layer.roughnessConstant = RtxOptions::Get()->legacyMaterial.roughnessConstant();
+
+    const bool hasOpaqueOverride = overrideMaterialData != nullptr && overrideMaterialData->getType() == MaterialDataType::Opaque;
+
+    if (hasOpaqueOverride) {
+      const OpaqueMaterialData& opaqueMaterialData = overrideMaterialData->getOpaqueMaterialData();
+
+      if (opaqueMaterialData.getAlbedoOpacityTexture().isValid()) {
+        layer.albedoTexture = opaqueMaterialData.getAlbedoOpacityTexture();
+      }
+
+      layer.normalTexture = opaqueMaterialData.getNormalTexture();
+      layer.roughnessTexture = opaqueMaterialData.getRoughnessTexture();
+      layer.roughnessConstant = opaqueMaterialData.getRoughnessConstant();
+    }
+
+    // Note: Compositing happens in texture space, so every input must be a function of the texture coordinates alone
+    layer.bakeable =
+      drawCallState.getGeometryData().texcoordBuffer.defined() &&
+      drawCallState.getTransformData().texgenMode == TexGenMode::None &&
+      !usesVertexColor(layer.materialData) &&
+      (overrideMaterialData == nullptr || hasOpaqueOverride) &&
+      layer.albedoTexture.getImageView() != nullptr;
+
+    // Everything the bake of this layer depends on
+    const TerrainBlendLayerState state = toLayerState(layer.materialData, false);
+    const uint32_t residency =
+      (layer.albedoTexture.isFullyResident() ? 1 : 0) |
+      (layer.normalTexture.isFullyResident() ? 2 : 0) |
+      (layer.roughnessTexture.isFullyResident() ? 4 : 0);
+
+    XXH64_hash_t hash = layer.materialData.getHash();
+    hash = XXH64(&state, sizeof(state), hash);
+    hash = XXH64(&residency, sizeof(residency), hash);
+
+    if (overrideMaterialData != nullptr) {
+      const XXH64_hash_t overrideHash = overrideMaterialData->getHash();
+      hash = XXH64(&overrideHash, sizeof(overrideHash), hash);
+    }
+
+    layer.inputHash = hash;
+
+    return layer;
+  }
+
+  TerrainBaker::LayerAction TerrainBaker::registerLayer(const DrawCallState& drawCallState, const MaterialData* overrideMaterialData,
+                                                        std::optional<DrawCallState>& bakedDrawCallState, const MaterialData*& bakedMaterialData) {
+    const uint32_t currentFrame = m_device->getCurrentFrameId();
+    // Note: Tiled terrain reuses the same chunk geometry for separate patches, the transform keeps their stacks apart
+    const Matrix4& objectToWorld = drawCallState.getTransformData().objectToWorld;
+    const XXH64_hash_t geometryHash = drawCallState.getGeometryData().getHashForRule(RtxOptions::Get()->GeometryAssetHashRule);
+    const XXH64_hash_t stackHash = XXH64(&objectToWorld, sizeof(objectToWorld), geometryHash);
+
+    Stack& stack = m_stacks[stackHash];
+
+    if (stack.frameLastRecorded != currentFrame) {
+      stack.layers.clear();
+      stack.frameLastRecorded = currentFrame;
+    }
+
+    // Note: Layers of a stack are drawn bottom to top, the draw order within the frame is the layer index
+    const size_t layerIndex = stack.layers.size();
+    stack.layers.emplace_back(createLayer(drawCallState, overrideMaterialData));
+
+    const Layer& layer = stack.layers.back();
+
+    if (!stack.bakedMaterial.has_value() ||
+        layerIndex >= stack.bakedLayerHashes.size() ||
+        stack.bakedLayerHashes[layerIndex] != layer.inputHash) {
+      return LayerAction::Draw;
+    }
+
+    if (layerIndex > 0) {
+      return LayerAction::Skip;
+    }
+
+    // The texture stage state of the base layer has been baked, so it must not be applied again when tracing
+    LegacyMaterialData materialData = drawCallState.getMaterialData();
+    materialData.textureColorArg1Source = RtTextureArgSource::Texture;
+    materialData.textureColorArg2Source = RtTextureArgSource::None;
+    materialData.textureColorOperation = DxvkRtTextureOperation::SelectArg1;
+    materialData.textureAlphaArg1Source = RtTextureArgSource::Texture;
+    materialData.textureAlphaArg2Source = RtTextureArgSource::None;
+    materialData.textureAlphaOperation = DxvkRtTextureOperation::SelectArg1;
+    materialData.tFactor = 0xffffffff;
+    materialData.alphaBlendEnabled = false;
+
+    bakedDrawCallState.emplace(
+      drawCallState.getGeometryData(),
+      materialData,
+      drawCallState.getTransformData(),
+      drawCallState.getSkinningState(),
+      drawCallState.getFogState(),
+      drawCallState.getStencilEnabledState());
+
+    bakedMaterialData = &*stack.bakedMaterial;
+
+    return LayerAction::DrawBaked;
+  }
+
+  bool TerrainBaker::isStackBakeable(const Stack& stack) const {
+    if (stack.layers.size() < 2) {
+      return false;
+    }
+
+    const Layer& base = stack.layers[0];
+
+    for (const Layer& layer : stack.layers) {
+      // Note: Layers must share the texture space of the base layer for the baked textures to be exact
+      if (!layer.bakeable || layer.texcoordHash != base.texcoordHash || layer.textureTransform != base.textureTransform) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void TerrainBaker::prepareSceneData(Rc<RtxContext> ctx) {
+    if (!RtxOptions::Get()->enableTerrainBaking()) {
+      return;
+    }
+
+    const uint32_t currentFrame = m_device->getCurrentFrameId();
+
+    for (auto& entry : m_stacks) {
+      Stack& stack = entry.second;
+
+      if (stack.frameLastRecorded != currentFrame) {
+        continue;
+      }
+
+      bool isUpToDate = stack.bakedMaterial.has_value() && stack.bakedLayerHashes.size() == stack.layers.size();
+
+      for (size_t i = 0; isUpToDate && i < stack.layers.size(); ++i) {
+        isUpToDate = stack.bakedLayerHashes[i] == stack.layers[i].inputHash;
+      }
+
+      if (isUpToDate) {
+        continue;
+      }
+
+      if (!isStackBakeable(stack)) {
+        // Fall back to drawing every layer
+        stack.bakedMaterial.reset();
+        stack.bakedLayerHashes.clear();
+        continue;
+      }
+
+      bakeStack(ctx, stack);
+    }
+  }
+
+  void TerrainBaker::bakeStack(Rc<RtxContext> ctx, Stack& stack) {
+    ScopedGpuProfileZone(ctx, "Terrain Bake");
+
+    // Bake at the resolution of the base layer, within the configured limit
+    VkExtent3D extent = stack.layers[0].albedoTexture.getImageView()->image()->info().extent;
+    extent.depth = 1;
+
+    const uint32_t maxResolution = std::max(RtxOptions::Get()->terrainBakingMaxResolution(), 1u);
+
+    while (std::max(extent.width, extent.height) > maxResolution) {
+      extent.width = std::max(extent.width / 2, 1u);
+      extent.height = std::max(extent.height / 2, 1u);
+    }
+
+    if (!stack.albedo.isValid() ||
+        stack.albedo.image->info().extent.width != extent.width ||
+        stack.albedo.image->info().extent.height != extent.height) {
+      Rc<DxvkContext> dxvkCtx = ctx;
+      stack.albedo = Resources::createImageResource(dxvkCtx, extent, VK_FORMAT_R8G8B8A8_UNORM);
+      stack.normal = Resources::createImageResource(dxvkCtx, extent, VK_FORMAT_R16G16_UNORM);
+      stack.roughness = Resources::createImageResource(dxvkCtx, extent, VK_FORMAT_R8_UNORM);
+    }
+
+    Rc<DxvkSampler> sampler = ctx->getResourceManager().getSampler(VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT);
+
+    ctx->bindResourceView(TERRAIN_BAKE_ALBEDO_OUTPUT, stack.albedo.view, nullptr);
+    ctx->bindResourceView(TERRAIN_BAKE_NORMAL_OUTPUT, stack.normal.view, nullptr);
+    ctx->bindResourceView(TERRAIN_BAKE_ROUGHNESS_OUTPUT, stack.roughness.view, nullptr);
+    ctx->bindShader(VK_SHADER_STAGE_COMPUTE_BIT, TerrainBakeShader::getShader());
+
+    const VkExtent3D workgroups = util::computeBlockCount(extent, VkExtent3D { TERRAIN_BAKE_BLOCK_SIZE, TERRAIN_BAKE_BLOCK_SIZE, 1 });
+
+    bool hasNormals = false;
+    stack.bakedLayerHashes.clear();
+
+    // Composite bottom to top, each layer reads the result of the previous one
+    for (size_t i = 0; i < stack.layers.size(); ++i) {
+      const Layer& layer = stack.layers[i];
+      DxvkImageView* normalView = layer.normalTexture.getImageView();
+      DxvkImageView* roughnessView = layer.roughnessTexture.getImageView();
+
+      TerrainBakeArgs args {};
+      args.layer = toLayerState(layer.materialData, i == 0);
+      args.resolution = { extent.width, extent.height };
+      args.rcpResolution = { 1.f / extent.width, 1.f / extent.height };
+      args.isBaseLayer = i == 0;
+      args.hasNormalTexture = normalView != nullptr;
+      args.hasRoughnessTexture = roughnessView != nullptr;
+      args.roughnessConstant = layer.roughnessConstant;
+
+      ctx->bindResourceView(TERRAIN_BAKE_ALBEDO_INPUT, layer.albedoTexture.getImageView(), nullptr);
+      ctx->bindResourceSampler(TERRAIN_BAKE_ALBEDO_INPUT, sampler);
+      ctx->bindResourceView(TERRAIN_BAKE_NORMAL_INPUT, normalView, nullptr);
+      ctx->bindResourceSampler(TERRAIN_BAKE_NORMAL_INPUT, sampler);
+      ctx->bindResourceView(TERRAIN_BAKE_ROUGHNESS_INPUT, roughnessView, nullptr);
+      ctx->bindResourceSampler(TERRAIN_BAKE_ROUGHNESS_INPUT, sampler);
+
+      ctx->pushConstants(0, sizeof(args), &args);
+      ctx->dispatch(workgroups.width, workgroups.height, workgroups.depth);
+
+      hasNormals |= normalView != nullptr;
+      stack.bakedLayerHashes.push_back(layer.inputHash);
+    }
+
+    const LegacyMaterialDefaults& defaults = RtxOptions::Get()->legacyMaterial;
+
+    stack.bakedMaterial.emplace(OpaqueMaterialData(
+      TextureRef(sampler, stack.albedo.view), hasNormals ? TextureRef(sampler, stack.normal.view) : TextureRef(),
+      TextureRef(), TextureRef(sampler, stack.roughness.view),
+      TextureRef(), TextureRef(),
+      defaults.anisotropy(), defaults.emissiveIntensity(),
+      Vector4(defaults.albedoConstant(), defaults.opacityConstant()),
+      defaults.roughnessConstant(), defaults.metallicConstant(),
+      defaults.emissiveColorConstant(), false,
+      1, 1, 0,
+      false, false, defaults.thinFilmThicknessConstant(),
+      false, false, BlendType::kAlpha, false,
+      AlphaTestType::kAlways, 0));
+  }
+
+  void TerrainBaker::garbageCollection(uint32_t currentFrame) {
+    const uint32_t numFramesToKeep = RtxOptions::Get()->numFramesToKeepGeometryData();
+
+    for (auto iter = m_stacks.begin(); iter != m_stacks.end(); ) {
+      if (iter->second.frameLastRecorded + numFramesToKeep < currentFrame) {
+        iter = m_stacks.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  void TerrainBaker::clear() {
+    m_stacks.clear();
+  }
+} // namespace dxvk
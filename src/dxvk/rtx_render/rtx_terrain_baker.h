@@ -0,0 +1,106 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "../util/rc/util_rc_ptr.h"
+#include "rtx_utils.h"
+#include "rtx_types.h"
+#include "rtx_materials.h"
+#include "rtx_resources.h"
+
+namespace dxvk {
+  class RtxContext;
+  class DxvkDevice;
+
+  // Bakes stacks of blended terrain layers (see rtx.terrainTextures) into a single opaque surface.
+  //
+  // Games draw terrain as the same chunk of geometry several times, each pass blending one more layer over the previous ones
+  // with fixed function texture stage and framebuffer blend state. Instead of tracing every layer as a stacked decal, the layers
+  // of a stack are composited once, in the texture space they share, into albedo/normal/roughness textures and only the bottom
+  // layer is traced with the baked material. Stacks are identified by geometry hash and object to world transform, and re-baked whenever any layer's inputs change.
+  class TerrainBaker {
+  public:
+    enum class LayerAction {
+      Draw,       // Not part of a baked stack, draw as usual
+      DrawBaked,  // Base layer of a baked stack, draw with the baked material
+      Skip        // Upper layer already composited into the baked material
+    };
+
+    TerrainBaker(TerrainBaker const&) = delete;
+    TerrainBaker& operator=(TerrainBaker const&) = delete;
+
+    TerrainBaker(Rc<DxvkDevice> device);
+    ~TerrainBaker();
+
+    // Records a terrain layer draw and decides how it should be drawn. For LayerAction::DrawBaked the base layer's draw
+    // call state with its fixed function state already applied by the bake, and the baked material, are returned.
+    LayerAction registerLayer(const DrawCallState& drawCallState, const MaterialData* overrideMaterialData,
+                              std::optional<DrawCallState>& bakedDrawCallState, const MaterialData*& bakedMaterialData);
+
+    // Bakes the stacks whose layers changed during the frame
+    void prepareSceneData(Rc<RtxContext> ctx);
+
+    void garbageCollection(uint32_t currentFrame);
+
+    void clear();
+
+  private:
+    struct Layer {
+      XXH64_hash_t inputHash = kEmptyHash;
+      bool bakeable = false;
+
+      LegacyMaterialData materialData;
+      XXH64_hash_t texcoordHash = kEmptyHash;
+      Matrix4 textureTransform;
+
+      TextureRef albedoTexture;
+      TextureRef normalTexture;
+      TextureRef roughnessTexture;
+      float roughnessConstant = 0.f;
+    };
+
+    struct Stack {
+      // Layers drawn in the frame the stack was last recorded, bottom to top
+      std::vector<Layer> layers;
+      uint32_t frameLastRecorded = UINT32_MAX;
+
+      // Input hashes of the layers composited into the baked textures
+      std::vector<XXH64_hash_t> bakedLayerHashes;
+      Resources::Resource albedo;
+      Resources::Resource normal;
+      Resources::Resource roughness;
+      std::optional<MaterialData> bakedMaterial;
+    };
+
+    Layer createLayer(const DrawCallState& drawCallState, const MaterialData* overrideMaterialData) const;
+
+    bool isStackBakeable(const Stack& stack) const;
+
+    void bakeStack(Rc<RtxContext> ctx, Stack& stack);
+
+    Rc<DxvkDevice> m_device;
+    fast_unordered_cache<Stack> m_stacks;
+  };
+} // namespace dxvk
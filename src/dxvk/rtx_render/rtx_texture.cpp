@@ -283,7 +283,10 @@ namespace dxvk {
       texture->linearImageDataSmallMips = pStagingData;
       texture->numLargeMips = desc.mipLevels - preloadMips;
       texture->minUploadedMip = desc.mipLevels;
-      texture->state = ManagedTexture::State::kHostMem;
+
+      // Note: Residency changes reload the mips while queued for upload, the texture is not done until it is resident again
+      if (texture->state != ManagedTexture::State::kQueuedForUpload)
+        texture->state = ManagedTexture::State::kHostMem;
     }
   }
 
@@ -413,10 +416,13 @@ namespace dxvk {
       minimumMipLevel = RtxOptions::Get()->getInitialSkipReplacementTextureMipMapLevel();
 
     // Adjust the asset data view if necessary
-    if (minimumMipLevel != 0 && texture->mipCount > 1) {
+    // Note: The view is reset as well when going back to the top mip, sampler feedback may move a texture in both directions
+    ImageAssetDataView* assetDataView = static_cast<ImageAssetDataView*>(&*texture->assetData);
+    if (texture->mipCount > 1 && (minimumMipLevel != 0 || assetDataView->getMinLevel() != 0)) {
       const int baseLevel = std::min(minimumMipLevel, (int) texture->mipCount - 1);
-      static_cast<ImageAssetDataView*>(&*texture->assetData)->setMinLevel(baseLevel);
+      assetDataView->setMinLevel(baseLevel);
     }
+    texture->residentMipLevel = assetDataView->getMinLevel();
 
     // Adjust image create info
     texture->futureImageDesc.extent = texture->assetData->info().extent;
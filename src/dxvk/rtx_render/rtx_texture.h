@@ -24,6 +24,7 @@
 #include "rtx_utils.h"
 #include "dxvk_context_state.h"
 #include "rtx_asset_data.h"
+#include "rtx_texture_residency.h"
 
 namespace gli {
   class texture;
@@ -83,6 +84,9 @@ namespace dxvk {
     std::shared_ptr<uint8_t> linearImageDataSmallMips;  // mips numLargeMips..mipLevels
     int numLargeMips = -1;                              // how many mips were not preloaded (i.e., number of mips in linearImageDataLargeMips)
     int largestMipLevel = 0;                            // biggest mip that we're willing to load
+    uint32_t residentMipLevel = 0;                      // first mip of the source asset present in the image
+    int reloadMipLevel = -1;                            // first mip of a queued residency change, see RtxTextureManager::changeResidentMip
+    TextureResidencyHistory residencyHistory;           // mips sampled by the path tracer, see sampler feedback
 
     // Stage 2 - Video memory (stripped top mips) cache.
     Rc<DxvkImageView> smallMipsImageView = nullptr;
@@ -96,6 +100,7 @@ namespace dxvk {
     DxvkImageCreateInfo futureImageDesc;
     bool canDemote = true;
     uint32_t frameQueuedForUpload = 0;
+    uint32_t frameDemoted = UINT32_MAX;                 // last frame the texture was demoted to free video memory
 
     bool good() const {
       return state != State::kUnknown && state != State::kFailed;
@@ -206,6 +211,16 @@ namespace dxvk {
       m_imageView = nullptr;
     }
 
+    // Swaps in the image of a completed mip residency change, the previous image stays bound until then.
+    bool finalizeResidencyChange() {
+      if (isFullyResident() && m_managedTexture.ptr() && m_managedTexture->state == ManagedTexture::State::kVidMem &&
+          m_managedTexture->allMipsImageView.ptr() && m_imageView != m_managedTexture->allMipsImageView) {
+        m_imageView = m_managedTexture->allMipsImageView;
+        return true;
+      }
+      return false;
+    }
+
     // If we have a valid full resource here, the managed texture has served it's purpose.
     bool finalizePendingPromotion() {
       if (!isFullyResident() && (m_managedTexture->state == ManagedTexture::State::kVidMem)) {
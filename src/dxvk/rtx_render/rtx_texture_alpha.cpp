@@ -0,0 +1,349 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_texture_alpha.h"
+
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace dxvk {
+  namespace {
+    struct AlphaBounds {
+      uint8_t minAlpha = 255;
+      uint8_t maxAlpha = 0;
+
+      void add(uint8_t alpha) {
+        minAlpha = std::min(minAlpha, alpha);
+        maxAlpha = std::max(maxAlpha, alpha);
+      }
+    };
+
+    // Accumulates the range of the bytes at the given offset within each texel of a run of texels.
+    // Texels are 1, 2 or 4 bytes and the run must start at a texel boundary.
+    void scanAlphaBytes(const uint8_t* data, size_t length, uint32_t texelSize, uint32_t alphaOffset, AlphaBounds& bounds) {
+      // Alpha lanes keep their value, the others are forced to values that don't affect the result
+      alignas(16) uint8_t alphaMask[16];
+      for (uint32_t i = 0; i < 16; i++) {
+        alphaMask[i] = (i % texelSize) == alphaOffset ? 0xFF : 0x00;
+      }
+
+      const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(alphaMask));
+      const __m128i inverseMask = _mm_xor_si128(mask, _mm_set1_epi8(-1));
+
+      __m128i minValues = _mm_set1_epi8(-1);
+      __m128i maxValues = _mm_setzero_si128();
+
+      size_t i = 0;
+
+      for (; i + 64 <= length; i += 64) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32));
+        const __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48));
+
+        minValues = _mm_min_epu8(minValues, _mm_min_epu8(_mm_min_epu8(v0, v1), _mm_min_epu8(v2, v3)));
+        maxValues = _mm_max_epu8(maxValues, _mm_max_epu8(_mm_max_epu8(v0, v1), _mm_max_epu8(v2, v3)));
+      }
+
+      for (; i + 16 <= length; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+        minValues = _mm_min_epu8(minValues, v);
+        maxValues = _mm_max_epu8(maxValues, v);
+      }
+
+      // Note: The lanes are only masked once at the end, all vector loads start at a multiple of 16 bytes
+      // so each lane always holds the same byte of a texel.
+      alignas(16) uint8_t minLanes[16];
+      alignas(16) uint8_t maxLanes[16];
+      _mm_store_si128(reinterpret_cast<__m128i*>(minLanes), _mm_or_si128(minValues, inverseMask));
+      _mm_store_si128(reinterpret_cast<__m128i*>(maxLanes), _mm_and_si128(maxValues, mask));
+
+      if (i > 0) {
+        for (uint32_t lane = alphaOffset; lane < 16; lane += texelSize) {
+          bounds.add(minLanes[lane]);
+          bounds.add(maxLanes[lane]);
+        }
+      }
+
+      for (i += alphaOffset; i < length; i += texelSize) {
+        bounds.add(data[i]);
+      }
+    }
+
+    void scanBC1Block(const uint8_t* block, AlphaBounds& bounds) {
+      uint16_t color0, color1;
+      uint32_t indices;
+      std::memcpy(&color0, block, sizeof(color0));
+      std::memcpy(&color1, block + 2, sizeof(color1));
+      std::memcpy(&indices, block + 4, sizeof(indices));
+
+      // Only blocks in 3 color mode have a transparent texel, index 3
+      if (color0 > color1) {
+        bounds.add(255);
+        return;
+      }
+
+      for (uint32_t i = 0; i < 16; i++) {
+        bounds.add(((indices >> (i * 2)) & 0x3) == 3 ? 0 : 255);
+      }
+    }
+
+    void scanBC2Block(const uint8_t* block, AlphaBounds& bounds) {
+      for (uint32_t i = 0; i < 8; i++) {
+        bounds.add((block[i] & 0xF) * 17);
+        bounds.add((block[i] >> 4) * 17);
+      }
+    }
+
+    void scanBC3Block(const uint8_t* block, AlphaBounds& bounds) {
+      const uint32_t alpha0 = block[0];
+      const uint32_t alpha1 = block[1];
+
+      uint64_t indices = 0;
+      std::memcpy(&indices, block + 2, 6);
+
+      uint32_t usedIndices = 0;
+      for (uint32_t i = 0; i < 16; i++) {
+        usedIndices |= 1u << ((indices >> (i * 3)) & 0x7);
+      }
+
+      // Interpolated values are bounded by rounding the interpolation down and up, as decoders differ in rounding
+      auto addInterpolated = [&](uint32_t weight0, uint32_t weight1, uint32_t divisor) {
+        const uint32_t sum = weight0 * alpha0 + weight1 * alpha1;
+        bounds.add(uint8_t(sum / divisor));
+        bounds.add(uint8_t((sum + divisor - 1) / divisor));
+      };
+
+      for (uint32_t index = 0; index < 8; index++) {
+        if ((usedIndices & (1u << index)) == 0) {
+          continue;
+        }
+
+        if (index == 0) {
+          bounds.add(uint8_t(alpha0));
+        } else if (index == 1) {
+          bounds.add(uint8_t(alpha1));
+        } else if (alpha0 > alpha1) {
+          addInterpolated(8 - index, index - 1, 7);
+        } else if (index < 6) {
+          addInterpolated(6 - index, index - 1, 5);
+        } else {
+          bounds.add(index == 6 ? 0 : 255);
+        }
+      }
+    }
+
+    template<typename ScanBlock>
+    void scanBlocks(const uint8_t* data, uint32_t width, uint32_t height, size_t rowPitch, size_t blockSize, const ScanBlock& scanBlock, AlphaBounds& bounds) {
+      const uint32_t blocksWide = (width + 3) / 4;
+      const uint32_t blocksHigh = (height + 3) / 4;
+
+      for (uint32_t y = 0; y < blocksHigh; y++) {
+        const uint8_t* row = data + y * rowPitch;
+
+        for (uint32_t x = 0; x < blocksWide; x++) {
+          scanBlock(row + x * blockSize, bounds);
+
+          // Nothing else can change the result once both extremes were seen
+          if (bounds.minAlpha == 0 && bounds.maxAlpha == 255) {
+            return;
+          }
+        }
+      }
+    }
+
+    // Result of the alpha test for every value of a range, if it is the same for all of them
+    enum class AlphaTestResult {
+      Mixed,
+      AllPass,
+      AllFail,
+    };
+
+    AlphaTestResult evaluateAlphaTest(const TextureAlphaRange& range, AlphaTestType type, uint8_t reference) {
+      const bool allBelow = range.maxAlpha < reference;
+      const bool allAbove = range.minAlpha > reference;
+
+      switch (type) {
+      case AlphaTestType::kAlways:
+        return AlphaTestResult::AllPass;
+      case AlphaTestType::kNever:
+        return AlphaTestResult::AllFail;
+      case AlphaTestType::kLess:
+      case AlphaTestType::kLessOrEqual:
+        return allBelow ? AlphaTestResult::AllPass : allAbove ? AlphaTestResult::AllFail : AlphaTestResult::Mixed;
+      case AlphaTestType::kGreater:
+      case AlphaTestType::kGreaterOrEqual:
+        return allAbove ? AlphaTestResult::AllPass : allBelow ? AlphaTestResult::AllFail : AlphaTestResult::Mixed;
+      case AlphaTestType::kEqual:
+        return allBelow || allAbove ? AlphaTestResult::AllFail : AlphaTestResult::Mixed;
+      case AlphaTestType::kNotEqual:
+        return allBelow || allAbove ? AlphaTestResult::AllPass : AlphaTestResult::Mixed;
+      }
+
+      return AlphaTestResult::Mixed;
+    }
+  }
+
+  size_t getTextureAlphaRowPitch(TextureAlphaFormat format, uint32_t width) {
+    size_t rowSize = 0;
+
+    switch (format) {
+    case TextureAlphaFormat::A8R8G8B8: rowSize = size_t(width) * 4; break;
+    case TextureAlphaFormat::A8L8:
+    case TextureAlphaFormat::A4R4G4B4:
+    case TextureAlphaFormat::A1R5G5B5: rowSize = size_t(width) * 2; break;
+    case TextureAlphaFormat::A8: rowSize = width; break;
+    case TextureAlphaFormat::BC1: rowSize = size_t((width + 3) / 4) * 8; break;
+    case TextureAlphaFormat::BC2:
+    case TextureAlphaFormat::BC3: rowSize = size_t((width + 3) / 4) * 16; break;
+    default: break;
+    }
+
+    return (rowSize + 3) & ~size_t(3);
+  }
+
+  TextureAlphaRange computeTextureAlphaRange(TextureAlphaFormat format, const void* data, uint32_t width, uint32_t height, size_t rowPitch) {
+    if (format == TextureAlphaFormat::Opaque) {
+      return TextureAlphaRange::known(255, 255);
+    }
+
+    if (format == TextureAlphaFormat::Unknown || data == nullptr || width == 0 || height == 0) {
+      return TextureAlphaRange {};
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    AlphaBounds bounds;
+
+    switch (format) {
+    case TextureAlphaFormat::BC1:
+      scanBlocks(bytes, width, height, rowPitch, 8, scanBC1Block, bounds);
+      break;
+    case TextureAlphaFormat::BC2:
+      scanBlocks(bytes, width, height, rowPitch, 16, scanBC2Block, bounds);
+      break;
+    case TextureAlphaFormat::BC3:
+      scanBlocks(bytes, width, height, rowPitch, 16, scanBC3Block, bounds);
+      break;
+    default: {
+      const uint32_t texelSize = format == TextureAlphaFormat::A8R8G8B8 ? 4 : format == TextureAlphaFormat::A8 ? 1 : 2;
+      const uint32_t alphaOffset = texelSize - 1;
+      const size_t rowSize = size_t(width) * texelSize;
+
+      if (rowPitch == rowSize) {
+        scanAlphaBytes(bytes, rowSize * height, texelSize, alphaOffset, bounds);
+      } else {
+        for (uint32_t y = 0; y < height; y++) {
+          scanAlphaBytes(bytes + y * rowPitch, rowSize, texelSize, alphaOffset, bounds);
+        }
+      }
+
+      // The high byte of packed 16 bit formats holds the alpha bits at the top, which order the same way as the alpha itself
+      if (format == TextureAlphaFormat::A4R4G4B4) {
+        bounds.minAlpha = (bounds.minAlpha >> 4) * 17;
+        bounds.maxAlpha = (bounds.maxAlpha >> 4) * 17;
+      } else if (format == TextureAlphaFormat::A1R5G5B5) {
+        bounds.minAlpha = (bounds.minAlpha >> 7) * 255;
+        bounds.maxAlpha = (bounds.maxAlpha >> 7) * 255;
+      }
+      break;
+    }
+    }
+
+    return TextureAlphaRange::known(bounds.minAlpha, bounds.maxAlpha);
+  }
+
+  TextureAlphaRange applyTextureStageAlpha(const TextureAlphaRange& textureRange, DxvkRtTextureOperation operation,
+                                           RtTextureArgSource arg1, RtTextureArgSource arg2, uint8_t tFactorAlpha) {
+    if (!textureRange.isKnown) {
+      return TextureAlphaRange {};
+    }
+
+    switch (operation) {
+    case DxvkRtTextureOperation::SelectArg1:
+      return arg1 == RtTextureArgSource::Texture ? textureRange : TextureAlphaRange {};
+    case DxvkRtTextureOperation::SelectArg2:
+      return arg2 == RtTextureArgSource::Texture ? textureRange : TextureAlphaRange {};
+    case DxvkRtTextureOperation::Modulate: {
+      const bool modulatesTexture =
+        (arg1 == RtTextureArgSource::Texture && arg2 == RtTextureArgSource::TFactor) ||
+        (arg1 == RtTextureArgSource::TFactor && arg2 == RtTextureArgSource::Texture);
+
+      if (!modulatesTexture) {
+        return TextureAlphaRange {};
+      }
+
+      // Round outwards, the product is compared and blended in floating point
+      const uint32_t minProduct = uint32_t(textureRange.minAlpha) * tFactorAlpha;
+      const uint32_t maxProduct = uint32_t(textureRange.maxAlpha) * tFactorAlpha;
+      return TextureAlphaRange::known(uint8_t(minProduct / 255), uint8_t((maxProduct + 254) / 255));
+    }
+    default:
+      return TextureAlphaRange {};
+    }
+  }
+
+  AlphaCoverage classifyAlphaCoverage(const TextureAlphaRange& alphaRange, AlphaTestType alphaTestType, uint8_t alphaTestReferenceValue,
+                                      bool blendEnabled, BlendType blendType, bool invertedBlend) {
+    if (!alphaRange.isKnown) {
+      return AlphaCoverage::Mixed;
+    }
+
+    const AlphaTestResult alphaTest = evaluateAlphaTest(alphaRange, alphaTestType, alphaTestReferenceValue);
+
+    if (alphaTest == AlphaTestResult::Mixed) {
+      return AlphaCoverage::Mixed;
+    }
+
+    if (!blendEnabled) {
+      // Without blending a surface is opaque wherever the tested alpha is above zero
+      if (alphaTest == AlphaTestResult::AllFail || alphaRange.maxAlpha == 0) {
+        return AlphaCoverage::Transparent;
+      }
+
+      return alphaRange.minAlpha > 0 ? AlphaCoverage::Opaque : AlphaCoverage::Mixed;
+    }
+
+    // Only plain alpha blending is decided by alpha alone, the other blend types also depend on the color
+    if (blendType != BlendType::kAlpha) {
+      return AlphaCoverage::Mixed;
+    }
+
+    if (alphaTest == AlphaTestResult::AllFail) {
+      // Note: Failing texels get an alpha of 0, which inverted blending would turn opaque rather than discard
+      return invertedBlend ? AlphaCoverage::Mixed : AlphaCoverage::Transparent;
+    }
+
+    const uint8_t opaqueAlpha = invertedBlend ? 0 : 255;
+    const uint8_t transparentAlpha = invertedBlend ? 255 : 0;
+
+    if (alphaRange.minAlpha == opaqueAlpha && alphaRange.maxAlpha == opaqueAlpha) {
+      return AlphaCoverage::Opaque;
+    }
+
+    if (alphaRange.minAlpha == transparentAlpha && alphaRange.maxAlpha == transparentAlpha) {
+      return AlphaCoverage::Transparent;
+    }
+
+    return AlphaCoverage::Mixed;
+  }
+}
@@ -0,0 +1,92 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../shaders/rtx/concept/surface/surface_shared.h"
+
+namespace dxvk {
+  // Texel layouts whose alpha channel can be analyzed on the CPU
+  enum class TextureAlphaFormat : uint8_t {
+    Unknown,
+    Opaque,   // No alpha channel, alpha always reads as 1
+    A8R8G8B8, // 32 bit texels with alpha in the last byte, also A8B8G8R8
+    A8L8,     // 16 bit texels with alpha in the last byte
+    A8,
+    A4R4G4B4,
+    A1R5G5B5,
+    BC1,
+    BC2,
+    BC3,
+  };
+
+  // Range of the 8 bit alpha values in a texture, only meaningful when known
+  struct TextureAlphaRange {
+    uint8_t minAlpha = 0;
+    uint8_t maxAlpha = 255;
+    bool isKnown = false;
+
+    static TextureAlphaRange known(uint8_t minAlpha, uint8_t maxAlpha) {
+      return TextureAlphaRange { minAlpha, maxAlpha, true };
+    }
+
+    // Range of the union of two ranges, unknown if either is
+    static TextureAlphaRange combine(const TextureAlphaRange& a, const TextureAlphaRange& b) {
+      if (!a.isKnown || !b.isKnown) {
+        return TextureAlphaRange {};
+      }
+
+      return known(a.minAlpha < b.minAlpha ? a.minAlpha : b.minAlpha, a.maxAlpha > b.maxAlpha ? a.maxAlpha : b.maxAlpha);
+    }
+
+    bool operator==(const TextureAlphaRange& other) const {
+      return minAlpha == other.minAlpha && maxAlpha == other.maxAlpha && isKnown == other.isKnown;
+    }
+  };
+
+  // What the alpha test and blending of a surface do with every alpha value of a range
+  enum class AlphaCoverage : uint8_t {
+    Mixed,       // Depends on the texel, or cannot be proven
+    Opaque,      // Every texel is fully opaque
+    Transparent, // Every texel is discarded or fully transparent
+  };
+
+  // Row pitch of tightly packed texture data with 4 byte aligned rows, in bytes. Rows of block
+  // compressed formats are rows of 4x4 blocks.
+  size_t getTextureAlphaRowPitch(TextureAlphaFormat format, uint32_t width);
+
+  // Determines the range of alpha values in a 2D texture level
+  TextureAlphaRange computeTextureAlphaRange(TextureAlphaFormat format, const void* data, uint32_t width, uint32_t height, size_t rowPitch);
+
+  // Range of the alpha value a legacy texture stage produces from a texture alpha range.
+  // Only stages that select the texture alpha or modulate it by the texture factor are supported.
+  TextureAlphaRange applyTextureStageAlpha(const TextureAlphaRange& textureRange, DxvkRtTextureOperation operation,
+                                           RtTextureArgSource arg1, RtTextureArgSource arg2, uint8_t tFactorAlpha);
+
+  // Classifies a surface by evaluating its alpha test and blending for the range of its alpha values.
+  // Comparisons against the reference value are only trusted with a margin of one step, as the shader
+  // compares in half precision.
+  AlphaCoverage classifyAlphaCoverage(const TextureAlphaRange& alphaRange, AlphaTestType alphaTestType, uint8_t alphaTestReferenceValue,
+                                      bool blendEnabled, BlendType blendType, bool invertedBlend);
+}
@@ -0,0 +1,293 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_texture_manifest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace dxvk {
+  namespace {
+    constexpr char kManifestMagic[4] = { 'R', 'T', 'M', 'F' };
+    constexpr uint32_t kManifestVersion = 1;
+
+    template<typename T>
+    void write(std::vector<uint8_t>& data, const T& value) {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+      data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    bool read(const std::vector<uint8_t>& data, size_t& offset, T& value) {
+      if (offset + sizeof(T) > data.size()) {
+        return false;
+      }
+
+      std::memcpy(&value, data.data() + offset, sizeof(T));
+      offset += sizeof(T);
+      return true;
+    }
+  }
+
+  TextureUsageManifest::TextureUsageManifest(float cellSize)
+    : m_cellSize(std::max(cellSize, 1e-3f)) {
+  }
+
+  TextureUsageManifest::CellKey TextureUsageManifest::getCellKey(const Vector3& position) const {
+    return CellKey {
+      int32_t(std::floor(position.x / m_cellSize)),
+      int32_t(std::floor(position.y / m_cellSize)),
+      int32_t(std::floor(position.z / m_cellSize))
+    };
+  }
+
+  Vector3 TextureUsageManifest::getCellCenter(const CellKey& key) const {
+    return Vector3(
+      (float(key.x) + 0.5f) * m_cellSize,
+      (float(key.y) + 0.5f) * m_cellSize,
+      (float(key.z) + 0.5f) * m_cellSize);
+  }
+
+  bool TextureUsageManifest::record(const Vector3& cameraPosition, MaterialHash gameMaterialHash, TextureHash textureHash) {
+    Cell& cell = m_cells[getCellKey(cameraPosition)];
+
+    auto result = cell.entries.try_emplace(textureHash, Entry { textureHash, gameMaterialHash, 0 });
+    Entry& entry = result.first->second;
+
+    // Note: Saturate so long sessions can't wrap the count around
+    if (entry.useCount < UINT32_MAX) {
+      ++entry.useCount;
+    }
+
+    m_dirty = true;
+
+    return result.second;
+  }
+
+  std::vector<TextureUsageManifest::TextureHash> TextureUsageManifest::predict(const Vector3& cameraPosition, const Vector3& cameraMotion, float lookAheadDistance, uint32_t maxTextures) const {
+    std::vector<TextureHash> result;
+
+    if (m_cells.empty() || maxTextures == 0) {
+      return result;
+    }
+
+    struct Candidate {
+      float distance;
+      uint32_t useCount;
+    };
+
+    std::unordered_map<TextureHash, Candidate> candidates;
+
+    auto gatherCell = [&](const CellKey& key) {
+      auto cellIt = m_cells.find(key);
+
+      if (cellIt == m_cells.end()) {
+        return;
+      }
+
+      const float distance = length(getCellCenter(key) - cameraPosition);
+
+      for (const auto& [hash, entry] : cellIt->second.entries) {
+        auto inserted = candidates.try_emplace(hash, Candidate { distance, entry.useCount });
+
+        if (!inserted.second) {
+          Candidate& candidate = inserted.first->second;
+          candidate.distance = std::min(candidate.distance, distance);
+          candidate.useCount = std::max(candidate.useCount, entry.useCount);
+        }
+      }
+    };
+
+    // Walk along the extrapolated camera path one cell at a time, gathering each cell and its direct neighbors
+    const float motionLength = length(cameraMotion);
+    const Vector3 direction = motionLength > 0.0f ? cameraMotion / motionLength : Vector3(0.0f);
+    const uint32_t numSteps = motionLength > 0.0f ? uint32_t(std::ceil(std::max(lookAheadDistance, 0.0f) / m_cellSize)) : 0;
+
+    CellKey lastKey = getCellKey(cameraPosition);
+    bool first = true;
+
+    for (uint32_t step = 0; step <= numSteps; ++step) {
+      const CellKey key = getCellKey(cameraPosition + direction * (float(step) * m_cellSize));
+
+      if (!first && key == lastKey) {
+        continue;
+      }
+
+      first = false;
+      lastKey = key;
+
+      for (int32_t z = -1; z <= 1; ++z) {
+        for (int32_t y = -1; y <= 1; ++y) {
+          for (int32_t x = -1; x <= 1; ++x) {
+            gatherCell(CellKey { key.x + x, key.y + y, key.z + z });
+          }
+        }
+      }
+    }
+
+    std::vector<std::pair<TextureHash, Candidate>> sorted(candidates.begin(), candidates.end());
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+      if (a.second.distance != b.second.distance) {
+        return a.second.distance < b.second.distance;
+      }
+
+      if (a.second.useCount != b.second.useCount) {
+        return a.second.useCount > b.second.useCount;
+      }
+
+      // Note: Keep the ordering deterministic
+      return a.first < b.first;
+    });
+
+    const size_t count = std::min(sorted.size(), size_t(maxTextures));
+    result.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      result.push_back(sorted[i].first);
+    }
+
+    return result;
+  }
+
+  bool TextureUsageManifest::serialize(std::vector<uint8_t>& outData) const {
+    outData.clear();
+
+    write(outData, kManifestMagic);
+    write(outData, kManifestVersion);
+    write(outData, m_cellSize);
+    write(outData, uint32_t(m_cells.size()));
+
+    for (const auto& [key, cell] : m_cells) {
+      write(outData, key.x);
+      write(outData, key.y);
+      write(outData, key.z);
+      write(outData, uint32_t(cell.entries.size()));
+
+      for (const auto& [hash, entry] : cell.entries) {
+        write(outData, entry.textureHash);
+        write(outData, entry.gameMaterialHash);
+        write(outData, entry.useCount);
+      }
+    }
+
+    return true;
+  }
+
+  bool TextureUsageManifest::deserialize(const std::vector<uint8_t>& data) {
+    size_t offset = 0;
+
+    char magic[4];
+    uint32_t version;
+    float cellSize;
+    uint32_t cellCount;
+
+    if (!read(data, offset, magic) || std::memcmp(magic, kManifestMagic, sizeof(magic)) != 0) {
+      return false;
+    }
+
+    if (!read(data, offset, version) || version != kManifestVersion) {
+      return false;
+    }
+
+    if (!read(data, offset, cellSize) || !(cellSize > 0.0f) || !read(data, offset, cellCount)) {
+      return false;
+    }
+
+    decltype(m_cells) cells;
+
+    for (uint32_t i = 0; i < cellCount; ++i) {
+      CellKey key;
+      uint32_t entryCount;
+
+      if (!read(data, offset, key.x) || !read(data, offset, key.y) || !read(data, offset, key.z) || !read(data, offset, entryCount)) {
+        return false;
+      }
+
+      Cell& cell = cells[key];
+
+      for (uint32_t j = 0; j < entryCount; ++j) {
+        Entry entry;
+
+        if (!read(data, offset, entry.textureHash) || !read(data, offset, entry.gameMaterialHash) || !read(data, offset, entry.useCount)) {
+          return false;
+        }
+
+        cell.entries[entry.textureHash] = entry;
+      }
+    }
+
+    // Note: Only commit the result once the whole manifest was read successfully
+    m_cellSize = cellSize;
+    m_cells = std::move(cells);
+    m_dirty = false;
+
+    return true;
+  }
+
+  bool TextureUsageManifest::writeToFile(const std::string& path) const {
+    std::vector<uint8_t> data;
+
+    if (!serialize(data)) {
+      return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (!file) {
+      return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    return file.good();
+  }
+
+  bool TextureUsageManifest::readFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file) {
+      return false;
+    }
+
+    const std::vector<uint8_t> data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    return deserialize(data);
+  }
+
+  void TextureUsageManifest::clear() {
+    m_cells.clear();
+    m_dirty = false;
+  }
+
+  size_t TextureUsageManifest::getEntryCount() const {
+    size_t count = 0;
+
+    for (const auto& [key, cell] : m_cells) {
+      count += cell.entries.size();
+    }
+
+    return count;
+  }
+} // namespace dxvk
@@ -0,0 +1,102 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../util/util_vector.h"
+
+namespace dxvk {
+  /**
+   * \brief Texture usage manifest
+   *
+   * Records which replacement textures were used while the camera was in a given region of
+   * the world (quantized to a uniform grid of cells), along with the game material hash which
+   * referenced them. On later runs the manifest is queried with the current camera position and
+   * motion to produce an ordered list of replacement textures worth streaming in ahead of time.
+   */
+  class TextureUsageManifest {
+  public:
+    typedef uint64_t TextureHash;
+    typedef uint64_t MaterialHash;
+
+    struct Entry {
+      TextureHash textureHash;
+      MaterialHash gameMaterialHash;
+      uint32_t useCount;
+    };
+
+    explicit TextureUsageManifest(float cellSize = 1000.0f);
+
+    // Records a use of a replacement texture by a game material while the camera was at the given position.
+    // Returns true if this texture was not yet recorded for the cell the camera is in.
+    bool record(const Vector3& cameraPosition, MaterialHash gameMaterialHash, TextureHash textureHash);
+
+    // Returns up to maxTextures replacement textures likely to be needed soon, given the current camera position and
+    // a per frame motion vector. Cells along the extrapolated path (up to lookAheadDistance) are considered, textures
+    // closest to the current position come first, ties are broken by how often the texture was recorded.
+    std::vector<TextureHash> predict(const Vector3& cameraPosition, const Vector3& cameraMotion, float lookAheadDistance, uint32_t maxTextures) const;
+
+    bool serialize(std::vector<uint8_t>& outData) const;
+    bool deserialize(const std::vector<uint8_t>& data);
+
+    bool writeToFile(const std::string& path) const;
+    bool readFromFile(const std::string& path);
+
+    void clear();
+
+    float getCellSize() const { return m_cellSize; }
+    size_t getCellCount() const { return m_cells.size(); }
+    size_t getEntryCount() const;
+    bool isDirty() const { return m_dirty; }
+
+  private:
+    struct CellKey {
+      int32_t x, y, z;
+
+      bool operator==(const CellKey& other) const {
+        return x == other.x && y == other.y && z == other.z;
+      }
+    };
+
+    struct CellKeyHash {
+      size_t operator()(const CellKey& key) const {
+        // Note: Large primes to decorrelate the axes (from "Optimized Spatial Hashing for Collision Detection of Deformable Objects")
+        return size_t(uint32_t(key.x) * 73856093u ^ uint32_t(key.y) * 19349663u ^ uint32_t(key.z) * 83492791u);
+      }
+    };
+
+    struct Cell {
+      std::unordered_map<TextureHash, Entry> entries;
+    };
+
+    CellKey getCellKey(const Vector3& position) const;
+    Vector3 getCellCenter(const CellKey& key) const;
+
+    float m_cellSize;
+    std::unordered_map<CellKey, Cell, CellKeyHash> m_cells;
+    bool m_dirty = false;
+  };
+} // namespace dxvk
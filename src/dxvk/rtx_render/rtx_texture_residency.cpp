@@ -0,0 +1,113 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_texture_residency.h"
+
+#include <algorithm>
+
+#include "rtx/utility/shared_constants.h"
+
+namespace dxvk {
+  void TextureResidencyHistory::record(uint32_t frameId, uint32_t bucketFrames, uint8_t mip) {
+    if (frameId < m_lastChangeFrame || mip == kUnsampled) {
+      return;
+    }
+
+    const uint32_t epoch = frameId / bucketFrames;
+    const uint32_t bucket = epoch % kNumBuckets;
+
+    if (m_bucketEpoch[bucket] != epoch) {
+      // The bucket holds feedback from an older window, start it over
+      m_bucketEpoch[bucket] = epoch;
+      m_bucketMinMip[bucket] = mip;
+    } else {
+      m_bucketMinMip[bucket] = std::min(m_bucketMinMip[bucket], mip);
+    }
+  }
+
+  uint8_t TextureResidencyHistory::getWindowMinMip(uint32_t frameId, uint32_t bucketFrames) const {
+    const uint32_t currentEpoch = frameId / bucketFrames;
+    uint8_t minMip = kUnsampled;
+
+    for (uint32_t i = 0; i < kNumBuckets; i++) {
+      const uint32_t epoch = m_bucketEpoch[i];
+
+      // Note: Feedback is read back a few frames late, so buckets are only required to not be older than the window
+      if (epoch == kInvalidEpoch || epoch > currentEpoch || currentEpoch - epoch >= kNumBuckets) {
+        continue;
+      }
+
+      minMip = std::min(minMip, m_bucketMinMip[i]);
+    }
+
+    return minMip;
+  }
+
+  void TextureResidencyHistory::reset(uint32_t frameId) {
+    m_bucketMinMip.fill(kUnsampled);
+    m_bucketEpoch.fill(kInvalidEpoch);
+    m_lastChangeFrame = frameId;
+  }
+
+  uint32_t TextureResidencyPolicy::getBucketFrames() const {
+    const uint32_t numBuckets = TextureResidencyHistory::kNumBuckets;
+    return std::max((windowFrames + numBuckets - 1) / numBuckets, 1u);
+  }
+
+  uint32_t TextureResidencyPolicy::selectResidentMip(const TextureResidencyHistory& history, uint32_t frameId,
+                                                     uint32_t residentMip, uint32_t minMip, uint32_t maxMip) const {
+    const uint8_t sampledMip = history.getWindowMinMip(frameId, getBucketFrames());
+
+    if (sampledMip == TextureResidencyHistory::kUnsampled) {
+      return residentMip;
+    }
+
+    uint32_t targetMip = sampledMip > mipBias ? sampledMip - mipBias : 0;
+    targetMip = std::clamp(targetMip, minMip, std::max(minMip, maxMip));
+
+    if (targetMip < residentMip) {
+      // Stream finer mips in right away, they are visibly needed
+      return targetMip;
+    }
+
+    if (targetMip > residentMip && frameId - history.getLastChangeFrame() >= windowFrames) {
+      // Only drop mips once a whole window of feedback at the current residency has not sampled them
+      return targetMip;
+    }
+
+    return residentMip;
+  }
+
+  bool decodeSamplerFeedback(uint32_t encodedFeedback, uint32_t residentMip, uint32_t mipCount, uint8_t& outMip) {
+    if (encodedFeedback == SAMPLER_FEEDBACK_UNSAMPLED || mipCount == 0) {
+      return false;
+    }
+
+    // Note: Negative relative mips request detail finer than the resident chain holds
+    const int32_t relativeMip = int32_t(std::min(encodedFeedback, uint32_t(SAMPLER_FEEDBACK_MAX_ENCODED_MIP))) - SAMPLER_FEEDBACK_MIP_OFFSET;
+    const int32_t absoluteMip = std::clamp(int32_t(residentMip) + relativeMip, 0, int32_t(mipCount) - 1);
+
+    outMip = uint8_t(std::min(absoluteMip, int32_t(TextureResidencyHistory::kUnsampled - 1)));
+
+    return true;
+  }
+
+} // namespace dxvk
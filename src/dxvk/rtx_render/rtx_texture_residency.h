@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace dxvk {
+  // Windowed history of the finest mip the path tracer sampled from a single texture.
+  // Feedback frames are folded into a small ring of buckets each covering a fixed number
+  // of frames, so the history stays a few bytes per texture regardless of the window length.
+  struct TextureResidencyHistory {
+    static constexpr uint32_t kNumBuckets = 8;
+    static constexpr uint8_t kUnsampled = 0xFF;
+    static constexpr uint32_t kInvalidEpoch = UINT32_MAX;
+
+    TextureResidencyHistory() {
+      reset(0);
+    }
+
+    // Records that the given mip was sampled on the given frame. Feedback from frames before the
+    // last residency change is discarded as it was relative to a different resident mip chain.
+    void record(uint32_t frameId, uint32_t bucketFrames, uint8_t mip);
+
+    // Returns the finest mip sampled within the buckets covering the last window, or kUnsampled.
+    uint8_t getWindowMinMip(uint32_t frameId, uint32_t bucketFrames) const;
+
+    // Drops all recorded feedback and marks the given frame as the last residency change.
+    void reset(uint32_t frameId);
+
+    uint32_t getLastChangeFrame() const {
+      return m_lastChangeFrame;
+    }
+
+  private:
+    std::array<uint8_t, kNumBuckets> m_bucketMinMip;
+    std::array<uint32_t, kNumBuckets> m_bucketEpoch;
+    uint32_t m_lastChangeFrame;
+  };
+
+  // Chooses the first resident mip of a texture from its sampling history.
+  struct TextureResidencyPolicy {
+    uint32_t windowFrames = 60;  // frames of feedback a decision to drop mips must be based on
+    uint32_t mipBias = 0;        // additional finer mips kept resident beyond the finest one sampled
+
+    uint32_t getBucketFrames() const;
+
+    // Returns the mip the texture should start its resident chain at, clamped to [minMip, maxMip].
+    // Finer mips are requested as soon as they are sampled, while mips are only dropped once a full
+    // window of feedback since the last change agrees they are unused. Textures without any feedback
+    // in the window keep their current residency, dropping them entirely is left to garbage collection.
+    uint32_t selectResidentMip(const TextureResidencyHistory& history, uint32_t frameId,
+                               uint32_t residentMip, uint32_t minMip, uint32_t maxMip) const;
+  };
+
+  // Converts a sampler feedback value written relative to the resident mip chain into an absolute
+  // mip of the source asset. Returns false for textures which were not sampled.
+  bool decodeSamplerFeedback(uint32_t encodedFeedback, uint32_t residentMip, uint32_t mipCount, uint8_t& outMip);
+
+} // namespace dxvk
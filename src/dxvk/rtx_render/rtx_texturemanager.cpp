@@ -21,6 +21,7 @@
 */
 #include "rtx_texturemanager.h"
 #include "../../util/thread.h"
+#include "../../util/util_thread_placement.h"
 #include "dxvk_context.h"
 #include "dxvk_device.h"
 #include <chrono>
@@ -28,6 +29,8 @@
 #include "rtx_texture.h"
 #include "rtx_io.h"
 
+#include "rtx/utility/shared_constants.h"
+
 namespace dxvk {
   RtxTextureManager::RtxTextureManager(const Rc<DxvkDevice>& device)
   : m_device(device),
@@ -75,6 +78,25 @@ namespace dxvk {
       break;
     }
 
+    scheduleManagedTextureUpload(managedTexture, immediateContext, allowAsync);
+  }
+
+  bool RtxTextureManager::prefetchTexture(const Rc<ManagedTexture>& texture, Rc<DxvkContext>& immediateContext) {
+    // Note: Only textures resting in host memory are prefetched, anything already resident or in-flight is left alone,
+    // and failed textures are left for a real use to retry.
+    if (texture.ptr() == nullptr || texture->state != ManagedTexture::State::kHostMem)
+      return false;
+
+    // Don't undo a demotion made to free video memory this frame
+    if (texture->frameDemoted == m_device->getCurrentFrameId())
+      return false;
+
+    scheduleManagedTextureUpload(texture, immediateContext, true);
+
+    return texture->state != ManagedTexture::State::kHostMem;
+  }
+
+  void RtxTextureManager::scheduleManagedTextureUpload(const Rc<ManagedTexture>& managedTexture, Rc<DxvkContext>& immediateContext, bool allowAsync) {
     int preloadMips = allowAsync ? calcPreloadMips(managedTexture->futureImageDesc.mipLevels) : managedTexture->futureImageDesc.mipLevels;
 
     if (RtxIo::enabled()) {
@@ -157,6 +179,7 @@ namespace dxvk {
     ZoneScoped;
 
     env::setThreadName("rtx-texture-manager");
+    ThreadPlacementService::get().applyToCurrentThread(ThreadRole::TextureStreaming);
 
     Rc<ManagedTexture> texture;
 
@@ -209,9 +232,12 @@ namespace dxvk {
           }
 
           if (m_dropRequests) {
+            texture->reloadMipLevel = -1;
             texture->state = ManagedTexture::State::kFailed;
             texture->demote();
-          } else
+          } else if (texture->reloadMipLevel >= 0)
+            reloadTexture(texture);
+          else
             uploadTexture(texture);
         }
       }
@@ -250,6 +276,36 @@ namespace dxvk {
     }
   }
 
+  void RtxTextureManager::reloadTexture(const Rc<ManagedTexture>& texture)
+  {
+    ZoneScoped;
+
+    const int mipLevel = texture->reloadMipLevel;
+    texture->reloadMipLevel = -1;
+
+    try {
+      // Note: The texture references still hold the current image and keep it bound until the new one is swapped in,
+      // see TextureRef::finalizeResidencyChange. Dropping the views here makes the promotion allocate a new image.
+      texture->smallMipsImageView = nullptr;
+      texture->allMipsImageView = nullptr;
+
+      TextureUtils::loadTexture(texture, m_device, m_ctx, TextureUtils::MemoryAperture::HOST, TextureUtils::MipsToLoad::HighMips, mipLevel);
+
+      if (texture->numLargeMips > 0) {
+        TextureUtils::loadTexture(texture, m_device, m_ctx, TextureUtils::MemoryAperture::HOST, TextureUtils::MipsToLoad::LowMips);
+      }
+
+      TextureUtils::promoteHostToVid(m_device, m_ctx, texture);
+      m_ctx->flushCommandList();
+      texture->linearImageDataLargeMips.reset();
+    }
+    catch (const DxvkError& e) {
+      texture->state = ManagedTexture::State::kFailed;
+      Logger::err("Failed to reload texture for a mip residency change!");
+      Logger::err(e.message());
+    }
+  }
+
   Rc<ManagedTexture> RtxTextureManager::preloadTexture(const Rc<AssetData>& assetData,
     ColorSpace colorSpace, const Rc<DxvkContext>& context, bool forceLoad) {
 
@@ -289,8 +345,15 @@ namespace dxvk {
     }
   }
 
-  uint32_t RtxTextureManager::updateMipMapSkipLevel(const Rc<DxvkContext>& context) {
-    // Check video memory
+  VkDeviceSize RtxTextureManager::getAvailableDeviceMemoryMib() const {
+    return getAvailableDeviceMemoryMib(true);
+  }
+
+  VkDeviceSize RtxTextureManager::getUnclampedAvailableDeviceMemoryMib() const {
+    return getAvailableDeviceMemoryMib(false);
+  }
+
+  VkDeviceSize RtxTextureManager::getAvailableDeviceMemoryMib(bool clampToBudget) const {
     VkPhysicalDeviceMemoryProperties memory = m_device->adapter()->memoryProperties();
     DxvkAdapterMemoryInfo memHeapInfo = m_device->adapter()->getMemoryHeapInfo();
     VkDeviceSize availableMemorySizeMib = 0;
@@ -303,9 +366,18 @@ namespace dxvk {
       VkDeviceSize memSizeMib = memHeapInfo.heaps[i].memoryBudget >> 20;
       VkDeviceSize memUsedMib = memHeapInfo.heaps[i].memoryAllocated >> 20;
 
-      availableMemorySizeMib = std::max(memSizeMib - memUsedMib, availableMemorySizeMib);
+      // Note: Allocations may exceed the budget, avoid wrapping around in that case unless asked not to
+      const VkDeviceSize memAvailableMib = (clampToBudget && memUsedMib > memSizeMib) ? 0 : memSizeMib - memUsedMib;
+      availableMemorySizeMib = std::max(memAvailableMib, availableMemorySizeMib);
     }
 
+    return availableMemorySizeMib;
+  }
+
+  uint32_t RtxTextureManager::updateMipMapSkipLevel(const Rc<DxvkContext>& context) {
+    // Check video memory
+    VkDeviceSize availableMemorySizeMib = getUnclampedAvailableDeviceMemoryMib();
+
     const int GB = 1024;
     RtxContext* rtxContext = dynamic_cast<RtxContext*>(context.ptr());
     if (rtxContext && !rtxContext->getResourceManager().isResourceReady()) {
@@ -334,4 +406,179 @@ namespace dxvk {
     return m_minimumMipLevel;
   }
 
+
+  bool RtxTextureManager::isSamplerFeedbackEnabled() {
+    // Note: Residency changes reload the texture through the host staging path, which RTX IO bypasses.
+    // Forced high resolution and non-adaptive modes pin the mip chain so there is nothing to decide.
+    return RtxOptions::Get()->enableSamplerFeedbackTextureResidency() &&
+           RtxOptions::Get()->enableAdaptiveResolutionReplacementTextures() &&
+           !RtxOptions::Get()->forceHighResolutionReplacementTextures() &&
+           !RtxIo::enabled();
+  }
+
+  const Rc<DxvkBuffer>& RtxTextureManager::getSamplerFeedbackBuffer(const Rc<DxvkContext>& context) {
+    if (m_samplerFeedbackBuffer == nullptr) {
+      DxvkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+      info.size = SAMPLER_FEEDBACK_MAX_TEXTURES * sizeof(uint32_t);
+      info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+      info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+      info.access = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+      m_samplerFeedbackBuffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer);
+
+      context->clearBuffer(m_samplerFeedbackBuffer, 0, info.size, SAMPLER_FEEDBACK_UNSAMPLED);
+    }
+
+    return m_samplerFeedbackBuffer;
+  }
+
+  void RtxTextureManager::resolveSamplerFeedback(const Rc<DxvkContext>& context, const std::vector<TextureRef>& textureTable) {
+    ZoneScoped;
+
+    if (!isSamplerFeedbackEnabled() || m_samplerFeedbackBuffer == nullptr) {
+      return;
+    }
+
+    const uint32_t frameId = m_device->getCurrentFrameId();
+    const uint32_t textureCount = std::min<uint32_t>(textureTable.size(), SAMPLER_FEEDBACK_MAX_TEXTURES);
+    SamplerFeedbackReadback& readback = m_samplerFeedbackReadbacks[frameId % kSamplerFeedbackLatency];
+
+    // Note: When the readback from a previous frame has not been consumed yet, this frame's feedback is dropped
+    if (!readback.pending && textureCount > 0) {
+      if (readback.buffer == nullptr) {
+        DxvkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        info.size = SAMPLER_FEEDBACK_MAX_TEXTURES * sizeof(uint32_t);
+        info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT;
+        info.access = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
+
+        readback.buffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, DxvkMemoryStats::Category::RTXBuffer);
+      }
+
+      context->copyBuffer(readback.buffer, 0, m_samplerFeedbackBuffer, 0, textureCount * sizeof(uint32_t));
+
+      // Remember which texture each bindless index referred to, slots may be reused before the feedback is read
+      readback.textureKeys.resize(textureCount);
+      for (uint32_t i = 0; i < textureCount; i++) {
+        readback.textureKeys[i] = textureTable[i].isValid() ? textureTable[i].getUniqueKey() : kInvalidTextureKey;
+      }
+
+      readback.frameId = frameId;
+      readback.pending = true;
+    }
+
+    context->clearBuffer(m_samplerFeedbackBuffer, 0, m_samplerFeedbackBuffer->info().size, SAMPLER_FEEDBACK_UNSAMPLED);
+  }
+
+  void RtxTextureManager::readSamplerFeedback(SamplerFeedbackReadback& readback, const std::vector<TextureRef>& textureTable) {
+    TextureResidencyPolicy policy;
+    policy.windowFrames = RtxOptions::Get()->textureResidencyWindowFrames();
+
+    const uint32_t bucketFrames = policy.getBucketFrames();
+    const uint32_t* feedback = static_cast<const uint32_t*>(readback.buffer->mapPtr(0));
+    const size_t textureCount = std::min(readback.textureKeys.size(), textureTable.size());
+
+    for (size_t i = 0; i < textureCount; i++) {
+      if (feedback[i] == SAMPLER_FEEDBACK_UNSAMPLED || readback.textureKeys[i] == kInvalidTextureKey) {
+        continue;
+      }
+
+      // Skip slots which were reassigned to another texture since the feedback was written
+      const TextureRef& texture = textureTable[i];
+      if (!texture.isValid() || texture.getUniqueKey() != readback.textureKeys[i]) {
+        continue;
+      }
+
+      // Note: Textures with a residency change in flight are skipped, their resident mip no longer matches the bound image
+      const Rc<ManagedTexture>& managedTexture = texture.getManagedTexture();
+      if (managedTexture == nullptr || managedTexture->state != ManagedTexture::State::kVidMem) {
+        continue;
+      }
+
+      uint8_t sampledMip;
+      if (decodeSamplerFeedback(feedback[i], managedTexture->residentMipLevel, managedTexture->mipCount, sampledMip)) {
+        managedTexture->residencyHistory.record(readback.frameId, bucketFrames, sampledMip);
+      }
+    }
+
+    readback.pending = false;
+  }
+
+  void RtxTextureManager::updateTextureResidency(std::vector<TextureRef>& textureTable) {
+    ZoneScoped;
+
+    if (!isSamplerFeedbackEnabled()) {
+      return;
+    }
+
+    const uint32_t frameId = m_device->getCurrentFrameId();
+
+    // Bind the images of residency changes the upload thread has finished
+    for (TextureRef& texture : textureTable) {
+      if (texture.finalizeResidencyChange()) {
+        texture.getManagedTexture()->residencyHistory.reset(frameId);
+      }
+    }
+
+    // Fold in all feedback the GPU is done writing
+    for (SamplerFeedbackReadback& readback : m_samplerFeedbackReadbacks) {
+      if (readback.pending && !readback.buffer->isInUse()) {
+        readSamplerFeedback(readback, textureTable);
+      }
+    }
+
+    TextureResidencyPolicy policy;
+    policy.windowFrames = RtxOptions::Get()->textureResidencyWindowFrames();
+    policy.mipBias = RtxOptions::Get()->textureResidencyMipBias();
+
+    const uint32_t minMip = std::max<int>(m_minimumMipLevel, RtxOptions::Get()->getInitialSkipReplacementTextureMipMapLevel());
+    uint32_t changesLeft = RtxOptions::Get()->textureResidencyMaxChangesPerFrame();
+
+    for (TextureRef& texture : textureTable) {
+      if (changesLeft == 0) {
+        break;
+      }
+
+      const Rc<ManagedTexture>& managedTexture = texture.getManagedTexture();
+      if (managedTexture == nullptr || !managedTexture->canDemote || managedTexture->mipCount <= 1) {
+        continue;
+      }
+
+      const ImageAssetDataView* assetDataView = static_cast<const ImageAssetDataView*>(managedTexture->assetData.ptr());
+      const uint32_t maxMip = assetDataView->getMaxMinLevel();
+      const uint32_t residentMip = managedTexture->residentMipLevel;
+      const uint32_t targetMip = policy.selectResidentMip(managedTexture->residencyHistory, frameId, residentMip, minMip, maxMip);
+
+      if (targetMip != residentMip && changeResidentMip(texture, targetMip)) {
+        --changesLeft;
+      }
+    }
+  }
+
+  bool RtxTextureManager::changeResidentMip(TextureRef& texture, uint32_t mipLevel) {
+    const Rc<ManagedTexture>& managedTexture = texture.getManagedTexture();
+
+    // Note: Only textures resident through this reference are changed, the reference keeps the current image bound while
+    // the new mip chain is loaded and uploaded on the upload thread. Textures in flight or in host memory are reconsidered
+    // once resident. The host copy of the small mips is what lets the texture be demoted and promoted again afterwards.
+    if (!texture.isFullyResident() ||
+        managedTexture->state != ManagedTexture::State::kVidMem ||
+        !managedTexture->linearImageDataSmallMips) {
+      return false;
+    }
+
+    { std::unique_lock<dxvk::mutex> lock(m_queueMutex);
+      managedTexture->reloadMipLevel = mipLevel;
+      m_textureQueue.push(managedTexture);
+      ++m_texturesPending;
+      managedTexture->state = ManagedTexture::State::kQueuedForUpload;
+      managedTexture->frameQueuedForUpload = m_device->getCurrentFrameId();
+    }
+
+    m_condOnAdd.notify_one();
+
+    return true;
+  }
+
+
 }
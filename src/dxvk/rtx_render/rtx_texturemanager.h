@@ -20,8 +20,10 @@
 * DEALINGS IN THE SOFTWARE.
 */
 #pragma once
+#include <array>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include "../../util/thread.h"
 #include "../../util/rc/util_rc_ptr.h"
@@ -42,6 +44,7 @@ namespace dxvk {
     Rc<ManagedTexture> preloadTexture(const Rc<AssetData>& assetData, ColorSpace colorSpace,
       const Rc<DxvkContext>& context, bool forceLoad);
     void scheduleTextureUpload(TextureRef& texture, Rc<DxvkContext>& immediateContext, bool allowAsync);
+    bool prefetchTexture(const Rc<ManagedTexture>& texture, Rc<DxvkContext>& immediateContext);
     void unloadTexture(const Rc<ManagedTexture>& texture);
     void releaseTexture(const Rc<ManagedTexture>& texture);
     void synchronize(bool dropRequests = false);
@@ -49,9 +52,18 @@ namespace dxvk {
 
     void demoteTexturesFromVidmem();
     uint32_t updateMipMapSkipLevel(const Rc<DxvkContext>& context);
+    VkDeviceSize getAvailableDeviceMemoryMib() const;
+    // Note: Wraps around when allocations exceed the budget, which the mip skip level has always relied on
+    VkDeviceSize getUnclampedAvailableDeviceMemoryMib() const;
 
     static int calcPreloadMips(int mipLevels);
 
+    // Sampler feedback driven mip residency, see TextureResidencyPolicy
+    static bool isSamplerFeedbackEnabled();
+    const Rc<DxvkBuffer>& getSamplerFeedbackBuffer(const Rc<DxvkContext>& context);
+    void resolveSamplerFeedback(const Rc<DxvkContext>& context, const std::vector<TextureRef>& textureTable);
+    void updateTextureResidency(std::vector<TextureRef>& textureTable);
+
     inline static XXH64_hash_t getUniqueKey() {
       static uint64_t ID;
       XXH64_hash_t key;
@@ -68,6 +80,16 @@ namespace dxvk {
     }
 
   private:
+    // Note: Feedback is read back once the GPU is done with the frame that wrote it, the ring covers the frames in flight
+    static constexpr uint32_t kSamplerFeedbackLatency = 3;
+
+    struct SamplerFeedbackReadback {
+      Rc<DxvkBuffer> buffer;
+      std::vector<size_t> textureKeys;  // unique key of the texture at each bindless index when the feedback was written
+      uint32_t frameId = 0;
+      bool pending = false;
+    };
+
     Rc<DxvkDevice> m_device;
     Rc<DxvkContext> m_ctx;
     dxvk::mutex m_queueMutex;
@@ -80,11 +102,19 @@ namespace dxvk {
     std::atomic<uint32_t> m_texturesPending = { 0u };
     dxvk::thread m_thread;
 
-    uint32_t m_minimumMipLevel;
+    uint32_t m_minimumMipLevel = 0;
     fast_unordered_cache<Rc<ManagedTexture>> m_textures;
 
+    Rc<DxvkBuffer> m_samplerFeedbackBuffer;
+    std::array<SamplerFeedbackReadback, kSamplerFeedbackLatency> m_samplerFeedbackReadbacks;
+
     void threadFunc();
     void uploadTexture(const Rc<ManagedTexture>& texture);
+    void reloadTexture(const Rc<ManagedTexture>& texture);
+    void scheduleManagedTextureUpload(const Rc<ManagedTexture>& managedTexture, Rc<DxvkContext>& immediateContext, bool allowAsync);
+    void readSamplerFeedback(SamplerFeedbackReadback& readback, const std::vector<TextureRef>& textureTable);
+    bool changeResidentMip(TextureRef& texture, uint32_t mipLevel);
+    VkDeviceSize getAvailableDeviceMemoryMib(bool clampToBudget) const;
   };
 
 } // namespace dxvk
@@ -133,6 +133,10 @@ struct RasterGeometry {
   // Used by replacements mostly, to force the cull bit to that set by the geometry data
   bool forceCullBit = false;
 
+  // Hash of the source geometry content (positions and indices) which is stable across runs,
+  // only set for replacement geometry and used to key persistent caches. kEmptyHash otherwise.
+  XXH64_hash_t persistentContentHash = kEmptyHash;
+
   RasterBuffer positionBuffer;
   RasterBuffer normalBuffer;
   RasterBuffer texcoordBuffer;
@@ -349,6 +353,8 @@ struct FogState {
 
 
 struct DrawCallState {
+  static constexpr uint32_t kNotInstanced = UINT32_MAX;
+
   DrawCallState()
     : m_stencilEnabled(false) { }
 
@@ -369,7 +375,8 @@ struct DrawCallState {
     , m_transformData(_input.m_transformData)
     , m_skinningData(_input.m_skinningData)
     , m_fogState(_input.m_fogState)
-    , m_isSky(_input.m_isSky) { }
+    , m_isSky(_input.m_isSky)
+    , m_instanceIndex(_input.m_instanceIndex) { }
 
   DrawCallState& operator=(const DrawCallState& drawCallState) {
     if (this != &drawCallState) {
@@ -379,6 +386,7 @@ struct DrawCallState {
       m_skinningData = drawCallState.m_skinningData;
       m_fogState = drawCallState.m_fogState;
       m_stencilEnabled = drawCallState.m_stencilEnabled;
+      m_instanceIndex = drawCallState.m_instanceIndex;
     }
 
     return *this;
@@ -422,6 +430,11 @@ struct DrawCallState {
     return m_isSky;
   }
 
+  // Index of the instance within an expanded instanced draw, kNotInstanced for other draws
+  uint32_t getInstanceIndex() const {
+    return m_instanceIndex;
+  }
+
   bool finalizeGeometryHashes() {
     if (!m_geometryData.futureGeometryHashes.valid())
       return false;
@@ -457,6 +470,8 @@ private:
 
   // Note: used for early sky detection and removing sky draws from raytracing scene and camera detection.
   bool m_isSky = false;
+
+  uint32_t m_instanceIndex = kNotInstanced;
 };
 
  // A BLAS and its data buffer that can be pooled and used for various geometries
@@ -492,6 +507,12 @@ struct BlasEntry {
 
   Rc<PooledBlas> staticBlas;
 
+  // Number of frames the build of the static BLAS has been deferred for by the BLAS build budget
+  uint32_t staticBlasFramesDeferred = 0;
+
+  // Hash of the asset the costs of this geometry are attributed to, replacement meshes use the hash of the mesh they replace
+  XXH64_hash_t assetHash = kEmptyHash;
+
   BlasEntry() = default;
 
   BlasEntry(const DrawCallState& input_)
@@ -594,6 +615,7 @@ struct DxvkRaytracingInstanceState {
   Matrix4 world;
   Matrix4 view;
   Matrix4 projection;
+  std::vector<Matrix4> instanceTransforms;
   Rc<DxvkBuffer> vsFixedFunctionCB;
   uint32_t colorTextureSlot = UINT32_MAX;
   uint32_t colorTextureSlot2 = UINT32_MAX;
@@ -99,6 +99,9 @@ struct Surface
   bool isAnimatedWater;
   bool isClipPlaneEnabled;
   bool isMatte;
+  // Note: Indicates normals/texcoords are stored with the compact encodings from vertex_packing.h
+  bool hasCompactNormals;
+  bool hasCompactTexcoords;
 
   mat4x3 objectToWorld;
   mat4x3 prevObjectToWorld;
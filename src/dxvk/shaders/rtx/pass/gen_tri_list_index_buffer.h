@@ -71,14 +71,38 @@ void generateIndices(const uint32_t idx, RWStructuredBuffer<uint16_t> dst, Struc
       idx2 = cb.minVertex;
     }
     
-    dst[idx * 3 + 0] = idx0 - cb.minVertex;
-    dst[idx * 3 + 1] = idx1 - cb.minVertex;
-    dst[idx * 3 + 2] = idx2 - cb.minVertex;
+    dst[cb.outputOffset + idx * 3 + 0] = idx0 - cb.minVertex;
+    dst[cb.outputOffset + idx * 3 + 1] = idx1 - cb.minVertex;
+    dst[cb.outputOffset + idx * 3 + 2] = idx2 - cb.minVertex;
   } 
   else 
   {
-    dst[idx * 3 + 0] = i0 - cb.minVertex;
-    dst[idx * 3 + 1] = i1 - cb.minVertex;
-    dst[idx * 3 + 2] = i2 - cb.minVertex;
+    dst[cb.outputOffset + idx * 3 + 0] = i0 - cb.minVertex;
+    dst[cb.outputOffset + idx * 3 + 1] = i1 - cb.minVertex;
+    dst[cb.outputOffset + idx * 3 + 2] = i2 - cb.minVertex;
   }
-}
\ No newline at end of file
+}
+
+// Finds the job a thread of a batched dispatch belongs to, jobs are sorted by their first thread
+#ifdef __cplusplus
+uint32_t findGenTriListJob(const GenTriListJob* jobs, const uint32_t jobCount, const uint32_t thread)
+#else
+uint32_t findGenTriListJob(StructuredBuffer<GenTriListJob> jobs, const uint32_t jobCount, const uint32_t thread)
+#endif
+{
+  uint32_t first = 0;
+  uint32_t count = jobCount;
+
+  while (count > 0) {
+    const uint32_t step = count / 2;
+
+    if (jobs[first + step].firstThread <= thread) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+
+  return first - 1;
+}
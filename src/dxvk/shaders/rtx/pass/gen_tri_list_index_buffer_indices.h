@@ -29,7 +29,22 @@ struct GenTriListArgs
   uint32_t primCount;
   uint32_t minVertex;
   uint32_t maxVertex;
+  uint32_t outputOffset;
 };
 
 #define GEN_TRILIST_BINDING_OUTPUT  0
 #define GEN_TRILIST_BINDING_INPUT   1
+#define GEN_TRILIST_BINDING_JOBS    2
+
+// Batched triangle list generation: every job of the table gets one thread per primitive, all inputs
+// and outputs live in a single buffer, so index buffer reads (firstIndex) and outputOffset are relative to it.
+struct GenTriListJob {
+  GenTriListArgs args;
+  uint32_t firstThread;
+};
+
+struct GenTriListBatchArgs {
+  uint32_t jobCount;
+  uint32_t threadOffset;
+  uint32_t threadCount;
+};
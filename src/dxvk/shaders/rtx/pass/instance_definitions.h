@@ -70,7 +70,12 @@
 
 #define OBJECT_MASK_TRANSLUCENT       (1 << 0)
 #define OBJECT_MASK_PORTAL            (1 << 1)
-#define OBJECT_MASK_OPAQUE            (1 << 3)
+
+// Opaque instances have one bit per secondary ray type that traces them, primary rays trace both.
+// Instances normally have both bits set, see rtx_ray_visibility.h for the categories that may lose one.
+#define OBJECT_MASK_OPAQUE_INDIRECT   (1 << 2)
+#define OBJECT_MASK_OPAQUE_SHADOW     (1 << 3)
+#define OBJECT_MASK_OPAQUE            (OBJECT_MASK_OPAQUE_INDIRECT | OBJECT_MASK_OPAQUE_SHADOW)
 
 // Instances to be drawn and visible in ViewModel pass only
 #define OBJECT_MASK_VIEWMODEL         (1 << 4)
@@ -92,6 +97,9 @@
 #define OBJECT_MASK_ALL_STANDARD    (OBJECT_MASK_TRANSLUCENT | OBJECT_MASK_PORTAL | OBJECT_MASK_OPAQUE)
 #define OBJECT_MASK_ALL             (OBJECT_MASK_ALL_STANDARD)
 
+// Objects traced by indirect rays
+#define OBJECT_MASK_ALL_INDIRECT    (OBJECT_MASK_TRANSLUCENT | OBJECT_MASK_PORTAL | OBJECT_MASK_OPAQUE_INDIRECT)
+
 /****************************** ~Instance Mask - Ordered TLAS ************************************************/
 
 
@@ -21,6 +21,8 @@
 */
 #pragma once
 
+#include "rtx/utility/vertex_packing.h"
+
 // This function can be executed on the CPU or GPU!!
 #ifdef __cplusplus
 #define asfloat(x) *reinterpret_cast<const float*>(&x)
@@ -33,22 +35,61 @@ void interleave(const uint32_t idx, RWStructuredBuffer<float> dst, StructuredBuf
 
   uint32_t writeOffset = 0;
 
-  dst[idx* cb.outputStride + writeOffset++] = srcPosition[srcVertexIndex * cb.positionStride + cb.positionOffset + 0];
-  dst[idx* cb.outputStride + writeOffset++] = srcPosition[srcVertexIndex * cb.positionStride + cb.positionOffset + 1];
-  dst[idx* cb.outputStride + writeOffset++] = srcPosition[srcVertexIndex * cb.positionStride + cb.positionOffset + 2];
+  dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcPosition[srcVertexIndex * cb.positionStride + cb.positionOffset + 0];
+  dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcPosition[srcVertexIndex * cb.positionStride + cb.positionOffset + 1];
+  dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcPosition[srcVertexIndex * cb.positionStride + cb.positionOffset + 2];
 
   if (cb.hasNormals) {
-    dst[idx * cb.outputStride + writeOffset++] = srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 0];
-    dst[idx * cb.outputStride + writeOffset++] = srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 1];
-    dst[idx * cb.outputStride + writeOffset++] = srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 2];
+    if (cb.compactNormals) {
+      const uint32_t packedNormal = vertexPackingEncodeNormal(
+        srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 0],
+        srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 1],
+        srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 2]);
+      dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = asfloat(packedNormal);
+    } else {
+      dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 0];
+      dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 1];
+      dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcNormal[srcVertexIndex * cb.normalStride + cb.normalOffset + 2];
+    }
   }
 
   if (cb.hasTexcoord) {
-    dst[idx * cb.outputStride + writeOffset++] = srcTexcoord[srcVertexIndex * cb.texcoordStride + cb.texcoordOffset + 0];
-    dst[idx * cb.outputStride + writeOffset++] = srcTexcoord[srcVertexIndex * cb.texcoordStride + cb.texcoordOffset + 1];
+    if (cb.compactTexcoords) {
+      const uint32_t packedTexcoord = vertexPackingEncodeTexcoord(
+        srcTexcoord[srcVertexIndex * cb.texcoordStride + cb.texcoordOffset + 0],
+        srcTexcoord[srcVertexIndex * cb.texcoordStride + cb.texcoordOffset + 1]);
+      dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = asfloat(packedTexcoord);
+    } else {
+      dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcTexcoord[srcVertexIndex * cb.texcoordStride + cb.texcoordOffset + 0];
+      dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = srcTexcoord[srcVertexIndex * cb.texcoordStride + cb.texcoordOffset + 1];
+    }
   } 
 
   if (cb.hasColor0) {
-    dst[idx * cb.outputStride + writeOffset++] = asfloat(srcColor0[srcVertexIndex * cb.color0Stride + cb.color0Offset + 0]);
+    dst[cb.outputOffset + idx * cb.outputStride + writeOffset++] = asfloat(srcColor0[srcVertexIndex * cb.color0Stride + cb.color0Offset + 0]);
   }
 }
+
+// Finds the job a thread of a batched dispatch belongs to, jobs are sorted by their first thread
+#ifdef __cplusplus
+uint32_t findInterleaveGeometryJob(const InterleaveGeometryJob* jobs, const uint32_t jobCount, const uint32_t thread)
+#else
+uint32_t findInterleaveGeometryJob(StructuredBuffer<InterleaveGeometryJob> jobs, const uint32_t jobCount, const uint32_t thread)
+#endif
+{
+  uint32_t first = 0;
+  uint32_t count = jobCount;
+
+  while (count > 0) {
+    const uint32_t step = count / 2;
+
+    if (jobs[first + step].firstThread <= thread) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+
+  return first - 1;
+}
@@ -38,7 +38,12 @@ struct InterleaveGeometryArgs {
 
   uint32_t minVertexIndex;
   uint32_t outputStride;
+  uint32_t outputOffset;
   uint32_t vertexCount;
+
+  // Note: See vertex_packing.h for the compact encodings
+  uint32_t compactNormals;
+  uint32_t compactTexcoords;
 };
 
 #define INTERLEAVE_GEOMETRY_BINDING_OUTPUT           0
@@ -46,3 +51,17 @@ struct InterleaveGeometryArgs {
 #define INTERLEAVE_GEOMETRY_BINDING_NORMAL_INPUT     2
 #define INTERLEAVE_GEOMETRY_BINDING_TEXCOORD_INPUT   3
 #define INTERLEAVE_GEOMETRY_BINDING_COLOR0_INPUT     4
+#define INTERLEAVE_GEOMETRY_BINDING_JOBS             5
+
+// Batched interleaving: every job of the table gets one thread per vertex, all inputs and outputs
+// live in a single buffer, so input and output offsets of the job args are relative to it.
+struct InterleaveGeometryJob {
+  InterleaveGeometryArgs args;
+  uint32_t firstThread;
+};
+
+struct InterleaveGeometryBatchArgs {
+  uint32_t jobCount;
+  uint32_t threadOffset;
+  uint32_t threadCount;
+};
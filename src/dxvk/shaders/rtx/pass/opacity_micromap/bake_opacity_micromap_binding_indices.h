@@ -55,4 +55,6 @@ struct BakeOpacityMicromapArgs {
   uint threadIndexOffset;
   uint conservativeEstimationMaxTexelTapsPerMicroTriangle;
   uint numActiveThreads;
+
+  uint compactTexcoords;
 };
\ No newline at end of file
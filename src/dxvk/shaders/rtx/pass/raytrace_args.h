@@ -240,4 +240,6 @@ struct RaytraceArgs {
 
   uint isLastCompositeOutputValid;
   uint isZUp; // Note: Indicates if the Z axis is the "up" axis in world space if true, otherwise the Y axis if false.
+
+  uint enableSamplerFeedback;
 };
@@ -0,0 +1,47 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include "rtx/utility/shader_types.h"
+#include "rtx/pass/terrain_bake/terrain_blend.h"
+
+#define TERRAIN_BAKE_ALBEDO_INPUT       0
+#define TERRAIN_BAKE_NORMAL_INPUT       1
+#define TERRAIN_BAKE_ROUGHNESS_INPUT    2
+
+#define TERRAIN_BAKE_ALBEDO_OUTPUT      3
+#define TERRAIN_BAKE_NORMAL_OUTPUT      4
+#define TERRAIN_BAKE_ROUGHNESS_OUTPUT   5
+
+#define TERRAIN_BAKE_BLOCK_SIZE         16
+
+struct TerrainBakeArgs {
+  TerrainBlendLayerState layer;
+
+  uvec2 resolution;
+  vec2 rcpResolution;
+
+  uint isBaseLayer;
+  uint hasNormalTexture;
+  uint hasRoughnessTexture;
+  float roughnessConstant;
+};
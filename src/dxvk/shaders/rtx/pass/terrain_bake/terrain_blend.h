@@ -0,0 +1,332 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+// Fixed function terrain layer compositing math used to bake blended terrain stacks into a single opaque surface.
+// These functions can be executed on the CPU or GPU!!
+//
+// All functions operate on a single channel so the same code paths can be used for the color (rgb) and alpha channels
+// of a layer. The texture stage operations mirror chooseTextureArgument/chooseTextureOperationColor/chooseTextureOperationAlpha
+// in opaque_surface_material_blending.slangh and the framebuffer blend mirrors VkBlendFactor/VkBlendOp.
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <cstdint>
+
+#define TERRAIN_BLEND_INLINE inline
+#define TERRAIN_BLEND_INOUT(type) type&
+
+TERRAIN_BLEND_INLINE float terrainBlendMin(float a, float b) {
+  return std::min(a, b);
+}
+
+TERRAIN_BLEND_INLINE float terrainBlendMax(float a, float b) {
+  return std::max(a, b);
+}
+
+TERRAIN_BLEND_INLINE float terrainBlendSaturate(float x) {
+  return std::min(std::max(x, 0.0f), 1.0f);
+}
+
+#else
+
+#define TERRAIN_BLEND_INLINE
+#define TERRAIN_BLEND_INOUT(type) inout type
+
+float terrainBlendMin(float a, float b) {
+  return min(a, b);
+}
+
+float terrainBlendMax(float a, float b) {
+  return max(a, b);
+}
+
+float terrainBlendSaturate(float x) {
+  return saturate(x);
+}
+
+#endif
+
+// Note: Values match RtTextureArgSource
+#define TERRAIN_BLEND_ARG_NONE          0
+#define TERRAIN_BLEND_ARG_TEXTURE       1
+#define TERRAIN_BLEND_ARG_VERTEX_COLOR0 2
+#define TERRAIN_BLEND_ARG_TFACTOR       3
+
+// Note: Values match DxvkRtTextureOperation
+#define TERRAIN_BLEND_TEXOP_DISABLE     0
+#define TERRAIN_BLEND_TEXOP_SELECT_ARG1 1
+#define TERRAIN_BLEND_TEXOP_SELECT_ARG2 2
+#define TERRAIN_BLEND_TEXOP_MODULATE    3
+#define TERRAIN_BLEND_TEXOP_MODULATE2X  4
+#define TERRAIN_BLEND_TEXOP_MODULATE4X  5
+#define TERRAIN_BLEND_TEXOP_ADD         6
+
+// Note: Values match VkBlendFactor
+#define TERRAIN_BLEND_FACTOR_ZERO                     0
+#define TERRAIN_BLEND_FACTOR_ONE                      1
+#define TERRAIN_BLEND_FACTOR_SRC_COLOR                2
+#define TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_COLOR      3
+#define TERRAIN_BLEND_FACTOR_DST_COLOR                4
+#define TERRAIN_BLEND_FACTOR_ONE_MINUS_DST_COLOR      5
+#define TERRAIN_BLEND_FACTOR_SRC_ALPHA                6
+#define TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA      7
+#define TERRAIN_BLEND_FACTOR_DST_ALPHA                8
+#define TERRAIN_BLEND_FACTOR_ONE_MINUS_DST_ALPHA      9
+#define TERRAIN_BLEND_FACTOR_CONSTANT_COLOR           10
+#define TERRAIN_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR 11
+#define TERRAIN_BLEND_FACTOR_CONSTANT_ALPHA           12
+#define TERRAIN_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA 13
+#define TERRAIN_BLEND_FACTOR_SRC_ALPHA_SATURATE       14
+
+// Note: Values match VkBlendOp
+#define TERRAIN_BLEND_OP_ADD              0
+#define TERRAIN_BLEND_OP_SUBTRACT         1
+#define TERRAIN_BLEND_OP_REVERSE_SUBTRACT 2
+#define TERRAIN_BLEND_OP_MIN              3
+#define TERRAIN_BLEND_OP_MAX              4
+
+// Fixed function state of a single terrain layer
+struct TerrainBlendLayerState {
+  uint32_t colorArg1Source;
+  uint32_t colorArg2Source;
+  uint32_t colorOperation;
+  uint32_t alphaArg1Source;
+
+  uint32_t alphaArg2Source;
+  uint32_t alphaOperation;
+  uint32_t blendEnabled;
+  uint32_t srcColorBlendFactor;
+
+  uint32_t dstColorBlendFactor;
+  uint32_t colorBlendOp;
+  uint32_t tFactor;          // D3DCOLOR (ARGB) value of D3DRS_TEXTUREFACTOR
+  uint32_t pad0;
+};
+
+// Inputs of a single terrain layer at one texel
+struct TerrainBlendLayerSample {
+  float color[4];
+  float normal[3];           // Tangent space
+  float roughness;
+  uint32_t hasNormal;
+};
+
+// Composited terrain surface at one texel
+struct TerrainBlendTexel {
+  float albedo[4];
+  float normal[3];           // Tangent space, not normalized
+  float roughness;
+};
+
+// Selects a texture stage argument, vertex colors are not available in texture space and must be filtered out
+// by the caller before a layer is considered for baking.
+TERRAIN_BLEND_INLINE float terrainBlendTextureArgument(uint32_t source, float textureValue, float tFactorValue, float defaultValue) {
+  switch (source) {
+  case TERRAIN_BLEND_ARG_TEXTURE:
+    return textureValue;
+  case TERRAIN_BLEND_ARG_TFACTOR:
+    return tFactorValue;
+  default:
+    return defaultValue;
+  }
+}
+
+// Texture stage operation for a color channel, all modulate variants are treated equally as in the ray tracer
+TERRAIN_BLEND_INLINE float terrainBlendTextureOperationColor(uint32_t operation, float current, float arg1, float arg2) {
+  switch (operation) {
+  case TERRAIN_BLEND_TEXOP_SELECT_ARG1:
+    return arg1;
+  case TERRAIN_BLEND_TEXOP_SELECT_ARG2:
+    return arg2;
+  case TERRAIN_BLEND_TEXOP_MODULATE:
+  case TERRAIN_BLEND_TEXOP_MODULATE2X:
+  case TERRAIN_BLEND_TEXOP_MODULATE4X:
+    return arg1 * arg2;
+  case TERRAIN_BLEND_TEXOP_ADD:
+    return arg1 + arg2;
+  default:
+    return current;
+  }
+}
+
+// Texture stage operation for the alpha channel
+TERRAIN_BLEND_INLINE float terrainBlendTextureOperationAlpha(uint32_t operation, float current, float arg1, float arg2) {
+  switch (operation) {
+  case TERRAIN_BLEND_TEXOP_SELECT_ARG1:
+    return arg1;
+  case TERRAIN_BLEND_TEXOP_SELECT_ARG2:
+    return arg2;
+  case TERRAIN_BLEND_TEXOP_MODULATE:
+    return arg1 * arg2;
+  case TERRAIN_BLEND_TEXOP_MODULATE2X:
+    return terrainBlendMin(1.0f, arg1 * arg2 * 2.0f);
+  case TERRAIN_BLEND_TEXOP_MODULATE4X:
+    return terrainBlendMin(1.0f, arg1 * arg2 * 4.0f);
+  case TERRAIN_BLEND_TEXOP_ADD:
+    return terrainBlendMin(1.0f, arg1 + arg2);
+  default:
+    return current;
+  }
+}
+
+// Evaluates a framebuffer blend factor for one channel. srcValue/dstValue are the values of the channel being blended,
+// srcAlpha/dstAlpha the alpha channels. isAlphaChannel selects the alpha variant of SRC_ALPHA_SATURATE.
+// Note: D3D9 blend constants are not tracked by the legacy material, the constant color is assumed to be white.
+TERRAIN_BLEND_INLINE float terrainBlendFactor(uint32_t factor, float srcValue, float srcAlpha, float dstValue, float dstAlpha, bool isAlphaChannel) {
+  const float constantValue = 1.0f;
+
+  switch (factor) {
+  case TERRAIN_BLEND_FACTOR_ZERO:
+    return 0.0f;
+  default:
+  case TERRAIN_BLEND_FACTOR_ONE:
+    return 1.0f;
+  case TERRAIN_BLEND_FACTOR_SRC_COLOR:
+    return srcValue;
+  case TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_COLOR:
+    return 1.0f - srcValue;
+  case TERRAIN_BLEND_FACTOR_DST_COLOR:
+    return dstValue;
+  case TERRAIN_BLEND_FACTOR_ONE_MINUS_DST_COLOR:
+    return 1.0f - dstValue;
+  case TERRAIN_BLEND_FACTOR_SRC_ALPHA:
+    return srcAlpha;
+  case TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA:
+    return 1.0f - srcAlpha;
+  case TERRAIN_BLEND_FACTOR_DST_ALPHA:
+    return dstAlpha;
+  case TERRAIN_BLEND_FACTOR_ONE_MINUS_DST_ALPHA:
+    return 1.0f - dstAlpha;
+  case TERRAIN_BLEND_FACTOR_CONSTANT_COLOR:
+  case TERRAIN_BLEND_FACTOR_CONSTANT_ALPHA:
+    return constantValue;
+  case TERRAIN_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR:
+  case TERRAIN_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA:
+    return 1.0f - constantValue;
+  case TERRAIN_BLEND_FACTOR_SRC_ALPHA_SATURATE:
+    return isAlphaChannel ? 1.0f : terrainBlendMin(srcAlpha, 1.0f - dstAlpha);
+  }
+}
+
+// Framebuffer blend equation for one channel, the result is clamped as it would be by a UNORM render target
+TERRAIN_BLEND_INLINE float terrainBlendOperation(uint32_t operation, float srcValue, float srcFactor, float dstValue, float dstFactor) {
+  switch (operation) {
+  default:
+  case TERRAIN_BLEND_OP_ADD:
+    return terrainBlendSaturate(srcValue * srcFactor + dstValue * dstFactor);
+  case TERRAIN_BLEND_OP_SUBTRACT:
+    return terrainBlendSaturate(srcValue * srcFactor - dstValue * dstFactor);
+  case TERRAIN_BLEND_OP_REVERSE_SUBTRACT:
+    return terrainBlendSaturate(dstValue * dstFactor - srcValue * srcFactor);
+  // Note: Blend factors are ignored by min/max
+  case TERRAIN_BLEND_OP_MIN:
+    return terrainBlendMin(srcValue, dstValue);
+  case TERRAIN_BLEND_OP_MAX:
+    return terrainBlendMax(srcValue, dstValue);
+  }
+}
+
+// Blends one channel of a layer onto the composited result
+TERRAIN_BLEND_INLINE float terrainBlendChannel(uint32_t srcFactor, uint32_t dstFactor, uint32_t operation,
+                                               float srcValue, float srcAlpha, float dstValue, float dstAlpha, bool isAlphaChannel) {
+  const float srcWeight = terrainBlendFactor(srcFactor, srcValue, srcAlpha, dstValue, dstAlpha, isAlphaChannel);
+  const float dstWeight = terrainBlendFactor(dstFactor, srcValue, srcAlpha, dstValue, dstAlpha, isAlphaChannel);
+
+  return terrainBlendOperation(operation, srcValue, srcWeight, dstValue, dstWeight);
+}
+
+// How much of the composited surface a layer replaces, used to blend the attributes which have no fixed function
+// equivalent (normals, roughness). Alpha blended layers replace the surface by their alpha, additive and multiplicative
+// layers only tint what is underneath them.
+TERRAIN_BLEND_INLINE float terrainBlendCoverage(uint32_t srcFactor, uint32_t dstFactor, uint32_t operation, float srcAlpha, float dstAlpha) {
+  if (operation == TERRAIN_BLEND_OP_MIN || operation == TERRAIN_BLEND_OP_MAX) {
+    return 0.0f;
+  }
+
+  // Multiplicative layers (dst * src) scale the surface underneath, they do not cover it
+  if (srcFactor == TERRAIN_BLEND_FACTOR_DST_COLOR || dstFactor == TERRAIN_BLEND_FACTOR_SRC_COLOR) {
+    return 0.0f;
+  }
+
+  // Note: Color dependent factors are evaluated for a mid grey surface
+  const float kMidGrey = 0.5f;
+  const float dstWeight = terrainBlendFactor(dstFactor, kMidGrey, srcAlpha, kMidGrey, dstAlpha, true);
+
+  return terrainBlendSaturate(1.0f - dstWeight);
+}
+
+// Returns one channel (r, g, b, a) of a D3DCOLOR texture factor
+TERRAIN_BLEND_INLINE float terrainBlendTFactorChannel(uint32_t tFactor, uint32_t channel) {
+  const uint32_t shift = channel == 3 ? 24 : 16 - 8 * channel;
+  return float((tFactor >> shift) & 0xff) / 255.0f;
+}
+
+// Composites a layer onto the terrain surface: texture stage state first, then the framebuffer blend.
+// Normals and roughness follow the coverage of the layer.
+TERRAIN_BLEND_INLINE void terrainBlendComposite(TERRAIN_BLEND_INOUT(TerrainBlendTexel) texel, TerrainBlendLayerState layer, TerrainBlendLayerSample layerSample) {
+  float src[4];
+
+  for (uint32_t c = 0; c < 3; ++c) {
+    const float tFactorValue = terrainBlendTFactorChannel(layer.tFactor, c);
+    const float arg1 = terrainBlendTextureArgument(layer.colorArg1Source, layerSample.color[c], tFactorValue, 1.0f);
+    const float arg2 = terrainBlendTextureArgument(layer.colorArg2Source, layerSample.color[c], tFactorValue, 1.0f);
+    src[c] = terrainBlendTextureOperationColor(layer.colorOperation, layerSample.color[c], arg1, arg2);
+  }
+
+  {
+    const float tFactorValue = terrainBlendTFactorChannel(layer.tFactor, 3);
+    const float arg1 = terrainBlendTextureArgument(layer.alphaArg1Source, layerSample.color[3], tFactorValue, layerSample.color[3]);
+    const float arg2 = terrainBlendTextureArgument(layer.alphaArg2Source, layerSample.color[3], tFactorValue, 1.0f);
+    src[3] = terrainBlendTextureOperationAlpha(layer.alphaOperation, layerSample.color[3], arg1, arg2);
+  }
+
+  float coverage = 1.0f;
+
+  if (layer.blendEnabled == 0) {
+    for (uint32_t c = 0; c < 4; ++c) {
+      texel.albedo[c] = terrainBlendSaturate(src[c]);
+    }
+  } else {
+    const float srcAlpha = terrainBlendSaturate(src[3]);
+    const float dstAlpha = texel.albedo[3];
+
+    for (uint32_t c = 0; c < 3; ++c) {
+      texel.albedo[c] = terrainBlendChannel(layer.srcColorBlendFactor, layer.dstColorBlendFactor, layer.colorBlendOp,
+                                            terrainBlendSaturate(src[c]), srcAlpha, texel.albedo[c], dstAlpha, false);
+    }
+
+    texel.albedo[3] = terrainBlendChannel(layer.srcColorBlendFactor, layer.dstColorBlendFactor, layer.colorBlendOp,
+                                          srcAlpha, srcAlpha, dstAlpha, dstAlpha, true);
+
+    coverage = terrainBlendCoverage(layer.srcColorBlendFactor, layer.dstColorBlendFactor, layer.colorBlendOp, srcAlpha, dstAlpha);
+  }
+
+  if (layerSample.hasNormal != 0) {
+    for (uint32_t c = 0; c < 3; ++c) {
+      texel.normal[c] += (layerSample.normal[c] - texel.normal[c]) * coverage;
+    }
+  }
+
+  texel.roughness += (layerSample.roughness - texel.roughness) * coverage;
+}
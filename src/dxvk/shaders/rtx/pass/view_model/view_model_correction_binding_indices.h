@@ -36,4 +36,5 @@ struct ViewModelCorrectionArgs {
   uint positionStride;
   uint normalOffset;
   uint normalStride;
+  uint compactNormals;
 };
\ No newline at end of file
@@ -34,4 +34,11 @@
 // If set, then the texture bound to transmittanceOrDiffuseTextureIndex is an albedo map for the diffuse layer
 #define TRANSLUCENT_SURFACE_MATERIAL_FLAG_USE_DIFFUSE_LAYER (1 << 0)
 
+// Sampler feedback holds one value per bindless texture, the minimum over all samples of the sampled mip
+// relative to the resident mip chain, offset so mips finer than the resident chain remain representable.
+#define SAMPLER_FEEDBACK_MAX_TEXTURES (1 << 16)
+#define SAMPLER_FEEDBACK_UNSAMPLED (0xFFFFFFFFu)
+#define SAMPLER_FEEDBACK_MIP_OFFSET (16)
+#define SAMPLER_FEEDBACK_MAX_ENCODED_MIP (2 * SAMPLER_FEEDBACK_MIP_OFFSET - 1)
+
 #endif // ifndef SHARED_CONSTANTS_H
@@ -0,0 +1,198 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+// Compact vertex attribute encodings used by the ray tracing geometry cache.
+// These functions can be executed on the CPU or GPU!!
+//
+// Normal:   octahedral encoding stored as 2x snorm16 in a single uint (identical to sphereDirectionToSnorm2x16
+//           in packing.slangh, so either may be used to decode).
+// Texcoord: 2x float16 in a single uint, u in the low 16 bits.
+//
+// Note: Positions are intentionally never compacted, they are consumed directly by BLAS builds, skinning,
+// view model correction and opacity micromap baking which all expect 32 bit float positions.
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#define VERTEX_PACKING_INLINE inline
+
+// Round to nearest even float32 -> float16 conversion, returns the half in the low 16 bits (same as f32tof16)
+inline uint32_t vertexPackingF32ToF16(float value) {
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+
+  const uint32_t sign = x & 0x80000000u;
+  x ^= sign;
+
+  uint32_t result;
+
+  if (x >= 0x47800000u) {
+    // Inf or NaN (all exponent bits set)
+    result = (x > 0x7F800000u) ? 0x7E00u : 0x7C00u;
+  } else if (x < 0x38800000u) {
+    // Subnormal or zero, let the FPU do the rounding by aligning the mantissa with a magic value
+    const uint32_t denormMagicBits = ((127 - 15) + (23 - 10) + 1) << 23;
+    float denormMagic;
+    std::memcpy(&denormMagic, &denormMagicBits, sizeof(denormMagic));
+
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    f += denormMagic;
+
+    uint32_t fBits;
+    std::memcpy(&fBits, &f, sizeof(fBits));
+    result = fBits - denormMagicBits;
+  } else {
+    const uint32_t mantissaOdd = (x >> 13) & 1u;
+    // Rebias the exponent and round
+    x += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu;
+    x += mantissaOdd;
+    result = x >> 13;
+  }
+
+  return (sign >> 16) | (result & 0xFFFFu);
+}
+
+// float16 (low 16 bits) -> float32 conversion (same as f16tof32)
+inline float vertexPackingF16ToF32(uint32_t value) {
+  const uint32_t sign = (value & 0x8000u) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1Fu;
+  const uint32_t mantissa = value & 0x3FFu;
+
+  if (exponent == 0) {
+    const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+    return sign ? -magnitude : magnitude;
+  }
+
+  const uint32_t bits = (exponent == 0x1Fu) ?
+    (sign | 0x7F800000u | (mantissa << 13)) :
+    (sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13));
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+#else
+
+#include "rtx/utility/shader_types.h"
+#include "rtx/utility/packing.slangh"
+
+#define VERTEX_PACKING_INLINE
+
+uint32_t vertexPackingF32ToF16(float value) {
+  return f32tof16(value);
+}
+
+float vertexPackingF16ToF32(uint32_t value) {
+  return f16tof32(value);
+}
+
+#endif
+
+// Note: Mirrors f32ToSnorm16 from packing.slangh (one value left out so 0 is encoded exactly)
+VERTEX_PACKING_INLINE uint32_t vertexPackingF32ToSnorm16(float x) {
+  const float m = x * 0.5f + 0.5f;
+  const uint32_t encoded = uint32_t(floor(m * 65534.0f + 0.5f));
+
+  return encoded < 0xFFFFu ? encoded : 0xFFFFu;
+}
+
+VERTEX_PACKING_INLINE float vertexPackingSnorm16ToF32(uint32_t x) {
+  return float(x & 0xFFFFu) / 65534.0f * 2.0f - 1.0f;
+}
+
+// Packs a (not necessarily normalized) object space normal into a signed octahedral snorm2x16 encoding.
+// Degenerate zero length normals are encoded as +Z to avoid propagating NaNs into the hit shaders.
+VERTEX_PACKING_INLINE uint32_t vertexPackingEncodeNormal(float x, float y, float z) {
+  const float absX = x < 0.0f ? -x : x;
+  const float absY = y < 0.0f ? -y : y;
+  const float absZ = z < 0.0f ? -z : z;
+  const float l1Norm = absX + absY + absZ;
+
+  float octX = 0.0f;
+  float octY = 0.0f;
+
+  if (l1Norm > 0.0f) {
+    octX = x / l1Norm;
+    octY = y / l1Norm;
+
+    if (z < 0.0f) {
+      const float wrappedX = (1.0f - (octY < 0.0f ? -octY : octY)) * (octX < 0.0f ? -1.0f : 1.0f);
+      const float wrappedY = (1.0f - (octX < 0.0f ? -octX : octX)) * (octY < 0.0f ? -1.0f : 1.0f);
+
+      octX = wrappedX;
+      octY = wrappedY;
+    }
+  }
+
+  return vertexPackingF32ToSnorm16(octX) | (vertexPackingF32ToSnorm16(octY) << 16);
+}
+
+VERTEX_PACKING_INLINE uint32_t vertexPackingEncodeTexcoord(float u, float v) {
+  return vertexPackingF32ToF16(u) | (vertexPackingF32ToF16(v) << 16);
+}
+
+#ifdef __cplusplus
+
+// CPU reference decoders, must match the GPU decoders below
+
+inline void vertexPackingDecodeNormal(uint32_t encoded, float normal[3]) {
+  const float octX = vertexPackingSnorm16ToF32(encoded);
+  const float octY = vertexPackingSnorm16ToF32(encoded >> 16);
+
+  float x = octX;
+  float y = octY;
+  const float z = 1.0f - std::fabs(octX) - std::fabs(octY);
+  const float t = std::max(-z, 0.0f);
+
+  x += (x >= 0.0f) ? -t : t;
+  y += (y >= 0.0f) ? -t : t;
+
+  const float length = std::sqrt(x * x + y * y + z * z);
+
+  normal[0] = x / length;
+  normal[1] = y / length;
+  normal[2] = z / length;
+}
+
+inline void vertexPackingDecodeTexcoord(uint32_t encoded, float texcoord[2]) {
+  texcoord[0] = vertexPackingF16ToF32(encoded & 0xFFFFu);
+  texcoord[1] = vertexPackingF16ToF32(encoded >> 16);
+}
+
+#else
+
+vec3 vertexPackingDecodeNormal(uint32_t encoded) {
+  return snorm2x16ToSphereDirection(encoded);
+}
+
+vec2 vertexPackingDecodeTexcoord(uint32_t encoded) {
+  return vec2(f16tof32(encoded), f16tof32(encoded >> 16));
+}
+
+#endif
@@ -0,0 +1,371 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+
+#include "util_thread_placement.h"
+
+namespace dxvk {
+
+  namespace {
+    // Logical processors of the cores selected for a role, restricted to a single
+    // processor group since a thread's affinity cannot span groups.
+    struct CoreSelection {
+      uint32_t group = 0;
+      uint64_t mask = 0;
+      uint32_t coreCount = 0;
+    };
+
+    uint32_t popCount(uint64_t mask) {
+      uint32_t count = 0;
+
+      for (; mask != 0; mask &= mask - 1)
+        count++;
+
+      return count;
+    }
+
+    const char* roleName(ThreadRole role) {
+      switch (role) {
+      case ThreadRole::Render:           return "render";
+      case ThreadRole::Submission:       return "submission";
+      case ThreadRole::Worker:           return "worker";
+      case ThreadRole::TextureStreaming: return "texture streaming";
+      case ThreadRole::PipelineCompiler: return "pipeline compiler";
+      case ThreadRole::AssetLoader:      return "asset loader";
+      default:                           return "unknown";
+      }
+    }
+
+    const char* priorityName(ThreadPriority priority) {
+      switch (priority) {
+      case ThreadPriority::Lowest:  return "lowest";
+      case ThreadPriority::Low:     return "low";
+      case ThreadPriority::Normal:  return "normal";
+      case ThreadPriority::High:    return "high";
+      case ThreadPriority::Highest: return "highest";
+      default:                      return "unknown";
+      }
+    }
+
+    // The application's main thread is assumed to live on the first of the fastest cores,
+    // which is where schedulers put the foreground thread of a freshly started process.
+    const CpuCore* findMainThreadCore(const CpuTopology& topology) {
+      const uint32_t maxClass = topology.getMaxEfficiencyClass();
+
+      for (const CpuCore& core : topology.getCores()) {
+        if (core.efficiencyClass == maxClass)
+          return &core;
+      }
+
+      return nullptr;
+    }
+
+    bool matchesClass(const CpuTopology& topology, const CpuCore& core, const CpuCore& mainCore, CpuCoreClass coreClass) {
+      switch (coreClass) {
+      case CpuCoreClass::Performance:
+        return core.efficiencyClass == mainCore.efficiencyClass
+            && core.cacheGroup == mainCore.cacheGroup;
+      case CpuCoreClass::Efficiency:
+        if (topology.isHybrid())
+          return core.efficiencyClass == topology.getMinEfficiencyClass();
+        return core.cacheGroup != mainCore.cacheGroup;
+      default:
+        return true;
+      }
+    }
+
+    CoreSelection selectCores(const CpuTopology& topology, const ThreadPlacementPolicy& policy, CpuCoreClass coreClass) {
+      CoreSelection selection;
+
+      const CpuCore* mainCore = findMainThreadCore(topology);
+
+      if (mainCore == nullptr || coreClass == CpuCoreClass::Any)
+        return selection;
+
+      std::vector<const CpuCore*> candidates;
+
+      for (const CpuCore& core : topology.getCores()) {
+        if (matchesClass(topology, core, *mainCore, coreClass))
+          candidates.push_back(&core);
+      }
+
+      // Only give up the main thread's core when enough performance cores remain
+      if (coreClass == CpuCoreClass::Performance && policy.reserveMainThreadCore && candidates.size() >= 4)
+        candidates.erase(std::find(candidates.begin(), candidates.end(), mainCore));
+
+      if (candidates.empty())
+        return selection;
+
+      selection.group = candidates.front()->group;
+
+      for (const CpuCore* core : candidates) {
+        if (core->group == selection.group) {
+          selection.mask |= core->mask;
+          selection.coreCount++;
+        }
+      }
+
+      return selection;
+    }
+  }
+
+
+  CpuTopology CpuTopology::fromProcessorInformation(const uint8_t* data, size_t size) {
+    CpuTopology topology;
+
+    struct Cache {
+      uint32_t level;
+      uint32_t group;
+      uint64_t mask;
+    };
+
+    std::vector<Cache> caches;
+    uint32_t lastLevel = 0;
+
+    size_t offset = 0;
+
+    while (offset + offsetof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX, Processor) <= size) {
+      auto info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(data + offset);
+
+      if (info->Size == 0 || offset + info->Size > size)
+        break;
+
+      if (info->Relationship == RelationProcessorCore && info->Processor.GroupCount > 0) {
+        CpuCore core;
+        core.group = info->Processor.GroupMask[0].Group;
+        core.mask = info->Processor.GroupMask[0].Mask;
+        core.efficiencyClass = info->Processor.EfficiencyClass;
+        topology.m_cores.push_back(core);
+      } else if (info->Relationship == RelationCache
+              && (info->Cache.Type == CacheUnified || info->Cache.Type == CacheData)) {
+        Cache cache;
+        cache.level = info->Cache.Level;
+        cache.group = info->Cache.GroupMask.Group;
+        cache.mask = info->Cache.GroupMask.Mask;
+        caches.push_back(cache);
+
+        lastLevel = std::max(lastLevel, cache.level);
+      }
+
+      offset += info->Size;
+    }
+
+    // Cores sharing a last level cache form a cache group, numbered in order of appearance
+    std::vector<const Cache*> cacheGroups;
+
+    for (const Cache& cache : caches) {
+      if (cache.level == lastLevel)
+        cacheGroups.push_back(&cache);
+    }
+
+    for (CpuCore& core : topology.m_cores) {
+      for (uint32_t i = 0; i < cacheGroups.size(); i++) {
+        if (cacheGroups[i]->group == core.group && (cacheGroups[i]->mask & core.mask) != 0) {
+          core.cacheGroup = i;
+          break;
+        }
+      }
+    }
+
+    topology.m_cacheGroupCount = std::max<uint32_t>(1, uint32_t(cacheGroups.size()));
+    return topology;
+  }
+
+
+  CpuTopology CpuTopology::query() {
+    DWORD size = 0;
+
+    if (GetLogicalProcessorInformationEx(RelationAll, nullptr, &size) || GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+      return CpuTopology();
+
+    std::vector<uint8_t> buffer(size);
+
+    if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &size))
+      return CpuTopology();
+
+    return fromProcessorInformation(buffer.data(), size);
+  }
+
+
+  uint32_t CpuTopology::getLogicalProcessorCount() const {
+    uint32_t count = 0;
+
+    for (const CpuCore& core : m_cores)
+      count += popCount(core.mask);
+
+    return count;
+  }
+
+
+  uint32_t CpuTopology::getMinEfficiencyClass() const {
+    uint32_t result = ~0u;
+
+    for (const CpuCore& core : m_cores)
+      result = std::min(result, core.efficiencyClass);
+
+    return m_cores.empty() ? 0 : result;
+  }
+
+
+  uint32_t CpuTopology::getMaxEfficiencyClass() const {
+    uint32_t result = 0;
+
+    for (const CpuCore& core : m_cores)
+      result = std::max(result, core.efficiencyClass);
+
+    return result;
+  }
+
+
+  std::string CpuTopology::describe() const {
+    std::stringstream stream;
+
+    uint32_t performanceCores = 0;
+
+    for (const CpuCore& core : m_cores) {
+      if (core.efficiencyClass == getMaxEfficiencyClass())
+        performanceCores++;
+    }
+
+    stream << m_cores.size() << " cores, " << getLogicalProcessorCount() << " logical processors, "
+           << m_cacheGroupCount << " last level cache(s)";
+
+    if (isHybrid())
+      stream << ", " << performanceCores << " performance / " << (m_cores.size() - performanceCores) << " efficiency cores";
+
+    return stream.str();
+  }
+
+
+  ThreadPlacementMode ThreadPlacementPolicy::parseMode(const std::string& mode) {
+    if (mode == "disabled")
+      return ThreadPlacementMode::Disabled;
+    if (mode == "priority")
+      return ThreadPlacementMode::Priority;
+    if (mode == "affinity")
+      return ThreadPlacementMode::Affinity;
+    if (mode == "auto")
+      return ThreadPlacementMode::Auto;
+
+    return ThreadPlacementMode::Priority;
+  }
+
+
+  ThreadPlacement ThreadPlacementService::computePlacement(const CpuTopology& topology, const ThreadPlacementPolicy& policy, ThreadRole role) {
+    ThreadPlacement placement;
+
+    if (policy.mode == ThreadPlacementMode::Disabled || role >= ThreadRole::Count)
+      return placement;
+
+    const ThreadPlacementPolicy::RoleRule& rule = policy.roles[uint32_t(role)];
+
+    placement.setPriority = true;
+    placement.priority = rule.priority;
+
+    bool useAffinity = policy.mode == ThreadPlacementMode::Affinity;
+
+    // Affinity only pays off when cores are not interchangeable
+    if (policy.mode == ThreadPlacementMode::Auto)
+      useAffinity = topology.isHybrid() || topology.getCacheGroupCount() > 1;
+
+    if (useAffinity) {
+      CoreSelection selection = selectCores(topology, policy, rule.coreClass);
+      placement.group = selection.group;
+      placement.affinityMask = selection.mask;
+    }
+
+    return placement;
+  }
+
+
+  ThreadPlacementService& ThreadPlacementService::get() {
+    static ThreadPlacementService s_instance;
+    return s_instance;
+  }
+
+
+  void ThreadPlacementService::configure(const CpuTopology& topology, const ThreadPlacementPolicy& policy) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    m_topology = topology;
+
+    for (uint32_t i = 0; i < uint32_t(ThreadRole::Count); i++)
+      m_placements[i] = computePlacement(topology, policy, ThreadRole(i));
+  }
+
+
+  ThreadPlacement ThreadPlacementService::getPlacement(ThreadRole role) const {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    if (role >= ThreadRole::Count)
+      return ThreadPlacement();
+
+    return m_placements[uint32_t(role)];
+  }
+
+
+  void ThreadPlacementService::applyToCurrentThread(ThreadRole role) const {
+    const ThreadPlacement placement = getPlacement(role);
+
+    if (placement.setPriority)
+      ::SetThreadPriority(::GetCurrentThread(), int32_t(placement.priority));
+
+    if (placement.affinityMask != 0) {
+      GROUP_AFFINITY affinity = { };
+      affinity.Group = WORD(placement.group);
+      affinity.Mask = KAFFINITY(placement.affinityMask);
+      ::SetThreadGroupAffinity(::GetCurrentThread(), &affinity, nullptr);
+    }
+  }
+
+
+  std::string ThreadPlacementService::report() const {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    std::stringstream stream;
+    stream << "Thread placement: " << m_topology.describe();
+
+    for (uint32_t i = 0; i < uint32_t(ThreadRole::Count); i++) {
+      const ThreadPlacement& placement = m_placements[i];
+
+      stream << std::endl << "  " << roleName(ThreadRole(i)) << ": ";
+
+      if (!placement.setPriority) {
+        stream << "unchanged";
+        continue;
+      }
+
+      stream << priorityName(placement.priority) << " priority, ";
+
+      if (placement.affinityMask != 0)
+        stream << popCount(placement.affinityMask) << " logical processors (group " << placement.group
+               << ", mask 0x" << std::hex << placement.affinityMask << std::dec << ")";
+      else
+        stream << "any core";
+    }
+
+    return stream.str();
+  }
+
+}
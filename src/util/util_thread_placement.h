@@ -0,0 +1,197 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "thread.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Physical core
+   *
+   * A physical core and the logical processors (SMT siblings) it is made of.
+   */
+  struct CpuCore {
+    uint32_t group = 0;             // Processor group the core belongs to
+    uint64_t mask = 0;              // Logical processors of the core within its group
+    uint32_t efficiencyClass = 0;   // Higher is faster, all cores are class 0 on homogeneous CPUs
+    uint32_t cacheGroup = 0;        // Index of the last level cache the core shares with its neighbours
+  };
+
+  /**
+   * \brief CPU topology
+   *
+   * Physical cores grouped by core class (hybrid CPUs) and by last level cache (multi-CCD CPUs).
+   */
+  class CpuTopology {
+  public:
+    /**
+     * \brief Parses a processor information buffer
+     *
+     * \param [in] data Output of GetLogicalProcessorInformationEx(RelationAll, ...)
+     * \param [in] size Size of the buffer in bytes
+     * \returns The topology, empty if the buffer contains no cores
+     */
+    static CpuTopology fromProcessorInformation(const uint8_t* data, size_t size);
+
+    /**
+     * \brief Queries the topology of the system
+     */
+    static CpuTopology query();
+
+    const std::vector<CpuCore>& getCores() const {
+      return m_cores;
+    }
+
+    uint32_t getCacheGroupCount() const {
+      return m_cacheGroupCount;
+    }
+
+    uint32_t getLogicalProcessorCount() const;
+
+    uint32_t getMinEfficiencyClass() const;
+
+    uint32_t getMaxEfficiencyClass() const;
+
+    /**
+     * \brief Checks for performance and efficiency cores
+     */
+    bool isHybrid() const {
+      return getMinEfficiencyClass() != getMaxEfficiencyClass();
+    }
+
+    std::string describe() const;
+
+  private:
+    std::vector<CpuCore> m_cores;
+    uint32_t m_cacheGroupCount = 0;
+  };
+
+  /**
+   * \brief Runtime thread roles
+   */
+  enum class ThreadRole : uint32_t {
+    Render,             // CS thread, records the frame
+    Submission,         // Queue submission and retirement
+    Worker,             // Generic worker thread pools
+    TextureStreaming,   // Texture uploads
+    PipelineCompiler,   // Background pipeline compilation
+    AssetLoader,        // Replacement asset loading
+
+    Count
+  };
+
+  /**
+   * \brief Class of cores a thread is placed on
+   */
+  enum class CpuCoreClass : uint32_t {
+    Any,
+    Performance,        // Fastest cores, sharing the last level cache with the application's main thread
+    Efficiency,         // Slowest cores, or cores away from the application's main thread on homogeneous CPUs
+  };
+
+  enum class ThreadPlacementMode : uint32_t {
+    Disabled,           // Leave threads alone
+    Priority,           // Only set thread priorities
+    Affinity,           // Set thread priorities and restrict threads to their core class
+    Auto,               // Affinity on hybrid and multi-cache CPUs, Priority otherwise
+  };
+
+  /**
+   * \brief Thread placement policy
+   */
+  struct ThreadPlacementPolicy {
+    struct RoleRule {
+      CpuCoreClass coreClass;
+      ThreadPriority priority;
+    };
+
+    // Note: Affinities rely on a guess of where the application's main thread runs, so they are opt-in
+    ThreadPlacementMode mode = ThreadPlacementMode::Priority;
+
+    // Keeps the first performance core free for the application's main thread
+    bool reserveMainThreadCore = true;
+
+    std::array<RoleRule, size_t(ThreadRole::Count)> roles = {{
+      { CpuCoreClass::Performance, ThreadPriority::High },   // Render
+      { CpuCoreClass::Performance, ThreadPriority::High },   // Submission
+      { CpuCoreClass::Any,         ThreadPriority::Normal }, // Worker
+      { CpuCoreClass::Efficiency,  ThreadPriority::Normal }, // TextureStreaming
+      { CpuCoreClass::Efficiency,  ThreadPriority::Lowest }, // PipelineCompiler
+      { CpuCoreClass::Efficiency,  ThreadPriority::Low },    // AssetLoader
+    }};
+
+    static ThreadPlacementMode parseMode(const std::string& mode);
+  };
+
+  /**
+   * \brief Placement chosen for a thread role
+   */
+  struct ThreadPlacement {
+    bool setPriority = false;
+    ThreadPriority priority = ThreadPriority::Normal;
+    uint32_t group = 0;
+    uint64_t affinityMask = 0;      // 0 when the thread may run on any core
+  };
+
+  /**
+   * \brief Thread placement service
+   *
+   * Assigns each thread role a set of cores and a priority based on the CPU topology and a policy.
+   * Threads apply their placement themselves when they start, so the service must be configured
+   * before the runtime spawns its threads.
+   */
+  class ThreadPlacementService {
+  public:
+    /**
+     * \brief Computes the placement of a role
+     */
+    static ThreadPlacement computePlacement(const CpuTopology& topology, const ThreadPlacementPolicy& policy, ThreadRole role);
+
+    static ThreadPlacementService& get();
+
+    void configure(const CpuTopology& topology, const ThreadPlacementPolicy& policy);
+
+    ThreadPlacement getPlacement(ThreadRole role) const;
+
+    /**
+     * \brief Applies the placement of a role to the calling thread
+     */
+    void applyToCurrentThread(ThreadRole role) const;
+
+    /**
+     * \brief Describes the topology and the placement chosen for each role
+     */
+    std::string report() const;
+
+  private:
+    mutable dxvk::mutex m_mutex;
+    CpuTopology m_topology;
+    std::array<ThreadPlacement, size_t(ThreadRole::Count)> m_placements = { };
+  };
+
+}
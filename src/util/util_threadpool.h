@@ -33,6 +33,7 @@
 #include "util_env.h"
 #include "util_math.h"
 #include "util_fastops.h"
+#include "util_thread_placement.h"
 #include "sync/sync_spinlock.h"
 
 namespace dxvk {
@@ -47,6 +48,7 @@ namespace dxvk {
     *  LowLatency: Enables the low-latency mode where workers will spin instead of
     *              waiting for tasks on a conditional variable
     *  (ctor)workerName: Name given to threads with the pattern: workerName(N)
+    *  (ctor)role: Thread role the workers are placed on CPU cores with
     * 
     *  Example usage:
     *   // Creates 1 thread, and uses it to return PI via a future
@@ -65,7 +67,7 @@ namespace dxvk {
     using TaskMutex = std::conditional_t<LowLatency, Nop, dxvk::mutex>;
 
   public:
-    WorkerThreadPool(uint8_t numThreads, const char* workerName = "Nameless Worker Thread") 
+    WorkerThreadPool(uint8_t numThreads, const char* workerName = "Nameless Worker Thread", ThreadRole role = ThreadRole::Worker) 
      : m_numThread(numThreads) {
       m_workerTasks.resize(m_numThread);
       m_workerThreads.resize(m_numThread);
@@ -78,8 +80,9 @@ namespace dxvk {
 
       // Start the worker threads
       for (int i = 0; i < m_numThread; i++) {
-        m_workerThreads[i] = std::thread([this, i, workerName] {
+        m_workerThreads[i] = std::thread([this, i, workerName, role] {
           env::setThreadName(str::format(workerName, "(", i, ")"));
+          ThreadPlacementService::get().applyToCurrentThread(role);
           processWork(i);
         });
       }
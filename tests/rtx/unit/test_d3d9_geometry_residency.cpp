@@ -0,0 +1,202 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_geometry_residency.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Geometry buffer on a fake device, following what D3D9DeviceEx does on lock, unlock and draw
+  class FakeGeometryBuffer {
+  public:
+    FakeGeometryBuffer(uint32_t size, D3D9GeometryResidency residency, D3D9GeometryTraffic& traffic)
+    : m_residency(residency), m_traffic(traffic), m_shadow(size, 0), m_device(size, 0), m_expected(size, 0) { }
+
+    // Writes a pattern through a lock, as an application would
+    void write(uint32_t offset, uint32_t size, bool discard, uint8_t value) {
+      const bool shadowed = m_residency == D3D9GeometryResidency::Shadowed;
+
+      if (discard) {
+        // Discarding maps a fresh slice with undefined contents
+        std::fill(m_shadow.begin(), m_shadow.end(), uint8_t(0xcd));
+        std::fill(m_expected.begin(), m_expected.end(), uint8_t(0xcd));
+      }
+
+      uint32_t min, max;
+      GetLockRange(offset, size, uint32_t(m_shadow.size()), discard, shadowed, min, max);
+
+      if (m_dirtyMin == m_dirtyMax) {
+        m_dirtyMin = min;
+        m_dirtyMax = max;
+      } else {
+        m_dirtyMin = std::min(m_dirtyMin, min);
+        m_dirtyMax = std::max(m_dirtyMax, max);
+      }
+
+      const uint32_t end = size ? offset + size : uint32_t(m_shadow.size());
+      std::fill(m_shadow.begin() + offset, m_shadow.begin() + end, value);
+      std::fill(m_expected.begin() + offset, m_expected.begin() + end, value);
+
+      // Unlock: directly mapped buffers are read in place, shadowed ones upload the dirty range
+      if (shadowed) {
+        std::memcpy(m_device.data() + m_dirtyMin, m_shadow.data() + m_dirtyMin, m_dirtyMax - m_dirtyMin);
+        m_traffic.addUpload(m_dirtyMax - m_dirtyMin);
+      }
+
+      m_dirtyMin = m_dirtyMax = 0;
+    }
+
+    // Reads a range written by the application, as a draw would
+    void draw(uint32_t offset, uint32_t size) {
+      const std::vector<uint8_t>& memory = m_residency == D3D9GeometryResidency::Shadowed ? m_device : m_shadow;
+
+      if (std::memcmp(memory.data() + offset, m_expected.data() + offset, size) != 0)
+        throw DxvkError("Draw read stale geometry");
+
+      // The CPU always reads the shadow, which must hold what the application wrote
+      if (std::memcmp(m_shadow.data() + offset, m_expected.data() + offset, size) != 0)
+        throw DxvkError("CPU read stale geometry");
+
+      m_traffic.addDrawRead(m_residency, size);
+    }
+
+  private:
+    D3D9GeometryResidency m_residency;
+    D3D9GeometryTraffic& m_traffic;
+    std::vector<uint8_t> m_shadow;
+    std::vector<uint8_t> m_device;
+    std::vector<uint8_t> m_expected;
+    uint32_t m_dirtyMin = 0;
+    uint32_t m_dirtyMax = 0;
+  };
+}
+
+class GeometryResidencyTestApp {
+public:
+  static void run() {
+    testResidency();
+    testLockRange();
+
+    const uint64_t hostBytes = runWorkload(D3D9GeometryResidency::Host);
+    const uint64_t shadowedBytes = runWorkload(D3D9GeometryResidency::Shadowed);
+
+    if (shadowedBytes >= hostBytes)
+      throw DxvkError("Shadowed geometry did not reduce bus traffic");
+
+    cout << "Geometry bus traffic: " << hostBytes / 1024 << " KB host resident, "
+         << shadowedBytes / 1024 << " KB shadowed" << endl;
+  }
+
+private:
+  static void testResidency() {
+    if (DetermineGeometryResidency(false, true, false, true, true) != D3D9GeometryResidency::Default
+     || DetermineGeometryResidency(true, true, false, false, true) != D3D9GeometryResidency::Default)
+      throw DxvkError("Residency applied to buffers the CPU does not read");
+
+    if (DetermineGeometryResidency(true, true, false, true, true) != D3D9GeometryResidency::Shadowed
+     || DetermineGeometryResidency(true, false, false, true, true) != D3D9GeometryResidency::Shadowed)
+      throw DxvkError("Static geometry not shadowed");
+
+    if (DetermineGeometryResidency(true, true, true, true, true) != D3D9GeometryResidency::Host
+     || DetermineGeometryResidency(true, true, false, true, false) != D3D9GeometryResidency::Host)
+      throw DxvkError("Dynamic or unshadowed geometry not kept in host memory");
+  }
+
+  static void testLockRange() {
+    uint32_t min, max;
+
+    GetLockRange(64, 32, 1024, false, false, min, max);
+    if (min != 64 || max != 96)
+      throw DxvkError("Lock range ignores the user bounds");
+
+    GetLockRange(64, 0, 1024, false, true, min, max);
+    if (min != 0 || max != 1024)
+      throw DxvkError("Lock of size 0 does not cover the buffer");
+
+    GetLockRange(64, 32, 1024, true, false, min, max);
+    if (min != 0 || max != 1024)
+      throw DxvkError("Discarding lock of a direct mapped buffer does not cover the buffer");
+
+    GetLockRange(64, 32, 1024, true, true, min, max);
+    if (min != 64 || max != 96)
+      throw DxvkError("Discarding lock of a shadowed buffer not narrowed to the locked range");
+
+    GetLockRange(1000, 100, 1024, false, true, min, max);
+    if (min != 1000 || max != 1024)
+      throw DxvkError("Lock range not clamped to the buffer size");
+  }
+
+  // Static meshes drawn every frame plus a buffer partially rewritten every few frames
+  static uint64_t runWorkload(D3D9GeometryResidency residency) {
+    constexpr uint32_t kFrameCount = 120;
+    constexpr uint32_t kMeshSize = 64 << 10;
+
+    D3D9GeometryTraffic traffic;
+
+    std::vector<FakeGeometryBuffer> meshes;
+    for (uint32_t i = 0; i < 8; i++) {
+      meshes.emplace_back(kMeshSize, residency, traffic);
+      meshes.back().write(0, 0, false, uint8_t(i + 1));
+    }
+
+    FakeGeometryBuffer streamed(kMeshSize, residency, traffic);
+
+    for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+      if (frame % 4 == 0) {
+        // Discard and refill the first half, then append a few batches
+        streamed.write(0, kMeshSize / 2, true, uint8_t(frame));
+
+        for (uint32_t j = 0; j < 4; j++)
+          streamed.write(kMeshSize / 2 + j * 1024, 1024, false, uint8_t(frame + j));
+      }
+
+      streamed.draw(0, kMeshSize / 2 + 4096);
+
+      // Each mesh is drawn a couple of times, e.g. for the main view and for shadows
+      for (FakeGeometryBuffer& mesh : meshes) {
+        mesh.draw(0, kMeshSize);
+        mesh.draw(kMeshSize / 4, kMeshSize / 2);
+      }
+    }
+
+    if (traffic.getHostReadBytes() + traffic.getDeviceReadBytes() == 0)
+      throw DxvkError("Draw reads not counted");
+
+    return traffic.getBusBytes();
+  }
+};
+
+int main() {
+  try {
+    GeometryResidencyTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,296 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_rtx_instancing.h"
+
+using namespace dxvk;
+using namespace std;
+
+class InstanceStreamTestApp {
+public:
+  static void run() {
+    testAffineRows();
+    testFullMatrix();
+    testTranslation();
+    testDivisor();
+    testDetection();
+    testTruncatedStream();
+    testDrawTransform();
+  }
+
+private:
+  static constexpr D3DVERTEXELEMENT9 kEnd = D3DDECL_END();
+
+  static D3DVERTEXELEMENT9 makeElement(WORD stream, WORD offset, BYTE type, BYTE usage, BYTE usageIndex) {
+    return D3DVERTEXELEMENT9 { stream, offset, type, D3DDECLMETHOD_DEFAULT, usage, usageIndex };
+  }
+
+  // Geometry in stream 0, as every instanced draw has
+  static vector<D3DVERTEXELEMENT9> makeGeometryElements() {
+    return {
+      makeElement(0, 0,  D3DDECLTYPE_FLOAT3, D3DDECLUSAGE_POSITION, 0),
+      makeElement(0, 12, D3DDECLTYPE_FLOAT3, D3DDECLUSAGE_NORMAL,   0),
+      makeElement(0, 24, D3DDECLTYPE_FLOAT2, D3DDECLUSAGE_TEXCOORD, 0),
+    };
+  }
+
+  template<typename T>
+  static void append(vector<uint8_t>& data, const T& value) {
+    const size_t offset = data.size();
+    data.resize(offset + sizeof(T));
+    memcpy(data.data() + offset, &value, sizeof(T));
+  }
+
+  static void expectPoint(const Matrix4& transform, const Vector4& position, const Vector4& expected, const char* what) {
+    const Vector4 result = transform * position;
+
+    for (uint32_t i = 0; i < 4; i++) {
+      if (std::abs(result[i] - expected[i]) > 1e-5f) {
+        throw DxvkError(str::format(what, ": expected (", expected.x, ", ", expected.y, ", ", expected.z, ", ", expected.w,
+                                    "), got (", result.x, ", ", result.y, ", ", result.z, ", ", result.w, ")"));
+      }
+    }
+  }
+
+  static void expectLayout(const D3D9InstanceStreamLayout& layout, D3D9InstanceTransformLayout transform, uint32_t stream, uint32_t offset, const char* what) {
+    if (layout.transform != transform || layout.stream != stream || layout.offset != offset) {
+      throw DxvkError(str::format(what, ": unexpected layout ", uint32_t(layout.transform), " in stream ", layout.stream, " at offset ", layout.offset));
+    }
+  }
+
+  static void testAffineRows() {
+    // Color and three rows of a 3x4 matrix in stream 1, with the
+    // shader computing float3(dot(pos, row0), dot(pos, row1), dot(pos, row2))
+    vector<D3DVERTEXELEMENT9> elements = makeGeometryElements();
+    elements.push_back(makeElement(1, 0,  D3DDECLTYPE_D3DCOLOR, D3DDECLUSAGE_COLOR,    1));
+    elements.push_back(makeElement(1, 4,  D3DDECLTYPE_FLOAT4,   D3DDECLUSAGE_TEXCOORD, 1));
+    elements.push_back(makeElement(1, 20, D3DDECLTYPE_FLOAT4,   D3DDECLUSAGE_TEXCOORD, 2));
+    elements.push_back(makeElement(1, 36, D3DDECLTYPE_FLOAT4,   D3DDECLUSAGE_TEXCOORD, 3));
+    elements.push_back(kEnd);
+
+    const D3D9InstanceStreamLayout layout = DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 1u << 1);
+    expectLayout(layout, D3D9InstanceTransformLayout::Rows3x4, 1, 4, "Affine rows");
+
+    const uint32_t stride = 4 + 3 * sizeof(Vector4);
+    vector<uint8_t> data;
+
+    for (uint32_t i = 0; i < 3; i++) {
+      // Scale by i + 1, rotate 90 degrees about z and move by (10 * i, 1, 2)
+      const float s = float(i + 1);
+      append(data, uint32_t(0xFF00FF00));
+      append(data, Vector4 { 0.0f, -s,   0.0f, 10.0f * float(i) });
+      append(data, Vector4 { s,    0.0f, 0.0f, 1.0f });
+      append(data, Vector4 { 0.0f, 0.0f, s,    2.0f });
+    }
+
+    vector<Matrix4> transforms;
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), stride, 1, 3, transforms) != 3)
+      throw DxvkError("Affine rows: wrong number of instances decoded");
+
+    expectPoint(transforms[0], Vector4 { 1.0f, 0.0f, 0.0f, 1.0f }, Vector4 { 0.0f, 2.0f, 2.0f, 1.0f }, "Affine rows, instance 0");
+    expectPoint(transforms[2], Vector4 { 1.0f, 2.0f, 3.0f, 1.0f }, Vector4 { 14.0f, 4.0f, 11.0f, 1.0f }, "Affine rows, instance 2");
+
+    // Directions are not translated
+    expectPoint(transforms[1], Vector4 { 0.0f, 1.0f, 0.0f, 0.0f }, Vector4 { -2.0f, 0.0f, 0.0f, 0.0f }, "Affine rows, direction");
+  }
+
+  static void testFullMatrix() {
+    // Four rows of a row vector matrix, i.e. mul(pos, float4x4(rows)), starting at TEXCOORD4
+    vector<D3DVERTEXELEMENT9> elements = makeGeometryElements();
+    for (BYTE row = 0; row < 4; row++)
+      elements.push_back(makeElement(2, WORD(row * sizeof(Vector4)), D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, BYTE(4 + row)));
+    elements.push_back(kEnd);
+
+    const D3D9InstanceStreamLayout layout = DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 1u << 2);
+    expectLayout(layout, D3D9InstanceTransformLayout::Matrix4x4, 2, 0, "Full matrix");
+
+    vector<uint8_t> data;
+    append(data, Vector4 { 2.0f, 0.0f, 0.0f, 0.0f });
+    append(data, Vector4 { 0.0f, 2.0f, 0.0f, 0.0f });
+    append(data, Vector4 { 0.0f, 0.0f, 2.0f, 0.0f });
+    append(data, Vector4 { 5.0f, 6.0f, 7.0f, 1.0f });
+
+    vector<Matrix4> transforms;
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), 4 * sizeof(Vector4), 1, 1, transforms) != 1)
+      throw DxvkError("Full matrix: wrong number of instances decoded");
+
+    expectPoint(transforms[0], Vector4 { 1.0f, 1.0f, 1.0f, 1.0f }, Vector4 { 7.0f, 8.0f, 9.0f, 1.0f }, "Full matrix");
+  }
+
+  static void testTranslation() {
+    // float4 position with a uniform scale in w
+    vector<D3DVERTEXELEMENT9> elements = makeGeometryElements();
+    elements.push_back(makeElement(1, 0, D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_POSITION, 1));
+    elements.push_back(kEnd);
+
+    D3D9InstanceStreamLayout layout = DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 1u << 1);
+    expectLayout(layout, D3D9InstanceTransformLayout::Translation, 1, 0, "Translation and scale");
+
+    vector<uint8_t> data;
+    append(data, Vector4 { 1.0f, 2.0f, 3.0f, 4.0f });
+    append(data, Vector4 { -1.0f, 0.0f, 0.0f, 0.0f });
+
+    vector<Matrix4> transforms;
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), sizeof(Vector4), 1, 2, transforms) != 2)
+      throw DxvkError("Translation and scale: wrong number of instances decoded");
+
+    expectPoint(transforms[0], Vector4 { 1.0f, 1.0f, 1.0f, 1.0f }, Vector4 { 5.0f, 6.0f, 7.0f, 1.0f }, "Translation and scale");
+    expectPoint(transforms[1], Vector4 { 1.0f, 1.0f, 1.0f, 1.0f }, Vector4 { 0.0f, 1.0f, 1.0f, 1.0f }, "Translation without scale");
+
+    // float3 position
+    elements = makeGeometryElements();
+    elements.push_back(makeElement(3, 8, D3DDECLTYPE_FLOAT3, D3DDECLUSAGE_POSITION, 1));
+    elements.push_back(kEnd);
+
+    layout = DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 1u << 3);
+    expectLayout(layout, D3D9InstanceTransformLayout::Translation, 3, 8, "Translation");
+
+    data.clear();
+    append(data, uint64_t(0));
+    append(data, Vector3 { 1.0f, 2.0f, 3.0f });
+
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), 20, 1, 1, transforms) != 1)
+      throw DxvkError("Translation: wrong number of instances decoded");
+
+    expectPoint(transforms[0], Vector4 { 1.0f, 1.0f, 1.0f, 1.0f }, Vector4 { 2.0f, 3.0f, 4.0f, 1.0f }, "Translation");
+  }
+
+  static void testDivisor() {
+    // With a step rate of 2, every instance element is used by two instances
+    D3D9InstanceStreamLayout layout;
+    layout.transform = D3D9InstanceTransformLayout::Translation;
+    layout.stream = 1;
+    layout.type = D3DDECLTYPE_FLOAT3;
+
+    vector<uint8_t> data;
+    for (uint32_t i = 0; i < 3; i++)
+      append(data, Vector3 { float(i), 0.0f, 0.0f });
+
+    vector<Matrix4> transforms;
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), sizeof(Vector3), 2, 5, transforms) != 5)
+      throw DxvkError("Divisor: wrong number of instances decoded");
+
+    const float expected[] = { 0.0f, 0.0f, 1.0f, 1.0f, 2.0f };
+    for (uint32_t i = 0; i < 5; i++)
+      expectPoint(transforms[i], Vector4 { 0.0f, 0.0f, 0.0f, 1.0f }, Vector4 { expected[i], 0.0f, 0.0f, 1.0f }, "Divisor");
+  }
+
+  static void testDetection() {
+    // Rows in a stream without instance data are not instance transforms
+    vector<D3DVERTEXELEMENT9> elements = makeGeometryElements();
+    for (BYTE row = 0; row < 3; row++)
+      elements.push_back(makeElement(1, WORD(row * sizeof(Vector4)), D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, BYTE(1 + row)));
+    elements.push_back(kEnd);
+
+    expectLayout(DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 0), D3D9InstanceTransformLayout::None, 0, 0, "Non instanced stream");
+
+    // Two rows are not a transform, and neither is a lone float4 texcoord
+    elements = makeGeometryElements();
+    elements.push_back(makeElement(1, 0,  D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, 1));
+    elements.push_back(makeElement(1, 16, D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, 2));
+    elements.push_back(makeElement(1, 48, D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, 3));
+    elements.push_back(kEnd);
+
+    expectLayout(DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 1u << 1), D3D9InstanceTransformLayout::None, 0, 0, "Broken run");
+
+    // Rows declared out of order are still found, and take precedence over an instance position
+    elements = makeGeometryElements();
+    elements.push_back(makeElement(1, 0,  D3DDECLTYPE_FLOAT3, D3DDECLUSAGE_POSITION, 1));
+    elements.push_back(makeElement(1, 44, D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, 7));
+    elements.push_back(makeElement(1, 12, D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, 5));
+    elements.push_back(makeElement(1, 28, D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TEXCOORD, 6));
+    elements.push_back(kEnd);
+
+    expectLayout(DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 1u << 1), D3D9InstanceTransformLayout::Rows3x4, 1, 12, "Out of order rows");
+
+    // Elements past the end marker are ignored
+    elements = makeGeometryElements();
+    elements.push_back(kEnd);
+    elements.push_back(makeElement(1, 0, D3DDECLTYPE_FLOAT3, D3DDECLUSAGE_POSITION, 1));
+
+    expectLayout(DetectInstanceStreamLayout(elements.data(), uint32_t(elements.size()), 1u << 1), D3D9InstanceTransformLayout::None, 0, 0, "End marker");
+  }
+
+  static void testTruncatedStream() {
+    // A stream shorter than the instance count only yields the instances it holds
+    D3D9InstanceStreamLayout layout;
+    layout.transform = D3D9InstanceTransformLayout::Rows3x4;
+    layout.stream = 1;
+    layout.offset = 0;
+
+    vector<uint8_t> data(2 * 3 * sizeof(Vector4) + 8, 0);
+
+    vector<Matrix4> transforms;
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), 3 * sizeof(Vector4), 1, 4, transforms) != 2)
+      throw DxvkError("Truncated stream: expected 2 instances");
+
+    layout.transform = D3D9InstanceTransformLayout::None;
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), 3 * sizeof(Vector4), 1, 4, transforms) != 0 || !transforms.empty())
+      throw DxvkError("No layout: expected no instances");
+  }
+
+  static void testDrawTransform() {
+    // The instance transform places the geometry within the draw's object space, the draw's own transform then applies
+    D3D9InstanceStreamLayout layout;
+    layout.transform = D3D9InstanceTransformLayout::Translation;
+    layout.stream = 1;
+    layout.type = D3DDECLTYPE_FLOAT3;
+
+    vector<uint8_t> data;
+    append(data, Vector3 { 1.0f, 2.0f, 3.0f });
+
+    vector<Matrix4> transforms;
+    if (DecodeInstanceTransforms(layout, data.data(), data.size(), sizeof(Vector3), 1, 1, transforms) != 1)
+      throw DxvkError("Draw transform: wrong number of instances decoded");
+
+    // Scale by 2, rotate 90 degrees about z and move by (10, 0, 0)
+    const Matrix4 objectToWorld(
+      Vector4 { 0.0f,  2.0f, 0.0f, 0.0f },
+      Vector4 { -2.0f, 0.0f, 0.0f, 0.0f },
+      Vector4 { 0.0f,  0.0f, 2.0f, 0.0f },
+      Vector4 { 10.0f, 0.0f, 0.0f, 1.0f });
+
+    const Matrix4 instanceToWorld = GetInstanceObjectToWorld(objectToWorld, transforms[0]);
+
+    // (1, 0, 0) is (2, 2, 3) in the draw's object space
+    expectPoint(instanceToWorld, Vector4 { 1.0f, 0.0f, 0.0f, 1.0f }, Vector4 { 6.0f, 4.0f, 6.0f, 1.0f }, "Draw transform");
+    expectPoint(instanceToWorld, Vector4 { 0.0f, 1.0f, 0.0f, 0.0f }, Vector4 { -2.0f, 0.0f, 0.0f, 0.0f }, "Draw transform, direction");
+
+    // An identity draw transform leaves the instance transform as is
+    expectPoint(GetInstanceObjectToWorld(Matrix4(), transforms[0]), Vector4 { 1.0f, 0.0f, 0.0f, 1.0f }, Vector4 { 2.0f, 2.0f, 3.0f, 1.0f }, "Identity draw transform");
+  }
+};
+
+int main() {
+  try {
+    InstanceStreamTestApp::run();
+  } catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
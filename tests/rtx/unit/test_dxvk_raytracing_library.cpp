@@ -0,0 +1,248 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_raytracing_library.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Mock pipeline backend: libraries are plain ids, creation and destruction are counted
+  struct MockBackend {
+    std::atomic<uint32_t> numCreated = { 0 };
+    std::atomic<uint32_t> numDestroyed = { 0 };
+    std::atomic<bool>     failNext = { false };
+
+    uint32_t create() {
+      if (failNext.exchange(false))
+        throw DxvkError("Mock library compilation failed");
+
+      return ++numCreated;
+    }
+  };
+
+  constexpr size_t kRayGen           = 1;
+  constexpr size_t kRayGenSer        = 2;
+  constexpr size_t kMiss             = 10;
+  constexpr size_t kClosestHit       = 20;
+  constexpr size_t kClosestHitAlpha  = 21;
+
+  DxvkRaytracingLibraryInterface makeInterface(size_t layoutHash = 100, uint32_t flags = 0) {
+    DxvkRaytracingLibraryInterface iface;
+    iface.layoutHash = layoutHash;
+    iface.flags = flags;
+    iface.maxPayloadSize = 64;
+    iface.maxHitAttributeSize = 8;
+    return iface;
+  }
+
+  std::vector<DxvkRaytracingLinkGroup> makePass(size_t rayGen) {
+    return {
+      { rayGen, true },
+      { kMiss, false },
+      { kClosestHit, false },
+      { kClosestHitAlpha, false },
+    };
+  }
+
+  std::vector<uint32_t> link(DxvkRaytracingLibraryCache<uint32_t>& cache, MockBackend& backend, const DxvkRaytracingLinkPlan& plan) {
+    std::vector<uint32_t> libraries;
+
+    for (const auto& library : plan.libraries)
+      libraries.push_back(cache.acquire(library.key, [&] { return backend.create(); }));
+
+    return libraries;
+  }
+}
+
+class RaytracingLibraryTestApp {
+public:
+  static void run() {
+    testPlan();
+    testDuplicateGroups();
+    testSharingAcrossPermutations();
+    testInterfaceKeys();
+    testConcurrentAcquire();
+    testFailureRetry();
+  }
+
+private:
+  static void testPlan() {
+    const auto plan = DxvkRaytracingLinkPlan::create(makePass(kRayGen), makeInterface());
+
+    if (plan.libraries.size() != 2 || plan.handleCount != 4)
+      throw DxvkError("Link plan did not split a pass into a ray generation and a hit library");
+
+    if (plan.libraries[0].groups != std::vector<uint32_t> { 0 } ||
+        plan.libraries[1].groups != std::vector<uint32_t> { 1, 2, 3 })
+      throw DxvkError("Link plan assigned groups to the wrong libraries");
+
+    for (uint32_t i = 0; i < 4; i++) {
+      if (plan.groupHandleIndices[i] != i)
+        throw DxvkError(str::format("Unexpected handle index for group ", i));
+    }
+
+    // Ray generation groups listed after others still come first in the linked pipeline
+    const auto reordered = DxvkRaytracingLinkPlan::create({ { kMiss, false }, { kRayGen, true } }, makeInterface());
+
+    if (reordered.groupHandleIndices[0] != 1 || reordered.groupHandleIndices[1] != 0)
+      throw DxvkError("Handle indices do not follow the library order");
+
+    // A pipeline with only ray generation groups needs a single library
+    const auto rayGenOnly = DxvkRaytracingLinkPlan::create({ { kRayGen, true } }, makeInterface());
+
+    if (rayGenOnly.libraries.size() != 1 || rayGenOnly.handleCount != 1)
+      throw DxvkError("Link plan created an empty library");
+  }
+
+  static void testDuplicateGroups() {
+    const auto plan = DxvkRaytracingLinkPlan::create({
+      { kRayGen, true },
+      { kMiss, false },
+      { kClosestHit, false },
+      { kClosestHit, false },
+      { kClosestHitAlpha, false },
+    }, makeInterface());
+
+    if (plan.handleCount != 4 || plan.libraries[1].groups.size() != 3)
+      throw DxvkError("Duplicate groups were compiled more than once");
+
+    if (plan.groupHandleIndices[2] != plan.groupHandleIndices[3] || plan.groupHandleIndices[4] != 3)
+      throw DxvkError("Duplicate groups do not share a handle");
+  }
+
+  static void testSharingAcrossPermutations() {
+    MockBackend backend;
+
+    {
+      DxvkRaytracingLibraryCache<uint32_t> cache([&] (uint32_t) { ++backend.numDestroyed; });
+
+      // Same pass with and without SER: only the ray generation shader differs
+      const auto plain = DxvkRaytracingLinkPlan::create(makePass(kRayGen), makeInterface());
+      const auto ser = DxvkRaytracingLinkPlan::create(makePass(kRayGenSer), makeInterface());
+
+      const auto plainLibraries = link(cache, backend, plain);
+      const auto serLibraries = link(cache, backend, ser);
+
+      if (plainLibraries[0] == serLibraries[0])
+        throw DxvkError("Permutations with different ray generation shaders share a library");
+
+      if (plainLibraries[1] != serLibraries[1])
+        throw DxvkError("Permutations do not share the hit library");
+
+      // Registering the same permutation again compiles nothing
+      link(cache, backend, plain);
+
+      cout << "Compiled " << cache.getCompileCount() << " libraries, reused " << cache.getReuseCount() << endl;
+
+      if (cache.getCompileCount() != 3 || cache.getReuseCount() != 3 || backend.numCreated != 3)
+        throw DxvkError("Unexpected number of library compilations");
+    }
+
+    if (backend.numDestroyed != 3)
+      throw DxvkError("Libraries were not destroyed exactly once");
+  }
+
+  static void testInterfaceKeys() {
+    MockBackend backend;
+    DxvkRaytracingLibraryCache<uint32_t> cache([] (uint32_t) { });
+
+    link(cache, backend, DxvkRaytracingLinkPlan::create(makePass(kRayGen), makeInterface()));
+
+    // Libraries must not be shared between pipelines with a different layout or flags (e.g. OMM)
+    link(cache, backend, DxvkRaytracingLinkPlan::create(makePass(kRayGen), makeInterface(101)));
+    link(cache, backend, DxvkRaytracingLinkPlan::create(makePass(kRayGen), makeInterface(100, 1)));
+
+    DxvkRaytracingLibraryInterface largerPayload = makeInterface();
+    largerPayload.maxPayloadSize = 128;
+    link(cache, backend, DxvkRaytracingLinkPlan::create(makePass(kRayGen), largerPayload));
+
+    if (cache.getCompileCount() != 8 || cache.getReuseCount() != 0)
+      throw DxvkError("Libraries were shared between incompatible interfaces");
+  }
+
+  static void testConcurrentAcquire() {
+    MockBackend backend;
+    DxvkRaytracingLibraryCache<uint32_t> cache([] (uint32_t) { });
+
+    const auto plan = DxvkRaytracingLinkPlan::create(makePass(kRayGen), makeInterface());
+
+    constexpr uint32_t kThreadCount = 8;
+    std::vector<std::vector<uint32_t>> results(kThreadCount);
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < kThreadCount; i++) {
+      threads.emplace_back([&, i] {
+        results[i] = link(cache, backend, plan);
+      });
+    }
+
+    for (auto& thread : threads)
+      thread.join();
+
+    for (uint32_t i = 1; i < kThreadCount; i++) {
+      if (results[i] != results[0])
+        throw DxvkError("Concurrent requests received different libraries");
+    }
+
+    if (backend.numCreated != 2)
+      throw DxvkError("Concurrent requests compiled a library more than once");
+  }
+
+  static void testFailureRetry() {
+    MockBackend backend;
+    DxvkRaytracingLibraryCache<uint32_t> cache([] (uint32_t) { });
+
+    const auto plan = DxvkRaytracingLinkPlan::create(makePass(kRayGen), makeInterface());
+
+    backend.failNext = true;
+    bool threw = false;
+
+    try {
+      link(cache, backend, plan);
+    } catch (const DxvkError&) {
+      threw = true;
+    }
+
+    if (!threw)
+      throw DxvkError("Library compilation failure was not reported");
+
+    if (link(cache, backend, plan).size() != 2 || cache.getCompileCount() != 2)
+      throw DxvkError("Failed library was not compiled again");
+  }
+};
+
+int main() {
+  try {
+    RaytracingLibraryTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
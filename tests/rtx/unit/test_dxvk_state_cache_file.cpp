@@ -0,0 +1,367 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_state_cache_file.h"
+#include "../../../src/util/sha1/sha1_util.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Size of the common state cache header preceding the body
+  constexpr size_t kBodyOffset = 12;
+
+  // Synthetic serialized entries, sized like typical graphics pipeline entries
+  struct RecordSet {
+    std::vector<char> data;
+    std::vector<DxvkStateCacheRecord> records;
+  };
+
+  RecordSet makeRecords(uint32_t count, uint32_t seed) {
+    RecordSet set;
+    std::vector<size_t> offsets;
+
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t size = 160 + (i * 37 + seed) % 256;
+      uint32_t id = seed * 0x10000000u + i;
+
+      offsets.push_back(set.data.size());
+
+      for (uint32_t j = 0; j < size; j++)
+        set.data.push_back(char(j < sizeof(id) ? (id >> (8 * j)) : (id * 31 + j)));
+
+      DxvkStateCacheRecord record;
+      record.size      = size;
+      record.stageMask = (i % 8) ? 0x11 : 0x20;
+      record.lastUse   = i % 16;
+      set.records.push_back(record);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      auto& record = set.records[i];
+      record.data = &set.data[offsets[i]];
+      record.checksum = DxvkStateCacheFile::computeChecksum(record.stageMask, record.data, record.size);
+    }
+
+    return set;
+  }
+
+  std::string writeFile(const std::vector<DxvkStateCacheRecord>& records, uint32_t session) {
+    std::ostringstream stream;
+    stream << std::string(kBodyOffset, 'H');
+
+    DxvkStateCacheIndexHeader indexHeader;
+    std::vector<DxvkStateCacheIndexEntry> index;
+    DxvkStateCacheFile::write(stream, kBodyOffset, session, records, indexHeader, index);
+    return stream.str();
+  }
+
+  void appendRecords(std::string& file, const std::vector<DxvkStateCacheRecord>& records) {
+    std::ostringstream stream;
+
+    for (const auto& record : records)
+      DxvkStateCacheFile::writeRecord(stream, record);
+
+    file += stream.str();
+  }
+
+  struct ParseResult {
+    bool valid = false;
+    DxvkStateCacheIndexHeader indexHeader;
+    std::vector<DxvkStateCacheIndexEntry> index;
+    std::vector<DxvkStateCacheRecord> records;
+    DxvkStateCacheFileStats stats;
+  };
+
+  ParseResult parseFile(const std::string& file) {
+    ParseResult result;
+    result.valid = DxvkStateCacheFile::parse(file.data(), file.size(), kBodyOffset,
+      result.indexHeader, result.index, result.records, result.stats);
+    return result;
+  }
+
+  bool equalRecords(const DxvkStateCacheRecord& a, const DxvkStateCacheRecord& b) {
+    return a.size == b.size
+        && a.stageMask == b.stageMask
+        && a.checksum == b.checksum
+        && !std::memcmp(a.data, b.data, a.size);
+  }
+
+  double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+  }
+}
+
+class StateCacheFileTestApp {
+public:
+  static void run() {
+    testRoundTrip();
+    testAppendedRecords();
+    testCorruption();
+    testDuplicates();
+    testCompaction();
+    benchmark();
+  }
+
+private:
+  static void testRoundTrip() {
+    RecordSet set = makeRecords(1000, 1);
+    std::string file = writeFile(set.records, 7);
+    ParseResult result = parseFile(file);
+
+    if (!result.valid || result.records.size() != set.records.size())
+      throw DxvkError("State cache file: round trip lost records");
+
+    if (result.indexHeader.session != 7 || result.indexHeader.compactSession != 7 || result.indexHeader.tailOffset != file.size())
+      throw DxvkError("State cache file: unexpected index header");
+
+    for (size_t i = 0; i < set.records.size(); i++) {
+      if (!equalRecords(result.records[i], set.records[i]) || result.records[i].lastUse != set.records[i].lastUse)
+        throw DxvkError(str::format("State cache file: record ", i, " differs after round trip"));
+    }
+
+    if (result.stats.indexedRecords != 1000 || result.stats.appendedRecords || result.stats.invalidRecords || result.stats.duplicateRecords)
+      throw DxvkError("State cache file: unexpected round trip statistics");
+
+    // Files without a usable index are rejected as a whole
+    std::string truncated = file.substr(0, kBodyOffset + 8);
+
+    if (parseFile(truncated).valid)
+      throw DxvkError("State cache file: accepted a truncated index");
+  }
+
+  static void testAppendedRecords() {
+    RecordSet indexed = makeRecords(100, 2);
+    RecordSet appended = makeRecords(50, 3);
+
+    std::string file = writeFile(indexed.records, 1);
+    appendRecords(file, appended.records);
+
+    ParseResult result = parseFile(file);
+
+    if (result.stats.indexedRecords != 100 || result.stats.appendedRecords != 50 || result.records.size() != 150)
+      throw DxvkError("State cache file: appended records not found");
+
+    // Indexed records come first, appended ones follow in file order
+    if (!equalRecords(result.records[0], indexed.records[0]) || !equalRecords(result.records[100], appended.records[0]))
+      throw DxvkError("State cache file: unexpected record order");
+
+    // A record cut off by a crash while appending is dropped
+    std::string truncated = file.substr(0, file.size() - 10);
+    result = parseFile(truncated);
+
+    if (result.stats.appendedRecords != 49 || result.stats.invalidRecords != 1)
+      throw DxvkError("State cache file: truncated record not detected");
+  }
+
+  static void testCorruption() {
+    RecordSet set = makeRecords(100, 4);
+    std::string file = writeFile(set.records, 1);
+
+    // Corrupt the data of one record and the stage mask of another
+    ParseResult result = parseFile(file);
+    size_t dataOffset = size_t(result.index[10].offset) + sizeof(DxvkStateCacheRecordHeader) + 20;
+    size_t maskOffset = size_t(result.index[20].offset);
+
+    file[dataOffset] ^= 0x01;
+    file[maskOffset] ^= 0x02;
+
+    result = parseFile(file);
+
+    if (result.records.size() != 98 || result.stats.invalidRecords != 2)
+      throw DxvkError("State cache file: corrupted records not detected");
+
+    // Index entries pointing outside of the indexed records are dropped
+    DxvkStateCacheIndexEntry entry;
+    entry.offset = file.size();
+    std::memcpy(&file[kBodyOffset + sizeof(DxvkStateCacheIndexHeader)], &entry, sizeof(entry));
+
+    result = parseFile(file);
+
+    if (result.records.size() != 97 || result.stats.invalidRecords != 3)
+      throw DxvkError("State cache file: invalid index entry not detected");
+
+    // Offsets and sizes close to the end of the address space must not wrap around the bounds checks
+    entry.offset = ~uint64_t(0) - sizeof(DxvkStateCacheRecordHeader) / 2;
+    std::memcpy(&file[kBodyOffset + sizeof(DxvkStateCacheIndexHeader) + sizeof(entry)], &entry, sizeof(entry));
+
+    DxvkStateCacheRecordHeader header;
+    size_t headerOffset = size_t(result.index[30].offset);
+    std::memcpy(&header, &file[headerOffset], sizeof(header));
+    header.entrySize = (1u << 24) - 1;
+    std::memcpy(&file[headerOffset], &header, sizeof(header));
+
+    result = parseFile(file);
+
+    if (result.records.size() != 95 || result.stats.invalidRecords != 5)
+      throw DxvkError("State cache file: out of range record not detected");
+  }
+
+  static void testDuplicates() {
+    RecordSet set = makeRecords(100, 5);
+    std::string file = writeFile(set.records, 20);
+
+    // Append the same pipeline twice more, once with a more recent use
+    DxvkStateCacheRecord recent = set.records[3];
+    recent.lastUse = 20;
+
+    DxvkStateCacheRecord older = set.records[3];
+    older.lastUse = 0;
+
+    appendRecords(file, { recent, older });
+
+    ParseResult result = parseFile(file);
+
+    if (result.records.size() != 100 || result.stats.duplicateRecords != 2)
+      throw DxvkError("State cache file: duplicates not removed");
+
+    if (result.records[3].lastUse != 20)
+      throw DxvkError("State cache file: duplicate did not keep the most recent use");
+  }
+
+  static void testCompaction() {
+    RecordSet set = makeRecords(64, 6);
+
+    // Most recently used first, ties keep their order
+    std::vector<uint32_t> order = DxvkStateCacheFile::compact(set.records, 20, 0);
+
+    if (order.size() != 64)
+      throw DxvkError("State cache file: compaction without eviction dropped records");
+
+    for (size_t i = 1; i < order.size(); i++) {
+      const auto& a = set.records[order[i - 1]];
+      const auto& b = set.records[order[i]];
+
+      if (a.lastUse < b.lastUse || (a.lastUse == b.lastUse && order[i - 1] > order[i]))
+        throw DxvkError("State cache file: compaction did not order records by last use");
+    }
+
+    // Records used in sessions 0 to 15, allow 10 unused sessions at session 20
+    order = DxvkStateCacheFile::compact(set.records, 20, 10);
+
+    for (uint32_t i : order) {
+      if (set.records[i].lastUse < 10)
+        throw DxvkError("State cache file: compaction kept a stale record");
+    }
+
+    if (order.size() != 64 - 4 * 10)
+      throw DxvkError(str::format("State cache file: compaction kept ", order.size(), " records"));
+  }
+
+  // Times a function, taking the fastest of a few runs to keep the comparisons below stable
+  template<typename Fn>
+  static double timeMs(const Fn& fn) {
+    double bestMs = 0.0;
+
+    for (uint32_t i = 0; i < 3; i++) {
+      auto start = std::chrono::high_resolution_clock::now();
+      fn();
+      double ms = elapsedMs(start);
+      bestMs = i ? std::min(bestMs, ms) : ms;
+    }
+
+    return bestMs;
+  }
+
+  static size_t recordBytes(const RecordSet& set) {
+    return set.data.size() + set.records.size() * sizeof(DxvkStateCacheRecordHeader);
+  }
+
+  static void benchmark() {
+    constexpr uint32_t kIndexedCount = 250000;
+    constexpr uint32_t kAppendedCount = 50000;
+
+    RecordSet indexed = makeRecords(kIndexedCount, 7);
+    RecordSet appended = makeRecords(kAppendedCount, 8);
+
+    // Append-only file as grown by many sessions: every record
+    // appended once more, plus the records of the last sessions
+    std::string file = writeFile({ }, 1);
+    appendRecords(file, indexed.records);
+    appendRecords(file, indexed.records);
+    appendRecords(file, appended.records);
+
+    ParseResult result;
+    double parseMs = timeMs([&] { result = parseFile(file); });
+
+    if (result.records.size() != kIndexedCount + kAppendedCount || result.stats.duplicateRecords != kIndexedCount)
+      throw DxvkError("State cache file: unexpected benchmark parse result");
+
+    // Reference: scalar SHA-1 validation of the same records
+    uint32_t sha1Count = 0;
+    double sha1Ms = timeMs([&] {
+      sha1Count = 0;
+
+      for (const auto& record : result.records)
+        sha1Count += Sha1Hash::compute(record.data, record.size).dword(0) != 0;
+    });
+
+    std::vector<uint32_t> order = DxvkStateCacheFile::compact(result.records, 20, 0);
+    std::vector<DxvkStateCacheRecord> compacted;
+
+    for (uint32_t i : order)
+      compacted.push_back(result.records[i]);
+
+    std::string compactedFile = writeFile(compacted, 20);
+
+    ParseResult compactedResult;
+    double compactedParseMs = timeMs([&] { compactedResult = parseFile(compactedFile); });
+
+    if (compactedResult.records.size() != compacted.size() || compactedResult.stats.appendedRecords)
+      throw DxvkError("State cache file: unexpected compacted parse result");
+
+    cout << "State cache benchmark: " << result.records.size() << " entries, "
+         << file.size() / 1024 << " KiB before and " << compactedFile.size() / 1024 << " KiB after compaction" << endl;
+    cout << "  parse: " << parseMs << " ms appended, " << compactedParseMs << " ms compacted, "
+         << "scalar SHA-1 validation alone: " << sha1Ms << " ms (" << sha1Count << " hashes)" << endl;
+
+    // Compaction drops the duplicates, leaving every record once plus the index
+    const size_t maxCompactedSize = kBodyOffset + sizeof(DxvkStateCacheIndexHeader)
+      + compacted.size() * sizeof(DxvkStateCacheIndexEntry) + recordBytes(indexed) + recordBytes(appended);
+
+    if (compacted.size() != kIndexedCount + kAppendedCount || compactedFile.size() > maxCompactedSize)
+      throw DxvkError(str::format("State cache file: compacted file is ", compactedFile.size(), " bytes, expected at most ", maxCompactedSize));
+
+    if (compactedParseMs >= parseMs)
+      throw DxvkError("State cache file: parsing the compacted file is not faster than the appended one");
+
+    // Note: The compacted file holds the same records the reference hashes
+    if (compactedParseMs >= sha1Ms)
+      throw DxvkError("State cache file: parsing with checksum validation is not faster than SHA-1 validation alone");
+  }
+};
+
+int main() {
+  try {
+    StateCacheFileTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
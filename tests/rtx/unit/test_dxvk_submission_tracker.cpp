@@ -0,0 +1,193 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_submission_tracker.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Fake GPU timeline: a wait lets the "GPU" run ahead by a configurable number of submissions
+  class FakeTimeline : public DxvkSubmissionTimeline {
+  public:
+    uint64_t getCompletedValue() override {
+      ++numQueries;
+
+      if (queryFails)
+        throw DxvkError("Fake timeline query failed");
+
+      return completedValue;
+    }
+
+    bool wait(uint64_t value) override {
+      ++numWaits;
+
+      if (deviceLost)
+        return false;
+
+      completedValue = std::min(std::max(completedValue, value + runAhead), lastSubmittedValue);
+      return true;
+    }
+
+    uint64_t completedValue = 0;
+    uint64_t lastSubmittedValue = 0;
+    uint64_t runAhead = 0;
+    bool deviceLost = false;
+    bool queryFails = false;
+    uint32_t numWaits = 0;
+    uint32_t numQueries = 0;
+  };
+
+  struct FakeCmdList {
+    uint32_t id;
+  };
+}
+
+class SubmissionTrackerTestApp {
+public:
+  static void run() {
+    testPartialRetirement();
+    testBatchedRetirement();
+    testDeviceLost();
+    testQueryFailure();
+  }
+
+private:
+  static void submit(FakeTimeline& timeline, DxvkSubmissionTracker<FakeCmdList>& tracker, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      const uint64_t value = ++timeline.lastSubmittedValue;
+      tracker.push(value, FakeCmdList { uint32_t(value) });
+    }
+  }
+
+  static void testPartialRetirement() {
+    FakeTimeline timeline;
+    DxvkSubmissionTracker<FakeCmdList> tracker(timeline);
+    std::vector<FakeCmdList> retired;
+
+    if (tracker.retireCompleted(retired) != 0 || tracker.oldestValue() != 0)
+      throw DxvkError("Empty submission tracker retired submissions");
+
+    submit(timeline, tracker, 10);
+
+    if (tracker.retireCompleted(retired) != 0)
+      throw DxvkError("Submissions were retired before the timeline advanced");
+
+    timeline.completedValue = 4;
+
+    if (tracker.retireCompleted(retired) != 4 || tracker.size() != 6 || tracker.oldestValue() != 5)
+      throw DxvkError("Submission tracker did not retire exactly the completed submissions");
+
+    for (uint32_t i = 0; i < retired.size(); i++) {
+      if (retired[i].id != i + 1)
+        throw DxvkError("Submissions were not retired in submission order");
+    }
+  }
+
+  static void testBatchedRetirement() {
+    FakeTimeline timeline;
+    timeline.runAhead = 7;
+
+    DxvkSubmissionTracker<FakeCmdList> tracker(timeline);
+    std::vector<FakeCmdList> retired;
+    uint32_t numRetired = 0;
+    uint32_t numBatches = 0;
+
+    submit(timeline, tracker, 64);
+
+    // Same loop as the queue's finish thread: one wait on the oldest value, then one batched retirement
+    while (!tracker.empty()) {
+      if (!timeline.wait(tracker.oldestValue()))
+        throw DxvkError("Fake timeline wait failed");
+
+      retired.clear();
+      const size_t count = tracker.retireCompleted(retired);
+
+      if (count == 0)
+        throw DxvkError("No submissions retired after waiting for the oldest one");
+
+      numRetired += uint32_t(count);
+      ++numBatches;
+    }
+
+    cout << "Retired " << numRetired << " submissions in " << numBatches << " batches with " << timeline.numWaits << " waits" << endl;
+
+    if (numRetired != 64 || numBatches != 8 || timeline.numWaits != 8)
+      throw DxvkError("Submissions were not retired in batches");
+  }
+
+  static void testDeviceLost() {
+    FakeTimeline timeline;
+    DxvkSubmissionTracker<FakeCmdList> tracker(timeline);
+    std::vector<FakeCmdList> retired;
+
+    submit(timeline, tracker, 5);
+    timeline.deviceLost = true;
+
+    if (timeline.wait(tracker.oldestValue()))
+      throw DxvkError("Fake timeline did not report device loss");
+
+    if (tracker.retireAll(retired) != 5 || !tracker.empty())
+      throw DxvkError("Submissions were not retired after device loss");
+  }
+
+  static void testQueryFailure() {
+    FakeTimeline timeline;
+    DxvkSubmissionTracker<FakeCmdList> tracker(timeline);
+    std::vector<FakeCmdList> retired;
+
+    submit(timeline, tracker, 5);
+    timeline.completedValue = 2;
+    timeline.queryFails = true;
+
+    bool threw = false;
+    try {
+      tracker.retireCompleted(retired);
+    } catch (const DxvkError&) {
+      threw = true;
+    }
+
+    if (!threw)
+      throw DxvkError("Timeline query failure was not propagated");
+
+    if (!retired.empty() || tracker.size() != 5)
+      throw DxvkError("Submissions were retired although the timeline query failed");
+
+    // Same as the queue's finish thread, which treats a failed query like a lost device
+    if (tracker.retireAll(retired) != 5 || !tracker.empty())
+      throw DxvkError("Submissions were not retired after a failed timeline query");
+  }
+};
+
+int main() {
+  try {
+    SubmissionTrackerTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,291 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_submit_budget.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  struct FakeCmdList {
+    std::vector<std::string> ops;
+    bool submitted = false;
+  };
+
+  enum class FakeCmdType {
+    Upload,  // Plain transfer recorded directly by the command
+    Draw,    // Queues a draw call snapshot, processed later like RtxContext does
+    Inject,  // Processes pending draw calls and traces rays
+  };
+
+  struct FakeCmd {
+    FakeCmdType type;
+    uint32_t    id;
+    uint64_t    bytes;
+  };
+
+  // Mirrors how DxvkContext and RtxContext record and split work: pending draw calls
+  // hold on to the command list they were started on while recording their copies and
+  // builds, and a flush converts all pending draw calls before submitting.
+  class FakeContext {
+  public:
+    // When set, the budget is acted upon as soon as work is recorded rather than between commands
+    bool flushWhenRecording = false;
+
+    explicit FakeContext(const DxvkSubmitBudgetLimits& limits) {
+      m_budget.setLimits(limits);
+      beginRecording();
+    }
+
+    void execute(const std::vector<FakeCmd>& stream) {
+      for (const FakeCmd& cmd : stream) {
+        switch (cmd.type) {
+        case FakeCmdType::Upload:
+          record(m_cmd, "upload" + std::to_string(cmd.id));
+          recordCopy(cmd.bytes);
+          break;
+        case FakeCmdType::Draw:
+          m_pendingDraws.push_back(cmd);
+          break;
+        case FakeCmdType::Inject:
+          processPendingDrawCalls();
+          record(m_cmd, "traceRays" + std::to_string(cmd.id));
+          m_budget.recordDispatch();
+          break;
+        }
+
+        if (!flushWhenRecording && m_budget.isExhausted())
+          flushCommandList();
+      }
+
+      flushCommandList();
+    }
+
+    std::vector<std::string> getSubmittedOps() const {
+      std::vector<std::string> result;
+
+      for (const auto& cmdList : m_submitted)
+        result.insert(result.end(), cmdList->ops.begin(), cmdList->ops.end());
+
+      return result;
+    }
+
+    size_t getSubmissionCount() const {
+      return m_submitted.size();
+    }
+
+    uint32_t getLostOpCount() const {
+      return m_lostOps;
+    }
+
+  private:
+    DxvkSubmitBudget                          m_budget;
+    std::shared_ptr<FakeCmdList>              m_cmd;
+    std::vector<std::shared_ptr<FakeCmdList>> m_submitted;
+    std::vector<FakeCmd>                      m_pendingDraws;
+    uint32_t                                  m_lostOps = 0;
+
+    void beginRecording() {
+      m_cmd = std::make_shared<FakeCmdList>();
+      m_budget.reset();
+    }
+
+    void flushCommandList() {
+      processPendingDrawCalls();
+
+      if (!m_cmd->ops.empty()) {
+        m_cmd->submitted = true;
+        m_submitted.push_back(m_cmd);
+      }
+
+      beginRecording();
+    }
+
+    void record(const std::shared_ptr<FakeCmdList>& cmdList, const std::string& op) {
+      // Anything recorded into a submitted command list never reaches the GPU
+      if (cmdList->submitted)
+        m_lostOps += 1;
+
+      cmdList->ops.push_back(op);
+    }
+
+    void recordCopy(uint64_t bytes) {
+      m_budget.recordCopy(bytes);
+
+      if (flushWhenRecording && m_budget.isExhausted())
+        flushCommandList();
+    }
+
+    void processPendingDrawCalls() {
+      std::vector<FakeCmd> draws = std::move(m_pendingDraws);
+      m_pendingDraws.clear();
+
+      for (const FakeCmd& draw : draws) {
+        // Like SceneManager::submitDrawState, keeps using the command list it was handed
+        std::shared_ptr<FakeCmdList> cmdList = m_cmd;
+
+        record(cmdList, "geometry" + std::to_string(draw.id));
+        recordCopy(draw.bytes);
+
+        record(cmdList, "blas" + std::to_string(draw.id));
+        m_budget.recordAccelStructBuilds(1);
+      }
+    }
+  };
+}
+
+class SubmitBudgetTestApp {
+public:
+  static void run() {
+    testLimits();
+    testReplay();
+    testSplitInsideOperation();
+  }
+
+private:
+  static std::vector<FakeCmd> makeStream() {
+    std::vector<FakeCmd> stream;
+    uint32_t id = 0;
+
+    for (uint32_t frame = 0; frame < 4; frame++) {
+      for (uint32_t i = 0; i < 8; i++)
+        stream.push_back({ FakeCmdType::Upload, id++, 3ull << 20 });
+
+      for (uint32_t i = 0; i < 24; i++)
+        stream.push_back({ FakeCmdType::Draw, id++, 1ull << 20 });
+
+      stream.push_back({ FakeCmdType::Inject, id++, 0 });
+    }
+
+    return stream;
+  }
+
+  static void testLimits() {
+    DxvkSubmitBudget budget;
+
+    budget.recordCopy(1ull << 30);
+    budget.recordAccelStructBuilds(1000);
+
+    for (uint32_t i = 0; i < 1000; i++)
+      budget.recordDispatch();
+
+    if (budget.isExhausted())
+      throw DxvkError("Budget without limits was exhausted");
+
+    DxvkSubmitBudgetLimits limits;
+    limits.accelStructBuilds = 4;
+    budget.setLimits(limits);
+
+    if (!budget.isExhausted())
+      throw DxvkError("Budget was not exhausted by work recorded before the limits were set");
+
+    budget.reset();
+    budget.recordAccelStructBuilds(3);
+
+    if (budget.isExhausted())
+      throw DxvkError("Budget was exhausted below the build limit");
+
+    budget.recordAccelStructBuilds(1);
+
+    if (!budget.isExhausted())
+      throw DxvkError("Budget was not exhausted at the build limit");
+
+    budget.reset();
+
+    if (budget.isExhausted() || budget.getRecordedWork().accelStructBuilds != 0)
+      throw DxvkError("Budget was not reset");
+
+    limits = DxvkSubmitBudgetLimits();
+    limits.copyBytes = 1000;
+    limits.dispatches = 2;
+    budget.setLimits(limits);
+
+    budget.recordCopy(999);
+    budget.recordDispatch();
+
+    if (budget.isExhausted())
+      throw DxvkError("Budget was exhausted below the copy and dispatch limits");
+
+    budget.recordDispatch();
+
+    if (!budget.isExhausted())
+      throw DxvkError("Budget was not exhausted at the dispatch limit");
+  }
+
+  static void testReplay() {
+    const std::vector<FakeCmd> stream = makeStream();
+
+    FakeContext reference { DxvkSubmitBudgetLimits() };
+    reference.execute(stream);
+
+    DxvkSubmitBudgetLimits limits;
+    limits.copyBytes = 16ull << 20;
+    limits.accelStructBuilds = 16;
+
+    FakeContext split { limits };
+    split.execute(stream);
+
+    cout << "Replayed " << stream.size() << " commands in " << reference.getSubmissionCount()
+         << " submissions without and " << split.getSubmissionCount() << " with splits" << endl;
+
+    if (split.getSubmissionCount() <= reference.getSubmissionCount())
+      throw DxvkError("Command stream was not split");
+
+    if (split.getLostOpCount() != 0 || reference.getLostOpCount() != 0)
+      throw DxvkError("Work was recorded into a submitted command list");
+
+    if (split.getSubmittedOps() != reference.getSubmittedOps())
+      throw DxvkError("Splitting the command stream changed the submitted work");
+  }
+
+  static void testSplitInsideOperation() {
+    // Splitting as soon as the budget runs out, i.e. in the middle of processing
+    // pending draw calls, loses work. This is what the budget must never do.
+    const std::vector<FakeCmd> stream = makeStream();
+
+    DxvkSubmitBudgetLimits limits;
+    limits.copyBytes = 16ull << 20;
+
+    FakeContext split { limits };
+    split.flushWhenRecording = true;
+    split.execute(stream);
+
+    if (split.getLostOpCount() == 0)
+      throw DxvkError("Splitting inside an operation did not lose work, the replay does not model it");
+  }
+};
+
+int main() {
+  try {
+    SubmitBudgetTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
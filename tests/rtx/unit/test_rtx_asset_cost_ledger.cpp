@@ -0,0 +1,264 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_asset_cost_ledger.h"
+
+using namespace dxvk;
+using namespace std;
+
+class AssetCostLedgerTestApp {
+public:
+  static void run() {
+    testFrameCosts();
+    testHistory();
+    testTopAssets();
+    testBounds();
+    testCsv();
+    benchmark();
+  }
+
+private:
+  static AssetCostLedger::Params makeParams(uint32_t maxEntries, uint32_t maxIdleFrames) {
+    AssetCostLedger::Params params;
+    params.maxEntries = maxEntries;
+    params.maxIdleFrames = maxIdleFrames;
+    return params;
+  }
+
+  static const AssetCostLedger::Row& findRow(const vector<AssetCostLedger::Row>& rows, XXH64_hash_t assetHash) {
+    for (const auto& row : rows) {
+      if (row.assetHash == assetHash)
+        return row;
+    }
+
+    throw DxvkError(str::format("Asset ", assetHash, " not found"));
+  }
+
+  static void testFrameCosts() {
+    AssetCostLedger ledger;
+    ledger.setParams(makeParams(16, 10));
+
+    // Costs only show up once the frame has ended
+    ledger.add(1, AssetCost::Instances, 1);
+    ledger.add(1, AssetCost::Instances, 1);
+    ledger.add(1, AssetCost::Triangles, 300);
+    ledger.add(2, AssetCost::TextureBytes, 4096);
+    ledger.add(3, AssetCost::Triangles, 0);
+
+    if (!ledger.getTopAssets(AssetCost::Instances, AssetCostPeriod::LastFrame, 10).empty())
+      throw DxvkError("Costs visible before the end of the frame");
+
+    ledger.endFrame();
+
+    if (ledger.getEntryCount() != 2)
+      throw DxvkError(str::format("Expected 2 assets, found ", ledger.getEntryCount()));
+
+    const auto rows = ledger.getTopAssets(AssetCost::Instances, AssetCostPeriod::LastFrame, 10);
+
+    if (rows.size() != 1 || rows[0].assetHash != 1 ||
+        rows[0].get(AssetCost::Instances, AssetCostPeriod::LastFrame) != 2.f ||
+        rows[0].get(AssetCost::Triangles, AssetCostPeriod::LastFrame) != 300.f)
+      throw DxvkError("Frame costs not accumulated");
+
+    // The next frame starts from zero
+    ledger.add(1, AssetCost::Instances, 1);
+    ledger.endFrame();
+
+    const auto nextRows = ledger.getTopAssets(AssetCost::Instances, AssetCostPeriod::LastFrame, 10);
+
+    if (nextRows.size() != 1 || nextRows[0].get(AssetCost::Instances, AssetCostPeriod::LastFrame) != 1.f)
+      throw DxvkError("Frame costs not reset at the end of the frame");
+  }
+
+  static void testHistory() {
+    AssetCostLedger ledger;
+    ledger.setParams(makeParams(16, 10));
+
+    // A spike in an otherwise steady cost
+    for (uint32_t frame = 0; frame < 400; frame++) {
+      ledger.add(1, AssetCost::BlasBuildTriangles, frame == 100 ? 100000 : 1000);
+      ledger.endFrame();
+    }
+
+    const auto& row = findRow(ledger.getTopAssets(AssetCost::BlasBuildTriangles, AssetCostPeriod::Peak, 10), 1);
+
+    if (row.get(AssetCost::BlasBuildTriangles, AssetCostPeriod::Peak) != 100000.f)
+      throw DxvkError("Peak not kept");
+
+    const float average = row.get(AssetCost::BlasBuildTriangles, AssetCostPeriod::Average);
+
+    if (std::abs(average - 1000.f) > 10.f)
+      throw DxvkError(str::format("Average ", average, " did not settle after the spike"));
+
+    // Assets not seen for longer than the idle limit are dropped
+    for (uint32_t frame = 0; frame < 10; frame++)
+      ledger.endFrame();
+
+    if (ledger.getEntryCount() != 1)
+      throw DxvkError("Asset dropped before the idle limit");
+
+    ledger.endFrame();
+
+    if (ledger.getEntryCount() != 0)
+      throw DxvkError("Idle asset not dropped");
+  }
+
+  static void testTopAssets() {
+    AssetCostLedger ledger;
+    ledger.setParams(makeParams(1024, 10));
+
+    for (XXH64_hash_t assetHash = 1; assetHash <= 100; assetHash++)
+      ledger.add(assetHash, AssetCost::Triangles, assetHash * 10);
+
+    // Same cost as asset 50, ties go to the lower hash
+    ledger.add(1000, AssetCost::Triangles, 500);
+    ledger.endFrame();
+
+    const auto rows = ledger.getTopAssets(AssetCost::Triangles, AssetCostPeriod::LastFrame, 52);
+
+    if (rows.size() != 52)
+      throw DxvkError(str::format("Expected 52 rows, found ", rows.size()));
+
+    for (size_t i = 0; i < 51; i++) {
+      if (rows[i].assetHash != 100 - i)
+        throw DxvkError(str::format("Row ", i, " holds asset ", rows[i].assetHash));
+    }
+
+    if (rows[51].assetHash != 1000)
+      throw DxvkError("Tie not broken by hash");
+
+    if (ledger.getTopAssets(AssetCost::Triangles, AssetCostPeriod::LastFrame, 1000).size() != 101)
+      throw DxvkError("Not all assets returned");
+
+    if (!ledger.getTopAssets(AssetCost::OpacityMicromapBytes, AssetCostPeriod::LastFrame, 10).empty())
+      throw DxvkError("Assets without a cost returned");
+  }
+
+  static void testBounds() {
+    AssetCostLedger ledger;
+    ledger.setParams(makeParams(8, 10));
+
+    for (XXH64_hash_t assetHash = 1; assetHash <= 100; assetHash++)
+      ledger.add(assetHash, AssetCost::Instances, 1);
+
+    ledger.endFrame();
+
+    // The assets over the limit are collected in the unattributed bucket, nothing is lost
+    if (ledger.getEntryCount() > 9)
+      throw DxvkError(str::format("Ledger grew to ", ledger.getEntryCount(), " entries"));
+
+    const auto rows = ledger.getTopAssets(AssetCost::Instances, AssetCostPeriod::LastFrame, 100);
+
+    float totalInstances = 0.f;
+    for (const auto& row : rows)
+      totalInstances += row.get(AssetCost::Instances, AssetCostPeriod::LastFrame);
+
+    if (totalInstances != 100.f)
+      throw DxvkError(str::format("Expected 100 instances, found ", totalInstances));
+
+    if (findRow(rows, AssetCostLedger::kUnattributedHash).get(AssetCost::Instances, AssetCostPeriod::LastFrame) != 92.f)
+      throw DxvkError("Overflowing assets not collected in the unattributed bucket");
+  }
+
+  static void testCsv() {
+    AssetCostLedger ledger;
+    ledger.setParams(makeParams(16, 10));
+
+    ledger.add(0xabc, AssetCost::BlasBytes, 65536);
+    ledger.add(0x1, AssetCost::Triangles, 12);
+    ledger.endFrame();
+
+    std::stringstream stream;
+    ledger.writeCsv(stream);
+
+    std::string header;
+    std::getline(stream, header);
+
+    if (header.rfind("AssetHash,InstancesLastFrame,InstancesAverage,InstancesPeak,TrianglesLastFrame", 0) != 0)
+      throw DxvkError(str::format("Unexpected header: ", header));
+
+    const size_t columnCount = std::count(header.begin(), header.end(), ',') + 1;
+
+    if (columnCount != 1 + AssetCostLedger::kCostCount * uint32_t(AssetCostPeriod::Count))
+      throw DxvkError(str::format("Unexpected column count ", columnCount));
+
+    // Rows in hash order
+    std::string first;
+    std::string second;
+    std::getline(stream, first);
+    std::getline(stream, second);
+
+    if (first.rfind("0x0000000000000001,0,0,0,12,", 0) != 0 || second.rfind("0x0000000000000abc,", 0) != 0)
+      throw DxvkError(str::format("Unexpected rows: ", first, " / ", second));
+
+    if (size_t(std::count(second.begin(), second.end(), ',') + 1) != columnCount)
+      throw DxvkError("Row does not match the header");
+  }
+
+  static void benchmark() {
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<XXH64_hash_t> assetHash(1, 5000);
+
+    AssetCostLedger ledger;
+    ledger.setParams(makeParams(4096, 600));
+
+    constexpr uint32_t kFrames = 100;
+    constexpr uint32_t kInstancesPerFrame = 20000;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t frame = 0; frame < kFrames; frame++) {
+      for (uint32_t i = 0; i < kInstancesPerFrame; i++) {
+        const XXH64_hash_t hash = assetHash(rng);
+        ledger.add(hash, AssetCost::Instances, 1);
+        ledger.add(hash, AssetCost::Triangles, 1000);
+      }
+
+      ledger.endFrame();
+    }
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    cout << "Attributed " << kInstancesPerFrame << " instances per frame in "
+         << std::chrono::duration<double, std::milli>(end - start).count() / kFrames << " ms per frame, "
+         << ledger.getEntryCount() << " assets tracked" << endl;
+  }
+};
+
+int main() {
+  try {
+    AssetCostLedgerTestApp::run();
+  } catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
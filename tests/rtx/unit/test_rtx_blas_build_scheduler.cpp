@@ -0,0 +1,308 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_blas_build_scheduler.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  struct PendingBuild {
+    BlasBuildScheduler::Candidate candidate;
+    uint32_t frameRequested;
+  };
+
+  struct BurstStats {
+    uint32_t frames = 0;
+    uint32_t maxFramesDeferred = 0;
+  };
+
+  // Feeds bursts of new builds to the scheduler until all of them are built, checking its guarantees every frame
+  BurstStats simulate(const vector<vector<BlasBuildScheduler::Candidate>>& burstsPerFrame, const BlasBuildScheduler::Params& params) {
+    vector<PendingBuild> pending;
+    BurstStats stats;
+
+    for (uint32_t frame = 0; frame < burstsPerFrame.size() || !pending.empty(); frame++) {
+      if (frame > 10000)
+        throw DxvkError("Builds never drained");
+
+      if (frame < burstsPerFrame.size()) {
+        for (const auto& candidate : burstsPerFrame[frame])
+          pending.push_back({ candidate, frame });
+      }
+
+      vector<BlasBuildScheduler::Candidate> candidates;
+      for (const auto& build : pending) {
+        candidates.push_back(build.candidate);
+        candidates.back().framesDeferred = frame - build.frameRequested;
+      }
+
+      const vector<bool> approved = BlasBuildScheduler::schedule(candidates, params);
+
+      if (approved.size() != candidates.size())
+        throw DxvkError("Approval count does not match the candidates");
+
+      uint64_t starvedPrimitives = 0;
+      uint64_t otherPrimitives = 0;
+      uint32_t otherApproved = 0;
+      float largestDeferred = -1.f;
+      float smallestApproved = -1.f;
+      bool anyApproved = false;
+
+      for (size_t i = 0; i < candidates.size(); i++) {
+        const bool isStarved = candidates[i].framesDeferred >= params.maxDeferredFrames;
+
+        if (isStarved && !approved[i])
+          throw DxvkError(str::format("Build deferred for ", candidates[i].framesDeferred, " frames was deferred again"));
+
+        if (approved[i]) {
+          anyApproved = true;
+          stats.maxFramesDeferred = std::max(stats.maxFramesDeferred, candidates[i].framesDeferred);
+
+          if (isStarved) {
+            starvedPrimitives += candidates[i].primitiveCount;
+          } else {
+            otherPrimitives += candidates[i].primitiveCount;
+            otherApproved++;
+
+            if (smallestApproved < 0.f || candidates[i].projectedSize < smallestApproved)
+              smallestApproved = candidates[i].projectedSize;
+          }
+        } else {
+          largestDeferred = std::max(largestDeferred, candidates[i].projectedSize);
+        }
+      }
+
+      if (!candidates.empty() && !anyApproved)
+        throw DxvkError(str::format("Frame ", frame, " made no progress"));
+
+      // The budget may only be exceeded by starved builds or by the single build of a frame
+      if (otherApproved > 0) {
+        const bool fitsBudget = starvedPrimitives + otherPrimitives <= params.maxPrimitivesPerFrame;
+        const bool isSingleOversizedBuild = starvedPrimitives == 0 && otherApproved == 1;
+
+        if (!fitsBudget && !isSingleOversizedBuild)
+          throw DxvkError(str::format("Frame ", frame, " built ", starvedPrimitives + otherPrimitives, " primitives over a budget of ", params.maxPrimitivesPerFrame));
+      }
+
+      // When nothing starved, the largest build on screen always goes first
+      if (starvedPrimitives == 0 && largestDeferred >= 0.f && otherApproved > 0) {
+        float largest = largestDeferred;
+        for (size_t i = 0; i < candidates.size(); i++)
+          largest = std::max(largest, candidates[i].projectedSize);
+
+        bool largestApproved = false;
+        for (size_t i = 0; i < candidates.size(); i++)
+          largestApproved |= approved[i] && candidates[i].projectedSize == largest;
+
+        if (!largestApproved)
+          throw DxvkError(str::format("Frame ", frame, " deferred the largest build on screen"));
+      }
+
+      vector<PendingBuild> stillPending;
+      for (size_t i = 0; i < pending.size(); i++) {
+        if (!approved[i])
+          stillPending.push_back(pending[i]);
+      }
+      pending.swap(stillPending);
+      stats.frames = frame + 1;
+    }
+
+    return stats;
+  }
+
+  vector<BlasBuildScheduler::Candidate> makeBurst(std::mt19937& rng, uint32_t count, uint32_t minPrimitives, uint32_t maxPrimitives) {
+    std::uniform_int_distribution<uint32_t> primitives(minPrimitives, maxPrimitives);
+    std::uniform_real_distribution<float> distance(1.f, 1000.f);
+    std::uniform_real_distribution<float> radius(0.1f, 50.f);
+
+    vector<BlasBuildScheduler::Candidate> burst(count);
+    for (auto& candidate : burst) {
+      candidate.primitiveCount = primitives(rng);
+      candidate.projectedSize = BlasBuildScheduler::getProjectedSize(radius(rng), distance(rng));
+    }
+    return burst;
+  }
+}
+
+class BlasBuildSchedulerTestApp {
+public:
+  static void run() {
+    testDisabledBudget();
+    testOrder();
+    testOversizedBuild();
+    testLevelLoadBurst();
+    testRepeatedBursts();
+    testProjectedSize();
+    benchmark();
+  }
+
+private:
+  static void testDisabledBudget() {
+    std::mt19937 rng(1);
+    const auto burst = makeBurst(rng, 100, 1000, 100000);
+
+    const vector<bool> approved = BlasBuildScheduler::schedule(burst, BlasBuildScheduler::Params {});
+
+    for (bool isApproved : approved) {
+      if (!isApproved)
+        throw DxvkError("Build deferred without a budget");
+    }
+  }
+
+  static void testOrder() {
+    BlasBuildScheduler::Params params;
+    params.maxPrimitivesPerFrame = 100;
+    params.maxDeferredFrames = 4;
+
+    // Largest on screen first, a smaller one that still fits after a large one did not is built too
+    const vector<BlasBuildScheduler::Candidate> candidates = {
+      { 60, 1.f, 0 },
+      { 60, 4.f, 0 },
+      { 30, 2.f, 0 },
+      { 20, 0.5f, 0 },
+    };
+
+    const vector<bool> approved = BlasBuildScheduler::schedule(candidates, params);
+    const vector<bool> expected = { false, true, true, false };
+
+    if (approved != expected)
+      throw DxvkError("Builds not approved in order of their size on screen");
+
+    // Equal sizes are broken by the time waited
+    const vector<BlasBuildScheduler::Candidate> ties = {
+      { 80, 1.f, 0 },
+      { 80, 1.f, 2 },
+    };
+
+    if (BlasBuildScheduler::schedule(ties, params) != vector<bool> { false, true })
+      throw DxvkError("Tie not broken by the time waited");
+
+    // Starved builds go first even over budget and push everything else back
+    const vector<BlasBuildScheduler::Candidate> starved = {
+      { 90, 10.f, 0 },
+      { 90, 0.1f, 4 },
+      { 10, 5.f, 0 },
+    };
+
+    if (BlasBuildScheduler::schedule(starved, params) != vector<bool> { false, true, true })
+      throw DxvkError("Starved build not approved first");
+  }
+
+  static void testOversizedBuild() {
+    BlasBuildScheduler::Params params;
+    params.maxPrimitivesPerFrame = 1000;
+    params.maxDeferredFrames = 100;
+
+    const vector<BlasBuildScheduler::Candidate> candidates = {
+      { 5000, 1.f, 0 },
+      { 4000, 0.5f, 0 },
+    };
+
+    if (BlasBuildScheduler::schedule(candidates, params) != vector<bool> { true, false })
+      throw DxvkError("Oversized build not approved alone");
+  }
+
+  // A level load: hundreds of meshes in one frame
+  static void testLevelLoadBurst() {
+    std::mt19937 rng(2);
+
+    BlasBuildScheduler::Params params;
+    params.maxPrimitivesPerFrame = 1000000;
+    params.maxDeferredFrames = 8;
+
+    const BurstStats stats = simulate({ makeBurst(rng, 400, 1000, 200000) }, params);
+
+    if (stats.maxFramesDeferred > params.maxDeferredFrames)
+      throw DxvkError(str::format("Build deferred for ", stats.maxFramesDeferred, " frames"));
+
+    if (stats.frames < 2)
+      throw DxvkError("Burst was not spread over several frames");
+  }
+
+  // Camera cuts every few frames, with some meshes larger than the budget
+  static void testRepeatedBursts() {
+    std::mt19937 rng(3);
+
+    BlasBuildScheduler::Params params;
+    params.maxPrimitivesPerFrame = 500000;
+    params.maxDeferredFrames = 4;
+
+    vector<vector<BlasBuildScheduler::Candidate>> bursts(60);
+    for (size_t frame = 0; frame < bursts.size(); frame += 5)
+      bursts[frame] = makeBurst(rng, 50, 1000, 800000);
+
+    const BurstStats stats = simulate(bursts, params);
+
+    if (stats.maxFramesDeferred > params.maxDeferredFrames)
+      throw DxvkError(str::format("Build deferred for ", stats.maxFramesDeferred, " frames"));
+  }
+
+  static void testProjectedSize() {
+    if (!(BlasBuildScheduler::getProjectedSize(1.f, 10.f) > BlasBuildScheduler::getProjectedSize(1.f, 100.f)))
+      throw DxvkError("Closer mesh not larger on screen");
+
+    if (!(BlasBuildScheduler::getProjectedSize(10.f, 100.f) > BlasBuildScheduler::getProjectedSize(1.f, 100.f)))
+      throw DxvkError("Larger mesh not larger on screen");
+
+    // Inside the bounding sphere
+    if (!(BlasBuildScheduler::getProjectedSize(10.f, 5.f) > BlasBuildScheduler::getProjectedSize(10.f, 20.f)))
+      throw DxvkError("Mesh around the camera not the largest on screen");
+  }
+
+  static void benchmark() {
+    std::mt19937 rng(4);
+    const auto burst = makeBurst(rng, 10000, 1000, 200000);
+
+    BlasBuildScheduler::Params params;
+    params.maxPrimitivesPerFrame = 1000000;
+    params.maxDeferredFrames = 8;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    const vector<bool> approved = BlasBuildScheduler::schedule(burst, params);
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    uint32_t approvedCount = 0;
+    for (bool isApproved : approved)
+      approvedCount += isApproved ? 1 : 0;
+
+    cout << "Scheduled " << burst.size() << " builds in " << std::chrono::duration<double, std::milli>(end - start).count()
+         << " ms, " << approvedCount << " approved" << endl;
+  }
+};
+
+int main() {
+  try {
+    BlasBuildSchedulerTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
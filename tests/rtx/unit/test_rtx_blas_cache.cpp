@@ -0,0 +1,239 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <filesystem>
+#include <fstream>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_blas_disk_cache.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Mock serializer: a blob is compatible if its first byte matches the "driver version"
+  class MockBlasSerializer : public BlasCacheSerializer {
+  public:
+    bool isCompatible(const std::vector<uint8_t>& serializedData) const override {
+      return !serializedData.empty() && serializedData[0] == driverVersion;
+    }
+
+    uint8_t driverVersion = 1;
+  };
+
+  std::vector<uint8_t> makeBlob(uint8_t driverVersion, size_t size, uint8_t seed) {
+    std::vector<uint8_t> data(size);
+
+    for (size_t i = 0; i < size; i++) {
+      data[i] = uint8_t(seed + i * 7);
+    }
+
+    data[0] = driverVersion;
+    return data;
+  }
+
+  BlasCacheKey makeKey(XXH64_hash_t geometryHash) {
+    BlasCacheKey key;
+    key.geometryHash = geometryHash;
+    key.deviceHash = 0x1234;
+    key.buildFlags = 0x4;
+    key.geometryFlags = 0x1;
+    key.vertexFormat = 106;
+    key.indexType = 0;
+    key.primitiveCount = 128;
+    key.vertexCount = 256;
+    return key;
+  }
+}
+
+class BlasCacheTestApp {
+public:
+  static void run() {
+    testKeying();
+    testRoundTrip();
+    testCorruption();
+    testIncompatibility();
+    testEviction();
+  }
+
+private:
+  static std::string makeDirectory(const char* name) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(path);
+    return path.string();
+  }
+
+  static void testKeying() {
+    const BlasCacheKey key = makeKey(1);
+
+    BlasCacheKey otherBuildFlags = key;
+    otherBuildFlags.buildFlags = 0x8;
+
+    BlasCacheKey otherDevice = key;
+    otherDevice.deviceHash = 0x4321;
+
+    if (key.hash() != makeKey(1).hash())
+      throw DxvkError("BLAS cache key hash is not deterministic");
+
+    if (key.hash() == makeKey(2).hash() || key.hash() == otherBuildFlags.hash() || key.hash() == otherDevice.hash())
+      throw DxvkError("BLAS cache key hash does not depend on all key fields");
+  }
+
+  static void testRoundTrip() {
+    const std::string directory = makeDirectory("rtx_blas_cache_roundtrip");
+    MockBlasSerializer serializer;
+
+    const std::vector<uint8_t> blob = makeBlob(serializer.driverVersion, 1000, 3);
+
+    {
+      BlasDiskCache cache(directory, 1 << 20, serializer);
+      std::vector<uint8_t> loaded;
+
+      if (cache.load(makeKey(1), loaded))
+        throw DxvkError("Empty BLAS cache reported a hit");
+
+      if (!cache.store(makeKey(1), blob))
+        throw DxvkError("Failed to store a BLAS in the cache");
+    }
+
+    // A new cache instance must pick up the entries from the previous session
+    BlasDiskCache cache(directory, 1 << 20, serializer);
+    std::vector<uint8_t> loaded;
+
+    if (!cache.contains(makeKey(1)) || !cache.load(makeKey(1), loaded) || loaded != blob)
+      throw DxvkError("BLAS cache entry did not survive a round trip through disk");
+
+    BlasCacheKey otherFlags = makeKey(1);
+    otherFlags.buildFlags = 0x8;
+
+    if (cache.load(otherFlags, loaded))
+      throw DxvkError("BLAS cache hit with different build flags");
+
+    std::filesystem::remove_all(directory);
+  }
+
+  static void testCorruption() {
+    const std::string directory = makeDirectory("rtx_blas_cache_corruption");
+    MockBlasSerializer serializer;
+    BlasDiskCache cache(directory, 1 << 20, serializer);
+
+    cache.store(makeKey(1), makeBlob(serializer.driverVersion, 1000, 5));
+    cache.store(makeKey(2), makeBlob(serializer.driverVersion, 1000, 9));
+
+    // Flip a byte in the payload of one entry and truncate the other
+    bool truncate = false;
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+      const auto size = std::filesystem::file_size(entry.path());
+
+      if (truncate) {
+        std::filesystem::resize_file(entry.path(), size - 10);
+      } else {
+        std::fstream file(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(size - 10);
+        file.put(char(0xAB));
+      }
+
+      truncate = true;
+    }
+
+    std::vector<uint8_t> loaded;
+
+    if (cache.load(makeKey(1), loaded) || cache.load(makeKey(2), loaded))
+      throw DxvkError("Corrupted BLAS cache entry was accepted");
+
+    if (cache.getEntryCount() != 0 || cache.getStatistics().invalidated != 2)
+      throw DxvkError("Corrupted BLAS cache entries were not evicted");
+
+    std::filesystem::remove_all(directory);
+  }
+
+  static void testIncompatibility() {
+    const std::string directory = makeDirectory("rtx_blas_cache_incompatible");
+    MockBlasSerializer serializer;
+    BlasDiskCache cache(directory, 1 << 20, serializer);
+
+    cache.store(makeKey(1), makeBlob(serializer.driverVersion, 1000, 5));
+
+    // Simulate a driver update, the entry must be rejected so the caller falls back to a build
+    serializer.driverVersion = 2;
+
+    std::vector<uint8_t> loaded;
+
+    if (cache.load(makeKey(1), loaded))
+      throw DxvkError("Incompatible BLAS cache entry was accepted");
+
+    if (cache.contains(makeKey(1)) || !loaded.empty())
+      throw DxvkError("Incompatible BLAS cache entry was not evicted");
+
+    // The rebuilt BLAS can then be stored again
+    if (!cache.store(makeKey(1), makeBlob(serializer.driverVersion, 1000, 5)) || !cache.load(makeKey(1), loaded))
+      throw DxvkError("Failed to replace an incompatible BLAS cache entry");
+
+    std::filesystem::remove_all(directory);
+  }
+
+  static void testEviction() {
+    const std::string directory = makeDirectory("rtx_blas_cache_eviction");
+    MockBlasSerializer serializer;
+
+    constexpr size_t kBlobSize = 1000;
+    // Room for three entries including their headers
+    BlasDiskCache cache(directory, 3 * (kBlobSize + 100), serializer);
+
+    std::vector<uint8_t> loaded;
+
+    cache.store(makeKey(1), makeBlob(serializer.driverVersion, kBlobSize, 1));
+    cache.store(makeKey(2), makeBlob(serializer.driverVersion, kBlobSize, 2));
+    cache.store(makeKey(3), makeBlob(serializer.driverVersion, kBlobSize, 3));
+
+    // Touch the oldest entry so that the second one becomes least recently used
+    cache.load(makeKey(1), loaded);
+
+    cache.store(makeKey(4), makeBlob(serializer.driverVersion, kBlobSize, 4));
+
+    cout << "BLAS cache entries: " << cache.getEntryCount() << ", size: " << cache.getSize() << " bytes, evicted: " << cache.getStatistics().evicted << endl;
+
+    if (cache.getSize() > 3 * (kBlobSize + 100))
+      throw DxvkError("BLAS cache exceeds its size budget");
+
+    if (!cache.contains(makeKey(1)) || cache.contains(makeKey(2)) || !cache.contains(makeKey(3)) || !cache.contains(makeKey(4)))
+      throw DxvkError("BLAS cache did not evict the least recently used entry");
+
+    // Entries larger than the whole budget are never stored
+    if (cache.store(makeKey(5), makeBlob(serializer.driverVersion, 4 * kBlobSize, 5)))
+      throw DxvkError("BLAS cache stored an entry exceeding its budget");
+
+    std::filesystem::remove_all(directory);
+  }
+};
+
+int main() {
+  try {
+    BlasCacheTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,219 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cmath>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_frame_budget.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Synthetic GPU cost model: a fixed scene cost plus a linear cost per setting step, with a
+  // deterministic bit of noise so the running average is exercised
+  struct CostModel {
+    float sceneCostMs;
+    std::vector<float> costPerStepMs;
+
+    float frameTimeMs(const std::vector<FrameBudgetGovernor::Setting>& settings, uint32_t frame) const {
+      float timeMs = sceneCostMs;
+
+      for (size_t i = 0; i < settings.size(); i++)
+        timeMs += costPerStepMs[i] * float(settings[i].value);
+
+      return timeMs * (1.f + 0.03f * std::sin(float(frame) * 0.7f));
+    }
+  };
+
+  std::vector<FrameBudgetGovernor::Setting> makeSettings() {
+    std::vector<FrameBudgetGovernor::Setting> settings = FrameBudgetGovernor::parseSettings(
+      "rtx.froxelMaxReservoirSamples:1, rtx.di.spatialSamples:1, rtx.pathMaxBounces:1");
+
+    const int32_t initialValues[] = { 6, 2, 4 };
+
+    for (size_t i = 0; i < settings.size(); i++)
+      settings[i].maxValue = settings[i].value = initialValues[i];
+
+    return settings;
+  }
+}
+
+class FrameBudgetTestApp {
+public:
+  static void run() {
+    testParse();
+    testPriorityOrder();
+    testTrace();
+    testNoOscillation();
+  }
+
+private:
+  static uint32_t simulate(FrameBudgetGovernor& governor, const CostModel& model, const FrameBudgetGovernor::Params& params, uint32_t numFrames, uint32_t firstFrame = 0) {
+    uint32_t numChanges = 0;
+
+    for (uint32_t frame = firstFrame; frame < firstFrame + numFrames; frame++) {
+      if (governor.update(model.frameTimeMs(governor.getSettings(), frame), params) >= 0)
+        numChanges++;
+    }
+
+    return numChanges;
+  }
+
+  static void testParse() {
+    const auto settings = FrameBudgetGovernor::parseSettings(" rtx.a:2,rtx.b , ,rtx.c:x, rtx.d:-1 ");
+
+    if (settings.size() != 3 ||
+        settings[0].name != "rtx.a" || settings[0].minValue != 2 ||
+        settings[1].name != "rtx.b" || settings[1].minValue != 0 ||
+        settings[2].name != "rtx.d" || settings[2].minValue != -1)
+      throw DxvkError("Setting list was not parsed as expected");
+  }
+
+  static void testPriorityOrder() {
+    FrameBudgetGovernor governor;
+    governor.setSettings(makeSettings());
+
+    FrameBudgetGovernor::Params params;
+    params.targetFrameTimeMs = 10.f;
+    params.settleFrames = 5;
+
+    // Hopelessly over budget: everything goes down to its minimum, in priority order
+    CostModel heavy { 50.f, { 1.f, 1.f, 1.f } };
+    std::vector<int32_t> order;
+
+    for (uint32_t frame = 0; frame < 2000; frame++) {
+      const int32_t changed = governor.update(heavy.frameTimeMs(governor.getSettings(), frame), params);
+
+      if (changed >= 0)
+        order.push_back(changed);
+    }
+
+    const std::vector<int32_t> expectedOrder = { 0, 0, 0, 0, 0, 1, 2, 2, 2 };
+
+    if (order != expectedOrder)
+      throw DxvkError("Settings were not lowered in priority order");
+
+    // Back under budget: everything is restored in the reverse order, but never beyond the original value
+    CostModel light { 1.f, { 0.1f, 0.1f, 0.1f } };
+    order.clear();
+
+    for (uint32_t frame = 0; frame < 2000; frame++) {
+      const int32_t changed = governor.update(light.frameTimeMs(governor.getSettings(), frame), params);
+
+      if (changed >= 0)
+        order.push_back(changed);
+    }
+
+    const std::vector<int32_t> expectedRestore = { 2, 2, 2, 1, 0, 0, 0, 0, 0 };
+
+    if (order != expectedRestore)
+      throw DxvkError("Settings were not restored in reverse priority order");
+
+    const auto expected = makeSettings();
+
+    for (size_t i = 0; i < expected.size(); i++) {
+      if (governor.getSettings()[i].value != expected[i].maxValue)
+        throw DxvkError("Settings were not restored to their original values");
+    }
+  }
+
+  static void testTrace() {
+    // Frame time trace: a light area, a dense area and back
+    FrameBudgetGovernor governor;
+    governor.setSettings(makeSettings());
+
+    FrameBudgetGovernor::Params params;
+    params.targetFrameTimeMs = 16.f;
+
+    const CostModel light { 4.f, { 0.5f, 1.f, 1.5f } };
+    const CostModel dense { 9.f, { 0.5f, 1.f, 1.5f } };
+
+    simulate(governor, light, params, 600, 0);
+
+    const float lightTimeMs = light.frameTimeMs(governor.getSettings(), 0);
+
+    if (lightTimeMs > params.targetFrameTimeMs * (1.f + params.hysteresis))
+      throw DxvkError("Light area went over budget");
+
+    simulate(governor, dense, params, 3000, 600);
+
+    const float denseTimeMs = dense.frameTimeMs(governor.getSettings(), 0);
+
+    cout << "Dense area settled at " << denseTimeMs << " ms with settings";
+    for (const auto& setting : governor.getSettings())
+      cout << " " << setting.name << "=" << setting.value;
+    cout << endl;
+
+    if (denseTimeMs > params.targetFrameTimeMs * (1.f + params.hysteresis))
+      throw DxvkError("Dense area was not brought back into the budget");
+
+    if (governor.getSettings()[2].value == governor.getSettings()[2].minValue)
+      throw DxvkError("Lowest priority setting was lowered further than necessary");
+
+    simulate(governor, light, params, 6000, 3600);
+
+    const auto expected = makeSettings();
+
+    for (size_t i = 0; i < expected.size(); i++) {
+      if (governor.getSettings()[i].value != expected[i].maxValue)
+        throw DxvkError("Settings were not restored after leaving the dense area");
+    }
+  }
+
+  static void testNoOscillation() {
+    // A single step costs more than the hysteresis band (12 ms at 4 bounces is over, 10 ms at 3 is
+    // under it), so the governor must not keep toggling it
+    FrameBudgetGovernor governor;
+    governor.setSettings(FrameBudgetGovernor::parseSettings("rtx.pathMaxBounces:1"));
+    governor.overrideValue(0, 4);
+
+    FrameBudgetGovernor::Params params;
+    params.targetFrameTimeMs = 11.f;
+    params.hysteresis = 0.05f;
+    params.settleFrames = 10;
+
+    const CostModel model { 4.f, { 2.f } };
+
+    const uint32_t numChanges = simulate(governor, model, params, 20000);
+
+    cout << "Expensive steps changed settings " << numChanges << " times in 20000 frames" << endl;
+
+    if (numChanges > 30)
+      throw DxvkError("Governor oscillated on a step larger than the hysteresis band");
+
+    if (governor.getSettings()[0].value > 3)
+      throw DxvkError("Governor left the budget exceeded");
+  }
+};
+
+int main() {
+  try {
+    FrameBudgetTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,381 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../../test_utils.h"
+
+// Borrowed from the vulkan_core.h file:
+#define VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST  3
+#define VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP 4
+#define VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN   5
+
+#include "../../../src/dxvk/shaders/rtx/pass/interleave_geometry_indices.h"
+#include "../../../src/dxvk/shaders/rtx/pass/interleave_geometry.h"
+#include "../../../src/dxvk/shaders/rtx/pass/gen_tri_list_index_buffer_indices.h"
+#include "../../../src/dxvk/shaders/rtx/pass/gen_tri_list_index_buffer.h"
+#include "../../../src/dxvk/rtx_render/rtx_geometry_batch.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Source buffers are identified by their index into a list of byte vectors
+  using Layout = GeometryBatchLayout<uint32_t>;
+
+  struct Attribute {
+    uint32_t buffer;
+    uint32_t offset;  // Byte offset of the first element
+    uint32_t stride;  // Byte stride
+  };
+
+  struct Mesh {
+    uint32_t vertexCount;
+    Attribute position;
+    bool hasNormals;
+    Attribute normal;
+    bool hasTexcoord;
+    Attribute texcoord;
+    bool hasColor0;
+    Attribute color0;
+    bool compactNormals;
+    bool compactTexcoords;
+  };
+
+  std::vector<uint8_t> makeBuffer(size_t size, uint32_t seed) {
+    std::vector<uint8_t> data(size);
+    uint32_t state = seed;
+
+    // Floats in [-2, 2), so compact encodings see regular values
+    for (size_t i = 0; i + 4 <= size; i += 4) {
+      state = state * 1664525u + 1013904223u;
+      const float value = float(state >> 8) / float(1 << 24) * 4.0f - 2.0f;
+      memcpy(&data[i], &value, sizeof(value));
+    }
+
+    return data;
+  }
+
+  uint32_t outputStride(const Mesh& mesh) {
+    uint32_t stride = 3;
+    if (mesh.hasNormals) stride += mesh.compactNormals ? 1 : 3;
+    if (mesh.hasTexcoord) stride += mesh.compactTexcoords ? 1 : 2;
+    if (mesh.hasColor0) stride += 1;
+    return stride;
+  }
+
+  InterleaveGeometryArgs makeArgs(const Mesh& mesh) {
+    InterleaveGeometryArgs args = {};
+    args.positionOffset = mesh.position.offset / 4;
+    args.positionStride = mesh.position.stride / 4;
+    args.hasNormals = mesh.hasNormals;
+    args.normalOffset = mesh.normal.offset / 4;
+    args.normalStride = mesh.normal.stride / 4;
+    args.hasTexcoord = mesh.hasTexcoord;
+    args.texcoordOffset = mesh.texcoord.offset / 4;
+    args.texcoordStride = mesh.texcoord.stride / 4;
+    args.hasColor0 = mesh.hasColor0;
+    args.color0Offset = mesh.color0.offset / 4;
+    args.color0Stride = mesh.color0.stride / 4;
+    args.outputStride = outputStride(mesh);
+    args.vertexCount = mesh.vertexCount;
+    args.compactNormals = mesh.compactNormals;
+    args.compactTexcoords = mesh.compactTexcoords;
+    return args;
+  }
+
+  const float* asFloats(const std::vector<uint8_t>& buffer) {
+    return reinterpret_cast<const float*>(buffer.data());
+  }
+
+  const uint32_t* asUints(const std::vector<uint8_t>& buffer) {
+    return reinterpret_cast<const uint32_t*>(buffer.data());
+  }
+
+  // Executes the input copies of a layout the way the batch flush records them
+  std::vector<uint8_t> buildInputArena(const Layout& layout, const std::vector<std::vector<uint8_t>>& buffers) {
+    std::vector<uint8_t> arena(layout.getInputSize() + Layout::kArenaAlignment);
+
+    for (const Layout::Copy& copy : layout.getCopies()) {
+      if (copy.arenaOffset % Layout::kArenaAlignment != 0) {
+        throw DxvkError("Misaligned input arena copy");
+      }
+
+      memcpy(&arena[copy.arenaOffset], &buffers[copy.resource][copy.resourceOffset], copy.size);
+    }
+
+    return arena;
+  }
+}
+
+class GeometryBatchTestApp {
+public:
+  static void run() {
+    testInputMerging();
+    testThreadPartitioning();
+    testInterleaveMatchesPerDraw();
+    testTriangleListMatchesPerDraw();
+  }
+
+private:
+  static void testInputMerging() {
+    cout << "Begin test: input merging" << endl;
+
+    Layout layout;
+    std::vector<uint64_t> offsets;
+
+    // Interleaved position and normal of a single vertex buffer, texcoords in a second buffer
+    layout.addInputs({ { 0, 64, 1000 }, { 0, 76, 1000 }, { 1, 8, 200 } }, offsets);
+
+    if (layout.getCopies().size() != 2) {
+      throw DxvkError(str::format("Expected 2 copies, got ", layout.getCopies().size()));
+    }
+
+    if (offsets[0] != 0 || offsets[1] != 12 || layout.getCopies()[0].size != 1012) {
+      throw DxvkError("Interleaved attributes were not merged into one copy");
+    }
+
+    if (offsets[2] % Layout::kArenaAlignment != 0 || offsets[2] < 1012) {
+      throw DxvkError("Second buffer overlaps the first copy");
+    }
+
+    // Disjoint ranges of the same buffer are copied separately, ranges merged transitively
+    layout.clear();
+    layout.addInputs({ { 0, 0, 16 }, { 0, 4096, 16 } }, offsets);
+
+    if (layout.getCopies().size() != 2 || layout.getInputSize() > 64) {
+      throw DxvkError("Disjoint ranges of a buffer must not be merged");
+    }
+
+    layout.clear();
+    layout.addInputs({ { 0, 0, 16 }, { 0, 32, 16 }, { 0, 16, 16 } }, offsets);
+
+    if (layout.getCopies().size() != 1 || offsets[1] != 32 || offsets[2] != 16) {
+      throw DxvkError("Chained ranges were not merged into one copy");
+    }
+  }
+
+  static void testThreadPartitioning() {
+    cout << "Begin test: thread partitioning" << endl;
+
+    const uint32_t counts[] = { 1, 300, 128, 1, 4097, 2 };
+
+    Layout layout;
+    std::vector<InterleaveGeometryJob> jobs;
+
+    for (uint32_t count : counts) {
+      InterleaveGeometryJob job = {};
+      job.firstThread = layout.addThreads(count);
+      jobs.push_back(job);
+    }
+
+    uint32_t expectedJob = 0;
+    uint32_t jobEnd = counts[0];
+
+    for (uint32_t thread = 0; thread < layout.getThreadCount(); thread++) {
+      while (thread >= jobEnd)
+        jobEnd += counts[++expectedJob];
+
+      const uint32_t jobIdx = findInterleaveGeometryJob(jobs.data(), uint32_t(jobs.size()), thread);
+
+      if (jobIdx != expectedJob) {
+        throw DxvkError(str::format("Thread ", thread, " assigned to job ", jobIdx, ", expected ", expectedJob));
+      }
+    }
+  }
+
+  static void testInterleaveMatchesPerDraw() {
+    cout << "Begin test: batched interleave matches per draw" << endl;
+
+    std::vector<std::vector<uint8_t>> buffers;
+    buffers.push_back(makeBuffer(64 * 1024, 1)); // Interleaved vertex buffer
+    buffers.push_back(makeBuffer(16 * 1024, 2)); // Separate positions
+    buffers.push_back(makeBuffer(16 * 1024, 3)); // Separate texcoords and colors
+
+    const Mesh meshes[] = {
+      // Interleaved position/normal/texcoord/color, 48 byte stride, at an offset into a shared buffer
+      { 300, { 0, 1024, 48 }, true, { 0, 1036, 48 }, true, { 0, 1048, 48 }, true, { 0, 1056, 48 }, false, false },
+      // Same layout compacted
+      { 200, { 0, 20480, 48 }, true, { 0, 20492, 48 }, true, { 0, 20504, 48 }, false, { }, true, true },
+      // Separate streams, positions only partially covering the buffer
+      { 1000, { 1, 16, 12 }, false, { }, true, { 2, 0, 8 }, true, { 2, 8192, 4 }, false, false },
+      // Single vertex
+      { 1, { 1, 13000, 12 }, false, { }, false, { }, false, { }, false, false },
+    };
+
+    Layout layout;
+    std::vector<InterleaveGeometryJob> jobs;
+    std::vector<std::vector<float>> expected;
+
+    for (const Mesh& mesh : meshes) {
+      const InterleaveGeometryArgs args = makeArgs(mesh);
+
+      // Per draw: one dispatch over the original buffers
+      std::vector<float> perDraw(args.outputStride * mesh.vertexCount);
+
+      for (uint32_t i = 0; i < mesh.vertexCount; i++) {
+        interleave(i, perDraw.data(), asFloats(buffers[mesh.position.buffer]), asFloats(buffers[mesh.normal.buffer]),
+                   asFloats(buffers[mesh.texcoord.buffer]), asUints(buffers[mesh.color0.buffer]), args);
+      }
+
+      expected.push_back(std::move(perDraw));
+
+      // Batched: inputs packed into the arena the way RtxGeometryUtils::batchInterleaveGeometry does
+      std::vector<Layout::Stream> streams;
+      std::vector<uint32_t*> streamOffsets;
+
+      InterleaveGeometryJob job = {};
+      job.args = args;
+
+      auto addStream = [&](const Attribute& attribute, uint32_t elementSize, uint32_t& offset) {
+        streams.push_back({ attribute.buffer, attribute.offset, (mesh.vertexCount - 1) * attribute.stride + elementSize });
+        streamOffsets.push_back(&offset);
+      };
+
+      addStream(mesh.position, 12, job.args.positionOffset);
+      if (mesh.hasNormals) addStream(mesh.normal, 12, job.args.normalOffset);
+      if (mesh.hasTexcoord) addStream(mesh.texcoord, 8, job.args.texcoordOffset);
+      if (mesh.hasColor0) addStream(mesh.color0, 4, job.args.color0Offset);
+
+      std::vector<uint64_t> arenaOffsets;
+      layout.addInputs(streams, arenaOffsets);
+
+      for (size_t i = 0; i < streams.size(); i++)
+        *streamOffsets[i] = uint32_t(arenaOffsets[i] / 4);
+
+      job.args.outputOffset = uint32_t(layout.addOutput(args.outputStride * mesh.vertexCount * 4) / 4);
+      job.firstThread = layout.addThreads(mesh.vertexCount);
+      jobs.push_back(job);
+    }
+
+    // One dispatch over every job
+    const std::vector<uint8_t> inputArena = buildInputArena(layout, buffers);
+    std::vector<float> outputArena(layout.getOutputSize() / 4);
+
+    for (uint32_t thread = 0; thread < layout.getThreadCount(); thread++) {
+      const InterleaveGeometryJob& job = jobs[findInterleaveGeometryJob(jobs.data(), uint32_t(jobs.size()), thread)];
+      interleave(thread - job.firstThread, outputArena.data(), asFloats(inputArena), asFloats(inputArena), asFloats(inputArena), asUints(inputArena), job.args);
+    }
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+      if (memcmp(&outputArena[jobs[i].args.outputOffset], expected[i].data(), expected[i].size() * sizeof(float)) != 0) {
+        throw DxvkError(str::format("Batched interleave output of mesh ", i, " differs from the per draw output"));
+      }
+    }
+  }
+
+  static void testTriangleListMatchesPerDraw() {
+    cout << "Begin test: batched triangle lists match per draw" << endl;
+
+    std::vector<std::vector<uint8_t>> buffers(1);
+    std::vector<uint16_t> indices(4096);
+
+    for (uint32_t i = 0; i < indices.size(); i++)
+      indices[i] = uint16_t((i * 7919u) % 600);
+
+    // Degenerate and out of range indices
+    indices[10] = indices[11];
+    indices[20] = 0xFFFF;
+
+    buffers[0].resize(indices.size() * sizeof(uint16_t));
+    memcpy(buffers[0].data(), indices.data(), buffers[0].size());
+
+    struct Draw {
+      uint32_t topology;
+      uint32_t primCount;
+      bool useIndexBuffer;
+      uint32_t indexByteOffset;
+    };
+
+    const Draw draws[] = {
+      { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP, 700, true, 0 },
+      { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN, 513, true, 2048 },
+      { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP, 999, false, 0 },
+      { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 600, true, 2 },
+      { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN, 1, false, 0 },
+    };
+
+    Layout layout;
+    std::vector<GenTriListJob> jobs;
+    std::vector<std::vector<uint16_t>> expected;
+
+    for (const Draw& draw : draws) {
+      GenTriListArgs args = {};
+      args.topology = draw.topology;
+      args.primCount = draw.primCount;
+      args.useIndexBuffer = draw.useIndexBuffer ? 1 : 0;
+      args.maxVertex = 599;
+
+      // Per draw: the index buffer is bound at the draw's offset
+      const uint16_t* src = reinterpret_cast<const uint16_t*>(&buffers[0][draw.indexByteOffset]);
+      std::vector<uint16_t> perDraw(draw.primCount * 3);
+
+      for (uint32_t i = 0; i < draw.primCount; i++)
+        generateIndices(i, perDraw.data(), draw.useIndexBuffer ? src : nullptr, args);
+
+      expected.push_back(std::move(perDraw));
+
+      // Batched, as RtxGeometryUtils::batchGenTriList does
+      GenTriListJob job = {};
+      job.args = args;
+
+      if (draw.useIndexBuffer) {
+        const uint32_t indexReadCount = (draw.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) ? draw.primCount * 3 : draw.primCount + 2;
+
+        std::vector<uint64_t> arenaOffsets;
+        layout.addInputs({ { 0, draw.indexByteOffset, indexReadCount * sizeof(uint16_t) } }, arenaOffsets);
+        job.args.firstIndex = uint32_t(arenaOffsets[0] / sizeof(uint16_t));
+      }
+
+      job.args.outputOffset = uint32_t(layout.addOutput(draw.primCount * 3 * sizeof(uint16_t)) / sizeof(uint16_t));
+      job.firstThread = layout.addThreads(draw.primCount);
+      jobs.push_back(job);
+    }
+
+    const std::vector<uint8_t> inputArena = buildInputArena(layout, buffers);
+    std::vector<uint16_t> outputArena(layout.getOutputSize() / sizeof(uint16_t));
+
+    for (uint32_t thread = 0; thread < layout.getThreadCount(); thread++) {
+      const GenTriListJob& job = jobs[findGenTriListJob(jobs.data(), uint32_t(jobs.size()), thread)];
+      generateIndices(thread - job.firstThread, outputArena.data(), reinterpret_cast<const uint16_t*>(inputArena.data()), job.args);
+    }
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+      if (memcmp(&outputArena[jobs[i].args.outputOffset], expected[i].data(), expected[i].size() * sizeof(uint16_t)) != 0) {
+        throw DxvkError(str::format("Batched triangle list of draw ", i, " differs from the per draw output"));
+      }
+    }
+  }
+};
+
+int main() {
+  try {
+    GeometryBatchTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,240 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <tuple>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_mesh_reorder.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  struct Vertex {
+    float position[3];
+    float texcoord[2];
+  };
+
+  struct Mesh {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+
+    MeshLocalityMetrics measure() const {
+      return measureMeshLocality(vertices[0].position, sizeof(Vertex), uint32_t(vertices.size()), indices);
+    }
+  };
+
+  // Wavy grid of n x n quads, the height keeps it from being degenerate along an axis
+  Mesh makeGrid(uint32_t n) {
+    Mesh mesh;
+
+    for (uint32_t y = 0; y <= n; y++) {
+      for (uint32_t x = 0; x <= n; x++) {
+        const float u = float(x) / n;
+        const float v = float(y) / n;
+        mesh.vertices.push_back({ { u, v, 0.1f * std::sin(u * 10.f) * std::cos(v * 7.f) }, { u, v } });
+      }
+    }
+
+    for (uint32_t y = 0; y < n; y++) {
+      for (uint32_t x = 0; x < n; x++) {
+        const uint32_t i = y * (n + 1) + x;
+        mesh.indices.insert(mesh.indices.end(), { i, i + 1, i + n + 2, i, i + n + 2, i + n + 1 });
+      }
+    }
+
+    return mesh;
+  }
+
+  // Shuffles triangles and vertices, like topology exported without regard for locality
+  Mesh scramble(const Mesh& mesh, uint32_t seed) {
+    std::mt19937 rng(seed);
+
+    std::vector<uint32_t> vertexOrder(mesh.vertices.size());
+    std::iota(vertexOrder.begin(), vertexOrder.end(), 0u);
+    std::shuffle(vertexOrder.begin(), vertexOrder.end(), rng);
+
+    std::vector<uint32_t> triangleOrder(mesh.indices.size() / 3);
+    std::iota(triangleOrder.begin(), triangleOrder.end(), 0u);
+    std::shuffle(triangleOrder.begin(), triangleOrder.end(), rng);
+
+    Mesh scrambled;
+    std::vector<uint32_t> newVertex(mesh.vertices.size());
+
+    for (uint32_t i = 0; i < vertexOrder.size(); i++) {
+      scrambled.vertices.push_back(mesh.vertices[vertexOrder[i]]);
+      newVertex[vertexOrder[i]] = i;
+    }
+
+    for (uint32_t t : triangleOrder) {
+      for (uint32_t k = 0; k < 3; k++) {
+        scrambled.indices.push_back(newVertex[mesh.indices[t * 3 + k]]);
+      }
+    }
+
+    return scrambled;
+  }
+
+  // Applies the load time optimization the way the USD loader does
+  Mesh optimize(const Mesh& mesh) {
+    Mesh optimized;
+    optimized.indices = mesh.indices;
+
+    reorderTrianglesSpatially(mesh.vertices[0].position, sizeof(Vertex), optimized.indices);
+    const std::vector<uint32_t> vertexOrder = reorderVerticesForFetch(optimized.indices, uint32_t(mesh.vertices.size()));
+
+    for (uint32_t vertex : vertexOrder) {
+      optimized.vertices.push_back(mesh.vertices[vertex]);
+    }
+
+    return optimized;
+  }
+
+  // Triangles as the sorted list of the data of their vertices, in their original winding
+  std::vector<std::array<std::tuple<float, float, float, float, float>, 3>> getTriangles(const Mesh& mesh) {
+    std::vector<std::array<std::tuple<float, float, float, float, float>, 3>> triangles;
+
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+      std::array<std::tuple<float, float, float, float, float>, 3> triangle;
+
+      for (uint32_t k = 0; k < 3; k++) {
+        const Vertex& v = mesh.vertices[mesh.indices[i + k]];
+        triangle[k] = std::make_tuple(v.position[0], v.position[1], v.position[2], v.texcoord[0], v.texcoord[1]);
+      }
+
+      triangles.push_back(triangle);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+  }
+}
+
+class MeshReorderTestApp {
+public:
+  static void run() {
+    testGeometryPreserved();
+    testUnreferencedVertices();
+    testDegenerateInput();
+    testLocality();
+  }
+
+private:
+  static void testGeometryPreserved() {
+    const Mesh scrambled = scramble(makeGrid(64), 1);
+    const Mesh optimized = optimize(scrambled);
+
+    if (optimized.vertices.size() != scrambled.vertices.size() || optimized.indices.size() != scrambled.indices.size())
+      throw DxvkError("Reorder: vertex or index count changed");
+
+    for (uint32_t index : optimized.indices) {
+      if (index >= optimized.vertices.size())
+        throw DxvkError("Reorder: index out of range");
+    }
+
+    // Every triangle must still be there with the same vertex data and winding
+    if (getTriangles(optimized) != getTriangles(scrambled))
+      throw DxvkError("Reorder: the reordered mesh is not geometrically identical");
+
+    // Vertices are numbered in order of first use
+    uint32_t nextVertex = 0;
+
+    for (uint32_t index : optimized.indices) {
+      if (index > nextVertex)
+        throw DxvkError("Reorder: vertex referenced before all lower numbered vertices");
+
+      nextVertex = std::max(nextVertex, index + 1);
+    }
+  }
+
+  static void testUnreferencedVertices() {
+    Mesh mesh = makeGrid(4);
+    // The last row of vertices is not used by any triangle
+    mesh.indices.resize(mesh.indices.size() - 4 * 6);
+
+    const Mesh optimized = optimize(mesh);
+
+    if (optimized.vertices.size() != mesh.vertices.size())
+      throw DxvkError("Reorder: unreferenced vertices were dropped");
+
+    if (getTriangles(optimized) != getTriangles(mesh))
+      throw DxvkError("Reorder: geometry changed with unreferenced vertices");
+
+    for (uint32_t index : optimized.indices) {
+      if (index >= 4 * 5)
+        throw DxvkError("Reorder: unreferenced vertices were not moved to the end");
+    }
+  }
+
+  static void testDegenerateInput() {
+    // All triangles at one point, the Morton codes are all equal and the order must stay stable
+    Mesh mesh;
+    mesh.vertices.assign(3, Vertex { { 1.f, 1.f, 1.f }, { 0.f, 0.f } });
+    mesh.indices = { 0, 1, 2, 2, 1, 0, 1, 2, 0 };
+
+    std::vector<uint32_t> indices = mesh.indices;
+    reorderTrianglesSpatially(mesh.vertices[0].position, sizeof(Vertex), indices);
+
+    if (indices != mesh.indices)
+      throw DxvkError("Reorder: triangles at the same position were not kept in order");
+  }
+
+  static void testLocality() {
+    for (uint32_t n : { 64u, 256u }) {
+      const Mesh scrambled = scramble(makeGrid(n), n);
+      const Mesh optimized = optimize(scrambled);
+
+      const MeshLocalityMetrics before = scrambled.measure();
+      const MeshLocalityMetrics after = optimized.measure();
+
+      cout << "Grid with " << scrambled.indices.size() / 3 << " triangles: ACMR " << before.acmr << " -> " << after.acmr
+           << ", average index delta " << before.averageIndexDelta << " -> " << after.averageIndexDelta
+           << ", average triangle distance " << before.averageTriangleDistance << " -> " << after.averageTriangleDistance << endl;
+
+      // A scrambled mesh fetches close to 3 vertices per triangle, a coherent one close to 1
+      if (after.acmr > 1.2f || before.acmr < 2.5f)
+        throw DxvkError(str::format("Reorder: unexpected ACMR ", before.acmr, " -> ", after.acmr));
+
+      if (after.averageTriangleDistance > before.averageTriangleDistance * 0.1f)
+        throw DxvkError("Reorder: triangles are not spatially coherent");
+
+      if (after.averageIndexDelta > before.averageIndexDelta * 0.1f)
+        throw DxvkError("Reorder: vertex fetches are not coherent");
+    }
+  }
+};
+
+int main() {
+  try {
+    MeshReorderTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,498 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <map>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_mesh_simplifier.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  constexpr float kPi = 3.141592653589793f;
+
+  struct Vertex {
+    Vector3 position;
+    Vector3 normal;
+    Vector2 texcoord;
+  };
+
+  struct Mesh {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+
+    MeshSimplifierInput getInput() const {
+      MeshSimplifierInput input;
+      input.positions = &vertices[0].position.x;
+      input.positionStride = sizeof(Vertex);
+      input.normals = &vertices[0].normal.x;
+      input.normalStride = sizeof(Vertex);
+      input.texcoords = &vertices[0].texcoord.x;
+      input.texcoordStride = sizeof(Vertex);
+      input.vertexCount = uint32_t(vertices.size());
+      return input;
+    }
+  };
+
+  // Flat grid of n x n quads in the XY plane covering [0, 1]
+  Mesh makeGrid(uint32_t n) {
+    Mesh mesh;
+
+    for (uint32_t y = 0; y <= n; y++) {
+      for (uint32_t x = 0; x <= n; x++) {
+        const Vector2 uv(float(x) / n, float(y) / n);
+        mesh.vertices.push_back({ Vector3(uv.x, uv.y, 0.f), Vector3(0.f, 0.f, 1.f), uv });
+      }
+    }
+
+    for (uint32_t y = 0; y < n; y++) {
+      for (uint32_t x = 0; x < n; x++) {
+        const uint32_t i = y * (n + 1) + x;
+        mesh.indices.insert(mesh.indices.end(), { i, i + 1, i + n + 2, i, i + n + 2, i + n + 1 });
+      }
+    }
+
+    return mesh;
+  }
+
+  // Unit sphere with a texture seam along the first meridian, where vertices are duplicated with
+  // different texcoords, and single vertices at the poles
+  Mesh makeSphere(uint32_t rings, uint32_t segments) {
+    Mesh mesh;
+
+    const auto addVertex = [&](float theta, float phi, float u) {
+      const Vector3 p(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+      mesh.vertices.push_back({ p, p, Vector2(u, theta / kPi) });
+    };
+
+    addVertex(0.f, 0.f, 0.5f);
+
+    for (uint32_t r = 1; r < rings; r++) {
+      for (uint32_t s = 0; s <= segments; s++) {
+        addVertex(kPi * r / rings, 2.f * kPi * (s % segments) / segments, float(s) / segments);
+      }
+    }
+
+    addVertex(kPi, 0.f, 0.5f);
+
+    const uint32_t south = uint32_t(mesh.vertices.size() - 1);
+    const auto ringVertex = [&](uint32_t r, uint32_t s) { return 1 + (r - 1) * (segments + 1) + s; };
+
+    for (uint32_t s = 0; s < segments; s++) {
+      mesh.indices.insert(mesh.indices.end(), { 0u, ringVertex(1, s), ringVertex(1, s + 1) });
+      mesh.indices.insert(mesh.indices.end(), { south, ringVertex(rings - 1, s + 1), ringVertex(rings - 1, s) });
+
+      for (uint32_t r = 1; r < rings - 1; r++) {
+        const uint32_t a = ringVertex(r, s), b = ringVertex(r, s + 1);
+        const uint32_t c = ringVertex(r + 1, s), d = ringVertex(r + 1, s + 1);
+        mesh.indices.insert(mesh.indices.end(), { a, c, d, a, d, b });
+      }
+    }
+
+    return mesh;
+  }
+
+  float getPointTriangleDistance(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c) {
+    const Vector3 n = normalize(cross(b - a, c - a));
+    const Vector3 projected = p - n * dot(p - a, n);
+
+    // Inside the triangle the distance is the distance to its plane
+    const bool inside =
+      dot(cross(b - a, projected - a), n) >= 0.f &&
+      dot(cross(c - b, projected - b), n) >= 0.f &&
+      dot(cross(a - c, projected - c), n) >= 0.f;
+
+    if (inside) {
+      return std::abs(dot(p - a, n));
+    }
+
+    const auto segmentDistance = [&](const Vector3& s0, const Vector3& s1) {
+      const float t = std::clamp(dot(p - s0, s1 - s0) / lengthSqr(s1 - s0), 0.f, 1.f);
+      return length(p - (s0 + (s1 - s0) * t));
+    };
+
+    return std::min({ segmentDistance(a, b), segmentDistance(b, c), segmentDistance(c, a) });
+  }
+
+  // Largest distance of the original vertices and triangle centers to the simplified surface
+  float measureError(const Mesh& mesh, const std::vector<uint32_t>& indices) {
+    float maxDistance = 0.f;
+
+    const auto measure = [&](const Vector3& p) {
+      float distance = FLT_MAX;
+
+      for (size_t i = 0; i < indices.size(); i += 3) {
+        distance = std::min(distance, getPointTriangleDistance(p,
+          mesh.vertices[indices[i + 0]].position, mesh.vertices[indices[i + 1]].position, mesh.vertices[indices[i + 2]].position));
+      }
+
+      maxDistance = std::max(maxDistance, distance);
+    };
+
+    for (const Vertex& vertex : mesh.vertices) {
+      measure(vertex.position);
+    }
+
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+      measure((mesh.vertices[mesh.indices[i]].position + mesh.vertices[mesh.indices[i + 1]].position + mesh.vertices[mesh.indices[i + 2]].position) / 3.f);
+    }
+
+    return maxDistance;
+  }
+
+  // Checks that the simplified mesh references valid vertices, has no degenerate triangles and stays manifold
+  void validateTopology(const Mesh& mesh, const std::vector<uint32_t>& indices, const char* name) {
+    if (indices.size() % 3 != 0)
+      throw DxvkError(str::format(name, ": index count is not a multiple of 3"));
+
+    std::map<std::pair<std::tuple<float, float, float>, std::tuple<float, float, float>>, uint32_t> edgeUseCounts;
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      std::tuple<float, float, float> p[3];
+
+      for (uint32_t k = 0; k < 3; k++) {
+        if (indices[i + k] >= mesh.vertices.size())
+          throw DxvkError(str::format(name, ": index out of range"));
+
+        const Vector3& position = mesh.vertices[indices[i + k]].position;
+        p[k] = std::make_tuple(position.x, position.y, position.z);
+      }
+
+      if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0])
+        throw DxvkError(str::format(name, ": degenerate triangle"));
+
+      for (uint32_t k = 0; k < 3; k++) {
+        edgeUseCounts[std::minmax(p[k], p[(k + 1) % 3])]++;
+      }
+    }
+
+    for (const auto& edge : edgeUseCounts) {
+      if (edge.second > 2)
+        throw DxvkError(str::format(name, ": non-manifold edge"));
+    }
+  }
+
+  bool referencesVertex(const std::vector<uint32_t>& indices, uint32_t vertex) {
+    return std::find(indices.begin(), indices.end(), vertex) != indices.end();
+  }
+
+  float getArea(const Mesh& mesh, const std::vector<uint32_t>& indices) {
+    float area = 0.f;
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      const Vector3& a = mesh.vertices[indices[i]].position;
+      area += 0.5f * length(cross(mesh.vertices[indices[i + 1]].position - a, mesh.vertices[indices[i + 2]].position - a));
+    }
+
+    return area;
+  }
+}
+
+class MeshSimplifierTestApp {
+public:
+  static void run() {
+    testPlanarGrid();
+    testMaterialBoundary();
+    testSphereErrorBounds();
+    testMaxError();
+    testLodChain();
+    testDiskCache();
+    testSelector();
+    benchmark();
+  }
+
+private:
+  static void testPlanarGrid() {
+    const uint32_t n = 32;
+    const Mesh grid = makeGrid(n);
+
+    MeshSimplifier simplifier(grid.getInput(), grid.indices);
+    simplifier.simplify(0, 1e-3f);
+
+    const std::vector<uint32_t> indices = simplifier.getIndices();
+    validateTopology(grid, indices, "Grid");
+
+    // Only the border vertices are locked, a flat interior collapses without error
+    if (indices.size() >= grid.indices.size() / 8)
+      throw DxvkError(str::format("Grid: only reduced from ", grid.indices.size(), " to ", indices.size(), " indices"));
+
+    if (simplifier.getError() > 1e-5f)
+      throw DxvkError(str::format("Grid: error ", simplifier.getError(), " on a planar mesh"));
+
+    // Any fold would show up as overlapping area
+    if (std::abs(getArea(grid, indices) - 1.f) > 1e-4f)
+      throw DxvkError(str::format("Grid: simplified area ", getArea(grid, indices), " does not match the original"));
+
+    for (uint32_t i = 0; i <= n; i++) {
+      for (uint32_t border : { i, n * (n + 1) + i, i * (n + 1), i * (n + 1) + n }) {
+        if (!referencesVertex(indices, border))
+          throw DxvkError("Grid: border vertex removed");
+      }
+    }
+  }
+
+  static void testMaterialBoundary() {
+    // Two material subsets of one grid sharing its vertices are simplified separately
+    const uint32_t n = 32;
+    const Mesh grid = makeGrid(n);
+
+    std::vector<uint32_t> leftIndices;
+    std::vector<uint32_t> rightIndices;
+
+    for (size_t i = 0; i < grid.indices.size(); i += 6) {
+      const uint32_t x = uint32_t(i / 6) % n;
+      auto& subset = x < n / 2 ? leftIndices : rightIndices;
+      subset.insert(subset.end(), grid.indices.begin() + i, grid.indices.begin() + i + 6);
+    }
+
+    MeshSimplifier left(grid.getInput(), leftIndices);
+    MeshSimplifier right(grid.getInput(), rightIndices);
+    left.simplify(0, 1e-3f);
+    right.simplify(0, 1e-3f);
+
+    const std::vector<uint32_t> simplifiedLeft = left.getIndices();
+    const std::vector<uint32_t> simplifiedRight = right.getIndices();
+
+    // The shared boundary must be kept by both subsets or cracks open up between them
+    for (uint32_t y = 0; y <= n; y++) {
+      const uint32_t boundary = y * (n + 1) + n / 2;
+
+      if (!referencesVertex(simplifiedLeft, boundary) || !referencesVertex(simplifiedRight, boundary))
+        throw DxvkError("Material boundary: boundary vertex removed");
+    }
+
+    if (std::abs(getArea(grid, simplifiedLeft) + getArea(grid, simplifiedRight) - 1.f) > 1e-4f)
+      throw DxvkError("Material boundary: subsets no longer cover the original surface");
+  }
+
+  static void testSphereErrorBounds() {
+    const uint32_t rings = 24;
+    const uint32_t segments = 48;
+    const Mesh sphere = makeSphere(rings, segments);
+
+    MeshSimplifier simplifier(sphere.getInput(), sphere.indices);
+    uint32_t previousIndexCount = simplifier.getIndexCount();
+    float previousError = 0.f;
+
+    for (uint32_t target : { 2000u, 1000u, 500u }) {
+      simplifier.simplify(target * 3, 1.f);
+
+      const std::vector<uint32_t> indices = simplifier.getIndices();
+      validateTopology(sphere, indices, "Sphere");
+
+      if (simplifier.getIndexCount() > target * 3 || simplifier.getIndexCount() >= previousIndexCount)
+        throw DxvkError(str::format("Sphere: ", simplifier.getIndexCount(), " indices left for a target of ", target * 3));
+
+      if (simplifier.getError() < previousError)
+        throw DxvkError("Sphere: error decreased while simplifying further");
+
+      // The reported error has to bound the actual deviation from the original surface
+      const float measuredError = measureError(sphere, indices);
+
+      if (measuredError > simplifier.getError() * 1.05f + 1e-4f)
+        throw DxvkError(str::format("Sphere: measured error ", measuredError, " exceeds reported error ", simplifier.getError()));
+
+      // Seam vertices have different texcoords than their counterparts on the other side
+      for (uint32_t r = 1; r < rings; r++) {
+        const uint32_t seamStart = 1 + (r - 1) * (segments + 1);
+
+        if (!referencesVertex(indices, seamStart) || !referencesVertex(indices, seamStart + segments))
+          throw DxvkError("Sphere: seam vertex removed");
+      }
+
+      previousIndexCount = simplifier.getIndexCount();
+      previousError = simplifier.getError();
+    }
+  }
+
+  static void testMaxError() {
+    const Mesh sphere = makeSphere(24, 48);
+    const float maxError = 0.01f;
+
+    MeshSimplifier simplifier(sphere.getInput(), sphere.indices);
+    simplifier.simplify(0, maxError);
+
+    if (simplifier.getError() > maxError)
+      throw DxvkError(str::format("Max error: error ", simplifier.getError(), " exceeds the limit of ", maxError));
+
+    if (simplifier.getIndexCount() == sphere.indices.size())
+      throw DxvkError("Max error: nothing was simplified");
+
+    if (measureError(sphere, simplifier.getIndices()) > maxError * 1.05f)
+      throw DxvkError("Max error: measured error exceeds the limit");
+  }
+
+  static void testLodChain() {
+    const Mesh sphere = makeSphere(64, 128);
+
+    MeshLodSettings settings;
+    settings.reductionPerLevel = 0.5f;
+    settings.maxLevels = 4;
+    settings.minTriangles = 256;
+
+    const std::vector<MeshLod> lods = generateMeshLods(sphere.getInput(), sphere.indices, settings);
+
+    if (lods.size() != settings.maxLevels)
+      throw DxvkError(str::format("LOD chain: ", lods.size(), " levels generated"));
+
+    size_t previousIndexCount = sphere.indices.size();
+    float previousError = 0.f;
+
+    for (const MeshLod& lod : lods) {
+      validateTopology(sphere, lod.indices, "LOD chain");
+
+      if (lod.indices.size() > previousIndexCount * settings.reductionPerLevel + 3)
+        throw DxvkError(str::format("LOD chain: level with ", lod.indices.size(), " indices after ", previousIndexCount));
+
+      if (lod.error < previousError || lod.error > settings.maxError)
+        throw DxvkError("LOD chain: errors are not increasing within the limit");
+
+      previousIndexCount = lod.indices.size();
+      previousError = lod.error;
+    }
+
+    // Too small meshes and a limit reached early end the chain
+    settings.minTriangles = uint32_t(sphere.indices.size() / 3);
+
+    if (!generateMeshLods(sphere.getInput(), sphere.indices, settings).empty())
+      throw DxvkError("LOD chain: levels generated for a mesh at the minimum triangle count");
+
+    settings.minTriangles = 16;
+    settings.maxError = 0.f;
+
+    if (!generateMeshLods(sphere.getInput(), sphere.indices, settings).empty())
+      throw DxvkError("LOD chain: levels generated without any error allowed");
+  }
+
+  static void testDiskCache() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "rtx_mesh_lod_cache_test";
+    std::filesystem::remove_all(directory);
+
+    const Mesh sphere = makeSphere(16, 32);
+    const std::vector<MeshLod> lods = generateMeshLods(sphere.getInput(), sphere.indices, MeshLodSettings { 0.5f, 3, 32, 1.f });
+
+    std::vector<MeshLod> loaded;
+
+    if (loadMeshLods(directory.string(), 1, loaded))
+      throw DxvkError("Disk cache: loaded a missing entry");
+
+    if (!storeMeshLods(directory.string(), 1, lods) || !loadMeshLods(directory.string(), 1, loaded))
+      throw DxvkError("Disk cache: round trip failed");
+
+    if (loaded.size() != lods.size())
+      throw DxvkError("Disk cache: level count mismatch");
+
+    for (size_t i = 0; i < lods.size(); i++) {
+      if (loaded[i].indices != lods[i].indices || loaded[i].error != lods[i].error)
+        throw DxvkError("Disk cache: level contents mismatch");
+    }
+
+    // Corrupt the entry, it must be rejected rather than produce garbage indices
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+      std::filesystem::resize_file(entry.path(), std::filesystem::file_size(entry.path()) - 4);
+    }
+
+    if (loadMeshLods(directory.string(), 1, loaded) || !loaded.empty())
+      throw DxvkError("Disk cache: loaded a corrupted entry");
+
+    std::filesystem::remove_all(directory);
+  }
+
+  static void testSelector() {
+    const float errors[] = { 0.f, 0.01f, 0.02f, 0.04f };
+    const float threshold = 1.f;
+    const float hysteresis = 0.2f;
+
+    // Without history the coarsest level within the threshold is picked
+    if (MeshLodSelector::selectLevel(errors, 4, 50.f, threshold, 0.f, UINT32_MAX) != 2)
+      throw DxvkError("Selector: wrong level without history");
+
+    if (MeshLodSelector::selectLevel(errors, 4, 1000.f, threshold, 0.f, UINT32_MAX) != 0)
+      throw DxvkError("Selector: close objects must use the full detail mesh");
+
+    MeshLodSelector selector;
+    const XXH64_hash_t key = 42;
+
+    // Moving away: level 2 becomes acceptable at 50 pixels per unit, but only taken with margin
+    if (selector.select(key, errors, 4, 90.f, threshold, hysteresis, 0) != 1)
+      throw DxvkError("Selector: wrong initial level");
+
+    if (selector.select(key, errors, 4, 45.f, threshold, hysteresis, 1) != 1)
+      throw DxvkError("Selector: coarsened within the hysteresis margin");
+
+    if (selector.select(key, errors, 4, 39.f, threshold, hysteresis, 2) != 2)
+      throw DxvkError("Selector: did not coarsen past the hysteresis margin");
+
+    // Moving back: level 2 exceeds the threshold at 50 pixels per unit, but is kept within the margin
+    if (selector.select(key, errors, 4, 55.f, threshold, hysteresis, 3) != 2)
+      throw DxvkError("Selector: refined within the hysteresis margin");
+
+    if (selector.select(key, errors, 4, 65.f, threshold, hysteresis, 4) != 1)
+      throw DxvkError("Selector: did not refine past the hysteresis margin");
+
+    selector.garbageCollect(10, 8);
+
+    if (selector.getObjectCount() != 1)
+      throw DxvkError("Selector: recently selected object collected");
+
+    selector.garbageCollect(20, 8);
+
+    if (selector.getObjectCount() != 0)
+      throw DxvkError("Selector: stale object not collected");
+  }
+
+  static void benchmark() {
+    MeshLodSettings settings;
+
+    for (uint32_t rings : { 64u, 128u }) {
+      const Mesh sphere = makeSphere(rings, rings * 2);
+
+      const auto start = std::chrono::high_resolution_clock::now();
+      const std::vector<MeshLod> lods = generateMeshLods(sphere.getInput(), sphere.indices, settings);
+      const auto end = std::chrono::high_resolution_clock::now();
+
+      cout << "Sphere with " << sphere.indices.size() / 3 << " triangles: " << lods.size() << " levels (";
+
+      for (const MeshLod& lod : lods) {
+        cout << lod.indices.size() / 3 << " triangles, error " << lod.error << (&lod != &lods.back() ? "; " : "");
+      }
+
+      cout << ") in " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << endl;
+    }
+  }
+};
+
+int main() {
+  try {
+    MeshSimplifierTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,225 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <functional>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_optional_resource.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  using Action = RtxOptionalResourceLifetime::Action;
+
+  // Stand-in for the options optional passes decide on
+  struct Options {
+    bool enableBloom = false;
+    uint32_t debugViewIdx = 0;
+    bool hdrWaveform = false;
+  };
+
+  // Optional resource driven by a predicate over the options, counting its allocations
+  struct OptionalResource {
+    std::function<bool(const Options&)> isActive;
+    RtxOptionalResourceLifetime lifetime;
+    bool allocated = false;
+    uint32_t allocations = 0;
+
+    void apply(Action action) {
+      if (action == Action::Allocate) {
+        allocated = true;
+        allocations++;
+      } else if (action == Action::Release) {
+        allocated = false;
+      }
+    }
+
+    void onFrameBegin(const Options& options, uint32_t idleFrames) {
+      apply(lifetime.update(isActive(options), idleFrames));
+    }
+
+    void onResize() {
+      apply(lifetime.onResize());
+    }
+  };
+}
+
+class OptionalResourceTestApp {
+public:
+  static void run() {
+    testAllocateOnFirstUse();
+    testIdleRelease();
+    testImmediateRelease();
+    testResize();
+    testPredicates();
+  }
+
+private:
+  static void testAllocateOnFirstUse() {
+    RtxOptionalResourceLifetime lifetime;
+
+    if (lifetime.update(false, 10) != Action::None || lifetime.isAllocated())
+      throw DxvkError("Optional resource allocated while inactive");
+
+    if (lifetime.update(true, 10) != Action::Allocate || !lifetime.isAllocated() || !lifetime.isActive())
+      throw DxvkError("Optional resource not allocated on first use");
+
+    if (lifetime.update(true, 10) != Action::None)
+      throw DxvkError("Optional resource allocated twice");
+  }
+
+  static void testIdleRelease() {
+    RtxOptionalResourceLifetime lifetime;
+    lifetime.update(true, 3);
+
+    // Kept for the given number of idle frames, released on the next one
+    for (uint32_t i = 0; i < 3; i++) {
+      if (lifetime.update(false, 3) != Action::None || !lifetime.isAllocated())
+        throw DxvkError(str::format("Optional resource released after ", i + 1, " idle frames"));
+    }
+
+    if (lifetime.update(false, 3) != Action::Release || lifetime.isAllocated())
+      throw DxvkError("Optional resource not released after its idle frames");
+
+    if (lifetime.update(false, 3) != Action::None)
+      throw DxvkError("Optional resource released twice");
+
+    // Reactivating within the idle frames keeps the resource and restarts the count
+    lifetime.update(true, 3);
+    lifetime.update(false, 3);
+    lifetime.update(false, 3);
+
+    if (lifetime.update(true, 3) != Action::None || lifetime.getIdleFrames() != 0)
+      throw DxvkError("Optional resource reallocated when reactivated while idle");
+  }
+
+  static void testImmediateRelease() {
+    RtxOptionalResourceLifetime lifetime;
+    lifetime.update(true, 0);
+
+    if (lifetime.update(false, 0) != Action::Release)
+      throw DxvkError("Optional resource not released immediately without idle frames");
+  }
+
+  static void testResize() {
+    RtxOptionalResourceLifetime lifetime;
+
+    if (lifetime.onResize() != Action::None)
+      throw DxvkError("Unallocated optional resource allocated on resize");
+
+    lifetime.update(true, 10);
+
+    if (lifetime.onResize() != Action::Allocate || !lifetime.isAllocated())
+      throw DxvkError("Optional resource in use not recreated on resize");
+
+    // Idle resources are released rather than reallocated at the new size
+    lifetime.update(false, 10);
+
+    if (lifetime.onResize() != Action::Release || lifetime.isAllocated())
+      throw DxvkError("Idle optional resource not released on resize");
+
+    if (lifetime.update(true, 10) != Action::Allocate)
+      throw DxvkError("Optional resource released on resize not allocated on next use");
+  }
+
+  static void testPredicates() {
+    constexpr uint32_t kIdleFrames = 30;
+
+    OptionalResource bloom;
+    bloom.isActive = [](const Options& o) { return o.enableBloom; };
+
+    OptionalResource debugView;
+    debugView.isActive = [](const Options& o) { return o.debugViewIdx != 0; };
+
+    OptionalResource waveform;
+    waveform.isActive = [](const Options& o) { return o.debugViewIdx != 0 && o.hdrWaveform; };
+
+    std::vector<OptionalResource*> resources = { &bloom, &debugView, &waveform };
+
+    Options options;
+    uint32_t frame = 0;
+
+    auto runFrames = [&](uint32_t count) {
+      for (uint32_t i = 0; i < count; i++, frame++) {
+        for (OptionalResource* resource : resources)
+          resource->onFrameBegin(options, kIdleFrames);
+      }
+    };
+
+    // Nothing is allocated while every feature is off
+    runFrames(100);
+
+    for (OptionalResource* resource : resources) {
+      if (resource->allocated || resource->allocations)
+        throw DxvkError("Optional resource allocated while its feature is off");
+    }
+
+    // The waveform option alone does not activate the waveform resource
+    options.hdrWaveform = true;
+    runFrames(10);
+
+    if (waveform.allocated)
+      throw DxvkError("Optional resource predicate ignored one of its options");
+
+    // Flicking the debug view on and off quickly allocates once
+    for (uint32_t i = 0; i < 10; i++) {
+      options.debugViewIdx = 1;
+      runFrames(5);
+      options.debugViewIdx = 0;
+      runFrames(5);
+    }
+
+    if (debugView.allocations != 1 || waveform.allocations != 1 || !debugView.allocated)
+      throw DxvkError("Optional resource reallocated while toggled within its idle frames");
+
+    runFrames(kIdleFrames);
+
+    if (debugView.allocated || waveform.allocated)
+      throw DxvkError("Optional resource kept after its idle frames");
+
+    // Resizing only recreates what is in use
+    options.enableBloom = true;
+    runFrames(1);
+
+    for (OptionalResource* resource : resources)
+      resource->onResize();
+
+    if (bloom.allocations != 2 || debugView.allocations != 1)
+      throw DxvkError("Resize recreated unexpected optional resources");
+
+    cout << "Optional resources: bloom " << bloom.allocations << ", debug view " << debugView.allocations
+         << ", waveform " << waveform.allocations << " allocations over " << frame << " frames" << endl;
+  }
+};
+
+int main() {
+  try {
+    OptionalResourceTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <iostream>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_ray_visibility.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Ray masks the path tracer uses for each ray type, without the view model and player model bits
+  constexpr uint32_t kPrimaryRayMask = OBJECT_MASK_ALL;
+  constexpr uint32_t kIndirectRayMask = OBJECT_MASK_ALL_INDIRECT;
+  constexpr uint32_t kShadowRayMask = OBJECT_MASK_OPAQUE_SHADOW;
+
+  constexpr uint32_t kParticle = uint32_t(RayVisibilityCategory::Particle);
+  constexpr uint32_t kDecal = uint32_t(RayVisibilityCategory::Decal);
+  constexpr uint32_t kAlphaTested = uint32_t(RayVisibilityCategory::AlphaTested);
+  constexpr uint32_t kSmall = uint32_t(RayVisibilityCategory::Small);
+
+  struct Visibility {
+    bool primary;
+    bool indirect;
+    bool shadow;
+  };
+
+  Visibility trace(uint32_t instanceMask) {
+    return Visibility { (instanceMask & kPrimaryRayMask) != 0, (instanceMask & kIndirectRayMask) != 0, (instanceMask & kShadowRayMask) != 0 };
+  }
+
+  void expectVisibility(const char* name, uint32_t categories, const RayVisibilityPolicy& policy, Visibility expected) {
+    const uint32_t mask = getOpaqueRayVisibilityMask(categories, policy);
+    const Visibility actual = trace(mask);
+
+    if (actual.primary != expected.primary || actual.indirect != expected.indirect || actual.shadow != expected.shadow) {
+      throw DxvkError(str::format(name, ": mask ", mask, " is traced by primary ", actual.primary, ", indirect ", actual.indirect, ", shadow ", actual.shadow,
+                                  " rays, expected ", expected.primary, ", ", expected.indirect, ", ", expected.shadow));
+    }
+  }
+}
+
+class RayVisibilityTestApp {
+public:
+  static void run() {
+    testMaskBits();
+    testCategories();
+    testPolicy();
+    testExcludedFromBoth();
+  }
+
+private:
+  // The opaque bits must not overlap the other ordered TLAS bits, and every ray type must still see unrestricted instances
+  static void testMaskBits() {
+    if (OBJECT_MASK_OPAQUE_INDIRECT & OBJECT_MASK_OPAQUE_SHADOW)
+      throw DxvkError("Opaque ray type bits overlap");
+
+    if (OBJECT_MASK_OPAQUE & (OBJECT_MASK_TRANSLUCENT | OBJECT_MASK_PORTAL | OBJECT_MASK_ALL_DYNAMIC))
+      throw DxvkError("Opaque bits overlap other instance mask bits");
+
+    if (OBJECT_MASK_ALL_INDIRECT & OBJECT_MASK_OPAQUE_SHADOW)
+      throw DxvkError("Indirect rays trace instances only meant for shadow rays");
+
+    if ((OBJECT_MASK_ALL & OBJECT_MASK_OPAQUE) != OBJECT_MASK_OPAQUE)
+      throw DxvkError("Primary rays do not trace both opaque bits");
+
+    expectVisibility("Unrestricted", 0, RayVisibilityPolicy {}, { true, true, true });
+  }
+
+  static void testCategories() {
+    struct Case {
+      bool isParticle, isDecal, isAlphaTested;
+      float radius, smallRadius;
+      uint32_t expected;
+    };
+
+    const Case cases[] = {
+      { false, false, false, 10.f, 0.f, 0 },
+      { true, false, false, 10.f, 0.f, kParticle },
+      { false, true, false, 10.f, 0.f, kDecal },
+      { false, false, true, 10.f, 0.f, kAlphaTested },
+      { true, true, true, 10.f, 0.f, kParticle | kDecal | kAlphaTested },
+      // Small only below the threshold, and never with unknown bounds
+      { false, false, false, 0.5f, 1.f, kSmall },
+      { false, false, false, 1.f, 1.f, 0 },
+      { false, false, false, -1.f, 1.f, 0 },
+      { false, false, false, 0.f, 0.f, 0 },
+    };
+
+    for (const Case& c : cases) {
+      const uint32_t categories = getRayVisibilityCategories(c.isParticle, c.isDecal, c.isAlphaTested, c.radius, c.smallRadius);
+
+      if (categories != c.expected)
+        throw DxvkError(str::format("Categories ", categories, " do not match the expected ", c.expected, " for radius ", c.radius));
+    }
+  }
+
+  static void testPolicy() {
+    // Particles hidden from indirect rays, decals from shadow rays
+    RayVisibilityPolicy policy;
+    policy.indirectExcluded = kParticle;
+    policy.shadowExcluded = kDecal;
+
+    expectVisibility("Plain instance", 0, policy, { true, true, true });
+    expectVisibility("Particle", kParticle, policy, { true, false, true });
+    expectVisibility("Decal", kDecal, policy, { true, true, false });
+    expectVisibility("Alpha tested", kAlphaTested, policy, { true, true, true });
+
+    // Any excluded category of an instance applies
+    policy.indirectExcluded = kSmall;
+    policy.shadowExcluded = 0;
+    expectVisibility("Small alpha tested", kAlphaTested | kSmall, policy, { true, false, true });
+  }
+
+  // Primary rays have no bit of their own, so exclusion from both ray types leaves the instance in shadow rays
+  static void testExcludedFromBoth() {
+    RayVisibilityPolicy policy;
+    policy.indirectExcluded = kParticle;
+    policy.shadowExcluded = kParticle;
+    expectVisibility("Particle excluded from both", kParticle, policy, { true, false, true });
+
+    policy.indirectExcluded = kSmall;
+    policy.shadowExcluded = kDecal;
+    expectVisibility("Small decal", kDecal | kSmall, policy, { true, false, true });
+    expectVisibility("Large decal", kDecal, policy, { true, true, false });
+
+    // Every combination must stay visible to primary rays
+    for (uint32_t shadowExcluded = 0; shadowExcluded < 16; shadowExcluded++) {
+      for (uint32_t indirectExcluded = 0; indirectExcluded < 16; indirectExcluded++) {
+        for (uint32_t categories = 0; categories < 16; categories++) {
+          const uint32_t mask = getOpaqueRayVisibilityMask(categories, RayVisibilityPolicy { shadowExcluded, indirectExcluded });
+
+          if (!trace(mask).primary)
+            throw DxvkError(str::format("Categories ", categories, " are hidden from primary rays"));
+        }
+      }
+    }
+  }
+};
+
+int main() {
+  try {
+    RayVisibilityTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_device.h"
+#include "../../../src/dxvk/rtx_render/rtx_lightmanager.h"
+#include "../../../src/dxvk/rtx_render/rtx_options.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Translation standing in for the transform of a root instance
+  struct Transform {
+    float x = 0.f, y = 0.f, z = 0.f;
+
+    bool operator==(const Transform& other) const {
+      return x == other.x && y == other.y && z == other.z;
+    }
+  };
+
+  RtLight createLocalLight() {
+    return RtLight(RtSphereLight(Vector3(1.f, 2.f, 3.f), Vector3(10.f, 10.f, 10.f), 0.5f, RtLightShaping()));
+  }
+
+  Matrix4 createTranslation(float x) {
+    Matrix4 transform;
+    transform[3] = Vector4(x, 0.f, 0.f, 1.f);
+    return transform;
+  }
+
+  // Stands in for prepareSceneData, which assigns the buffer index RTXDI keeps temporal history under
+  void assignBufferIndices(const LightManager& lightManager) {
+    uint32_t bufferIdx = 0;
+
+    for (const auto& entry : lightManager.getLightTable()) {
+      entry.second.setBufferIdx(bufferIdx++);
+    }
+  }
+
+  const RtLight& getOnlyLight(const LightManager& lightManager, const char* context) {
+    if (lightManager.getLightTable().size() != 1)
+      throw DxvkError(str::format(context, ": ", lightManager.getLightTable().size(), " lights in the table, expected 1"));
+
+    return lightManager.getLightTable().begin()->second;
+  }
+}
+
+class ReplacementLightBindingsTestApp {
+public:
+  static void run() {
+    RtxOptions::Create(Config());
+
+    testActions();
+    testRetire();
+    testLightManagerInstance();
+    testLightManagerRetire();
+  }
+
+private:
+  static void testActions() {
+    RtReplacementLightBindings<Transform> bindings;
+    using Action = RtReplacementLightBindings<Transform>::Action;
+
+    const Transform a { 1.f, 0.f, 0.f };
+    const Transform b { 2.f, 0.f, 0.f };
+
+    if (bindings.bind(1, 10, a, 0) != Action::Create || bindings.bind(1, 11, a, 0) != Action::Create)
+      throw DxvkError("Replacement light not created on first bind");
+
+    if (bindings.bind(1, 10, a, 1) != Action::Keep || bindings.bind(1, 11, a, 1) != Action::Keep)
+      throw DxvkError("Replacement light of a static instance not kept");
+
+    // All lights of a moved instance are updated, including ones bound after the first
+    if (bindings.bind(1, 10, b, 2) != Action::Update || bindings.bind(1, 11, b, 2) != Action::Update)
+      throw DxvkError("Replacement light of a moved instance not updated");
+
+    // Lights added to an existing instance are created, not updated
+    if (bindings.bind(1, 12, b, 3) != Action::Create || bindings.bind(1, 10, b, 3) != Action::Keep)
+      throw DxvkError("Replacement light added to an existing instance not created");
+
+    if (bindings.bind(2, 10, b, 3) != Action::Create || bindings.getInstanceCount() != 2)
+      throw DxvkError("Replacement lights of different instances not bound separately");
+  }
+
+  static void testRetire() {
+    RtReplacementLightBindings<Transform> bindings;
+
+    bindings.bind(1, 10, Transform(), 0);
+    bindings.bind(1, 11, Transform(), 0);
+    bindings.bind(2, 10, Transform(), 0);
+
+    bindings.retire(1);
+    bindings.retire(1);
+
+    if (bindings.getInstanceCount() != 1)
+      throw DxvkError("Replacement light bindings not retired with their instance");
+
+    if (bindings.bind(2, 10, Transform(), 1) != RtReplacementLightBindings<Transform>::Action::Keep)
+      throw DxvkError("Retiring an instance affected another instance");
+
+    if (bindings.bind(1, 10, Transform(), 1) != RtReplacementLightBindings<Transform>::Action::Create)
+      throw DxvkError("Light of a retired instance not created again");
+  }
+
+  // Lights of static and moving instances keep their buffer index in the real light manager
+  static void testLightManagerInstance() {
+    LightManager lightManager(nullptr);
+    const RtLight localLight = createLocalLight();
+
+    lightManager.setDetachedFrameId(1);
+    lightManager.addReplacementLight(1, localLight, createTranslation(0.f));
+    lightManager.garbageCollection();
+    assignBufferIndices(lightManager);
+
+    const uint32_t bufferIdx = getOnlyLight(lightManager, "Created light").getBufferIdx();
+
+    lightManager.setDetachedFrameId(2);
+    lightManager.addReplacementLight(1, localLight, createTranslation(0.f));
+    lightManager.garbageCollection();
+
+    const RtLight& staticLight = getOnlyLight(lightManager, "Static light");
+    if (staticLight.getFrameLastTouched() != 2 || staticLight.getBufferIdx() != bufferIdx)
+      throw DxvkError("Light of a static instance not kept");
+
+    lightManager.setDetachedFrameId(3);
+    lightManager.addReplacementLight(1, localLight, createTranslation(5.f));
+    lightManager.garbageCollection();
+
+    const RtLight& movedLight = getOnlyLight(lightManager, "Moved light");
+    if (movedLight.getPosition().x != 6.f || movedLight.getBufferIdx() != bufferIdx)
+      throw DxvkError("Light of a moved instance not transformed in place");
+  }
+
+  // Lights of destroyed instances age out, and a light of an instance recreated in the same
+  // place takes over their buffer index through light matching
+  static void testLightManagerRetire() {
+    LightManager lightManager(nullptr);
+    const RtLight localLight = createLocalLight();
+
+    lightManager.setDetachedFrameId(1);
+    lightManager.addReplacementLight(1, localLight, createTranslation(0.f));
+    lightManager.garbageCollection();
+    assignBufferIndices(lightManager);
+
+    const uint32_t bufferIdx = getOnlyLight(lightManager, "Created light").getBufferIdx();
+
+    lightManager.retireReplacementLights(1);
+    getOnlyLight(lightManager, "Retired light");
+
+    lightManager.setDetachedFrameId(2);
+    lightManager.addReplacementLight(2, localLight, createTranslation(0.f));
+    lightManager.garbageCollection();
+
+    const RtLight& recreatedLight = getOnlyLight(lightManager, "Recreated light");
+    if (recreatedLight.getBufferIdx() != bufferIdx)
+      throw DxvkError("Light of a recreated instance lost the buffer index of the retired light");
+
+    lightManager.retireReplacementLights(2);
+
+    lightManager.setDetachedFrameId(3);
+    lightManager.garbageCollection();
+
+    if (!lightManager.getLightTable().empty())
+      throw DxvkError("Light of a retired instance not aged out");
+  }
+};
+
+int main() {
+  try {
+    ReplacementLightBindingsTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
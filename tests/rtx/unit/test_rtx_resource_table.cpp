@@ -0,0 +1,161 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstdint>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/dxvk_format.h"
+#include "../../../src/dxvk/rtx_render/rtx_resource_table.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  RtxOutputExtents makeExtents() {
+    RtxOutputExtents extents;
+    extents.downscaled = { 1920, 1080, 1 };
+    extents.target = { 3840, 2160, 1 };
+    extents.froxelVolume = { 120, 68, 48 };
+    extents.numFroxelVolumes = 3;
+    extents.rtxdiGradientFactor = 3;
+    return extents;
+  }
+
+  const RtxOutputMemoryReport::Entry* findEntry(const RtxOutputMemoryReport& report, RtxOutputResource id) {
+    for (const auto& entry : report.entries) {
+      if (entry.id == id)
+        return &entry;
+    }
+
+    return nullptr;
+  }
+}
+
+class ResourceTableTestApp {
+public:
+  static void run() {
+    testTable();
+    testExtents();
+    testReport();
+  }
+
+private:
+  static void testTable() {
+    for (uint32_t i = 0; i < uint32_t(RtxOutputResource::Count); i++) {
+      const RtxOutputResourceDesc& desc = getRtxOutputResourceDesc(RtxOutputResource(i));
+
+      if (uint32_t(desc.id) != i)
+        throw DxvkError(str::format("Output resource table entry ", i, " is out of order"));
+
+      if (imageFormatInfo(desc.format)->elementSize == 0)
+        throw DxvkError(str::format("Output resource ", desc.name, " has an unsupported format"));
+
+      if (desc.ownsMemory())
+        continue;
+
+      // Aliases share an image, so they must have the same texel size as the resource they alias
+      const RtxOutputResourceDesc& target = getRtxOutputResourceDesc(desc.aliasOf);
+
+      if (!target.ownsMemory() || target.scale != desc.scale || target.numLayers != desc.numLayers)
+        throw DxvkError(str::format("Output resource ", desc.name, " aliases an incompatible resource"));
+
+      if (imageFormatInfo(desc.format)->elementSize != imageFormatInfo(target.format)->elementSize)
+        throw DxvkError(str::format("Output resource ", desc.name, " has a different texel size than ", target.name));
+
+      if (desc.compactFormat != VK_FORMAT_UNDEFINED || target.compactFormat != VK_FORMAT_UNDEFINED)
+        throw DxvkError(str::format("Aliased output resource ", desc.name, " has a compact format"));
+    }
+  }
+
+  static void testExtents() {
+    const RtxOutputExtents extents = makeExtents();
+
+    const VkExtent3D volumes = getRtxOutputResourceExtent(RtxOutputResource::VolumeReservoirs0, extents);
+    const VkExtent3D volume = getRtxOutputResourceExtent(RtxOutputResource::VolumePreintegratedRadiance, extents);
+
+    if (volumes.width != 360 || volumes.height != 68 || volumes.depth != 48 || volume.width != 120)
+      throw DxvkError("Unexpected froxel volume extents");
+
+    const VkExtent3D gradients = getRtxOutputResourceExtent(RtxOutputResource::RtxdiGradients, extents);
+
+    if (gradients.width != 640 || gradients.height != 360 || gradients.depth != 1)
+      throw DxvkError("Unexpected RTXDI gradient extents");
+
+    const VkExtent3D target = getRtxOutputResourceExtent(RtxOutputResource::FinalOutput, extents);
+
+    if (target.width != 3840 || target.height != 2160)
+      throw DxvkError("Unexpected target extents");
+  }
+
+  static void testReport() {
+    const RtxOutputMemoryReport report = computeRtxOutputMemoryReport(makeExtents());
+
+    const auto* finalOutput = findEntry(report, RtxOutputResource::FinalOutput);
+
+    if (!finalOutput || finalOutput->bytes != 3840ull * 2160 * 8 || finalOutput->compactBytes != 3840ull * 2160 * 4)
+      throw DxvkError("Unexpected final output size");
+
+    const auto* reservoirs = findEntry(report, RtxOutputResource::VolumeReservoirs1);
+
+    if (!reservoirs || reservoirs->bytes != 360ull * 68 * 48 * 16)
+      throw DxvkError("Unexpected volume reservoir size");
+
+    const auto* gradients = findEntry(report, RtxOutputResource::RtxdiGradients);
+
+    if (!gradients || gradients->bytes != 640ull * 360 * 2 * 4)
+      throw DxvkError("Unexpected RTXDI gradients size");
+
+    if (findEntry(report, RtxOutputResource::GbufferPSRData1) || findEntry(report, RtxOutputResource::RestirGIRadiance))
+      throw DxvkError("Aliased resources were counted separately");
+
+    uint64_t entryBytes = 0;
+    uint64_t compactBytes = 0;
+    uint64_t passBytes = 0;
+
+    for (const auto& entry : report.entries) {
+      entryBytes += entry.bytes;
+      compactBytes += entry.compactBytes;
+    }
+
+    for (const auto& passTotal : report.passTotals)
+      passBytes += passTotal.bytes;
+
+    if (entryBytes != report.totalBytes || passBytes != report.totalBytes || compactBytes != report.compactTotalBytes)
+      throw DxvkError("Memory report totals do not add up");
+
+    if (report.compactTotalBytes >= report.totalBytes)
+      throw DxvkError("Compact formats do not save memory");
+
+    cout << "Render targets: " << report.totalBytes / (1024 * 1024) << " MiB, compact: " << report.compactTotalBytes / (1024 * 1024) << " MiB" << endl;
+  }
+};
+
+int main() {
+  try {
+    ResourceTableTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,200 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_scene_digest.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  struct FakeInstance {
+    uint64_t id;
+    float transform[12];
+    uint64_t materialHash;
+  };
+
+  struct FakeScene {
+    float worldToView[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    std::vector<FakeInstance> instances;
+    std::vector<XXH64_hash_t> lights;
+    XXH64_hash_t options = 0;
+
+    XXH64_hash_t digest() const {
+      SceneDigest digest;
+      digest.add(worldToView);
+
+      for (const FakeInstance& instance : instances)
+        digest.add(instance);
+
+      for (XXH64_hash_t light : lights)
+        digest.addUnordered(light);
+
+      digest.add(options);
+      return digest.getHash();
+    }
+  };
+
+  FakeScene makeScene() {
+    FakeScene scene;
+
+    for (uint32_t i = 0; i < 16; i++)
+      scene.instances.push_back({ i, { 1, 0, 0, float(i), 0, 1, 0, 0, 0, 0, 1, 0 }, 0x1000ull + i });
+
+    for (uint32_t i = 0; i < 4; i++)
+      scene.lights.push_back(0xABCD0000ull + i);
+
+    return scene;
+  }
+}
+
+class SceneDigestTestApp {
+public:
+  static void run() {
+    testDigest();
+    testReuse();
+    testRefreshInterval();
+  }
+
+private:
+  static void testDigest() {
+    const FakeScene scene = makeScene();
+    const XXH64_hash_t reference = scene.digest();
+
+    if (makeScene().digest() != reference)
+      throw DxvkError("Identical scenes produced different digests");
+
+    FakeScene reordered = makeScene();
+    std::swap(reordered.lights[0], reordered.lights[3]);
+
+    if (reordered.digest() != reference)
+      throw DxvkError("Reordering an unordered table changed the digest");
+
+    FakeScene duplicated = makeScene();
+    duplicated.lights.push_back(duplicated.lights[0]);
+    duplicated.lights.push_back(duplicated.lights[0]);
+
+    if (duplicated.digest() == reference)
+      throw DxvkError("Duplicate lights cancelled out in the digest");
+
+    FakeScene moved = makeScene();
+    moved.instances[7].transform[3] += 0.001f;
+
+    FakeScene camera = makeScene();
+    camera.worldToView[14] = 1.f;
+
+    FakeScene material = makeScene();
+    material.instances[3].materialHash ^= 1;
+
+    FakeScene option = makeScene();
+    option.options = 1;
+
+    FakeScene removed = makeScene();
+    removed.instances.pop_back();
+
+    for (const FakeScene* changed : { &moved, &camera, &material, &option, &removed }) {
+      if (changed->digest() == reference)
+        throw DxvkError("A scene change was not reflected in the digest");
+    }
+  }
+
+  static void testReuse() {
+    StaticSceneDetector detector;
+    StaticSceneDetector::Settings settings;
+    settings.minStaticFrames = 3;
+
+    const XXH64_hash_t a = makeScene().digest();
+    FakeScene changed = makeScene();
+    changed.options = 42;
+    const XXH64_hash_t b = changed.digest();
+
+    // The first frame and 3 unchanged frames after it render, then the output is reused
+    const StaticSceneAction expected[] = {
+      StaticSceneAction::Render, StaticSceneAction::Render, StaticSceneAction::Render,
+      StaticSceneAction::Render, StaticSceneAction::Reuse, StaticSceneAction::Reuse,
+    };
+
+    for (uint32_t i = 0; i < std::size(expected); i++) {
+      if (detector.update(a, settings) != expected[i])
+        throw DxvkError(str::format("Unexpected action on static frame ", i));
+    }
+
+    if (!detector.isReusingOutput() || detector.getStaticFrameCount() != 5)
+      throw DxvkError("Detector did not track the static frames");
+
+    // Any change renders right away and restarts convergence
+    if (detector.update(b, settings) != StaticSceneAction::Render || detector.getStaticFrameCount() != 0)
+      throw DxvkError("A changed scene did not render immediately");
+
+    if (detector.update(b, settings) != StaticSceneAction::Render)
+      throw DxvkError("Output was reused before the scene converged again");
+
+    // A reset forces the next frame to render even when the digest is unchanged
+    for (uint32_t i = 0; i < 8; i++)
+      detector.update(b, settings);
+
+    detector.reset();
+
+    if (detector.update(b, settings) != StaticSceneAction::Render)
+      throw DxvkError("Frame after a reset was not rendered");
+
+    // Without any convergence frames the first unchanged frame is reused already
+    StaticSceneDetector immediate;
+    settings.minStaticFrames = 0;
+
+    if (immediate.update(a, settings) != StaticSceneAction::Render || immediate.update(a, settings) != StaticSceneAction::Reuse)
+      throw DxvkError("Unchanged frame was not reused without convergence frames");
+  }
+
+  static void testRefreshInterval() {
+    StaticSceneDetector detector;
+    StaticSceneDetector::Settings settings;
+    settings.minStaticFrames = 0;
+    settings.refreshInterval = 4;
+
+    const XXH64_hash_t a = makeScene().digest();
+    uint32_t numRendered = 0;
+
+    detector.update(a, settings);
+
+    for (uint32_t i = 0; i < 40; i++) {
+      if (detector.update(a, settings) == StaticSceneAction::Render)
+        numRendered++;
+    }
+
+    if (numRendered != 10)
+      throw DxvkError(str::format("Rendered ", numRendered, " of 40 static frames with a refresh interval of 4"));
+  }
+};
+
+int main() {
+  try {
+    SceneDigestTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
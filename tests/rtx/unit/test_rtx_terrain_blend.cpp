@@ -0,0 +1,264 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cmath>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/shaders/rtx/pass/terrain_bake/terrain_blend.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  struct Layer {
+    TerrainBlendLayerState state;
+    TerrainBlendLayerSample sample;
+  };
+
+  TerrainBlendLayerState opaqueState() {
+    TerrainBlendLayerState state {};
+    state.colorArg1Source = TERRAIN_BLEND_ARG_TEXTURE;
+    state.colorArg2Source = TERRAIN_BLEND_ARG_NONE;
+    state.colorOperation = TERRAIN_BLEND_TEXOP_MODULATE;
+    state.alphaArg1Source = TERRAIN_BLEND_ARG_TEXTURE;
+    state.alphaArg2Source = TERRAIN_BLEND_ARG_NONE;
+    state.alphaOperation = TERRAIN_BLEND_TEXOP_SELECT_ARG1;
+    state.blendEnabled = 0;
+    state.srcColorBlendFactor = TERRAIN_BLEND_FACTOR_ONE;
+    state.dstColorBlendFactor = TERRAIN_BLEND_FACTOR_ZERO;
+    state.colorBlendOp = TERRAIN_BLEND_OP_ADD;
+    state.tFactor = 0xffffffff;
+    return state;
+  }
+
+  TerrainBlendLayerState blendedState(uint32_t srcFactor, uint32_t dstFactor, uint32_t op = TERRAIN_BLEND_OP_ADD) {
+    TerrainBlendLayerState state = opaqueState();
+    state.blendEnabled = 1;
+    state.srcColorBlendFactor = srcFactor;
+    state.dstColorBlendFactor = dstFactor;
+    state.colorBlendOp = op;
+    return state;
+  }
+
+  TerrainBlendLayerSample sample(float r, float g, float b, float a, float roughness = 0.5f) {
+    TerrainBlendLayerSample s {};
+    s.color[0] = r;
+    s.color[1] = g;
+    s.color[2] = b;
+    s.color[3] = a;
+    s.normal[2] = 1.0f;
+    s.roughness = roughness;
+    return s;
+  }
+
+  TerrainBlendTexel composite(const vector<Layer>& stack) {
+    TerrainBlendTexel texel {};
+    texel.normal[2] = 1.0f;
+
+    for (const Layer& layer : stack) {
+      terrainBlendComposite(texel, layer.state, layer.sample);
+    }
+
+    return texel;
+  }
+
+  void expectNear(float value, float expected, const char* what) {
+    if (std::fabs(value - expected) > 1e-4f) {
+      throw DxvkError(str::format(what, ": expected ", expected, ", got ", value));
+    }
+  }
+
+  void expectAlbedo(const TerrainBlendTexel& texel, float r, float g, float b, const char* what) {
+    expectNear(texel.albedo[0], r, what);
+    expectNear(texel.albedo[1], g, what);
+    expectNear(texel.albedo[2], b, what);
+  }
+}
+
+class TerrainBlendTestApp {
+public:
+  static void run() {
+    testAlphaBlendedLayer();
+    testTextureStageState();
+    testAdditiveAndMultiplicativeLayers();
+    testBlendOperations();
+    testNormalAndRoughness();
+    testLayerOrder();
+  }
+
+private:
+  static void testAlphaBlendedLayer() {
+    cout << "Begin test: alpha blended layer" << endl;
+
+    // Grass base with a 25% dirt layer on top
+    const vector<Layer> stack = {
+      { opaqueState(), sample(0.2f, 0.6f, 0.1f, 1.0f) },
+      { blendedState(TERRAIN_BLEND_FACTOR_SRC_ALPHA, TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA), sample(0.5f, 0.4f, 0.3f, 0.25f) }
+    };
+
+    const TerrainBlendTexel texel = composite(stack);
+    expectAlbedo(texel, 0.2f * 0.75f + 0.5f * 0.25f, 0.6f * 0.75f + 0.4f * 0.25f, 0.1f * 0.75f + 0.3f * 0.25f, "Alpha blended layer");
+
+    // A fully transparent layer must leave the base untouched, a non blended layer must replace it
+    const TerrainBlendTexel transparent = composite({ stack[0], { stack[1].state, sample(1.0f, 1.0f, 1.0f, 0.0f) } });
+    expectAlbedo(transparent, 0.2f, 0.6f, 0.1f, "Transparent layer");
+
+    const TerrainBlendTexel replaced = composite({ stack[0], { opaqueState(), sample(0.5f, 0.4f, 0.3f, 0.25f) } });
+    expectAlbedo(replaced, 0.5f, 0.4f, 0.3f, "Non blended layer");
+  }
+
+  static void testTextureStageState() {
+    cout << "Begin test: texture stage state" << endl;
+
+    // Texture modulated by the texture factor (ARGB)
+    TerrainBlendLayerState state = opaqueState();
+    state.colorArg2Source = TERRAIN_BLEND_ARG_TFACTOR;
+    state.tFactor = 0x80804020;
+
+    TerrainBlendTexel texel = composite({ { state, sample(1.0f, 0.5f, 1.0f, 1.0f) } });
+    expectAlbedo(texel, 128.0f / 255.0f, 0.5f * 64.0f / 255.0f, 32.0f / 255.0f, "Texture factor modulation");
+
+    // Select the texture factor alpha as the layer opacity, driving an alpha blend
+    TerrainBlendLayerState detail = blendedState(TERRAIN_BLEND_FACTOR_SRC_ALPHA, TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA);
+    detail.alphaArg1Source = TERRAIN_BLEND_ARG_TFACTOR;
+    detail.tFactor = 0x40ffffff;
+
+    texel = composite({ { opaqueState(), sample(0.0f, 0.0f, 0.0f, 1.0f) }, { detail, sample(1.0f, 1.0f, 1.0f, 1.0f) } });
+    expectAlbedo(texel, 64.0f / 255.0f, 64.0f / 255.0f, 64.0f / 255.0f, "Texture factor alpha");
+
+    // Color add is unclamped until the framebuffer, alpha operations clamp
+    state = opaqueState();
+    state.colorOperation = TERRAIN_BLEND_TEXOP_ADD;
+    state.colorArg2Source = TERRAIN_BLEND_ARG_TEXTURE;
+    state.alphaOperation = TERRAIN_BLEND_TEXOP_MODULATE4X;
+    state.alphaArg2Source = TERRAIN_BLEND_ARG_TEXTURE;
+
+    texel = composite({ { state, sample(0.75f, 0.25f, 0.0f, 0.75f) } });
+    expectAlbedo(texel, 1.0f, 0.5f, 0.0f, "Color add");
+    expectNear(texel.albedo[3], 1.0f, "Alpha modulate 4x");
+
+    expectNear(terrainBlendTextureOperationAlpha(TERRAIN_BLEND_TEXOP_MODULATE2X, 0.0f, 0.25f, 0.5f), 0.25f, "Alpha modulate 2x");
+    expectNear(terrainBlendTextureOperationAlpha(TERRAIN_BLEND_TEXOP_ADD, 0.0f, 0.75f, 0.5f), 1.0f, "Alpha add");
+    expectNear(terrainBlendTextureOperationColor(TERRAIN_BLEND_TEXOP_MODULATE4X, 0.0f, 0.5f, 0.5f), 0.25f, "Color modulate 4x");
+    expectNear(terrainBlendTextureOperationColor(TERRAIN_BLEND_TEXOP_DISABLE, 0.3f, 0.5f, 0.5f), 0.3f, "Disabled stage");
+  }
+
+  static void testAdditiveAndMultiplicativeLayers() {
+    cout << "Begin test: additive and multiplicative layers" << endl;
+
+    const Layer base = { opaqueState(), sample(0.8f, 0.5f, 0.2f, 1.0f, 0.9f) };
+
+    // Additive highlights saturate
+    TerrainBlendTexel texel = composite({ base, { blendedState(TERRAIN_BLEND_FACTOR_ONE, TERRAIN_BLEND_FACTOR_ONE), sample(0.5f, 0.25f, 0.1f, 1.0f, 0.1f) } });
+    expectAlbedo(texel, 1.0f, 0.75f, 0.3f, "Additive layer");
+    expectNear(texel.roughness, 0.9f, "Additive layer roughness");
+
+    // Modulating detail layer (D3DBLEND_DESTCOLOR, D3DBLEND_ZERO)
+    texel = composite({ base, { blendedState(TERRAIN_BLEND_FACTOR_DST_COLOR, TERRAIN_BLEND_FACTOR_ZERO), sample(0.5f, 0.5f, 1.0f, 1.0f, 0.1f) } });
+    expectAlbedo(texel, 0.4f, 0.25f, 0.2f, "Multiplicative layer");
+    expectNear(texel.roughness, 0.9f, "Multiplicative layer roughness");
+
+    // Modulate 2x detail layer (D3DBLEND_DESTCOLOR, D3DBLEND_SRCCOLOR)
+    texel = composite({ base, { blendedState(TERRAIN_BLEND_FACTOR_DST_COLOR, TERRAIN_BLEND_FACTOR_SRC_COLOR), sample(0.5f, 0.75f, 0.25f, 1.0f) } });
+    expectAlbedo(texel, 0.8f, 0.75f, 0.1f, "Multiplicative 2x layer");
+  }
+
+  static void testBlendOperations() {
+    cout << "Begin test: blend operations" << endl;
+
+    const Layer base = { opaqueState(), sample(0.5f, 0.5f, 0.5f, 1.0f) };
+    const TerrainBlendLayerSample layerSample = sample(0.25f, 0.75f, 0.5f, 1.0f);
+
+    TerrainBlendTexel texel = composite({ base, { blendedState(TERRAIN_BLEND_FACTOR_ONE, TERRAIN_BLEND_FACTOR_ONE, TERRAIN_BLEND_OP_REVERSE_SUBTRACT), layerSample } });
+    expectAlbedo(texel, 0.25f, 0.0f, 0.0f, "Reverse subtract");
+
+    texel = composite({ base, { blendedState(TERRAIN_BLEND_FACTOR_ONE, TERRAIN_BLEND_FACTOR_ONE, TERRAIN_BLEND_OP_SUBTRACT), layerSample } });
+    expectAlbedo(texel, 0.0f, 0.25f, 0.0f, "Subtract");
+
+    texel = composite({ base, { blendedState(TERRAIN_BLEND_FACTOR_ZERO, TERRAIN_BLEND_FACTOR_ZERO, TERRAIN_BLEND_OP_MIN), layerSample } });
+    expectAlbedo(texel, 0.25f, 0.5f, 0.5f, "Min");
+
+    texel = composite({ base, { blendedState(TERRAIN_BLEND_FACTOR_ZERO, TERRAIN_BLEND_FACTOR_ZERO, TERRAIN_BLEND_OP_MAX), layerSample } });
+    expectAlbedo(texel, 0.5f, 0.75f, 0.5f, "Max");
+
+    // Destination alpha driven blend, the base alpha is the blend weight
+    const Layer maskedBase = { opaqueState(), sample(0.0f, 0.0f, 0.0f, 0.25f) };
+    texel = composite({ maskedBase, { blendedState(TERRAIN_BLEND_FACTOR_DST_ALPHA, TERRAIN_BLEND_FACTOR_ONE_MINUS_DST_ALPHA), sample(1.0f, 1.0f, 1.0f, 1.0f) } });
+    expectAlbedo(texel, 0.25f, 0.25f, 0.25f, "Destination alpha");
+  }
+
+  static void testNormalAndRoughness() {
+    cout << "Begin test: normal and roughness" << endl;
+
+    TerrainBlendLayerSample rock = sample(0.5f, 0.5f, 0.5f, 0.5f, 0.1f);
+    rock.hasNormal = 1;
+    rock.normal[0] = 1.0f;
+    rock.normal[2] = 0.0f;
+
+    const TerrainBlendTexel texel = composite({
+      { opaqueState(), sample(0.2f, 0.6f, 0.1f, 1.0f, 0.9f) },
+      { blendedState(TERRAIN_BLEND_FACTOR_SRC_ALPHA, TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA), rock } });
+
+    expectNear(texel.normal[0], 0.5f, "Blended normal x");
+    expectNear(texel.normal[1], 0.0f, "Blended normal y");
+    expectNear(texel.normal[2], 0.5f, "Blended normal z");
+    expectNear(texel.roughness, 0.5f, "Blended roughness");
+
+    // Layers without a normal map keep the normal underneath
+    TerrainBlendLayerSample flat = rock;
+    flat.hasNormal = 0;
+
+    const TerrainBlendTexel flatTexel = composite({
+      { opaqueState(), rock },
+      { blendedState(TERRAIN_BLEND_FACTOR_SRC_ALPHA, TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA), flat } });
+
+    expectNear(flatTexel.normal[0], 1.0f, "Preserved normal x");
+    expectNear(flatTexel.normal[2], 0.0f, "Preserved normal z");
+  }
+
+  static void testLayerOrder() {
+    cout << "Begin test: layer order" << endl;
+
+    // Grass, 50% dirt, then 50% snow. Compositing is order dependent and must match drawing the layers bottom to top.
+    const Layer grass = { opaqueState(), sample(0.2f, 0.6f, 0.1f, 1.0f) };
+    const Layer dirt = { blendedState(TERRAIN_BLEND_FACTOR_SRC_ALPHA, TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA), sample(0.4f, 0.3f, 0.2f, 0.5f) };
+    const Layer snow = { blendedState(TERRAIN_BLEND_FACTOR_SRC_ALPHA, TERRAIN_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA), sample(1.0f, 1.0f, 1.0f, 0.5f) };
+
+    const TerrainBlendTexel grassDirtSnow = composite({ grass, dirt, snow });
+    expectAlbedo(grassDirtSnow, (0.2f * 0.5f + 0.4f * 0.5f) * 0.5f + 0.5f, (0.6f * 0.5f + 0.3f * 0.5f) * 0.5f + 0.5f, (0.1f * 0.5f + 0.2f * 0.5f) * 0.5f + 0.5f, "Grass, dirt, snow");
+
+    const TerrainBlendTexel grassSnowDirt = composite({ grass, snow, dirt });
+    expectAlbedo(grassSnowDirt, (0.2f * 0.5f + 0.5f) * 0.5f + 0.2f, (0.6f * 0.5f + 0.5f) * 0.5f + 0.15f, (0.1f * 0.5f + 0.5f) * 0.5f + 0.1f, "Grass, snow, dirt");
+  }
+};
+
+int main() {
+  try {
+    TerrainBlendTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,254 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_texture_alpha.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Scalar reference of the alpha range of uncompressed texel data
+  TextureAlphaRange referenceAlphaRange(const std::vector<uint8_t>& data, uint32_t texelSize, uint32_t width, uint32_t height, size_t rowPitch) {
+    uint8_t minAlpha = 255;
+    uint8_t maxAlpha = 0;
+
+    for (uint32_t y = 0; y < height; y++) {
+      for (uint32_t x = 0; x < width; x++) {
+        const uint8_t alpha = data[y * rowPitch + x * texelSize + texelSize - 1];
+        minAlpha = std::min(minAlpha, alpha);
+        maxAlpha = std::max(maxAlpha, alpha);
+      }
+    }
+
+    return TextureAlphaRange::known(minAlpha, maxAlpha);
+  }
+
+  void expectRange(const TextureAlphaRange& range, uint8_t minAlpha, uint8_t maxAlpha, const char* what) {
+    if (!(range == TextureAlphaRange::known(minAlpha, maxAlpha))) {
+      throw DxvkError(str::format("Texture alpha: ", what, " range is [", uint32_t(range.minAlpha), ", ", uint32_t(range.maxAlpha),
+                                  "] known ", range.isKnown, ", expected [", uint32_t(minAlpha), ", ", uint32_t(maxAlpha), "]"));
+    }
+  }
+
+  void expectCoverage(AlphaCoverage coverage, AlphaCoverage expected, const char* what) {
+    if (coverage != expected) {
+      throw DxvkError(str::format("Texture alpha: ", what, " classified as ", uint32_t(coverage), ", expected ", uint32_t(expected)));
+    }
+  }
+}
+
+class TextureAlphaTestApp {
+public:
+  static void run() {
+    testUncompressed();
+    testPacked();
+    testBlockCompressed();
+    testTextureStage();
+    testClassification();
+    benchmark();
+  }
+
+private:
+  static void testUncompressed() {
+    std::mt19937 rng(7);
+
+    // Odd sizes and padded rows exercise the vector tails, the ranges are narrow so the extremes are rare texels
+    for (uint32_t texelSize : { 1u, 2u, 4u }) {
+      for (uint32_t width : { 1u, 3u, 5u, 17u, 64u, 131u }) {
+        for (bool padded : { false, true }) {
+          const uint32_t height = 9;
+          const size_t rowPitch = width * texelSize + (padded ? 12 : 0);
+          std::vector<uint8_t> data(rowPitch * height);
+
+          for (uint8_t& byte : data) {
+            byte = uint8_t(rng());
+          }
+
+          for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+              data[y * rowPitch + x * texelSize + texelSize - 1] = uint8_t(100 + rng() % 50);
+            }
+          }
+
+          // One extreme texel somewhere in the middle
+          data[(height / 2) * rowPitch + (width / 2) * texelSize + texelSize - 1] = 20;
+
+          const TextureAlphaFormat format = texelSize == 4 ? TextureAlphaFormat::A8R8G8B8 : texelSize == 2 ? TextureAlphaFormat::A8L8 : TextureAlphaFormat::A8;
+          const TextureAlphaRange range = computeTextureAlphaRange(format, data.data(), width, height, rowPitch);
+          const TextureAlphaRange expected = referenceAlphaRange(data, texelSize, width, height, rowPitch);
+
+          if (!(range == expected)) {
+            throw DxvkError(str::format("Texture alpha: texel size ", texelSize, " width ", width, " padded ", padded, " does not match the scalar reference"));
+          }
+        }
+      }
+    }
+
+    // Opaque formats are known without data
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::Opaque, nullptr, 4, 4, 0), 255, 255, "opaque format");
+
+    const uint8_t texels[16] = {};
+    if (computeTextureAlphaRange(TextureAlphaFormat::Unknown, texels, 2, 2, 8).isKnown)
+      throw DxvkError("Texture alpha: unknown formats must not be analyzed");
+  }
+
+  static void testPacked() {
+    // A4R4G4B4 with alpha nibbles 0x3 and 0xF
+    const uint16_t argb4[] = { 0x3123, 0xF456, 0xF789, 0x3ABC };
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::A4R4G4B4, argb4, 4, 1, getTextureAlphaRowPitch(TextureAlphaFormat::A4R4G4B4, 4)), 0x33, 0xFF, "A4R4G4B4");
+
+    // A1R5G5B5, all set and one clear
+    const uint16_t argb1[] = { 0xFFFF, 0x8000, 0x7FFF, 0x8001 };
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::A1R5G5B5, argb1, 2, 1, 4), 255, 255, "A1R5G5B5 opaque");
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::A1R5G5B5, argb1, 4, 1, 8), 0, 255, "A1R5G5B5 mixed");
+
+    if (getTextureAlphaRowPitch(TextureAlphaFormat::A8L8, 3) != 8 || getTextureAlphaRowPitch(TextureAlphaFormat::BC1, 5) != 16)
+      throw DxvkError("Texture alpha: unexpected row pitch");
+  }
+
+  static void testBlockCompressed() {
+    // BC1 in 4 color mode is opaque regardless of the indices
+    const uint8_t bc1Opaque[8] = { 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF };
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC1, bc1Opaque, 4, 4, 8), 255, 255, "BC1 4 color");
+
+    // BC1 in 3 color mode only has transparent texels where index 3 is used
+    const uint8_t bc1NoTransparent[8] = { 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x55, 0xAA, 0x00 };
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC1, bc1NoTransparent, 4, 4, 8), 255, 255, "BC1 3 color");
+
+    const uint8_t bc1Transparent[8] = { 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0xC0 };
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC1, bc1Transparent, 4, 4, 8), 0, 255, "BC1 punch through");
+
+    // BC2 with explicit alpha, nibbles 0x8 and 0xF
+    uint8_t bc2[16] = {};
+    std::memset(bc2, 0xF8, 8);
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC2, bc2, 4, 4, 16), 0x88, 0xFF, "BC2");
+
+    // BC3 with only the endpoints used
+    uint8_t bc3[16] = { 200, 100 };
+    bc3[2] = 0x08; // Texel 1 uses index 1
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC3, bc3, 4, 4, 16), 100, 200, "BC3 endpoints");
+
+    // BC3 with an interpolated value between equal endpoints stays exact
+    uint8_t bc3Uniform[16] = { 255, 255 };
+    std::memset(bc3Uniform + 2, 0x92, 6); // Mixes indices 2, 4 and others
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC3, bc3Uniform, 4, 4, 16), 255, 255, "BC3 uniform");
+
+    // BC3 in 6 value mode has explicit 0 and 255 at indices 6 and 7
+    uint8_t bc3Explicit[16] = { 100, 200 };
+    bc3Explicit[2] = 0x06; // Texel 0 uses index 6
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC3, bc3Explicit, 4, 4, 16), 0, 100, "BC3 explicit zero");
+
+    // Two block rows with a padded pitch, the transparent texel is in the second row
+    std::vector<uint8_t> blocks(2 * 24, 0);
+    std::memcpy(&blocks[0], bc1Opaque, 8);
+    std::memcpy(&blocks[8], bc1Opaque, 8);
+    std::memcpy(&blocks[24], bc1Opaque, 8);
+    std::memcpy(&blocks[32], bc1Transparent, 8);
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC1, blocks.data(), 8, 8, 24), 0, 255, "BC1 rows");
+    expectRange(computeTextureAlphaRange(TextureAlphaFormat::BC1, blocks.data(), 8, 4, 24), 255, 255, "BC1 first row");
+  }
+
+  static void testTextureStage() {
+    const TextureAlphaRange opaque = TextureAlphaRange::known(255, 255);
+
+    expectRange(applyTextureStageAlpha(opaque, DxvkRtTextureOperation::SelectArg1, RtTextureArgSource::Texture, RtTextureArgSource::None, 0), 255, 255, "select texture");
+    expectRange(applyTextureStageAlpha(opaque, DxvkRtTextureOperation::Modulate, RtTextureArgSource::TFactor, RtTextureArgSource::Texture, 255), 255, 255, "modulate by opaque factor");
+    expectRange(applyTextureStageAlpha(TextureAlphaRange::known(100, 200), DxvkRtTextureOperation::Modulate, RtTextureArgSource::Texture, RtTextureArgSource::TFactor, 128), 50, 101, "modulate by half");
+
+    if (applyTextureStageAlpha(opaque, DxvkRtTextureOperation::SelectArg1, RtTextureArgSource::VertexColor0, RtTextureArgSource::Texture, 255).isKnown ||
+        applyTextureStageAlpha(opaque, DxvkRtTextureOperation::Modulate, RtTextureArgSource::Texture, RtTextureArgSource::VertexColor0, 255).isKnown ||
+        applyTextureStageAlpha(opaque, DxvkRtTextureOperation::Add, RtTextureArgSource::Texture, RtTextureArgSource::TFactor, 255).isKnown)
+      throw DxvkError("Texture alpha: stages that don't only depend on the texture must not be known");
+  }
+
+  static void testClassification() {
+    const TextureAlphaRange opaque = TextureAlphaRange::known(255, 255);
+    const TextureAlphaRange transparent = TextureAlphaRange::known(0, 0);
+    const TextureAlphaRange cutout = TextureAlphaRange::known(0, 255);
+    const TextureAlphaRange high = TextureAlphaRange::known(200, 255);
+
+    // Alpha tested without blending
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kGreater, 128, false, BlendType::kAlpha, false), AlphaCoverage::Opaque, "test passing");
+    expectCoverage(classifyAlphaCoverage(high, AlphaTestType::kGreaterOrEqual, 128, false, BlendType::kAlpha, false), AlphaCoverage::Opaque, "test passing above reference");
+    expectCoverage(classifyAlphaCoverage(cutout, AlphaTestType::kGreater, 128, false, BlendType::kAlpha, false), AlphaCoverage::Mixed, "cutout");
+    expectCoverage(classifyAlphaCoverage(high, AlphaTestType::kLess, 100, false, BlendType::kAlpha, false), AlphaCoverage::Transparent, "test failing");
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kNever, 0, false, BlendType::kAlpha, false), AlphaCoverage::Transparent, "never");
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kNotEqual, 0, false, BlendType::kAlpha, false), AlphaCoverage::Opaque, "not equal");
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kEqual, 0, false, BlendType::kAlpha, false), AlphaCoverage::Transparent, "equal");
+
+    // Values at the reference are not trusted either way
+    expectCoverage(classifyAlphaCoverage(TextureAlphaRange::known(128, 255), AlphaTestType::kGreaterOrEqual, 128, false, BlendType::kAlpha, false), AlphaCoverage::Mixed, "at reference");
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kEqual, 255, false, BlendType::kAlpha, false), AlphaCoverage::Mixed, "equal to reference");
+
+    // Passing texels with zero alpha are still transparent without blending
+    expectCoverage(classifyAlphaCoverage(TextureAlphaRange::known(0, 50), AlphaTestType::kLess, 100, false, BlendType::kAlpha, false), AlphaCoverage::Mixed, "passing zero alpha");
+
+    // Alpha blending
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kAlways, 0, true, BlendType::kAlpha, false), AlphaCoverage::Opaque, "blend opaque");
+    expectCoverage(classifyAlphaCoverage(transparent, AlphaTestType::kAlways, 0, true, BlendType::kAlpha, false), AlphaCoverage::Transparent, "blend transparent");
+    expectCoverage(classifyAlphaCoverage(transparent, AlphaTestType::kAlways, 0, true, BlendType::kAlpha, true), AlphaCoverage::Opaque, "inverted blend opaque");
+    expectCoverage(classifyAlphaCoverage(high, AlphaTestType::kAlways, 0, true, BlendType::kAlpha, false), AlphaCoverage::Mixed, "blend partial");
+    expectCoverage(classifyAlphaCoverage(high, AlphaTestType::kLess, 100, true, BlendType::kAlpha, false), AlphaCoverage::Transparent, "blend with failing test");
+    expectCoverage(classifyAlphaCoverage(high, AlphaTestType::kLess, 100, true, BlendType::kAlpha, true), AlphaCoverage::Mixed, "inverted blend with failing test");
+
+    // Blend types which depend on color are never decided
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kAlways, 0, true, BlendType::kAlphaEmissive, false), AlphaCoverage::Mixed, "emissive");
+    expectCoverage(classifyAlphaCoverage(opaque, AlphaTestType::kAlways, 0, true, BlendType::kColor, false), AlphaCoverage::Mixed, "color");
+
+    // Nothing is decided without knowing the texture
+    expectCoverage(classifyAlphaCoverage(TextureAlphaRange {}, AlphaTestType::kNever, 0, false, BlendType::kAlpha, false), AlphaCoverage::Mixed, "unknown");
+  }
+
+  static void benchmark() {
+    const uint32_t size = 2048;
+    std::vector<uint8_t> data(size_t(size) * size * 4, 0xFF);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    TextureAlphaRange range;
+    for (uint32_t i = 0; i < 10; i++) {
+      range = computeTextureAlphaRange(TextureAlphaFormat::A8R8G8B8, data.data(), size, size, size_t(size) * 4);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    expectRange(range, 255, 255, "benchmark");
+
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count() / 10;
+    cout << "Alpha range of a " << size << "x" << size << " A8R8G8B8 texture in " << ms << " ms (" << (data.size() / (1024.0 * 1024.0)) / (ms / 1000.0) << " MB/s)" << endl;
+  }
+};
+
+int main() {
+  try {
+    TextureAlphaTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,219 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <cstdio>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_texture_manifest.h"
+
+using namespace dxvk;
+using namespace std;
+
+class TextureManifestTestApp {
+public:
+  static void run() {
+    testRecording();
+    testPrediction();
+    testSerialization();
+    testSyntheticCameraPath();
+  }
+
+private:
+  static constexpr float kCellSize = 100.0f;
+
+  static void testRecording() {
+    cout << "Begin test: recording" << endl;
+
+    TextureUsageManifest manifest(kCellSize);
+
+    if (!manifest.record(Vector3(10.f, 10.f, 10.f), 1, 100))
+      throw DxvkError("First use of a texture in a cell was not reported as new");
+
+    if (manifest.record(Vector3(20.f, 30.f, 40.f), 2, 100))
+      throw DxvkError("Repeated use of a texture in the same cell was reported as new");
+
+    // Same texture in a different cell is a new entry
+    manifest.record(Vector3(-10.f, 10.f, 10.f), 1, 100);
+
+    if (manifest.getCellCount() != 2 || manifest.getEntryCount() != 2)
+      throw DxvkError("Unexpected manifest size after recording");
+
+    if (!manifest.isDirty())
+      throw DxvkError("Manifest not marked dirty after recording");
+  }
+
+  static void testPrediction() {
+    cout << "Begin test: prediction ordering" << endl;
+
+    TextureUsageManifest manifest(kCellSize);
+
+    // Texture 1 at the origin, texture 2 one cell ahead, texture 3 far ahead along +X, texture 4 far behind
+    manifest.record(Vector3(50.f, 50.f, 50.f), 0, 1);
+    manifest.record(Vector3(150.f, 50.f, 50.f), 0, 2);
+    manifest.record(Vector3(850.f, 50.f, 50.f), 0, 3);
+    manifest.record(Vector3(-850.f, 50.f, 50.f), 0, 4);
+
+    // Stationary camera only sees its own neighborhood
+    auto predicted = manifest.predict(Vector3(50.f, 50.f, 50.f), Vector3(0.f), 1000.f, 16);
+
+    if (predicted.size() != 2 || predicted[0] != 1 || predicted[1] != 2)
+      throw DxvkError("Unexpected prediction for a stationary camera");
+
+    // Moving along +X should pick up texture 3 last, but never texture 4 behind the camera
+    predicted = manifest.predict(Vector3(50.f, 50.f, 50.f), Vector3(5.f, 0.f, 0.f), 1000.f, 16);
+
+    if (predicted.size() != 3 || predicted[0] != 1 || predicted[1] != 2 || predicted[2] != 3)
+      throw DxvkError("Unexpected prediction for a moving camera");
+
+    // Results are truncated to the requested count, closest first
+    predicted = manifest.predict(Vector3(50.f, 50.f, 50.f), Vector3(5.f, 0.f, 0.f), 1000.f, 1);
+
+    if (predicted.size() != 1 || predicted[0] != 1)
+      throw DxvkError("Prediction was not truncated to the closest texture");
+
+    // Equal distance is ordered by use count
+    TextureUsageManifest counted(kCellSize);
+    counted.record(Vector3(50.f, 50.f, 50.f), 0, 7);
+    counted.record(Vector3(50.f, 50.f, 50.f), 0, 8);
+    counted.record(Vector3(50.f, 50.f, 50.f), 0, 8);
+
+    predicted = counted.predict(Vector3(50.f, 50.f, 50.f), Vector3(0.f), 0.f, 16);
+
+    if (predicted.size() != 2 || predicted[0] != 8 || predicted[1] != 7)
+      throw DxvkError("Equidistant textures were not ordered by use count");
+  }
+
+  static void testSerialization() {
+    cout << "Begin test: serialization" << endl;
+
+    TextureUsageManifest manifest(kCellSize);
+
+    for (uint32_t i = 0; i < 64; i++) {
+      manifest.record(Vector3(float(i) * 37.f, float(i % 5) * 91.f, -float(i) * 13.f), i * 3, 1000 + i % 17);
+    }
+
+    std::vector<uint8_t> data;
+    manifest.serialize(data);
+
+    TextureUsageManifest loaded;
+
+    if (!loaded.deserialize(data))
+      throw DxvkError("Failed to deserialize manifest");
+
+    if (loaded.getCellSize() != kCellSize || loaded.getCellCount() != manifest.getCellCount() || loaded.getEntryCount() != manifest.getEntryCount())
+      throw DxvkError("Deserialized manifest does not match");
+
+    const Vector3 position(300.f, 100.f, -200.f);
+    const Vector3 motion(10.f, 0.f, -3.f);
+
+    if (loaded.predict(position, motion, 500.f, 32) != manifest.predict(position, motion, 500.f, 32))
+      throw DxvkError("Deserialized manifest predicts differently");
+
+    // Truncated or corrupt data must be rejected without clobbering the manifest
+    std::vector<uint8_t> truncated(data.begin(), data.begin() + data.size() / 2);
+
+    if (loaded.deserialize(truncated))
+      throw DxvkError("Truncated manifest was accepted");
+
+    if (loaded.getEntryCount() != manifest.getEntryCount())
+      throw DxvkError("Failed deserialization modified the manifest");
+
+    std::vector<uint8_t> corrupt = data;
+    corrupt[0] ^= 0xFF;
+
+    if (loaded.deserialize(corrupt))
+      throw DxvkError("Manifest with a bad header was accepted");
+
+    // Round trip through a file
+    const std::string path = "test_rtx_texture_manifest.texturemanifest";
+
+    if (!manifest.writeToFile(path))
+      throw DxvkError("Failed to write manifest file");
+
+    TextureUsageManifest fromFile;
+    const bool readResult = fromFile.readFromFile(path);
+    std::remove(path.c_str());
+
+    if (!readResult || fromFile.getEntryCount() != manifest.getEntryCount())
+      throw DxvkError("Failed to read back manifest file");
+  }
+
+  static void testSyntheticCameraPath() {
+    cout << "Begin test: synthetic camera path" << endl;
+
+    // Record a walk down a corridor along +Z where every 4 cells use a new set of textures
+    TextureUsageManifest manifest(kCellSize);
+    const uint32_t kNumSteps = 400;
+    const float kStepSize = 10.f;
+
+    auto texturesAt = [](float z) {
+      const uint32_t area = uint32_t(z / (4.f * kCellSize));
+      return std::vector<TextureUsageManifest::TextureHash> { area * 10 + 1, area * 10 + 2, area * 10 + 3 };
+    };
+
+    for (uint32_t i = 0; i < kNumSteps; i++) {
+      const Vector3 position(0.f, 0.f, float(i) * kStepSize);
+
+      for (auto hash : texturesAt(position.z)) {
+        manifest.record(position, 0, hash);
+      }
+    }
+
+    // Replay the walk and measure how far ahead of first use each texture is predicted
+    std::vector<TextureUsageManifest::TextureHash> prefetched;
+    uint32_t misses = 0;
+
+    for (uint32_t i = 0; i < kNumSteps; i++) {
+      const Vector3 position(0.f, 0.f, float(i) * kStepSize);
+
+      for (auto hash : manifest.predict(position, Vector3(0.f, 0.f, kStepSize), 3.f * kCellSize, 8)) {
+        if (std::find(prefetched.begin(), prefetched.end(), hash) == prefetched.end()) {
+          prefetched.push_back(hash);
+        }
+      }
+
+      for (auto hash : texturesAt(position.z)) {
+        if (std::find(prefetched.begin(), prefetched.end(), hash) == prefetched.end()) {
+          ++misses;
+          prefetched.push_back(hash);
+        }
+      }
+    }
+
+    cout << "Textures used: " << prefetched.size() << ", not prefetched before first use: " << misses << endl;
+
+    if (misses != 0)
+      throw DxvkError("Textures along the recorded path were not prefetched ahead of use");
+  }
+};
+
+int main() {
+  try {
+    TextureManifestTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
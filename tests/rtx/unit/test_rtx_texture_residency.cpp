@@ -0,0 +1,237 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstdint>
+#include <vector>
+
+#include "../../test_utils.h"
+
+#include "../../../src/dxvk/shaders/rtx/utility/shared_constants.h"
+#include "../../../src/dxvk/rtx_render/rtx_texture_residency.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  constexpr uint32_t kMipCount = 12;  // 2048x2048 texture
+
+  uint32_t encode(int32_t relativeMip) {
+    return uint32_t(relativeMip + SAMPLER_FEEDBACK_MIP_OFFSET);
+  }
+
+  // Plays back a synthetic history of per frame sampled mips (or -1 for not sampled) through decode, record and
+  // select the way the texture manager does, changing the resident mip whenever the policy asks for it.
+  struct ResidencySimulation {
+    TextureResidencyPolicy policy;
+    TextureResidencyHistory history;
+    uint32_t residentMip = 0;
+    uint32_t minMip = 0;
+    uint32_t maxMip = kMipCount - 1;
+    uint32_t frameId = 1;
+    uint32_t numChanges = 0;
+
+    void runFrames(uint32_t numFrames, int32_t absoluteSampledMip) {
+      for (uint32_t i = 0; i < numFrames; i++, frameId++) {
+        if (absoluteSampledMip >= 0) {
+          // The GPU sees the resident chain only, so it reports mips relative to its first level
+          uint8_t mip;
+          if (!decodeSamplerFeedback(encode(absoluteSampledMip - int32_t(residentMip)), residentMip, kMipCount, mip)) {
+            throw DxvkError("Sampled feedback was decoded as unsampled");
+          }
+
+          history.record(frameId, policy.getBucketFrames(), mip);
+        }
+
+        const uint32_t targetMip = policy.selectResidentMip(history, frameId, residentMip, minMip, maxMip);
+        if (targetMip != residentMip) {
+          residentMip = targetMip;
+          history.reset(frameId);
+          numChanges++;
+        }
+      }
+    }
+  };
+
+  void expect(uint32_t actual, uint32_t expected, const char* what) {
+    if (actual != expected) {
+      throw DxvkError(str::format(what, ": expected ", expected, ", got ", actual));
+    }
+  }
+}
+
+class TextureResidencyTestApp {
+public:
+  static void run() {
+    testDecode();
+    testWindowMinimum();
+    testFeedbackAfterChangeIsDiscarded();
+    testStreamInImmediately();
+    testDropAfterWindow();
+    testNoThrashOnOscillation();
+    testMipBiasAndClamp();
+    testUnsampledKeepsResidency();
+  }
+
+private:
+  static void testDecode() {
+    cout << "Begin test: decode sampler feedback" << endl;
+
+    uint8_t mip;
+    if (decodeSamplerFeedback(SAMPLER_FEEDBACK_UNSAMPLED, 0, kMipCount, mip)) {
+      throw DxvkError("Unsampled feedback decoded as a sampled mip");
+    }
+
+    decodeSamplerFeedback(encode(0), 2, kMipCount, mip);
+    expect(mip, 2, "Top of the resident chain");
+    decodeSamplerFeedback(encode(3), 2, kMipCount, mip);
+    expect(mip, 5, "Coarser than the resident top");
+    decodeSamplerFeedback(encode(-2), 3, kMipCount, mip);
+    expect(mip, 1, "Finer than the resident chain");
+    decodeSamplerFeedback(0, 1, kMipCount, mip);
+    expect(mip, 0, "Finer than the source asset");
+    decodeSamplerFeedback(SAMPLER_FEEDBACK_MAX_ENCODED_MIP, 0, kMipCount, mip);
+    expect(mip, kMipCount - 1, "Coarser than the source asset");
+  }
+
+  static void testWindowMinimum() {
+    cout << "Begin test: window minimum" << endl;
+
+    TextureResidencyHistory history;
+    const uint32_t bucketFrames = 4;  // 32 frame window
+
+    history.record(0, bucketFrames, 5);
+    history.record(10, bucketFrames, 3);
+    history.record(20, bucketFrames, 7);
+
+    expect(history.getWindowMinMip(20, bucketFrames), 3, "Minimum over the window");
+
+    // Frame 10 falls out of the window once its bucket is 8 buckets old
+    expect(history.getWindowMinMip(36, bucketFrames), 3, "Minimum before the old bucket expires");
+    expect(history.getWindowMinMip(40, bucketFrames), 7, "Minimum after the old bucket expired");
+    expect(history.getWindowMinMip(100, bucketFrames), TextureResidencyHistory::kUnsampled, "Minimum of an expired history");
+
+    // A reused bucket starts over rather than keeping the minimum of its previous epoch
+    history.record(41, bucketFrames, 9);
+    expect(history.getWindowMinMip(41, bucketFrames), 7, "Minimum after reusing a bucket");
+  }
+
+  static void testFeedbackAfterChangeIsDiscarded() {
+    cout << "Begin test: feedback from before a residency change" << endl;
+
+    TextureResidencyHistory history;
+    history.reset(50);
+    history.record(48, 1, 2);
+    expect(history.getWindowMinMip(50, 1), TextureResidencyHistory::kUnsampled, "Stale feedback recorded");
+    history.record(50, 1, 2);
+    expect(history.getWindowMinMip(50, 1), 2, "Current feedback dropped");
+  }
+
+  static void testStreamInImmediately() {
+    cout << "Begin test: stream in finer mips" << endl;
+
+    ResidencySimulation sim;
+    sim.residentMip = 4;
+    sim.runFrames(1, 1);
+
+    expect(sim.residentMip, 1, "Resident mip after sampling a finer mip");
+    expect(sim.numChanges, 1, "Number of residency changes");
+  }
+
+  static void testDropAfterWindow() {
+    cout << "Begin test: drop unused mips after the window" << endl;
+
+    ResidencySimulation sim;
+    sim.policy.windowFrames = 32;
+
+    // Close to the surface first, then move away so only mip 3 and coarser are sampled
+    sim.runFrames(10, 0);
+    expect(sim.residentMip, 0, "Resident mip when sampling the top mip");
+
+    sim.runFrames(25, 3);
+    expect(sim.residentMip, 0, "Mips dropped before a full window without sampling them");
+
+    sim.runFrames(40, 3);
+    expect(sim.residentMip, 3, "Resident mip after a full window at mip 3");
+    expect(sim.numChanges, 1, "Number of residency changes");
+  }
+
+  static void testNoThrashOnOscillation() {
+    cout << "Begin test: oscillating feedback" << endl;
+
+    ResidencySimulation sim;
+    sim.policy.windowFrames = 60;
+
+    // Alternating between a close and far view faster than the window must not keep restreaming the texture
+    for (uint32_t i = 0; i < 20; i++) {
+      sim.runFrames(15, 1);
+      sim.runFrames(15, 6);
+    }
+
+    expect(sim.residentMip, 1, "Resident mip with oscillating feedback");
+    expect(sim.numChanges, 1, "Number of residency changes");
+  }
+
+  static void testMipBiasAndClamp() {
+    cout << "Begin test: mip bias and clamping" << endl;
+
+    ResidencySimulation sim;
+    sim.policy.mipBias = 1;
+    sim.residentMip = 8;
+    sim.runFrames(1, 4);
+    expect(sim.residentMip, 3, "Resident mip with a bias of one mip");
+
+    ResidencySimulation clamped;
+    clamped.minMip = 2;
+    clamped.maxMip = 9;
+    clamped.residentMip = 5;
+    clamped.runFrames(1, 0);
+    expect(clamped.residentMip, 2, "Resident mip clamped to the minimum");
+
+    clamped.policy.windowFrames = 8;
+    clamped.runFrames(20, 11);
+    expect(clamped.residentMip, 9, "Resident mip clamped to the maximum");
+  }
+
+  static void testUnsampledKeepsResidency() {
+    cout << "Begin test: unsampled texture" << endl;
+
+    ResidencySimulation sim;
+    sim.policy.windowFrames = 16;
+    sim.residentMip = 2;
+    sim.runFrames(4, 2);
+    sim.runFrames(200, -1);
+
+    expect(sim.residentMip, 2, "Resident mip of a texture no longer sampled");
+    expect(sim.numChanges, 0, "Number of residency changes");
+  }
+};
+
+int main() {
+  try {
+    TextureResidencyTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,265 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/shaders/rtx/utility/vertex_packing.h"
+#include "../../../src/dxvk/shaders/rtx/pass/interleave_geometry_indices.h"
+#include "../../../src/dxvk/shaders/rtx/pass/interleave_geometry.h"
+
+using namespace dxvk;
+using namespace std;
+
+class VertexPackingTestApp {
+public:
+  static void run() {
+    testNormalEncoding();
+    testTexcoordEncoding();
+    testInterleavedRoundTrip();
+  }
+
+private:
+  static void testNormalEncoding() {
+    cout << "Begin test: compact normals" << endl;
+
+    // Degenerate normals must decode to something finite (+Z)
+    float decoded[3];
+    vertexPackingDecodeNormal(vertexPackingEncodeNormal(0.0f, 0.0f, 0.0f), decoded);
+
+    if (decoded[2] != 1.0f)
+      throw DxvkError("Zero length normal did not decode to +Z");
+
+    // Axis aligned normals must round trip exactly
+    const float axes[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+    for (const auto& axis : axes) {
+      vertexPackingDecodeNormal(vertexPackingEncodeNormal(axis[0], axis[1], axis[2]), decoded);
+
+      for (uint32_t i = 0; i < 3; i++) {
+        if (std::fabs(decoded[i] - axis[i]) > 1e-6f)
+          throw DxvkError("Axis aligned normal did not round trip");
+      }
+    }
+
+    // Random directions, 16 bit octahedral encoding should be well under 0.01 degrees of error
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> dist;
+
+    float maxErrorDegrees = 0.0f;
+
+    for (uint32_t i = 0; i < 100000; i++) {
+      float n[3] = { dist(rng), dist(rng), dist(rng) };
+      const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+      if (length == 0.0f)
+        continue;
+
+      for (float& c : n) {
+        c /= length;
+      }
+
+      vertexPackingDecodeNormal(vertexPackingEncodeNormal(n[0], n[1], n[2]), decoded);
+
+      // Note: Use the cross product magnitude in double precision, acos of a float dot product is far too imprecise near 1
+      const double cx = double(n[1]) * decoded[2] - double(n[2]) * decoded[1];
+      const double cy = double(n[2]) * decoded[0] - double(n[0]) * decoded[2];
+      const double cz = double(n[0]) * decoded[1] - double(n[1]) * decoded[0];
+      const double angle = std::asin(std::min(1.0, std::sqrt(cx * cx + cy * cy + cz * cz)));
+      maxErrorDegrees = std::max(maxErrorDegrees, float(angle * 180.0 / 3.14159265358979));
+    }
+
+    cout << "Max normal error: " << maxErrorDegrees << " degrees" << endl;
+
+    if (maxErrorDegrees > 0.01f)
+      throw DxvkError("Compact normal error exceeds bound");
+  }
+
+  static void testTexcoordEncoding() {
+    cout << "Begin test: compact texcoords" << endl;
+
+    std::mt19937 rng(5678);
+    std::uniform_real_distribution<float> dist(-8.0f, 8.0f);
+
+    float maxRelativeError = 0.0f;
+
+    for (uint32_t i = 0; i < 100000; i++) {
+      const float uv[2] = { dist(rng), dist(rng) };
+
+      float decoded[2];
+      vertexPackingDecodeTexcoord(vertexPackingEncodeTexcoord(uv[0], uv[1]), decoded);
+
+      for (uint32_t c = 0; c < 2; c++) {
+        // Half precision has an 11 bit significand, so relative error is bounded by 2^-11 (plus the denormal floor)
+        const float error = std::fabs(decoded[c] - uv[c]) / std::max(std::fabs(uv[c]), 6.1e-5f);
+        maxRelativeError = std::max(maxRelativeError, error);
+      }
+    }
+
+    cout << "Max texcoord relative error: " << maxRelativeError << endl;
+
+    if (maxRelativeError > 1.0f / 2048.0f)
+      throw DxvkError("Compact texcoord error exceeds bound");
+
+    // Exactly representable values must round trip exactly
+    float decoded[2];
+    vertexPackingDecodeTexcoord(vertexPackingEncodeTexcoord(0.5f, -1.0f), decoded);
+
+    if (decoded[0] != 0.5f || decoded[1] != -1.0f)
+      throw DxvkError("Exact texcoord values did not round trip");
+  }
+
+  // Interleaves a mesh with the full and the compact layout, as the geometry cache does
+  static std::vector<float> interleaveMesh(const std::vector<float>& positions, const std::vector<float>& normals,
+                                           const std::vector<float>& texcoords, const std::vector<uint32_t>& colors,
+                                           bool compact, uint32_t outputStride) {
+    const uint32_t vertexCount = uint32_t(colors.size());
+
+    InterleaveGeometryArgs args = {};
+    args.positionStride = 3;
+    args.hasNormals = true;
+    args.normalStride = 3;
+    args.hasTexcoord = true;
+    args.texcoordStride = 2;
+    args.hasColor0 = true;
+    args.color0Stride = 1;
+    args.outputStride = outputStride;
+    args.vertexCount = vertexCount;
+    args.compactNormals = compact;
+    args.compactTexcoords = compact;
+
+    // Note: A guard vertex past the end catches writes beyond the stride
+    const float kUnwritten = -12345.0f;
+    std::vector<float> output((vertexCount + 1) * outputStride, kUnwritten);
+
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      interleave(i, output.data(), positions.data(), normals.data(), texcoords.data(), colors.data(), args);
+    }
+
+    for (uint32_t i = 0; i < output.size(); i++) {
+      if ((output[i] == kUnwritten) != (i >= vertexCount * outputStride))
+        throw DxvkError(str::format("Interleaved ", compact ? "compact" : "full", " vertex data does not fill a stride of ", outputStride, " floats"));
+    }
+
+    output.resize(vertexCount * outputStride);
+    return output;
+  }
+
+  static void testInterleavedRoundTrip() {
+    cout << "Begin test: interleaved round trip" << endl;
+
+    constexpr uint32_t kVertexCount = 65536;
+
+    std::mt19937 rng(91011);
+    std::normal_distribution<float> normalDist;
+    std::uniform_real_distribution<float> positionDist(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> texcoordDist(-8.0f, 8.0f);
+
+    std::vector<float> positions, normals, texcoords;
+    std::vector<uint32_t> colors;
+
+    for (uint32_t i = 0; i < kVertexCount; i++) {
+      float n[3] = { normalDist(rng), normalDist(rng), normalDist(rng) };
+      const float length = std::max(std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]), 1e-6f);
+
+      for (uint32_t c = 0; c < 3; c++) {
+        positions.push_back(positionDist(rng));
+        normals.push_back(n[c] / length);
+      }
+
+      texcoords.push_back(texcoordDist(rng));
+      texcoords.push_back(texcoordDist(rng));
+      colors.push_back(uint32_t(rng()));
+    }
+
+    // Position, normal, texcoord and color in 32 bit floats, and with the normal and texcoord packed into 32 bits each
+    const uint32_t fullStride = 3 + 3 + 2 + 1;
+    const uint32_t compactStride = 3 + 1 + 1 + 1;
+
+    const std::vector<float> full = interleaveMesh(positions, normals, texcoords, colors, false, fullStride);
+    const std::vector<float> compact = interleaveMesh(positions, normals, texcoords, colors, true, compactStride);
+
+    const size_t fullBytes = full.size() * sizeof(float);
+    const size_t compactBytes = compact.size() * sizeof(float);
+
+    cout << "Mesh with " << kVertexCount << " vertices: " << fullBytes << " -> " << compactBytes << " bytes ("
+         << (100.0f * (fullBytes - compactBytes)) / fullBytes << "% saved)" << endl;
+
+    if (compactBytes * 3 != fullBytes * 2)
+      throw DxvkError("Compact vertex data is not two thirds of the full vertex data");
+
+    float maxNormalError = 0.0f;
+    float maxTexcoordError = 0.0f;
+
+    for (uint32_t i = 0; i < kVertexCount; i++) {
+      const float* fullVertex = &full[i * fullStride];
+      const float* compactVertex = &compact[i * compactStride];
+
+      // Positions and colors are copied as is by both layouts, and the full layout keeps everything as is
+      if (std::memcmp(fullVertex, &positions[i * 3], sizeof(float) * 3) ||
+          std::memcmp(fullVertex + 3, &normals[i * 3], sizeof(float) * 3) ||
+          std::memcmp(fullVertex + 6, &texcoords[i * 2], sizeof(float) * 2) ||
+          std::memcmp(fullVertex + 8, &colors[i], sizeof(uint32_t)))
+        throw DxvkError("Full vertex data did not round trip");
+
+      if (std::memcmp(compactVertex, &positions[i * 3], sizeof(float) * 3) ||
+          std::memcmp(compactVertex + 5, &colors[i], sizeof(uint32_t)))
+        throw DxvkError("Compact vertex positions or colors did not round trip");
+
+      uint32_t packedNormal, packedTexcoord;
+      std::memcpy(&packedNormal, compactVertex + 3, sizeof(uint32_t));
+      std::memcpy(&packedTexcoord, compactVertex + 4, sizeof(uint32_t));
+
+      float normal[3], texcoord[2];
+      vertexPackingDecodeNormal(packedNormal, normal);
+      vertexPackingDecodeTexcoord(packedTexcoord, texcoord);
+
+      for (uint32_t c = 0; c < 3; c++)
+        maxNormalError = std::max(maxNormalError, std::fabs(normal[c] - normals[i * 3 + c]));
+
+      for (uint32_t c = 0; c < 2; c++) {
+        const float reference = texcoords[i * 2 + c];
+        maxTexcoordError = std::max(maxTexcoordError, std::fabs(texcoord[c] - reference) / std::max(std::fabs(reference), 6.1e-5f));
+      }
+    }
+
+    cout << "Max interleaved normal component error: " << maxNormalError << ", texcoord relative error: " << maxTexcoordError << endl;
+
+    // Note: 0.01 degrees of angular error (see above) bound each normal component error by about 2e-4
+    if (maxNormalError > 2e-4f || maxTexcoordError > 1.0f / 2048.0f)
+      throw DxvkError("Compact vertex data did not round trip within the encoding error");
+  }
+};
+
+int main() {
+  try {
+    VertexPackingTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,296 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_thread_placement.h"
+
+using namespace dxvk;
+using namespace std;
+
+namespace {
+  // Builds GetLogicalProcessorInformationEx output the way Windows reports it
+  class TopologyFixture {
+  public:
+    void addCore(WORD group, KAFFINITY mask, BYTE efficiencyClass) {
+      SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX info = {};
+      info.Relationship = RelationProcessorCore;
+      info.Size = sizeof(info);
+      info.Processor.Flags = (mask & (mask - 1)) != 0 ? LTP_PC_SMT : 0;
+      info.Processor.EfficiencyClass = efficiencyClass;
+      info.Processor.GroupCount = 1;
+      info.Processor.GroupMask[0].Group = group;
+      info.Processor.GroupMask[0].Mask = mask;
+      append(info);
+    }
+
+    void addCache(BYTE level, PROCESSOR_CACHE_TYPE type, WORD group, KAFFINITY mask) {
+      SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX info = {};
+      info.Relationship = RelationCache;
+      info.Size = sizeof(info);
+      info.Cache.Level = level;
+      info.Cache.Type = type;
+      info.Cache.GroupMask.Group = group;
+      info.Cache.GroupMask.Mask = mask;
+      append(info);
+    }
+
+    CpuTopology parse() const {
+      return CpuTopology::fromProcessorInformation(m_data.data(), m_data.size());
+    }
+
+    const std::vector<uint8_t>& data() const {
+      return m_data;
+    }
+
+  private:
+    std::vector<uint8_t> m_data;
+
+    void append(const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info) {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&info);
+      m_data.insert(m_data.end(), bytes, bytes + sizeof(info));
+    }
+  };
+
+  // 8 performance cores with SMT and 8 efficiency cores behind a single L3
+  TopologyFixture hybridFixture() {
+    TopologyFixture fixture;
+
+    for (uint32_t i = 0; i < 8; i++) {
+      fixture.addCore(0, KAFFINITY(3) << (2 * i), 1);
+      fixture.addCache(1, CacheData, 0, KAFFINITY(3) << (2 * i));
+      fixture.addCache(1, CacheInstruction, 0, KAFFINITY(3) << (2 * i));
+      fixture.addCache(2, CacheUnified, 0, KAFFINITY(3) << (2 * i));
+    }
+
+    for (uint32_t i = 0; i < 8; i++) {
+      fixture.addCore(0, KAFFINITY(1) << (16 + i), 0);
+      fixture.addCache(1, CacheData, 0, KAFFINITY(1) << (16 + i));
+    }
+
+    fixture.addCache(2, CacheUnified, 0, 0x0F0000);
+    fixture.addCache(2, CacheUnified, 0, 0xF00000);
+    fixture.addCache(3, CacheUnified, 0, 0xFFFFFF);
+    return fixture;
+  }
+
+  // 16 cores with SMT split over two L3 caches
+  TopologyFixture dualCacheFixture() {
+    TopologyFixture fixture;
+
+    for (uint32_t i = 0; i < 16; i++) {
+      fixture.addCore(0, KAFFINITY(3) << (2 * i), 0);
+      fixture.addCache(2, CacheUnified, 0, KAFFINITY(3) << (2 * i));
+    }
+
+    fixture.addCache(3, CacheUnified, 0, 0x0000FFFF);
+    fixture.addCache(3, CacheUnified, 0, 0xFFFF0000);
+    return fixture;
+  }
+
+  // 4 cores without SMT behind a single L3
+  TopologyFixture quadCoreFixture() {
+    TopologyFixture fixture;
+
+    for (uint32_t i = 0; i < 4; i++)
+      fixture.addCore(0, KAFFINITY(1) << i, 0);
+
+    fixture.addCache(3, CacheUnified, 0, 0xF);
+    return fixture;
+  }
+
+  void expectPlacement(const CpuTopology& topology, const ThreadPlacementPolicy& policy, ThreadRole role,
+                       ThreadPriority priority, uint64_t affinityMask, const char* what) {
+    const ThreadPlacement placement = ThreadPlacementService::computePlacement(topology, policy, role);
+
+    if (!placement.setPriority || placement.priority != priority) {
+      throw DxvkError(str::format(what, ": unexpected priority ", int32_t(placement.priority)));
+    }
+
+    if (placement.affinityMask != affinityMask) {
+      throw DxvkError(str::format(what, ": expected affinity 0x", std::hex, affinityMask, " got 0x", placement.affinityMask));
+    }
+  }
+}
+
+class ThreadPlacementTestApp {
+public:
+  static void run() {
+    testParseHybrid();
+    testParseDualCache();
+    testParseTruncated();
+    testHybridPlacement();
+    testDualCachePlacement();
+    testQuadCorePlacement();
+    testModes();
+  }
+
+private:
+  static void testParseHybrid() {
+    cout << "Begin test: parse hybrid topology" << endl;
+
+    const CpuTopology topology = hybridFixture().parse();
+
+    if (topology.getCores().size() != 16 || topology.getLogicalProcessorCount() != 24) {
+      throw DxvkError(str::format("Expected 16 cores and 24 logical processors, got ", topology.getCores().size(), " and ", topology.getLogicalProcessorCount()));
+    }
+
+    if (!topology.isHybrid() || topology.getMinEfficiencyClass() != 0 || topology.getMaxEfficiencyClass() != 1) {
+      throw DxvkError("Hybrid topology not detected");
+    }
+
+    // The E-core L2 clusters must not split the cores into several cache groups
+    if (topology.getCacheGroupCount() != 1) {
+      throw DxvkError(str::format("Expected a single cache group, got ", topology.getCacheGroupCount()));
+    }
+  }
+
+  static void testParseDualCache() {
+    cout << "Begin test: parse dual cache topology" << endl;
+
+    const CpuTopology topology = dualCacheFixture().parse();
+
+    if (topology.isHybrid() || topology.getCacheGroupCount() != 2) {
+      throw DxvkError("Expected a homogeneous topology with two cache groups");
+    }
+
+    for (uint32_t i = 0; i < topology.getCores().size(); i++) {
+      if (topology.getCores()[i].cacheGroup != i / 8) {
+        throw DxvkError(str::format("Core ", i, " assigned to cache group ", topology.getCores()[i].cacheGroup));
+      }
+    }
+  }
+
+  static void testParseTruncated() {
+    cout << "Begin test: parse truncated buffer" << endl;
+
+    const TopologyFixture fixture = quadCoreFixture();
+    const std::vector<uint8_t>& data = fixture.data();
+
+    // A partial trailing entry must be ignored rather than read past the end
+    const CpuTopology topology = CpuTopology::fromProcessorInformation(data.data(), data.size() - 1);
+
+    if (topology.getCores().size() != 4 || topology.getCacheGroupCount() != 1) {
+      throw DxvkError("Unexpected topology from truncated buffer");
+    }
+
+    if (!CpuTopology::fromProcessorInformation(nullptr, 0).getCores().empty()) {
+      throw DxvkError("Expected an empty topology from an empty buffer");
+    }
+  }
+
+  static void testHybridPlacement() {
+    cout << "Begin test: hybrid placement" << endl;
+
+    const CpuTopology topology = hybridFixture().parse();
+
+    // Affinities are opt-in, the default only sets priorities
+    const ThreadPlacementPolicy defaultPolicy;
+    expectPlacement(topology, defaultPolicy, ThreadRole::Render, ThreadPriority::High, 0, "Render (default)");
+    expectPlacement(topology, defaultPolicy, ThreadRole::PipelineCompiler, ThreadPriority::Lowest, 0, "Pipeline compiler (default)");
+
+    ThreadPlacementPolicy policy;
+    policy.mode = ThreadPlacementMode::Auto;
+
+    // P-cores minus the first one, kept for the application's main thread
+    expectPlacement(topology, policy, ThreadRole::Render, ThreadPriority::High, 0xFFFC, "Render");
+    expectPlacement(topology, policy, ThreadRole::Submission, ThreadPriority::High, 0xFFFC, "Submission");
+    expectPlacement(topology, policy, ThreadRole::Worker, ThreadPriority::Normal, 0, "Worker");
+    expectPlacement(topology, policy, ThreadRole::TextureStreaming, ThreadPriority::Normal, 0xFF0000, "Texture streaming");
+    expectPlacement(topology, policy, ThreadRole::PipelineCompiler, ThreadPriority::Lowest, 0xFF0000, "Pipeline compiler");
+    expectPlacement(topology, policy, ThreadRole::AssetLoader, ThreadPriority::Low, 0xFF0000, "Asset loader");
+
+    ThreadPlacementPolicy noReserve;
+    noReserve.mode = ThreadPlacementMode::Auto;
+    noReserve.reserveMainThreadCore = false;
+    expectPlacement(topology, noReserve, ThreadRole::Render, ThreadPriority::High, 0xFFFF, "Render without reserved core");
+  }
+
+  static void testDualCachePlacement() {
+    cout << "Begin test: dual cache placement" << endl;
+
+    const CpuTopology topology = dualCacheFixture().parse();
+    ThreadPlacementPolicy policy;
+    policy.mode = ThreadPlacementMode::Auto;
+
+    // Latency critical threads share the main thread's cache, background threads use the other one
+    expectPlacement(topology, policy, ThreadRole::Render, ThreadPriority::High, 0x0000FFFC, "Render");
+    expectPlacement(topology, policy, ThreadRole::PipelineCompiler, ThreadPriority::Lowest, 0xFFFF0000, "Pipeline compiler");
+    expectPlacement(topology, policy, ThreadRole::Worker, ThreadPriority::Normal, 0, "Worker");
+  }
+
+  static void testQuadCorePlacement() {
+    cout << "Begin test: quad core placement" << endl;
+
+    const CpuTopology topology = quadCoreFixture().parse();
+
+    // Interchangeable cores, auto mode only sets priorities
+    ThreadPlacementPolicy policy;
+    policy.mode = ThreadPlacementMode::Auto;
+    expectPlacement(topology, policy, ThreadRole::Render, ThreadPriority::High, 0, "Render (auto)");
+    expectPlacement(topology, policy, ThreadRole::PipelineCompiler, ThreadPriority::Lowest, 0, "Pipeline compiler (auto)");
+
+    // There are no efficiency cores to move background threads to
+    policy.mode = ThreadPlacementMode::Affinity;
+    expectPlacement(topology, policy, ThreadRole::Render, ThreadPriority::High, 0xE, "Render (affinity)");
+    expectPlacement(topology, policy, ThreadRole::PipelineCompiler, ThreadPriority::Lowest, 0, "Pipeline compiler (affinity)");
+  }
+
+  static void testModes() {
+    cout << "Begin test: placement modes" << endl;
+
+    if (ThreadPlacementPolicy::parseMode("disabled") != ThreadPlacementMode::Disabled
+     || ThreadPlacementPolicy::parseMode("priority") != ThreadPlacementMode::Priority
+     || ThreadPlacementPolicy::parseMode("affinity") != ThreadPlacementMode::Affinity
+     || ThreadPlacementPolicy::parseMode("auto") != ThreadPlacementMode::Auto
+     || ThreadPlacementPolicy::parseMode("bogus") != ThreadPlacementMode::Priority) {
+      throw DxvkError("Unexpected placement mode parsing");
+    }
+
+    const CpuTopology topology = hybridFixture().parse();
+
+    ThreadPlacementPolicy policy;
+    policy.mode = ThreadPlacementMode::Priority;
+    expectPlacement(topology, policy, ThreadRole::Render, ThreadPriority::High, 0, "Render (priority)");
+
+    policy.mode = ThreadPlacementMode::Disabled;
+    if (ThreadPlacementService::computePlacement(topology, policy, ThreadRole::Render).setPriority) {
+      throw DxvkError("Disabled placement must leave threads alone");
+    }
+
+    // Without topology information threads are left unrestricted
+    policy.mode = ThreadPlacementMode::Affinity;
+    expectPlacement(CpuTopology(), policy, ThreadRole::Render, ThreadPriority::High, 0, "Render (no topology)");
+  }
+};
+
+int main() {
+  try {
+    ThreadPlacementTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    cerr << e.message() << endl;
+    return -1;
+  }
+
+  return 0;
+}